@@ -21,9 +21,10 @@ my $file = dirname($0) . "/../src/schema.tmpl";	# name the file
 
 my ($state, %output, $eol, $fk_bol, $fk_eol, $ltab, $pkey, $table_name, $pkey_name);
 my ($szcol1, $szcol2, $szcol3, $szcol4, $sequences, $sql_suffix, $triggers);
-my ($fkeys, $fkeys_prefix, $fkeys_suffix, $uniq, $delete_cascade);
+my ($fkeys, $fkeys_prefix, $fkeys_suffix, $uniq);
 
 my %table_types;	# for making sure that table types aren't duplicated
+my %delete_cascade;	# parent tables referenced by foreign keys with cascade delete
 
 my %c = (
 	"type"		=>	"code",
@@ -179,7 +180,7 @@ sub process_table($)
 
 	newstate("table");
 
-	$delete_cascade = 0;
+	%delete_cascade = ();
 
 	($table_name, $pkey_name, $flags) = split(/\|/, $line, 3);
 
@@ -290,18 +291,18 @@ sub process_field($)
 				$fk_field = $name;
 			}
 
-			$fk_table = "\"${fk_table}\"";
-			$fk_field = "\"${fk_field}\"";
-
 			if (not $fk_flags or $fk_flags eq "")
 			{
-				$delete_cascade = 1;
+				$delete_cascade{$fk_table} = 1;
 				$fk_flags = "ZBX_FK_CASCADE_DELETE";
 			}
 			elsif ($fk_flags eq "RESTRICT")
 			{
 				$fk_flags = "0";
 			}
+
+			$fk_table = "\"${fk_table}\"";
+			$fk_field = "\"${fk_field}\"";
 		}
 		else
 		{
@@ -359,7 +360,7 @@ sub process_field($)
 
 			if (not $fk_flags or $fk_flags eq "")
 			{
-				$delete_cascade = 1;
+				$delete_cascade{$fk_table} = 1;
 				$fk_flags = " ON DELETE CASCADE";
 			}
 			elsif ($fk_flags eq "RESTRICT")
@@ -812,9 +813,15 @@ sub process_changelog($)
 {
 	my $table_type = shift;
 
-	if ($delete_cascade)
+	# rows removed by cascade delete do not fire triggers on MySQL, such tables can be tracked only when
+	# the parent table is tracked too and configuration cache removes the dependent rows by itself
+	foreach my $parent (keys(%delete_cascade))
 	{
-		die("table '$table_name' foreign keys without RESTRICT flag are not compatible with table CHANGELOG token");
+		if (not grep { $_ eq $parent } values(%table_types))
+		{
+			die("table '$table_name' foreign keys without RESTRICT flag are not compatible with table CHANGELOG token".
+					" unless referenced table '$parent' has CHANGELOG token");
+		}
 	}
 
 	if (exists($table_types{$table_type}) && $table_types{$table_type} ne $table_name)
@@ -317,6 +317,10 @@
 #	include <unistd.h>
 #endif
 
+#ifdef HAVE_SYS_INOTIFY_H
+#	include <sys/inotify.h>
+#endif
+
 #ifdef HAVE_SYS_IPC_H
 #	include <sys/ipc.h>
 #endif
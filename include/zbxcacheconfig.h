@@ -986,6 +986,26 @@ int	zbx_dc_get_host_inventory_value_by_hostid(zbx_uint64_t hostid, char **replac
 void	*zbx_dc_config_get_stats(int request);
 
 int	zbx_dc_config_get_last_sync_time(void);
+
+#define ZBX_DC_SYNC_STATS_MAX		64
+#define ZBX_DC_SYNC_NAME_LEN		32
+#define ZBX_DC_SYNC_MODE_LEN		16
+
+/* configuration cache synchronization statistics of a single table during last sync */
+typedef struct
+{
+	char		name[ZBX_DC_SYNC_NAME_LEN];
+	char		mode[ZBX_DC_SYNC_MODE_LEN];	/* init, diff, changelog or fallback */
+	double		sql_time;
+	double		sync_time;
+	zbx_uint64_t	add_num;
+	zbx_uint64_t	update_num;
+	zbx_uint64_t	remove_num;
+	zbx_int64_t	sync_size;
+}
+zbx_dc_sync_stats_t;
+
+int	zbx_dc_config_get_sync_stats(zbx_dc_sync_stats_t *stats, int *changelog_num, double *changelog_time);
 int	zbx_dc_config_get_proxypoller_hosts(zbx_dc_proxy_t *proxies, int max_hosts);
 int	zbx_dc_config_get_proxypoller_nextcheck(void);
 
@@ -1354,6 +1374,7 @@ int	zbx_dc_drule_revisions_get(zbx_uint64_t *rev_last, zbx_vector_uint64_pair_t
 int	zbx_dc_httptest_next(time_t now, zbx_uint64_t *httptestid, time_t *nextcheck);
 void	zbx_dc_httptest_queue(time_t now, zbx_uint64_t httptestid, int delay);
 
+zbx_uint64_t	zbx_dc_get_lld_rule_revision(zbx_uint64_t itemid);
 void	zbx_dc_get_upstream_revision(zbx_uint64_t *config_revision, zbx_uint64_t *hostmap_revision);
 void	zbx_dc_set_upstream_revision(zbx_uint64_t config_revision, zbx_uint64_t hostmap_revision);
 
@@ -45,6 +45,9 @@
  *   either zbx_history_record_vector_destroy() function (free the zbx_vc_get_values()
  *   call output) or zbx_history_record_clear() function (free the zbx_vc_get_value() call output).
  *
+ *   Values can be also processed in place without copying them with zbx_vc_process_values()
+ *   function, or aggregated with zbx_vc_get_aggregate() function.
+ *
  * Locking
  *
  *   The cache ensures synchronization between processes by using automatic locks whenever
@@ -78,6 +81,22 @@ typedef struct
 }
 zbx_vc_stats_t;
 
+/* the value processing callback, returns SUCCEED to continue or FAIL to stop processing */
+typedef int	(*zbx_vc_value_cb_t)(const zbx_history_record_t *value, void *data);
+
+/* numeric value aggregate */
+typedef struct
+{
+	/* the number of aggregated values */
+	int			values_num;
+
+	zbx_history_value_t	sum;
+	zbx_history_value_t	min;
+	zbx_history_value_t	max;
+	double			avg;
+}
+zbx_vc_aggregate_t;
+
 /* item diagnostic statistics */
 typedef struct
 {
@@ -91,7 +110,7 @@ ZBX_PTR_VECTOR_DECL(vc_item_stats_ptr, zbx_vc_item_stats_t *)
 
 void	zbx_vc_item_stats_free(zbx_vc_item_stats_t *vc_item_stats);
 
-int	zbx_vc_init(zbx_uint64_t value_cache_size, char **error);
+int	zbx_vc_init(zbx_uint64_t value_cache_size, int value_cache_compression, char **error);
 
 void	zbx_vc_destroy(void);
 
@@ -107,6 +126,12 @@ int	zbx_vc_get_values(zbx_uint64_t itemid, unsigned char value_type, zbx_vector_
 int	zbx_vc_get_value(zbx_uint64_t itemid, unsigned char value_type, const zbx_timespec_t *ts,
 		zbx_history_record_t *value);
 
+int	zbx_vc_process_values(zbx_uint64_t itemid, unsigned char value_type, int seconds, int count,
+		const zbx_timespec_t *ts, zbx_vc_value_cb_t value_cb, void *data);
+
+int	zbx_vc_get_aggregate(zbx_uint64_t itemid, unsigned char value_type, int seconds, int count,
+		const zbx_timespec_t *ts, zbx_vc_aggregate_t *aggregate);
+
 int	zbx_vc_add_values(zbx_vector_dc_history_ptr_t *history, int *ret_flush, int config_history_storage_pipelines);
 
 int	zbx_vc_get_statistics(zbx_vc_stats_t *stats);
@@ -174,9 +174,10 @@ typedef struct
 #elif defined(HAVE_OPENSSL)
 	SSL				*ctx;
 #if defined(HAVE_OPENSSL_WITH_PSK)
-	char	psk_buf[HOST_TLS_PSK_LEN / 2];
-	int	psk_len;
-	size_t	identity_len;
+	char		psk_buf[HOST_TLS_PSK_LEN / 2];
+	int		psk_len;
+	size_t		identity_len;
+	unsigned char	psk_accepted;	/* incoming connection is using PSK */
 #endif
 #endif
 } zbx_tls_context_t;
@@ -301,6 +302,8 @@ void	zbx_tcp_unlisten(zbx_socket_t *s);
 
 int	zbx_tcp_accept(zbx_socket_t *s, unsigned int tls_accept, int poll_timeout, char *tls_listen,
 		const char *unencrypted_allowed_ip);
+int	zbx_tcp_accept_nowait(zbx_socket_t *s);
+int	zbx_tcp_accept_handshake(zbx_socket_t *s, unsigned int tls_accept, short *event);
 void	zbx_tcp_unaccept(zbx_socket_t *s);
 
 #define ZBX_TCP_READ_UNTIL_CLOSE 0x01
@@ -17,7 +17,13 @@
 
 #include "zbxtypes.h"
 
+#define ZBX_COMPRESS_LEVEL_DEFAULT	0
+#define ZBX_COMPRESS_LEVEL_MIN		1
+#define ZBX_COMPRESS_LEVEL_MAX		9
+
+void	zbx_compress_set_level(int level);
 int	zbx_compress(const char *in, size_t size_in, char **out, size_t *size_out);
+int	zbx_compress_gzip(const char *in, size_t size_in, char **out, size_t *size_out);
 int	zbx_uncompress(const char *in, size_t size_in, char *out, size_t *size_out);
 const char	*zbx_compress_strerror(void);
 
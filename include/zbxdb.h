@@ -60,6 +60,7 @@ typedef struct
 	unsigned int	dbport;
 	int		log_slow_queries;
 	int		read_only_recoverable;
+	int		bulk_load;
 }
 zbx_db_config_t;
 
@@ -279,6 +280,8 @@ typedef struct
 	/* the last id assigned by autoincrement */
 	zbx_uint64_t			lastid;
 	char				*clause;
+	/* load rows with database bulk load interface instead of insert statements */
+	int				bulk_load;
 }
 zbx_db_insert_t;
 
@@ -293,6 +296,7 @@ void	zbx_dbconn_set_autoincrement(zbx_dbconn_t *db, int options);
 
 int	zbx_dbconn_open(zbx_dbconn_t *db);
 void 	zbx_dbconn_close(zbx_dbconn_t *db);
+void	zbx_db_thread_deinit(void);
 
 int	zbx_dbconn_execute(zbx_dbconn_t *db, const char *fmt, ...);
 int	zbx_dbconn_vexecute(zbx_dbconn_t *db, const char *fmt, va_list args);
@@ -325,6 +329,9 @@ zbx_uint64_t	zbx_db_insert_get_lastid(zbx_db_insert_t *self);
 void	zbx_db_insert_clean(zbx_db_insert_t *db_insert);
 void	zbx_db_insert_set_batch_size(zbx_db_insert_t *self, int batch_size);
 int	zbx_db_insert_get_row_count(zbx_db_insert_t *self);
+void	zbx_db_insert_remove_row(zbx_db_insert_t *self, int index);
+void	zbx_db_insert_set_dbconn(zbx_db_insert_t *self, zbx_dbconn_t *db);
+void	zbx_db_insert_set_bulk_load(zbx_db_insert_t *self);
 
 void	zbx_dbconn_extract_version_info(zbx_dbconn_t *db, struct zbx_db_version_info_t *version_info);
 
@@ -325,6 +325,8 @@ zbx_eval_count_pattern_data_t;
 
 int	zbx_init_count_pattern(char *operator, char *pattern, unsigned char value_type,
 		zbx_eval_count_pattern_data_t *pdata, char **error);
+int	zbx_count_var_with_pattern(zbx_eval_count_pattern_data_t *pdata, const char *pattern,
+		const zbx_variant_t *value, int *count, char **error);
 int	zbx_count_var_vector_with_pattern(zbx_eval_count_pattern_data_t *pdata, char *pattern, zbx_vector_var_t *values,
 		int limit, int *count, char **error);
 void	zbx_clear_count_pattern(zbx_eval_count_pattern_data_t *pdata);
@@ -23,9 +23,13 @@
 
 typedef struct
 {
-	char	*name;
-	FILE	*file;
-	int	missing;
+	char		*name;
+	int		fd;
+	int		missing;
+	int		checked;
+	zbx_uint64_t	size;
+	char		*buf;
+	size_t		buf_offset;
 }
 zbx_export_file_t;
 
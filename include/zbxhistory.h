@@ -48,7 +48,8 @@ void	zbx_history_value2variant(const zbx_history_value_t *value, unsigned char v
 #define zbx_history_record_vector_create(vector)	zbx_vector_history_record_create(vector)
 
 int	zbx_history_init(const char *config_history_storage_url, const char *config_history_storage_opts,
-		int config_log_slow_queries, char **error);
+		const char *config_history_storage_path, const char *config_history_storage_path_opts,
+		int config_log_slow_queries, int config_history_writers, char **error);
 void	zbx_history_destroy(void);
 
 typedef struct
@@ -23,6 +23,7 @@ typedef struct
 	const char	*config_ssl_ca_location;
 	const char	*config_ssl_cert_location;
 	const char	*config_ssl_key_location;
+	int		config_max_concurrent_checks_per_poller;
 }
 zbx_thread_httppoller_args;
 
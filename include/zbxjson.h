@@ -360,6 +360,25 @@ int		zbx_json_open_path(const struct zbx_json_parse *jp, const char *path, struc
 zbx_json_type_t	zbx_json_valuetype(const char *p);
 struct zbx_json	*zbx_json_clone(const struct zbx_json *src);
 
+/* object member index for repeated lookups by name in large objects */
+typedef struct
+{
+	struct zbx_json_parse	jp;
+	zbx_hashset_t		pairs;
+	unsigned char		indexed;
+}
+zbx_json_index_t;
+
+void		zbx_json_index_init(zbx_json_index_t *index, const struct zbx_json_parse *jp);
+void		zbx_json_index_destroy(zbx_json_index_t *index);
+const char	*zbx_json_index_pair_by_name(zbx_json_index_t *index, const char *name);
+int		zbx_json_index_value_by_name(zbx_json_index_t *index, const char *name, char *string, size_t len,
+		zbx_json_type_t *type);
+int		zbx_json_index_value_by_name_dyn(zbx_json_index_t *index, const char *name, char **string,
+		size_t *string_alloc, zbx_json_type_t *type);
+int		zbx_json_index_brackets_by_name(zbx_json_index_t *index, const char *name,
+		struct zbx_json_parse *out);
+
 /* jsonpath support */
 
 typedef struct zbx_jsonpath_segment zbx_jsonpath_segment_t;
@@ -43,6 +43,7 @@ typedef enum
 	ZBX_MUTEX_VMWARE,
 	ZBX_MUTEX_SQLITE3,
 	ZBX_MUTEX_PROCSTAT,
+	ZBX_MUTEX_PROCSNAP,
 	ZBX_MUTEX_PROXY_HISTORY,
 #ifdef HAVE_VMINFO_T_UPDATES
 	ZBX_MUTEX_KSTAT,
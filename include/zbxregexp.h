@@ -60,6 +60,7 @@ int	zbx_mregexp_sub_precompiled(const char *string, const zbx_regexp_t *regexp,
 		size_t limit, char **out);
 int	zbx_regexp_repl(const char *string, const char *pattern, const char *repl_template, char **out);
 void	zbx_regexp_clean_expressions(zbx_vector_expression_t *expressions);
+void	zbx_regexp_cache_get_stats(zbx_uint64_t *hits, zbx_uint64_t *misses);
 
 void	zbx_add_regexp_ex(zbx_vector_expression_t *regexps, const char *name, const char *expression,
 		int expression_type, char exp_delimiter, int case_sensitive);
@@ -71,6 +72,7 @@ int	zbx_regexp_sub_ex2(const zbx_vector_expression_t *regexps, const char *strin
 		int case_sensitive, const char *output_template, char **output, char **err_msg);
 int	zbx_global_regexp_exists(const char *name, const zbx_vector_expression_t *regexps);
 void	zbx_regexp_escape(char **string);
+char	*zbx_regexp_extract_literal(const char *pattern);
 
 /* wildcards */
 void	zbx_wildcard_minimize(char *str);
@@ -31,11 +31,31 @@ ZBX_PTR_VECTOR_DECL(db_service, zbx_db_service *)
 #define ZBX_IPC_SERVICE_RELOAD_CACHE			7
 #define ZBX_IPC_SERVICE_SERVICE_EVENTS_SUPPRESS		8
 #define ZBX_IPC_SERVICE_SERVICE_EVENTS_UNSUPPRESS	9
+#define ZBX_IPC_SERVICE_SERVICE_DIAG_STATS		10
 
 void	zbx_service_flush(zbx_uint32_t code, unsigned char *data, zbx_uint32_t size);
 void	zbx_service_send(zbx_uint32_t code, unsigned char *data, zbx_uint32_t size, zbx_ipc_message_t *response);
 void	zbx_service_reload_cache(void);
 
+/* service manager diagnostic statistics */
+typedef struct
+{
+	zbx_uint64_t	services_num;
+	zbx_uint64_t	problems_num;
+	zbx_uint64_t	batches_num;	/* number of processed event batches */
+	zbx_uint64_t	evaluated_num;	/* number of service status evaluations */
+	zbx_uint64_t	updates_num;	/* number of service status changes */
+	zbx_uint64_t	lag_num;	/* number of lag measurements */
+	double		recalc_time;	/* time spent recalculating service statuses */
+	double		db_time;	/* time spent writing service changes to database */
+	double		lag_last;	/* lag between problem event and service update */
+	double		lag_max;
+	double		lag_total;
+}
+zbx_service_diag_stats_t;
+
+int	zbx_service_get_diag_stats(zbx_service_diag_stats_t *stats, char **error);
+
 typedef struct
 {
 	zbx_uint64_t	eventid;
@@ -71,4 +91,7 @@ zbx_uint32_t	zbx_service_serialize_event_severities(unsigned char **data,
 void	zbx_service_deserialize_event_severities(const unsigned char *data,
 		zbx_vector_event_severity_ptr_t *event_severities);
 
+zbx_uint32_t	zbx_service_serialize_diag_stats(unsigned char **data, const zbx_service_diag_stats_t *stats);
+void	zbx_service_deserialize_diag_stats(const unsigned char *data, zbx_service_diag_stats_t *stats);
+
 #endif /* ZABBIX_ZBXSERVICE_H */
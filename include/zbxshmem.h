@@ -23,6 +23,10 @@
 #define SHMEM_MAX_BUCKET_SIZE		256 /* starting from this size all free chunks are put into the same bucket */
 #define ZBX_SHMEM_BUCKET_COUNT		((SHMEM_MAX_BUCKET_SIZE - ZBX_SHMEM_MIN_BUCKET_SIZE) / 8 + 1)
 
+/* large free chunk allocation strategies */
+#define ZBX_SHMEM_ALLOC_FIRSTFIT	0	/* large free chunks are kept in a single list */
+#define ZBX_SHMEM_ALLOC_BESTFIT		1	/* large free chunks are kept in a size indexed tree */
+
 typedef struct
 {
 	void		*base;
@@ -40,6 +44,9 @@ typedef struct
 	/* Set this flag to 1 to allow execution in out of memory situations.     */
 	char		allow_oom;
 
+	/* allocation strategy for free chunks not fitting into size buckets (ZBX_SHMEM_ALLOC_*) */
+	unsigned char	alloc_mode;
+
 	const char	*mem_descr;
 	const char	*mem_param;
 }
@@ -55,11 +62,13 @@ typedef struct
 	unsigned int	chunks_num[ZBX_SHMEM_BUCKET_COUNT];
 	unsigned int	free_chunks;
 	unsigned int	used_chunks;
+	unsigned char	alloc_mode;
+	double		fragmentation;	/* percentage of free memory outside the largest free chunk */
 }
 zbx_shmem_stats_t;
 
 int	zbx_shmem_create(zbx_shmem_info_t **info, zbx_uint64_t size, const char *descr, const char *param,
-		int allow_oom, char **error);
+		int allow_oom, unsigned char alloc_mode, char **error);
 int	zbx_shmem_create_min(zbx_shmem_info_t **info, zbx_uint64_t size, const char *descr, const char *param,
 		int allow_oom, char **error);
 void	zbx_shmem_destroy(zbx_shmem_info_t *info);
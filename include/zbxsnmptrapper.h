@@ -21,6 +21,9 @@ typedef struct
 {
 	const char	*config_snmptrap_file;
 	const char	*config_ha_node_name;
+	int		config_snmptrap_listen_port;
+	const char	*config_snmptrap_listen_community;
+	const char	*progname;
 }
 zbx_thread_snmptrapper_args;
 
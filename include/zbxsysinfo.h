@@ -149,7 +149,7 @@ void		zbx_deinit_modbus(void);
 /* stats */
 ZBX_THREAD_ENTRY(zbx_collector_thread, args);
 
-int	zbx_init_collector_data(char **error);
+int	zbx_init_collector_data(int config_process_snapshot_interval, char **error);
 void	zbx_free_collector_data(void);
 
 #if defined(_WINDOWS)
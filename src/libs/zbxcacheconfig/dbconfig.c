@@ -163,6 +163,12 @@ int	zbx_get_sync_in_progress(void)
 #define START_SYNC	do { WRLOCK_CACHE_CONFIG_HISTORY; WRLOCK_CACHE; sync_in_progress = 1; } while(0)
 #define FINISH_SYNC	do { sync_in_progress = 0; UNLOCK_CACHE; UNLOCK_CACHE_CONFIG_HISTORY; } while(0)
 
+/* table groups loaded in parallel during initial configuration sync */
+#define ZBX_DBSYNC_GROUP_HOSTS		0
+#define ZBX_DBSYNC_GROUP_ITEMS		1
+#define ZBX_DBSYNC_GROUP_TRIGGERS	2
+#define ZBX_DBSYNC_GROUP_ACTIONS	3
+
 #define ZBX_SNMP_OID_TYPE_NORMAL	0
 #define ZBX_SNMP_OID_TYPE_DYNAMIC	1
 #define ZBX_SNMP_OID_TYPE_MACRO		2
@@ -3252,6 +3258,47 @@ static void	process_zero_pollers_items(ZBX_DC_ITEM *item)
 	}
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: updates revision of LLD rule                                      *
+ *                                                                            *
+ * Parameters: itemid   - [IN] LLD rule identifier                            *
+ *             revision - [IN] configuration revision                         *
+ *                                                                            *
+ * Comments: Item prototypes do not have their own revisions, so changes of   *
+ *           item prototypes are tracked by revision of their LLD rule.       *
+ *                                                                            *
+ ******************************************************************************/
+static void	dc_lld_rule_update_revision(zbx_uint64_t itemid, zbx_uint64_t revision)
+{
+	ZBX_DC_ITEM	*item;
+
+	if (NULL != (item = (ZBX_DC_ITEM *)zbx_hashset_search(&config->items, &itemid)) &&
+			0 != (item->flags & ZBX_FLAG_DISCOVERY_RULE))
+	{
+		item->revision = revision;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: updates revision of LLD rule the item prototype belongs to        *
+ *                                                                            *
+ * Parameters: itemid   - [IN] item prototype identifier                      *
+ *             revision - [IN] configuration revision                         *
+ *                                                                            *
+ ******************************************************************************/
+static void	dc_prototype_update_lld_rule_revision(zbx_uint64_t itemid, zbx_uint64_t revision)
+{
+	const ZBX_DC_ITEM_DISCOVERY	*item_discovery;
+
+	if (NULL != (item_discovery = (const ZBX_DC_ITEM_DISCOVERY *)zbx_hashset_search(&config->item_discovery,
+			&itemid)))
+	{
+		dc_lld_rule_update_revision(item_discovery->parent_itemid, revision);
+	}
+}
+
 static void	DCsync_items(zbx_dbsync_t *sync, zbx_uint64_t revision, zbx_synced_new_config_t synced,
 		zbx_vector_uint64_t *deleted_itemids, zbx_vector_dc_item_ptr_t *new_items)
 {
@@ -3315,6 +3362,9 @@ static void	DCsync_items(zbx_dbsync_t *sync, zbx_uint64_t revision, zbx_synced_n
 			template_item->hostid = hostid;
 			template_item->templateid = templateid;
 
+			if (0 != (atoi(row[18]) & ZBX_FLAG_DISCOVERY_PROTOTYPE))
+				dc_prototype_update_lld_rule_revision(itemid, revision);
+
 			continue;
 		}
 
@@ -3617,6 +3667,7 @@ static void	DCsync_items(zbx_dbsync_t *sync, zbx_uint64_t revision, zbx_synced_n
 		if (NULL != (template_item = (ZBX_DC_TEMPLATE_ITEM *)zbx_hashset_search(&config->template_items,
 				&rowid)))
 		{
+			dc_prototype_update_lld_rule_revision(rowid, revision);
 			zbx_hashset_remove_direct(&config->template_items, template_item);
 		}
 
@@ -3722,7 +3773,7 @@ static void	DCsync_items(zbx_dbsync_t *sync, zbx_uint64_t revision, zbx_synced_n
 }
 #undef DUMP_HASHMAP
 
-static void	DCsync_item_discovery(zbx_dbsync_t *sync)
+static void	DCsync_item_discovery(zbx_dbsync_t *sync, zbx_uint64_t revision)
 {
 	char			**row;
 	zbx_uint64_t		rowid, itemid;
@@ -3756,8 +3807,13 @@ static void	DCsync_item_discovery(zbx_dbsync_t *sync)
 		item_discovery = (ZBX_DC_ITEM_DISCOVERY *)DCfind_id_ext(&config->item_discovery, itemid,
 				sizeof(ZBX_DC_ITEM_DISCOVERY), &found, uniq);
 
+		/* item prototype was added to or moved between LLD rules */
+		if (0 != found)
+			dc_lld_rule_update_revision(item_discovery->parent_itemid, revision);
+
 		/* LLD item prototype */
 		ZBX_STR2UINT64(item_discovery->parent_itemid, row[1]);
+		dc_lld_rule_update_revision(item_discovery->parent_itemid, revision);
 	}
 
 	for (; SUCCEED == ret; ret = zbx_dbsync_next(sync, &rowid, &row, &tag))
@@ -3768,6 +3824,7 @@ static void	DCsync_item_discovery(zbx_dbsync_t *sync)
 			continue;
 		}
 
+		dc_lld_rule_update_revision(item_discovery->parent_itemid, revision);
 		zbx_hashset_remove_direct(&config->item_discovery, item_discovery);
 	}
 
@@ -7614,8 +7671,8 @@ zbx_uint64_t	zbx_dc_sync_configuration(unsigned char mode, zbx_synced_new_config
 	zbx_dbsync_init_changelog(&hp_sync, "host_proxy", changelog_sync_mode);
 	zbx_dbsync_init(&hi_sync, "host_inventory", mode);
 	zbx_dbsync_init(&htmpl_sync, "hosts_templates", mode);
-	zbx_dbsync_init(&gmacro_sync, "globalmacro", mode);
-	zbx_dbsync_init(&hmacro_sync, "hostmacro", mode);
+	zbx_dbsync_init_changelog(&gmacro_sync, "globalmacro", mode);
+	zbx_dbsync_init_changelog(&hmacro_sync, "hostmacro", mode);
 	zbx_dbsync_init(&if_sync, "interface", mode);
 	zbx_dbsync_init_changelog(&items_sync, "items", changelog_sync_mode);
 	zbx_dbsync_init(&item_discovery_sync, "item_discovery", mode);
@@ -7637,7 +7694,7 @@ zbx_uint64_t	zbx_dc_sync_configuration(unsigned char mode, zbx_synced_new_config
 	zbx_dbsync_init(&correlation_sync, "correlation", mode);
 	zbx_dbsync_init(&corr_condition_sync, "corr_condition", mode);
 	zbx_dbsync_init(&corr_operation_sync, "corr_operation", mode);
-	zbx_dbsync_init(&hgroups_sync, "hstgrp", mode);
+	zbx_dbsync_init_changelog(&hgroups_sync, "hstgrp", mode);
 	zbx_dbsync_init(&hgroup_host_sync, "hosts_groups", mode);
 	zbx_dbsync_init_changelog(&itempp_sync, "item_preproc", changelog_sync_mode);
 	zbx_dbsync_init(&itemscrp_sync, "item_parameter", mode);
@@ -7719,52 +7776,97 @@ zbx_uint64_t	zbx_dc_sync_configuration(unsigned char mode, zbx_synced_new_config
 		goto clean;
 	}
 
+	/* During initial sync the changesets only select data, so the database queries of independent table */
+	/* groups are executed in parallel and the data is fetched later when applying changesets.            */
+	if (ZBX_DBSYNC_INIT == mode)
+	{
+		zbx_dbsync_task_t	tasks[] = {
+			{&proxy_sync, zbx_dbsync_compare_proxies, ZBX_DBSYNC_GROUP_HOSTS},
+			{&hosts_sync, zbx_dbsync_compare_hosts, ZBX_DBSYNC_GROUP_HOSTS},
+			{&hi_sync, zbx_dbsync_compare_host_inventory, ZBX_DBSYNC_GROUP_HOSTS},
+			{&hgroups_sync, zbx_dbsync_compare_host_groups, ZBX_DBSYNC_GROUP_HOSTS},
+			{&hgroup_host_sync, zbx_dbsync_compare_host_group_hosts, ZBX_DBSYNC_GROUP_HOSTS},
+			{&hp_sync, zbx_dbsync_prepare_host_proxy, ZBX_DBSYNC_GROUP_HOSTS},
+			{&if_sync, zbx_dbsync_compare_interfaces, ZBX_DBSYNC_GROUP_HOSTS},
+			{&items_sync, zbx_dbsync_compare_items, ZBX_DBSYNC_GROUP_ITEMS},
+			{&item_discovery_sync, zbx_dbsync_compare_item_discovery, ZBX_DBSYNC_GROUP_ITEMS},
+			{&itempp_sync, zbx_dbsync_compare_item_preprocs, ZBX_DBSYNC_GROUP_ITEMS},
+			{&itemscrp_sync, zbx_dbsync_compare_item_script_param, ZBX_DBSYNC_GROUP_ITEMS},
+			{&item_tag_sync, zbx_dbsync_compare_item_tags, ZBX_DBSYNC_GROUP_ITEMS},
+			{&triggers_sync, zbx_dbsync_compare_triggers, ZBX_DBSYNC_GROUP_TRIGGERS},
+			{&func_sync, zbx_dbsync_compare_functions, ZBX_DBSYNC_GROUP_TRIGGERS},
+			{&tdep_sync, zbx_dbsync_compare_trigger_dependency, ZBX_DBSYNC_GROUP_TRIGGERS},
+			{&trigger_tag_sync, zbx_dbsync_compare_trigger_tags, ZBX_DBSYNC_GROUP_TRIGGERS},
+			{&expr_sync, zbx_dbsync_compare_expressions, ZBX_DBSYNC_GROUP_TRIGGERS},
+			{&action_sync, zbx_dbsync_compare_actions, ZBX_DBSYNC_GROUP_ACTIONS},
+			{&action_condition_sync, zbx_dbsync_compare_action_conditions, ZBX_DBSYNC_GROUP_ACTIONS},
+			{&correlation_sync, zbx_dbsync_compare_correlations, ZBX_DBSYNC_GROUP_ACTIONS},
+			{&corr_condition_sync, zbx_dbsync_compare_corr_conditions, ZBX_DBSYNC_GROUP_ACTIONS},
+			{&corr_operation_sync, zbx_dbsync_compare_corr_operations, ZBX_DBSYNC_GROUP_ACTIONS},
+			{&maintenance_sync, zbx_dbsync_compare_maintenances, ZBX_DBSYNC_GROUP_ACTIONS},
+			{&maintenance_tag_sync, zbx_dbsync_compare_maintenance_tags, ZBX_DBSYNC_GROUP_ACTIONS},
+			{&maintenance_period_sync, zbx_dbsync_compare_maintenance_periods, ZBX_DBSYNC_GROUP_ACTIONS},
+			{&maintenance_group_sync, zbx_dbsync_compare_maintenance_groups, ZBX_DBSYNC_GROUP_ACTIONS},
+			{&maintenance_host_sync, zbx_dbsync_compare_maintenance_hosts, ZBX_DBSYNC_GROUP_ACTIONS},
+			{&drules_sync, zbx_dbsync_prepare_drules, ZBX_DBSYNC_GROUP_ACTIONS},
+			{&dchecks_sync, zbx_dbsync_prepare_dchecks, ZBX_DBSYNC_GROUP_ACTIONS},
+			{&httptest_sync, zbx_dbsync_prepare_httptests, ZBX_DBSYNC_GROUP_ACTIONS},
+			{&httptest_field_sync, zbx_dbsync_prepare_httptest_fields, ZBX_DBSYNC_GROUP_ACTIONS},
+			{&httpstep_sync, zbx_dbsync_prepare_httpsteps, ZBX_DBSYNC_GROUP_ACTIONS},
+			{&httpstep_field_sync, zbx_dbsync_prepare_httpstep_fields, ZBX_DBSYNC_GROUP_ACTIONS},
+			{&connector_sync, zbx_dbsync_compare_connectors, ZBX_DBSYNC_GROUP_ACTIONS},
+			{&connector_tag_sync, zbx_dbsync_compare_connector_tags, ZBX_DBSYNC_GROUP_ACTIONS}
+		};
+
+		zbx_dbsync_prefetch(tasks, (int)ARRSIZE(tasks));
+	}
+
 	/* sync host data to support host lookups when resolving macros during configuration sync */
-	if (FAIL == zbx_dbsync_compare_proxies(&proxy_sync))
+	if (FAIL == zbx_dbsync_compare(&proxy_sync, zbx_dbsync_compare_proxies))
 		goto out;
 
-	if (FAIL == zbx_dbsync_compare_hosts(&hosts_sync))
+	if (FAIL == zbx_dbsync_compare(&hosts_sync, zbx_dbsync_compare_hosts))
 		goto out;
 
-	if (FAIL == zbx_dbsync_compare_host_inventory(&hi_sync))
+	if (FAIL == zbx_dbsync_compare(&hi_sync, zbx_dbsync_compare_host_inventory))
 		goto out;
 
-	if (FAIL == zbx_dbsync_compare_host_groups(&hgroups_sync))
+	if (FAIL == zbx_dbsync_compare(&hgroups_sync, zbx_dbsync_compare_host_groups))
 		goto out;
-	if (FAIL == zbx_dbsync_compare_host_group_hosts(&hgroup_host_sync))
+	if (FAIL == zbx_dbsync_compare(&hgroup_host_sync, zbx_dbsync_compare_host_group_hosts))
 		goto out;
 
-	if (FAIL == zbx_dbsync_compare_maintenances(&maintenance_sync))
+	if (FAIL == zbx_dbsync_compare(&maintenance_sync, zbx_dbsync_compare_maintenances))
 		goto out;
-	if (FAIL == zbx_dbsync_compare_maintenance_tags(&maintenance_tag_sync))
+	if (FAIL == zbx_dbsync_compare(&maintenance_tag_sync, zbx_dbsync_compare_maintenance_tags))
 		goto out;
-	if (FAIL == zbx_dbsync_compare_maintenance_periods(&maintenance_period_sync))
+	if (FAIL == zbx_dbsync_compare(&maintenance_period_sync, zbx_dbsync_compare_maintenance_periods))
 		goto out;
-	if (FAIL == zbx_dbsync_compare_maintenance_groups(&maintenance_group_sync))
+	if (FAIL == zbx_dbsync_compare(&maintenance_group_sync, zbx_dbsync_compare_maintenance_groups))
 		goto out;
-	if (FAIL == zbx_dbsync_compare_maintenance_hosts(&maintenance_host_sync))
+	if (FAIL == zbx_dbsync_compare(&maintenance_host_sync, zbx_dbsync_compare_maintenance_hosts))
 		goto out;
 
-	if (FAIL == zbx_dbsync_prepare_drules(&drules_sync))
+	if (FAIL == zbx_dbsync_compare(&drules_sync, zbx_dbsync_prepare_drules))
 		goto out;
-	if (FAIL == zbx_dbsync_prepare_dchecks(&dchecks_sync))
+	if (FAIL == zbx_dbsync_compare(&dchecks_sync, zbx_dbsync_prepare_dchecks))
 		goto out;
 
-	if (FAIL == zbx_dbsync_prepare_httptests(&httptest_sync))
+	if (FAIL == zbx_dbsync_compare(&httptest_sync, zbx_dbsync_prepare_httptests))
 		goto out;
-	if (FAIL == zbx_dbsync_prepare_httptest_fields(&httptest_field_sync))
+	if (FAIL == zbx_dbsync_compare(&httptest_field_sync, zbx_dbsync_prepare_httptest_fields))
 		goto out;
-	if (FAIL == zbx_dbsync_prepare_httpsteps(&httpstep_sync))
+	if (FAIL == zbx_dbsync_compare(&httpstep_sync, zbx_dbsync_prepare_httpsteps))
 		goto out;
-	if (FAIL == zbx_dbsync_prepare_httpstep_fields(&httpstep_field_sync))
+	if (FAIL == zbx_dbsync_compare(&httpstep_field_sync, zbx_dbsync_prepare_httpstep_fields))
 		goto out;
 
-	if (FAIL == zbx_dbsync_compare_connectors(&connector_sync))
+	if (FAIL == zbx_dbsync_compare(&connector_sync, zbx_dbsync_compare_connectors))
 		goto out;
-	if (FAIL == zbx_dbsync_compare_connector_tags(&connector_tag_sync))
+	if (FAIL == zbx_dbsync_compare(&connector_tag_sync, zbx_dbsync_compare_connector_tags))
 		goto out;
 
-	if (FAIL == zbx_dbsync_prepare_host_proxy(&hp_sync))
+	if (FAIL == zbx_dbsync_compare(&hp_sync, zbx_dbsync_prepare_host_proxy))
 		goto out;
 
 	zbx_hashset_create(&psk_owners, 0, ZBX_DEFAULT_PTR_HASH_FUNC, ZBX_DEFAULT_PTR_COMPARE_FUNC);
@@ -7816,22 +7918,22 @@ zbx_uint64_t	zbx_dc_sync_configuration(unsigned char mode, zbx_synced_new_config
 
 	/* sync item data to support item lookups when resolving macros during configuration sync */
 
-	if (FAIL == zbx_dbsync_compare_interfaces(&if_sync))
+	if (FAIL == zbx_dbsync_compare(&if_sync, zbx_dbsync_compare_interfaces))
 		goto out;
 
-	if (FAIL == zbx_dbsync_compare_items(&items_sync))
+	if (FAIL == zbx_dbsync_compare(&items_sync, zbx_dbsync_compare_items))
 		goto out;
 
-	if (FAIL == zbx_dbsync_compare_item_discovery(&item_discovery_sync))
+	if (FAIL == zbx_dbsync_compare(&item_discovery_sync, zbx_dbsync_compare_item_discovery))
 		goto out;
 
-	if (FAIL == zbx_dbsync_compare_item_preprocs(&itempp_sync))
+	if (FAIL == zbx_dbsync_compare(&itempp_sync, zbx_dbsync_compare_item_preprocs))
 		goto out;
 
-	if (FAIL == zbx_dbsync_compare_item_script_param(&itemscrp_sync))
+	if (FAIL == zbx_dbsync_compare(&itemscrp_sync, zbx_dbsync_compare_item_script_param))
 		goto out;
 
-	if (FAIL == zbx_dbsync_compare_functions(&func_sync))
+	if (FAIL == zbx_dbsync_compare(&func_sync, zbx_dbsync_compare_functions))
 		goto out;
 
 	START_SYNC;
@@ -7841,7 +7943,7 @@ zbx_uint64_t	zbx_dc_sync_configuration(unsigned char mode, zbx_synced_new_config
 
 	/* relies on hosts, proxies and interfaces, must be after DCsync_{hosts,interfaces}() */
 	DCsync_items(&items_sync, new_revision, synced, deleted_itemids, pnew_items);
-	DCsync_item_discovery(&item_discovery_sync);
+	DCsync_item_discovery(&item_discovery_sync, new_revision);
 
 	/* relies on items, must be after DCsync_items() */
 	DCsync_item_preproc(&itempp_sync, new_revision);
@@ -7862,38 +7964,38 @@ zbx_uint64_t	zbx_dc_sync_configuration(unsigned char mode, zbx_synced_new_config
 	zbx_dc_flush_history();	/* misconfigured items generate pseudo-historic values to become notsupported */
 
 	/* sync rest of the data */
-	if (FAIL == zbx_dbsync_compare_triggers(&triggers_sync))
+	if (FAIL == zbx_dbsync_compare(&triggers_sync, zbx_dbsync_compare_triggers))
 		goto out;
 
-	if (FAIL == zbx_dbsync_compare_trigger_dependency(&tdep_sync))
+	if (FAIL == zbx_dbsync_compare(&tdep_sync, zbx_dbsync_compare_trigger_dependency))
 		goto out;
 
-	if (FAIL == zbx_dbsync_compare_expressions(&expr_sync))
+	if (FAIL == zbx_dbsync_compare(&expr_sync, zbx_dbsync_compare_expressions))
 		goto out;
 
-	if (FAIL == zbx_dbsync_compare_actions(&action_sync))
+	if (FAIL == zbx_dbsync_compare(&action_sync, zbx_dbsync_compare_actions))
 		goto out;
 
 	if (FAIL == zbx_dbsync_compare_action_ops(&action_op_sync))
 		goto out;
 
-	if (FAIL == zbx_dbsync_compare_action_conditions(&action_condition_sync))
+	if (FAIL == zbx_dbsync_compare(&action_condition_sync, zbx_dbsync_compare_action_conditions))
 		goto out;
 
-	if (FAIL == zbx_dbsync_compare_trigger_tags(&trigger_tag_sync))
+	if (FAIL == zbx_dbsync_compare(&trigger_tag_sync, zbx_dbsync_compare_trigger_tags))
 		goto out;
 
 	/* relies on items, must be after DCsync_items() */
-	if (FAIL == zbx_dbsync_compare_item_tags(&item_tag_sync))
+	if (FAIL == zbx_dbsync_compare(&item_tag_sync, zbx_dbsync_compare_item_tags))
 		goto out;
 
-	if (FAIL == zbx_dbsync_compare_correlations(&correlation_sync))
+	if (FAIL == zbx_dbsync_compare(&correlation_sync, zbx_dbsync_compare_correlations))
 		goto out;
 
-	if (FAIL == zbx_dbsync_compare_corr_conditions(&corr_condition_sync))
+	if (FAIL == zbx_dbsync_compare(&corr_condition_sync, zbx_dbsync_compare_corr_conditions))
 		goto out;
 
-	if (FAIL == zbx_dbsync_compare_corr_operations(&corr_operation_sync))
+	if (FAIL == zbx_dbsync_compare(&corr_operation_sync, zbx_dbsync_compare_corr_operations))
 		goto out;
 
 	START_SYNC;
@@ -8119,6 +8221,9 @@ out:
 
 	config->status->last_update = 0;
 	config->sync_ts = time(NULL);
+	config->sync_stats_num = zbx_dcsync_stats_copy(config->sync_stats, ZBX_DC_SYNC_STATS_MAX);
+	config->sync_changelog_num = changelog_num;
+	config->sync_changelog_time = changelog_sec;
 
 	if (0 == (get_program_type_cb() & ZBX_PROGRAM_TYPE_SERVER))
 		dc_update_proxy_failover_delay();
@@ -8614,7 +8719,7 @@ int	zbx_init_configuration_cache(zbx_get_program_type_f get_program_type, zbx_ge
 		goto out;
 
 	if (SUCCEED != (ret = zbx_shmem_create(&config_mem, conf_cache_size, "configuration cache",
-			"CacheSize", 0, error)))
+			"CacheSize", 0, ZBX_SHMEM_ALLOC_BESTFIT, error)))
 	{
 		goto out;
 	}
@@ -8813,6 +8918,9 @@ int	zbx_init_configuration_cache(zbx_get_program_type_f get_program_type, zbx_ge
 	config->proxy_failover_delay = ZBX_PG_DEFAULT_FAILOVER_DELAY;
 	config->proxy_lastonline = 0;
 	config->sync_status = 0;
+	config->sync_stats_num = 0;
+	config->sync_changelog_num = 0;
+	config->sync_changelog_time = 0;
 
 	zbx_dbsync_env_init(config);
 	zbx_hashset_create(&config_private.item_tag_links, 0, ZBX_DEFAULT_UINT64_HASH_FUNC,
@@ -12439,6 +12547,34 @@ int	zbx_dc_config_get_last_sync_time(void)
 	return config->sync_ts;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get per table statistics of the last configuration cache sync     *
+ *                                                                            *
+ * Parameters: stats          - [OUT] the table statistics, must have space   *
+ *                                    for ZBX_DC_SYNC_STATS_MAX elements      *
+ *             changelog_num  - [OUT] the number of changelog records read    *
+ *             changelog_time - [OUT] the time spent reading changelog        *
+ *                                                                            *
+ * Return value: the number of tables in statistics                           *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_dc_config_get_sync_stats(zbx_dc_sync_stats_t *stats, int *changelog_num, double *changelog_time)
+{
+	int	stats_num;
+
+	RDLOCK_CACHE;
+
+	stats_num = config->sync_stats_num;
+	memcpy(stats, config->sync_stats, sizeof(zbx_dc_sync_stats_t) * (size_t)stats_num);
+	*changelog_num = config->sync_changelog_num;
+	*changelog_time = config->sync_changelog_time;
+
+	UNLOCK_CACHE;
+
+	return stats_num;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: Get array of proxies for proxy poller                             *
@@ -16785,6 +16921,41 @@ void	zbx_dc_httptest_queue(time_t now, zbx_uint64_t httptestid, int delay)
 	UNLOCK_CACHE;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get the configuration revision of LLD rule                        *
+ *                                                                            *
+ * Parameters: itemid - [IN] LLD rule identifier                              *
+ *                                                                            *
+ * Return value: The last revision when LLD rule, its item prototypes, host,  *
+ *               user macros or global regular expressions were changed,      *
+ *               0 if LLD rule is not found.                                  *
+ *                                                                            *
+ ******************************************************************************/
+zbx_uint64_t	zbx_dc_get_lld_rule_revision(zbx_uint64_t itemid)
+{
+	const ZBX_DC_ITEM	*item;
+	const ZBX_DC_HOST	*host;
+	zbx_uint64_t		revision = 0;
+
+	RDLOCK_CACHE;
+
+	if (NULL == (item = (const ZBX_DC_ITEM *)zbx_hashset_search(&config->items, &itemid)))
+		goto out;
+
+	revision = MAX(item->revision, config->revision.expression);
+
+	if (NULL != (host = (const ZBX_DC_HOST *)zbx_hashset_search(&config->hosts, &item->hostid)))
+		revision = MAX(revision, host->revision);
+
+	um_cache_get_host_revision(config->um_cache, ZBX_UM_CACHE_GLOBAL_MACRO_HOSTID, &revision);
+	um_cache_get_host_revision(config->um_cache, item->hostid, &revision);
+out:
+	UNLOCK_CACHE;
+
+	return revision;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: get the configuration revision received from server               *
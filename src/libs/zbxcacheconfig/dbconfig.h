@@ -1071,6 +1071,10 @@ typedef struct
 								/* value during next configuration sync	      */
 	int			proxy_lastonline;	/* last server connection timestamp - proxy only */
 	zbx_uint32_t		sync_status;
+	zbx_dc_sync_stats_t	sync_stats[ZBX_DC_SYNC_STATS_MAX];	/* per table statistics of last sync */
+	int			sync_stats_num;
+	int			sync_changelog_num;	/* changelog records read during last sync */
+	double			sync_changelog_time;
 }
 zbx_dc_config_t;
 
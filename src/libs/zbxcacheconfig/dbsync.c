@@ -27,6 +27,7 @@
 #include "zbxinterface.h"
 #include "zbxip.h"
 #include "zbxtime.h"
+#include "zbxthreads.h"
 
 /* global correlation constants */
 #define ZBX_CORRELATION_ENABLED				0
@@ -377,6 +378,8 @@ int	zbx_dbsync_env_prepare(unsigned char mode)
 
 	zbx_hashset_create(&dbsync_env.strpool, 100, dbsync_strpool_hash_func, dbsync_strpool_compare_func);
 
+	dbsync_env.mode = mode;
+
 	for (i = 0; i < ARRSIZE(dbsync_env.journals); i++)
 		dbsync_journal_init(&dbsync_env.journals[i]);
 
@@ -462,7 +465,7 @@ static void	dbsync_env_flush_journal(zbx_dbsync_journal_t *journal)
 	if (0 == journal->changelog.values_num)
 		return;
 
-	objects_num = journal->inserts.values_num + journal->updates.values_num;
+	objects_num = journal->inserts.values_num + journal->updates.values_num + journal->deletes.values_num;
 
 	for (i = 0; i < journal->syncs.values_num; i++)
 		objects_num += journal->syncs.values[i]->rows.values_num;
@@ -486,6 +489,10 @@ static void	dbsync_env_flush_journal(zbx_dbsync_journal_t *journal)
 	for (i = 0; i < journal->updates.values_num; i++)
 		zbx_hashset_insert(&objectids, &journal->updates.values[i], sizeof(journal->updates.values[i]));
 
+	/* deleted objects might be missing from rows if journal was not read because of full table compare */
+	for (i = 0; i < journal->deletes.values_num; i++)
+		zbx_hashset_insert(&objectids, &journal->deletes.values[i], sizeof(journal->deletes.values[i]));
+
 	for (i = 0; i < journal->changelog.values_num; i++)
 	{
 		if (NULL != zbx_hashset_search(&objectids, &journal->changelog.values[i].objectid))
@@ -554,6 +561,31 @@ int	zbx_dbsync_env_changelog_dbsyncs_new_records(void)
 	return FAIL;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: executes select statement with changeset database connection     *
+ *                                                                            *
+ * Comments: Changesets calculated by prefetch threads use the connection of  *
+ *           the thread, other changesets use the default connection.         *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_db_result_t	dbsync_select(zbx_dbsync_t *sync, const char *fmt, ...)
+{
+	va_list		args;
+	zbx_db_result_t	result;
+
+	va_start(args, fmt);
+
+	if (NULL != sync->db)
+		result = zbx_dbconn_vselect(sync->db, fmt, args);
+	else
+		result = zbx_db_vselect(fmt, args);
+
+	va_end(args);
+
+	return result;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: get rows changed since last sync                                  *
@@ -580,7 +612,7 @@ static int	dbsync_get_rows(zbx_dbsync_t *sync, char **sql, size_t *sql_alloc, si
 		if (NULL != order_field)
 			zbx_snprintf_alloc(sql, sql_alloc, sql_offset, " order by %s", order_field);
 
-		if (NULL == (result = zbx_db_select("%s", *sql)))
+		if (NULL == (result = dbsync_select(sync, "%s", *sql)))
 			return FAIL;
 
 		*sql_offset = sql_offset_reset;
@@ -662,6 +694,47 @@ static int	dbsync_read_journal(zbx_dbsync_t *sync, char **sql, size_t *sql_alloc
 	return SUCCEED;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: check if table must be compared with cache instead of reading     *
+ *          the objects registered in changelog journal                       *
+ *                                                                            *
+ * Parameters: sync        - [IN/OUT] the changeset                           *
+ *             journal     - [IN] the table changelog journal                 *
+ *             objects_num - [IN] the number of cached objects                *
+ *                                                                            *
+ * Return value: SUCCEED - the whole table must be compared with cache        *
+ *               FAIL    - the changelog journal must be used                 *
+ *                                                                            *
+ * Comments: Changelog is not available until it has been initialized by     *
+ *           full sync. Also reading objects by identifier batches becomes    *
+ *           slower than a single table scan when large part of the table     *
+ *           has been changed (for example after mass update or import).      *
+ *                                                                            *
+ ******************************************************************************/
+static int	dbsync_journal_fallback(zbx_dbsync_t *sync, const zbx_dbsync_journal_t *journal, int objects_num)
+{
+	int	changes_num;
+
+	if (ZBX_DBSYNC_INIT == dbsync_env.mode)
+	{
+		sync->type = ZBX_DBSYNC_TYPE_DIFF;
+		return SUCCEED;
+	}
+
+	changes_num = journal->inserts.values_num + journal->updates.values_num;
+
+	if (ZBX_DBSYNC_BATCH_SIZE >= changes_num || objects_num / 2 >= changes_num)
+		return FAIL;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "%s changelog has %d changed objects out of %d, comparing whole table",
+			sync->from, changes_num, objects_num);
+
+	sync->type = ZBX_DBSYNC_TYPE_FALLBACK;
+
+	return SUCCEED;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: initializes changeset                                             *
@@ -678,6 +751,8 @@ static void	dbsync_init(zbx_dbsync_t *sync, unsigned char mode)
 	sync->sql_time = 0;
 	sync->sync_time = 0;
 	sync->sync_size = 0;
+	sync->prefetched = 0;
+	sync->db = NULL;
 
 	sync->row = NULL;
 	sync->preproc_row_func = NULL;
@@ -834,6 +909,169 @@ int	zbx_dbsync_next(zbx_dbsync_t *sync, zbx_uint64_t *rowid, char ***row, unsign
 	return SUCCEED;
 }
 
+typedef struct
+{
+	int			group;
+	zbx_dbsync_task_t	*tasks;
+	int			tasks_num;
+	pthread_t		thread;
+}
+zbx_dbsync_prefetch_t;
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: calculates changesets of one task group using separate database   *
+ *          connection                                                        *
+ *                                                                            *
+ ******************************************************************************/
+static void	*dbsync_prefetch_entry(void *args)
+{
+	zbx_dbsync_prefetch_t	*prefetch = (zbx_dbsync_prefetch_t *)args;
+	zbx_dbconn_t		*db;
+	sigset_t		mask;
+	int			i, err;
+	double			sec;
+
+	sigemptyset(&mask);
+	sigaddset(&mask, SIGTERM);
+	sigaddset(&mask, SIGUSR1);
+	sigaddset(&mask, SIGUSR2);
+	sigaddset(&mask, SIGHUP);
+	sigaddset(&mask, SIGQUIT);
+	sigaddset(&mask, SIGINT);
+
+	if (0 != (err = pthread_sigmask(SIG_BLOCK, &mask, NULL)))
+		zabbix_log(LOG_LEVEL_WARNING, "cannot block signals: %s", zbx_strerror(err));
+
+	sec = zbx_time();
+
+	db = zbx_dbconn_create();
+	(void)zbx_dbconn_set_connect_options(db, ZBX_DB_CONNECT_ONCE);
+
+	if (ZBX_DB_OK != zbx_dbconn_open(db))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot connect to database, configuration cache group %d will be"
+				" loaded sequentially", prefetch->group);
+		goto out;
+	}
+
+	for (i = 0; i < prefetch->tasks_num; i++)
+	{
+		zbx_dbsync_task_t	*task = &prefetch->tasks[i];
+
+		if (task->group != prefetch->group)
+			continue;
+
+		/* the result sets are fetched later, after the connection is closed */
+		task->sync->db = db;
+		task->sync->prefetch_ret = task->compare_func(task->sync);
+		task->sync->prefetched = 1;
+		task->sync->db = NULL;
+
+		if (FAIL == task->sync->prefetch_ret)
+			break;
+	}
+
+	zbx_dbconn_close(db);
+out:
+	zbx_dbconn_free(db);
+	zbx_db_thread_deinit();
+
+	zabbix_log(LOG_LEVEL_DEBUG, "configuration cache group %d prefetched in " ZBX_FS_DBL " sec", prefetch->group,
+			zbx_time() - sec);
+
+	return NULL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: calculates changesets of independent table groups in parallel     *
+ *                                                                            *
+ * Parameters: tasks     - [IN/OUT] changeset calculation tasks               *
+ *             tasks_num - [IN] number of tasks                               *
+ *                                                                            *
+ * Comments: Each task group is processed by a separate thread with its own   *
+ *           database connection. Only tasks in ZBX_DBSYNC_INIT mode can be   *
+ *           prefetched - they only select data without reading cache, which  *
+ *           is later fetched while applying changesets under cache lock.     *
+ *           Tasks that were not prefetched (thread or connection failure)    *
+ *           are calculated by zbx_dbsync_compare() in the calling thread.    *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_dbsync_prefetch(zbx_dbsync_task_t *tasks, int tasks_num)
+{
+	zbx_dbsync_prefetch_t	*prefetches;
+	int			i, groups_num = 0, err;
+	pthread_attr_t		attr;
+	double			sec;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() tasks:%d", __func__, tasks_num);
+
+	sec = zbx_time();
+
+	for (i = 0; i < tasks_num; i++)
+	{
+		if (ZBX_DBSYNC_INIT != tasks[i].sync->mode)
+		{
+			THIS_SHOULD_NEVER_HAPPEN;
+			goto out;
+		}
+
+		if (tasks[i].group >= groups_num)
+			groups_num = tasks[i].group + 1;
+	}
+
+	prefetches = (zbx_dbsync_prefetch_t *)zbx_malloc(NULL, sizeof(zbx_dbsync_prefetch_t) * (size_t)groups_num);
+
+	zbx_pthread_init_attr(&attr);
+
+	for (i = 0; i < groups_num; i++)
+	{
+		prefetches[i].group = i;
+		prefetches[i].tasks = tasks;
+		prefetches[i].tasks_num = tasks_num;
+
+		if (0 != (err = pthread_create(&prefetches[i].thread, &attr, dbsync_prefetch_entry, &prefetches[i])))
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "cannot create thread: %s", zbx_strerror(err));
+			prefetches[i].tasks_num = 0;
+		}
+	}
+
+	for (i = 0; i < groups_num; i++)
+	{
+		void	*retval;
+
+		if (0 != prefetches[i].tasks_num)
+			pthread_join(prefetches[i].thread, &retval);
+	}
+
+	pthread_attr_destroy(&attr);
+	zbx_free(prefetches);
+out:
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s() groups:%d " ZBX_FS_DBL " sec", __func__, groups_num,
+			zbx_time() - sec);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: calculates changeset unless it was already done by prefetch       *
+ *                                                                            *
+ * Parameters: sync         - [IN/OUT] changeset                              *
+ *             compare_func - [IN] changeset calculation function             *
+ *                                                                            *
+ * Return value: SUCCEED - the changeset was successfully calculated          *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_dbsync_compare(zbx_dbsync_t *sync, zbx_dbsync_compare_func_t compare_func)
+{
+	if (0 != sync->prefetched)
+		return sync->prefetch_ret;
+
+	return compare_func(sync);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: encode serialized expression to be returned as db field           *
@@ -871,7 +1109,7 @@ static char	*encode_expression(const zbx_eval_context_t *ctx)
  *     On success this function produces a changeset with 0 or 1 record       *
  *     because 'config_autoreg_tls' table can have no more than 1 record.     *
  *     If in future you want to support multiple autoregistration PSKs and/or *
- *     select more columns in zbx_db_select() then do not forget to sync      *
+ *     select more columns in dbsync_select() then do not forget to sync      *
  *     changes with DCsync_autoreg_config() !!!                               *
  *                                                                            *
  ******************************************************************************/
@@ -882,11 +1120,11 @@ int	zbx_dbsync_compare_autoreg_psk(zbx_dbsync_t *sync)
 	int		num_records = 0;
 
 	zbx_dcsync_sql_start(sync);
-#define CONFIG_AUTOREG_TLS_FIELD_COUNT	2	/* number of columns in the following zbx_db_select() */
+#define CONFIG_AUTOREG_TLS_FIELD_COUNT	2	/* number of columns in the following dbsync_select() */
 
-	if (NULL == (result = zbx_db_select("select tls_psk_identity,tls_psk"
+	if (NULL == (result = dbsync_select(sync, "select tls_psk_identity,tls_psk"
 			" from config_autoreg_tls"
-			" order by autoreg_tlsid")))	/* if you change number of columns in zbx_db_select(), */
+			" order by autoreg_tlsid")))	/* if you change number of columns in dbsync_select(), */
 							/* adjust CONFIG_AUTOREG_TLS_FIELD_COUNT */
 	{
 		return FAIL;
@@ -950,7 +1188,7 @@ int	zbx_dbsync_compare_autoreg_host(zbx_dbsync_t *sync)
 
 	zbx_dcsync_sql_start(sync);
 
-	if (NULL == (sync->dbresult = zbx_db_select(
+	if (NULL == (sync->dbresult = dbsync_select(sync,
 			"select host,listen_ip,listen_dns,host_metadata,flags,listen_port"
 			" from autoreg_host"
 			" where proxyid is null")))
@@ -995,7 +1233,7 @@ int	zbx_dbsync_compare_hosts(zbx_dbsync_t *sync)
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
-		if (NULL == (sync->dbresult = zbx_db_select("%s", sql)))
+		if (NULL == (sync->dbresult = dbsync_select(sync, "%s", sql)))
 			ret = FAIL;
 		goto out;
 	}
@@ -1071,7 +1309,7 @@ int	zbx_dbsync_compare_host_inventory(zbx_dbsync_t *sync)
 			"poc_2_cell,poc_2_screen,poc_2_notes"
 			" from host_inventory";
 
-	if (NULL == (result = zbx_db_select("%s", sql)))
+	if (NULL == (result = dbsync_select(sync, "%s", sql)))
 	{
 		zbx_dcsync_sql_end(sync);
 		return FAIL;
@@ -1147,7 +1385,7 @@ int	zbx_dbsync_compare_host_templates(zbx_dbsync_t *sync)
 
 	zbx_dcsync_sql_start(sync);
 
-	if (NULL == (result = zbx_db_select(
+	if (NULL == (result = dbsync_select(sync,
 			"select hostid,templateid"
 			" from hosts_templates"
 			" order by hostid")))
@@ -1286,10 +1524,30 @@ int	zbx_dbsync_compare_global_macros(zbx_dbsync_t *sync)
 	zbx_hashset_iter_t	iter;
 	zbx_uint64_t		rowid, *prowid = &rowid;
 	zbx_um_macro_t		**pmacro;
+	zbx_dbsync_journal_t	*journal = &dbsync_env.journals[ZBX_DBSYNC_JOURNAL(ZBX_DBSYNC_OBJ_GLOBALMACRO)];
 
 	zbx_dcsync_sql_start(sync);
 
-	if (NULL == (result = zbx_db_select(
+	if (ZBX_DBSYNC_INIT != sync->mode &&
+			FAIL == dbsync_journal_fallback(sync, journal, dbsync_env.cache->gmacros.num_data))
+	{
+		char	*sql = NULL;
+		size_t	sql_alloc = 0, sql_offset = 0;
+		int	ret;
+
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, "select globalmacroid,macro,value,type from globalmacro");
+		dbsync_prepare(sync, 4, NULL);
+
+		ret = dbsync_read_journal(sync, &sql, &sql_alloc, &sql_offset, "globalmacroid", "where", NULL,
+				journal);
+
+		zbx_free(sql);
+		zbx_dcsync_sql_end(sync);
+
+		return ret;
+	}
+
+	if (NULL == (result = dbsync_select(sync,
 			"select globalmacroid,macro,value,type"
 			" from globalmacro")))
 	{
@@ -1405,7 +1663,38 @@ out:
 
 /******************************************************************************
  *                                                                            *
- * Purpose: compares global macros table with cached configuration data       *
+ * Purpose: adds removed rows for cached macros of deleted hosts              *
+ *                                                                            *
+ * Parameter: sync - [OUT] the changeset                                      *
+ *                                                                            *
+ * Comments: Host macros are removed together with hosts by cascade delete,   *
+ *           which does not fire changelog triggers on all databases.         *
+ *           Duplicate removals are ignored by user macro cache sync.         *
+ *                                                                            *
+ ******************************************************************************/
+static void	dbsync_add_deleted_host_macros(zbx_dbsync_t *sync)
+{
+	const zbx_vector_uint64_t	*hostids = &dbsync_env.journals[ZBX_DBSYNC_JOURNAL(ZBX_DBSYNC_OBJ_HOST)].deletes;
+	zbx_um_host_t			**phost;
+
+	for (int i = 0; i < hostids->values_num; i++)
+	{
+		const zbx_uint64_t	*phostid = &hostids->values[i];
+
+		if (NULL == (phost = (zbx_um_host_t **)zbx_hashset_search(&dbsync_env.cache->um_cache->hosts,
+				&phostid)))
+		{
+			continue;
+		}
+
+		for (int j = 0; j < (*phost)->macros.values_num; j++)
+			dbsync_add_row(sync, (*phost)->macros.values[j]->macroid, ZBX_DBSYNC_ROW_REMOVE, NULL);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: compares host macros table with cached configuration data       *
  *                                                                            *
  * Parameter: sync - [OUT] the changeset                                      *
  *                                                                            *
@@ -1421,10 +1710,34 @@ int	zbx_dbsync_compare_host_macros(zbx_dbsync_t *sync)
 	zbx_hashset_iter_t	iter;
 	zbx_uint64_t		rowid, *prowid = &rowid;
 	zbx_um_macro_t		**pmacro;
+	zbx_dbsync_journal_t	*journal = &dbsync_env.journals[ZBX_DBSYNC_JOURNAL(ZBX_DBSYNC_OBJ_HOSTMACRO)];
 
 	zbx_dcsync_sql_start(sync);
 
-	if (NULL == (result = zbx_db_select("select hostmacroid,hostid,macro,value,type from hostmacro")))
+	if (ZBX_DBSYNC_INIT != sync->mode &&
+			FAIL == dbsync_journal_fallback(sync, journal, dbsync_env.cache->hmacros.num_data))
+	{
+		char	*sql = NULL;
+		size_t	sql_alloc = 0, sql_offset = 0;
+		int	ret;
+
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset,
+				"select hostmacroid,hostid,macro,value,type from hostmacro");
+		dbsync_prepare(sync, 5, NULL);
+
+		if (SUCCEED == (ret = dbsync_read_journal(sync, &sql, &sql_alloc, &sql_offset, "hostmacroid", "where",
+				NULL, journal)))
+		{
+			dbsync_add_deleted_host_macros(sync);
+		}
+
+		zbx_free(sql);
+		zbx_dcsync_sql_end(sync);
+
+		return ret;
+	}
+
+	if (NULL == (result = dbsync_select(sync, "select hostmacroid,hostid,macro,value,type from hostmacro")))
 		return FAIL;
 
 	dbsync_prepare(sync, 5, NULL);
@@ -1651,7 +1964,7 @@ int	zbx_dbsync_compare_interfaces(zbx_dbsync_t *sync)
 
 	zbx_dcsync_sql_start(sync);
 
-	if (NULL == (result = zbx_db_select(
+	if (NULL == (result = dbsync_select(sync,
 			"select i.interfaceid,i.hostid,i.type,i.main,i.useip,i.ip,i.dns,i.port,"
 			"i.available,i.disable_until,i.error,i.errors_from,"
 			"s.version,s.bulk,s.community,s.securityname,s.securitylevel,s.authpassphrase,s.privpassphrase,"
@@ -1786,7 +2099,7 @@ int	zbx_dbsync_compare_items(zbx_dbsync_t *sync)
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
-		if (NULL == (sync->dbresult = zbx_db_select("%s", sql)))
+		if (NULL == (sync->dbresult = dbsync_select(sync, "%s", sql)))
 			ret = FAIL;
 		goto out;
 	}
@@ -1826,7 +2139,7 @@ int	zbx_dbsync_compare_item_discovery(zbx_dbsync_t *sync)
 
 	zbx_dcsync_sql_start(sync);
 
-	if (NULL == (result = zbx_db_select("select itemid,parent_itemid from item_discovery")))
+	if (NULL == (result = dbsync_select(sync, "select itemid,parent_itemid from item_discovery")))
 		return FAIL;
 
 	dbsync_prepare(sync, 2, NULL);
@@ -1981,7 +2294,7 @@ int	zbx_dbsync_compare_triggers(zbx_dbsync_t *sync)
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
-		if (NULL == (sync->dbresult = zbx_db_select("%s", sql)))
+		if (NULL == (sync->dbresult = dbsync_select(sync, "%s", sql)))
 			ret = FAIL;
 		goto out;
 	}
@@ -2019,7 +2332,7 @@ int	zbx_dbsync_compare_trigger_dependency(zbx_dbsync_t *sync)
 
 	zbx_dcsync_sql_start(sync);
 
-	if (NULL == (result = zbx_db_select("select triggerid_down,triggerid_up from trigger_depends")))
+	if (NULL == (result = dbsync_select(sync, "select triggerid_down,triggerid_up from trigger_depends")))
 		return FAIL;
 
 	dbsync_prepare(sync, 2, NULL);
@@ -2131,7 +2444,7 @@ int	zbx_dbsync_compare_functions(zbx_dbsync_t *sync)
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
-		if (NULL == (sync->dbresult = zbx_db_select("%s", sql)))
+		if (NULL == (sync->dbresult = dbsync_select(sync, "%s", sql)))
 			ret = FAIL;
 		goto out;
 	}
@@ -2198,7 +2511,7 @@ int	zbx_dbsync_compare_expressions(zbx_dbsync_t *sync)
 
 	zbx_dcsync_sql_start(sync);
 
-	if (NULL == (result = zbx_db_select(
+	if (NULL == (result = dbsync_select(sync,
 			"select r.name,e.expressionid,e.expression,e.expression_type,e.exp_delimiter,e.case_sensitive"
 			" from regexps r,expressions e"
 			" where r.regexpid=e.regexpid")))
@@ -2299,7 +2612,7 @@ int	zbx_dbsync_compare_actions(zbx_dbsync_t *sync)
 
 	zbx_dcsync_sql_start(sync);
 
-	if (NULL == (result = zbx_db_select(
+	if (NULL == (result = dbsync_select(sync,
 			"select actionid,eventsource,evaltype,formula"
 			" from actions"
 			" where eventsource<>%d"
@@ -2401,7 +2714,7 @@ int	zbx_dbsync_compare_action_ops(zbx_dbsync_t *sync)
 
 	zbx_dcsync_sql_start(sync);
 
-	if (NULL == (result = zbx_db_select(
+	if (NULL == (result = dbsync_select(sync,
 			"select a.actionid,o.recovery"
 			" from actions a"
 			" left join operations o"
@@ -2501,7 +2814,7 @@ int	zbx_dbsync_compare_action_conditions(zbx_dbsync_t *sync)
 
 	zbx_dcsync_sql_start(sync);
 
-	if (NULL == (result = zbx_db_select(
+	if (NULL == (result = dbsync_select(sync,
 			"select c.conditionid,c.actionid,c.conditiontype,c.operator,c.value,c.value2"
 			" from conditions c,actions a"
 			" where c.actionid=a.actionid"
@@ -2581,7 +2894,7 @@ int	zbx_dbsync_compare_trigger_tags(zbx_dbsync_t *sync)
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
-		if (NULL == (sync->dbresult = zbx_db_select("%s", sql)))
+		if (NULL == (sync->dbresult = dbsync_select(sync, "%s", sql)))
 			ret = FAIL;
 		goto out;
 	}
@@ -2619,7 +2932,7 @@ int	zbx_dbsync_compare_item_tags(zbx_dbsync_t *sync)
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
-		if (NULL == (sync->dbresult = zbx_db_select("%s", sql)))
+		if (NULL == (sync->dbresult = dbsync_select(sync, "%s", sql)))
 			ret = FAIL;
 		goto out;
 	}
@@ -2657,7 +2970,7 @@ int	zbx_dbsync_compare_host_tags(zbx_dbsync_t *sync)
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
-		if (NULL == (sync->dbresult = zbx_db_select("%s", sql)))
+		if (NULL == (sync->dbresult = dbsync_select(sync, "%s", sql)))
 			ret = FAIL;
 		goto out;
 	}
@@ -2717,7 +3030,7 @@ int	zbx_dbsync_compare_correlations(zbx_dbsync_t *sync)
 
 	zbx_dcsync_sql_start(sync);
 
-	if (NULL == (result = zbx_db_select(
+	if (NULL == (result = dbsync_select(sync,
 			"select correlationid,name,evaltype,formula"
 			" from correlation"
 			" where status=%d",
@@ -2847,7 +3160,7 @@ int	zbx_dbsync_compare_corr_conditions(zbx_dbsync_t *sync)
 
 	zbx_dcsync_sql_start(sync);
 
-	if (NULL == (result = zbx_db_select(
+	if (NULL == (result = dbsync_select(sync,
 			"select cc.corr_conditionid,cc.correlationid,cc.type,cct.tag,cctv.tag,cctv.value,cctv.operator,"
 				" ccg.groupid,ccg.operator,cctp.oldtag,cctp.newtag"
 			" from correlation c,corr_condition cc"
@@ -2956,7 +3269,7 @@ int	zbx_dbsync_compare_corr_operations(zbx_dbsync_t *sync)
 
 	zbx_dcsync_sql_start(sync);
 
-	if (NULL == (result = zbx_db_select(
+	if (NULL == (result = dbsync_select(sync,
 			"select co.corr_operationid,co.correlationid,co.type"
 			" from correlation c,corr_operation co"
 			" where c.correlationid=co.correlationid"
@@ -3048,10 +3361,32 @@ int	zbx_dbsync_compare_host_groups(zbx_dbsync_t *sync)
 	zbx_hashset_iter_t	iter;
 	zbx_uint64_t		rowid;
 	zbx_dc_hostgroup_t	*group;
+	zbx_dbsync_journal_t	*journal = &dbsync_env.journals[ZBX_DBSYNC_JOURNAL(ZBX_DBSYNC_OBJ_HSTGRP)];
 
 	zbx_dcsync_sql_start(sync);
 
-	if (NULL == (result = zbx_db_select("select groupid,name from hstgrp where type=%d", HOSTGROUP_TYPE_HOST)))
+	if (ZBX_DBSYNC_INIT != sync->mode &&
+			FAIL == dbsync_journal_fallback(sync, journal, dbsync_env.cache->hostgroups.num_data))
+	{
+		char	*sql = NULL;
+		size_t	sql_alloc = 0, sql_offset = 0;
+		int	ret;
+
+		/* template groups are filtered out, their changelog records are ignored */
+		zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, "select groupid,name from hstgrp where type=%d",
+				HOSTGROUP_TYPE_HOST);
+		dbsync_prepare(sync, 2, NULL);
+
+		ret = dbsync_read_journal(sync, &sql, &sql_alloc, &sql_offset, "groupid", "and", NULL, journal);
+
+		zbx_free(sql);
+		zbx_dcsync_sql_end(sync);
+
+		return ret;
+	}
+
+	if (NULL == (result = dbsync_select(sync, "select groupid,name from hstgrp where type=%d",
+			HOSTGROUP_TYPE_HOST)))
 		return FAIL;
 
 	dbsync_prepare(sync, 2, NULL);
@@ -3123,7 +3458,7 @@ int	zbx_dbsync_compare_item_preprocs(zbx_dbsync_t *sync)
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
-		if (NULL == (sync->dbresult = zbx_db_select("%s", sql)))
+		if (NULL == (sync->dbresult = dbsync_select(sync, "%s", sql)))
 			ret = FAIL;
 		goto out;
 	}
@@ -3213,7 +3548,7 @@ int	zbx_dbsync_compare_item_script_param(zbx_dbsync_t *sync)
 
 	zbx_dcsync_sql_start(sync);
 
-	if (NULL == (result = zbx_db_select(
+	if (NULL == (result = dbsync_select(sync,
 			"select p.item_parameterid,p.itemid,p.name,p.value,i.hostid"
 			" from item_parameter p,items i,hosts h"
 			" where p.itemid=i.itemid"
@@ -3298,8 +3633,9 @@ int	zbx_dbsync_compare_maintenances(zbx_dbsync_t *sync)
 
 	zbx_dcsync_sql_start(sync);
 
-	if (NULL == (result = zbx_db_select("select maintenanceid,maintenance_type,active_since,active_till,tags_evaltype"
-						" from maintenances")))
+	if (NULL == (result = dbsync_select(sync,
+			"select maintenanceid,maintenance_type,active_since,active_till,tags_evaltype"
+			" from maintenances")))
 	{
 		return FAIL;
 	}
@@ -3396,7 +3732,7 @@ int	zbx_dbsync_compare_maintenance_tags(zbx_dbsync_t *sync)
 
 	zbx_dcsync_sql_start(sync);
 
-	if (NULL == (result = zbx_db_select("select maintenancetagid,maintenanceid,operator,tag,value"
+	if (NULL == (result = dbsync_select(sync, "select maintenancetagid,maintenanceid,operator,tag,value"
 						" from maintenance_tag")))
 	{
 		return FAIL;
@@ -3510,10 +3846,11 @@ int	zbx_dbsync_compare_maintenance_periods(zbx_dbsync_t *sync)
 
 	zbx_dcsync_sql_start(sync);
 
-	if (NULL == (result = zbx_db_select("select t.timeperiodid,t.timeperiod_type,t.every,t.month,t.dayofweek,t.day,"
-						"t.start_time,t.period,t.start_date,m.maintenanceid"
-					" from maintenances_windows m,timeperiods t"
-					" where t.timeperiodid=m.timeperiodid")))
+	if (NULL == (result = dbsync_select(sync,
+			"select t.timeperiodid,t.timeperiod_type,t.every,t.month,t.dayofweek,t.day,"
+				"t.start_time,t.period,t.start_date,m.maintenanceid"
+			" from maintenances_windows m,timeperiods t"
+			" where t.timeperiodid=m.timeperiodid")))
 	{
 		return FAIL;
 	}
@@ -3588,8 +3925,11 @@ int	zbx_dbsync_compare_maintenance_groups(zbx_dbsync_t *sync)
 
 	zbx_dcsync_sql_start(sync);
 
-	if (NULL == (result = zbx_db_select("select maintenanceid,groupid from maintenances_groups order by maintenanceid")))
+	if (NULL == (result = dbsync_select(sync,
+			"select maintenanceid,groupid from maintenances_groups order by maintenanceid")))
+	{
 		return FAIL;
+	}
 
 	dbsync_prepare(sync, 2, NULL);
 
@@ -3668,7 +4008,8 @@ int	zbx_dbsync_compare_maintenance_hosts(zbx_dbsync_t *sync)
 
 	zbx_dcsync_sql_start(sync);
 
-	if (NULL == (result = zbx_db_select("select maintenanceid,hostid from maintenances_hosts order by maintenanceid")))
+	if (NULL == (result = dbsync_select(sync,
+			"select maintenanceid,hostid from maintenances_hosts order by maintenanceid")))
 	{
 		return FAIL;
 	}
@@ -3750,7 +4091,7 @@ int	zbx_dbsync_compare_host_group_hosts(zbx_dbsync_t *sync)
 
 	zbx_dcsync_sql_start(sync);
 
-	if (NULL == (result = zbx_db_select(
+	if (NULL == (result = dbsync_select(sync,
 			"select hg.groupid,hg.hostid"
 			" from hosts_groups hg,hosts h"
 			" where hg.hostid=h.hostid"
@@ -3841,7 +4182,7 @@ int	zbx_dbsync_prepare_drules(zbx_dbsync_t *sync)
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
-		if (NULL == (sync->dbresult = zbx_db_select("%s", sql)))
+		if (NULL == (sync->dbresult = dbsync_select(sync, "%s", sql)))
 			ret = FAIL;
 
 		goto out;
@@ -3885,7 +4226,7 @@ int	zbx_dbsync_prepare_dchecks(zbx_dbsync_t *sync)
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
-		if (NULL == (sync->dbresult = zbx_db_select("%s", sql)))
+		if (NULL == (sync->dbresult = dbsync_select(sync, "%s", sql)))
 			ret = FAIL;
 		goto out;
 	}
@@ -3923,7 +4264,7 @@ int	zbx_dbsync_prepare_httptests(zbx_dbsync_t *sync)
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
-		if (NULL == (sync->dbresult = zbx_db_select("%s", sql)))
+		if (NULL == (sync->dbresult = dbsync_select(sync, "%s", sql)))
 			ret = FAIL;
 		goto out;
 	}
@@ -3961,7 +4302,7 @@ int	zbx_dbsync_prepare_httptest_fields(zbx_dbsync_t *sync)
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
-		if (NULL == (sync->dbresult = zbx_db_select("%s", sql)))
+		if (NULL == (sync->dbresult = dbsync_select(sync, "%s", sql)))
 			ret = FAIL;
 		goto out;
 	}
@@ -3998,7 +4339,7 @@ int	zbx_dbsync_prepare_httpsteps(zbx_dbsync_t *sync)
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
-		if (NULL == (sync->dbresult = zbx_db_select("%s", sql)))
+		if (NULL == (sync->dbresult = dbsync_select(sync, "%s", sql)))
 			ret = FAIL;
 		goto out;
 	}
@@ -4035,7 +4376,7 @@ int	zbx_dbsync_prepare_httpstep_fields(zbx_dbsync_t *sync)
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
-		if (NULL == (sync->dbresult = zbx_db_select("%s", sql)))
+		if (NULL == (sync->dbresult = dbsync_select(sync, "%s", sql)))
 			ret = FAIL;
 		goto out;
 	}
@@ -4078,7 +4419,7 @@ int	zbx_dbsync_compare_connectors(zbx_dbsync_t *sync)
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
-		if (NULL == (sync->dbresult = zbx_db_select("%s", sql)))
+		if (NULL == (sync->dbresult = dbsync_select(sync, "%s", sql)))
 			ret = FAIL;
 		goto out;
 	}
@@ -4108,7 +4449,7 @@ int	zbx_dbsync_compare_connector_tags(zbx_dbsync_t *sync)
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
-		if (NULL == (sync->dbresult = zbx_db_select("%s", sql)))
+		if (NULL == (sync->dbresult = dbsync_select(sync, "%s", sql)))
 			ret = FAIL;
 		goto out;
 	}
@@ -4145,7 +4486,7 @@ int	zbx_dbsync_compare_proxies(zbx_dbsync_t *sync)
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
-		if (NULL == (sync->dbresult = zbx_db_select("%s", sql)))
+		if (NULL == (sync->dbresult = dbsync_select(sync, "%s", sql)))
 			ret = FAIL;
 		goto out;
 	}
@@ -4184,7 +4525,7 @@ int	zbx_dbsync_prepare_proxy_group(zbx_dbsync_t *sync)
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
-		if (NULL == (sync->dbresult = zbx_db_select("%s", sql)))
+		if (NULL == (sync->dbresult = dbsync_select(sync, "%s", sql)))
 			ret = FAIL;
 		goto out;
 	}
@@ -4227,7 +4568,7 @@ int	zbx_dbsync_prepare_host_proxy(zbx_dbsync_t *sync)
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
-		if (NULL == (sync->dbresult = zbx_db_select("%s", sql)))
+		if (NULL == (sync->dbresult = dbsync_select(sync, "%s", sql)))
 			ret = FAIL;
 		goto out;
 	}
@@ -4271,6 +4612,52 @@ static void	dcsync_log_stats(const char *function_name, const zbx_dbsync_t *sync
 			sync->sync_time, sync->sync_size, sync->add_num, sync->update_num, sync->remove_num);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: copy per table statistics of the current sync                     *
+ *                                                                            *
+ * Parameters: stats     - [OUT] the statistics                               *
+ *             stats_max - [IN] the maximum number of tables to copy          *
+ *                                                                            *
+ * Return value: the number of copied tables                                  *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_dcsync_stats_copy(zbx_dc_sync_stats_t *stats, int stats_max)
+{
+	const zbx_vector_dbsync_t	*syncs[] = {&dbsync_env.changelog_dbsyncs, &dbsync_env.dbsyncs};
+	int				stats_num = 0;
+
+	for (size_t i = 0; i < ARRSIZE(syncs); i++)
+	{
+		for (int j = 0; j < syncs[i]->values_num && stats_num < stats_max; j++)
+		{
+			const zbx_dbsync_t	*sync = syncs[i]->values[j];
+			zbx_dc_sync_stats_t	*stat = &stats[stats_num++];
+			const char		*mode;
+
+			if (ZBX_DBSYNC_INIT == sync->mode)
+				mode = "init";
+			else if (ZBX_DBSYNC_TYPE_CHANGELOG == sync->type)
+				mode = "changelog";
+			else if (ZBX_DBSYNC_TYPE_FALLBACK == sync->type)
+				mode = "fallback";
+			else
+				mode = "diff";
+
+			zbx_strlcpy(stat->name, sync->from, sizeof(stat->name));
+			zbx_strlcpy(stat->mode, mode, sizeof(stat->mode));
+			stat->sql_time = sync->sql_time;
+			stat->sync_time = sync->sync_time;
+			stat->add_num = sync->add_num;
+			stat->update_num = sync->update_num;
+			stat->remove_num = sync->remove_num;
+			stat->sync_size = sync->sync_size;
+		}
+	}
+
+	return stats_num;
+}
+
 void	zbx_dcsync_stats_dump(const char *function_name)
 {
 	double		sync_time_total = 0, sql_time_total = 0;
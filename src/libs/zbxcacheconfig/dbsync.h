@@ -42,6 +42,8 @@
 
 #define ZBX_DBSYNC_TYPE_DIFF		0
 #define ZBX_DBSYNC_TYPE_CHANGELOG	1
+/* changelog journal was too large and the table was compared with cache instead */
+#define ZBX_DBSYNC_TYPE_FALLBACK	2
 
 #define ZBX_DBSYNC_OBJ_HOST		1
 #define ZBX_DBSYNC_OBJ_HOST_TAG		2
@@ -64,8 +66,20 @@
 #define ZBX_DBSYNC_OBJ_PROXY		19
 #define ZBX_DBSYNC_OBJ_PROXY_GROUP	20
 #define ZBX_DBSYNC_OBJ_HOST_PROXY	21
+#define ZBX_DBSYNC_OBJ_GLOBALMACRO	22
+#define ZBX_DBSYNC_OBJ_HOSTMACRO	23
+#define ZBX_DBSYNC_OBJ_HSTGRP		24
 /* number of dbsync objects - keep in sync with above defines */
-#define ZBX_DBSYNC_OBJ_COUNT		21
+#define ZBX_DBSYNC_OBJ_COUNT		24
+
+/* Tables out of changelog scope, they are always compared with cache:                                  */
+/*   interface, host_inventory - updated by server at runtime (interface availability, inventory         */
+/*       populated from items), triggers would turn every such update into a changelog record             */
+/*   actions, operations, conditions, correlation, corr_condition, corr_operation, maintenances,          */
+/*   maintenances_windows, maintenance_tag, maintenances_groups, maintenances_hosts - small tables with   */
+/*       child rows removed by cascade delete, operations sync also returns virtual rows                  */
+/*   hosts_templates, hosts_groups, trigger_depends, item_discovery, item_parameter, regexps,             */
+/*   autoreg_host, config_autoreg_tls - not converted yet                                                 */
 
 /******************************************************************************
  *                                                                            *
@@ -133,8 +147,27 @@ struct zbx_dbsync
 	double		sync_time;
 	zbx_uint64_t	used;
 	zbx_int64_t	sync_size;
+
+	/* set when the changeset was already calculated by prefetch thread (see zbx_dbsync_prefetch()) */
+	unsigned char	prefetched;
+	int		prefetch_ret;
+
+	/* connection of prefetch thread calculating the changeset, NULL for the default connection */
+	zbx_dbconn_t	*db;
 };
 
+typedef int (*zbx_dbsync_compare_func_t)(zbx_dbsync_t *sync);
+
+/* changeset calculation task, tasks of the same group are executed sequentially */
+/* by one prefetch thread using its own database connection                    */
+typedef struct
+{
+	zbx_dbsync_t			*sync;
+	zbx_dbsync_compare_func_t	compare_func;
+	int				group;
+}
+zbx_dbsync_task_t;
+
 typedef struct
 {
 	zbx_uint64_t	changelogid;
@@ -172,6 +205,9 @@ typedef struct
 
 	zbx_hashset_t			changelog;
 
+	/* the changelog sync mode, journals are not available in ZBX_DBSYNC_INIT mode */
+	unsigned char			mode;
+
 	zbx_dbsync_journal_t		journals[ZBX_DBSYNC_OBJ_COUNT];
 
 	zbx_vector_dbsync_t		changelog_dbsyncs;
@@ -194,6 +230,9 @@ int	zbx_dbsync_next(zbx_dbsync_t *sync, zbx_uint64_t *rowid, char ***row, unsign
 
 void	dbsync_prepare(zbx_dbsync_t *sync, int columns_num, zbx_dbsync_preproc_row_func_t preproc_row_func);
 
+void	zbx_dbsync_prefetch(zbx_dbsync_task_t *tasks, int tasks_num);
+int	zbx_dbsync_compare(zbx_dbsync_t *sync, zbx_dbsync_compare_func_t compare_func);
+
 int	zbx_dbsync_compare_autoreg_psk(zbx_dbsync_t *sync);
 int	zbx_dbsync_compare_autoreg_host(zbx_dbsync_t *sync);
 int	zbx_dbsync_compare_hosts(zbx_dbsync_t *sync);
@@ -252,5 +291,6 @@ void	zbx_dcsync_sql_end(zbx_dbsync_t *sync);
 void	zbx_dcsync_sync_start(zbx_dbsync_t *sync, zbx_uint64_t used_size);
 void	zbx_dcsync_sync_end(zbx_dbsync_t *sync, zbx_uint64_t used_size);
 void	zbx_dcsync_stats_dump(const char *function_name);
+int	zbx_dcsync_stats_copy(zbx_dc_sync_stats_t *stats, int stats_max);
 
 #endif /* BUILD_SRC_LIBS_ZBXDBCACHE_DBSYNC_H_ */
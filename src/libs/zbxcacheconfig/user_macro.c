@@ -1426,8 +1426,10 @@ void	um_cache_remove_hosts(zbx_um_cache_t *cache, const zbx_vector_uint64_t *hos
 
 		if (NULL != (phost = (zbx_um_host_t **)zbx_hashset_search(&cache->hosts, &phostid)))
 		{
+			zbx_um_host_t	*host = *phost;
+
 			zbx_hashset_remove_direct(&cache->hosts, phost);
-			um_host_release(*phost);
+			um_host_release(host);
 		}
 	}
 }
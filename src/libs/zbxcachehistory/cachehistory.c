@@ -124,6 +124,14 @@ static ZBX_DC_CACHE	*cache = NULL;
 #define ZBX_STRUCT_REALLOC_STEP	8
 #define ZBX_STRING_REALLOC_STEP	ZBX_KIBIBYTE
 
+/* flushed trend reference, used to index trends by itemid */
+typedef struct
+{
+	zbx_uint64_t	itemid;
+	ZBX_DC_TREND	*trend;
+}
+zbx_dc_trend_ref_t;
+
 typedef enum
 {
 	ZBX_DC_SYNC_TREND_MODE_PARALLEL,
@@ -405,6 +413,7 @@ static void	dc_insert_trends_in_db(ZBX_DC_TREND *trends, int trends_num, int ups
 			"value_max", (char *)NULL);
 
 #ifdef HAVE_POSTGRESQL
+	/* existing rows were merged with cached trends by dc_trends_fetch_and_update(), overwrite them */
 	if (0 != upserts_num)
 	{
 		zbx_db_insert_clause(&db_insert, " on conflict (itemid,clock) do update set num=EXCLUDED.num,"
@@ -412,6 +421,8 @@ static void	dc_insert_trends_in_db(ZBX_DC_TREND *trends, int trends_num, int ups
 				"value_avg=EXCLUDED.value_avg,"
 				"value_max=EXCLUDED.value_max");
 	}
+	else
+		zbx_db_insert_set_bulk_load(&db_insert);
 #else
 	ZBX_UNUSED(upserts_num);
 #endif
@@ -457,12 +468,12 @@ static void	dc_insert_trends_in_db(ZBX_DC_TREND *trends, int trends_num, int ups
  * Comments: A helper function for DCflush trends                             *
  *                                                                            *
  ******************************************************************************/
-static void	dc_remove_updated_trends(ZBX_DC_TREND *trends, int trends_num, const char *table_name,
-		int value_type, zbx_uint64_t *itemids, int *itemids_num, int clock)
+static void	dc_remove_updated_trends(zbx_hashset_t *trends_index, const char *table_name,
+		zbx_uint64_t *itemids, int *itemids_num, int clock)
 {
-	int		i, j, clocks_num, now, age;
-	ZBX_DC_TREND	*trend;
-	zbx_uint64_t	itemid;
+	int			j, clocks_num, now, age;
+	zbx_dc_trend_ref_t	*ref;
+	zbx_uint64_t		itemid;
 	size_t		sql_offset;
 	zbx_db_result_t	result;
 	zbx_db_row_t	row;
@@ -504,19 +515,8 @@ static void	dc_remove_updated_trends(ZBX_DC_TREND *trends, int trends_num, const
 	{
 		itemid = itemids[--*itemids_num];
 
-		for (i = 0; i < trends_num; i++)
-		{
-			trend = &trends[i];
-
-			if (itemid != trend->itemid)
-				continue;
-
-			if (clock != trend->clock || value_type != trend->value_type)
-				continue;
-
-			trend->disable_from = clock;
-			break;
-		}
+		if (NULL != (ref = (zbx_dc_trend_ref_t *)zbx_hashset_search(trends_index, &itemid)))
+			ref->trend->disable_from = clock;
 	}
 }
 
@@ -544,6 +544,7 @@ static void	dc_trends_update_float(ZBX_DC_TREND *trend, zbx_db_row_t row, int nu
 	trend->num += num;
 }
 
+#ifndef HAVE_POSTGRESQL
 static void	db_trends_update_float(ZBX_DC_TREND *trend, size_t *sql_offset)
 {
 	zbx_snprintf_alloc(&sql, &sql_alloc, sql_offset, "update trends set"
@@ -553,6 +554,7 @@ static void	db_trends_update_float(ZBX_DC_TREND *trend, size_t *sql_offset)
 			trend->num, trend->value_min.dbl, trend->value_avg.dbl, trend->value_max.dbl,
 			trend->itemid, trend->clock);
 }
+#endif
 
 /******************************************************************************
  *                                                                            *
@@ -580,6 +582,7 @@ static void	dc_trends_update_uint(ZBX_DC_TREND *trend, zbx_db_row_t row, int num
 	zbx_uinc128_128(&trend->value_avg.ui64, &avg);
 }
 
+#ifndef HAVE_POSTGRESQL
 static void	db_trends_update_uint(ZBX_DC_TREND *trend, size_t *sql_offset)
 {
 	zbx_uint128_t	avg;
@@ -597,29 +600,38 @@ static void	db_trends_update_uint(ZBX_DC_TREND *trend, size_t *sql_offset)
 			trend->itemid,
 			trend->clock);
 }
+#endif
 
 /******************************************************************************
  *                                                                            *
- * Purpose: helper function for DCflush trends                                *
+ * Purpose: merges cached trends with the trends already stored in database   *
+ *                                                                            *
+ * Parameters: trends_index - [IN] flushed trends indexed by itemid           *
+ *             itemids      - [IN] items that might have trends in database   *
+ *             itemids_num  - [IN] number of items                            *
+ *             inserts_num  - [IN/OUT] number of trends to insert             *
+ *             upserts_num  - [OUT] number of merged trends to upsert         *
+ *             value_type   - [IN] trends value type                          *
+ *             table_name   - [IN] trends table name                          *
+ *             clock        - [IN] trends clock                               *
+ *                                                                            *
+ * Comments: On PostgreSQL the merged trends are written with upsert by       *
+ *           dc_insert_trends_in_db(). Other databases update the merged rows *
+ *           here and remove the trends from insert - MySQL upsert would need *
+ *           either deprecated VALUES() function or row alias, which is not   *
+ *           supported by MariaDB.                                            *
  *                                                                            *
  ******************************************************************************/
-static void	dc_trends_fetch_and_update(ZBX_DC_TREND *trends, int trends_num, zbx_uint64_t *itemids,
-		int itemids_num, int *inserts_num, int *upserts_num, unsigned char value_type, const char *table_name,
-		int clock)
+static void	dc_trends_fetch_and_update(zbx_hashset_t *trends_index, zbx_uint64_t *itemids, int itemids_num,
+		int *inserts_num, int *upserts_num, unsigned char value_type, const char *table_name, int clock)
 {
-	int		i, num;
-	zbx_db_result_t	result;
-	zbx_db_row_t	row;
-	zbx_uint64_t	itemid;
-	ZBX_DC_TREND	*trend;
-	size_t		sql_offset;
-#ifdef HAVE_POSTGRESQL
-	int		upsert = 0;
+	int			num;
+	zbx_db_result_t		result;
+	zbx_db_row_t		row;
+	zbx_uint64_t		itemid;
+	zbx_dc_trend_ref_t	*ref;
+	size_t			sql_offset = 0;
 
-	if (0 != zbx_tsdb_get_version())
-		upsert = 1;
-#endif
-	sql_offset = 0;
 	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
 			"select itemid,num,value_min,value_avg,value_max"
 			" from %s"
@@ -629,34 +641,21 @@ static void	dc_trends_fetch_and_update(ZBX_DC_TREND *trends, int trends_num, zbx
 	zbx_db_add_condition_alloc(&sql, &sql_alloc, &sql_offset, "itemid", itemids, itemids_num);
 
 #ifdef HAVE_POSTGRESQL
-	if (1 == upsert)
-		result = zbx_db_select("%s", sql);
-	else
-		result = zbx_db_select("%s order by itemid,clock", sql);
+	ZBX_UNUSED(inserts_num);
+
+	result = zbx_db_select("%s", sql);
 #else
-	result = zbx_db_select("%s order by itemid,clock", sql);
-#endif
+	ZBX_UNUSED(upserts_num);
 
+	result = zbx_db_select("%s order by itemid,clock", sql);
 	sql_offset = 0;
+#endif
 
 	while (NULL != (row = zbx_db_fetch(result)))
 	{
 		ZBX_STR2UINT64(itemid, row[0]);
 
-		for (i = 0; i < trends_num; i++)
-		{
-			trend = &trends[i];
-
-			if (itemid != trend->itemid)
-				continue;
-
-			if (clock != trend->clock || value_type != trend->value_type)
-				continue;
-
-			break;
-		}
-
-		if (i == trends_num)
+		if (NULL == (ref = (zbx_dc_trend_ref_t *)zbx_hashset_search(trends_index, &itemid)))
 		{
 			THIS_SHOULD_NEVER_HAPPEN;
 			continue;
@@ -665,34 +664,29 @@ static void	dc_trends_fetch_and_update(ZBX_DC_TREND *trends, int trends_num, zbx
 		num = atoi(row[1]);
 
 		if (value_type == ITEM_VALUE_TYPE_FLOAT)
-			dc_trends_update_float(trend, row, num);
+			dc_trends_update_float(ref->trend, row, num);
 		else
-			dc_trends_update_uint(trend, row, num);
+			dc_trends_update_uint(ref->trend, row, num);
 
 #ifdef HAVE_POSTGRESQL
-		if (1 == upsert)
-		{
-			(*upserts_num)++;
-			continue;
-		}
+		(*upserts_num)++;
 #else
-		ZBX_UNUSED(upserts_num);
-#endif
 		if (value_type == ITEM_VALUE_TYPE_FLOAT)
-			db_trends_update_float(trend, &sql_offset);
+			db_trends_update_float(ref->trend, &sql_offset);
 		else
-			db_trends_update_uint(trend, &sql_offset);
-
-		trend->itemid = 0;
+			db_trends_update_uint(ref->trend, &sql_offset);
 
+		ref->trend->itemid = 0;
 		--*inserts_num;
 
 		zbx_db_execute_overflowed_sql(&sql, &sql_alloc, &sql_offset);
+#endif
 	}
 
 	zbx_db_free_result(result);
-
+#ifndef HAVE_POSTGRESQL
 	(void)zbx_db_flush_overflowed_sql(sql, sql_offset);
+#endif
 }
 
 /******************************************************************************
@@ -708,6 +702,7 @@ void	zbx_db_flush_trends(ZBX_DC_TREND *trends, int *trends_num, zbx_vector_uint6
 	zbx_uint64_t	*itemids = NULL;
 	ZBX_DC_TREND	*trend = NULL;
 	const char	*table_name;
+	zbx_hashset_t	trends_index;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() trends_num:%d", __func__, *trends_num);
 
@@ -753,12 +748,26 @@ void	zbx_db_flush_trends(ZBX_DC_TREND *trends, int *trends_num, zbx_vector_uint6
 		}
 	}
 
-	if (0 != itemids_num)
+	zbx_hashset_create(&trends_index, (size_t)trends_to, ZBX_DEFAULT_UINT64_HASH_FUNC,
+			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+	for (i = 0; i < trends_to; i++)
 	{
-		dc_remove_updated_trends(trends, trends_to, table_name, value_type, itemids,
-				&itemids_num, clock);
+		zbx_dc_trend_ref_t	ref_local;
+
+		trend = &trends[i];
+
+		if (clock != trend->clock || value_type != trend->value_type)
+			continue;
+
+		ref_local.itemid = trend->itemid;
+		ref_local.trend = trend;
+		zbx_hashset_insert(&trends_index, &ref_local, sizeof(ref_local));
 	}
 
+	if (0 != itemids_num)
+		dc_remove_updated_trends(&trends_index, table_name, itemids, &itemids_num, clock);
+
 	for (i = 0; i < trends_to; i++)
 	{
 		trend = &trends[i];
@@ -774,10 +783,11 @@ void	zbx_db_flush_trends(ZBX_DC_TREND *trends, int *trends_num, zbx_vector_uint6
 
 	if (0 != itemids_num)
 	{
-		dc_trends_fetch_and_update(trends, trends_to, itemids, itemids_num, &inserts_num, &upserts_num,
-				value_type, table_name, clock);
+		dc_trends_fetch_and_update(&trends_index, itemids, itemids_num, &inserts_num, &upserts_num, value_type,
+				table_name, clock);
 	}
 
+	zbx_hashset_destroy(&trends_index);
 	zbx_free(itemids);
 
 	/* if 'trends' is not a primary trends buffer */
@@ -3359,7 +3369,7 @@ static int	init_trend_cache(zbx_uint64_t *trends_cache_size, char **error)
 
 	sz = zbx_shmem_required_size(1, "trend cache", "TrendCacheSize");
 	if (SUCCEED != (ret = zbx_shmem_create(&trend_mem, *trends_cache_size, "trend cache", "TrendCacheSize", 0,
-			error)))
+			ZBX_SHMEM_ALLOC_FIRSTFIT, error)))
 	{
 		goto out;
 	}
@@ -3413,13 +3423,13 @@ int	zbx_init_database_cache(zbx_get_program_type_f get_program_type,
 		goto out;
 
 	if (SUCCEED != (ret = zbx_shmem_create(&hc_mem, history_cache_size, "history cache",
-			"HistoryCacheSize", 1, error)))
+			"HistoryCacheSize", 1, ZBX_SHMEM_ALLOC_BESTFIT, error)))
 	{
 		goto out;
 	}
 
 	if (SUCCEED != (ret = zbx_shmem_create(&hc_index_mem, history_index_cache_size, "history index cache",
-			"HistoryIndexCacheSize", 0, error)))
+			"HistoryIndexCacheSize", 0, ZBX_SHMEM_ALLOC_FIRSTFIT, error)))
 	{
 		goto out;
 	}
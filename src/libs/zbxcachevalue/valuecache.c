@@ -73,6 +73,13 @@ zbx_rwlock_t	vc_lock = ZBX_RWLOCK_NULL;
 /* value cache state, after initialization value cache is always disabled */
 static int	vc_state = ZBX_VC_DISABLED;
 
+/* compress numeric value chunks (ValueCacheCompression configuration parameter) */
+static int	vc_compression = 0;
+
+/* the last decompressed chunk values, owned by the calling thread */
+static ZBX_THREAD_LOCAL zbx_history_record_t	*vc_decoded_values = NULL;
+static ZBX_THREAD_LOCAL zbx_uint64_t		vc_decoded_id = 0;
+
 ZBX_SHMEM_FUNC_IMPL(__vc, vc_mem)
 
 #define VC_STRPOOL_INIT_SIZE	(1000)
@@ -105,11 +112,30 @@ typedef struct zbx_vc_chunk
 	/* the number of item value slots in chunk */
 	int			slots_num;
 
-	/* the item value data */
+	/* the size of encoded value data in bytes, 0 for uncompressed chunks */
+	int			compressed_size;
+
+	/* the compressed chunk identifier, used to cache decompressed values */
+	zbx_uint64_t		compressed_id;
+
+	/* The item value data. For compressed chunks it contains slots_num values     */
+	/* encoded with delta-of-delta timestamps and XOR (float) or delta-of-delta    */
+	/* (unsigned) values. Compressed chunks are never modified except the          */
+	/* first_value index being increased when old values are removed.              */
 	zbx_history_record_t	slots[1];
 }
 zbx_vc_chunk_t;
 
+/* bit stream used to encode compressed chunk values */
+typedef struct
+{
+	unsigned char	*data;
+
+	/* the current bit offset */
+	size_t		offset;
+}
+zbx_vc_bits_t;
+
 /* min/max number of item history values to store in chunk */
 
 #define ZBX_VC_MIN_CHUNK_RECORDS	2
@@ -118,6 +144,12 @@ zbx_vc_chunk_t;
 #define ZBX_VC_MAX_CHUNK_RECORDS	((64 * ZBX_KIBIBYTE - sizeof(zbx_vc_chunk_t)) / \
 		sizeof(zbx_history_record_t) + 1)
 
+/* the minimum number of values in chunk to be compressed */
+#define ZBX_VC_MIN_COMPRESS_RECORDS	16
+
+/* the maximum encoded value size in bytes - 69 bit timestamp, 31 bit nanoseconds, 77 bit value */
+#define ZBX_VC_MAX_ENCODED_RECORD_SIZE	23
+
 /* the value cache item data */
 typedef struct
 {
@@ -212,6 +244,9 @@ typedef struct
 
 	/* the string pool for str, text and log item values */
 	zbx_hashset_t	strpool;
+
+	/* the last assigned compressed chunk identifier */
+	zbx_uint64_t	compressed_id;
 }
 zbx_vc_cache_t;
 
@@ -944,7 +979,7 @@ static void	vc_history_record_copy(zbx_history_record_t *dst, const zbx_history_
  *                                                                            *
  ******************************************************************************/
 static void	vc_history_record_vector_append(zbx_vector_history_record_t *vector, int value_type,
-		zbx_history_record_t *value)
+		const zbx_history_record_t *value)
 {
 	zbx_history_record_t	record;
 
@@ -1294,6 +1329,468 @@ static void	vc_item_update_db_cached_from(zbx_vc_item_t *item, int timestamp)
  * range) are automatically removed from cache.
  */
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: writes the specified number of low bits of value into bit stream  *
+ *                                                                            *
+ * Parameters: bits  - [IN/OUT] the bit stream, must be zero initialized      *
+ *             value - [IN] the value to write                                *
+ *             num   - [IN] the number of bits to write (0-64)                *
+ *                                                                            *
+ ******************************************************************************/
+static void	vc_bits_write(zbx_vc_bits_t *bits, zbx_uint64_t value, int num)
+{
+	while (0 < num)
+	{
+		int	avail = 8 - (int)(bits->offset & 7), n = MIN(num, avail);
+
+		bits->data[bits->offset >> 3] |= (unsigned char)(((value >> (num - n)) & ((1u << n) - 1)) <<
+				(avail - n));
+		bits->offset += (size_t)n;
+		num -= n;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: reads the specified number of bits from bit stream                *
+ *                                                                            *
+ * Parameters: bits  - [IN/OUT] the bit stream                                *
+ *             num   - [IN] the number of bits to read (0-64)                 *
+ *                                                                            *
+ * Return value: the read value                                               *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_uint64_t	vc_bits_read(zbx_vc_bits_t *bits, int num)
+{
+	zbx_uint64_t	value = 0;
+
+	while (0 < num)
+	{
+		int	avail = 8 - (int)(bits->offset & 7), n = MIN(num, avail);
+
+		value = (value << n) | ((bits->data[bits->offset >> 3] >> (avail - n)) & ((1u << n) - 1));
+		bits->offset += (size_t)n;
+		num -= n;
+	}
+
+	return value;
+}
+
+/* The signed deltas are zigzag encoded and written with a prefix of 0-5 '1' bits */
+/* terminated by '0' bit (except the last tier) selecting the number of bits.      */
+static const int	vc_delta_tiers[] = {0, 7, 9, 12, 32, 64};
+
+#define VC_DELTA_TIERS_NUM	((int)ARRSIZE(vc_delta_tiers))
+
+static void	vc_bits_write_delta(zbx_vc_bits_t *bits, zbx_int64_t delta)
+{
+	zbx_uint64_t	value = ((zbx_uint64_t)delta << 1) ^ (zbx_uint64_t)(delta >> 63);
+	int		i;
+
+	for (i = 0; i < VC_DELTA_TIERS_NUM - 1; i++)
+	{
+		if (value < ((zbx_uint64_t)1 << vc_delta_tiers[i]))
+			break;
+	}
+
+	if (i < VC_DELTA_TIERS_NUM - 1)
+		vc_bits_write(bits, ((zbx_uint64_t)1 << (i + 1)) - 2, i + 1);
+	else
+		vc_bits_write(bits, ((zbx_uint64_t)1 << i) - 1, i);
+
+	vc_bits_write(bits, value, vc_delta_tiers[i]);
+}
+
+static zbx_int64_t	vc_bits_read_delta(zbx_vc_bits_t *bits)
+{
+	zbx_uint64_t	value;
+	int		i;
+
+	for (i = 0; i < VC_DELTA_TIERS_NUM - 1 && 1 == vc_bits_read(bits, 1); i++)
+		;
+
+	value = vc_bits_read(bits, vc_delta_tiers[i]);
+
+	return (zbx_int64_t)(value >> 1) ^ -(zbx_int64_t)(value & 1);
+}
+
+#undef VC_DELTA_TIERS_NUM
+
+static int	vc_leading_zeros(zbx_uint64_t value)
+{
+	int	n = 0;
+
+	while (0 == (value & __UINT64_C(0x8000000000000000)))
+	{
+		value <<= 1;
+		n++;
+	}
+
+	return n;
+}
+
+static int	vc_trailing_zeros(zbx_uint64_t value)
+{
+	int	n = 0;
+
+	while (0 == (value & 1))
+	{
+		value >>= 1;
+		n++;
+	}
+
+	return n;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: writes XOR of two consecutive floating point values               *
+ *                                                                            *
+ * Parameters: bits     - [IN/OUT] the bit stream                             *
+ *             xor      - [IN] XOR of current and previous value bits         *
+ *             leading  - [IN/OUT] the leading zero count of the last written *
+ *                                 meaningful bit window (-1 - none)          *
+ *             trailing - [IN/OUT] the trailing zero count of the last        *
+ *                                 written meaningful bit window              *
+ *                                                                            *
+ * Comments: '0'  - the value did not change                                  *
+ *           '10' - meaningful bits fit into previous window                  *
+ *           '11' - 5 bits leading zeros, 6 bits meaningful bit count - 1,    *
+ *                  followed by meaningful bits                               *
+ *                                                                            *
+ ******************************************************************************/
+static void	vc_bits_write_xor(zbx_vc_bits_t *bits, zbx_uint64_t xor, int *leading, int *trailing)
+{
+	int	lz, tz;
+
+	if (0 == xor)
+	{
+		vc_bits_write(bits, 0, 1);
+		return;
+	}
+
+	if (31 < (lz = vc_leading_zeros(xor)))
+		lz = 31;
+
+	tz = vc_trailing_zeros(xor);
+
+	if (-1 != *leading && lz >= *leading && tz >= *trailing)
+	{
+		vc_bits_write(bits, 2, 2);
+		vc_bits_write(bits, xor >> *trailing, 64 - *leading - *trailing);
+		return;
+	}
+
+	vc_bits_write(bits, 3, 2);
+	vc_bits_write(bits, (zbx_uint64_t)lz, 5);
+	vc_bits_write(bits, (zbx_uint64_t)(64 - lz - tz - 1), 6);
+	vc_bits_write(bits, xor >> tz, 64 - lz - tz);
+
+	*leading = lz;
+	*trailing = tz;
+}
+
+static zbx_uint64_t	vc_bits_read_xor(zbx_vc_bits_t *bits, int *leading, int *trailing)
+{
+	int	len;
+
+	if (0 == vc_bits_read(bits, 1))
+		return 0;
+
+	if (1 == vc_bits_read(bits, 1))
+	{
+		*leading = (int)vc_bits_read(bits, 5);
+		len = (int)vc_bits_read(bits, 6) + 1;
+		*trailing = 64 - *leading - len;
+	}
+	else
+		len = 64 - *leading - *trailing;
+
+	return vc_bits_read(bits, len) << *trailing;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: encodes numeric history values                                    *
+ *                                                                            *
+ * Parameters: values     - [IN] the values to encode                         *
+ *             values_num - [IN] the number of values                         *
+ *             value_type - [IN] the value type (float or unsigned)           *
+ *             data       - [OUT] the encoded data, must be zero initialized  *
+ *                                and have ZBX_VC_MAX_ENCODED_RECORD_SIZE     *
+ *                                bytes for each value                        *
+ *                                                                            *
+ * Return value: the number of bytes used                                     *
+ *                                                                            *
+ ******************************************************************************/
+static size_t	vc_values_encode(const zbx_history_record_t *values, int values_num, unsigned char value_type,
+		unsigned char *data)
+{
+	zbx_vc_bits_t	bits = {.data = data};
+	zbx_int64_t	delta = 0, value_delta = 0;
+	int		i, leading = -1, trailing = 0;
+	zbx_uint64_t	last;
+
+	vc_bits_write(&bits, (zbx_uint64_t)(zbx_uint32_t)values[0].timestamp.sec, 32);
+	vc_bits_write(&bits, (zbx_uint64_t)values[0].timestamp.ns, 30);
+
+	memcpy(&last, &values[0].value, sizeof(last));
+	vc_bits_write(&bits, last, 64);
+
+	for (i = 1; i < values_num; i++)
+	{
+		zbx_int64_t	d;
+		zbx_uint64_t	value;
+
+		d = (zbx_int64_t)values[i].timestamp.sec - values[i - 1].timestamp.sec;
+		vc_bits_write_delta(&bits, d - delta);
+		delta = d;
+
+		if (values[i].timestamp.ns == values[i - 1].timestamp.ns)
+		{
+			vc_bits_write(&bits, 0, 1);
+		}
+		else
+		{
+			vc_bits_write(&bits, 1, 1);
+			vc_bits_write(&bits, (zbx_uint64_t)values[i].timestamp.ns, 30);
+		}
+
+		memcpy(&value, &values[i].value, sizeof(value));
+
+		if (ITEM_VALUE_TYPE_FLOAT == value_type)
+		{
+			vc_bits_write_xor(&bits, value ^ last, &leading, &trailing);
+		}
+		else
+		{
+			d = (zbx_int64_t)(value - last);
+			vc_bits_write_delta(&bits, (zbx_int64_t)((zbx_uint64_t)d - (zbx_uint64_t)value_delta));
+			value_delta = d;
+		}
+
+		last = value;
+	}
+
+	return (bits.offset + 7) >> 3;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: decodes numeric history values                                    *
+ *                                                                            *
+ * Parameters: data       - [IN] the encoded data                             *
+ *             values_num - [IN] the number of values                         *
+ *             value_type - [IN] the value type (float or unsigned)           *
+ *             values     - [OUT] the decoded values                          *
+ *                                                                            *
+ ******************************************************************************/
+static void	vc_values_decode(const unsigned char *data, int values_num, unsigned char value_type,
+		zbx_history_record_t *values)
+{
+	zbx_vc_bits_t	bits = {.data = (unsigned char *)data};
+	zbx_int64_t	delta = 0, value_delta = 0;
+	int		i, leading = -1, trailing = 0;
+	zbx_uint64_t	last;
+
+	values[0].timestamp.sec = (int)(zbx_uint32_t)vc_bits_read(&bits, 32);
+	values[0].timestamp.ns = (int)vc_bits_read(&bits, 30);
+	last = vc_bits_read(&bits, 64);
+	memcpy(&values[0].value, &last, sizeof(last));
+
+	for (i = 1; i < values_num; i++)
+	{
+		delta += vc_bits_read_delta(&bits);
+		values[i].timestamp.sec = (int)(values[i - 1].timestamp.sec + delta);
+
+		if (0 == vc_bits_read(&bits, 1))
+			values[i].timestamp.ns = values[i - 1].timestamp.ns;
+		else
+			values[i].timestamp.ns = (int)vc_bits_read(&bits, 30);
+
+		if (ITEM_VALUE_TYPE_FLOAT == value_type)
+		{
+			last ^= vc_bits_read_xor(&bits, &leading, &trailing);
+		}
+		else
+		{
+			value_delta = (zbx_int64_t)((zbx_uint64_t)value_delta + (zbx_uint64_t)vc_bits_read_delta(&bits));
+			last += (zbx_uint64_t)value_delta;
+		}
+
+		memcpy(&values[i].value, &last, sizeof(last));
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: returns chunk values, decompressing them if necessary             *
+ *                                                                            *
+ * Parameters: chunk      - [IN] the chunk                                    *
+ *             value_type - [IN] the item value type                          *
+ *                                                                            *
+ * Return value: the chunk values indexed by slot                             *
+ *                                                                            *
+ * Comments: Decompressed values are kept in thread local buffer until other  *
+ *           compressed chunk is accessed, so the returned values must not be *
+ *           used after calling this function for another chunk.              *
+ *                                                                            *
+ ******************************************************************************/
+static const zbx_history_record_t	*vch_chunk_values(const zbx_vc_chunk_t *chunk, unsigned char value_type)
+{
+	if (0 == chunk->compressed_size)
+		return chunk->slots;
+
+	if (vc_decoded_id != chunk->compressed_id)
+	{
+		if (NULL == vc_decoded_values)
+		{
+			vc_decoded_values = (zbx_history_record_t *)zbx_malloc(NULL,
+					sizeof(zbx_history_record_t) * ZBX_VC_MAX_CHUNK_RECORDS);
+		}
+
+		vc_values_decode((const unsigned char *)chunk->slots, chunk->slots_num, value_type, vc_decoded_values);
+		vc_decoded_id = chunk->compressed_id;
+	}
+
+	return vc_decoded_values;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: returns timestamp of the specified chunk value                    *
+ *                                                                            *
+ ******************************************************************************/
+static const zbx_timespec_t	*vch_chunk_timestamp(const zbx_vc_chunk_t *chunk, int index, unsigned char value_type)
+{
+	return &vch_chunk_values(chunk, value_type)[index].timestamp;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: returns the allocated chunk size in bytes                         *
+ *                                                                            *
+ ******************************************************************************/
+static size_t	vch_chunk_size(const zbx_vc_chunk_t *chunk)
+{
+	if (0 != chunk->compressed_size)
+		return offsetof(zbx_vc_chunk_t, slots) + (size_t)chunk->compressed_size;
+
+	return sizeof(zbx_vc_chunk_t) + (size_t)(chunk->slots_num - 1) * sizeof(zbx_history_record_t);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: replaces chunk in item's chunk list                               *
+ *                                                                            *
+ ******************************************************************************/
+static void	vch_item_replace_chunk(zbx_vc_item_t *item, zbx_vc_chunk_t *chunk, zbx_vc_chunk_t *new_chunk)
+{
+	new_chunk->prev = chunk->prev;
+	new_chunk->next = chunk->next;
+
+	if (NULL != chunk->prev)
+		chunk->prev->next = new_chunk;
+	else
+		item->tail = new_chunk;
+
+	if (NULL != chunk->next)
+		chunk->next->prev = new_chunk;
+	else
+		item->head = new_chunk;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: compresses chunk values                                           *
+ *                                                                            *
+ * Parameters: item  - [IN/OUT] the chunk owner item                          *
+ *             chunk - [IN] the chunk to compress                             *
+ *                                                                            *
+ * Comments: Only chunks that will not receive new values are compressed -    *
+ *           chunks before head chunk and full tail chunks. The chunk is left *
+ *           uncompressed if compression is disabled, the item is not numeric *
+ *           or compression does not save at least quarter of the space.      *
+ *                                                                            *
+ ******************************************************************************/
+static void	vch_item_compress_chunk(zbx_vc_item_t *item, zbx_vc_chunk_t *chunk)
+{
+	zbx_vc_chunk_t	*cchunk;
+	unsigned char	*data;
+	int		values_num;
+	size_t		size;
+
+	if (0 == vc_compression || 0 != chunk->compressed_size)
+		return;
+
+	if (ITEM_VALUE_TYPE_FLOAT != item->value_type && ITEM_VALUE_TYPE_UINT64 != item->value_type)
+		return;
+
+	if (ZBX_VC_MIN_COMPRESS_RECORDS > (values_num = chunk->last_value - chunk->first_value + 1))
+		return;
+
+	data = (unsigned char *)zbx_calloc(NULL, (size_t)values_num, ZBX_VC_MAX_ENCODED_RECORD_SIZE);
+	size = vc_values_encode(chunk->slots + chunk->first_value, values_num, item->value_type, data);
+
+	if (size > sizeof(zbx_history_record_t) * (size_t)values_num * 3 / 4)
+		goto out;
+
+	/* compression is optional, don't try releasing space for it */
+	if (NULL == (cchunk = (zbx_vc_chunk_t *)__vc_shmem_malloc_func(NULL, offsetof(zbx_vc_chunk_t, slots) + size)))
+		goto out;
+
+	cchunk->first_value = 0;
+	cchunk->last_value = values_num - 1;
+	cchunk->slots_num = values_num;
+	cchunk->compressed_size = (int)size;
+	cchunk->compressed_id = ++vc_cache->compressed_id;
+	memcpy(cchunk->slots, data, size);
+
+	vch_item_replace_chunk(item, chunk, cchunk);
+	__vc_shmem_free_func(chunk);
+out:
+	zbx_free(data);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: converts compressed chunk back to uncompressed chunk so its       *
+ *          values can be modified                                            *
+ *                                                                            *
+ * Parameters: item  - [IN/OUT] the chunk owner item                          *
+ *             chunk - [IN] the compressed chunk                              *
+ *                                                                            *
+ * Return value: the uncompressed chunk or NULL if there was not enough       *
+ *               space in cache                                               *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_vc_chunk_t	*vch_item_decompress_chunk(zbx_vc_item_t *item, zbx_vc_chunk_t *chunk)
+{
+	zbx_vc_chunk_t	*dchunk;
+
+	if (0 == chunk->compressed_size)
+		return chunk;
+
+	if (NULL == (dchunk = (zbx_vc_chunk_t *)vc_item_malloc(item, sizeof(zbx_vc_chunk_t) +
+			sizeof(zbx_history_record_t) * (size_t)(chunk->slots_num - 1))))
+	{
+		return NULL;
+	}
+
+	memset(dchunk, 0, sizeof(zbx_vc_chunk_t));
+	dchunk->slots_num = chunk->slots_num;
+	dchunk->first_value = chunk->first_value;
+	dchunk->last_value = chunk->last_value;
+	memcpy(dchunk->slots, vch_chunk_values(chunk, item->value_type),
+			sizeof(zbx_history_record_t) * (size_t)chunk->slots_num);
+
+	vch_item_replace_chunk(item, chunk, dchunk);
+	__vc_shmem_free_func(chunk);
+
+	return dchunk;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: updates item range with current request range                     *
@@ -1320,7 +1817,7 @@ static void	vch_item_update_range(zbx_vc_item_t *item, int range, int now)
 		diff += 0xff;
 
 	if (NULL != item->head)
-		last_value_timestamp = item->head->slots[item->head->last_value].timestamp.sec;
+		last_value_timestamp = vch_chunk_timestamp(item->head, item->head->last_value, item->value_type)->sec;
 	else
 		last_value_timestamp = now;
 
@@ -1428,8 +1925,9 @@ static int	vch_item_add_chunk(zbx_vc_item_t *item, int nslots, zbx_vc_chunk_t *i
  * Purpose: find the index of the last value in chunk with timestamp less or  *
  *          equal to the specified timestamp.                                 *
  *                                                                            *
- * Parameters:  chunk - [IN] the chunk                                        *
- *              ts    - [IN] the target timestamp                             *
+ * Parameters:  chunk      - [IN] the chunk                                   *
+ *              value_type - [IN] the item value type                         *
+ *              ts         - [IN] the target timestamp                        *
  *                                                                            *
  * Return value: The index of the last value in chunk with timestamp less or  *
  *               equal to the specified timestamp.                            *
@@ -1437,12 +1935,14 @@ static int	vch_item_add_chunk(zbx_vc_item_t *item, int nslots, zbx_vc_chunk_t *i
  *               values have timestamps greater than the target timestamp).   *
  *                                                                            *
  ******************************************************************************/
-static int	vch_chunk_find_last_value_before(const zbx_vc_chunk_t *chunk, const zbx_timespec_t *ts)
+static int	vch_chunk_find_last_value_before(const zbx_vc_chunk_t *chunk, unsigned char value_type,
+		const zbx_timespec_t *ts)
 {
-	int	start = chunk->first_value, end = chunk->last_value, middle;
+	int				start = chunk->first_value, end = chunk->last_value, middle;
+	const zbx_history_record_t	*slots = vch_chunk_values(chunk, value_type);
 
 	/* check if the last value timestamp is already greater or equal to the specified timestamp */
-	if (0 >= zbx_timespec_compare(&chunk->slots[end].timestamp, ts))
+	if (0 >= zbx_timespec_compare(&slots[end].timestamp, ts))
 		return end;
 
 	/* chunk contains only one value, which did not pass the above check, return failure */
@@ -1454,13 +1954,13 @@ static int	vch_chunk_find_last_value_before(const zbx_vc_chunk_t *chunk, const z
 	{
 		middle = start + (end - start) / 2;
 
-		if (0 < zbx_timespec_compare(&chunk->slots[middle].timestamp, ts))
+		if (0 < zbx_timespec_compare(&slots[middle].timestamp, ts))
 		{
 			end = middle;
 			continue;
 		}
 
-		if (0 >= zbx_timespec_compare(&chunk->slots[middle + 1].timestamp, ts))
+		if (0 >= zbx_timespec_compare(&slots[middle + 1].timestamp, ts))
 		{
 			start = middle;
 			continue;
@@ -1502,16 +2002,16 @@ static int	vch_item_get_last_value(const zbx_vc_item_t *item, const zbx_timespec
 
 	index = chunk->last_value;
 
-	if (0 < zbx_timespec_compare(&chunk->slots[index].timestamp, ts))
+	if (0 < zbx_timespec_compare(vch_chunk_timestamp(chunk, index, item->value_type), ts))
 	{
-		while (0 < zbx_timespec_compare(&chunk->slots[chunk->first_value].timestamp, ts))
+		while (0 < zbx_timespec_compare(vch_chunk_timestamp(chunk, chunk->first_value, item->value_type), ts))
 		{
 			chunk = chunk->prev;
 			/* there are no values for requested range, return failure */
 			if (NULL == chunk)
 				return FAIL;
 		}
-		index = vch_chunk_find_last_value_before(chunk, ts);
+		index = vch_chunk_find_last_value_before(chunk, item->value_type, ts);
 	}
 
 	*pchunk = chunk;
@@ -1642,7 +2142,8 @@ static size_t	vch_item_free_chunk(zbx_vc_item_t *item, zbx_vc_chunk_t *chunk)
 {
 	size_t	freed;
 
-	freed = sizeof(zbx_vc_chunk_t) + (size_t)(chunk->slots_num - 1) * sizeof(zbx_history_record_t);
+	/* compressed chunks contain only numeric values, which are not dereferenced when freeing */
+	freed = vch_chunk_size(chunk);
 	freed += vc_item_free_values(item, chunk->slots, chunk->first_value, chunk->last_value);
 
 	__vc_shmem_free_func(chunk);
@@ -1692,15 +2193,17 @@ static void	vch_item_clean_cache(zbx_vc_item_t *item, int timestamp)
 	{
 		zbx_vc_chunk_t	*tail = item->tail;
 		zbx_vc_chunk_t	*chunk = tail;
+		int		head_sec, last_sec;
 
 		timestamp -= item->active_range;
+		head_sec = vch_chunk_timestamp(item->head, item->head->last_value, item->value_type)->sec;
 
 		/* Try to remove chunks with all history values older than maximum request range, maximum */
 		/* request range should be calculated from last received value with which active range    */
 		/* was calculated to avoid dropping of chunks that might be still used in count request.  */
-		while (NULL != chunk && chunk->slots[chunk->last_value].timestamp.sec < timestamp &&
-				chunk->slots[chunk->last_value].timestamp.sec !=
-						item->head->slots[item->head->last_value].timestamp.sec)
+		while (NULL != chunk &&
+				(last_sec = vch_chunk_timestamp(chunk, chunk->last_value, item->value_type)->sec) <
+				timestamp && last_sec != head_sec)
 		{
 			/* don't remove the head chunk */
 			if (NULL == (next = chunk->next))
@@ -1714,10 +2217,10 @@ static void	vch_item_clean_cache(zbx_vc_item_t *item, int timestamp)
 			/* In this case increase the first value index of the next chunk until the first  */
 			/* value timestamp is greater.                                                    */
 
-			if (next->slots[next->first_value].timestamp.sec != next->slots[next->last_value].timestamp.sec)
+			if (vch_chunk_timestamp(next, next->first_value, item->value_type)->sec !=
+					vch_chunk_timestamp(next, next->last_value, item->value_type)->sec)
 			{
-				while (next->slots[next->first_value].timestamp.sec ==
-						chunk->slots[chunk->last_value].timestamp.sec)
+				while (vch_chunk_timestamp(next, next->first_value, item->value_type)->sec == last_sec)
 				{
 					vc_item_free_values(item, next->slots, next->first_value, next->first_value);
 					next->first_value++;
@@ -1725,7 +2228,7 @@ static void	vch_item_clean_cache(zbx_vc_item_t *item, int timestamp)
 			}
 
 			/* set the database cached from timestamp to the last (oldest) removed value timestamp + 1 */
-			item->db_cached_from = chunk->slots[chunk->last_value].timestamp.sec + 1;
+			item->db_cached_from = last_sec + 1;
 
 			vch_item_remove_chunk(item, chunk);
 
@@ -1756,16 +2259,16 @@ static void	vch_item_remove_values(zbx_vc_item_t *item, int timestamp)
 		item->status = 0;
 
 	/* try to remove chunks with all history values older than the timestamp */
-	while (NULL != chunk && chunk->slots[chunk->first_value].timestamp.sec < timestamp)
+	while (NULL != chunk && vch_chunk_timestamp(chunk, chunk->first_value, item->value_type)->sec < timestamp)
 	{
 		zbx_vc_chunk_t	*next;
 
 		/* If chunk contains values with timestamp greater or equal - remove */
 		/* only the values with less timestamp. Otherwise remove the while   */
 		/* chunk and check next one.                                         */
-		if (chunk->slots[chunk->last_value].timestamp.sec >= timestamp)
+		if (vch_chunk_timestamp(chunk, chunk->last_value, item->value_type)->sec >= timestamp)
 		{
-			while (chunk->slots[chunk->first_value].timestamp.sec < timestamp)
+			while (vch_chunk_timestamp(chunk, chunk->first_value, item->value_type)->sec < timestamp)
 			{
 				vc_item_free_values(item, chunk->slots, chunk->first_value, chunk->first_value);
 				chunk->first_value++;
@@ -1780,6 +2283,68 @@ static void	vch_item_remove_values(zbx_vc_item_t *item, int timestamp)
 	}
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: removes cached values that are not newer than the specified       *
+ *          timestamp seconds, so they are read from database when requested  *
+ *                                                                            *
+ * Parameters:  item - [IN] the item                                          *
+ *              ts   - [IN] the timestamp                                     *
+ *                                                                            *
+ * Return value: SUCCEED - the values were removed                            *
+ *               FAIL - no values are left in cache, the item must be removed *
+ *                                                                            *
+ ******************************************************************************/
+static int	vch_item_uncache_values(zbx_vc_item_t *item, const zbx_timespec_t *ts)
+{
+	/* make sure no values with matching timestamp seconds are kept in cache */
+	vch_item_remove_values(item, ts->sec + 1);
+
+	/* empty items must be removed to avoid situation when a new value is added to cache */
+	/* while other values with matching timestamp seconds are not cached                 */
+	if (NULL == item->head)
+		return FAIL;
+
+	/* if the value is newer than the database cached from timestamp we must */
+	/* adjust the cached from timestamp to exclude this value                */
+	if (item->db_cached_from <= ts->sec)
+		item->db_cached_from = ts->sec + 1;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: decompresses chunks the values will be shifted in when inserting  *
+ *          a value older than the last cached value                          *
+ *                                                                            *
+ * Parameters:  item - [IN] the item                                          *
+ *              ts   - [IN] the inserted value timestamp                      *
+ *                                                                            *
+ * Return value: SUCCEED - the chunks were decompressed                       *
+ *               FAIL - there was not enough space in cache                   *
+ *                                                                            *
+ * Comments: Compressed chunks are read-only, so all affected chunks are      *
+ *           decompressed before shifting any value. This way a failure       *
+ *           leaves the cached values unchanged.                              *
+ *                                                                            *
+ ******************************************************************************/
+static int	vch_item_decompress_chunks_after(zbx_vc_item_t *item, const zbx_timespec_t *ts)
+{
+	zbx_vc_chunk_t	*chunk;
+
+	for (chunk = item->head; NULL != chunk; chunk = chunk->prev)
+	{
+		if (NULL == (chunk = vch_item_decompress_chunk(item, chunk)))
+			return FAIL;
+
+		if (0 >= zbx_timespec_compare(&chunk->slots[chunk->first_value].timestamp, ts))
+			break;
+	}
+
+	return SUCCEED;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: adds one item history value at the end of current item's history  *
@@ -1794,33 +2359,27 @@ static void	vch_item_remove_values(zbx_vc_item_t *item, int timestamp)
  * Comments: In the case of failure the item will be removed from cache       *
  *           later.                                                           *
  *                                                                            *
+ *           If a value older than the last cached value cannot be inserted   *
+ *           because compressed chunks cannot be decompressed, the cached     *
+ *           values up to the inserted value are dropped instead and read     *
+ *           from database when requested.                                    *
+ *                                                                            *
  ******************************************************************************/
 static int	vch_item_add_value_at_head(zbx_vc_item_t *item, const zbx_history_record_t *value)
 {
 	int		ret = FAIL, index, sindex, nslots = 0;
 	zbx_vc_chunk_t	*chunk, *schunk;
 
-	if (NULL != item->head &&
-			0 < zbx_history_record_compare_asc_func(&item->head->slots[item->head->last_value], value))
+	if (NULL != item->head && 0 < zbx_history_record_compare_asc_func(
+			&vch_chunk_values(item->head, item->value_type)[item->head->last_value], value))
 	{
-		if (0 < zbx_history_record_compare_asc_func(&item->tail->slots[item->tail->first_value], value))
+		/* If the added value has the same or older timestamp as the first value in cache */
+		/* we can't add it to keep cache consistency.                                     */
+		if (0 < zbx_history_record_compare_asc_func(
+				&vch_chunk_values(item->tail, item->value_type)[item->tail->first_value], value) ||
+				SUCCEED != vch_item_decompress_chunks_after(item, &value->timestamp))
 		{
-			/* If the added value has the same or older timestamp as the first value in cache */
-			/* we can't add it to keep cache consistency. Additionally we must make sure no   */
-			/* values with matching timestamp seconds are kept in cache.                      */
-			vch_item_remove_values(item, value->timestamp.sec + 1);
-
-			/* empty items must be removed to avoid situation when a new value is added to cache */
-			/* while other values with matching timestamp seconds are not cached                 */
-			if (NULL == item->head)
-				goto out;
-
-			/* if the value is newer than the database cached from timestamp we must */
-			/* adjust the cached from timestamp to exclude this value                */
-			if (item->db_cached_from <= value->timestamp.sec)
-				item->db_cached_from = value->timestamp.sec + 1;
-
-			ret = SUCCEED;
+			ret = vch_item_uncache_values(item, &value->timestamp);
 			goto out;
 		}
 
@@ -1865,7 +2424,7 @@ static int	vch_item_add_value_at_head(zbx_vc_item_t *item, const zbx_history_rec
 	else
 	{
 		/* find the number of free slots on the right side in last (head) chunk */
-		if (NULL != item->head)
+		if (NULL != item->head && 0 == item->head->compressed_size)
 			nslots = item->head->slots_num - item->head->last_value - 1;
 
 		if (0 == nslots)
@@ -1885,6 +2444,10 @@ static int	vch_item_add_value_at_head(zbx_vc_item_t *item, const zbx_history_rec
 	if (SUCCEED != vch_item_copy_value(item, chunk, index, value))
 		goto out;
 
+	/* the previous chunk will not receive new values after a new head chunk was added */
+	if (item->head->first_value == item->head->last_value && NULL != item->head->prev)
+		vch_item_compress_chunk(item, item->head->prev);
+
 	ret = SUCCEED;
 out:
 	return ret;
@@ -1913,7 +2476,7 @@ static int	vch_item_add_values_at_tail(zbx_vc_item_t *item, const zbx_history_re
 	/* skip values already added to the item cache by another process */
 	if (NULL != item->tail)
 	{
-		int	sec = item->tail->slots[item->tail->first_value].timestamp.sec;
+		int	sec = vch_chunk_timestamp(item->tail, item->tail->first_value, item->value_type)->sec;
 
 		while (--count >= 0 && values[count].timestamp.sec >= sec)
 			;
@@ -1925,7 +2488,7 @@ static int	vch_item_add_values_at_tail(zbx_vc_item_t *item, const zbx_history_re
 		int	copy_slots, nslots = 0;
 
 		/* find the number of free slots on the left side in first (tail) chunk */
-		if (NULL != item->tail)
+		if (NULL != item->tail && 0 == item->tail->compressed_size)
 			nslots = item->tail->first_value;
 
 		if (0 == nslots)
@@ -1945,6 +2508,10 @@ static int	vch_item_add_values_at_tail(zbx_vc_item_t *item, const zbx_history_re
 
 		if (FAIL == vch_item_copy_values_at_tail(item, values + count, copy_slots))
 			goto out;
+
+		/* full tail chunk will not receive new values unless it's also the head chunk */
+		if (0 == item->tail->first_value && item->tail != item->head)
+			vch_item_compress_chunk(item, item->tail);
 	}
 
 	ret = SUCCEED;
@@ -1984,7 +2551,7 @@ static int	vch_item_cache_values_by_time(zbx_vc_item_t **item, int range_start)
 	if (NULL != (*item)->tail)
 	{
 		/* we need to get item values before the first cached value, but not including it */
-		range_end = (*item)->tail->slots[(*item)->tail->first_value].timestamp.sec - 1;
+		range_end = vch_chunk_timestamp((*item)->tail, (*item)->tail->first_value, (*item)->value_type)->sec - 1;
 	}
 	else
 		range_end = ZBX_JAN_2038;
@@ -2093,7 +2660,7 @@ static int	vch_item_cache_values_by_time_and_count(zbx_vc_item_t **item, int ran
 
 	/* get the end timestamp to which (including) the values should be cached */
 	if (0 != (*item)->db_cached_from && NULL != (*item)->head)
-		range_end = (*item)->tail->slots[(*item)->tail->first_value].timestamp.sec - 1;
+		range_end = vch_chunk_timestamp((*item)->tail, (*item)->tail->first_value, (*item)->value_type)->sec - 1;
 	else
 		range_end = ZBX_JAN_2038;
 
@@ -2152,7 +2719,7 @@ static int	vch_item_cache_values_by_time_and_count(zbx_vc_item_t **item, int ran
 	if ((count <= records.values_num || 0 == range_start) && 0 != records.values_num)
 	{
 		vc_item_update_db_cached_from(*item,
-				(*item)->tail->slots[(*item)->tail->first_value].timestamp.sec);
+				vch_chunk_timestamp((*item)->tail, (*item)->tail->first_value, (*item)->value_type)->sec);
 	}
 	else if (0 != range_start)
 		vc_item_update_db_cached_from(*item, range_start);
@@ -2163,23 +2730,49 @@ out:
 	return ret;
 }
 
+/* vch_item_process_values() callback data to append values to vector */
+typedef struct
+{
+	zbx_vector_history_record_t	*values;
+	int				value_type;
+}
+zbx_vc_append_data_t;
+
 /******************************************************************************
  *                                                                            *
- * Purpose: retrieves item history data from cache                            *
+ * Purpose: appends value to history record vector                            *
+ *                                                                            *
+ ******************************************************************************/
+static int	vc_append_value_cb(const zbx_history_record_t *value, void *data)
+{
+	zbx_vc_append_data_t	*append = (zbx_vc_append_data_t *)data;
+
+	vc_history_record_vector_append(append->values, append->value_type, value);
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: processes item history data from cache                            *
  *                                                                            *
  * Parameters: item      - [IN] the item                                      *
- *             values    - [OUT] the item history data stored time/value      *
- *                         pairs in undefined order                           *
  *             seconds   - [IN] the time period to retrieve data for          *
  *             ts        - [IN] the requested period end timestamp            *
+ *             value_cb  - [IN] the callback to process values with, values   *
+ *                              are processed from newest to oldest           *
+ *             data      - [IN] the callback data                             *
+ *                                                                            *
+ * Return value: the number of processed values                               *
  *                                                                            *
  ******************************************************************************/
-static void	vch_item_get_values_by_time(const zbx_vc_item_t *item, zbx_vector_history_record_t *values, int seconds,
-		const zbx_timespec_t *ts)
+static int	vch_item_process_values_by_time(const zbx_vc_item_t *item, int seconds, const zbx_timespec_t *ts,
+		zbx_vc_value_cb_t value_cb, void *data)
 {
-	int		index, now;
-	zbx_timespec_t	start = {ts->sec - seconds, ts->ns};
-	zbx_vc_chunk_t	*chunk;
+	int				index, now, values_num = 0;
+	zbx_timespec_t			start = {ts->sec - seconds, ts->ns};
+	zbx_vc_chunk_t			*chunk;
+	const zbx_history_record_t	*slots;
 
 	now = (int)time(NULL);
 	/* add another second to include nanosecond shifts */
@@ -2189,43 +2782,52 @@ static void	vch_item_get_values_by_time(const zbx_vc_item_t *item, zbx_vector_hi
 	{
 		/* Cache does not contain records for the specified timeshift & seconds range. */
 		/* Return empty vector with success.                                           */
-		return;
+		return 0;
 	}
 
-	/* fill the values vector with item history values until the start timestamp is reached */
-	while (0 < zbx_timespec_compare(&chunk->slots[chunk->last_value].timestamp, &start))
+	/* process item history values until the start timestamp is reached */
+	while (0 < zbx_timespec_compare(&(slots = vch_chunk_values(chunk, item->value_type))[chunk->last_value].timestamp,
+			&start))
 	{
-		while (index >= chunk->first_value && 0 < zbx_timespec_compare(&chunk->slots[index].timestamp, &start))
-			vc_history_record_vector_append(values, item->value_type, &chunk->slots[index--]);
+		while (index >= chunk->first_value && 0 < zbx_timespec_compare(&slots[index].timestamp, &start))
+		{
+			values_num++;
+
+			if (SUCCEED != value_cb(&slots[index--], data))
+				return values_num;
+		}
 
 		if (NULL == (chunk = chunk->prev))
 			break;
 
 		index = chunk->last_value;
 	}
+
+	return values_num;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: retrieves item history data from cache                            *
+ * Purpose: processes item history data from cache                            *
  *                                                                            *
  * Parameters: item      - [IN] the item                                      *
- *             values    - [OUT] the item history data stored time/value      *
- *                         pairs in undefined order, optional                 *
- *                         If null then cache is updated if necessary, but no *
- *                         values are returned. Used to ensure that cache     *
- *                         contains a value of the specified timestamp.       *
  *             seconds   - [IN] the time period                               *
  *             count     - [IN] the number of history values to retrieve      *
- *             timestamp - [IN] the target timestamp                          *
+ *             ts        - [IN] the target timestamp                          *
+ *             value_cb  - [IN] the callback to process values with, values   *
+ *                              are processed from newest to oldest           *
+ *             data      - [IN] the callback data                             *
+ *                                                                            *
+ * Return value: the number of processed values                               *
  *                                                                            *
  ******************************************************************************/
-static void	vch_item_get_values_by_time_and_count(zbx_vc_item_t *item, zbx_vector_history_record_t *values,
-		int seconds, int count, const zbx_timespec_t *ts)
+static int	vch_item_process_values_by_time_and_count(zbx_vc_item_t *item, int seconds, int count,
+		const zbx_timespec_t *ts, zbx_vc_value_cb_t value_cb, void *data)
 {
-	int		index, now, range_timestamp;
-	zbx_vc_chunk_t	*chunk;
-	zbx_timespec_t	start;
+	int				index, now, range_timestamp, values_num = 0, last_sec = 0;
+	zbx_vc_chunk_t			*chunk;
+	zbx_timespec_t			start;
+	const zbx_history_record_t	*slots;
 
 	/* set start timestamp of the requested time period */
 	if (0 != seconds)
@@ -2245,16 +2847,22 @@ static void	vch_item_get_values_by_time_and_count(zbx_vc_item_t *item, zbx_vecto
 		goto out;
 	}
 
-	/* fill the values vector with item history values until the <count> values are read    */
-	/* or no more values within specified time period                                       */
-	/* fill the values vector with item history values until the start timestamp is reached */
-	while (0 < zbx_timespec_compare(&chunk->slots[chunk->last_value].timestamp, &start))
+	/* process item history values until the <count> values are read or no more values */
+	/* within specified time period                                                     */
+	while (0 < zbx_timespec_compare(&(slots = vch_chunk_values(chunk, item->value_type))[chunk->last_value].timestamp,
+			&start))
 	{
-		while (index >= chunk->first_value && 0 < zbx_timespec_compare(&chunk->slots[index].timestamp, &start))
+		while (index >= chunk->first_value && 0 < zbx_timespec_compare(&slots[index].timestamp, &start))
 		{
-			vc_history_record_vector_append(values, item->value_type, &chunk->slots[index--]);
+			last_sec = slots[index].timestamp.sec;
+			values_num++;
 
-			if (values->values_num == count)
+			/* the processing was stopped before reaching the requested range end, */
+			/* so the range cannot be updated                                      */
+			if (SUCCEED != value_cb(&slots[index--], data) && values_num != count)
+				return values_num;
+
+			if (values_num == count)
 				goto out;
 		}
 
@@ -2264,10 +2872,10 @@ static void	vch_item_get_values_by_time_and_count(zbx_vc_item_t *item, zbx_vecto
 		index = chunk->last_value;
 	}
 out:
-	if (count > values->values_num)
+	if (count > values_num)
 	{
 		if (0 == seconds)
-			return;
+			return values_num;
 
 		/* set the range equal to the period plus one second to include nanosecond shifts */
 		range_timestamp = ts->sec - seconds;
@@ -2275,45 +2883,45 @@ out:
 	else
 	{
 		/* the requested number of values was retrieved, set the range to the oldest value timestamp */
-		range_timestamp = values->values[values->values_num - 1].timestamp.sec - 1;
+		range_timestamp = last_sec - 1;
 	}
 
 	now = (int)time(NULL);
 	vc_cache_item_update(item->itemid, ZBX_VC_UPDATE_RANGE, now - range_timestamp, now);
+
+	return values_num;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: get item values for the specified range                           *
+ * Purpose: processes item values for the specified range                     *
  *                                                                            *
  * Parameters: item      - [IN] the item                                      *
- *             values    - [OUT] the item history data stored time/value      *
- *                         pairs in undefined order, optional                 *
- *                         If null then cache is updated if necessary, but no *
- *                         values are returned. Used to ensure that cache     *
- *                         contains a value of the specified timestamp.       *
  *             seconds   - [IN] the time period to retrieve data for          *
  *             count     - [IN] the number of history values to retrieve      *
  *             ts        - [IN] the target timestamp                          *
+ *             value_cb  - [IN] the callback to process values with           *
+ *             data      - [IN] the callback data                             *
  *                                                                            *
- * Return value:  SUCCEED - the item history data was retrieved successfully  *
+ * Return value:  SUCCEED - the item history data was processed successfully  *
  *                FAIL    - the item history data was not retrieved           *
  *                                                                            *
- * Comments: This function returns data from cache if necessary updating it   *
- *           from DB. If cache update was required and failed (not enough     *
+ * Comments: This function processes data from cache if necessary updating    *
+ *           it from DB. If cache update was required and failed (not enough  *
  *           memory to cache DB values), then this function also fails.       *
  *                                                                            *
  *           If <count> is set then value range is defined as <count> values  *
  *           before <timestamp>. Otherwise the range is defined as <seconds>  *
  *           seconds before <timestamp>.                                      *
  *                                                                            *
+ *           The callback is called while holding the cache lock, so it must  *
+ *           not access value cache.                                          *
+ *                                                                            *
  ******************************************************************************/
-static int	vch_item_get_values(zbx_vc_item_t *item, zbx_vector_history_record_t *values, int seconds,
-		int count, const zbx_timespec_t *ts)
+static int	vch_item_process_values(zbx_vc_item_t *item, int seconds, int count, const zbx_timespec_t *ts,
+		zbx_vc_value_cb_t value_cb, void *data)
 {
-	int	ret, records_read, hits, misses, range_start;
-
-	zbx_vector_history_record_clear(values);
+	int	ret, records_read, hits, misses, range_start, values_num;
 
 	if (0 == count)
 	{
@@ -2325,10 +2933,7 @@ static int	vch_item_get_values(zbx_vc_item_t *item, zbx_vector_history_record_t
 
 		records_read = ret;
 
-		vch_item_get_values_by_time(item, values, seconds, ts);
-
-		if (records_read > values->values_num)
-			records_read = values->values_num;
+		values_num = vch_item_process_values_by_time(item, seconds, ts, value_cb, data);
 	}
 	else
 	{
@@ -2339,13 +2944,13 @@ static int	vch_item_get_values(zbx_vc_item_t *item, zbx_vector_history_record_t
 
 		records_read = ret;
 
-		vch_item_get_values_by_time_and_count(item, values, seconds, count, ts);
-
-		if (records_read > values->values_num)
-			records_read = values->values_num;
+		values_num = vch_item_process_values_by_time_and_count(item, seconds, count, ts, value_cb, data);
 	}
 
-	hits = values->values_num - records_read;
+	if (records_read > values_num)
+		records_read = values_num;
+
+	hits = values_num - records_read;
 	misses = records_read;
 
 	vc_cache_item_update(item->itemid, ZBX_VC_UPDATE_STATS, hits, misses);
@@ -2394,8 +2999,13 @@ static size_t	vch_item_free_cache(zbx_vc_item_t *item)
  *                                                                            *
  * Purpose: initializes value cache                                           *
  *                                                                            *
+ * Parameters: value_cache_size        - [IN] the value cache size in bytes   *
+ *             value_cache_compression - [IN] 1 - compress numeric values     *
+ *                                            stored in cache, 0 - otherwise  *
+ *             error                   - [OUT] the error message              *
+ *                                                                            *
  ******************************************************************************/
-int	zbx_vc_init(zbx_uint64_t value_cache_size, char **error)
+int	zbx_vc_init(zbx_uint64_t value_cache_size, int value_cache_compression, char **error)
 {
 	zbx_uint64_t	size_reserved;
 	int		ret = FAIL;
@@ -2403,6 +3013,9 @@ int	zbx_vc_init(zbx_uint64_t value_cache_size, char **error)
 	if (0 == value_cache_size)
 		return SUCCEED;
 
+	vc_compression = value_cache_compression;
+	vc_decoded_id = 0;
+
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
 	if (SUCCEED != (ret = zbx_rwlock_create(&vc_lock, ZBX_RWLOCK_VALUECACHE, error)))
@@ -2411,7 +3024,7 @@ int	zbx_vc_init(zbx_uint64_t value_cache_size, char **error)
 	size_reserved = zbx_shmem_required_size(1, "value cache size", "ValueCacheSize");
 
 	if (SUCCEED != zbx_shmem_create(&vc_mem, value_cache_size, "value cache size", "ValueCacheSize", 1,
-			error))
+			ZBX_SHMEM_ALLOC_BESTFIT, error))
 	{
 		goto out;
 	}
@@ -2585,7 +3198,7 @@ int	zbx_vc_add_values(zbx_vector_dc_history_ptr_t *history, int *ret_flush, int
 			int			last_value_timestamp;
 
 			if (NULL != head)
-				last_value_timestamp = head->slots[head->last_value].timestamp.sec;
+				last_value_timestamp = vch_chunk_timestamp(head, head->last_value, item->value_type)->sec;
 			else
 				last_value_timestamp = (int)time(NULL);
 
@@ -2637,6 +3250,82 @@ int	zbx_vc_add_values(zbx_vector_dc_history_ptr_t *history, int *ret_flush, int
  ******************************************************************************/
 int	zbx_vc_get_values(zbx_uint64_t itemid, unsigned char value_type, zbx_vector_history_record_t *values,
 		int seconds, int count, const zbx_timespec_t *ts)
+{
+	zbx_vc_append_data_t	append = {.values = values, .value_type = value_type};
+
+	zbx_vector_history_record_clear(values);
+
+	return zbx_vc_process_values(itemid, value_type, seconds, count, ts, vc_append_value_cb, &append);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get the last history value with a timestamp less or equal to the  *
+ *          target timestamp                                                  *
+ *                                                                            *
+ * Parameters: itemid     - [IN] the item id                                  *
+ *             value_type - [IN] the item value type                          *
+ *             ts         - [IN] the target timestamp                         *
+ *             value      - [OUT] the value found                             *
+ *                                                                            *
+ * Return Value: SUCCEED - the item was retrieved                             *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: Depending on the value type this function might allocate memory  *
+ *           to store value data. To free it use zbx_vc_history_value_clear() *
+ *           function.                                                        *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_vc_get_value(zbx_uint64_t itemid, unsigned char value_type, const zbx_timespec_t *ts,
+		zbx_history_record_t *value)
+{
+	zbx_vector_history_record_t	values;
+	int				ret = FAIL;
+
+	zbx_history_record_vector_create(&values);
+
+	if (SUCCEED != zbx_vc_get_values(itemid, value_type, &values, ts->sec, 1, ts) || 0 == values.values_num)
+		goto out;
+
+	*value = values.values[0];
+
+	/* reset values vector size so the returned value is not cleared when destroying the vector */
+	values.values_num = 0;
+
+	ret = SUCCEED;
+out:
+	zbx_history_record_vector_destroy(&values, value_type);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: processes item history data for the specified time period without *
+ *          copying it                                                        *
+ *                                                                            *
+ * Parameters: itemid     - [IN] the item id                                  *
+ *             value_type - [IN] the item value type                          *
+ *             seconds    - [IN] the time period to retrieve data for         *
+ *             count      - [IN] the number of history values to retrieve     *
+ *             ts         - [IN] the period end timestamp                     *
+ *             value_cb   - [IN] the callback to process values with, values  *
+ *                               are processed from newest to oldest          *
+ *             data       - [IN] the callback data                            *
+ *                                                                            *
+ * Return value:  SUCCEED - the item history data was processed successfully  *
+ *                FAIL    - the item history data was not retrieved           *
+ *                                                                            *
+ * Comments: The range is defined the same way as in zbx_vc_get_values().     *
+ *                                                                            *
+ *           When values are cached the callback is called while holding the  *
+ *           cache lock, so it must be fast and must not call value cache     *
+ *           functions. The processed values must not be referenced after     *
+ *           callback returns.                                                *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_vc_process_values(zbx_uint64_t itemid, unsigned char value_type, int seconds, int count,
+		const zbx_timespec_t *ts, zbx_vc_value_cb_t value_cb, void *data)
 {
 	zbx_vc_item_t	*item, new_item;
 	int 		ret = FAIL, cache_used = 1;
@@ -2668,70 +3357,145 @@ int	zbx_vc_get_values(zbx_uint64_t itemid, unsigned char value_type, zbx_vector_
 	else if (item->value_type != value_type)
 		goto out;
 
-	ret = vch_item_get_values(item, values, seconds, count, ts);
+	ret = vch_item_process_values(item, seconds, count, ts, value_cb, data);
 out:
 	if (FAIL == ret)
 	{
+		zbx_vector_history_record_t	values;
+		int				i;
+
 		cache_used = 0;
 
 		UNLOCK_CACHE;
-		ret = vc_db_get_values(itemid, value_type, values, seconds, count, ts);
+
+		zbx_history_record_vector_create(&values);
+
+		if (SUCCEED == (ret = vc_db_get_values(itemid, value_type, &values, seconds, count, ts)))
+		{
+			for (i = 0; i < values.values_num && SUCCEED == value_cb(&values.values[i], data); i++)
+				;
+		}
+
 		WRLOCK_CACHE;
 
 		if (ZBX_VC_DISABLED != vc_state)
 			vc_remove_item_by_id(itemid);
 
 		if (SUCCEED == ret)
-			vc_update_statistics(NULL, 0, values->values_num, (int)time(NULL));
+			vc_update_statistics(NULL, 0, values.values_num, (int)time(NULL));
+
+		zbx_history_record_vector_destroy(&values, value_type);
 	}
 
 	UNLOCK_CACHE;
 
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s count:%d cached:%d",
-			__func__, zbx_result_string(ret), values->values_num, cache_used);
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s cached:%d", __func__, zbx_result_string(ret), cache_used);
 
 	return ret;
 }
 
+/* zbx_vc_get_aggregate() callback data */
+typedef struct
+{
+	zbx_vc_aggregate_t	*aggregate;
+	unsigned char		value_type;
+}
+zbx_vc_aggregate_data_t;
+
 /******************************************************************************
  *                                                                            *
- * Purpose: get the last history value with a timestamp less or equal to the  *
- *          target timestamp                                                  *
+ * Purpose: adds value to numeric aggregate                                   *
+ *                                                                            *
+ ******************************************************************************/
+static int	vc_aggregate_value_cb(const zbx_history_record_t *value, void *data)
+{
+	zbx_vc_aggregate_data_t	*ad = (zbx_vc_aggregate_data_t *)data;
+	zbx_vc_aggregate_t	*agg = ad->aggregate;
+
+	if (ITEM_VALUE_TYPE_FLOAT == ad->value_type)
+	{
+		double	dbl = value->value.dbl;
+
+		if (0 == agg->values_num)
+		{
+			agg->min.dbl = dbl;
+			agg->max.dbl = dbl;
+		}
+		else
+		{
+			if (dbl < agg->min.dbl)
+				agg->min.dbl = dbl;
+			if (dbl > agg->max.dbl)
+				agg->max.dbl = dbl;
+		}
+
+		agg->sum.dbl += dbl;
+		agg->avg += dbl / (agg->values_num + 1) - agg->avg / (agg->values_num + 1);
+	}
+	else
+	{
+		zbx_uint64_t	ui64 = value->value.ui64;
+
+		if (0 == agg->values_num)
+		{
+			agg->min.ui64 = ui64;
+			agg->max.ui64 = ui64;
+		}
+		else
+		{
+			if (ui64 < agg->min.ui64)
+				agg->min.ui64 = ui64;
+			if (ui64 > agg->max.ui64)
+				agg->max.ui64 = ui64;
+		}
+
+		agg->sum.ui64 += ui64;
+		agg->avg += (double)ui64;
+	}
+
+	agg->values_num++;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: calculates sum, minimum, maximum and average of numeric item      *
+ *          values for the specified time period without copying them         *
  *                                                                            *
  * Parameters: itemid     - [IN] the item id                                  *
- *             value_type - [IN] the item value type                          *
- *             ts         - [IN] the target timestamp                         *
- *             value      - [OUT] the value found                             *
+ *             value_type - [IN] the item value type (float or unsigned)      *
+ *             seconds    - [IN] the time period to retrieve data for         *
+ *             count      - [IN] the number of history values to retrieve     *
+ *             ts         - [IN] the period end timestamp                     *
+ *             aggregate  - [OUT] the value aggregate                         *
  *                                                                            *
- * Return Value: SUCCEED - the item was retrieved                             *
- *               FAIL    - otherwise                                          *
+ * Return value:  SUCCEED - the aggregate was calculated successfully         *
+ *                FAIL    - the item history data was not retrieved           *
  *                                                                            *
- * Comments: Depending on the value type this function might allocate memory  *
- *           to store value data. To free it use zbx_vc_history_value_clear() *
- *           function.                                                        *
+ * Comments: The aggregated values are accumulated from newest to oldest      *
+ *           value, giving the same results as processing values returned by  *
+ *           zbx_vc_get_values() in order. The minimum, maximum and average   *
+ *           are valid only if values_num is not zero.                        *
  *                                                                            *
  ******************************************************************************/
-int	zbx_vc_get_value(zbx_uint64_t itemid, unsigned char value_type, const zbx_timespec_t *ts,
-		zbx_history_record_t *value)
+int	zbx_vc_get_aggregate(zbx_uint64_t itemid, unsigned char value_type, int seconds, int count,
+		const zbx_timespec_t *ts, zbx_vc_aggregate_t *aggregate)
 {
-	zbx_vector_history_record_t	values;
-	int				ret = FAIL;
+	zbx_vc_aggregate_data_t	ad = {.aggregate = aggregate, .value_type = value_type};
 
-	zbx_history_record_vector_create(&values);
-
-	if (SUCCEED != zbx_vc_get_values(itemid, value_type, &values, ts->sec, 1, ts) || 0 == values.values_num)
-		goto out;
+	if (ITEM_VALUE_TYPE_FLOAT != value_type && ITEM_VALUE_TYPE_UINT64 != value_type)
+		return FAIL;
 
-	*value = values.values[0];
+	memset(aggregate, 0, sizeof(zbx_vc_aggregate_t));
 
-	/* reset values vector size so the returned value is not cleared when destroying the vector */
-	values.values_num = 0;
+	if (SUCCEED != zbx_vc_process_values(itemid, value_type, seconds, count, ts, vc_aggregate_value_cb, &ad))
+		return FAIL;
 
-	ret = SUCCEED;
-out:
-	zbx_history_record_vector_destroy(&values, value_type);
+	if (ITEM_VALUE_TYPE_UINT64 == value_type && 0 != aggregate->values_num)
+		aggregate->avg /= aggregate->values_num;
 
-	return ret;
+	return SUCCEED;
 }
 
 /******************************************************************************
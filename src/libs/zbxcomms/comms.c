@@ -1586,29 +1586,23 @@ void	zbx_tcp_unlisten(zbx_socket_t *s)
 
 /******************************************************************************
  *                                                                            *
- * Purpose: permits an incoming connection attempt on a socket                *
+ * Purpose: accepts TCP connection without reading any data from it          *
  *                                                                            *
- * Parameters: s              - [IN/OUT] socket to listen                     *
- *             tls_accept     - [IN] TLS configuration                        *
- *             poll_timeout   - [IN] milliseconds to wait for connection      *
- *                                  0 - don't wait, -1 - wait forever         *
- *             tls_listen     - [IN] allow unencrypted inbound                *
- *             unencrypted_allowed_ip - [IN]                                  *
+ * Parameters: s            - [IN/OUT] socket to listen                       *
+ *             poll_timeout - [IN] milliseconds to wait for connection        *
+ *                                 0 - don't wait, -1 - wait forever          *
  *                                                                            *
  * Return value: SUCCEED       - success                                      *
  *               FAIL          - an error occurred                            *
  *               TIMEOUT_ERROR - no connections for the timeout period        *
  *                                                                            *
  ******************************************************************************/
-int	zbx_tcp_accept(zbx_socket_t *s, unsigned int tls_accept, int poll_timeout, char *tls_listen,
-		const char *unencrypted_allowed_ip)
+static int	tcp_accept_connection(zbx_socket_t *s, int poll_timeout)
 {
 	ZBX_SOCKADDR	serv_addr;
 	ZBX_SOCKET	accepted_socket;
 	ZBX_SOCKLEN_T	nlen;
 	int		i, ret = FAIL;
-	ssize_t		res;
-	char		buf;	/* 1 byte buffer */
 	zbx_pollfd_t	*pds;
 
 	zbx_tcp_unaccept(s);
@@ -1637,6 +1631,8 @@ int	zbx_tcp_accept(zbx_socket_t *s, unsigned int tls_accept, int poll_timeout, c
 		goto out;
 	}
 
+	ret = FAIL;
+
 	for (i = 0; i < s->num_socks; i++)
 	{
 		if (0 != (pds[i].revents & POLLIN))
@@ -1685,54 +1681,131 @@ int	zbx_tcp_accept(zbx_socket_t *s, unsigned int tls_accept, int poll_timeout, c
 		goto out;
 	}
 
-	zbx_socket_set_deadline(s, s->timeout);
+	ret = SUCCEED;
+out:
+	zbx_free(pds);
 
-	if (FAIL == (res = tcp_peek(s, &buf, 1)) || TIMEOUT_ERROR == res)
-	{
-		zbx_set_socket_strerror("from %s: reading first byte from connection failed: %s", s->peer,
-				zbx_strerror_from_system(zbx_socket_last_error()));
-		zbx_tcp_unaccept(s);
-		goto out;
-	}
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: detects whether accepted connection is encrypted and performs     *
+ *          TLS handshake if it is                                            *
+ *                                                                            *
+ * Parameters: s          - [IN/OUT] accepted socket                          *
+ *             tls_accept - [IN] TLS configuration                            *
+ *             event      - [OUT] NULL to wait for the handshake to complete  *
+ *                                or events to wait for before calling the    *
+ *                                function again                              *
+ *                                                                            *
+ * Return value: SUCCEED - connection is ready for data exchange              *
+ *               FAIL    - an error occurred (socket error message is set)    *
+ *                         or retry is needed if event is filled              *
+ *                                                                            *
+ * Comments: Non-blocking mode is used to finish accepting connection         *
+ *           accepted by zbx_tcp_accept_nowait().                             *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_tcp_accept_handshake(zbx_socket_t *s, unsigned int tls_accept, short *event)
+{
+	ssize_t	res;
+	char	buf;	/* 1 byte buffer */
+
+	if (NULL != event)
+		*event = 0;
 
-	/* if the 1st byte is 0x16 then assume it's a TLS connection */
-	if (1 == res && '\x16' == buf)
-	{
 #if defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL)
-		if (0 != (tls_accept & (ZBX_TCP_SEC_TLS_CERT | ZBX_TCP_SEC_TLS_PSK)))
+	/* TLS context exists if the handshake is being continued */
+	if (NULL == s->tls_ctx)
+#endif
+	{
+		if (NULL == event)
+			res = tcp_peek(s, &buf, 1);
+		else if (ZBX_PROTO_ERROR == (res = ZBX_TCP_RECV(s->socket, &buf, 1, MSG_PEEK)) &&
+				SUCCEED == zbx_socket_had_nonblocking_error())
 		{
-			char	*error = NULL;
+			*event = POLLIN;
+			return FAIL;
+		}
 
-			if (SUCCEED != zbx_tls_accept(s, tls_accept, &error))
-			{
-				zbx_set_socket_strerror("from %s: %s", s->peer, error);
-				zbx_tcp_unaccept(s);
-				zbx_free(error);
-				goto out;
-			}
+		if (FAIL == res || TIMEOUT_ERROR == res)
+		{
+			zbx_set_socket_strerror("from %s: reading first byte from connection failed: %s", s->peer,
+					zbx_strerror_from_system(zbx_socket_last_error()));
+			return FAIL;
 		}
-		else
+
+		/* if the 1st byte is 0x16 then assume it's a TLS connection */
+		if (1 != res || '\x16' != buf)
 		{
-			zbx_set_socket_strerror("from %s: TLS connections are not allowed", s->peer);
-			zbx_tcp_unaccept(s);
-			goto out;
+			if (0 == (tls_accept & ZBX_TCP_SEC_UNENCRYPTED))
+			{
+				zbx_set_socket_strerror("from %s: unencrypted connections are not allowed", s->peer);
+				return FAIL;
+			}
+
+			s->connection_type = ZBX_TCP_SEC_UNENCRYPTED;
+
+			return SUCCEED;
 		}
-#else
-		zbx_set_socket_strerror("from %s: support for TLS was not compiled in", s->peer);
-		zbx_tcp_unaccept(s);
-		goto out;
-#endif
 	}
-	else
+
+#if defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL)
+	if (0 != (tls_accept & (ZBX_TCP_SEC_TLS_CERT | ZBX_TCP_SEC_TLS_PSK)))
 	{
-		if (0 == (tls_accept & ZBX_TCP_SEC_UNENCRYPTED))
+		char	*error = NULL;
+
+		if (SUCCEED != zbx_tls_accept(s, tls_accept, event, &error))
 		{
-			zbx_set_socket_strerror("from %s: unencrypted connections are not allowed", s->peer);
-			zbx_tcp_unaccept(s);
-			goto out;
+			if (NULL != event && 0 != *event)
+				return FAIL;
+
+			zbx_set_socket_strerror("from %s: %s", s->peer, error);
+			zbx_free(error);
+			return FAIL;
 		}
 
-		s->connection_type = ZBX_TCP_SEC_UNENCRYPTED;
+		return SUCCEED;
+	}
+
+	zbx_set_socket_strerror("from %s: TLS connections are not allowed", s->peer);
+#else
+	zbx_set_socket_strerror("from %s: support for TLS was not compiled in", s->peer);
+#endif
+	return FAIL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: permits an incoming connection attempt on a socket                *
+ *                                                                            *
+ * Parameters: s              - [IN/OUT] socket to listen                     *
+ *             tls_accept     - [IN] TLS configuration                        *
+ *             poll_timeout   - [IN] milliseconds to wait for connection      *
+ *                                  0 - don't wait, -1 - wait forever         *
+ *             tls_listen     - [IN] allow unencrypted inbound                *
+ *             unencrypted_allowed_ip - [IN]                                  *
+ *                                                                            *
+ * Return value: SUCCEED       - success                                      *
+ *               FAIL          - an error occurred                            *
+ *               TIMEOUT_ERROR - no connections for the timeout period        *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_tcp_accept(zbx_socket_t *s, unsigned int tls_accept, int poll_timeout, char *tls_listen,
+		const char *unencrypted_allowed_ip)
+{
+	int	ret;
+
+	if (SUCCEED != (ret = tcp_accept_connection(s, poll_timeout)))
+		return ret;
+
+	zbx_socket_set_deadline(s, s->timeout);
+
+	if (SUCCEED != zbx_tcp_accept_handshake(s, tls_accept, NULL))
+	{
+		zbx_tcp_unaccept(s);
+		return FAIL;
 	}
 
 	s->max_len_limit = 0;
@@ -1743,7 +1816,7 @@ int	zbx_tcp_accept(zbx_socket_t *s, unsigned int tls_accept, int poll_timeout, c
 		{
 			zbx_set_socket_strerror("from %s: unencrypted connections are not allowed", s->peer);
 			zbx_tcp_unaccept(s);
-			goto out;
+			return FAIL;
 		}
 		else
 		{
@@ -1754,9 +1827,27 @@ int	zbx_tcp_accept(zbx_socket_t *s, unsigned int tls_accept, int poll_timeout, c
 
 	zbx_socket_set_deadline(s, 0);
 
-	ret = SUCCEED;
-out:
-	zbx_free(pds);
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: accepts pending incoming connection without waiting for the peer  *
+ *          to send data                                                      *
+ *                                                                            *
+ * Return value: SUCCEED       - connection was accepted                      *
+ *               FAIL          - an error occurred                            *
+ *               TIMEOUT_ERROR - no pending connections                       *
+ *                                                                            *
+ * Comments: Call zbx_tcp_accept_handshake() to finish accepting connection.  *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_tcp_accept_nowait(zbx_socket_t *s)
+{
+	int	ret;
+
+	if (SUCCEED == (ret = tcp_accept_connection(s, 0)))
+		s->max_len_limit = 0;
 
 	return ret;
 }
@@ -1501,39 +1501,26 @@ out1:
 
 /******************************************************************************
  *                                                                            *
- * Purpose: establish a TLS connection over an accepted TCP connection        *
+ * Purpose: set up TLS session for accepted TCP connection                    *
  *                                                                            *
  * Parameters:                                                                *
  *     s          - [IN] socket with opened connection                        *
+ *     tls_accept - [IN] type of connection to accept                         *
  *     error      - [OUT] dynamically allocated memory with error message     *
- *     tls_accept - [IN] type of connection to accept. Can be be either       *
- *                       ZBX_TCP_SEC_TLS_CERT or ZBX_TCP_SEC_TLS_PSK, or      *
- *                       a bitwise 'OR' of both.                              *
  *                                                                            *
  * Return value:                                                              *
- *     SUCCEED - successful TLS handshake with a valid certificate or PSK     *
+ *     SUCCEED - session was set up                                           *
  *     FAIL - an error occurred                                               *
  *                                                                            *
  ******************************************************************************/
-int	zbx_tls_accept(zbx_socket_t *s, unsigned int tls_accept, char **error)
+static int	tls_accept_init(zbx_socket_t *s, unsigned int tls_accept, char **error)
 {
-	int				ret = FAIL, res;
-	gnutls_credentials_type_t	creds;
-
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
-
-	/* set up TLS context */
-
-	s->tls_ctx = zbx_malloc(s->tls_ctx, sizeof(zbx_tls_context_t));
-	s->tls_ctx->ctx = NULL;
-	s->tls_ctx->psk_client_creds = NULL;
-	s->tls_ctx->psk_server_creds = NULL;
-	s->tls_ctx->close_notify_received = 0;
+	int	res;
 
 	if (GNUTLS_E_SUCCESS != (res = gnutls_init(&s->tls_ctx->ctx, GNUTLS_SERVER)))
 	{
 		*error = zbx_dsprintf(*error, "gnutls_init() failed: %d %s", res, gnutls_strerror(res));
-		goto out;
+		return FAIL;
 	}
 
 	/* prepare to accept with certificate */
@@ -1545,7 +1532,7 @@ int	zbx_tls_accept(zbx_socket_t *s, unsigned int tls_accept, char **error)
 		{
 			*error = zbx_dsprintf(*error, "gnutls_credentials_set() for certificate failed: %d %s", res,
 					gnutls_strerror(res));
-			goto out;
+			return FAIL;
 		}
 
 		/* client certificate is mandatory unless pre-shared key is used */
@@ -1563,7 +1550,7 @@ int	zbx_tls_accept(zbx_socket_t *s, unsigned int tls_accept, char **error)
 		{
 			*error = zbx_dsprintf(*error, "gnutls_credentials_set() for my_psk_server_creds failed: %d %s",
 					res, gnutls_strerror(res));
-			goto out;
+			return FAIL;
 		}
 		else if (0 != (zbx_get_program_type_cb() & (ZBX_PROGRAM_TYPE_PROXY | ZBX_PROGRAM_TYPE_SERVER)))
 		{
@@ -1574,7 +1561,7 @@ int	zbx_tls_accept(zbx_socket_t *s, unsigned int tls_accept, char **error)
 			{
 				*error = zbx_dsprintf(*error, "gnutls_psk_allocate_server_credentials() for"
 						" psk_server_creds failed: %d %s", res, gnutls_strerror(res));
-				goto out;
+				return FAIL;
 			}
 
 			gnutls_psk_set_server_credentials_function(s->tls_ctx->psk_server_creds, zbx_psk_cb);
@@ -1584,7 +1571,7 @@ int	zbx_tls_accept(zbx_socket_t *s, unsigned int tls_accept, char **error)
 			{
 				*error = zbx_dsprintf(*error, "gnutls_credentials_set() for psk_server_creds failed"
 						": %d %s", res, gnutls_strerror(res));
-				goto out;
+				return FAIL;
 			}
 		}
 	}
@@ -1602,7 +1589,7 @@ int	zbx_tls_accept(zbx_socket_t *s, unsigned int tls_accept, char **error)
 			{
 				*error = zbx_dsprintf(*error, "gnutls_priority_set() for 'ciphersuites_all' failed: %d"
 						" %s", res, gnutls_strerror(res));
-				goto out;
+				return FAIL;
 			}
 		}
 		else
@@ -1612,7 +1599,7 @@ int	zbx_tls_accept(zbx_socket_t *s, unsigned int tls_accept, char **error)
 			{
 				*error = zbx_dsprintf(*error, "gnutls_priority_set() for 'ciphersuites_psk' failed: %d"
 						" %s", res, gnutls_strerror(res));
-				goto out;
+				return FAIL;
 			}
 		}
 	}
@@ -1622,7 +1609,7 @@ int	zbx_tls_accept(zbx_socket_t *s, unsigned int tls_accept, char **error)
 		{
 			*error = zbx_dsprintf(*error, "gnutls_priority_set() for 'ciphersuites_cert' failed: %d %s",
 					res, gnutls_strerror(res));
-			goto out;
+			return FAIL;
 		}
 	}
 	else if (0 != (tls_accept & ZBX_TCP_SEC_TLS_PSK))
@@ -1631,7 +1618,7 @@ int	zbx_tls_accept(zbx_socket_t *s, unsigned int tls_accept, char **error)
 		{
 			*error = zbx_dsprintf(*error, "gnutls_priority_set() for 'ciphersuites_psk' failed: %d %s", res,
 					gnutls_strerror(res));
-			goto out;
+			return FAIL;
 		}
 	}
 
@@ -1652,12 +1639,65 @@ int	zbx_tls_accept(zbx_socket_t *s, unsigned int tls_accept, char **error)
 
 	gnutls_transport_set_int(s->tls_ctx->ctx, ZBX_SOCKET_TO_INT(s->socket));
 
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: establish a TLS connection over an accepted TCP connection        *
+ *                                                                            *
+ * Parameters:                                                                *
+ *     s          - [IN] socket with opened connection                        *
+ *     tls_accept - [IN] type of connection to accept. Can be be either       *
+ *                       ZBX_TCP_SEC_TLS_CERT or ZBX_TCP_SEC_TLS_PSK, or      *
+ *                       a bitwise 'OR' of both.                              *
+ *     event      - [OUT] NULL to wait for the handshake to complete or       *
+ *                        events to wait for before calling the function      *
+ *                        again to continue non-blocking handshake            *
+ *     error      - [OUT] dynamically allocated memory with error message     *
+ *                                                                            *
+ * Return value:                                                              *
+ *     SUCCEED - successful TLS handshake with a valid certificate or PSK     *
+ *     FAIL - an error occurred or retry is needed if event is filled         *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_tls_accept(zbx_socket_t *s, unsigned int tls_accept, short *event, char **error)
+{
+	int				ret = FAIL, res;
+	gnutls_credentials_type_t	creds;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
+
+	if (NULL != event)
+		*event = 0;
+
+	/* set up TLS context */
+
+	if (NULL == s->tls_ctx)
+	{
+		s->tls_ctx = zbx_malloc(s->tls_ctx, sizeof(zbx_tls_context_t));
+		s->tls_ctx->ctx = NULL;
+		s->tls_ctx->psk_client_creds = NULL;
+		s->tls_ctx->psk_server_creds = NULL;
+		s->tls_ctx->close_notify_received = 0;
+
+		if (SUCCEED != tls_accept_init(s, tls_accept, error))
+			goto out;
+	}
+
 	/* TLS handshake */
 
 	while (GNUTLS_E_SUCCESS != (res = gnutls_handshake(s->tls_ctx->ctx)))
 	{
 		if (GNUTLS_E_INTERRUPTED == res || GNUTLS_E_AGAIN == res)
 		{
+			if (NULL != event)
+			{
+				tls_socket_event(s->tls_ctx->ctx, 0, event);
+				zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, tls_error_string(res));
+				return FAIL;
+			}
+
 			if (FAIL == tls_socket_wait(s->socket, s->tls_ctx->ctx, 0))
 			{
 				*error = zbx_dsprintf(*error, "cannot wait for TLS handshake: %s",
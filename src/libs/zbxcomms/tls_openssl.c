@@ -207,7 +207,6 @@ static ZBX_THREAD_LOCAL size_t			psk_len_for_cb		= 0;
 #endif
 #ifdef HAVE_OPENSSL_WITH_PSK
 /* variables for capturing PSK identity from server callback function */
-static ZBX_THREAD_LOCAL int			incoming_connection_has_psk = 0;
 static ZBX_THREAD_LOCAL char			incoming_connection_psk_id[PSK_MAX_IDENTITY_LEN + 1];
 #endif
 /* buffer for messages produced by zbx_openssl_info_cb() */
@@ -433,16 +432,17 @@ static unsigned int	zbx_psk_client_cb(SSL *ssl, const char *hint, char *identity
 static unsigned int	zbx_psk_server_cb(SSL *ssl, const char *identity, unsigned char *psk,
 		unsigned int max_psk_len)
 {
-	const char	*psk_loc;
-	size_t		psk_len = 0;
-	int		psk_bin_len;
-	unsigned char	tls_psk_hex[HOST_TLS_PSK_LEN_MAX], psk_buf[HOST_TLS_PSK_LEN / 2];
-
-	ZBX_UNUSED(ssl);
+	const char		*psk_loc;
+	size_t			psk_len = 0;
+	int			psk_bin_len;
+	unsigned char		tls_psk_hex[HOST_TLS_PSK_LEN_MAX], psk_buf[HOST_TLS_PSK_LEN / 2];
+	zbx_tls_context_t	*tls_ctx;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "%s() requested PSK identity \"%s\"", __func__, identity);
 
-	incoming_connection_has_psk = 1;
+	if (NULL != (tls_ctx = (zbx_tls_context_t *)SSL_get_app_data(ssl)))
+		tls_ctx->psk_accepted = 1;
+
 	psk_usage = 0;
 
 	if (0 != (zbx_get_program_type_cb() & (ZBX_PROGRAM_TYPE_PROXY | ZBX_PROGRAM_TYPE_SERVER)))
@@ -1815,38 +1815,25 @@ out1:
 
 /******************************************************************************
  *                                                                            *
- * Purpose: establish a TLS connection over an accepted TCP connection        *
+ * Purpose: create TLS context for accepted TCP connection                    *
  *                                                                            *
  * Parameters:                                                                *
  *     s          - [IN] socket with opened connection                        *
+ *     tls_accept - [IN] type of connection to accept                         *
  *     error      - [OUT] dynamically allocated memory with error message     *
- *     tls_accept - [IN] type of connection to accept. Can be be either       *
- *                       ZBX_TCP_SEC_TLS_CERT or ZBX_TCP_SEC_TLS_PSK, or      *
- *                       a bitwise 'OR' of both.                              *
  *                                                                            *
  * Return value:                                                              *
- *     SUCCEED - successful TLS handshake with a valid certificate or PSK     *
+ *     SUCCEED - context was created and attached to the socket               *
  *     FAIL - an error occurred                                               *
  *                                                                            *
  ******************************************************************************/
-int	zbx_tls_accept(zbx_socket_t *s, unsigned int tls_accept, char **error)
+static int	tls_accept_init(zbx_socket_t *s, unsigned int tls_accept, char **error)
 {
-	const char	*cipher_name;
-	int		ret = FAIL, res;
-	size_t		error_alloc = 0, error_offset = 0;
-	long		verify_result;
-
+	size_t	error_alloc = 0, error_offset = 0;
 #if OPENSSL_VERSION_NUMBER >= 0x1010100fL	/* OpenSSL 1.1.1 or newer, or LibreSSL */
 	const unsigned char	session_id_context[] = {'Z', 'b', 'x'};
 #endif
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
-	s->tls_ctx = zbx_malloc(s->tls_ctx, sizeof(zbx_tls_context_t));
-	s->tls_ctx->ctx = NULL;
-
-#if defined(HAVE_OPENSSL_WITH_PSK)
-	incoming_connection_has_psk = 0;	/* assume certificate-based connection by default */
-#endif
 	if ((ZBX_TCP_SEC_TLS_CERT | ZBX_TCP_SEC_TLS_PSK) == (tls_accept & (ZBX_TCP_SEC_TLS_CERT | ZBX_TCP_SEC_TLS_PSK)))
 	{
 #if defined(HAVE_OPENSSL_WITH_PSK)
@@ -1860,7 +1847,7 @@ int	zbx_tls_accept(zbx_socket_t *s, unsigned int tls_accept, char **error)
 				zbx_snprintf_alloc(error, &error_alloc, &error_offset, "cannot create context to accept"
 						" connection:");
 				zbx_tls_error_msg(error, &error_alloc, &error_offset);
-				goto out;
+				return FAIL;
 			}
 		}
 #else
@@ -1874,21 +1861,21 @@ int	zbx_tls_accept(zbx_socket_t *s, unsigned int tls_accept, char **error)
 					zbx_snprintf_alloc(error, &error_alloc, &error_offset, "cannot create context"
 							" to accept connection:");
 					zbx_tls_error_msg(error, &error_alloc, &error_offset);
-					goto out;
+					return FAIL;
 				}
 			}
 			else
 			{
 				*error = zbx_strdup(*error, "not ready for certificate-based incoming connection:"
 						" certificate not loaded. PSK support not compiled in.");
-				goto out;
+				return FAIL;
 			}
 		}
 #endif
 		else if (0 != (zbx_get_program_type_cb() & ZBX_PROGRAM_TYPE_AGENTD))
 		{
 			THIS_SHOULD_NEVER_HAPPEN;
-			goto out;
+			return FAIL;
 		}
 #if defined(HAVE_OPENSSL_WITH_PSK)
 		else if (NULL != ctx_psk)
@@ -1901,13 +1888,13 @@ int	zbx_tls_accept(zbx_socket_t *s, unsigned int tls_accept, char **error)
 				zbx_snprintf_alloc(error, &error_alloc, &error_offset, "cannot create context to accept"
 						" connection:");
 				zbx_tls_error_msg(error, &error_alloc, &error_offset);
-				goto out;
+				return FAIL;
 			}
 		}
 		else
 		{
 			THIS_SHOULD_NEVER_HAPPEN;
-			goto out;
+			return FAIL;
 		}
 #endif
 	}
@@ -1920,14 +1907,14 @@ int	zbx_tls_accept(zbx_socket_t *s, unsigned int tls_accept, char **error)
 				zbx_snprintf_alloc(error, &error_alloc, &error_offset, "cannot create context to accept"
 						" connection:");
 				zbx_tls_error_msg(error, &error_alloc, &error_offset);
-				goto out;
+				return FAIL;
 			}
 		}
 		else
 		{
 			*error = zbx_strdup(*error, "not ready for certificate-based incoming connection: certificate"
 					" not loaded");
-			goto out;
+			return FAIL;
 		}
 	}
 	else	/* PSK */
@@ -1940,17 +1927,17 @@ int	zbx_tls_accept(zbx_socket_t *s, unsigned int tls_accept, char **error)
 				zbx_snprintf_alloc(error, &error_alloc, &error_offset, "cannot create context to accept"
 						" connection:");
 				zbx_tls_error_msg(error, &error_alloc, &error_offset);
-				goto out;
+				return FAIL;
 			}
 		}
 		else
 		{
 			*error = zbx_strdup(*error, "not ready for PSK-based incoming connection: PSK not loaded");
-			goto out;
+			return FAIL;
 		}
 #else
 		*error = zbx_strdup(*error, "support for PSK was not compiled in");
-		goto out;
+		return FAIL;
 #endif
 	}
 
@@ -1958,13 +1945,61 @@ int	zbx_tls_accept(zbx_socket_t *s, unsigned int tls_accept, char **error)
 	if (1 != SSL_set_session_id_context(s->tls_ctx->ctx, session_id_context, sizeof(session_id_context)))
 	{
 		*error = zbx_strdup(*error, "cannot set session_id_context");
-		goto out;
+		return FAIL;
 	}
 #endif
 	if (1 != SSL_set_fd(s->tls_ctx->ctx, s->socket))
 	{
 		*error = zbx_strdup(*error, "cannot set socket for TLS context");
-		goto out;
+		return FAIL;
+	}
+
+	/* let PSK server callback mark this connection, handshakes of several connections can be interleaved */
+	SSL_set_app_data(s->tls_ctx->ctx, s->tls_ctx);
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: establish a TLS connection over an accepted TCP connection        *
+ *                                                                            *
+ * Parameters:                                                                *
+ *     s          - [IN] socket with opened connection                        *
+ *     tls_accept - [IN] type of connection to accept. Can be be either       *
+ *                       ZBX_TCP_SEC_TLS_CERT or ZBX_TCP_SEC_TLS_PSK, or      *
+ *                       a bitwise 'OR' of both.                              *
+ *     event      - [OUT] NULL to wait for the handshake to complete or       *
+ *                        events to wait for before calling the function      *
+ *                        again to continue non-blocking handshake            *
+ *     error      - [OUT] dynamically allocated memory with error message     *
+ *                                                                            *
+ * Return value:                                                              *
+ *     SUCCEED - successful TLS handshake with a valid certificate or PSK     *
+ *     FAIL - an error occurred or retry is needed if event is filled         *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_tls_accept(zbx_socket_t *s, unsigned int tls_accept, short *event, char **error)
+{
+	const char	*cipher_name;
+	int		ret = FAIL, res;
+	size_t		error_alloc = 0, error_offset = 0;
+	long		verify_result;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
+
+	if (NULL != event)
+		*event = 0;
+
+	if (NULL == s->tls_ctx)
+	{
+		s->tls_ctx = zbx_malloc(s->tls_ctx, sizeof(zbx_tls_context_t));
+		s->tls_ctx->ctx = NULL;
+#if defined(HAVE_OPENSSL_WITH_PSK)
+		s->tls_ctx->psk_accepted = 0;	/* assume certificate-based connection by default */
+#endif
+		if (SUCCEED != tls_accept_init(s, tls_accept, error))
+			goto out;
 	}
 
 	/* TLS handshake */
@@ -1980,6 +2015,15 @@ int	zbx_tls_accept(zbx_socket_t *s, unsigned int tls_accept, char **error)
 		if (SSL_ERROR_WANT_READ != ssl_err && SSL_ERROR_WANT_WRITE != ssl_err)
 			break;
 
+		if (NULL != event)
+		{
+			tls_socket_event(s->tls_ctx->ctx, ssl_err, event);
+
+			zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s %s", __func__, tls_error_string(ssl_err),
+					zbx_result_string(ret));
+			return FAIL;
+		}
+
 		if (FAIL == tls_socket_wait(s->socket, s->tls_ctx->ctx, ssl_err))
 		{
 			*error = zbx_dsprintf(*error, "cannot wait for TLS handshake: %s",
@@ -2039,7 +2083,7 @@ int	zbx_tls_accept(zbx_socket_t *s, unsigned int tls_accept, char **error)
 	cipher_name = SSL_get_cipher(s->tls_ctx->ctx);
 
 #if defined(HAVE_OPENSSL_WITH_PSK)
-	if (1 == incoming_connection_has_psk)
+	if (0 != s->tls_ctx->psk_accepted)
 	{
 		s->connection_type = ZBX_TCP_SEC_TLS_PSK;
 	}
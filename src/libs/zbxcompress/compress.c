@@ -20,8 +20,26 @@
 #include "zlib.h"
 
 #define ZBX_COMPRESS_STRERROR_LEN	512
+#define ZBX_COMPRESS_BUF_MIN		1024
 
 static int	zbx_zlib_errno = 0;
+static int	zbx_compress_level = Z_DEFAULT_COMPRESSION;
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: sets compression level used by the following zbx_compress() calls *
+ *                                                                            *
+ * Parameters: level - [IN] the compression level, 1 (fastest) - 9 (best      *
+ *                          compression) or ZBX_COMPRESS_LEVEL_DEFAULT        *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_compress_set_level(int level)
+{
+	if (ZBX_COMPRESS_LEVEL_DEFAULT == level)
+		zbx_compress_level = Z_DEFAULT_COMPRESSION;
+	else
+		zbx_compress_level = level;
+}
 
 /******************************************************************************
  *                                                                            *
@@ -46,6 +64,9 @@ const char	*zbx_compress_strerror(void)
 		case Z_DATA_ERROR:
 			zbx_strlcpy(message, "corrupted input data", sizeof(message));
 			break;
+		case Z_STREAM_ERROR:
+			zbx_strlcpy(message, "invalid compression parameters", sizeof(message));
+			break;
 		default:
 			zbx_snprintf(message, sizeof(message), "unknown error (%d)", zbx_zlib_errno);
 			break;
@@ -58,10 +79,11 @@ const char	*zbx_compress_strerror(void)
  *                                                                            *
  * Purpose: compress data                                                     *
  *                                                                            *
- * Parameters: in       - [IN] the data to compress                           *
- *             size_in  - [IN] the input data size                            *
- *             out      - [OUT] the compressed data                           *
- *             size_out - [OUT] the compressed data size                      *
+ * Parameters: in          - [IN] the data to compress                        *
+ *             size_in     - [IN] the input data size                         *
+ *             out         - [OUT] the compressed data                        *
+ *             size_out    - [OUT] the compressed data size                   *
+ *             window_bits - [IN] zlib window bits, also selects the format   *
  *                                                                            *
  * Return value: SUCCEED - the data was compressed successfully               *
  *               FAIL    - otherwise                                          *
@@ -69,27 +91,99 @@ const char	*zbx_compress_strerror(void)
  * Comments: In the case of success the output buffer must be freed by the    *
  *           caller.                                                          *
  *                                                                            *
+ *           The data is deflated in a stream into output buffer growing on   *
+ *           demand instead of preallocating compressBound() sized buffer, as *
+ *           the protocol data usually compresses several times.              *
+ *                                                                            *
  ******************************************************************************/
-int	zbx_compress(const char *in, size_t size_in, char **out, size_t *size_out)
+static int	compress_data(const char *in, size_t size_in, char **out, size_t *size_out, int window_bits)
 {
-	Bytef	*buf;
-	uLongf	buf_size;
+	z_stream	stream;
+	Bytef		*buf;
+	size_t		buf_size, left_in = size_in;
+	int		ret;
+
+	memset(&stream, 0, sizeof(stream));
+
+	if (Z_OK != (zbx_zlib_errno = deflateInit2(&stream, zbx_compress_level, Z_DEFLATED, window_bits, 8,
+			Z_DEFAULT_STRATEGY)))
+	{
+		return FAIL;
+	}
 
-	buf_size = compressBound(size_in);
+	buf_size = MAX(size_in / 4, ZBX_COMPRESS_BUF_MIN);
 	buf = (Bytef *)zbx_malloc(NULL, buf_size);
 
-	if (Z_OK != (zbx_zlib_errno = compress(buf, &buf_size, (const Bytef *)in, size_in)))
+	stream.next_in = (Bytef *)in;
+	stream.next_out = buf;
+	stream.avail_out = (uInt)MIN(buf_size, UINT_MAX);
+
+	do
 	{
+		if (0 == stream.avail_in)
+		{
+			stream.avail_in = (uInt)MIN(left_in, UINT_MAX);
+			left_in -= stream.avail_in;
+		}
+
+		if (0 == stream.avail_out)
+		{
+			size_t	offset = (size_t)(stream.next_out - buf);
+
+			buf_size += buf_size / 2;
+			buf = (Bytef *)zbx_realloc(buf, buf_size);
+
+			stream.next_out = buf + offset;
+			stream.avail_out = (uInt)MIN(buf_size - offset, UINT_MAX);
+		}
+
+		ret = deflate(&stream, 0 == left_in ? Z_FINISH : Z_NO_FLUSH);
+	}
+	while (Z_OK == ret || Z_BUF_ERROR == ret);
+
+	if (Z_STREAM_END != ret)
+	{
+		zbx_zlib_errno = ret;
+		(void)deflateEnd(&stream);
 		zbx_free(buf);
+
 		return FAIL;
 	}
 
 	*out = (char *)buf;
-	*size_out = buf_size;
+	*size_out = (size_t)(stream.next_out - buf);
+
+	(void)deflateEnd(&stream);
 
 	return SUCCEED;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: compress data in zlib format                                      *
+ *                                                                            *
+ * Comments: In the case of success the output buffer must be freed by the    *
+ *           caller.                                                          *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_compress(const char *in, size_t size_in, char **out, size_t *size_out)
+{
+	return compress_data(in, size_in, out, size_out, MAX_WBITS);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: compress data in gzip format (used for HTTP content encoding)     *
+ *                                                                            *
+ * Comments: In the case of success the output buffer must be freed by the    *
+ *           caller.                                                          *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_compress_gzip(const char *in, size_t size_in, char **out, size_t *size_out)
+{
+	return compress_data(in, size_in, out, size_out, MAX_WBITS + 16);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: uncompress data                                                   *
@@ -117,6 +211,11 @@ int	zbx_uncompress(const char *in, size_t size_in, char *out, size_t *size_out)
 
 #else
 
+void	zbx_compress_set_level(int level)
+{
+	ZBX_UNUSED(level);
+}
+
 int	zbx_compress(const char *in, size_t size_in, char **out, size_t *size_out)
 {
 	ZBX_UNUSED(in);
@@ -126,6 +225,15 @@ int	zbx_compress(const char *in, size_t size_in, char **out, size_t *size_out)
 	return FAIL;
 }
 
+int	zbx_compress_gzip(const char *in, size_t size_in, char **out, size_t *size_out)
+{
+	ZBX_UNUSED(in);
+	ZBX_UNUSED(size_in);
+	ZBX_UNUSED(out);
+	ZBX_UNUSED(size_out);
+	return FAIL;
+}
+
 int	zbx_uncompress(const char *in, size_t size_in, char *out, size_t *size_out)
 {
 	ZBX_UNUSED(in);
@@ -1415,6 +1415,21 @@ void 	zbx_dbconn_close(zbx_dbconn_t *db)
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: release database client library resources of the calling thread  *
+ *                                                                            *
+ * Comments: Must be called before exiting by threads, other than the main    *
+ *           process thread, that have opened database connections.          *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_db_thread_deinit(void)
+{
+#if defined(HAVE_MYSQL)
+	mysql_thread_end();
+#endif
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: start transaction                                                 *
@@ -1569,6 +1584,161 @@ int	zbx_dbconn_execute(zbx_dbconn_t *db, const char *fmt, ...)
 	return rc;
 }
 
+#if defined(HAVE_POSTGRESQL)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: bulk loads data with COPY ... FROM STDIN statement                *
+ *                                                                            *
+ * Parameters: db   - [IN] database connection                                *
+ *             sql  - [IN] COPY statement                                     *
+ *             data - [IN] data in the format specified by COPY statement     *
+ *             size - [IN] data size                                          *
+ *                                                                            *
+ * Return value: ZBX_DB_FAIL (on error) or ZBX_DB_DOWN (on recoverable error) *
+ *               or number of rows loaded (on success)                        *
+ *                                                                            *
+ ******************************************************************************/
+static int	dbconn_copy(zbx_dbconn_t *db, const char *sql, const char *data, size_t size)
+{
+#define ZBX_COPY_CHUNK_SIZE	(256 * ZBX_KIBIBYTE)
+
+	PGresult	*result;
+	char		*error = NULL;
+	const char	*copy_error = NULL;
+	int		ret = ZBX_DB_OK;
+	double		sec = 0;
+
+	if (0 != db->config->log_slow_queries)
+		sec = zbx_time();
+
+	if (0 == db->txn_level)
+		zabbix_log(LOG_LEVEL_DEBUG, "query without transaction detected");
+
+	if (ZBX_DB_OK != db->txn_error)
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "ignoring query [txnlev:%d] [%s] within failed transaction", db->txn_level,
+				sql);
+		return ZBX_DB_FAIL;
+	}
+
+	zabbix_log(LOG_LEVEL_DEBUG, "query [txnlev:%d] [%s] size:" ZBX_FS_SIZE_T, db->txn_level, sql,
+			(zbx_fs_size_t)size);
+
+	result = PQexec(db->conn, sql);
+
+	if (NULL == result)
+	{
+		dbconn_errlog(db, ERR_Z3005, 0, "result is NULL", sql);
+		ret = (CONNECTION_OK == PQstatus(db->conn) ? ZBX_DB_FAIL : ZBX_DB_DOWN);
+		goto out;
+	}
+
+	if (PGRES_COPY_IN != PQresultStatus(result))
+		goto check;
+
+	PQclear(result);
+
+	for (size_t offset = 0; offset < size; offset += ZBX_COPY_CHUNK_SIZE)
+	{
+		int	chunk_size = (int)MIN(size - offset, ZBX_COPY_CHUNK_SIZE);
+
+		if (1 != PQputCopyData(db->conn, data + offset, chunk_size))
+		{
+			copy_error = "failed to send COPY data";
+			break;
+		}
+	}
+
+	/* an error message forces the server to fail COPY instead of loading the rows sent so far, */
+	/* the failure is then reported by the result of the COPY statement                          */
+	(void)PQputCopyEnd(db->conn, copy_error);
+
+	if (NULL == (result = PQgetResult(db->conn)))
+	{
+		dbconn_errlog(db, ERR_Z3005, 0, "result is NULL", sql);
+		ret = (CONNECTION_OK == PQstatus(db->conn) ? ZBX_DB_FAIL : ZBX_DB_DOWN);
+		goto out;
+	}
+check:
+	if (PGRES_COMMAND_OK != PQresultStatus(result))
+	{
+		zbx_err_codes_t	errcode;
+
+		db_get_postgresql_error(&error, result);
+
+		if (0 == zbx_strcmp_null(PQresultErrorField(result, PG_DIAG_SQLSTATE), ZBX_PG_UNIQUE_VIOLATION))
+			errcode = ERR_Z3008;
+		else if (0 == zbx_strcmp_null(PQresultErrorField(result, PG_DIAG_SQLSTATE), ZBX_PG_READ_ONLY))
+			errcode = ERR_Z3009;
+		else
+			errcode = ERR_Z3005;
+
+		dbconn_errlog(db, errcode, 0, error, sql);
+		zbx_free(error);
+
+		ret = (SUCCEED == dbconn_is_recoverable_error(db, result) ? ZBX_DB_DOWN : ZBX_DB_FAIL);
+	}
+
+	if (ZBX_DB_OK == ret)
+		ret = atoi(PQcmdTuples(result));
+
+	PQclear(result);
+
+	/* drain the remaining results to make connection ready for the next query */
+	while (NULL != (result = PQgetResult(db->conn)))
+		PQclear(result);
+out:
+	if (0 != db->config->log_slow_queries)
+	{
+		sec = zbx_time() - sec;
+		if (sec > (double)db->config->log_slow_queries / 1000.0)
+			zabbix_log(LOG_LEVEL_WARNING, "slow query: " ZBX_FS_DBL " sec, \"%s\"", sec, sql);
+	}
+
+	if (ZBX_DB_FAIL == ret && 0 < db->txn_level)
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "query [%s] failed, setting transaction as failed", sql);
+		db->txn_error = ZBX_DB_FAIL;
+	}
+
+	return ret;
+
+#undef ZBX_COPY_CHUNK_SIZE
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: bulk loads data with COPY ... FROM STDIN statement                *
+ *                                                                            *
+ * Comments: retry until DB is up                                             *
+ *                                                                            *
+ ******************************************************************************/
+int	dbconn_copy_from(zbx_dbconn_t *db, const char *sql, const char *data, size_t size)
+{
+	int	rc;
+
+	rc = dbconn_copy(db, sql, data, size);
+
+	if (ZBX_DB_CONNECT_NORMAL != db->connect_options)
+		return rc;
+
+	while (ZBX_DB_DOWN == rc)
+	{
+		zbx_dbconn_close(db);
+		zbx_dbconn_open(db);
+
+		if (ZBX_DB_DOWN == (rc = dbconn_copy(db, sql, data, size)))
+		{
+			zabbix_log(LOG_LEVEL_ERR, "database is down: retrying in %d seconds", ZBX_DB_WAIT_DOWN);
+			db->connection_failure = 1;
+			sleep(ZBX_DB_WAIT_DOWN);
+		}
+	}
+
+	return rc;
+}
+#endif
+
 /******************************************************************************
  *                                                                            *
  * Purpose: execute a select statement                                        *
@@ -81,6 +81,10 @@ char	*db_dyn_escape_string(const char *src, size_t max_bytes, size_t max_chars,
 char	*db_dyn_escape_field_len(const zbx_db_field_t *field, const char *src, zbx_escape_sequence_t flag);
 int	db_is_escape_sequence(char c);
 
+#if defined(HAVE_POSTGRESQL)
+int	dbconn_copy_from(zbx_dbconn_t *db, const char *sql, const char *data, size_t size);
+#endif
+
 zbx_uint32_t	db_get_server_version(void);
 
 #endif
@@ -21,6 +21,27 @@
 #include "zbxstr.h"
 #include "zbxtypes.h"
 
+static void	db_insert_free_row(const zbx_db_insert_t *db_insert, zbx_db_value_t *row)
+{
+	for (int j = 0; j < db_insert->fields.values_num; j++)
+	{
+		const zbx_db_field_t	*field = db_insert->fields.values[j];
+
+		switch (field->type)
+		{
+			case ZBX_TYPE_CHAR:
+			case ZBX_TYPE_TEXT:
+			case ZBX_TYPE_LONGTEXT:
+			case ZBX_TYPE_CUID:
+			case ZBX_TYPE_BLOB:
+				zbx_free(row[j].str);
+				break;
+		}
+	}
+
+	zbx_free(row);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: releases resources allocated by bulk insert operations            *
@@ -31,27 +52,7 @@
 static void	db_insert_clear_rows(zbx_db_insert_t *db_insert)
 {
 	for (int i = 0; i < db_insert->rows.values_num; i++)
-	{
-		zbx_db_value_t	*row = db_insert->rows.values[i];
-
-		for (int j = 0; j < db_insert->fields.values_num; j++)
-		{
-			const zbx_db_field_t	*field = db_insert->fields.values[j];
-
-			switch (field->type)
-			{
-				case ZBX_TYPE_CHAR:
-				case ZBX_TYPE_TEXT:
-				case ZBX_TYPE_LONGTEXT:
-				case ZBX_TYPE_CUID:
-				case ZBX_TYPE_BLOB:
-					zbx_free(row[j].str);
-					break;
-			}
-		}
-
-		zbx_free(row);
-	}
+		db_insert_free_row(db_insert, db_insert->rows.values[i]);
 
 	zbx_vector_db_value_ptr_clear(&db_insert->rows);
 }
@@ -110,6 +111,7 @@ void	zbx_dbconn_prepare_insert_dyn(zbx_dbconn_t *db, zbx_db_insert_t *db_insert,
 	db_insert->lastid = 0;
 	db_insert->batch_size = 0;
 	db_insert->clause = NULL;
+	db_insert->bulk_load = 0;
 
 	zbx_vector_const_db_field_ptr_create(&db_insert->fields);
 	zbx_vector_db_value_ptr_create(&db_insert->rows);
@@ -220,7 +222,9 @@ void	zbx_db_insert_add_values_dyn(zbx_db_insert_t *db_insert, zbx_db_value_t **v
 			case ZBX_TYPE_TEXT:
 			case ZBX_TYPE_CUID:
 			case ZBX_TYPE_BLOB:
-				row[i].str = db_dyn_escape_field_len(field, value->str, ESCAPE_SEQUENCE_ON);
+				/* bulk loaded values are sent as raw data and must not be escaped */
+				row[i].str = db_dyn_escape_field_len(field, value->str,
+						0 == db_insert->bulk_load ? ESCAPE_SEQUENCE_ON : ESCAPE_SEQUENCE_OFF);
 				break;
 			case ZBX_TYPE_INT:
 			case ZBX_TYPE_FLOAT:
@@ -359,6 +363,203 @@ static void	decode_and_escape_binary_value_for_sql(zbx_dbconn_t *db, char **sql_
 }
 #endif
 
+#if defined(HAVE_POSTGRESQL)
+
+static void	db_copy_append(char **buf, size_t *buf_alloc, size_t *buf_offset, const void *data, size_t size)
+{
+	if (*buf_alloc < *buf_offset + size)
+	{
+		while (*buf_alloc < *buf_offset + size)
+			*buf_alloc *= 2;
+
+		*buf = (char *)zbx_realloc(*buf, *buf_alloc);
+	}
+
+	memcpy(*buf + *buf_offset, data, size);
+	*buf_offset += size;
+}
+
+static void	db_copy_append_uint16(char **buf, size_t *buf_alloc, size_t *buf_offset, unsigned short value)
+{
+	unsigned char	data[2] = {(unsigned char)(value >> 8), (unsigned char)value};
+
+	db_copy_append(buf, buf_alloc, buf_offset, data, sizeof(data));
+}
+
+static void	db_copy_append_uint32(char **buf, size_t *buf_alloc, size_t *buf_offset, zbx_uint32_t value)
+{
+	unsigned char	data[4];
+
+	for (int i = 3; i >= 0; i--, value >>= 8)
+		data[i] = (unsigned char)value;
+
+	db_copy_append(buf, buf_alloc, buf_offset, data, sizeof(data));
+}
+
+static void	db_copy_append_uint64(char **buf, size_t *buf_alloc, size_t *buf_offset, zbx_uint64_t value)
+{
+	unsigned char	data[8];
+
+	for (int i = 7; i >= 0; i--, value >>= 8)
+		data[i] = (unsigned char)value;
+
+	db_copy_append(buf, buf_alloc, buf_offset, data, sizeof(data));
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: appends unsigned 64 bit integer as numeric field in PostgreSQL    *
+ *          binary copy format                                                *
+ *                                                                            *
+ * Comments: The numeric value is stored as number of base 10000 digits,      *
+ *           weight of the first digit, sign, display scale and the digits    *
+ *           starting with the most significant one. Trailing zero digits are *
+ *           omitted.                                                         *
+ *                                                                            *
+ ******************************************************************************/
+static void	db_copy_append_numeric(char **buf, size_t *buf_alloc, size_t *buf_offset, zbx_uint64_t value)
+{
+	unsigned short	digits[5];
+	int		digits_num = 0, low = 0;
+
+	for (; 0 != value; value /= 10000)
+		digits[digits_num++] = (unsigned short)(value % 10000);
+
+	while (low < digits_num && 0 == digits[low])
+		low++;
+
+	db_copy_append_uint32(buf, buf_alloc, buf_offset, (zbx_uint32_t)(8 + 2 * (digits_num - low)));
+	db_copy_append_uint16(buf, buf_alloc, buf_offset, (unsigned short)(digits_num - low));
+	db_copy_append_uint16(buf, buf_alloc, buf_offset, (unsigned short)(0 == digits_num ? 0 : digits_num - 1));
+	db_copy_append_uint16(buf, buf_alloc, buf_offset, 0);	/* positive sign */
+	db_copy_append_uint16(buf, buf_alloc, buf_offset, 0);	/* display scale */
+
+	for (int i = digits_num - 1; i >= low; i--)
+		db_copy_append_uint16(buf, buf_alloc, buf_offset, digits[i]);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: loads the prepared rows with COPY statement in binary format      *
+ *                                                                            *
+ * Parameters: db_insert - [IN] the bulk insert data                          *
+ *                                                                            *
+ * Return value: SUCCEED if the operation completed successfully or           *
+ *               FAIL otherwise.                                              *
+ *                                                                            *
+ ******************************************************************************/
+static int	db_insert_copy(zbx_db_insert_t *db_insert)
+{
+	static const char	signature[] = "PGCOPY\n\377\r\n";
+
+	int			ret = SUCCEED;
+	char			*sql = NULL, *data;
+	size_t			sql_alloc = 0, sql_offset = 0, data_alloc = 16 * ZBX_KIBIBYTE, data_offset = 0;
+
+	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, "copy %s (", db_insert->table->table);
+
+	for (int i = 0; i < db_insert->fields.values_num; i++)
+	{
+		if (0 != i)
+			zbx_chrcpy_alloc(&sql, &sql_alloc, &sql_offset, ',');
+
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, db_insert->fields.values[i]->name);
+	}
+
+	zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, ") from stdin (format binary)");
+
+	data = (char *)zbx_malloc(NULL, data_alloc);
+
+	/* header - signature including terminating '\0', flags and header extension length */
+	db_copy_append(&data, &data_alloc, &data_offset, signature, sizeof(signature));
+	db_copy_append_uint32(&data, &data_alloc, &data_offset, 0);
+	db_copy_append_uint32(&data, &data_alloc, &data_offset, 0);
+
+	for (int i = 0; i < db_insert->rows.values_num; i++)
+	{
+		zbx_db_value_t	*values = db_insert->rows.values[i];
+
+		db_copy_append_uint16(&data, &data_alloc, &data_offset, (unsigned short)db_insert->fields.values_num);
+
+		for (int j = 0; j < db_insert->fields.values_num; j++)
+		{
+			zbx_db_value_t		*value = &values[j];
+			const zbx_db_field_t	*field = db_insert->fields.values[j];
+			size_t			len;
+			zbx_uint64_t		dbl_bits;
+			char			*bin;
+
+			switch (field->type)
+			{
+				case ZBX_TYPE_CHAR:
+				case ZBX_TYPE_TEXT:
+				case ZBX_TYPE_LONGTEXT:
+				case ZBX_TYPE_CUID:
+					len = strlen(value->str);
+					db_copy_append_uint32(&data, &data_alloc, &data_offset, (zbx_uint32_t)len);
+					db_copy_append(&data, &data_alloc, &data_offset, value->str, len);
+					break;
+				case ZBX_TYPE_BLOB:
+					len = 0;
+					bin = NULL;
+
+					if (NULL != value->str)
+					{
+						size_t	bin_alloc = strlen(value->str) * 3 / 4 + 1;
+
+						bin = (char *)zbx_malloc(NULL, bin_alloc);
+						zbx_base64_decode(value->str, bin, bin_alloc, &len);
+					}
+
+					db_copy_append_uint32(&data, &data_alloc, &data_offset, (zbx_uint32_t)len);
+					if (0 != len)
+						db_copy_append(&data, &data_alloc, &data_offset, bin, len);
+					zbx_free(bin);
+					break;
+				case ZBX_TYPE_INT:
+					db_copy_append_uint32(&data, &data_alloc, &data_offset, 4);
+					db_copy_append_uint32(&data, &data_alloc, &data_offset, (zbx_uint32_t)value->i32);
+					break;
+				case ZBX_TYPE_FLOAT:
+					memcpy(&dbl_bits, &value->dbl, sizeof(dbl_bits));
+					db_copy_append_uint32(&data, &data_alloc, &data_offset, 8);
+					db_copy_append_uint64(&data, &data_alloc, &data_offset, dbl_bits);
+					break;
+				case ZBX_TYPE_UINT:
+					db_copy_append_numeric(&data, &data_alloc, &data_offset, value->ui64);
+					break;
+				case ZBX_TYPE_ID:
+					/* zero identifier is inserted as null, see zbx_db_sql_id_ins() */
+					if (0 == value->ui64)
+					{
+						db_copy_append_uint32(&data, &data_alloc, &data_offset, (zbx_uint32_t)-1);
+						break;
+					}
+
+					db_copy_append_uint32(&data, &data_alloc, &data_offset, 8);
+					db_copy_append_uint64(&data, &data_alloc, &data_offset, value->ui64);
+					break;
+				default:
+					THIS_SHOULD_NEVER_HAPPEN;
+					exit(EXIT_FAILURE);
+			}
+		}
+	}
+
+	/* file trailer */
+	db_copy_append_uint16(&data, &data_alloc, &data_offset, (unsigned short)-1);
+
+	if (ZBX_DB_OK > dbconn_copy_from(db_insert->db, sql, data, data_offset))
+		ret = FAIL;
+
+	zbx_free(data);
+	zbx_free(sql);
+
+	return ret;
+}
+
+#endif
+
 /******************************************************************************
  *                                                                            *
  * Purpose: executes the prepared database bulk insert operation              *
@@ -414,6 +615,11 @@ int	zbx_db_insert_execute(zbx_db_insert_t *db_insert)
 		db_insert->autoincrement = -1;
 	}
 
+#if defined(HAVE_POSTGRESQL)
+	if (0 != db_insert->bulk_load)
+		return db_insert_copy(db_insert);
+#endif
+
 	sql = (char *)zbx_malloc(NULL, sql_alloc);
 	sql_command = (char *)zbx_malloc(NULL, sql_command_alloc);
 
@@ -514,8 +720,12 @@ int	zbx_db_insert_execute(zbx_db_insert_t *db_insert)
 							value->ui64);
 					break;
 				case ZBX_TYPE_ID:
-					zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset,
-							zbx_db_sql_id_ins(value->ui64));
+					/* format identifier in place instead of zbx_db_sql_id_ins() static buffers */
+					/* to allow executing inserts from multiple threads                         */
+					if (0 == value->ui64)
+						zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, "null");
+					else
+						zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, ZBX_FS_UI64, value->ui64);
 					break;
 				default:
 					THIS_SHOULD_NEVER_HAPPEN;
@@ -597,6 +807,12 @@ void	zbx_db_insert_autoincrement(zbx_db_insert_t *db_insert, const char *field_n
  ******************************************************************************/
 void	zbx_db_insert_clause(zbx_db_insert_t *self, const char *clause)
 {
+	if (0 != self->bulk_load)
+	{
+		THIS_SHOULD_NEVER_HAPPEN;
+		exit(EXIT_FAILURE);
+	}
+
 	self->clause = zbx_strdup(self->clause, clause);
 }
 
@@ -635,3 +851,74 @@ int	zbx_db_insert_get_row_count(zbx_db_insert_t *self)
 {
 	return self->rows.values_num;
 }
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: removes row from bulk insert data                                 *
+ *                                                                            *
+ * Parameters: self  - [IN] bulk insert data                                  *
+ *             index - [IN] index of the row to remove                        *
+ *                                                                            *
+ * Comments: The last row is moved in place of the removed one.               *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_db_insert_remove_row(zbx_db_insert_t *self, int index)
+{
+	db_insert_free_row(self, self->rows.values[index]);
+	zbx_vector_db_value_ptr_remove_noorder(&self->rows, index);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: sets database connection used to execute bulk insert              *
+ *                                                                            *
+ * Parameters: self - [IN] bulk insert data                                   *
+ *             db   - [IN] database connection                                *
+ *                                                                            *
+ * Comments: Allows to prepare bulk insert data in one thread and execute it  *
+ *           in another thread with its own database connection.              *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_db_insert_set_dbconn(zbx_db_insert_t *self, zbx_dbconn_t *db)
+{
+	self->db = db;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: enables bulk load mode                                            *
+ *                                                                            *
+ * Parameters: self - [IN] bulk insert data                                   *
+ *                                                                            *
+ * Comments: In bulk load mode the rows are loaded with COPY ... FROM STDIN   *
+ *           statement in binary format instead of insert statements. It is  *
+ *           supported only by PostgreSQL and only if enabled by DBBulkLoad   *
+ *           configuration parameter, otherwise this function does nothing.   *
+ *           Must be called before any rows are added. Bulk load mode cannot  *
+ *           be combined with insert clause.                                  *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_db_insert_set_bulk_load(zbx_db_insert_t *self)
+{
+#if defined(HAVE_POSTGRESQL)
+	if (0 != self->rows.values_num || NULL != self->clause)
+	{
+		THIS_SHOULD_NEVER_HAPPEN;
+		return;
+	}
+
+	if (0 == self->db->config->bulk_load)
+		return;
+
+	for (int i = 0; i < self->fields.values_num; i++)
+	{
+		/* upper() conversion is done by database and is not available for bulk load */
+		if (0 != (self->fields.values[i]->flags & ZBX_UPPER))
+			return;
+	}
+
+	self->bulk_load = 1;
+#else
+	ZBX_UNUSED(self);
+#endif
+}
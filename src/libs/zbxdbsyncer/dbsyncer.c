@@ -18,6 +18,7 @@
 #include "zbxself.h"
 #include "zbxtime.h"
 #include "zbxcachehistory.h"
+#include "zbxhistory.h"
 #include "zbxexport.h"
 #include "zbxprof.h"
 #include "zbxtimekeeper.h"
@@ -277,6 +278,7 @@ ZBX_THREAD_ENTRY(zbx_dbsyncer_thread, args)
 
 	zbx_dc_sync_trends(dbsyncer_args->config_syncer_num);
 
+	zbx_history_destroy();
 	zbx_db_close();
 	zbx_unblock_signals(&orig_mask);
 
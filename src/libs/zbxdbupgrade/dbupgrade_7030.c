@@ -622,6 +622,51 @@ static int	DBpatch_7030048(void)
 
 	return DBadd_foreign_key("hostmacro_config", 1, &field);
 }
+
+static int	DBpatch_7030049(void)
+{
+	return DBcreate_changelog_insert_trigger("globalmacro", "globalmacroid");
+}
+
+static int	DBpatch_7030050(void)
+{
+	return DBcreate_changelog_update_trigger("globalmacro", "globalmacroid");
+}
+
+static int	DBpatch_7030051(void)
+{
+	return DBcreate_changelog_delete_trigger("globalmacro", "globalmacroid");
+}
+
+static int	DBpatch_7030052(void)
+{
+	return DBcreate_changelog_insert_trigger("hostmacro", "hostmacroid");
+}
+
+static int	DBpatch_7030053(void)
+{
+	return DBcreate_changelog_update_trigger("hostmacro", "hostmacroid");
+}
+
+static int	DBpatch_7030054(void)
+{
+	return DBcreate_changelog_delete_trigger("hostmacro", "hostmacroid");
+}
+
+static int	DBpatch_7030055(void)
+{
+	return DBcreate_changelog_insert_trigger("hstgrp", "groupid");
+}
+
+static int	DBpatch_7030056(void)
+{
+	return DBcreate_changelog_update_trigger("hstgrp", "groupid");
+}
+
+static int	DBpatch_7030057(void)
+{
+	return DBcreate_changelog_delete_trigger("hstgrp", "groupid");
+}
 #endif
 
 DBPATCH_START(7030)
@@ -677,5 +722,14 @@ DBPATCH_ADD(7030045, 0, 1)
 DBPATCH_ADD(7030046, 0, 1)
 DBPATCH_ADD(7030047, 0, 1)
 DBPATCH_ADD(7030048, 0, 1)
+DBPATCH_ADD(7030049, 0, 1)
+DBPATCH_ADD(7030050, 0, 1)
+DBPATCH_ADD(7030051, 0, 1)
+DBPATCH_ADD(7030052, 0, 1)
+DBPATCH_ADD(7030053, 0, 1)
+DBPATCH_ADD(7030054, 0, 1)
+DBPATCH_ADD(7030055, 0, 1)
+DBPATCH_ADD(7030056, 0, 1)
+DBPATCH_ADD(7030057, 0, 1)
 
 DBPATCH_END()
@@ -2488,6 +2488,7 @@ int	zbx_process_proxy_data(const zbx_dc_proxy_t *proxy, const struct zbx_json_pa
 		zbx_autoreg_prepare_host_func_t autoreg_prepare_host_cb, int *more, char **error)
 {
 	struct zbx_json_parse	jp_data;
+	zbx_json_index_t	jp_index;
 	int			ret = SUCCEED, flags_old, lastaccess;
 	char			*error_step = NULL, value[MAX_STRING_LEN];
 	size_t			error_alloc = 0, error_offset = 0;
@@ -2495,6 +2496,9 @@ int	zbx_process_proxy_data(const zbx_dc_proxy_t *proxy, const struct zbx_json_pa
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
+	/* proxy data contains several large arrays, index the top level members to avoid rescanning them */
+	zbx_json_index_init(&jp_index, jp);
+
 	proxy_diff.flags = ZBX_FLAGS_PROXY_DIFF_UNSET;
 	proxy_diff.hostid = proxy->proxyid;
 
@@ -2508,7 +2512,7 @@ int	zbx_process_proxy_data(const zbx_dc_proxy_t *proxy, const struct zbx_json_pa
 
 	proxy_diff.lastaccess = lastaccess;
 
-	if (SUCCEED == zbx_json_value_by_name(jp, ZBX_PROTO_TAG_MORE, value, sizeof(value), NULL))
+	if (SUCCEED == zbx_json_index_value_by_name(&jp_index, ZBX_PROTO_TAG_MORE, value, sizeof(value), NULL))
 		proxy_diff.more_data = atoi(value);
 	else
 		proxy_diff.more_data = ZBX_PROXY_DATA_DONE;
@@ -2516,7 +2520,7 @@ int	zbx_process_proxy_data(const zbx_dc_proxy_t *proxy, const struct zbx_json_pa
 	if (NULL != more)
 		*more = proxy_diff.more_data;
 
-	if (SUCCEED == zbx_json_value_by_name(jp, ZBX_PROTO_TAG_PROXY_DELAY, value, sizeof(value), NULL))
+	if (SUCCEED == zbx_json_index_value_by_name(&jp_index, ZBX_PROTO_TAG_PROXY_DELAY, value, sizeof(value), NULL))
 		proxy_diff.proxy_delay = atoi(value);
 	else
 		proxy_diff.proxy_delay = 0;
@@ -2535,7 +2539,7 @@ int	zbx_process_proxy_data(const zbx_dc_proxy_t *proxy, const struct zbx_json_pa
 	if (ZBX_FLAGS_PROXY_DIFF_UNSET != proxy_diff.flags)
 		zbx_dc_update_proxy(&proxy_diff);
 
-	if (SUCCEED == zbx_json_brackets_by_name(jp, ZBX_PROTO_TAG_INTERFACE_AVAILABILITY, &jp_data))
+	if (SUCCEED == zbx_json_index_brackets_by_name(&jp_index, ZBX_PROTO_TAG_INTERFACE_AVAILABILITY, &jp_data))
 	{
 		if (SUCCEED != (ret = process_interfaces_availability_contents(&jp_data, &error_step)))
 			zbx_strcatnl_alloc(error, &error_alloc, &error_offset, error_step);
@@ -2543,11 +2547,12 @@ int	zbx_process_proxy_data(const zbx_dc_proxy_t *proxy, const struct zbx_json_pa
 
 	flags_old = proxy_diff.nodata_win.flags;
 
-	if (SUCCEED == zbx_json_brackets_by_name(jp, ZBX_PROTO_TAG_HISTORY_DATA, &jp_data))
+	if (SUCCEED == zbx_json_index_brackets_by_name(&jp_index, ZBX_PROTO_TAG_HISTORY_DATA, &jp_data))
 	{
 		zbx_session_t	*session = NULL;
 
-		if (SUCCEED == zbx_json_value_by_name(jp, ZBX_PROTO_TAG_SESSION, value, sizeof(value), NULL))
+		if (SUCCEED == zbx_json_index_value_by_name(&jp_index, ZBX_PROTO_TAG_SESSION, value, sizeof(value),
+				NULL))
 		{
 			size_t	token_len;
 
@@ -2584,7 +2589,7 @@ int	zbx_process_proxy_data(const zbx_dc_proxy_t *proxy, const struct zbx_json_pa
 	if (ZBX_FLAGS_PROXY_DIFF_UNSET != proxy_diff.flags)
 		zbx_dc_update_proxy(&proxy_diff);
 
-	if (SUCCEED == zbx_json_brackets_by_name(jp, ZBX_PROTO_TAG_DISCOVERY_DATA, &jp_data))
+	if (SUCCEED == zbx_json_index_brackets_by_name(&jp_index, ZBX_PROTO_TAG_DISCOVERY_DATA, &jp_data))
 	{
 		if (SUCCEED != (ret = process_discovery_data_contents(&jp_data, events_cbs,
 				discovery_update_host_cb, discovery_update_service_cb, discovery_update_service_down_cb,
@@ -2594,7 +2599,7 @@ int	zbx_process_proxy_data(const zbx_dc_proxy_t *proxy, const struct zbx_json_pa
 		}
 	}
 
-	if (SUCCEED == zbx_json_brackets_by_name(jp, ZBX_PROTO_TAG_AUTOREGISTRATION, &jp_data))
+	if (SUCCEED == zbx_json_index_brackets_by_name(&jp_index, ZBX_PROTO_TAG_AUTOREGISTRATION, &jp_data))
 	{
 		if (SUCCEED != (ret = process_autoregistration_contents(&jp_data, proxy, events_cbs,
 				autoreg_host_free_cb, autoreg_flush_hosts_cb, autoreg_prepare_host_cb, &error_step)))
@@ -2603,10 +2608,10 @@ int	zbx_process_proxy_data(const zbx_dc_proxy_t *proxy, const struct zbx_json_pa
 		}
 	}
 
-	if (SUCCEED == zbx_json_brackets_by_name(jp, ZBX_PROTO_TAG_TASKS, &jp_data))
+	if (SUCCEED == zbx_json_index_brackets_by_name(&jp_index, ZBX_PROTO_TAG_TASKS, &jp_data))
 		process_tasks_contents(&jp_data);
 
-	if (SUCCEED == zbx_json_brackets_by_name(jp, ZBX_PROTO_TAG_PROXY_ACTIVE_AVAIL_DATA, &jp_data))
+	if (SUCCEED == zbx_json_index_brackets_by_name(&jp_index, ZBX_PROTO_TAG_PROXY_ACTIVE_AVAIL_DATA, &jp_data))
 	{
 		const char			*ptr;
 		zbx_vector_proxy_hostdata_ptr_t	host_avails;
@@ -2684,6 +2689,7 @@ int	zbx_process_proxy_data(const zbx_dc_proxy_t *proxy, const struct zbx_json_pa
 	}
 
 out:
+	zbx_json_index_destroy(&jp_index);
 	zbx_free(error_step);
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
 
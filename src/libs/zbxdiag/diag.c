@@ -19,6 +19,7 @@
 #include "zbxshmem.h"
 #include "zbxcachehistory.h"
 #include "zbxconnector.h"
+#include "zbxcacheconfig.h"
 #include "zbxlog.h"
 #include "zbxmutexs.h"
 #include "zbxtime.h"
@@ -42,6 +43,14 @@
 #define ZBX_DIAG_CONNECTOR_VALUES			0x00000001
 #define ZBX_DIAG_CONNECTOR_SIMPLE		(ZBX_DIAG_CONNECTOR_VALUES)
 
+#define ZBX_DIAG_CONFIGCACHE_CHANGELOG		0x00000001
+#define ZBX_DIAG_CONFIGCACHE_SQL		0x00000002
+#define ZBX_DIAG_CONFIGCACHE_SYNC		0x00000004
+
+#define ZBX_DIAG_CONFIGCACHE_SIMPLE	(ZBX_DIAG_CONFIGCACHE_CHANGELOG | \
+					ZBX_DIAG_CONFIGCACHE_SQL | \
+					ZBX_DIAG_CONFIGCACHE_SYNC)
+
 ZBX_PTR_VECTOR_IMPL(diag_map_ptr, zbx_diag_map_t *)
 
 static zbx_diag_add_section_info_func_t	diag_add_section_info_cb;
@@ -174,10 +183,13 @@ void	zbx_diag_add_mem_stats(struct zbx_json *json, const char *name, const zbx_s
 	zbx_json_close(json);
 
 	zbx_json_addobject(json, "chunks");
+	zbx_json_addstring(json, "mode", ZBX_SHMEM_ALLOC_BESTFIT == stats->alloc_mode ? "best-fit" : "first-fit",
+			ZBX_JSON_TYPE_STRING);
 	zbx_json_adduint64(json, "free", stats->free_chunks);
 	zbx_json_adduint64(json, "used", stats->used_chunks);
 	zbx_json_adduint64(json, "min", stats->min_chunk_size);
 	zbx_json_adduint64(json, "max", stats->max_chunk_size);
+	zbx_json_addfloat(json, "fragmentation", stats->fragmentation);
 
 	zbx_json_addarray(json, "buckets");
 
@@ -412,16 +424,16 @@ void	zbx_diag_add_locks_info(struct zbx_json *json)
 	const char	*names[ZBX_MUTEX_COUNT] = {"ZBX_MUTEX_LOG", "ZBX_MUTEX_CACHE", "ZBX_MUTEX_TRENDS",
 				"ZBX_MUTEX_CACHE_IDS", "ZBX_MUTEX_SELFMON", "ZBX_MUTEX_CPUSTATS", "ZBX_MUTEX_DISKSTATS",
 				"ZBX_MUTEX_VALUECACHE", "ZBX_MUTEX_VMWARE", "ZBX_MUTEX_SQLITE3",
-				"ZBX_MUTEX_PROCSTAT", "ZBX_MUTEX_PROXY_HISTORY", "ZBX_MUTEX_KSTAT", "ZBX_MUTEX_MODBUS",
-				"ZBX_MUTEX_TREND_FUNC", "ZBX_MUTEX_REMOTE_COMMANDS", "ZBX_MUTEX_PROXY_BUFFER",
-				"ZBX_MUTEX_VPS_MONITOR"};
+				"ZBX_MUTEX_PROCSTAT", "ZBX_MUTEX_PROCSNAP", "ZBX_MUTEX_PROXY_HISTORY", "ZBX_MUTEX_KSTAT",
+				"ZBX_MUTEX_MODBUS", "ZBX_MUTEX_TREND_FUNC", "ZBX_MUTEX_REMOTE_COMMANDS",
+				"ZBX_MUTEX_PROXY_BUFFER", "ZBX_MUTEX_VPS_MONITOR"};
 #else
 	const char	*names[ZBX_MUTEX_COUNT] = {"ZBX_MUTEX_LOG", "ZBX_MUTEX_CACHE", "ZBX_MUTEX_TRENDS",
 				"ZBX_MUTEX_CACHE_IDS", "ZBX_MUTEX_SELFMON", "ZBX_MUTEX_CPUSTATS", "ZBX_MUTEX_DISKSTATS",
 				"ZBX_MUTEX_VALUECACHE", "ZBX_MUTEX_VMWARE", "ZBX_MUTEX_SQLITE3",
-				"ZBX_MUTEX_PROCSTAT", "ZBX_MUTEX_PROXY_HISTORY", "ZBX_MUTEX_MODBUS",
-				"ZBX_MUTEX_TREND_FUNC", "ZBX_MUTEX_REMOTE_COMMANDS", "ZBX_MUTEX_PROXY_BUFFER",
-				"ZBX_MUTEX_VPS_MONITOR"};
+				"ZBX_MUTEX_PROCSTAT", "ZBX_MUTEX_PROCSNAP", "ZBX_MUTEX_PROXY_HISTORY",
+				"ZBX_MUTEX_MODBUS", "ZBX_MUTEX_TREND_FUNC", "ZBX_MUTEX_REMOTE_COMMANDS",
+				"ZBX_MUTEX_PROXY_BUFFER", "ZBX_MUTEX_VPS_MONITOR"};
 #endif
 	zbx_json_addarray(json, ZBX_DIAG_LOCKS);
 
@@ -551,6 +563,12 @@ static void	diag_prepare_default_request(struct zbx_json *j, unsigned int flags)
 	if (0 != (flags & (1 << ZBX_DIAGINFO_PROXYBUFFER)))
 		diag_add_section_request(j, ZBX_DIAG_PROXYBUFFER, NULL);
 
+	if (0 != (flags & (1 << ZBX_DIAGINFO_CONFIGCACHE)))
+		diag_add_section_request(j, ZBX_DIAG_CONFIGCACHE, "tables", NULL);
+
+	if (0 != (flags & (1 << ZBX_DIAGINFO_SERVICEMANAGER)))
+		diag_add_section_request(j, ZBX_DIAG_SERVICEMANAGER, NULL);
+
 }
 
 /******************************************************************************
@@ -829,6 +847,46 @@ static void	diag_log_proxybuffer(struct zbx_json_parse *jp, char **out, size_t *
 	zbx_strlog_alloc(LOG_LEVEL_INFORMATION, out, out_alloc, out_offset, "==");
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: log configuration cache diagnostic information                    *
+ *                                                                            *
+ ******************************************************************************/
+static void	diag_log_configcache(struct zbx_json_parse *jp, char **out, size_t *out_alloc, size_t *out_offset)
+{
+	char	*msg = NULL;
+
+	zbx_strlog_alloc(LOG_LEVEL_INFORMATION, out, out_alloc, out_offset,
+			"== configuration cache diagnostic information ==");
+
+	diag_get_simple_values(jp, &msg);
+	zbx_strlog_alloc(LOG_LEVEL_INFORMATION, out, out_alloc, out_offset, "%s", msg);
+	zbx_free(msg);
+
+	diag_log_top_view(jp, "top.tables", "$.top.tables", out, out_alloc, out_offset);
+
+	zbx_strlog_alloc(LOG_LEVEL_INFORMATION, out, out_alloc, out_offset, "==");
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: log service manager diagnostic information                        *
+ *                                                                            *
+ ******************************************************************************/
+static void	diag_log_servicemanager(struct zbx_json_parse *jp, char **out, size_t *out_alloc, size_t *out_offset)
+{
+	char	*msg = NULL;
+
+	zbx_strlog_alloc(LOG_LEVEL_INFORMATION, out, out_alloc, out_offset,
+			"== service manager diagnostic information ==");
+
+	diag_get_simple_values(jp, &msg);
+	zbx_strlog_alloc(LOG_LEVEL_INFORMATION, out, out_alloc, out_offset, "%s", msg);
+	zbx_free(msg);
+
+	zbx_strlog_alloc(LOG_LEVEL_INFORMATION, out, out_alloc, out_offset, "==");
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: log diagnostic information                                        *
@@ -895,6 +953,10 @@ void	zbx_diag_log_info(unsigned int flags, char **result)
 				diag_log_connector(&jp_section, result, &result_alloc, &result_offset);
 			else if (0 == strcmp(section, ZBX_DIAG_PROXYBUFFER))
 				diag_log_proxybuffer(&jp_section, result, &result_alloc, &result_offset);
+			else if (0 == strcmp(section, ZBX_DIAG_CONFIGCACHE))
+				diag_log_configcache(&jp_section, result, &result_alloc, &result_offset);
+			else if (0 == strcmp(section, ZBX_DIAG_SERVICEMANAGER))
+				diag_log_servicemanager(&jp_section, result, &result_alloc, &result_offset);
 		}
 	}
 	else
@@ -1007,6 +1069,145 @@ out:
 	return ret;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: compare configuration cache table statistics by total time for    *
+ *          descending sorting                                                *
+ *                                                                            *
+ ******************************************************************************/
+static int	diag_compare_sync_stats_time_desc(const void *d1, const void *d2)
+{
+	const zbx_dc_sync_stats_t	*s1 = (const zbx_dc_sync_stats_t *)d1;
+	const zbx_dc_sync_stats_t	*s2 = (const zbx_dc_sync_stats_t *)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(s2->sql_time + s2->sync_time, s1->sql_time + s1->sync_time);
+
+	return 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: add configuration cache table statistics to json                  *
+ *                                                                            *
+ ******************************************************************************/
+static void	diag_configcache_add_tables(struct zbx_json *json, const char *field, const zbx_dc_sync_stats_t *stats,
+		int stats_num)
+{
+	zbx_json_addarray(json, field);
+
+	for (int i = 0; i < stats_num; i++)
+	{
+		zbx_json_addobject(json, NULL);
+		zbx_json_addstring(json, "table", stats[i].name, ZBX_JSON_TYPE_STRING);
+		zbx_json_addstring(json, "mode", stats[i].mode, ZBX_JSON_TYPE_STRING);
+		zbx_json_addfloat(json, "sql", stats[i].sql_time);
+		zbx_json_addfloat(json, "sync", stats[i].sync_time);
+		zbx_json_adduint64(json, "add", stats[i].add_num);
+		zbx_json_adduint64(json, "update", stats[i].update_num);
+		zbx_json_adduint64(json, "remove", stats[i].remove_num);
+		zbx_json_addint64(json, "memory", stats[i].sync_size);
+		zbx_json_close(json);
+	}
+
+	zbx_json_close(json);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: add requested configuration cache diagnostic information to json  *
+ *          data                                                              *
+ *                                                                            *
+ * Parameters: jp    - [IN] the request                                       *
+ *             json  - [IN/OUT] the json to update                            *
+ *             error - [OUT] error message                                    *
+ *                                                                            *
+ * Return value: SUCCEED - the information was added successfully             *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_diag_add_configcache_info(const struct zbx_json_parse *jp, struct zbx_json *json, char **error)
+{
+	zbx_vector_diag_map_ptr_t	tops;
+	int				ret, stats_num, changelog_num;
+	double				time1, time2, time_total = 0, changelog_time;
+	zbx_uint64_t			fields;
+	zbx_dc_sync_stats_t		*stats;
+	zbx_diag_map_t			field_map[] = {
+							{"", ZBX_DIAG_CONFIGCACHE_SIMPLE},
+							{"changelog", ZBX_DIAG_CONFIGCACHE_CHANGELOG},
+							{"sql", ZBX_DIAG_CONFIGCACHE_SQL},
+							{"sync", ZBX_DIAG_CONFIGCACHE_SYNC},
+							{NULL, 0}
+						};
+
+	zbx_vector_diag_map_ptr_create(&tops);
+
+	if (SUCCEED != (ret = zbx_diag_parse_request(jp, field_map, &fields, &tops, error)))
+		goto out;
+
+	stats = (zbx_dc_sync_stats_t *)zbx_malloc(NULL, sizeof(zbx_dc_sync_stats_t) * ZBX_DC_SYNC_STATS_MAX);
+
+	time1 = zbx_time();
+	stats_num = zbx_dc_config_get_sync_stats(stats, &changelog_num, &changelog_time);
+	time2 = zbx_time();
+	time_total += time2 - time1;
+
+	zbx_json_addobject(json, ZBX_DIAG_CONFIGCACHE);
+
+	if (0 != (fields & ZBX_DIAG_CONFIGCACHE_SIMPLE))
+	{
+		double	sql_time = changelog_time, sync_time = 0;
+
+		for (int i = 0; i < stats_num; i++)
+		{
+			sql_time += stats[i].sql_time;
+			sync_time += stats[i].sync_time;
+		}
+
+		if (0 != (fields & ZBX_DIAG_CONFIGCACHE_CHANGELOG))
+			zbx_json_addint64(json, "changelog", changelog_num);
+		if (0 != (fields & ZBX_DIAG_CONFIGCACHE_SQL))
+			zbx_json_addfloat(json, "sql", sql_time);
+		if (0 != (fields & ZBX_DIAG_CONFIGCACHE_SYNC))
+			zbx_json_addfloat(json, "sync", sync_time);
+	}
+
+	if (0 != tops.values_num)
+	{
+		zbx_json_addobject(json, "top");
+
+		for (int i = 0; i < tops.values_num; i++)
+		{
+			zbx_diag_map_t	*map = tops.values[i];
+
+			if (0 == strcmp(map->name, "tables"))
+			{
+				qsort(stats, (size_t)stats_num, sizeof(zbx_dc_sync_stats_t),
+						diag_compare_sync_stats_time_desc);
+				diag_configcache_add_tables(json, map->name, stats, MIN((int)map->value, stats_num));
+			}
+			else
+			{
+				*error = zbx_dsprintf(*error, "Unsupported top field: %s", map->name);
+				ret = FAIL;
+				break;
+			}
+		}
+
+		zbx_json_close(json);
+	}
+
+	zbx_json_addfloat(json, "time", time_total);
+	zbx_json_close(json);
+
+	zbx_free(stats);
+out:
+	zbx_vector_diag_map_ptr_clear_ext(&tops, zbx_diag_map_free);
+	zbx_vector_diag_map_ptr_destroy(&tops);
+
+	return ret;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: initializes zbxdiag library with component-specific callback      *
@@ -314,11 +314,51 @@ void	zbx_clear_count_pattern(zbx_eval_count_pattern_data_t *pdata)
 	}
 }
 
+int	zbx_count_var_with_pattern(zbx_eval_count_pattern_data_t *pdata, const char *pattern,
+		const zbx_variant_t *value, int *count, char **error)
+{
+	char	buf[ZBX_MAX_UINT64_LEN];
+
+	switch (value->type)
+	{
+		case ZBX_VARIANT_UI64:
+			if (0 != pdata->numeric_search)
+			{
+				count_one_ui64(count, pdata->op, value->data.ui64, pdata->pattern_ui64,
+						pdata->pattern2_ui64);
+			}
+			else
+			{
+				zbx_snprintf(buf, sizeof(buf), ZBX_FS_UI64, value->data.ui64);
+				if (FAIL == count_one_str(count, pdata->op, buf, pattern, &pdata->regexps, error))
+					return FAIL;
+			}
+			break;
+		case ZBX_VARIANT_DBL:
+			if (0 != pdata->numeric_search)
+			{
+				count_one_dbl(count, pdata->op, value->data.dbl, pdata->pattern_dbl);
+			}
+			else
+			{
+				zbx_snprintf(buf, sizeof(buf), ZBX_FS_DBL_EXT(4), value->data.dbl);
+				if (FAIL == count_one_str(count, pdata->op, buf, pattern, &pdata->regexps, error))
+					return FAIL;
+			}
+			break;
+		case ZBX_VARIANT_STR:
+			if (FAIL == count_one_str(count, pdata->op, value->data.str, pattern, &pdata->regexps, error))
+				return FAIL;
+			break;
+	}
+
+	return SUCCEED;
+}
+
 int	zbx_count_var_vector_with_pattern(zbx_eval_count_pattern_data_t *pdata, char *pattern, zbx_vector_var_t *values,
 		int limit, int *count, char **error)
 {
 	int	i;
-	char	buf[ZBX_MAX_UINT64_LEN];
 
 	if (OP_ANY == pdata->op)
 	{
@@ -330,51 +370,8 @@ int	zbx_count_var_vector_with_pattern(zbx_eval_count_pattern_data_t *pdata, char
 
 	for (i = 0; i < values->values_num && *count < limit; i++)
 	{
-		zbx_variant_t	value;
-
-		value = values->values[i];
-
-		switch (value.type)
-		{
-			case ZBX_VARIANT_UI64:
-				if (0 != pdata->numeric_search)
-				{
-					count_one_ui64(count, pdata->op, value.data.ui64, pdata->pattern_ui64,
-							pdata->pattern2_ui64);
-				}
-				else
-				{
-					zbx_snprintf(buf, sizeof(buf), ZBX_FS_UI64, value.data.ui64);
-					if (FAIL == count_one_str(count, pdata->op, buf, pattern, &pdata->regexps,
-							error))
-					{
-						return FAIL;
-					}
-				}
-				break;
-			case ZBX_VARIANT_DBL:
-				if (0 != pdata->numeric_search)
-				{
-					count_one_dbl(count, pdata->op, value.data.dbl, pdata->pattern_dbl);
-				}
-				else
-				{
-					zbx_snprintf(buf, sizeof(buf), ZBX_FS_DBL_EXT(4), value.data.dbl);
-					if (FAIL == count_one_str(count, pdata->op, buf, pattern, &pdata->regexps,
-							error))
-					{
-						return FAIL;
-					}
-				}
-				break;
-			case ZBX_VARIANT_STR:
-				if (FAIL == count_one_str(count, pdata->op, value.data.str, pattern, &pdata->regexps,
-						error))
-				{
-					return FAIL;
-				}
-				break;
-		}
+		if (FAIL == zbx_count_var_with_pattern(pdata, pattern, &values->values[i], count, error))
+			return FAIL;
 	}
 
 	return SUCCEED;
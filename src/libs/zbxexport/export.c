@@ -15,6 +15,7 @@
 #include "zbxexport.h"
 
 #include "zbxcommon.h"
+#include "zbxfile.h"
 #include "zbxstr.h"
 #include "zbxtypes.h"
 
@@ -22,6 +23,8 @@
 #define ZBX_OPTION_EXPTYPE_HISTORY	"history"
 #define ZBX_OPTION_EXPTYPE_TRENDS	"trends"
 
+#define ZBX_EXPORT_BUFFER_SIZE	(256 * ZBX_KIBIBYTE)
+
 static zbx_get_export_file_f	get_history_file;
 static zbx_get_export_file_f	get_trends_file;
 static zbx_get_export_file_f	get_problems_file;
@@ -197,19 +200,50 @@ void	zbx_deinit_library_export(void)
 	get_problems_file = NULL;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: opens export file for appending and reads its current size        *
+ *                                                                            *
+ ******************************************************************************/
 static int	open_export_file(zbx_export_file_t *file, char **error)
 {
-	if (NULL == (file->file = fopen(file->name, "a")))
+	zbx_stat_t	st;
+
+	if (-1 == (file->fd = open(file->name, O_WRONLY | O_APPEND | O_CREAT, 0666)))
 	{
 		*error = zbx_dsprintf(*error, "cannot open export file '%s': %s", file->name, zbx_strerror(errno));
 		return FAIL;
 	}
 
+	if (0 != zbx_fstat(file->fd, &st))
+	{
+		*error = zbx_dsprintf(*error, "cannot obtain size of export file '%s': %s", file->name,
+				zbx_strerror(errno));
+		close(file->fd);
+		file->fd = -1;
+		return FAIL;
+	}
+
+	file->size = (zbx_uint64_t)st.st_size;
+
 	zabbix_log(LOG_LEVEL_DEBUG, "successfully created export file '%s'", file->name);
 
 	return SUCCEED;
 }
 
+static int	close_export_file(zbx_export_file_t *file)
+{
+	int	ret;
+
+	if (-1 == file->fd)
+		return SUCCEED;
+
+	ret = (0 == close(file->fd) ? SUCCEED : FAIL);
+	file->fd = -1;
+
+	return ret;
+}
+
 static zbx_export_file_t	*export_init(const char *process_type, const char *process_name, int process_num)
 {
 	char			*export_dir, *error = NULL;
@@ -243,6 +277,9 @@ static zbx_export_file_t	*export_init(const char *process_type, const char *proc
 	}
 
 	file->missing = 0;
+	file->checked = 1;
+	file->buf = (char *)zbx_malloc(NULL, ZBX_EXPORT_BUFFER_SIZE);
+	file->buf_offset = 0;
 
 	return file;
 }
@@ -271,41 +308,156 @@ zbx_export_file_t	*zbx_problems_export_init(zbx_get_export_file_f get_export_fil
 	return export_init("problems", process_name, process_num);
 }
 
-void	zbx_export_deinit(zbx_export_file_t *file)
-{
-	zbx_fclose(file->file);
-	zbx_free(file->name);
-	zbx_free(file);
-}
-
-static void	export_write(const char *buf, size_t count, zbx_export_file_t *file)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: logs export error, suppressing repeated messages                  *
+ *                                                                            *
+ ******************************************************************************/
+static void	export_log_error(const char *error)
 {
 #define ZBX_LOGGING_SUSPEND_TIME	10
 
 	static time_t	last_log_time = 0;
 	time_t		now;
-	char		*error_msg = NULL;
-	long		file_offset;
 
-	if (NULL == config_export)
+	now = time(NULL);
+
+	if (ZBX_LOGGING_SUSPEND_TIME < now - last_log_time)
 	{
-		zabbix_log(LOG_LEVEL_CRIT, "export library is not initialized");
-		exit(EXIT_FAILURE);
+		zabbix_log(LOG_LEVEL_ERR, "%s", error);
+		last_log_time = now;
+	}
+
+#undef ZBX_LOGGING_SUSPEND_TIME
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: closes export file after failure, buffered data is kept to be     *
+ *          written when the file is reopened                                 *
+ *                                                                            *
+ ******************************************************************************/
+static void	export_fail(zbx_export_file_t *file, char *error)
+{
+	if (FAIL == close_export_file(file))
+	{
+		error = zbx_dsprintf(error, "%s; cannot close export file %s': %s", error, file->name,
+				zbx_strerror(errno));
 	}
 
-	if (0 == file->missing && 0 != access(file->name, F_OK))
+	export_log_error(error);
+	zbx_free(error);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: writes buffered export data to file                               *
+ *                                                                            *
+ * Return value: SUCCEED - buffer was written or there was nothing to write   *
+ *               FAIL    - file is not open or write error                    *
+ *                                                                            *
+ * Comments: On write error the file is closed and the data that was not      *
+ *           written is left in the buffer to be retried after the file is    *
+ *           reopened.                                                        *
+ *                                                                            *
+ ******************************************************************************/
+static int	export_write_buffer(zbx_export_file_t *file)
+{
+	size_t	written = 0;
+
+	if (0 == file->buf_offset)
+		return SUCCEED;
+
+	/* the file was closed after failure and is not reopened yet */
+	if (-1 == file->fd)
+		return FAIL;
+
+	while (written < file->buf_offset)
 	{
-		if (NULL != file->file && 0 != fclose(file->file))
-			zabbix_log(LOG_LEVEL_DEBUG, "cannot close export file '%s': %s",file->name,
+		ssize_t	ret;
+
+		if (-1 != (ret = write(file->fd, file->buf + written, file->buf_offset - written)))
+		{
+			written += (size_t)ret;
+		}
+		else if (EINTR != errno)
+		{
+			char	*error;
+
+			error = zbx_dsprintf(NULL, "cannot write to export file '%s': %s", file->name,
 					zbx_strerror(errno));
 
-		file->file = NULL;
+			file->size += written;
+			file->buf_offset -= written;
+			memmove(file->buf, file->buf + written, file->buf_offset);
+
+			export_fail(file, error);
+
+			return FAIL;
+		}
+	}
+
+	file->size += file->buf_offset;
+	file->buf_offset = 0;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: discards buffered export data that could not be written           *
+ *                                                                            *
+ ******************************************************************************/
+static void	export_discard_buffer(zbx_export_file_t *file)
+{
+	int		lines_num = 0;
+	const char	*p = file->buf, *end = file->buf + file->buf_offset;
+
+	if (0 == file->buf_offset)
+		return;
+
+	while (NULL != (p = (const char *)memchr(p, '\n', (size_t)(end - p))))
+	{
+		lines_num++;
+		p++;
+	}
+
+	zabbix_log(LOG_LEVEL_WARNING, "discarded %d lines that could not be written to export file '%s'",
+			lines_num, file->name);
+
+	file->buf_offset = 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks that export file still exists and reopens it if needed     *
+ *                                                                            *
+ * Comments: The check is done once per flush, not for every exported line.   *
+ *                                                                            *
+ ******************************************************************************/
+static int	export_check_file(zbx_export_file_t *file, char **error)
+{
+	if (0 == file->checked)
+	{
+		if (0 == file->missing && -1 != file->fd && 0 != access(file->name, F_OK))
+		{
+			if (FAIL == close_export_file(file))
+			{
+				zabbix_log(LOG_LEVEL_DEBUG, "cannot close export file '%s': %s", file->name,
+						zbx_strerror(errno));
+			}
+		}
+
+		file->checked = 1;
 	}
 
-	if (NULL == file->file && FAIL == open_export_file(file, &error_msg))
+	if (-1 == file->fd)
 	{
-		file->missing = 1;
-		goto error;
+		if (FAIL == open_export_file(file, error))
+		{
+			file->missing = 1;
+			return FAIL;
+		}
 	}
 
 	if (1 == file->missing)
@@ -314,74 +466,108 @@ static void	export_write(const char *buf, size_t count, zbx_export_file_t *file)
 		zabbix_log(LOG_LEVEL_ERR, "regained access to export file '%s'", file->name);
 	}
 
-	if (-1 == (file_offset = ftell(file->file)))
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: renames current export file to .old and opens a new one           *
+ *                                                                            *
+ ******************************************************************************/
+static int	export_rotate(zbx_export_file_t *file, char **error)
+{
+	char	filename_old[MAX_STRING_LEN];
+
+	zbx_strscpy(filename_old, file->name);
+	zbx_strlcat(filename_old, ".old", MAX_STRING_LEN);
+
+	if (0 == access(filename_old, F_OK) && 0 != remove(filename_old))
 	{
-		error_msg = zbx_dsprintf(error_msg, "cannot get current position in export file '%s': %s",
-				file->name, zbx_strerror(errno));
-		goto error;
+		*error = zbx_dsprintf(*error, "cannot remove export file '%s': %s", filename_old, zbx_strerror(errno));
+		return FAIL;
 	}
 
-	if (config_export->file_size <= count + (size_t)file_offset + 1)
+	if (FAIL == close_export_file(file))
 	{
-		char	filename_old[MAX_STRING_LEN];
-
-		zbx_strscpy(filename_old, file->name);
-		zbx_strlcat(filename_old, ".old", MAX_STRING_LEN);
+		*error = zbx_dsprintf(*error, "cannot close export file %s': %s", file->name, zbx_strerror(errno));
+		return FAIL;
+	}
 
-		if (0 == access(filename_old, F_OK) && 0 != remove(filename_old))
-		{
-			error_msg = zbx_dsprintf(error_msg, "cannot remove export file '%s': %s",
-					filename_old, zbx_strerror(errno));
-			goto error;
-		}
+	if (0 != rename(file->name, filename_old))
+	{
+		*error = zbx_dsprintf(*error, "cannot rename export file '%s': %s", file->name, zbx_strerror(errno));
+		return FAIL;
+	}
 
-		if (0 != fclose(file->file))
-		{
-			error_msg = zbx_dsprintf(error_msg, "cannot close export file %s': %s",
-					file->name, zbx_strerror(errno));
-			file->file = NULL;
-			goto error;
-		}
-		file->file = NULL;
+	return open_export_file(file, error);
+}
 
-		if (0 != rename(file->name, filename_old))
-		{
-			error_msg = zbx_dsprintf(error_msg, "cannot rename export file '%s': %s",
-					file->name, zbx_strerror(errno));
-			goto error;
-		}
+/******************************************************************************
+ *                                                                            *
+ * Purpose: appends line to export file buffer                                *
+ *                                                                            *
+ * Parameters: buf   - [IN] line to export (without newline)                  *
+ *             count - [IN] line length                                       *
+ *             file  - [IN] export file                                       *
+ *                                                                            *
+ * Comments: Data is written to disk when the buffer is full or on flush.     *
+ *           File rotation is based on the tracked file size, so no file      *
+ *           position or existence checks are done per line.                  *
+ *           Data that cannot be written stays in the buffer and is retried   *
+ *           on the next write or flush. It is discarded only when the buffer *
+ *           is needed for new data.                                          *
+ *                                                                            *
+ ******************************************************************************/
+static void	export_write(const char *buf, size_t count, zbx_export_file_t *file)
+{
+	char	*error_msg = NULL;
 
-		if (FAIL == open_export_file(file, &error_msg))
-			goto error;
+	if (NULL == config_export)
+	{
+		zabbix_log(LOG_LEVEL_CRIT, "export library is not initialized");
+		exit(EXIT_FAILURE);
 	}
 
-	if (count != fwrite(buf, 1, count, file->file) || '\n' != fputc('\n', file->file))
+	/* when the file cannot be opened the line is still buffered to be written after the file is reopened */
+	if (FAIL == export_check_file(file, &error_msg))
 	{
-		error_msg = zbx_dsprintf(error_msg, "cannot write to export file '%s': %s", file->name,
-				zbx_strerror(errno));
-		goto error;
+		export_fail(file, error_msg);
 	}
-
-	return;
-error:
-	if (NULL != file->file && 0 != fclose(file->file))
+	else if (config_export->file_size <= count + file->size + file->buf_offset + 1 &&
+			SUCCEED == export_write_buffer(file) && FAIL == export_rotate(file, &error_msg))
 	{
-		error_msg = zbx_dsprintf(error_msg, "%s; cannot close export file %s': %s",
-				error_msg, file->name, zbx_strerror(errno));
+		export_fail(file, error_msg);
 	}
 
-	file->file = NULL;
-	now = time(NULL);
+	/* buffered data is discarded only when it cannot be written and there is no room for the new line */
+	if (ZBX_EXPORT_BUFFER_SIZE - file->buf_offset < count + 1 && FAIL == export_write_buffer(file))
+		export_discard_buffer(file);
 
-	if (ZBX_LOGGING_SUSPEND_TIME < now - last_log_time)
+	if (ZBX_EXPORT_BUFFER_SIZE < count + 1)
 	{
-		zabbix_log(LOG_LEVEL_ERR, "%s", error_msg);
-		last_log_time = now;
-	}
+		/* line does not fit in the buffer, write it directly */
+		if (-1 == file->fd)
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "discarded line that could not be written to export file '%s'",
+					file->name);
+			return;
+		}
 
-	zbx_free(error_msg);
+		if (FAIL == zbx_write_all(file->fd, buf, count) || FAIL == zbx_write_all(file->fd, "\n", 1))
+		{
+			export_fail(file, zbx_dsprintf(NULL, "cannot write to export file '%s': %s", file->name,
+					zbx_strerror(errno)));
+			return;
+		}
 
-#undef ZBX_LOGGING_SUSPEND_TIME
+		file->size += count + 1;
+
+		return;
+	}
+
+	memcpy(file->buf + file->buf_offset, buf, count);
+	file->buf_offset += count;
+	file->buf[file->buf_offset++] = '\n';
 }
 
 void	zbx_problems_export_write(const char *buf, size_t count)
@@ -399,10 +585,38 @@ void	zbx_trends_export_write(const char *buf, size_t count)
 	export_write(buf, count, get_trends_file());
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: writes buffered export data, reopening the file if it was closed  *
+ *          after failure                                                     *
+ *                                                                            *
+ ******************************************************************************/
 static void	export_flush(zbx_export_file_t *file)
 {
-	if (NULL != file && NULL != file->file && 0 != fflush(file->file))
-		zabbix_log(LOG_LEVEL_ERR, "cannot flush export file '%s': %s", file->name, zbx_strerror(errno));
+	char	*error = NULL;
+
+	if (NULL == file)
+		return;
+
+	if (0 != file->buf_offset)
+	{
+		if (SUCCEED == export_check_file(file, &error))
+			export_write_buffer(file);
+		else
+			export_fail(file, error);
+	}
+
+	file->checked = 0;
+}
+
+void	zbx_export_deinit(zbx_export_file_t *file)
+{
+	export_flush(file);
+	export_discard_buffer(file);
+	close_export_file(file);
+	zbx_free(file->buf);
+	zbx_free(file->name);
+	zbx_free(file);
 }
 
 void	zbx_problems_export_flush(void)
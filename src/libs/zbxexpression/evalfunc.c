@@ -1109,6 +1109,61 @@ int	zbx_execute_count_with_pattern(char *pattern, unsigned char value_type, zbx_
 	return ret;
 }
 
+/* count_value_cb() data */
+typedef struct
+{
+	zbx_eval_count_pattern_data_t	*pdata;
+	const char			*pattern;
+	unsigned char			value_type;
+	int				limit;
+	int				count;
+}
+zbx_count_data_t;
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: counts value cache value matching pattern                         *
+ *                                                                            *
+ * Return value: SUCCEED - continue counting                                  *
+ *               FAIL    - the count limit is reached                         *
+ *                                                                            *
+ * Comments: Regular expression patterns are not supported as they are too    *
+ *           slow to be matched while value cache is locked.                  *
+ *                                                                            *
+ ******************************************************************************/
+static int	count_value_cb(const zbx_history_record_t *value, void *data)
+{
+	zbx_count_data_t	*cd = (zbx_count_data_t *)data;
+	zbx_variant_t		var;
+
+	if (OP_ANY == cd->pdata->op)
+	{
+		cd->count++;
+	}
+	else
+	{
+		switch (cd->value_type)
+		{
+			case ITEM_VALUE_TYPE_UINT64:
+				zbx_variant_set_ui64(&var, value->value.ui64);
+				break;
+			case ITEM_VALUE_TYPE_FLOAT:
+				zbx_variant_set_dbl(&var, value->value.dbl);
+				break;
+			case ITEM_VALUE_TYPE_LOG:
+				zbx_variant_set_str(&var, value->value.log->value);
+				break;
+			default:
+				zbx_variant_set_str(&var, value->value.str);
+		}
+
+		/* only regular expressions can fail, which are not counted by this callback */
+		(void)zbx_count_var_with_pattern(cd->pdata, cd->pattern, &var, &cd->count, NULL);
+	}
+
+	return cd->count < cd->limit ? SUCCEED : FAIL;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: evaluate functions 'count' and 'find' for the item.               *
@@ -1199,6 +1254,25 @@ static int	evaluate_COUNT(zbx_variant_t *value, const zbx_dc_evaluate_item_t *it
 			THIS_SHOULD_NEVER_HAPPEN;
 	}
 
+	/* count values in place unless they must be deduplicated or matched with regular expression */
+	if (COUNT_ALL == unique && OP_REGEXP != pdata.op && OP_IREGEXP != pdata.op)
+	{
+		zbx_count_data_t	cd = {.pdata = &pdata, .pattern = pattern, .value_type = item->value_type,
+						.limit = limit};
+
+		if (FAIL == zbx_vc_process_values(item->itemid, item->value_type, seconds, nvalues, &ts_end,
+				count_value_cb, &cd))
+		{
+			*error = zbx_strdup(*error, "cannot get values from value cache");
+			goto clean;
+		}
+
+		zbx_variant_set_dbl(value, cd.count);
+		ret = SUCCEED;
+
+		goto clean;
+	}
+
 	if (FAIL == zbx_vc_get_values(item->itemid, item->value_type, &values, seconds, nvalues, &ts_end))
 	{
 		*error = zbx_strdup(*error, "cannot get values from value cache");
@@ -1284,16 +1358,13 @@ out:
 static int	evaluate_SUM(zbx_variant_t *value, const zbx_dc_evaluate_item_t *item, const char *parameters,
 		const zbx_timespec_t *ts, char **error)
 {
-	int				arg1, i, ret = FAIL, seconds = 0, nvalues = 0, time_shift;
-	zbx_value_type_t		arg1_type;
-	zbx_vector_history_record_t	values;
-	zbx_history_value_t		result;
-	zbx_timespec_t			ts_end = *ts;
+	int			arg1, ret = FAIL, seconds = 0, nvalues = 0, time_shift;
+	zbx_value_type_t	arg1_type;
+	zbx_vc_aggregate_t	aggregate;
+	zbx_timespec_t		ts_end = *ts;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
-	zbx_history_record_vector_create(&values);
-
 	if (ITEM_VALUE_TYPE_FLOAT != item->value_type && ITEM_VALUE_TYPE_UINT64 != item->value_type)
 	{
 		*error = zbx_strdup(*error, "invalid value type");
@@ -1327,32 +1398,15 @@ static int	evaluate_SUM(zbx_variant_t *value, const zbx_dc_evaluate_item_t *item
 			THIS_SHOULD_NEVER_HAPPEN;
 	}
 
-	if (FAIL == zbx_vc_get_values(item->itemid, item->value_type, &values, seconds, nvalues, &ts_end))
+	if (FAIL == zbx_vc_get_aggregate(item->itemid, item->value_type, seconds, nvalues, &ts_end, &aggregate))
 	{
 		*error = zbx_strdup(*error, "cannot get values from value cache");
 		goto out;
 	}
 
-	if (ITEM_VALUE_TYPE_FLOAT == item->value_type)
-	{
-		result.dbl = 0;
-
-		for (i = 0; i < values.values_num; i++)
-			result.dbl += values.values[i].value.dbl;
-	}
-	else
-	{
-		result.ui64 = 0;
-
-		for (i = 0; i < values.values_num; i++)
-			result.ui64 += values.values[i].value.ui64;
-	}
-
-	zbx_history_value2variant(&result, item->value_type, value);
+	zbx_history_value2variant(&aggregate.sum, item->value_type, value);
 	ret = SUCCEED;
 out:
-	zbx_history_record_vector_destroy(&values, item->value_type);
-
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
 
 	return ret;
@@ -1376,15 +1430,13 @@ out:
 static int	evaluate_AVG(zbx_variant_t *value, const zbx_dc_evaluate_item_t *item, const char *parameters,
 		const zbx_timespec_t *ts, char **error)
 {
-	int				arg1, ret = FAIL, i, seconds = 0, nvalues = 0, time_shift;
-	zbx_value_type_t		arg1_type;
-	zbx_vector_history_record_t	values;
-	zbx_timespec_t			ts_end = *ts;
+	int			arg1, ret = FAIL, seconds = 0, nvalues = 0, time_shift;
+	zbx_value_type_t	arg1_type;
+	zbx_vc_aggregate_t	aggregate;
+	zbx_timespec_t		ts_end = *ts;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
-	zbx_history_record_vector_create(&values);
-
 	if (ITEM_VALUE_TYPE_FLOAT != item->value_type && ITEM_VALUE_TYPE_UINT64 != item->value_type)
 	{
 		*error = zbx_strdup(*error, "invalid value type");
@@ -1418,29 +1470,15 @@ static int	evaluate_AVG(zbx_variant_t *value, const zbx_dc_evaluate_item_t *item
 			THIS_SHOULD_NEVER_HAPPEN;
 	}
 
-	if (FAIL == zbx_vc_get_values(item->itemid, item->value_type, &values, seconds, nvalues, &ts_end))
+	if (FAIL == zbx_vc_get_aggregate(item->itemid, item->value_type, seconds, nvalues, &ts_end, &aggregate))
 	{
 		*error = zbx_strdup(*error, "cannot get values from value cache");
 		goto out;
 	}
 
-	if (0 < values.values_num)
+	if (0 < aggregate.values_num)
 	{
-		double	avg = 0;
-
-		if (ITEM_VALUE_TYPE_FLOAT == item->value_type)
-		{
-			for (i = 0; i < values.values_num; i++)
-				avg += values.values[i].value.dbl / (i + 1) - avg / (i + 1);
-		}
-		else
-		{
-			for (i = 0; i < values.values_num; i++)
-				avg += (double)values.values[i].value.ui64;
-
-			avg = avg / values.values_num;
-		}
-		zbx_variant_set_dbl(value, avg);
+		zbx_variant_set_dbl(value, aggregate.avg);
 
 		ret = SUCCEED;
 	}
@@ -1450,8 +1488,6 @@ static int	evaluate_AVG(zbx_variant_t *value, const zbx_dc_evaluate_item_t *item
 		*error = zbx_strdup(*error, "not enough data");
 	}
 out:
-	zbx_history_record_vector_destroy(&values, item->value_type);
-
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
 
 	return ret;
@@ -1574,17 +1610,6 @@ static int	evaluate_LOGTIMESTAMP(zbx_variant_t *value, const zbx_dc_evaluate_ite
 #define EVALUATE_MIN	0
 #define EVALUATE_MAX	1
 
-#define LOOP_FIND_MIN_OR_MAX(type, mode_op)							\
-	do											\
-	{											\
-		for (i = 1; i < values.values_num; i++)							\
-		{											\
-			if (values.values[i].value.type mode_op values.values[index].value.type)	\
-				index = i;								\
-		}											\
-	}												\
-	while(0)
-
 /******************************************************************************
  *                                                                            *
  * Purpose: evaluate function 'min' or 'max' for the item.                    *
@@ -1604,15 +1629,13 @@ static int	evaluate_LOGTIMESTAMP(zbx_variant_t *value, const zbx_dc_evaluate_ite
 static int	evaluate_MIN_or_MAX(zbx_variant_t *value, const zbx_dc_evaluate_item_t *item, const char *parameters,
 		const zbx_timespec_t *ts, char **error, int min_or_max)
 {
-	int				arg1, i, ret = FAIL, seconds = 0, nvalues = 0, time_shift;
-	zbx_value_type_t		arg1_type;
-	zbx_vector_history_record_t	values;
-	zbx_timespec_t			ts_end = *ts;
+	int			arg1, ret = FAIL, seconds = 0, nvalues = 0, time_shift;
+	zbx_value_type_t	arg1_type;
+	zbx_vc_aggregate_t	aggregate;
+	zbx_timespec_t		ts_end = *ts;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
-	zbx_history_record_vector_create(&values);
-
 	if (ITEM_VALUE_TYPE_FLOAT != item->value_type && ITEM_VALUE_TYPE_UINT64 != item->value_type)
 	{
 		*error = zbx_strdup(*error, "invalid value type");
@@ -1646,40 +1669,16 @@ static int	evaluate_MIN_or_MAX(zbx_variant_t *value, const zbx_dc_evaluate_item_
 			THIS_SHOULD_NEVER_HAPPEN;
 	}
 
-	if (FAIL == zbx_vc_get_values(item->itemid, item->value_type, &values, seconds, nvalues, &ts_end))
+	if (FAIL == zbx_vc_get_aggregate(item->itemid, item->value_type, seconds, nvalues, &ts_end, &aggregate))
 	{
 		*error = zbx_strdup(*error, "cannot get values from value cache");
 		goto out;
 	}
 
-	if (0 < values.values_num)
+	if (0 < aggregate.values_num)
 	{
-		int	index = 0;
-
-		if (ITEM_VALUE_TYPE_UINT64 == item->value_type)
-		{
-			if (EVALUATE_MIN == min_or_max)
-			{
-				LOOP_FIND_MIN_OR_MAX(ui64, <);
-			}
-			else
-			{
-				LOOP_FIND_MIN_OR_MAX(ui64, >);
-			}
-		}
-		else
-		{
-			if (EVALUATE_MIN == min_or_max)
-			{
-				LOOP_FIND_MIN_OR_MAX(dbl, <);
-			}
-			else
-			{
-				LOOP_FIND_MIN_OR_MAX(dbl, >);
-			}
-		}
-
-		zbx_history_value2variant(&values.values[index].value, item->value_type, value);
+		zbx_history_value2variant(EVALUATE_MIN == min_or_max ? &aggregate.min : &aggregate.max,
+				item->value_type, value);
 		ret = SUCCEED;
 	}
 	else
@@ -1688,8 +1687,6 @@ static int	evaluate_MIN_or_MAX(zbx_variant_t *value, const zbx_dc_evaluate_item_
 		*error = zbx_strdup(*error, "not enough data");
 	}
 out:
-	zbx_history_record_vector_destroy(&values, item->value_type);
-
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
 
 	return ret;
@@ -207,6 +207,63 @@ int	zbx_write_all(int fd, const char *buf, size_t n)
 
 #endif	/* not _WINDOWS */
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: fills word with repeated character of given size                  *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_uint64_t	buf_fill_word(const char *c, size_t szbyte)
+{
+	zbx_uint64_t	word;
+	size_t		i;
+
+	for (i = 0; i < sizeof(word); i += szbyte)
+		memcpy((char *)&word + i, c, szbyte);
+
+	return word;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: skips whole words of buffer which contain neither newline nor     *
+ *          zero characters                                                   *
+ *                                                                            *
+ * Parameters: p       - [IN] pointer to buffer                               *
+ *             p_end   - [IN] pointer to end of buffer p                      *
+ *             cr_word - [IN] carriage return repeated over the whole word    *
+ *             lf_word - [IN] line feed repeated over the whole word          *
+ *             ones    - [IN] word with value 1 in every character            *
+ *             highs   - [IN] word with the top bit set in every character    *
+ *                                                                            *
+ * Return value: pointer to the first word which must be checked character    *
+ *               by character                                                 *
+ *                                                                            *
+ * Comments: A word has a zero character if subtracting 1 from every          *
+ *           character sets the highest bit of a character where it was not   *
+ *           set before. Newlines are detected as zero characters after       *
+ *           XOR with the repeated newline.                                   *
+ *                                                                            *
+ ******************************************************************************/
+static char	*buf_skip_plain_words(char *p, const char *p_end, zbx_uint64_t cr_word, zbx_uint64_t lf_word,
+		zbx_uint64_t ones, zbx_uint64_t highs)
+{
+#define HAS_ZERO(w)	(0 != (((w) - ones) & ~(w) & highs))
+	zbx_uint64_t	word;
+
+	while (sizeof(word) <= (size_t)(p_end - p))
+	{
+		memcpy(&word, p, sizeof(word));
+
+		if (HAS_ZERO(word) || HAS_ZERO(word ^ lf_word) || HAS_ZERO(word ^ cr_word))
+			break;
+
+		p += sizeof(word);
+	}
+
+	return p;
+#undef HAS_ZERO
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: find next newline in buffer using newline encoding                *
@@ -218,7 +275,8 @@ int	zbx_write_all(int fd, const char *buf, size_t n)
  *             lf      - [IN] line feed string                                *
  *             szbyte  - [IN] size of newline strings                         *
  *                                                                            *
- * Comment: This function replaces '\0' symbols with '?'.                     *
+ * Comment: This function replaces '\0' symbols with '?'. Parts of buffer     *
+ *          without newline and zero characters are skipped a word at a time. *
  *                                                                            *
  * Return value: pointer to end of line (before newline string) or            *
  *               NULL if newline is not found.                                *
@@ -226,10 +284,20 @@ int	zbx_write_all(int fd, const char *buf, size_t n)
  ******************************************************************************/
 char	*zbx_find_buf_newline(char *p, char **p_next, const char *p_end, const char *cr, const char *lf, size_t szbyte)
 {
+	zbx_uint64_t	ones, highs, cr_word, lf_word;
+
+	ones = __UINT64_C(0xffffffffffffffff) / ((__UINT64_C(1) << (8 * szbyte)) - 1);
+	highs = ones << (8 * szbyte - 1);
+	cr_word = buf_fill_word(cr, szbyte);
+	lf_word = buf_fill_word(lf, szbyte);
+
 	if (1 == szbyte)	/* single-byte character set */
 	{
 		for (; p < p_end; p++)
 		{
+			if (p_end == (p = buf_skip_plain_words(p, p_end, cr_word, lf_word, ones, highs)))
+				break;
+
 			/* detect NULL byte and replace it with '?' character */
 			if (0x0 == *p)
 			{
@@ -264,6 +332,9 @@ char	*zbx_find_buf_newline(char *p, char **p_next, const char *p_end, const char
 	{
 		while (p <= p_end - szbyte)
 		{
+			if (p_end - szbyte < (p = buf_skip_plain_words(p, p_end, cr_word, lf_word, ones, highs)))
+				break;
+
 			/* detect NULL byte in UTF-16 encoding and replace it with '?' character */
 			if (2 == szbyte && 0x0 == *p && 0x0 == *(p + 1))
 			{
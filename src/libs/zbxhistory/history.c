@@ -38,20 +38,28 @@ zbx_history_iface_t	history_ifaces[ITEM_VALUE_TYPE_BIN + 1];
  *                                                                                  *
  * Comments: History interfaces are created for all values types based on           *
  *           configuration. Every value type can have different history storage     *
- *           backend. (Binary value type is not supported for ElasticSearch)        *
+ *           backend. (Binary value type is not supported for ElasticSearch, only   *
+ *           numeric value types are supported by local history storage)            *
  *                                                                                  *
  ************************************************************************************/
 int	zbx_history_init(const char *config_history_storage_url, const char *config_history_storage_opts,
-		int config_log_slow_queries, char **error)
+		const char *config_history_storage_path, const char *config_history_storage_path_opts,
+		int config_log_slow_queries, int config_history_writers, char **error)
 {
 	/* TODO: support per value type specific configuration */
 
 	const char	*opts[] = {"dbl", "str", "log", "uint", "text", "bin"};
 
+	zbx_history_sql_set_writers_num(config_history_writers);
+
 	for (int i = ITEM_VALUE_TYPE_FLOAT; i <= ITEM_VALUE_TYPE_BIN; i++)
 	{
-
-		if (NULL == config_history_storage_url || NULL == strstr(config_history_storage_opts, opts[i]))
+		if (NULL != config_history_storage_path && NULL != strstr(config_history_storage_path_opts, opts[i]))
+		{
+			if (FAIL == zbx_history_tsdb_init(&history_ifaces[i], i, config_history_storage_path, error))
+				return FAIL;
+		}
+		else if (NULL == config_history_storage_url || NULL == strstr(config_history_storage_opts, opts[i]))
 		{
 			zbx_history_sql_init(&history_ifaces[i], i);
 		}
@@ -91,7 +99,8 @@ void	zbx_history_destroy(void)
 	{
 		zbx_history_iface_t	*writer = &history_ifaces[i];
 
-		writer->destroy(writer);
+		if (NULL != writer->destroy)
+			writer->destroy(writer);
 	}
 }
 
@@ -39,6 +39,7 @@ struct zbx_history_iface
 	union
 	{
 		void				*elastic_data;
+		void				*tsdb_data;
 		zbx_history_func_t		sql_history_func;
 	} data;
 	zbx_history_destroy_func_t	destroy;
@@ -50,6 +51,7 @@ struct zbx_history_iface
 
 /* SQL hist */
 void	zbx_history_sql_init(zbx_history_iface_t *hist, unsigned char value_type);
+void	zbx_history_sql_set_writers_num(int writers_num);
 
 /* elastic hist */
 int	zbx_history_elastic_init(zbx_history_iface_t *hist, unsigned char value_type,
@@ -58,4 +60,8 @@ void	zbx_elastic_version_extract(struct zbx_json *json, int *result, int config_
 		const char *config_history_storage_url);
 zbx_uint32_t	zbx_elastic_version_get(void);
 
+/* local hist */
+int	zbx_history_tsdb_init(zbx_history_iface_t *hist, unsigned char value_type,
+		const char *config_history_storage_path, char **error);
+
 #endif
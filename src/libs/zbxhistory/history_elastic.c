@@ -29,22 +29,35 @@
 #include "zbxvariant.h"
 #include "zbxcurl.h"
 #include "zbxcacheconfig.h"
+#include "zbxcompress.h"
 
 #define		ZBX_HISTORY_STORAGE_DOWN	10000 /* Timeout in milliseconds */
 
 #define		ZBX_IDX_JSON_ALLOCATE		256
 #define		ZBX_JSON_ALLOCATE		2048
 
+#define		ZBX_ELASTIC_BULK_MAX_SIZE		(5 * ZBX_MEBIBYTE)	/* uncompressed bulk request size */
+#define		ZBX_ELASTIC_BULK_MAX_REQUESTS		4			/* concurrent bulk requests per index */
+#define		ZBX_ELASTIC_FORBIDDEN_MAX_ATTEMPTS	3			/* sending attempts to blocked index */
+#define		ZBX_ELASTIC_STATS_PERIOD		(5 * SEC_PER_MIN)	/* statistics logging period */
+
+#define		ZBX_ELASTIC_HTTP_FORBIDDEN		403
+#define		ZBX_ELASTIC_HTTP_TOO_MANY_REQUESTS	429
+#define		ZBX_ELASTIC_HTTP_SERVER_ERROR		500
+
 const char	*value_type_str[] = {"dbl", "str", "log", "uint", "text"};
 
 static zbx_uint32_t	ZBX_ELASTIC_SVERSION = ZBX_DBVERSION_UNDEFINED;
 
 typedef struct
 {
-	char	*base_url;
-	char	*post_url;
-	char	*buf;
-	CURL	*handle;
+	char			*base_url;
+	char			*post_url;
+	char			*buf;
+	size_t			buf_alloc;
+	size_t			buf_offset;
+	zbx_vector_uint64_t	docs;		/* offsets of bulk documents (action and source lines) in buf */
+	CURL			*handle;
 }
 zbx_elastic_data_t;
 
@@ -71,12 +84,30 @@ static zbx_httppage_t	page_r;
 
 typedef struct
 {
-	zbx_httppage_t	page;
-	char		errbuf[CURL_ERROR_SIZE];
+	zbx_history_iface_t	*hist;
+	CURL			*handle;
+	char			*body;
+	zbx_vector_int32_t	docs;		/* indexes of documents sent by this request */
+	zbx_httppage_t		page;
+	char			errbuf[CURL_ERROR_SIZE];
+	double			time_start;
+	int			attempt;	/* the number of times the documents were sent, including this one */
+}
+zbx_elastic_request_t;
+
+typedef struct
+{
+	zbx_uint64_t	requests;
+	zbx_uint64_t	docs;
+	zbx_uint64_t	retried;
+	zbx_uint64_t	failed;
+	double		time_total;
+	double		time_max;
 }
-zbx_curlpage_t;
+zbx_elastic_stats_t;
 
-static zbx_curlpage_t	page_w[ITEM_VALUE_TYPE_BIN + 1];
+static zbx_elastic_stats_t	elastic_stats[ITEM_VALUE_TYPE_BIN + 1];
+static time_t			elastic_stats_time;
 
 static size_t	curl_write_cb(void *ptr, size_t size, size_t nmemb, void *userdata)
 {
@@ -240,12 +271,12 @@ static void	elastic_close(zbx_history_iface_t *hist)
 
 	zbx_free(data->buf);
 	zbx_free(data->post_url);
+	data->buf_alloc = 0;
+	data->buf_offset = 0;
+	zbx_vector_uint64_clear(&data->docs);
 
 	if (NULL != data->handle)
 	{
-		if (NULL != writer.handle)
-			curl_multi_remove_handle(writer.handle, data->handle);
-
 		curl_easy_cleanup(data->handle);
 		data->handle = NULL;
 	}
@@ -253,70 +284,108 @@ static void	elastic_close(zbx_history_iface_t *hist)
 
 /******************************************************************************
  *                                                                            *
- * Purpose: check an error from Elastic json response                         *
+ * Purpose: checks bulk response for failed documents                         *
+ *                                                                            *
+ * Parameters: req     - [IN] the completed bulk request                      *
+ *             retries - [OUT] the documents to send again                    *
  *                                                                            *
- * Parameters: page - [IN]  the buffer with json response                     *
- *             err  - [OUT] the parse error message. If the error value is    *
- *                           set it must be freed by caller after it has      *
- *                           been used.                                       *
+ * Return value: the number of documents rejected with non-retryable error    *
  *                                                                            *
- * Return value: SUCCEED - the response contains an error                     *
- *               FAIL    - otherwise                                          *
+ * Comments: Bulk response items are in the same order as request documents.  *
+ *           Documents rejected because of overloaded or blocked index are    *
+ *           sent again, other errors (like mapping errors) are only logged,  *
+ *           as there is no sense to send the same data again. Blocked index  *
+ *           is not expected to recover soon, so such documents are dropped   *
+ *           after ZBX_ELASTIC_FORBIDDEN_MAX_ATTEMPTS attempts.               *
  *                                                                            *
  ******************************************************************************/
-static int	elastic_is_error_present(zbx_httppage_t *page, char **err)
+static int	elastic_bulk_get_retries(const zbx_elastic_request_t *req, zbx_vector_int32_t *retries)
 {
 	struct zbx_json_parse	jp, jp_values, jp_index, jp_error, jp_items, jp_item;
 	const char		*errors, *p = NULL;
-	char			*index = NULL, *status = NULL, *type = NULL, *reason = NULL;
-	size_t			index_alloc = 0, status_alloc = 0, type_alloc = 0, reason_alloc = 0;
-	int			rc_js = SUCCEED;
+	char			*index = NULL, *type = NULL, *reason = NULL, status[16];
+	size_t			index_alloc = 0, type_alloc = 0, reason_alloc = 0;
+	int			i = 0, failed = 0, retried = 0, rc_js = SUCCEED;
 
-	zabbix_log(LOG_LEVEL_TRACE, "%s() raw json: %s", __func__, ZBX_NULL2EMPTY_STR(page->data));
+	zabbix_log(LOG_LEVEL_TRACE, "%s() raw json: %s", __func__, ZBX_NULL2EMPTY_STR(req->page.data));
 
-	if (SUCCEED != zbx_json_open(page->data, &jp) || SUCCEED != zbx_json_brackets_open(jp.start, &jp_values))
-		return FAIL;
+	if (SUCCEED != zbx_json_open(req->page.data, &jp) || SUCCEED != zbx_json_brackets_open(jp.start, &jp_values))
+		return 0;
 
 	if (NULL == (errors = zbx_json_pair_by_name(&jp_values, "errors")) || 0 != strncmp("true", errors, 4))
-		return FAIL;
+		return 0;
+
+	if (SUCCEED != zbx_json_brackets_by_name(&jp, "items", &jp_items))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot send data to elasticsearch: elasticsearch version is not fully"
+				" compatible with zabbix server");
 
-	if (SUCCEED == zbx_json_brackets_by_name(&jp, "items", &jp_items))
+		for (i = 0; i < req->docs.values_num; i++)
+			zbx_vector_int32_append(retries, req->docs.values[i]);
+
+		return 0;
+	}
+
+	for (; NULL != (p = zbx_json_next(&jp_items, p)) && i < req->docs.values_num; i++)
 	{
-		while (NULL != (p = zbx_json_next(&jp_items, p)))
+		int	code;
+
+		if (SUCCEED != zbx_json_brackets_open(p, &jp_item) ||
+				SUCCEED != zbx_json_brackets_by_name(&jp_item, "index", &jp_index) ||
+				SUCCEED != zbx_json_brackets_by_name(&jp_index, "error", &jp_error))
 		{
-			if (SUCCEED == zbx_json_brackets_open(p, &jp_item) &&
-					SUCCEED == zbx_json_brackets_by_name(&jp_item, "index", &jp_index) &&
-					SUCCEED == zbx_json_brackets_by_name(&jp_index, "error", &jp_error))
-			{
-				if (SUCCEED != zbx_json_value_by_name_dyn(&jp_error, "type", &type, &type_alloc, NULL))
-					rc_js = FAIL;
-				if (SUCCEED != zbx_json_value_by_name_dyn(&jp_error, "reason", &reason, &reason_alloc, NULL))
-					rc_js = FAIL;
-			}
-			else
-				continue;
+			continue;
+		}
 
-			if (SUCCEED != zbx_json_value_by_name_dyn(&jp_index, "status", &status, &status_alloc, NULL))
-				rc_js = FAIL;
-			if (SUCCEED != zbx_json_value_by_name_dyn(&jp_index, "_index", &index, &index_alloc, NULL))
-				rc_js = FAIL;
+		if (SUCCEED != zbx_json_value_by_name(&jp_index, "status", status, sizeof(status), NULL))
+		{
+			*status = '\0';
+			rc_js = FAIL;
+		}
 
-			break;
+		code = atoi(status);
+
+		if (ZBX_ELASTIC_HTTP_TOO_MANY_REQUESTS == code || ZBX_ELASTIC_HTTP_SERVER_ERROR <= code || 0 == code ||
+				(ZBX_ELASTIC_HTTP_FORBIDDEN == code &&
+				ZBX_ELASTIC_FORBIDDEN_MAX_ATTEMPTS > req->attempt))
+		{
+			zbx_vector_int32_append(retries, req->docs.values[i]);
+			retried++;
 		}
+		else
+			failed++;
+
+		/* log only the first error of the request */
+		if (NULL != type)
+			continue;
+
+		if (SUCCEED != zbx_json_value_by_name_dyn(&jp_error, "type", &type, &type_alloc, NULL))
+			rc_js = FAIL;
+		if (SUCCEED != zbx_json_value_by_name_dyn(&jp_error, "reason", &reason, &reason_alloc, NULL))
+			rc_js = FAIL;
+		if (SUCCEED != zbx_json_value_by_name_dyn(&jp_index, "_index", &index, &index_alloc, NULL))
+			rc_js = FAIL;
+
+		zabbix_log(LOG_LEVEL_WARNING, "cannot send data to elasticsearch: index:%s status:%s type:%s reason:%s%s",
+				ZBX_NULL2EMPTY_STR(index), status, ZBX_NULL2EMPTY_STR(type), ZBX_NULL2EMPTY_STR(reason),
+				FAIL == rc_js ? " / elasticsearch version is not fully compatible with zabbix server" : "");
+
+		if (NULL == type)
+			type = zbx_strdup(NULL, "");
 	}
-	else
-		rc_js = FAIL;
 
-	*err = zbx_dsprintf(NULL,"index:%s status:%s type:%s reason:%s%s", ZBX_NULL2EMPTY_STR(index),
-			ZBX_NULL2EMPTY_STR(status), ZBX_NULL2EMPTY_STR(type), ZBX_NULL2EMPTY_STR(reason),
-			FAIL == rc_js ? " / elasticsearch version is not fully compatible with zabbix server" : "");
+	if (0 != failed || 0 != retried)
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "elasticsearch rejected %d of %d documents in index \"%s\", %d will be"
+				" sent again", failed + retried, req->docs.values_num,
+				value_type_str[req->hist->value_type], retried);
+	}
 
-	zbx_free(status);
 	zbx_free(type);
 	zbx_free(reason);
 	zbx_free(index);
 
-	return SUCCEED;
+	return failed;
 }
 
 /******************************************************************************************************************
@@ -371,82 +440,263 @@ static void	elastic_writer_release(void)
  *                                                                                  *
  * Purpose: adds history storage interface to be flushed later                      *
  *                                                                                  *
- * Parameters: db_insert - [IN] bulk insert data                                    *
+ * Parameters: hist - [IN] the history storage interface                            *
  *                                                                                  *
  ************************************************************************************/
 static void	elastic_writer_add_iface(zbx_history_iface_t *hist)
+{
+	elastic_writer_init();
+
+	zbx_vector_ptr_append(&writer.ifaces, hist);
+}
+
+static void	elastic_request_free(zbx_elastic_request_t *req)
+{
+	if (NULL != req->handle)
+	{
+		curl_multi_remove_handle(writer.handle, req->handle);
+		curl_easy_cleanup(req->handle);
+	}
+
+	zbx_vector_int32_destroy(&req->docs);
+	zbx_free(req->body);
+	zbx_free(req->page.data);
+	zbx_free(req);
+}
+
+/************************************************************************************
+ *                                                                                  *
+ * Purpose: creates bulk request from queued documents and starts it                *
+ *                                                                                  *
+ * Parameters: hist    - [IN] the history storage interface                         *
+ *             queue   - [IN] the queued document indexes                           *
+ *             pos     - [IN/OUT] the position of the next document in queue        *
+ *             attempt - [IN] the number of times the queued documents were sent,   *
+ *                            including this one                                    *
+ *             headers - [IN] HTTP headers for plain and gzip compressed body       *
+ *             retries - [OUT] the documents to send again                          *
+ *                                                                                  *
+ * Return value: the started request or NULL on failure                             *
+ *                                                                                  *
+ * Comments: Documents are taken from the queue until the bulk size limit is        *
+ *           reached. The request body is gzip compressed if possible. If the       *
+ *           request cannot be started its documents are added to retries.          *
+ *                                                                                  *
+ ************************************************************************************/
+static zbx_elastic_request_t	*elastic_request_start(zbx_history_iface_t *hist, const zbx_vector_int32_t *queue,
+		int *pos, int attempt, struct curl_slist **headers, zbx_vector_int32_t *retries)
 {
 	zbx_elastic_data_t	*data = hist->data.elastic_data;
+	zbx_elastic_request_t	*req;
 	CURLoption		opt;
 	CURLcode		err;
-	char			*error = NULL;
+	char			*error = NULL, *body = NULL;
+	size_t			body_alloc = 0, body_offset = 0, body_size;
+	int			compressed;
 
-	elastic_writer_init();
+	req = (zbx_elastic_request_t *)zbx_malloc(NULL, sizeof(zbx_elastic_request_t));
+	memset(req, 0, sizeof(zbx_elastic_request_t));
+	req->hist = hist;
+	req->attempt = attempt;
+	zbx_vector_int32_create(&req->docs);
 
-	if (NULL == (data->handle = curl_easy_init()))
+	while (*pos < queue->values_num && ZBX_ELASTIC_BULK_MAX_SIZE > body_offset)
+	{
+		int	doc = queue->values[(*pos)++];
+		size_t	from = (size_t)data->docs.values[doc], to;
+
+		to = (doc + 1 < data->docs.values_num ? (size_t)data->docs.values[doc + 1] : data->buf_offset);
+		zbx_strncpy_alloc(&body, &body_alloc, &body_offset, data->buf + from, to - from);
+		zbx_vector_int32_append(&req->docs, doc);
+	}
+
+	zabbix_log(LOG_LEVEL_DEBUG, "sending %s", body);
+
+	if (SUCCEED == zbx_compress_gzip(body, body_offset, &req->body, &body_size))
+	{
+		zbx_free(body);
+		compressed = 1;
+	}
+	else
+	{
+		req->body = body;
+		body_size = body_offset;
+		compressed = 0;
+	}
+
+	if (NULL == (req->handle = curl_easy_init()))
 	{
 		zabbix_log(LOG_LEVEL_ERR, "cannot initialize cURL session");
-		return;
+		goto out;
 	}
 
-	if (CURLE_OK != (err = curl_easy_setopt(data->handle, opt = CURLOPT_URL, data->post_url)) ||
-			CURLE_OK != (err = curl_easy_setopt(data->handle, opt = CURLOPT_POST, 1L)) ||
-			CURLE_OK != (err = curl_easy_setopt(data->handle, opt = CURLOPT_POSTFIELDS, data->buf)) ||
-			CURLE_OK != (err = curl_easy_setopt(data->handle, opt = CURLOPT_WRITEFUNCTION,
+	if (CURLE_OK != (err = curl_easy_setopt(req->handle, opt = CURLOPT_URL, data->post_url)) ||
+			CURLE_OK != (err = curl_easy_setopt(req->handle, opt = CURLOPT_POST, 1L)) ||
+			CURLE_OK != (err = curl_easy_setopt(req->handle, opt = CURLOPT_POSTFIELDS, req->body)) ||
+			CURLE_OK != (err = curl_easy_setopt(req->handle, opt = CURLOPT_POSTFIELDSIZE_LARGE,
+					(curl_off_t)body_size)) ||
+			CURLE_OK != (err = curl_easy_setopt(req->handle, opt = CURLOPT_HTTPHEADER,
+					headers[compressed])) ||
+			CURLE_OK != (err = curl_easy_setopt(req->handle, opt = CURLOPT_WRITEFUNCTION,
 					curl_write_cb)) ||
-			CURLE_OK != (err = curl_easy_setopt(data->handle, opt = CURLOPT_WRITEDATA,
-					&page_w[hist->value_type].page)) ||
-			CURLE_OK != (err = curl_easy_setopt(data->handle, opt = CURLOPT_FAILONERROR, 1L)) ||
-			CURLE_OK != (err = curl_easy_setopt(data->handle, opt = CURLOPT_ERRORBUFFER,
-					page_w[hist->value_type].errbuf)) ||
-			CURLE_OK != (err = curl_easy_setopt(data->handle, opt = CURLOPT_ACCEPT_ENCODING, "")))
+			CURLE_OK != (err = curl_easy_setopt(req->handle, opt = CURLOPT_WRITEDATA, &req->page)) ||
+			CURLE_OK != (err = curl_easy_setopt(req->handle, opt = CURLOPT_FAILONERROR, 1L)) ||
+			CURLE_OK != (err = curl_easy_setopt(req->handle, opt = CURLOPT_ERRORBUFFER, req->errbuf)) ||
+			CURLE_OK != (err = curl_easy_setopt(req->handle, opt = CURLOPT_ACCEPT_ENCODING, "")) ||
+			CURLE_OK != (err = curl_easy_setopt(req->handle, opt = CURLOPT_PRIVATE, req)))
 	{
 		zabbix_log(LOG_LEVEL_ERR, "cannot set cURL option %d: [%s]", (int)opt, curl_easy_strerror(err));
 		goto out;
 	}
 
-	if (SUCCEED != zbx_curl_setopt_https(data->handle, &error))
+	if (SUCCEED != zbx_curl_setopt_https(req->handle, &error))
 	{
 		zabbix_log(LOG_LEVEL_ERR, "%s", error);
 		goto out;
 	}
 
-	*page_w[hist->value_type].errbuf = '\0';
+	req->time_start = zbx_time();
+	curl_multi_add_handle(writer.handle, req->handle);
+
+	return req;
+out:
+	zbx_free(error);
+	zbx_vector_int32_append_array(retries, req->docs.values, req->docs.values_num);
+	elastic_request_free(req);
+
+	return NULL;
+}
 
-	if (CURLE_OK != (err = curl_easy_setopt(data->handle, opt = CURLOPT_PRIVATE, &page_w[hist->value_type])))
+/************************************************************************************
+ *                                                                                  *
+ * Purpose: processes completed bulk request                                        *
+ *                                                                                  *
+ * Parameters: req     - [IN] the completed request                                 *
+ *             result  - [IN] the request transfer result                           *
+ *             retries - [OUT] the documents to send again                          *
+ *                                                                                  *
+ ************************************************************************************/
+static void	elastic_request_complete(zbx_elastic_request_t *req, CURLcode result, zbx_vector_int32_t *retries)
+{
+	zbx_history_iface_t	*hist = req->hist;
+	zbx_elastic_stats_t	*stats = &elastic_stats[hist->value_type];
+	double			sec;
+	long int		response_code = 0;
+	int			i, failed = 0;
+
+	sec = zbx_time() - req->time_start;
+
+	if (CURLE_HTTP_RETURNED_ERROR == result)
 	{
-		zabbix_log(LOG_LEVEL_ERR, "cannot set cURL option %d: [%s]", (int)opt, curl_easy_strerror(err));
-		goto out;
+		(void)curl_easy_getinfo(req->handle, CURLINFO_RESPONSE_CODE, &response_code);
+
+		if ('\0' != *req->errbuf)
+		{
+			zabbix_log(LOG_LEVEL_ERR, "cannot send data to elasticsearch, HTTP error message: %s",
+					req->errbuf);
+		}
+		else if (0 != response_code)
+		{
+			zabbix_log(LOG_LEVEL_ERR, "cannot send data to elasticsearch, HTTP status code: %ld",
+					response_code);
+		}
+		else
+			zabbix_log(LOG_LEVEL_ERR, "cannot send data to elasticsearch, unknown HTTP status code");
+
+		/* overloaded cluster or temporary server failure, the same data can be sent again */
+		if (ZBX_ELASTIC_HTTP_TOO_MANY_REQUESTS == response_code || ZBX_ELASTIC_HTTP_SERVER_ERROR <= response_code)
+		{
+			for (i = 0; i < req->docs.values_num; i++)
+				zbx_vector_int32_append(retries, req->docs.values[i]);
+		}
+		else
+			failed = req->docs.values_num;
 	}
+	else if (CURLE_OK != result)
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot send data to elasticsearch: %s",
+				'\0' != *req->errbuf ? req->errbuf : curl_easy_strerror(result));
 
-	page_w[hist->value_type].page.offset = 0;
+		/* If the error is due to curl internal problems or unrelated */
+		/* problems with HTTP, the documents are sent again           */
+		for (i = 0; i < req->docs.values_num; i++)
+			zbx_vector_int32_append(retries, req->docs.values[i]);
+	}
+	else
+		failed = elastic_bulk_get_retries(req, retries);
 
-	if (0 < page_w[hist->value_type].page.alloc)
-		*page_w[hist->value_type].page.data = '\0';
+	stats->requests++;
+	stats->docs += (zbx_uint64_t)req->docs.values_num;
+	stats->failed += (zbx_uint64_t)failed;
+	stats->time_total += sec;
 
-	curl_multi_add_handle(writer.handle, data->handle);
+	if (sec > stats->time_max)
+		stats->time_max = sec;
 
-	zbx_vector_ptr_append(&writer.ifaces, hist);
+	if (0 != hist->config_log_slow_queries && sec > (double)hist->config_log_slow_queries / 1000.0)
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "slow elasticsearch bulk request: " ZBX_FS_DBL " sec, index \"%s\","
+				" %d documents", sec, value_type_str[hist->value_type], req->docs.values_num);
+	}
+}
 
-	return;
-out:
-	zbx_free(error);
-	elastic_close(hist);
+/************************************************************************************
+ *                                                                                  *
+ * Purpose: logs per index bulk request statistics                                  *
+ *                                                                                  *
+ * Comments: Statistics are accumulated and logged once per                         *
+ *           ZBX_ELASTIC_STATS_PERIOD, then reset.                                  *
+ *                                                                                  *
+ ************************************************************************************/
+static void	elastic_stats_log(void)
+{
+	time_t	now;
+
+	now = time(NULL);
+
+	if (0 == elastic_stats_time)
+		elastic_stats_time = now;
+
+	if (now < elastic_stats_time + ZBX_ELASTIC_STATS_PERIOD)
+		return;
+
+	for (int i = 0; i <= ITEM_VALUE_TYPE_BIN; i++)
+	{
+		zbx_elastic_stats_t	*stats = &elastic_stats[i];
+
+		if (0 == stats->requests)
+			continue;
+
+		zabbix_log(LOG_LEVEL_INFORMATION, "elasticsearch index \"%s\" statistics for the last %d seconds:"
+				" requests:" ZBX_FS_UI64 " documents:" ZBX_FS_UI64 " retried:" ZBX_FS_UI64 " failed:"
+				ZBX_FS_UI64 " avg time:" ZBX_FS_DBL " max time:" ZBX_FS_DBL, value_type_str[i],
+				(int)(now - elastic_stats_time), stats->requests, stats->docs, stats->retried,
+				stats->failed, stats->time_total / (double)stats->requests, stats->time_max);
+	}
+
+	memset(elastic_stats, 0, sizeof(elastic_stats));
+	elastic_stats_time = now;
 }
 
 /************************************************************************************
  *                                                                                  *
  * Purpose: posts historical data to elastic storage                                *
  *                                                                                  *
+ * Comments: Documents of every index are split into bulk requests limited by size  *
+ *           and at most ZBX_ELASTIC_BULK_MAX_REQUESTS requests per index are sent  *
+ *           concurrently, so a slow index does not delay the other indexes more    *
+ *           than necessary. Documents failed with retryable errors are sent again  *
+ *           after ZBX_HISTORY_STORAGE_DOWN timeout.                                *
+ *                                                                                  *
  ************************************************************************************/
 static int	elastic_writer_flush(void)
 {
-	struct curl_slist	*curl_headers = NULL;
-	int			i, running, previous, msgnum;
+	struct curl_slist	*headers[2] = {NULL, NULL};
+	int			i, msgnum, queue_pos[ITEM_VALUE_TYPE_BIN + 1],
+				requests[ITEM_VALUE_TYPE_BIN + 1], attempts[ITEM_VALUE_TYPE_BIN + 1];
+	zbx_vector_int32_t	queues[ITEM_VALUE_TYPE_BIN + 1], retries[ITEM_VALUE_TYPE_BIN + 1];
+	zbx_vector_ptr_t	active;
 	CURLMsg			*msg;
-	zbx_vector_ptr_t	retries;
-	CURLcode		err;
-	int			ret = SUCCEED;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
@@ -455,37 +705,83 @@ static int	elastic_writer_flush(void)
 	if (0 == writer.initialized)
 		goto end;
 
-	zbx_vector_ptr_create(&retries);
+	headers[0] = curl_slist_append(headers[0], "Content-Type: application/x-ndjson");
+	headers[1] = curl_slist_append(headers[1], "Content-Type: application/x-ndjson");
+	headers[1] = curl_slist_append(headers[1], "Content-Encoding: gzip");
+
+	zbx_vector_ptr_create(&active);
 
-	curl_headers = curl_slist_append(curl_headers, "Content-Type: application/x-ndjson");
+	for (i = 0; i <= ITEM_VALUE_TYPE_BIN; i++)
+	{
+		zbx_vector_int32_create(&queues[i]);
+		zbx_vector_int32_create(&retries[i]);
+		queue_pos[i] = 0;
+		requests[i] = 0;
+		attempts[i] = 1;
+	}
 
 	for (i = 0; i < writer.ifaces.values_num; i++)
 	{
 		zbx_history_iface_t	*hist = (zbx_history_iface_t *)writer.ifaces.values[i];
 		zbx_elastic_data_t	*data = hist->data.elastic_data;
 
-		if (CURLE_OK != (err = curl_easy_setopt(data->handle, CURLOPT_HTTPHEADER, curl_headers)))
+		for (int j = 0; j < data->docs.values_num; j++)
+			zbx_vector_int32_append(&queues[hist->value_type], j);
+	}
+
+	while (1)
+	{
+		int		fds, retry = 0;
+		CURLMcode	code;
+
+		for (i = 0; i < writer.ifaces.values_num; i++)
 		{
-			zabbix_log(LOG_LEVEL_ERR, "cannot set cURL option %d: [%s]", (int)CURLOPT_HTTPHEADER,
-					curl_easy_strerror(err));
-			ret = FAIL;
-			goto clean;
+			zbx_history_iface_t	*hist = (zbx_history_iface_t *)writer.ifaces.values[i];
+			unsigned char		vt = hist->value_type;
+
+			while (ZBX_ELASTIC_BULK_MAX_REQUESTS > requests[vt] && queue_pos[vt] < queues[vt].values_num)
+			{
+				zbx_elastic_request_t	*req;
+
+				if (NULL == (req = elastic_request_start(hist, &queues[vt], &queue_pos[vt],
+						attempts[vt], headers, &retries[vt])))
+				{
+					continue;
+				}
+
+				zbx_vector_ptr_append(&active, req);
+				requests[vt]++;
+			}
 		}
 
-		zabbix_log(LOG_LEVEL_DEBUG, "sending %s", data->buf);
-	}
+		if (0 == active.values_num)
+		{
+			/* We check if we have documents to retry. If yes, we put them back in the queues */
+			/* and try sending the data again after sleeping for ZBX_HISTORY_STORAGE_DOWN    */
+			/* / 1000 (seconds) */
+			for (i = 0; i <= ITEM_VALUE_TYPE_BIN; i++)
+			{
+				if (0 == retries[i].values_num)
+					continue;
 
-try_again:
-	previous = 0;
+				elastic_stats[i].retried += (zbx_uint64_t)retries[i].values_num;
 
-	do
-	{
-		int		fds;
-		CURLMcode	code;
-		char		*error;
-		zbx_curlpage_t	*curl_page;
+				zbx_vector_int32_clear(&queues[i]);
+				zbx_vector_int32_append_array(&queues[i], retries[i].values, retries[i].values_num);
+				zbx_vector_int32_clear(&retries[i]);
+				queue_pos[i] = 0;
+				attempts[i]++;
+				retry = 1;
+			}
+
+			if (0 == retry)
+				break;
+
+			sleep(ZBX_HISTORY_STORAGE_DOWN / 1000);
+			continue;
+		}
 
-		if (CURLM_OK != (code = curl_multi_perform(writer.handle, &running)))
+		if (CURLM_OK != (code = curl_multi_perform(writer.handle, &fds)))
 		{
 			zabbix_log(LOG_LEVEL_ERR, "cannot perform on curl multi handle: %s", curl_multi_strerror(code));
 			break;
@@ -497,104 +793,49 @@ try_again:
 			break;
 		}
 
-		if (previous == running)
-			continue;
-
 		while (NULL != (msg = curl_multi_info_read(writer.handle, &msgnum)))
 		{
-			/* If the error is due to malformed data, there is no sense on re-trying to send. */
-			/* That's why we actually check for transport and curl errors separately */
-			if (CURLE_HTTP_RETURNED_ERROR == msg->data.result)
-			{
-				if (CURLE_OK == curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE,
-						(char **)&curl_page) && '\0' != *curl_page->errbuf)
-				{
-					zabbix_log(LOG_LEVEL_ERR, "cannot send data to elasticsearch, HTTP error"
-							" message: %s", curl_page->errbuf);
-				}
-				else
-				{
-					char		http_status[MAX_STRING_LEN];
-					long int	response_code;
-
-					if (CURLE_OK == curl_easy_getinfo(msg->easy_handle,
-							CURLINFO_RESPONSE_CODE, &response_code))
-					{
-						zbx_snprintf(http_status, sizeof(http_status), "HTTP status code: %ld",
-								response_code);
-					}
-					else
-					{
-						zbx_strlcpy(http_status, "unknown HTTP status code",
-								sizeof(http_status));
-					}
-
-					zabbix_log(LOG_LEVEL_ERR, "cannot send data to elasticsearch, %s", http_status);
-				}
-			}
-			else if (CURLE_OK != msg->data.result)
-			{
-				if (CURLE_OK == curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE,
-						(char **)&curl_page) && '\0' != *curl_page->errbuf)
-				{
-					zabbix_log(LOG_LEVEL_WARNING, "cannot send data to elasticsearch: %s",
-							curl_page->errbuf);
-				}
-				else
-				{
-					zabbix_log(LOG_LEVEL_WARNING, "cannot send data to elasticsearch: %s",
-							curl_easy_strerror(msg->data.result));
-				}
+			zbx_elastic_request_t	*req;
 
-				/* If the error is due to curl internal problems or unrelated */
-				/* problems with HTTP, we put the handle in a retry list and */
-				/* remove it from the current execution loop */
-				zbx_vector_ptr_append(&retries, msg->easy_handle);
-				curl_multi_remove_handle(writer.handle, msg->easy_handle);
-			}
-			else if (CURLE_OK == curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, (char **)&curl_page)
-					&& SUCCEED == elastic_is_error_present(&curl_page->page, &error))
+			if (CURLMSG_DONE != msg->msg || CURLE_OK != curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE,
+					(char **)&req))
 			{
-				zabbix_log(LOG_LEVEL_WARNING, "%s() cannot send data to elasticsearch: %s",
-						__func__, error);
-				zbx_free(error);
-
-				/* If the error is due to elastic internal problems (for example an index */
-				/* became read-only), we put the handle in a retry list and */
-				/* remove it from the current execution loop */
-				zbx_vector_ptr_append(&retries, msg->easy_handle);
-				curl_multi_remove_handle(writer.handle, msg->easy_handle);
+				continue;
 			}
-		}
 
-		previous = running;
+			elastic_request_complete(req, msg->data.result, &retries[req->hist->value_type]);
+
+			requests[req->hist->value_type]--;
+
+			if (FAIL != (i = zbx_vector_ptr_search(&active, req, ZBX_DEFAULT_PTR_COMPARE_FUNC)))
+				zbx_vector_ptr_remove_noorder(&active, i);
+
+			elastic_request_free(req);
+		}
 	}
-	while (running);
 
-	/* We check if we have handles to retry. If yes, we put them back in the multi */
-	/* handle and go to the beginning of the do while() for try sending the data again */
-	/* after sleeping for ZBX_HISTORY_STORAGE_DOWN / 1000 (seconds) */
-	if (0 < retries.values_num)
-	{
-		for (i = 0; i < retries.values_num; i++)
-			curl_multi_add_handle(writer.handle, retries.values[i]);
+	elastic_stats_log();
+
+	/* requests left after curl multi handle failure */
+	for (i = 0; i < active.values_num; i++)
+		elastic_request_free((zbx_elastic_request_t *)active.values[i]);
 
-		zbx_vector_ptr_clear(&retries);
+	zbx_vector_ptr_destroy(&active);
 
-		sleep(ZBX_HISTORY_STORAGE_DOWN / 1000);
-		goto try_again;
+	for (i = 0; i <= ITEM_VALUE_TYPE_BIN; i++)
+	{
+		zbx_vector_int32_destroy(&queues[i]);
+		zbx_vector_int32_destroy(&retries[i]);
 	}
-clean:
-	curl_slist_free_all(curl_headers);
 
-	zbx_vector_ptr_destroy(&retries);
+	curl_slist_free_all(headers[0]);
+	curl_slist_free_all(headers[1]);
 
 	elastic_writer_release();
-
 end:
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 
-	return ret;
+	return SUCCEED;
 }
 
 /******************************************************************************************************************
@@ -616,6 +857,7 @@ static void	elastic_destroy(zbx_history_iface_t *hist)
 
 	elastic_close(hist);
 
+	zbx_vector_uint64_destroy(&data->docs);
 	zbx_free(data->base_url);
 	zbx_free(data);
 }
@@ -1023,7 +1265,6 @@ static int	elastic_add_values(zbx_history_iface_t *hist, const zbx_vector_dc_his
 	int			i, num = 0;
 	zbx_dc_history_t	*h;
 	struct zbx_json		json_idx, json;
-	size_t			buf_alloc = 0, buf_offset = 0;
 	char			pipeline[14]; /* index name length + suffix "-pipeline" */
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
@@ -1073,7 +1314,9 @@ static int	elastic_add_values(zbx_history_iface_t *hist, const zbx_vector_dc_his
 
 		zbx_json_close(&json);
 
-		zbx_snprintf_alloc(&data->buf, &buf_alloc, &buf_offset, "%s\n%s\n", json_idx.buffer, json.buffer);
+		zbx_vector_uint64_append(&data->docs, (zbx_uint64_t)data->buf_offset);
+		zbx_snprintf_alloc(&data->buf, &data->buf_alloc, &data->buf_offset, "%s\n%s\n", json_idx.buffer,
+				json.buffer);
 
 		zbx_json_free(&json);
 
@@ -1143,8 +1386,11 @@ int	zbx_history_elastic_init(zbx_history_iface_t *hist, unsigned char value_type
 	data->base_url = zbx_strdup(NULL, config_history_storage_url);
 	zbx_rtrim(data->base_url, "/");
 	data->buf = NULL;
+	data->buf_alloc = 0;
+	data->buf_offset = 0;
 	data->post_url = NULL;
 	data->handle = NULL;
+	zbx_vector_uint64_create(&data->docs);
 
 	hist->value_type = value_type;
 	hist->data.elastic_data = data;
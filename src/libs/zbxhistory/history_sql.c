@@ -22,6 +22,7 @@
 #include "zbxstr.h"
 #include "zbxtime.h"
 #include "zbxvariant.h"
+#include "zbxthreads.h"
 
 typedef struct
 {
@@ -32,6 +33,48 @@ zbx_sql_writer_t;
 
 static zbx_sql_writer_t	writer;
 
+/* history writer thread - writes handed over history batches with its own database connection */
+typedef struct
+{
+	/* the bulk insert data of the batch to write */
+	zbx_vector_ptr_t	dbinserts;
+	/* 1 - the batch is being written, 0 - the writer is idle */
+	int			pending;
+	zbx_dbconn_t		*db;
+	pthread_t		thread;
+}
+zbx_sql_thread_writer_t;
+
+/* asynchronous writer - history syncer hands every batch over to an idle writer thread, which writes */
+/* all history tables of the batch in a single transaction, and continues without waiting for it     */
+typedef struct
+{
+	/* number of writer threads, 0 - history is written by history syncer only */
+	int			writers_num;
+	int			started;
+	int			stop;
+	/* number of history values the writer threads failed to write */
+	zbx_uint64_t		values_lost;
+	zbx_sql_thread_writer_t	*writers;
+	pthread_mutex_t		lock;
+	pthread_cond_t		event;
+}
+zbx_sql_async_writer_t;
+
+static zbx_sql_async_writer_t	async_writer;
+
+/* history value key, unique in history tables */
+typedef struct
+{
+	zbx_uint64_t	itemid;
+	int		clock;
+	int		ns;
+}
+zbx_sql_history_key_t;
+
+ZBX_VECTOR_DECL(sql_history_key, zbx_sql_history_key_t)
+ZBX_VECTOR_IMPL(sql_history_key, zbx_sql_history_key_t)
+
 typedef void (*vc_str2value_func_t)(zbx_history_value_t *value, zbx_db_row_t row);
 
 /* history table data */
@@ -110,22 +153,31 @@ static void	sql_writer_init(void)
 
 /************************************************************************************
  *                                                                                  *
- * Purpose: releases initialized sql writer by freeing allocated resources and      *
- *          setting its state to uninitialized.                                     *
+ * Purpose: frees bulk insert data                                                  *
  *                                                                                  *
  ************************************************************************************/
-static void	sql_writer_release(void)
+static void	sql_writer_clear_dbinserts(zbx_vector_ptr_t *dbinserts)
 {
-	int	i;
-
-	for (i = 0; i < writer.dbinserts.values_num; i++)
+	for (int i = 0; i < dbinserts->values_num; i++)
 	{
-		zbx_db_insert_t	*db_insert = (zbx_db_insert_t *)writer.dbinserts.values[i];
+		zbx_db_insert_t	*db_insert = (zbx_db_insert_t *)dbinserts->values[i];
 
 		zbx_db_insert_clean(db_insert);
 		zbx_free(db_insert);
 	}
-	zbx_vector_ptr_clear(&writer.dbinserts);
+
+	zbx_vector_ptr_clear(dbinserts);
+}
+
+/************************************************************************************
+ *                                                                                  *
+ * Purpose: releases initialized sql writer by freeing allocated resources and      *
+ *          setting its state to uninitialized.                                     *
+ *                                                                                  *
+ ************************************************************************************/
+static void	sql_writer_release(void)
+{
+	sql_writer_clear_dbinserts(&writer.dbinserts);
 	zbx_vector_ptr_destroy(&writer.dbinserts);
 
 	writer.initialized = 0;
@@ -144,45 +196,424 @@ static void	sql_writer_add_dbinsert(zbx_db_insert_t *db_insert)
 	zbx_vector_ptr_append(&writer.dbinserts, db_insert);
 }
 
+static int	sql_history_key_compare(const void *d1, const void *d2)
+{
+	const zbx_sql_history_key_t	*k1 = (const zbx_sql_history_key_t *)d1;
+	const zbx_sql_history_key_t	*k2 = (const zbx_sql_history_key_t *)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(k1->itemid, k2->itemid);
+	ZBX_RETURN_IF_NOT_EQUAL(k1->clock, k2->clock);
+	ZBX_RETURN_IF_NOT_EQUAL(k1->ns, k2->ns);
+
+	return 0;
+}
+
 /************************************************************************************
  *                                                                                  *
- * Purpose: flushes bulk insert data into database                                  *
+ * Purpose: removes values already stored in history tables from bulk insert data   *
+ *                                                                                  *
+ * Parameters: db        - [IN] database connection                                 *
+ *             dbinserts - [IN/OUT] bulk insert data                                *
+ *                                                                                  *
+ * Return value: number of removed values                                           *
+ *                                                                                  *
+ * Comments: Itemid, clock and ns are the first fields of all history table         *
+ *           inserts.                                                               *
  *                                                                                  *
  ************************************************************************************/
-static int	sql_writer_flush(void)
+static int	sql_thread_writer_remove_duplicates(zbx_dbconn_t *db, zbx_vector_ptr_t *dbinserts)
 {
-	int	i, txn_error;
+	zbx_vector_sql_history_key_t	keys;
+	int				removed = 0;
 
-	/* The writer might be uninitialized only if the history */
-	/* was already flushed. In that case, return SUCCEED */
-	if (0 == writer.initialized)
-		return SUCCEED;
+	zbx_vector_sql_history_key_create(&keys);
+
+	for (int i = 0; i < dbinserts->values_num; i++)
+	{
+		zbx_db_insert_t	*db_insert = (zbx_db_insert_t *)dbinserts->values[i];
+		zbx_db_result_t	result;
+		zbx_db_row_t	row;
+		char		*sql = NULL;
+		size_t		sql_alloc = 0, sql_offset = 0;
+		const char	*separator = "";
+
+		if (0 == db_insert->rows.values_num)
+			continue;
+
+		zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, "select itemid,clock,ns from %s where",
+				db_insert->table->table);
+
+		for (int j = 0; j < db_insert->rows.values_num; j++)
+		{
+			const zbx_db_value_t	*values = db_insert->rows.values[j];
+
+			zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, "%s (itemid=" ZBX_FS_UI64 " and clock=%d"
+					" and ns=%d)", separator, values[0].ui64, values[1].i32, values[2].i32);
+			separator = " or";
+		}
+
+		result = zbx_dbconn_select(db, "%s", sql);
+		zbx_free(sql);
+
+		while (NULL != (row = zbx_db_fetch(result)))
+		{
+			zbx_sql_history_key_t	key;
+
+			ZBX_STR2UINT64(key.itemid, row[0]);
+			key.clock = atoi(row[1]);
+			key.ns = atoi(row[2]);
+
+			zbx_vector_sql_history_key_append(&keys, key);
+		}
+		zbx_db_free_result(result);
+
+		zbx_vector_sql_history_key_sort(&keys, sql_history_key_compare);
+
+		/* rows are removed by moving the last row in place, so iterate from the end */
+		for (int j = db_insert->rows.values_num - 1; 0 <= j; j--)
+		{
+			const zbx_db_value_t	*values = db_insert->rows.values[j];
+			zbx_sql_history_key_t	key = {.itemid = values[0].ui64, .clock = values[1].i32,
+							.ns = values[2].i32};
+
+			if (FAIL != zbx_vector_sql_history_key_bsearch(&keys, key, sql_history_key_compare))
+			{
+				zbx_db_insert_remove_row(db_insert, j);
+				removed++;
+			}
+		}
+
+		zbx_vector_sql_history_key_clear(&keys);
+	}
+
+	zbx_vector_sql_history_key_destroy(&keys);
+
+	return removed;
+}
+
+/************************************************************************************
+ *                                                                                  *
+ * Purpose: writes history batch into database in a single transaction              *
+ *                                                                                  *
+ * Parameters: db        - [IN] database connection                                 *
+ *             dbinserts - [IN/OUT] bulk insert data                                *
+ *                                                                                  *
+ * Return value: number of values that were not written                             *
+ *                                                                                  *
+ * Comments: If the batch is rejected because of duplicate values, the values       *
+ *           already stored in database are removed and the batch is written again. *
+ *           Other errors are only logged, as there is nobody waiting for result.   *
+ *                                                                                  *
+ ************************************************************************************/
+static int	sql_thread_writer_write(zbx_dbconn_t *db, zbx_vector_ptr_t *dbinserts)
+{
+	int	txn_error, removed = 0, values_num = 0;
+
+	for (;;)
+	{
+		do
+		{
+			zbx_dbconn_begin(db);
+
+			for (int i = 0; i < dbinserts->values_num; i++)
+			{
+				zbx_db_insert_t	*db_insert = (zbx_db_insert_t *)dbinserts->values[i];
+
+				zbx_db_insert_execute(db_insert);
+			}
+		}
+		while (ZBX_DB_DOWN == (txn_error = zbx_dbconn_commit(db)));
+
+		if (ZBX_DB_OK == txn_error)
+			return 0;
+
+		/* duplicates are removed only once, repeated rejection is caused by something else */
+		if (0 != removed || ERR_Z3008 != zbx_dbconn_last_errcode(db) ||
+				0 == (removed = sql_thread_writer_remove_duplicates(db, dbinserts)))
+		{
+			break;
+		}
+
+		zabbix_log(LOG_LEVEL_WARNING, "skipped %d duplicates", removed);
+	}
+
+	for (int i = 0; i < dbinserts->values_num; i++)
+		values_num += zbx_db_insert_get_row_count((zbx_db_insert_t *)dbinserts->values[i]);
+
+	zabbix_log(LOG_LEVEL_ERR, "cannot write %d history values: %s", values_num, zbx_dbconn_last_strerr(db));
+
+	return values_num;
+}
+
+/************************************************************************************
+ *                                                                                  *
+ * Purpose: history writer thread entry point                                       *
+ *                                                                                  *
+ ************************************************************************************/
+static void	*sql_thread_writer_entry(void *args)
+{
+	zbx_sql_thread_writer_t	*thread_writer = (zbx_sql_thread_writer_t *)args;
+	sigset_t		mask;
+	int			err;
+
+	sigemptyset(&mask);
+	sigaddset(&mask, SIGTERM);
+	sigaddset(&mask, SIGUSR1);
+	sigaddset(&mask, SIGUSR2);
+	sigaddset(&mask, SIGHUP);
+	sigaddset(&mask, SIGQUIT);
+	sigaddset(&mask, SIGINT);
+
+	if (0 != (err = pthread_sigmask(SIG_BLOCK, &mask, NULL)))
+		zabbix_log(LOG_LEVEL_WARNING, "cannot block signals: %s", zbx_strerror(err));
+
+	zbx_dbconn_open(thread_writer->db);
+
+	pthread_mutex_lock(&async_writer.lock);
+
+	for (;;)
+	{
+		int	values_lost;
+
+		/* the handed over batches are written also when stopping */
+		if (0 == thread_writer->pending)
+		{
+			if (0 != async_writer.stop)
+				break;
+
+			pthread_cond_wait(&async_writer.event, &async_writer.lock);
+			continue;
+		}
+
+		pthread_mutex_unlock(&async_writer.lock);
+
+		values_lost = sql_thread_writer_write(thread_writer->db, &thread_writer->dbinserts);
+		sql_writer_clear_dbinserts(&thread_writer->dbinserts);
+
+		pthread_mutex_lock(&async_writer.lock);
+
+		async_writer.values_lost += (zbx_uint64_t)values_lost;
+		thread_writer->pending = 0;
+		pthread_cond_broadcast(&async_writer.event);
+	}
+
+	pthread_mutex_unlock(&async_writer.lock);
+
+	zbx_dbconn_close(thread_writer->db);
+	zbx_db_thread_deinit();
+
+	return NULL;
+}
+
+/************************************************************************************
+ *                                                                                  *
+ * Purpose: stops history writer threads and releases their resources               *
+ *                                                                                  *
+ * Parameters: writers_num - [IN] number of started writer threads                  *
+ *                                                                                  *
+ * Comments: The batches already handed over are written before threads exit.       *
+ *                                                                                  *
+ ************************************************************************************/
+static void	sql_async_writer_stop(int writers_num)
+{
+	pthread_mutex_lock(&async_writer.lock);
+	async_writer.stop = 1;
+	pthread_cond_broadcast(&async_writer.event);
+	pthread_mutex_unlock(&async_writer.lock);
+
+	for (int i = 0; i < async_writer.writers_num; i++)
+	{
+		zbx_sql_thread_writer_t	*thread_writer = &async_writer.writers[i];
+
+		if (i < writers_num)
+			pthread_join(thread_writer->thread, NULL);
+
+		zbx_vector_ptr_destroy(&thread_writer->dbinserts);
+		zbx_dbconn_free(thread_writer->db);
+	}
+
+	pthread_cond_destroy(&async_writer.event);
+	pthread_mutex_destroy(&async_writer.lock);
+	zbx_free(async_writer.writers);
+
+	if (0 != async_writer.values_lost)
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "history writers failed to write " ZBX_FS_UI64 " values",
+				async_writer.values_lost);
+	}
+
+	async_writer.started = 0;
+	async_writer.stop = 0;
+}
+
+/************************************************************************************
+ *                                                                                  *
+ * Purpose: starts history writer threads                                           *
+ *                                                                                  *
+ * Return value: SUCCEED - the writer threads were started                          *
+ *               FAIL    - otherwise                                                *
+ *                                                                                  *
+ ************************************************************************************/
+static int	sql_async_writer_start(void)
+{
+	int	i, err = 0;
+
+	async_writer.writers = (zbx_sql_thread_writer_t *)zbx_calloc(NULL, (size_t)async_writer.writers_num,
+			sizeof(zbx_sql_thread_writer_t));
+
+	pthread_mutex_init(&async_writer.lock, NULL);
+	pthread_cond_init(&async_writer.event, NULL);
+
+	for (i = 0; i < async_writer.writers_num; i++)
+	{
+		zbx_sql_thread_writer_t	*thread_writer = &async_writer.writers[i];
+
+		zbx_vector_ptr_create(&thread_writer->dbinserts);
+		thread_writer->db = zbx_dbconn_create();
+		(void)zbx_dbconn_set_connect_options(thread_writer->db, ZBX_DB_CONNECT_NORMAL);
+	}
+
+	for (i = 0; i < async_writer.writers_num; i++)
+	{
+		zbx_sql_thread_writer_t	*thread_writer = &async_writer.writers[i];
+		pthread_attr_t		attr;
+
+		zbx_pthread_init_attr(&attr);
+		err = pthread_create(&thread_writer->thread, &attr, sql_thread_writer_entry, thread_writer);
+		pthread_attr_destroy(&attr);
+
+		if (0 != err)
+			break;
+	}
+
+	if (0 != err)
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot create history writer thread: %s, history will be written"
+				" by history syncer only", zbx_strerror(err));
+
+		sql_async_writer_stop(i);
+		async_writer.writers_num = 0;
+
+		return FAIL;
+	}
+
+	async_writer.started = 1;
+
+	return SUCCEED;
+}
+
+/************************************************************************************
+ *                                                                                  *
+ * Purpose: hands bulk insert data of the batch over to an idle writer thread       *
+ *                                                                                  *
+ * Parameters: dbinserts - [IN/OUT] bulk insert data, moved to the writer thread    *
+ *                                                                                  *
+ * Comments: If all writer threads are busy, waits until one of them finishes.      *
+ *                                                                                  *
+ ************************************************************************************/
+static void	sql_async_writer_handover(zbx_vector_ptr_t *dbinserts)
+{
+	zbx_sql_thread_writer_t	*thread_writer = NULL;
+
+	pthread_mutex_lock(&async_writer.lock);
+
+	for (;;)
+	{
+		for (int i = 0; i < async_writer.writers_num; i++)
+		{
+			if (0 == async_writer.writers[i].pending)
+			{
+				thread_writer = &async_writer.writers[i];
+				break;
+			}
+		}
+
+		if (NULL != thread_writer)
+			break;
+
+		pthread_cond_wait(&async_writer.event, &async_writer.lock);
+	}
+
+	for (int i = 0; i < dbinserts->values_num; i++)
+		zbx_db_insert_set_dbconn((zbx_db_insert_t *)dbinserts->values[i], thread_writer->db);
+
+	zbx_vector_ptr_append_array(&thread_writer->dbinserts, dbinserts->values, dbinserts->values_num);
+	zbx_vector_ptr_clear(dbinserts);
+
+	thread_writer->pending = 1;
+	pthread_cond_broadcast(&async_writer.event);
+
+	pthread_mutex_unlock(&async_writer.lock);
+}
+
+/************************************************************************************
+ *                                                                                  *
+ * Purpose: writes bulk insert data with history syncer database connection         *
+ *                                                                                  *
+ * Parameters: dbinserts - [IN] bulk insert data                                    *
+ *             errcode   - [OUT] error code if the transaction failed               *
+ *                                                                                  *
+ * Return value: ZBX_DB_OK   - the data was written                                 *
+ *               ZBX_DB_FAIL - otherwise                                            *
+ *                                                                                  *
+ ************************************************************************************/
+static int	sql_writer_write(zbx_vector_ptr_t *dbinserts, zbx_err_codes_t *errcode)
+{
+	int	txn_error;
 
 	do
 	{
 		zbx_db_begin();
 
-		for (i = 0; i < writer.dbinserts.values_num; i++)
+		for (int i = 0; i < dbinserts->values_num; i++)
 		{
-			zbx_db_insert_t	*db_insert = (zbx_db_insert_t *)writer.dbinserts.values[i];
+			zbx_db_insert_t	*db_insert = (zbx_db_insert_t *)dbinserts->values[i];
 			zbx_db_insert_execute(db_insert);
 		}
 	}
 	while (ZBX_DB_DOWN == (txn_error = zbx_db_commit()));
 
-	sql_writer_release();
+	if (ZBX_DB_OK != txn_error)
+		*errcode = zbx_db_last_errcode();
 
-	if (ZBX_DB_OK == txn_error)
+	return txn_error;
+}
+
+/************************************************************************************
+ *                                                                                  *
+ * Purpose: flushes bulk insert data into database                                  *
+ *                                                                                  *
+ * Comments: With history writer threads started the whole batch is handed over     *
+ *           to a writer thread and the function returns without waiting for it     *
+ *           to be written. Otherwise the batch is written by history syncer and    *
+ *           rejected duplicates are reported to the caller to be removed.          *
+ *                                                                                  *
+ ************************************************************************************/
+static int	sql_writer_flush(void)
+{
+	int		txn_error, ret = FLUSH_SUCCEED;
+	zbx_err_codes_t	errcode = 0;
+
+	/* The writer might be uninitialized only if the history */
+	/* was already flushed. In that case, return SUCCEED */
+	if (0 == writer.initialized)
+		return SUCCEED;
+
+	if (0 != async_writer.writers_num && (0 != async_writer.started || SUCCEED == sql_async_writer_start()))
 	{
-		return FLUSH_SUCCEED;
+		sql_async_writer_handover(&writer.dbinserts);
 	}
-	else
+	else if (ZBX_DB_OK != (txn_error = sql_writer_write(&writer.dbinserts, &errcode)))
 	{
-		if (ZBX_DB_FAIL == txn_error && ERR_Z3008 == zbx_db_last_errcode())
-			return FLUSH_DUPL_REJECTED;
-
-		return FLUSH_FAIL;
+		if (ZBX_DB_FAIL == txn_error && ERR_Z3008 == errcode)
+			ret = FLUSH_DUPL_REJECTED;
+		else
+			ret = FLUSH_FAIL;
 	}
+
+	sql_writer_release();
+
+	return ret;
 }
 
 /******************************************************************************************************************
@@ -196,6 +627,7 @@ static void	add_history_dbl(const zbx_vector_dc_history_ptr_t *history)
 	zbx_db_insert_t	*db_insert = (zbx_db_insert_t *)zbx_malloc(NULL, sizeof(zbx_db_insert_t));
 
 	zbx_db_insert_prepare(db_insert, "history", "itemid", "clock", "ns", "value", (char *)NULL);
+	zbx_db_insert_set_bulk_load(db_insert);
 
 	for (int i = 0; i < history->values_num; i++)
 	{
@@ -215,6 +647,7 @@ static void	add_history_uint(const zbx_vector_dc_history_ptr_t *history)
 	zbx_db_insert_t	*db_insert = (zbx_db_insert_t *)zbx_malloc(NULL, sizeof(zbx_db_insert_t));
 
 	zbx_db_insert_prepare(db_insert, "history_uint", "itemid", "clock", "ns", "value", (char *)NULL);
+	zbx_db_insert_set_bulk_load(db_insert);
 
 	for (int i = 0; i < history->values_num; i++)
 	{
@@ -234,6 +667,7 @@ static void	add_history_str(const zbx_vector_dc_history_ptr_t *history)
 	zbx_db_insert_t	*db_insert = (zbx_db_insert_t *)zbx_malloc(NULL, sizeof(zbx_db_insert_t));
 
 	zbx_db_insert_prepare(db_insert, "history_str", "itemid", "clock", "ns", "value", (char *)NULL);
+	zbx_db_insert_set_bulk_load(db_insert);
 
 	for (int i = 0; i < history->values_num; i++)
 	{
@@ -253,6 +687,7 @@ static void	add_history_text(const zbx_vector_dc_history_ptr_t *history)
 	zbx_db_insert_t	*db_insert = (zbx_db_insert_t *)zbx_malloc(NULL, sizeof(zbx_db_insert_t));
 
 	zbx_db_insert_prepare(db_insert, "history_text", "itemid", "clock", "ns", "value", (char *)NULL);
+	zbx_db_insert_set_bulk_load(db_insert);
 
 	for (int i = 0; i < history->values_num; i++)
 	{
@@ -273,6 +708,7 @@ static void	add_history_log(const zbx_vector_dc_history_ptr_t *history)
 
 	zbx_db_insert_prepare(db_insert, "history_log", "itemid", "clock", "ns", "timestamp", "source", "severity",
 			"value", "logeventid", (char *)NULL);
+	zbx_db_insert_set_bulk_load(db_insert);
 
 	for (int i = 0; i < history->values_num; i++)
 	{
@@ -296,6 +732,7 @@ static void	add_history_bin(const zbx_vector_dc_history_ptr_t *history)
 	zbx_db_insert_t	*db_insert = (zbx_db_insert_t *)zbx_malloc(NULL, sizeof(zbx_db_insert_t));
 
 	zbx_db_insert_prepare(db_insert, "history_bin", "itemid", "clock", "ns", "value", (char *)NULL);
+	zbx_db_insert_set_bulk_load(db_insert);
 
 	for (int i = 0; i < history->values_num; i++)
 	{
@@ -613,6 +1050,9 @@ out:
 static void	sql_destroy(zbx_history_iface_t *hist)
 {
 	ZBX_UNUSED(hist);
+
+	if (0 != async_writer.started)
+		sql_async_writer_stop(async_writer.writers_num);
 }
 
 /************************************************************************************
@@ -694,6 +1134,19 @@ static int	sql_flush(zbx_history_iface_t *hist)
 	return sql_writer_flush();
 }
 
+/************************************************************************************
+ *                                                                                  *
+ * Purpose: sets the number of history writer threads                               *
+ *                                                                                  *
+ * Parameters:  writers_num - [IN] the number of writer threads, 0 - history is     *
+ *                                 written by history syncer only                   *
+ *                                                                                  *
+ ************************************************************************************/
+void	zbx_history_sql_set_writers_num(int writers_num)
+{
+	async_writer.writers_num = writers_num;
+}
+
 /************************************************************************************
  *                                                                                  *
  * Purpose: initializes history storage interface                                   *
@@ -0,0 +1,1501 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxhistory.h"
+#include "history.h"
+
+#include "zbxalgo.h"
+#include "zbxcacheconfig.h"
+#include "zbxdb.h"
+#include "zbxfile.h"
+#include "zbxnum.h"
+#include "zbxstr.h"
+#include "zbxtime.h"
+
+#include <sys/mman.h>
+
+/* Local history storage layout:                                                       */
+/*                                                                                     */
+/*   <path>/<value type>/<block start>.zts                                             */
+/*                                                                                     */
+/* Values are grouped into daily time blocks. Every block is a segment file which is   */
+/* only appended to. A chunk consists of zbx_tsdb_chunk_t header with value count and  */
+/* min/max/sum summaries followed by the values encoded with delta of delta timestamps */
+/* and xor compressed values (see Gorilla time series database).                       */
+/*                                                                                     */
+/* Values are buffered per item and written as a single chunk when the buffer is full, */
+/* when its oldest value was buffered ZBX_TSDB_CHUNK_DELAY ago or when it contains     */
+/* values of a previous time block. Each flush appends all chunks of a block with a    */
+/* single write under exclusive file lock, so concurrent writers do not interleave.    */
+/*                                                                                     */
+/* Every process keeps an in-memory index of chunk positions by item. The index of a   */
+/* block is updated on read from the already indexed file size, so only headers of     */
+/* chunks appended since the last read are scanned. Only ZBX_TSDB_INDEXED_BLOCKS_MAX   */
+/* most recently read blocks are kept indexed.                                         */
+
+#define ZBX_TSDB_BLOCK_PERIOD		SEC_PER_DAY
+#define ZBX_TSDB_CHUNK_MAGIC		0x3353545a	/* "ZTS3" */
+#define ZBX_TSDB_FILE_EXT		".zts"
+#define ZBX_TSDB_HOUSEKEEPING_PERIOD	SEC_PER_HOUR
+#define ZBX_TSDB_BLOCKS_REFRESH_PERIOD	SEC_PER_MIN
+#define ZBX_TSDB_CHUNK_VALUES_MAX	1000
+#define ZBX_TSDB_CHUNK_DELAY		(5 * SEC_PER_MIN)
+#define ZBX_TSDB_INDEXED_BLOCKS_MAX	3
+
+typedef struct
+{
+	zbx_uint32_t	magic;
+	zbx_uint32_t	value_type;
+	zbx_uint64_t	itemid;
+	zbx_uint32_t	size;		/* encoded data size in bytes */
+	zbx_uint32_t	count;		/* number of values in chunk */
+	int		first;		/* timestamp of the first value */
+	int		last;		/* timestamp of the last value */
+	zbx_uint64_t	min;		/* minimum value (double bits for float values) */
+	zbx_uint64_t	max;		/* maximum value (double bits for float values) */
+	double		sum;
+}
+zbx_tsdb_chunk_t;
+
+/* position of indexed chunk data in segment file */
+typedef struct
+{
+	zbx_uint64_t	offset;
+	zbx_uint32_t	size;
+	zbx_uint32_t	count;
+	int		first;
+	int		last;
+}
+zbx_tsdb_chunk_ref_t;
+
+ZBX_VECTOR_DECL(tsdb_chunk_ref, zbx_tsdb_chunk_ref_t)
+ZBX_VECTOR_IMPL(tsdb_chunk_ref, zbx_tsdb_chunk_ref_t)
+
+typedef struct
+{
+	zbx_uint64_t			itemid;
+	zbx_vector_tsdb_chunk_ref_t	chunks;
+}
+zbx_tsdb_item_t;
+
+typedef struct
+{
+	int		start;
+	int		fd;		/* file descriptor for reading, -1 if not opened */
+	zbx_uint64_t	indexed;	/* size of indexed part of segment file */
+	time_t		lastaccess;	/* last time the block was read */
+	zbx_hashset_t	items;
+}
+zbx_tsdb_block_t;
+
+ZBX_PTR_VECTOR_DECL(tsdb_block_ptr, zbx_tsdb_block_t *)
+ZBX_PTR_VECTOR_IMPL(tsdb_block_ptr, zbx_tsdb_block_t *)
+
+/* values of an item not yet written to segment files */
+typedef struct
+{
+	zbx_uint64_t			itemid;
+	time_t				created;	/* time the oldest buffered value was added */
+	int				first;		/* timestamp of the oldest buffered value */
+	zbx_vector_history_record_t	values;
+}
+zbx_tsdb_pending_t;
+
+/* chunks to be appended to a time block segment file */
+typedef struct
+{
+	int	start;
+	char	*buf;
+	size_t	buf_alloc;
+	size_t	buf_offset;
+}
+zbx_tsdb_write_t;
+
+ZBX_VECTOR_DECL(tsdb_write, zbx_tsdb_write_t)
+ZBX_VECTOR_IMPL(tsdb_write, zbx_tsdb_write_t)
+
+typedef struct
+{
+	char				*dir;
+	zbx_hashset_t			pending;
+	zbx_vector_tsdb_block_ptr_t	blocks;		/* known blocks in descending order */
+	time_t				blocks_time;	/* last time blocks were listed */
+	time_t				housekeeping_time;
+}
+zbx_tsdb_data_t;
+
+typedef struct
+{
+	unsigned char	*data;
+	size_t		alloc;
+	size_t		bits;
+}
+zbx_tsdb_bits_t;
+
+typedef struct
+{
+	int		sec;
+	int		delta;
+	int		ns;
+	zbx_uint64_t	value;
+	int		leading;
+	int		trailing;
+}
+zbx_tsdb_codec_t;
+
+/******************************************************************************************************************
+ *                                                                                                                *
+ * value encoding                                                                                                 *
+ *                                                                                                                *
+ ******************************************************************************************************************/
+
+static void	tsdb_bits_write(zbx_tsdb_bits_t *bs, zbx_uint64_t value, int nbits)
+{
+	while (0 < nbits--)
+	{
+		size_t	byte = bs->bits >> 3;
+
+		if (byte >= bs->alloc)
+		{
+			size_t	alloc = bs->alloc;
+
+			bs->alloc = (0 == alloc ? 256 : alloc * 2);
+			bs->data = (unsigned char *)zbx_realloc(bs->data, bs->alloc);
+			memset(bs->data + alloc, 0, bs->alloc - alloc);
+		}
+
+		if (0 != ((value >> nbits) & 1))
+			bs->data[byte] |= (unsigned char)(0x80 >> (bs->bits & 7));
+
+		bs->bits++;
+	}
+}
+
+static int	tsdb_bits_read(const unsigned char *data, size_t size, size_t *pos, int nbits, zbx_uint64_t *value)
+{
+	if (*pos + (size_t)nbits > size * 8)
+		return FAIL;
+
+	*value = 0;
+
+	while (0 < nbits--)
+	{
+		*value = (*value << 1) | ((data[*pos >> 3] >> (7 - (*pos & 7))) & 1);
+		(*pos)++;
+	}
+
+	return SUCCEED;
+}
+
+static int	tsdb_leading_zeros(zbx_uint64_t value)
+{
+	int	n = 0;
+
+	while (0 == (value & __UINT64_C(0x8000000000000000)))
+	{
+		value <<= 1;
+		n++;
+	}
+
+	return n;
+}
+
+static int	tsdb_trailing_zeros(zbx_uint64_t value)
+{
+	int	n = 0;
+
+	while (0 == (value & 1))
+	{
+		value >>= 1;
+		n++;
+	}
+
+	return n;
+}
+
+static zbx_uint64_t	tsdb_value2bits(const zbx_history_value_t *value, unsigned char value_type)
+{
+	zbx_uint64_t	bits;
+
+	if (ITEM_VALUE_TYPE_UINT64 == value_type)
+		return value->ui64;
+
+	memcpy(&bits, &value->dbl, sizeof(bits));
+
+	return bits;
+}
+
+static void	tsdb_bits2value(zbx_uint64_t bits, unsigned char value_type, zbx_history_value_t *value)
+{
+	if (ITEM_VALUE_TYPE_UINT64 == value_type)
+		value->ui64 = bits;
+	else
+		memcpy(&value->dbl, &bits, sizeof(bits));
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: encodes value timestamp and value into bit stream                 *
+ *                                                                            *
+ * Comments: The first value is stored as is. Following timestamps are        *
+ *           stored as delta of delta seconds and nanoseconds only if they    *
+ *           differ from previous value. Values are xor'ed with the previous  *
+ *           value and only the meaningful bits are stored.                   *
+ *                                                                            *
+ ******************************************************************************/
+static void	tsdb_encode(zbx_tsdb_bits_t *bs, zbx_tsdb_codec_t *codec, const zbx_timespec_t *ts,
+		zbx_uint64_t value, int first)
+{
+	zbx_uint64_t	xor;
+	int		dod, leading, trailing;
+
+	if (0 != first)
+	{
+		tsdb_bits_write(bs, (zbx_uint32_t)ts->sec, 32);
+		tsdb_bits_write(bs, (zbx_uint64_t)ts->ns, 30);
+		tsdb_bits_write(bs, value, 64);
+
+		codec->sec = ts->sec;
+		codec->delta = 0;
+		codec->ns = ts->ns;
+		codec->value = value;
+		codec->leading = -1;
+		codec->trailing = 0;
+
+		return;
+	}
+
+	dod = (ts->sec - codec->sec) - codec->delta;
+
+	if (0 == dod)
+	{
+		tsdb_bits_write(bs, 0, 1);
+	}
+	else if (-63 <= dod && dod <= 64)
+	{
+		tsdb_bits_write(bs, 2, 2);
+		tsdb_bits_write(bs, (zbx_uint64_t)(dod + 63), 7);
+	}
+	else if (-255 <= dod && dod <= 256)
+	{
+		tsdb_bits_write(bs, 6, 3);
+		tsdb_bits_write(bs, (zbx_uint64_t)(dod + 255), 9);
+	}
+	else if (-2047 <= dod && dod <= 2048)
+	{
+		tsdb_bits_write(bs, 14, 4);
+		tsdb_bits_write(bs, (zbx_uint64_t)(dod + 2047), 12);
+	}
+	else
+	{
+		tsdb_bits_write(bs, 15, 4);
+		tsdb_bits_write(bs, (zbx_uint32_t)dod, 32);
+	}
+
+	codec->delta = ts->sec - codec->sec;
+	codec->sec = ts->sec;
+
+	if (ts->ns == codec->ns)
+	{
+		tsdb_bits_write(bs, 0, 1);
+	}
+	else
+	{
+		tsdb_bits_write(bs, 1, 1);
+		tsdb_bits_write(bs, (zbx_uint64_t)ts->ns, 30);
+		codec->ns = ts->ns;
+	}
+
+	if (0 == (xor = value ^ codec->value))
+	{
+		tsdb_bits_write(bs, 0, 1);
+		return;
+	}
+
+	tsdb_bits_write(bs, 1, 1);
+
+	if (31 < (leading = tsdb_leading_zeros(xor)))
+		leading = 31;
+
+	trailing = tsdb_trailing_zeros(xor);
+
+	if (-1 != codec->leading && leading >= codec->leading && trailing >= codec->trailing)
+	{
+		tsdb_bits_write(bs, 0, 1);
+		tsdb_bits_write(bs, xor >> codec->trailing, 64 - codec->leading - codec->trailing);
+	}
+	else
+	{
+		tsdb_bits_write(bs, 1, 1);
+		tsdb_bits_write(bs, (zbx_uint64_t)leading, 5);
+		tsdb_bits_write(bs, (zbx_uint64_t)(64 - leading - trailing - 1), 6);
+		tsdb_bits_write(bs, xor >> trailing, 64 - leading - trailing);
+
+		codec->leading = leading;
+		codec->trailing = trailing;
+	}
+
+	codec->value = value;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: decodes value encoded by tsdb_encode()                            *
+ *                                                                            *
+ ******************************************************************************/
+static int	tsdb_decode(const unsigned char *data, size_t size, size_t *pos, zbx_tsdb_codec_t *codec,
+		zbx_timespec_t *ts, zbx_uint64_t *value, int first)
+{
+	zbx_uint64_t	bits;
+	int		dod, i, len;
+	const int	dod_bits[] = {7, 9, 12, 32}, dod_bias[] = {63, 255, 2047, 0};
+
+	if (0 != first)
+	{
+		if (FAIL == tsdb_bits_read(data, size, pos, 32, &bits))
+			return FAIL;
+		codec->sec = (int)(zbx_uint32_t)bits;
+
+		if (FAIL == tsdb_bits_read(data, size, pos, 30, &bits))
+			return FAIL;
+		codec->ns = (int)bits;
+
+		if (FAIL == tsdb_bits_read(data, size, pos, 64, &codec->value))
+			return FAIL;
+
+		codec->delta = 0;
+		codec->leading = -1;
+		codec->trailing = 0;
+
+		goto out;
+	}
+
+	/* count the leading '1' bits of delta of delta prefix */
+	for (i = 0; 4 > i; i++)
+	{
+		if (FAIL == tsdb_bits_read(data, size, pos, 1, &bits))
+			return FAIL;
+
+		if (0 == bits)
+			break;
+	}
+
+	if (0 == i)
+	{
+		dod = 0;
+	}
+	else
+	{
+		if (FAIL == tsdb_bits_read(data, size, pos, dod_bits[i - 1], &bits))
+			return FAIL;
+
+		if (4 == i)
+			dod = (int)(zbx_uint32_t)bits;
+		else
+			dod = (int)bits - dod_bias[i - 1];
+	}
+
+	codec->delta += dod;
+	codec->sec += codec->delta;
+
+	if (FAIL == tsdb_bits_read(data, size, pos, 1, &bits))
+		return FAIL;
+
+	if (0 != bits)
+	{
+		if (FAIL == tsdb_bits_read(data, size, pos, 30, &bits))
+			return FAIL;
+
+		codec->ns = (int)bits;
+	}
+
+	if (FAIL == tsdb_bits_read(data, size, pos, 1, &bits))
+		return FAIL;
+
+	if (0 != bits)
+	{
+		if (FAIL == tsdb_bits_read(data, size, pos, 1, &bits))
+			return FAIL;
+
+		if (0 != bits)
+		{
+			if (FAIL == tsdb_bits_read(data, size, pos, 5, &bits))
+				return FAIL;
+			codec->leading = (int)bits;
+
+			if (FAIL == tsdb_bits_read(data, size, pos, 6, &bits))
+				return FAIL;
+			codec->trailing = 64 - codec->leading - (int)bits - 1;
+		}
+		else if (-1 == codec->leading)
+			return FAIL;
+
+		len = 64 - codec->leading - codec->trailing;
+
+		if (0 >= len || FAIL == tsdb_bits_read(data, size, pos, len, &bits))
+			return FAIL;
+
+		codec->value ^= bits << codec->trailing;
+	}
+out:
+	ts->sec = codec->sec;
+	ts->ns = codec->ns;
+	*value = codec->value;
+
+	return SUCCEED;
+}
+
+/******************************************************************************************************************
+ *                                                                                                                *
+ * segment files                                                                                                  *
+ *                                                                                                                *
+ ******************************************************************************************************************/
+
+static int	tsdb_block_start(int clock)
+{
+	return clock - clock % ZBX_TSDB_BLOCK_PERIOD;
+}
+
+static void	tsdb_block_path(const zbx_tsdb_data_t *data, int start, char *path, size_t path_size)
+{
+	zbx_snprintf(path, path_size, "%s/%d" ZBX_TSDB_FILE_EXT, data->dir, start);
+}
+
+static void	tsdb_item_clear(void *d)
+{
+	zbx_tsdb_item_t	*item = (zbx_tsdb_item_t *)d;
+
+	zbx_vector_tsdb_chunk_ref_destroy(&item->chunks);
+}
+
+static zbx_tsdb_block_t	*tsdb_block_create(int start)
+{
+	zbx_tsdb_block_t	*block;
+
+	block = (zbx_tsdb_block_t *)zbx_malloc(NULL, sizeof(zbx_tsdb_block_t));
+	block->start = start;
+	block->fd = -1;
+	block->indexed = 0;
+	block->lastaccess = 0;
+	zbx_hashset_create_ext(&block->items, 0, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC,
+			tsdb_item_clear, ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC,
+			ZBX_DEFAULT_MEM_FREE_FUNC);
+
+	return block;
+}
+
+static int	tsdb_block_compare_lastaccess(const void *d1, const void *d2)
+{
+	const zbx_tsdb_block_t	*b1 = *(const zbx_tsdb_block_t * const *)d1;
+	const zbx_tsdb_block_t	*b2 = *(const zbx_tsdb_block_t * const *)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(b2->lastaccess, b1->lastaccess);
+	ZBX_RETURN_IF_NOT_EQUAL(b2->start, b1->start);
+
+	return 0;
+}
+
+static void	tsdb_block_free(zbx_tsdb_block_t *block)
+{
+	if (-1 != block->fd)
+		close(block->fd);
+
+	zbx_hashset_destroy(&block->items);
+	zbx_free(block);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: releases index of least recently read blocks so that the index   *
+ *          memory does not grow with the number of blocks read               *
+ *                                                                            *
+ ******************************************************************************/
+static void	tsdb_release_indexes(zbx_tsdb_data_t *data)
+{
+	zbx_vector_tsdb_block_ptr_t	indexed;
+
+	zbx_vector_tsdb_block_ptr_create(&indexed);
+
+	for (int i = 0; i < data->blocks.values_num; i++)
+	{
+		if (-1 != data->blocks.values[i]->fd)
+			zbx_vector_tsdb_block_ptr_append(&indexed, data->blocks.values[i]);
+	}
+
+	if (ZBX_TSDB_INDEXED_BLOCKS_MAX < indexed.values_num)
+	{
+		zbx_vector_tsdb_block_ptr_sort(&indexed, tsdb_block_compare_lastaccess);
+
+		for (int i = ZBX_TSDB_INDEXED_BLOCKS_MAX; i < indexed.values_num; i++)
+		{
+			zbx_tsdb_block_t	*block = indexed.values[i];
+
+			close(block->fd);
+			block->fd = -1;
+			block->indexed = 0;
+			zbx_hashset_clear(&block->items);
+		}
+	}
+
+	zbx_vector_tsdb_block_ptr_destroy(&indexed);
+}
+
+static int	tsdb_block_compare_desc(const void *d1, const void *d2)
+{
+	const zbx_tsdb_block_t	*b1 = *(const zbx_tsdb_block_t * const *)d1;
+	const zbx_tsdb_block_t	*b2 = *(const zbx_tsdb_block_t * const *)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(b2->start, b1->start);
+
+	return 0;
+}
+
+static zbx_tsdb_block_t	*tsdb_get_block(const zbx_tsdb_data_t *data, int start)
+{
+	zbx_tsdb_block_t	block_local, *block = &block_local;
+	int			i;
+
+	block_local.start = start;
+
+	if (FAIL == (i = zbx_vector_tsdb_block_ptr_bsearch(&data->blocks, block, tsdb_block_compare_desc)))
+		return NULL;
+
+	return data->blocks.values[i];
+}
+
+static zbx_tsdb_block_t	*tsdb_add_block(zbx_tsdb_data_t *data, int start)
+{
+	zbx_tsdb_block_t	*block;
+
+	if (NULL != (block = tsdb_get_block(data, start)))
+		return block;
+
+	block = tsdb_block_create(start);
+	zbx_vector_tsdb_block_ptr_append(&data->blocks, block);
+	zbx_vector_tsdb_block_ptr_sort(&data->blocks, tsdb_block_compare_desc);
+
+	return block;
+}
+
+/************************************************************************************
+ *                                                                                  *
+ * Purpose: updates the list of known time blocks                                   *
+ *                                                                                  *
+ * Parameters: data  - [IN/OUT] local storage data                                  *
+ *             now   - [IN] current time                                            *
+ *             force - [IN] 1 - list segment files even if the blocks were          *
+ *                              listed recently                                     *
+ *                                                                                  *
+ * Comments: Segment files are listed at most once per                              *
+ *           ZBX_TSDB_BLOCKS_REFRESH_PERIOD to detect blocks created or removed     *
+ *           by other processes. Between listings only the segment file of the      *
+ *           current time block is looked up when it is not known yet, as new       *
+ *           values are mostly written there.                                       *
+ *                                                                                  *
+ ***********************************************************************************/
+static void	tsdb_refresh_blocks(zbx_tsdb_data_t *data, time_t now, int force)
+{
+	DIR			*dir;
+	struct dirent		*entry;
+	zbx_vector_int32_t	starts;
+	int			start;
+
+	if (0 == force && ZBX_TSDB_BLOCKS_REFRESH_PERIOD > now - data->blocks_time)
+	{
+		char		path[MAX_STRING_LEN];
+		zbx_stat_t	st;
+
+		start = tsdb_block_start((int)now);
+
+		if (NULL == tsdb_get_block(data, start))
+		{
+			tsdb_block_path(data, start, path, sizeof(path));
+
+			if (0 == zbx_stat(path, &st))
+				tsdb_add_block(data, start);
+		}
+
+		return;
+	}
+
+	if (NULL == (dir = opendir(data->dir)))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot open directory \"%s\": %s", data->dir, zbx_strerror(errno));
+		return;
+	}
+
+	data->blocks_time = now;
+	zbx_vector_int32_create(&starts);
+
+	while (NULL != (entry = readdir(dir)))
+	{
+		char	*ext;
+
+		if (NULL == (ext = strchr(entry->d_name, '.')) || 0 != strcmp(ext, ZBX_TSDB_FILE_EXT))
+			continue;
+
+		*ext = '\0';
+
+		if (SUCCEED == zbx_is_uint31(entry->d_name, &start))
+			zbx_vector_int32_append(&starts, start);
+	}
+
+	closedir(dir);
+
+	zbx_vector_int32_sort(&starts, ZBX_DEFAULT_INT_COMPARE_FUNC);
+
+	/* forget blocks removed by other processes */
+	for (int i = 0; i < data->blocks.values_num;)
+	{
+		if (FAIL == zbx_vector_int32_bsearch(&starts, data->blocks.values[i]->start,
+				ZBX_DEFAULT_INT_COMPARE_FUNC))
+		{
+			tsdb_block_free(data->blocks.values[i]);
+			zbx_vector_tsdb_block_ptr_remove(&data->blocks, i);
+		}
+		else
+			i++;
+	}
+
+	for (int i = 0; i < starts.values_num; i++)
+		tsdb_add_block(data, starts.values[i]);
+
+	zbx_vector_int32_destroy(&starts);
+}
+
+/************************************************************************************
+ *                                                                                  *
+ * Purpose: indexes chunks appended to segment file since the last indexing         *
+ *                                                                                  *
+ * Parameters: data       - [IN] local storage data                                 *
+ *             value_type - [IN]                                                    *
+ *             block      - [IN/OUT] time block                                     *
+ *                                                                                  *
+ * Return value: SUCCEED - the block index is up to date                            *
+ *               FAIL    - the segment file cannot be read                          *
+ *                                                                                  *
+ * Comments: Only chunk headers are read. A trailing incomplete chunk is being      *
+ *           written by another process and is indexed on the next call.            *
+ *           Corrupted data is reported and skipped by searching for the next       *
+ *           valid chunk header.                                                    *
+ *                                                                                  *
+ ***********************************************************************************/
+static int	tsdb_index_block(const zbx_tsdb_data_t *data, unsigned char value_type, zbx_tsdb_block_t *block)
+{
+	char			path[MAX_STRING_LEN];
+	zbx_stat_t		st;
+	const unsigned char	*map;
+	zbx_uint64_t		offset, size, corrupted = 0;
+	int			i;
+
+	tsdb_block_path(data, block->start, path, sizeof(path));
+
+	if (-1 == block->fd && -1 == (block->fd = open(path, O_RDONLY)))
+	{
+		if (ENOENT != errno)
+			zabbix_log(LOG_LEVEL_WARNING, "cannot open file \"%s\": %s", path, zbx_strerror(errno));
+		return FAIL;
+	}
+
+	if (0 != zbx_fstat(block->fd, &st))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot stat file \"%s\": %s", path, zbx_strerror(errno));
+		return FAIL;
+	}
+
+	size = (zbx_uint64_t)st.st_size;
+
+	if (block->indexed + sizeof(zbx_tsdb_chunk_t) > size)
+		return SUCCEED;
+
+	if (MAP_FAILED == (map = (const unsigned char *)mmap(NULL, (size_t)size, PROT_READ, MAP_SHARED, block->fd,
+			0)))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot map file \"%s\": %s", path, zbx_strerror(errno));
+		return FAIL;
+	}
+
+	for (offset = block->indexed; offset + sizeof(zbx_tsdb_chunk_t) <= size;)
+	{
+		zbx_tsdb_chunk_t	chunk;
+		zbx_tsdb_chunk_ref_t	ref;
+		zbx_tsdb_item_t		*item;
+
+		memcpy(&chunk, map + offset, sizeof(chunk));
+
+		if (ZBX_TSDB_CHUNK_MAGIC != chunk.magic || value_type != chunk.value_type || 0 == chunk.count ||
+				chunk.first > chunk.last || block->start != tsdb_block_start(chunk.first))
+		{
+			if (0 == corrupted++)
+			{
+				zabbix_log(LOG_LEVEL_WARNING, "corrupted data in file \"%s\" at offset " ZBX_FS_UI64
+						", searching for the next chunk", path, offset);
+			}
+
+			offset++;
+			continue;
+		}
+
+		if (0 != corrupted)
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "skipped " ZBX_FS_UI64 " bytes of corrupted data in file \"%s\"",
+					corrupted, path);
+			corrupted = 0;
+		}
+
+		if (chunk.size > size - offset - sizeof(chunk))
+			break;
+
+		if (NULL == (item = (zbx_tsdb_item_t *)zbx_hashset_search(&block->items, &chunk.itemid)))
+		{
+			zbx_tsdb_item_t	item_local = {.itemid = chunk.itemid};
+
+			item = (zbx_tsdb_item_t *)zbx_hashset_insert(&block->items, &item_local, sizeof(item_local));
+			zbx_vector_tsdb_chunk_ref_create(&item->chunks);
+		}
+
+		ref.offset = offset + sizeof(chunk);
+		ref.size = chunk.size;
+		ref.count = chunk.count;
+		ref.first = chunk.first;
+		ref.last = chunk.last;
+
+		/* keep chunks ordered by their last value, mostly they are appended in this order already */
+		for (i = item->chunks.values_num; 0 < i && item->chunks.values[i - 1].last > ref.last; i--)
+			;
+
+		zbx_vector_tsdb_chunk_ref_insert(&item->chunks, ref, i);
+
+		offset += sizeof(chunk) + chunk.size;
+	}
+
+	block->indexed = offset;
+	munmap((void *)map, (size_t)size);
+
+	return SUCCEED;
+}
+
+/************************************************************************************
+ *                                                                                  *
+ * Purpose: reads values of indexed chunk                                           *
+ *                                                                                  *
+ * Parameters: block      - [IN] time block                                         *
+ *             ref        - [IN] chunk position                                     *
+ *             value_type - [IN]                                                    *
+ *             start      - [IN] period start timestamp (excluding)                 *
+ *             end        - [IN] period end timestamp (including)                   *
+ *             buf        - [IN/OUT] read buffer                                    *
+ *             buf_alloc  - [IN/OUT] read buffer size                               *
+ *             values     - [OUT] item history values                               *
+ *                                                                                  *
+ ***********************************************************************************/
+static void	tsdb_read_chunk(const zbx_tsdb_block_t *block, const zbx_tsdb_chunk_ref_t *ref,
+		unsigned char value_type, int start, int end, unsigned char **buf, size_t *buf_alloc,
+		zbx_vector_history_record_t *values)
+{
+	zbx_tsdb_codec_t	codec;
+	size_t			pos = 0;
+
+	if (*buf_alloc < ref->size)
+	{
+		*buf_alloc = ref->size;
+		*buf = (unsigned char *)zbx_realloc(*buf, *buf_alloc);
+	}
+
+	if ((ssize_t)ref->size != pread(block->fd, *buf, ref->size, (off_t)ref->offset))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot read history block %d at offset " ZBX_FS_UI64 ": %s",
+				block->start, ref->offset, zbx_strerror(errno));
+		return;
+	}
+
+	memset(&codec, 0, sizeof(codec));
+
+	for (zbx_uint32_t i = 0; i < ref->count; i++)
+	{
+		zbx_history_record_t	record;
+		zbx_uint64_t		bits;
+
+		if (FAIL == tsdb_decode(*buf, ref->size, &pos, &codec, &record.timestamp, &bits, 0 == i))
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "corrupted data in history block %d at offset " ZBX_FS_UI64,
+					block->start, ref->offset);
+			break;
+		}
+
+		if (record.timestamp.sec <= start || record.timestamp.sec > end)
+			continue;
+
+		tsdb_bits2value(bits, value_type, &record.value);
+		zbx_vector_history_record_append_ptr(values, &record);
+	}
+}
+
+/************************************************************************************
+ *                                                                                  *
+ * Purpose: encodes values of one item belonging to one time block into chunk       *
+ *                                                                                  *
+ * Parameters: itemid     - [IN]                                                    *
+ *             value_type - [IN]                                                    *
+ *             values     - [IN] values sorted by timestamp                         *
+ *             num        - [IN] number of values                                   *
+ *             bs         - [IN/OUT] bit stream buffer                              *
+ *             write      - [IN/OUT] chunks of the time block                       *
+ *                                                                                  *
+ ***********************************************************************************/
+static void	tsdb_encode_chunk(zbx_uint64_t itemid, unsigned char value_type, const zbx_history_record_t *values,
+		int num, zbx_tsdb_bits_t *bs, zbx_tsdb_write_t *write)
+{
+	zbx_tsdb_chunk_t	chunk;
+	zbx_tsdb_codec_t	codec;
+	double			min = 0, max = 0;
+
+	if (0 != bs->alloc)
+		memset(bs->data, 0, bs->alloc);
+	bs->bits = 0;
+
+	memset(&chunk, 0, sizeof(chunk));
+	memset(&codec, 0, sizeof(codec));
+	chunk.magic = ZBX_TSDB_CHUNK_MAGIC;
+	chunk.value_type = value_type;
+	chunk.itemid = itemid;
+	chunk.count = (zbx_uint32_t)num;
+	chunk.first = values[0].timestamp.sec;
+	chunk.last = values[num - 1].timestamp.sec;
+
+	for (int i = 0; i < num; i++)
+	{
+		const zbx_history_record_t	*v = &values[i];
+
+		if (ITEM_VALUE_TYPE_UINT64 == value_type)
+		{
+			if (0 == i || v->value.ui64 < chunk.min)
+				chunk.min = v->value.ui64;
+			if (0 == i || v->value.ui64 > chunk.max)
+				chunk.max = v->value.ui64;
+
+			chunk.sum += (double)v->value.ui64;
+		}
+		else
+		{
+			if (0 == i || v->value.dbl < min)
+				min = v->value.dbl;
+			if (0 == i || v->value.dbl > max)
+				max = v->value.dbl;
+
+			chunk.sum += v->value.dbl;
+		}
+
+		tsdb_encode(bs, &codec, &v->timestamp, tsdb_value2bits(&v->value, value_type), 0 == i);
+	}
+
+	if (ITEM_VALUE_TYPE_UINT64 != value_type)
+	{
+		memcpy(&chunk.min, &min, sizeof(min));
+		memcpy(&chunk.max, &max, sizeof(max));
+	}
+
+	chunk.size = (zbx_uint32_t)((bs->bits + 7) / 8);
+
+	if (write->buf_alloc < write->buf_offset + sizeof(chunk) + chunk.size)
+	{
+		while (write->buf_alloc < write->buf_offset + sizeof(chunk) + chunk.size)
+			write->buf_alloc = (0 == write->buf_alloc ? ZBX_KIBIBYTE : write->buf_alloc * 2);
+
+		write->buf = (char *)zbx_realloc(write->buf, write->buf_alloc);
+	}
+
+	memcpy(write->buf + write->buf_offset, &chunk, sizeof(chunk));
+	memcpy(write->buf + write->buf_offset + sizeof(chunk), bs->data, chunk.size);
+	write->buf_offset += sizeof(chunk) + chunk.size;
+}
+
+/************************************************************************************
+ *                                                                                  *
+ * Purpose: appends encoded chunks to time block segment file                       *
+ *                                                                                  *
+ * Parameters: data  - [IN/OUT] local storage data                                  *
+ *             start - [IN] block start timestamp                                   *
+ *             buf   - [IN] encoded chunks                                          *
+ *             size  - [IN] buffer size                                             *
+ *             error - [OUT] error message                                          *
+ *                                                                                  *
+ * Comments: The chunks are written with a single write while holding exclusive     *
+ *           lock of the file, so writes of different processes do not interleave.  *
+ *           Partially written data is truncated, readers treat the trailing        *
+ *           incomplete chunk as absent until then.                                 *
+ *                                                                                  *
+ ***********************************************************************************/
+static int	tsdb_append_block(zbx_tsdb_data_t *data, int start, const char *buf, size_t size, char **error)
+{
+	char		path[MAX_STRING_LEN];
+	int		fd, ret = FAIL;
+	ssize_t		written;
+	zbx_stat_t	st;
+	struct flock	lock;
+
+	tsdb_block_path(data, start, path, sizeof(path));
+
+	if (-1 == (fd = open(path, O_WRONLY | O_APPEND | O_CREAT, 0640)))
+	{
+		*error = zbx_dsprintf(*error, "cannot open file \"%s\": %s", path, zbx_strerror(errno));
+		return FAIL;
+	}
+
+	memset(&lock, 0, sizeof(lock));
+	lock.l_type = F_WRLCK;
+	lock.l_whence = SEEK_SET;
+
+	if (-1 == fcntl(fd, F_SETLKW, &lock))
+	{
+		*error = zbx_dsprintf(*error, "cannot lock file \"%s\": %s", path, zbx_strerror(errno));
+		goto out;
+	}
+
+	if (0 != zbx_fstat(fd, &st))
+	{
+		*error = zbx_dsprintf(*error, "cannot stat file \"%s\": %s", path, zbx_strerror(errno));
+		goto out;
+	}
+
+	if ((ssize_t)size != (written = write(fd, buf, size)))
+	{
+		if (-1 == written)
+		{
+			*error = zbx_dsprintf(*error, "cannot write to file \"%s\": %s", path, zbx_strerror(errno));
+		}
+		else
+		{
+			*error = zbx_dsprintf(*error, "cannot write to file \"%s\": written " ZBX_FS_SSIZE_T " of "
+					ZBX_FS_SIZE_T " bytes", path, (zbx_fs_ssize_t)written, (zbx_fs_size_t)size);
+
+			if (0 != ftruncate(fd, st.st_size))
+			{
+				zabbix_log(LOG_LEVEL_WARNING, "cannot truncate file \"%s\": %s", path,
+						zbx_strerror(errno));
+			}
+		}
+
+		goto out;
+	}
+
+	tsdb_add_block(data, start);
+	ret = SUCCEED;
+out:
+	/* closing the file releases the lock */
+	close(fd);
+
+	return ret;
+}
+
+static zbx_tsdb_write_t	*tsdb_get_write(zbx_vector_tsdb_write_t *writes, int start)
+{
+	zbx_tsdb_write_t	write_local = {.start = start};
+
+	for (int i = 0; i < writes->values_num; i++)
+	{
+		if (writes->values[i].start == start)
+			return &writes->values[i];
+	}
+
+	zbx_vector_tsdb_write_append(writes, write_local);
+
+	return &writes->values[writes->values_num - 1];
+}
+
+/************************************************************************************
+ *                                                                                  *
+ * Purpose: writes buffered item values to segment files                            *
+ *                                                                                  *
+ * Parameters: data       - [IN/OUT] local storage data                             *
+ *             value_type - [IN]                                                    *
+ *             now        - [IN] current time                                       *
+ *             force      - [IN] 1 - write all buffered values                      *
+ *                                                                                  *
+ * Return value: FLUSH_SUCCEED - the values were written                            *
+ *               FLUSH_FAIL    - otherwise                                          *
+ *                                                                                  *
+ * Comments: Values of an item are written when ZBX_TSDB_CHUNK_VALUES_MAX values    *
+ *           are buffered, the oldest value was buffered ZBX_TSDB_CHUNK_DELAY ago   *
+ *           or belongs to a previous time block. Values spanning several time      *
+ *           blocks are split into one chunk per block.                             *
+ *                                                                                  *
+ ***********************************************************************************/
+static int	tsdb_write_pending(zbx_tsdb_data_t *data, unsigned char value_type, time_t now, int force)
+{
+	zbx_hashset_iter_t	iter;
+	zbx_tsdb_pending_t	*pending;
+	zbx_vector_tsdb_write_t	writes;
+	zbx_tsdb_bits_t		bs = {0};
+	char			*error = NULL;
+	int			ret = FLUSH_SUCCEED, block = tsdb_block_start((int)now);
+
+	zbx_vector_tsdb_write_create(&writes);
+
+	zbx_hashset_iter_reset(&data->pending, &iter);
+	while (NULL != (pending = (zbx_tsdb_pending_t *)zbx_hashset_iter_next(&iter)))
+	{
+		zbx_history_record_t	*values;
+		int			from = 0;
+
+		if (0 == force && ZBX_TSDB_CHUNK_VALUES_MAX > pending->values.values_num &&
+				ZBX_TSDB_CHUNK_DELAY > now - pending->created &&
+				block == tsdb_block_start(pending->first))
+		{
+			continue;
+		}
+
+		zbx_vector_history_record_sort(&pending->values,
+				(zbx_compare_func_t)zbx_history_record_compare_asc_func);
+		values = pending->values.values;
+
+		for (int i = 1; i <= pending->values.values_num; i++)
+		{
+			int	start = tsdb_block_start(values[from].timestamp.sec);
+
+			if (i != pending->values.values_num && tsdb_block_start(values[i].timestamp.sec) == start)
+				continue;
+
+			tsdb_encode_chunk(pending->itemid, value_type, values + from, i - from, &bs,
+					tsdb_get_write(&writes, start));
+			from = i;
+		}
+
+		zbx_hashset_iter_remove(&iter);
+	}
+
+	for (int i = 0; i < writes.values_num; i++)
+	{
+		zbx_tsdb_write_t	*write = &writes.values[i];
+
+		if (FAIL == tsdb_append_block(data, write->start, write->buf, write->buf_offset, &error))
+		{
+			zabbix_log(LOG_LEVEL_ERR, "cannot write history to local storage: %s", error);
+			zbx_free(error);
+			ret = FLUSH_FAIL;
+		}
+
+		zbx_free(write->buf);
+	}
+
+	zbx_vector_tsdb_write_destroy(&writes);
+	zbx_free(bs.data);
+
+	return ret;
+}
+
+/************************************************************************************
+ *                                                                                  *
+ * Purpose: removes time blocks that are older than the history storage period      *
+ *                                                                                  *
+ * Comments: Time blocks contain values of all items, so only global history        *
+ *           storage period can be applied. The local history storage is not        *
+ *           started without it, if it is disabled later the expired blocks are     *
+ *           kept and a warning is logged.                                          *
+ *                                                                                  *
+ ***********************************************************************************/
+static void	tsdb_housekeep(zbx_tsdb_data_t *data)
+{
+	time_t	now, least_ts = 0;
+
+	now = time(NULL);
+
+	if (ZBX_TSDB_HOUSEKEEPING_PERIOD > now - data->housekeeping_time)
+		return;
+
+	data->housekeeping_time = now;
+
+	zbx_recalc_time_period(&least_ts, ZBX_RECALC_TIME_PERIOD_HISTORY);
+
+	if (0 == least_ts)
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "expired history is not removed from local history storage \"%s\":"
+				" global history storage period override is disabled", data->dir);
+		return;
+	}
+
+	tsdb_refresh_blocks(data, now, 1);
+
+	/* blocks are sorted in descending order, the oldest are at the end */
+	for (int i = data->blocks.values_num - 1; 0 <= i; i--)
+	{
+		zbx_tsdb_block_t	*block = data->blocks.values[i];
+		char			path[MAX_STRING_LEN];
+
+		if (block->start + ZBX_TSDB_BLOCK_PERIOD > least_ts)
+			break;
+
+		tsdb_block_path(data, block->start, path, sizeof(path));
+
+		if (0 != unlink(path) && ENOENT != errno)
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "cannot remove file \"%s\": %s", path, zbx_strerror(errno));
+			continue;
+		}
+
+		zabbix_log(LOG_LEVEL_DEBUG, "removed expired history block \"%s\"", path);
+
+		tsdb_block_free(block);
+		zbx_vector_tsdb_block_ptr_remove_noorder(&data->blocks, i);
+	}
+}
+
+/******************************************************************************************************************
+ *                                                                                                                *
+ * history interface support                                                                                      *
+ *                                                                                                                *
+ ******************************************************************************************************************/
+
+/************************************************************************************
+ *                                                                                  *
+ * Purpose: destroys history storage interface                                      *
+ *                                                                                  *
+ * Parameters:  hist - [IN] the history storage interface                           *
+ *                                                                                  *
+ * Comments: Buffered values are written before destroying.                         *
+ *                                                                                  *
+ ***********************************************************************************/
+static void	tsdb_destroy(zbx_history_iface_t *hist)
+{
+	zbx_tsdb_data_t	*data = (zbx_tsdb_data_t *)hist->data.tsdb_data;
+
+	(void)tsdb_write_pending(data, hist->value_type, time(NULL), 1);
+
+	zbx_vector_tsdb_block_ptr_clear_ext(&data->blocks, tsdb_block_free);
+	zbx_vector_tsdb_block_ptr_destroy(&data->blocks);
+	zbx_hashset_destroy(&data->pending);
+	zbx_free(data->dir);
+	zbx_free(data);
+}
+
+/************************************************************************************
+ *                                                                                  *
+ * Purpose: gets item history data from history storage                             *
+ *                                                                                  *
+ * Parameters:  hist    - [IN] the history storage interface                        *
+ *              itemid  - [IN] the itemid                                           *
+ *              start   - [IN] the period start timestamp                           *
+ *              count   - [IN] the number of values to read                         *
+ *              end     - [IN] the period end timestamp                             *
+ *              values  - [OUT] the item history data values                        *
+ *                                                                                  *
+ * Return value: SUCCEED - the history data were read successfully                  *
+ *               FAIL - otherwise                                                   *
+ *                                                                                  *
+ * Comments: This function reads <count> values from ]<start>,<end>] interval or    *
+ *           all values from the specified interval if count is zero. When count    *
+ *           is set all values from the second of the oldest returned value are     *
+ *           returned, so that data is cached by seconds.                           *
+ *                                                                                  *
+ ***********************************************************************************/
+static int	tsdb_get_values(zbx_history_iface_t *hist, zbx_uint64_t itemid, int start, int count, int end,
+		zbx_vector_history_record_t *values)
+{
+	zbx_tsdb_data_t		*data = (zbx_tsdb_data_t *)hist->data.tsdb_data;
+	zbx_tsdb_pending_t	*pending;
+	int			pos = values->values_num;
+	time_t			time_from = start, now;
+	unsigned char		*buf = NULL;
+	size_t			buf_alloc = 0;
+
+	zbx_recalc_time_period(&time_from, ZBX_RECALC_TIME_PERIOD_HISTORY);
+
+	/* values buffered by this process are not in segment files yet */
+	if (NULL != (pending = (zbx_tsdb_pending_t *)zbx_hashset_search(&data->pending, &itemid)))
+	{
+		for (int i = 0; i < pending->values.values_num; i++)
+		{
+			zbx_history_record_t	*record = &pending->values.values[i];
+
+			if (record->timestamp.sec > time_from && record->timestamp.sec <= end)
+				zbx_vector_history_record_append_ptr(values, record);
+		}
+	}
+
+	now = time(NULL);
+	tsdb_refresh_blocks(data, now, 0);
+
+	for (int i = 0; i < data->blocks.values_num; i++)
+	{
+		zbx_tsdb_block_t	*block = data->blocks.values[i];
+		zbx_tsdb_item_t		*item;
+
+		if (block->start > end)
+			continue;
+
+		if (block->start + ZBX_TSDB_BLOCK_PERIOD <= time_from)
+			break;
+
+		if (SUCCEED != tsdb_index_block(data, hist->value_type, block))
+			continue;
+
+		block->lastaccess = now;
+
+		if (NULL == (item = (zbx_tsdb_item_t *)zbx_hashset_search(&block->items, &itemid)))
+			continue;
+
+		/* read the newest chunks first, so that reading by count can stop early */
+		for (int j = item->chunks.values_num - 1; 0 <= j; j--)
+		{
+			const zbx_tsdb_chunk_ref_t	*ref = &item->chunks.values[j];
+
+			if (ref->last <= time_from)
+				break;
+
+			/* chunks outside the requested period are skipped without reading */
+			if (ref->first > end)
+				continue;
+
+			if (0 != count && values->values_num - pos >= count)
+			{
+				qsort(values->values + pos, (size_t)(values->values_num - pos),
+						sizeof(zbx_history_record_t),
+						(zbx_compare_func_t)zbx_history_record_compare_desc_func);
+
+				/* the remaining chunks contain only values older than the requested ones */
+				if (ref->last < values->values[pos + count - 1].timestamp.sec)
+					break;
+			}
+
+			tsdb_read_chunk(block, ref, hist->value_type, (int)time_from, end, &buf, &buf_alloc, values);
+		}
+
+		/* blocks are aligned to seconds, older blocks cannot contain values from the same second */
+		if (0 != count && values->values_num - pos >= count)
+			break;
+	}
+
+	zbx_free(buf);
+	tsdb_release_indexes(data);
+
+	if (0 == count)
+		return SUCCEED;
+
+	qsort(values->values + pos, (size_t)(values->values_num - pos), sizeof(zbx_history_record_t),
+			(zbx_compare_func_t)zbx_history_record_compare_desc_func);
+
+	if (values->values_num - pos > count)
+	{
+		int	sec;
+
+		sec = values->values[pos + count - 1].timestamp.sec;
+
+		for (count += pos; count < values->values_num && values->values[count].timestamp.sec == sec; count++)
+			;
+
+		values->values_num = count;
+	}
+
+	return SUCCEED;
+}
+
+/************************************************************************************
+ *                                                                                  *
+ * Purpose: buffers history data to be written to storage                           *
+ *                                                                                  *
+ * Parameters:  hist    - [IN] the history storage interface                        *
+ *              history - [IN] the history data vector (may have mixed value types) *
+ *                                                                                  *
+ ***********************************************************************************/
+static int	tsdb_add_values(zbx_history_iface_t *hist, const zbx_vector_dc_history_ptr_t *history,
+		int config_history_storage_pipelines)
+{
+	zbx_tsdb_data_t	*data = (zbx_tsdb_data_t *)hist->data.tsdb_data;
+	int		num = 0;
+	time_t		now;
+
+	ZBX_UNUSED(config_history_storage_pipelines);
+
+	now = time(NULL);
+
+	for (int i = 0; i < history->values_num; i++)
+	{
+		zbx_dc_history_t	*h = history->values[i];
+		zbx_tsdb_pending_t	*pending;
+		zbx_history_record_t	record;
+
+		if (h->value_type != hist->value_type)
+			continue;
+
+		if (NULL == (pending = (zbx_tsdb_pending_t *)zbx_hashset_search(&data->pending, &h->itemid)))
+		{
+			zbx_tsdb_pending_t	pending_local = {.itemid = h->itemid, .created = now,
+							.first = h->ts.sec};
+
+			pending = (zbx_tsdb_pending_t *)zbx_hashset_insert(&data->pending, &pending_local,
+					sizeof(pending_local));
+			zbx_history_record_vector_create(&pending->values);
+		}
+		else if (h->ts.sec < pending->first)
+			pending->first = h->ts.sec;
+
+		record.timestamp = h->ts;
+		record.value = h->value;
+		zbx_vector_history_record_append_ptr(&pending->values, &record);
+		num++;
+	}
+
+	return num;
+}
+
+/************************************************************************************
+ *                                                                                  *
+ * Purpose: writes buffered history data that is due to storage                     *
+ *                                                                                  *
+ * Parameters:  hist    - [IN] the history storage interface                        *
+ *                                                                                  *
+ ***********************************************************************************/
+static int	tsdb_flush(zbx_history_iface_t *hist)
+{
+	zbx_tsdb_data_t	*data = (zbx_tsdb_data_t *)hist->data.tsdb_data;
+	int		ret;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() items:%d", __func__, data->pending.num_data);
+
+	ret = tsdb_write_pending(data, hist->value_type, time(NULL), 0);
+
+	tsdb_housekeep(data);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
+
+	return ret;
+}
+
+static void	tsdb_pending_clear(void *d)
+{
+	zbx_tsdb_pending_t	*pending = (zbx_tsdb_pending_t *)d;
+
+	zbx_vector_history_record_destroy(&pending->values);
+}
+
+/************************************************************************************
+ *                                                                                  *
+ * Purpose: sets local history storage interface callbacks and data                 *
+ *                                                                                  *
+ * Parameters: hist       - [OUT] history storage interface                         *
+ *             value_type - [IN] target value type                                  *
+ *             dir        - [IN] value type storage directory, freed with           *
+ *                               the interface                                      *
+ *                                                                                  *
+ ***********************************************************************************/
+static void	tsdb_iface_init(zbx_history_iface_t *hist, unsigned char value_type, char *dir)
+{
+	zbx_tsdb_data_t	*data;
+
+	data = (zbx_tsdb_data_t *)zbx_malloc(NULL, sizeof(zbx_tsdb_data_t));
+	data->dir = dir;
+	data->blocks_time = 0;
+	data->housekeeping_time = 0;
+	zbx_hashset_create_ext(&data->pending, 0, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC,
+			tsdb_pending_clear, ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC,
+			ZBX_DEFAULT_MEM_FREE_FUNC);
+	zbx_vector_tsdb_block_ptr_create(&data->blocks);
+
+	hist->value_type = value_type;
+	hist->data.tsdb_data = data;
+	hist->destroy = tsdb_destroy;
+	hist->add_values = tsdb_add_values;
+	hist->flush = tsdb_flush;
+	hist->get_values = tsdb_get_values;
+	hist->requires_trends = 1;
+}
+
+/************************************************************************************
+ *                                                                                  *
+ * Purpose: checks that global history storage period override is enabled           *
+ *                                                                                  *
+ * Comments: Time blocks contain values of all items and cannot be housekept        *
+ *           by item history storage periods.                                       *
+ *                                                                                  *
+ ***********************************************************************************/
+static int	tsdb_check_housekeeping(char **error)
+{
+	zbx_db_result_t	result;
+	zbx_db_row_t	row;
+	int		ret = FAIL;
+
+	if (ZBX_DB_OK != zbx_db_connect(ZBX_DB_CONNECT_NORMAL))
+	{
+		*error = zbx_strdup(*error, "Cannot connect to the database to check housekeeping settings");
+		return FAIL;
+	}
+
+	if (NULL == (result = zbx_db_select("select value_int from settings where name='hk_history_global'")))
+	{
+		*error = zbx_strdup(*error, "Cannot read housekeeping settings");
+		goto out;
+	}
+
+	if (NULL != (row = zbx_db_fetch(result)) && 1 == atoi(row[0]))
+		ret = SUCCEED;
+	else
+		*error = zbx_strdup(*error, "Local history storage requires enabled global history storage period"
+				" override in housekeeping settings");
+
+	zbx_db_free_result(result);
+out:
+	zbx_db_close();
+
+	return ret;
+}
+
+/************************************************************************************
+ *                                                                                  *
+ * Purpose: initializes local history storage interface                             *
+ *                                                                                  *
+ * Parameters:                                                                      *
+ *    hist                        - [IN] history storage interface                  *
+ *    value_type                  - [IN] target value type                          *
+ *    config_history_storage_path - [IN] local history storage directory            *
+ *    error                       - [OUT] error message                             *
+ *                                                                                  *
+ * Return value: SUCCEED - history storage interface was initialized                *
+ *               FAIL    - otherwise                                                *
+ *                                                                                  *
+ ***********************************************************************************/
+int	zbx_history_tsdb_init(zbx_history_iface_t *hist, unsigned char value_type,
+		const char *config_history_storage_path, char **error)
+{
+	char		*dir;
+	const char	*type;
+
+	switch (value_type)
+	{
+		case ITEM_VALUE_TYPE_FLOAT:
+			type = "dbl";
+			break;
+		case ITEM_VALUE_TYPE_UINT64:
+			type = "uint";
+			break;
+		default:
+			*error = zbx_strdup(*error, "Only numeric value types are supported by local history storage");
+			return FAIL;
+	}
+
+	if (SUCCEED != tsdb_check_housekeeping(error))
+		return FAIL;
+
+	dir = zbx_dsprintf(NULL, "%s/%s", config_history_storage_path, type);
+
+	if (0 != mkdir(dir, 0750) && EEXIST != errno)
+	{
+		*error = zbx_dsprintf(*error, "Cannot create directory \"%s\": %s", dir, zbx_strerror(errno));
+		zbx_free(dir);
+		return FAIL;
+	}
+
+	tsdb_iface_init(hist, value_type, dir);
+
+	return SUCCEED;
+}
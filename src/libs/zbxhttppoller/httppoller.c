@@ -22,23 +22,58 @@
 #include "httptest.h"
 #include "zbxtime.h"
 #include "zbxthreads.h"
+#include "zbxpreproc.h"
+
+#include <event2/event.h>
+
+typedef struct
+{
+	const zbx_thread_info_t	*info;
+	unsigned char		state;
+}
+zbx_httppoller_selfmon_t;
+
+static void	httppoller_update_selfmon_counter(void *arg)
+{
+	zbx_httppoller_selfmon_t	*selfmon = (zbx_httppoller_selfmon_t *)arg;
+
+	if (ZBX_PROCESS_STATE_IDLE == selfmon->state)
+	{
+		zbx_update_selfmon_counter(selfmon->info, ZBX_PROCESS_STATE_BUSY);
+		selfmon->state = ZBX_PROCESS_STATE_BUSY;
+	}
+}
+
+static void	httppoller_wake_cb(evutil_socket_t fd, short events, void *arg)
+{
+	ZBX_UNUSED(fd);
+	ZBX_UNUSED(events);
+	ZBX_UNUSED(arg);
+}
 
 /******************************************************************************
  *                                                                            *
  * Purpose: main loop of processing of httptests                              *
  *                                                                            *
- * Comments: never returns                                                    *
+ * Comments: Web scenarios are executed asynchronously, up to                 *
+ *           MaxConcurrentChecksPerPoller scenarios at once.                  *
+ *           Never returns.                                                   *
  *                                                                            *
  ******************************************************************************/
 ZBX_THREAD_ENTRY(zbx_httppoller_thread, args)
 {
-	int					sleeptime = -1, httptests_count = 0, old_httptests_count = 0,
+	int					httptests_count = 0,
 						server_num = ((zbx_thread_args_t *)args)->info.server_num,
 						process_num = ((zbx_thread_args_t *)args)->info.process_num;
-	double					total_sec = 0.0, old_total_sec = 0.0;
 	time_t					last_stat_time, nextcheck = 0;
 	const zbx_thread_info_t			*info = &((zbx_thread_args_t *)args)->info;
 	unsigned char				process_type = ((zbx_thread_args_t *)args)->info.process_type;
+	struct event_base			*base;
+	struct event				*wake_timer;
+	struct timeval				tv = {1, 0};
+	zbx_httptest_poller_t			*poller;
+	zbx_httppoller_selfmon_t		selfmon = {.info = info};
+	char					*error = NULL;
 
 	const zbx_thread_httppoller_args	*httppoller_args_in = (const zbx_thread_httppoller_args *)
 						(((zbx_thread_args_t *)args)->args);
@@ -47,6 +82,7 @@ ZBX_THREAD_ENTRY(zbx_httppoller_thread, args)
 			server_num, get_process_type_string(process_type), process_num);
 
 	zbx_update_selfmon_counter(info, ZBX_PROCESS_STATE_BUSY);
+	selfmon.state = ZBX_PROCESS_STATE_BUSY;
 
 #define STAT_INTERVAL	5	/* if a process is busy and does not sleep then update status not faster than */
 				/* once in STAT_INTERVAL seconds */
@@ -56,28 +92,47 @@ ZBX_THREAD_ENTRY(zbx_httppoller_thread, args)
 
 	zbx_db_connect(ZBX_DB_CONNECT_NORMAL);
 
+	if (NULL == (base = event_base_new()))
+	{
+		zabbix_log(LOG_LEVEL_ERR, "cannot initialize event base");
+		exit(EXIT_FAILURE);
+	}
+
+	/* wake up at least once per second to start scheduled web scenarios */
+	if (NULL == (wake_timer = event_new(base, -1, EV_PERSIST, httppoller_wake_cb, NULL)))
+	{
+		zabbix_log(LOG_LEVEL_ERR, "cannot create wake up timer event");
+		exit(EXIT_FAILURE);
+	}
+
+	evtimer_add(wake_timer, &tv);
+
+	if (NULL == (poller = zbx_httptest_poller_create(base, httppoller_update_selfmon_counter, &selfmon,
+			httppoller_args_in->config_max_concurrent_checks_per_poller,
+			httppoller_args_in->config_source_ip, httppoller_args_in->config_ssl_ca_location,
+			httppoller_args_in->config_ssl_cert_location, httppoller_args_in->config_ssl_key_location,
+			&error)))
+	{
+		zabbix_log(LOG_LEVEL_ERR, "cannot initialize web scenario poller: %s", error);
+		zbx_free(error);
+		exit(EXIT_FAILURE);
+	}
+
+	zbx_setproctitle("%s #%d started", get_process_type_string(process_type), process_num);
+
 	while (ZBX_IS_RUNNING())
 	{
 		double	sec = zbx_time();
 
 		zbx_update_env(get_process_type_string(process_type), sec);
 
-		if (0 != sleeptime)
-		{
-			zbx_setproctitle("%s #%d [got %d values in " ZBX_FS_DBL " sec, getting values]",
-					get_process_type_string(process_type), process_num, old_httptests_count,
-					old_total_sec);
-		}
-
 		if ((int)sec >= nextcheck)
 		{
 			time_t	now;
 
-			httptests_count += process_httptests((int)sec, httppoller_args_in->config_source_ip,
-					httppoller_args_in->config_ssl_ca_location,
-					httppoller_args_in->config_ssl_cert_location,
-					httppoller_args_in->config_ssl_key_location, &nextcheck);
-			total_sec += zbx_time() - sec;
+			httppoller_update_selfmon_counter(&selfmon);
+
+			httptests_count += process_httptests(poller, (int)sec, &nextcheck);
 
 			now = time(NULL);
 
@@ -85,32 +140,34 @@ ZBX_THREAD_ENTRY(zbx_httppoller_thread, args)
 				nextcheck = now + POLLER_DELAY;
 		}
 
-		sleeptime = zbx_calculate_sleeptime(nextcheck, POLLER_DELAY);
+		if (ZBX_PROCESS_STATE_BUSY == selfmon.state && zbx_httptest_poller_processing(poller) <
+				httppoller_args_in->config_max_concurrent_checks_per_poller)
+		{
+			zbx_update_selfmon_counter(info, ZBX_PROCESS_STATE_IDLE);
+			selfmon.state = ZBX_PROCESS_STATE_IDLE;
+		}
+
+		event_base_loop(base, EVLOOP_ONCE);
 
-		if (0 != sleeptime || STAT_INTERVAL <= time(NULL) - last_stat_time)
+		if (ZBX_IS_RUNNING())
+			zbx_preprocessor_flush();
+
+		if (STAT_INTERVAL <= time(NULL) - last_stat_time)
 		{
-			if (0 == sleeptime)
-			{
-				zbx_setproctitle("%s #%d [got %d values in " ZBX_FS_DBL " sec, getting values]",
-						get_process_type_string(process_type), process_num, httptests_count,
-						total_sec);
-			}
-			else
-			{
-				zbx_setproctitle("%s #%d [got %d values in " ZBX_FS_DBL " sec, idle %d sec]",
-						get_process_type_string(process_type), process_num, httptests_count,
-						total_sec, sleeptime);
-				old_httptests_count = httptests_count;
-				old_total_sec = total_sec;
-			}
+			zbx_setproctitle("%s #%d [got %d values, started %d in %d sec, awaiting %d]",
+					get_process_type_string(process_type), process_num,
+					zbx_httptest_poller_pop_processed(poller), httptests_count, STAT_INTERVAL,
+					zbx_httptest_poller_processing(poller));
+
 			httptests_count = 0;
-			total_sec = 0.0;
 			last_stat_time = time(NULL);
 		}
-
-		zbx_sleep_loop(info, sleeptime);
 	}
 
+	zbx_httptest_poller_destroy(poller);
+	event_free(wake_timer);
+	event_base_free(base);
+
 	zbx_setproctitle("%s #%d [terminated]", get_process_type_string(process_type), process_num);
 
 	while (1)
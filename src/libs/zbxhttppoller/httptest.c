@@ -35,6 +35,7 @@
 #include "zbxregexp.h"
 
 #include "zbxcurl.h"
+#include "zbxasynchttppoller.h"
 
 typedef struct
 {
@@ -669,32 +670,240 @@ out:
 	return ret;
 }
 
+/* web scenario step as loaded from database, macros are expanded when step is started */
+typedef struct
+{
+	zbx_uint64_t	httpstepid;
+	int		no;
+	char		*name;
+	char		*url;
+	char		*timeout;
+	char		*posts;
+	char		*required;
+	char		*status_codes;
+	int		post_type;
+	int		follow_redirects;
+	int		retrieve_mode;
+}
+zbx_httptest_step_row_t;
+
+ZBX_PTR_VECTOR_DECL(httptest_step_row_ptr, zbx_httptest_step_row_t *)
+ZBX_PTR_VECTOR_IMPL(httptest_step_row_ptr, zbx_httptest_step_row_t *)
+
+static void	httptest_step_row_free(zbx_httptest_step_row_t *row)
+{
+	zbx_free(row->name);
+	zbx_free(row->url);
+	zbx_free(row->timeout);
+	zbx_free(row->posts);
+	zbx_free(row->required);
+	zbx_free(row->status_codes);
+
+	zbx_free(row);
+}
+
+/* web scenario being executed */
+typedef struct
+{
+	zbx_dc_host_t				host;
+	zbx_httptest_t				httptest;
+
+	/* the time when scenario was taken from queue, used to schedule the next check */
+	time_t					now;
+	int					delay;
+
+	zbx_vector_httptest_step_row_ptr_t	steps;
+	int					step_index;
+
+	/* the current step */
+	zbx_db_httpstep				db_httpstep;
+	zbx_httpstep_t				httpstep;
+	unsigned char				step_started;
+
+	char					*err_str;
+	double					speed_download;
+	int					speed_download_num;
+	int					lastfailedstep;
+#ifdef HAVE_LIBCURL
+	CURL					*easyhandle;
+	struct curl_slist			*headers_slist;
+	zbx_http_response_t			body;
+	zbx_http_response_t			header;
+	char					errbuf[CURL_ERROR_SIZE];
+#endif
+}
+zbx_httptest_context_t;
+
+ZBX_PTR_VECTOR_DECL(httptest_context_ptr, zbx_httptest_context_t *)
+ZBX_PTR_VECTOR_IMPL(httptest_context_ptr, zbx_httptest_context_t *)
+
+struct zbx_httptest_poller
+{
+	const char				*config_source_ip;
+	const char				*config_ssl_ca_location;
+	const char				*config_ssl_cert_location;
+	const char				*config_ssl_key_location;
+	int					max_concurrent;
+	zbx_httptest_action_cb_t		action_cb;
+	void					*action_arg;
+
+	/* the number of web scenarios being executed and the number of finished scenarios */
+	int					processing;
+	int					processed;
+
+	zbx_vector_httptest_context_ptr_t	contexts;
+#ifdef HAVE_LIBCURL
+	zbx_asynchttppoller_config		*asynchttppoller_config;
+#endif
+};
+
+static void	httptest_context_free(zbx_httptest_context_t *context)
+{
+	zbx_free(context->httptest.httptest.ssl_key_password);
+	zbx_free(context->httptest.httptest.ssl_key_file);
+	zbx_free(context->httptest.httptest.ssl_cert_file);
+	zbx_free(context->httptest.httptest.http_proxy);
+
+	if (HTTPTEST_AUTH_NONE != context->httptest.httptest.authentication)
+	{
+		zbx_free(context->httptest.httptest.http_password);
+		zbx_free(context->httptest.httptest.http_user);
+	}
+
+	zbx_free(context->httptest.httptest.agent);
+	zbx_free(context->httptest.httptest.name);
+	zbx_free(context->httptest.httptest.delay);
+	zbx_free(context->httptest.headers);
+	httppairs_free(&context->httptest.variables);
+
+	httptest_remove_macros(&context->httptest);
+	zbx_vector_ptr_pair_destroy(&context->httptest.macros);
+
+	zbx_vector_httptest_step_row_ptr_clear_ext(&context->steps, httptest_step_row_free);
+	zbx_vector_httptest_step_row_ptr_destroy(&context->steps);
+
+	zbx_free(context->err_str);
+#ifdef HAVE_LIBCURL
+	if (NULL != context->easyhandle)
+		curl_easy_cleanup(context->easyhandle);
+#endif
+	zbx_free(context);
+}
+
 /******************************************************************************
  *                                                                            *
- * Purpose: processes single scenario of HTTP test                            *
+ * Purpose: loads web scenario and its steps                                  *
+ *                                                                            *
+ * Parameters: httptestid - [IN]                                              *
+ *             now        - [IN] current timestamp                            *
+ *                                                                            *
+ * Return value: web scenario context or NULL if scenario was not found or    *
+ *               its data could not be loaded                                 *
  *                                                                            *
  ******************************************************************************/
-static void	process_httptest(zbx_dc_host_t *host, zbx_httptest_t *httptest, int *delay,
-		const char *config_source_ip, const char *config_ssl_ca_location, const char *config_ssl_cert_location,
-		const char *config_ssl_key_location)
+static zbx_httptest_context_t	*httptest_context_load(zbx_uint64_t httptestid, time_t now)
 {
 	zbx_db_result_t		result;
-	zbx_db_httpstep		db_httpstep;
-	char			*err_str = NULL, *buffer = NULL;
-	zbx_timespec_t		ts;
-	double			speed_download = 0;
-	int			speed_download_num = 0, lastfailedstep = 0;
-#ifdef HAVE_LIBCURL
 	zbx_db_row_t		row;
-	zbx_httpstat_t		stat;
-	char			errbuf[CURL_ERROR_SIZE];
-	CURL			*easyhandle = NULL;
-	CURLcode		err;
-	zbx_httpstep_t		httpstep;
-	zbx_http_response_t	body = {0}, header = {0};
-#endif
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s() httptestid:" ZBX_FS_UI64 " name:'%s'",
-			__func__, httptest->httptest.httptestid, httptest->httptest.name);
+	zbx_httptest_context_t	*context;
+	zbx_dc_um_handle_t	*um_handle_masked, *um_handle_secure;
+
+	result = zbx_db_select(
+			"select h.hostid,h.host,h.name,t.httptestid,t.name,t.agent,"
+				"t.authentication,t.http_user,t.http_password,t.http_proxy,t.retries,"
+				"t.ssl_cert_file,t.ssl_key_file,t.ssl_key_password,t.verify_peer,"
+				"t.verify_host,t.delay"
+			" from httptest t,hosts h"
+			" where t.hostid=h.hostid"
+				" and t.httptestid=" ZBX_FS_UI64,
+			httptestid);
+
+	if (NULL == (row = zbx_db_fetch(result)))
+	{
+		zbx_db_free_result(result);
+		return NULL;
+	}
+
+	context = (zbx_httptest_context_t *)zbx_malloc(NULL, sizeof(zbx_httptest_context_t));
+	memset(context, 0, sizeof(zbx_httptest_context_t));
+
+	context->now = now;
+	zbx_vector_httptest_step_row_ptr_create(&context->steps);
+
+	/* create macro cache to use in HTTP test */
+	zbx_vector_ptr_pair_create(&context->httptest.macros);
+
+	ZBX_STR2UINT64(context->host.hostid, row[0]);
+	zbx_strscpy(context->host.host, row[1]);
+	zbx_strlcpy_utf8(context->host.name, row[2], sizeof(context->host.name));
+
+	ZBX_STR2UINT64(context->httptest.httptest.httptestid, row[3]);
+	context->httptest.httptest.name = zbx_strdup(NULL, row[4]);
+	context->httptest.httptest.delay = zbx_strdup(NULL, row[16]);
+
+	if (SUCCEED != httptest_load_pairs(&context->host, &context->httptest))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot process web scenario \"%s\" on host \"%s\": "
+				"cannot load web scenario data", context->httptest.httptest.name, context->host.name);
+		zbx_db_free_result(result);
+		THIS_SHOULD_NEVER_HAPPEN;
+
+		httptest_context_free(context);
+
+		return NULL;
+	}
+
+	um_handle_masked = zbx_dc_open_user_macros_masked();
+	um_handle_secure = zbx_dc_open_user_macros_secure();
+
+	context->httptest.httptest.agent = zbx_strdup(NULL, row[5]);
+	zbx_dc_expand_user_and_func_macros(um_handle_masked, &context->httptest.httptest.agent,
+			&context->host.hostid, 1, NULL);
+
+	if (HTTPTEST_AUTH_NONE != (context->httptest.httptest.authentication = atoi(row[6])))
+	{
+		context->httptest.httptest.http_user = zbx_strdup(NULL, row[7]);
+		zbx_dc_expand_user_and_func_macros(um_handle_secure, &context->httptest.httptest.http_user,
+				&context->host.hostid, 1, NULL);
+
+		context->httptest.httptest.http_password = zbx_strdup(NULL, row[8]);
+		zbx_dc_expand_user_and_func_macros(um_handle_secure, &context->httptest.httptest.http_password,
+				&context->host.hostid, 1, NULL);
+	}
+
+	if ('\0' != *row[9])
+	{
+		context->httptest.httptest.http_proxy = zbx_strdup(NULL, row[9]);
+		zbx_dc_expand_user_and_func_macros(um_handle_masked, &context->httptest.httptest.http_proxy,
+				&context->host.hostid, 1, NULL);
+	}
+	else
+		context->httptest.httptest.http_proxy = NULL;
+
+	context->httptest.httptest.retries = atoi(row[10]);
+
+	context->httptest.httptest.ssl_cert_file = zbx_strdup(NULL, row[11]);
+	context->httptest.httptest.ssl_key_file = zbx_strdup(NULL, row[12]);
+
+	zbx_substitute_macros(&context->httptest.httptest.ssl_cert_file, NULL, 0, &macro_httptest_field_resolv,
+			um_handle_masked, &context->host);
+	zbx_substitute_macros(&context->httptest.httptest.ssl_key_file, NULL, 0, &macro_httptest_field_resolv,
+			um_handle_masked, &context->host);
+
+	context->httptest.httptest.ssl_key_password = zbx_strdup(NULL, row[13]);
+	zbx_dc_expand_user_and_func_macros(um_handle_secure, &context->httptest.httptest.ssl_key_password,
+			&context->host.hostid, 1, NULL);
+
+	zbx_dc_close_user_macros(um_handle_secure);
+	zbx_dc_close_user_macros(um_handle_masked);
+
+	context->httptest.httptest.verify_peer = atoi(row[14]);
+	context->httptest.httptest.verify_host = atoi(row[15]);
+
+	zbx_db_free_result(result);
+
+	/* add httptest variables to the current test macro cache */
+	http_process_variables(&context->httptest, &context->httptest.variables, NULL, NULL);
 
 	result = zbx_db_select(
 			"select httpstepid,no,name,url,timeout,posts,required,status_codes,post_type,follow_redirects,"
@@ -702,562 +911,786 @@ static void	process_httptest(zbx_dc_host_t *host, zbx_httptest_t *httptest, int
 			" from httpstep"
 			" where httptestid=" ZBX_FS_UI64
 			" order by no",
-			httptest->httptest.httptestid);
+			httptestid);
 
-	buffer = zbx_strdup(buffer, httptest->httptest.delay);
+	while (NULL != (row = zbx_db_fetch(result)))
+	{
+		zbx_httptest_step_row_t	*step_row;
+
+		step_row = (zbx_httptest_step_row_t *)zbx_malloc(NULL, sizeof(zbx_httptest_step_row_t));
+
+		ZBX_STR2UINT64(step_row->httpstepid, row[0]);
+		step_row->no = atoi(row[1]);
+		step_row->name = zbx_strdup(NULL, row[2]);
+		step_row->url = zbx_strdup(NULL, row[3]);
+		step_row->timeout = zbx_strdup(NULL, row[4]);
+		step_row->posts = zbx_strdup(NULL, row[5]);
+		step_row->required = zbx_strdup(NULL, row[6]);
+		step_row->status_codes = zbx_strdup(NULL, row[7]);
+		step_row->post_type = atoi(row[8]);
+		step_row->follow_redirects = atoi(row[9]);
+		step_row->retrieve_mode = atoi(row[10]);
+
+		zbx_vector_httptest_step_row_ptr_append(&context->steps, step_row);
+	}
 
-	zbx_dc_um_handle_t	*um_handle = zbx_dc_open_user_macros_masked();
-	zbx_dc_expand_user_and_func_macros(um_handle, &buffer, &host->hostid, 1, NULL);
-	zbx_dc_close_user_macros(um_handle);
+	zbx_db_free_result(result);
+
+	return context;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: sends web scenario data, schedules the next check and frees web   *
+ *          scenario context                                                  *
+ *                                                                            *
+ ******************************************************************************/
+static void	httptest_finish(zbx_httptest_poller_t *poller, zbx_httptest_context_t *context)
+{
+	zbx_timespec_t	ts;
+	int		i;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() httptestid:" ZBX_FS_UI64 " name:'%s'", __func__,
+			context->httptest.httptest.httptestid, context->httptest.httptest.name);
+
+	zbx_timespec(&ts);
+
+	if (NULL != context->err_str)
+	{
+		if (0 >= context->lastfailedstep)
+		{
+			/* we are here because web scenario update interval is invalid, */
+			/* cURL initialization failed or we have been compiled without cURL library */
+
+			context->lastfailedstep = 1;
+		}
+
+		if (NULL != context->db_httpstep.name)
+		{
+			zabbix_log(LOG_LEVEL_DEBUG, "cannot process step \"%s\" of web scenario \"%s\" on host \"%s\": "
+					"%s", context->db_httpstep.name, context->httptest.httptest.name,
+					context->host.name, context->err_str);
+		}
+	}
+
+	if (0 != context->speed_download_num)
+		context->speed_download /= context->speed_download_num;
 
-	/* Avoid the potential usage of uninitialized values when: */
-	/* 1) compile without libCURL support */
-	/* 2) update interval is invalid */
-	db_httpstep.name = NULL;
+	process_test_data(context->httptest.httptest.httptestid, context->lastfailedstep, context->speed_download,
+			context->err_str, &ts);
 
-	if (SUCCEED != zbx_is_time_suffix(buffer, delay, ZBX_LENGTH_UNLIMITED))
+	zbx_dc_httptest_queue(context->now, context->httptest.httptest.httptestid, context->delay);
+
+	if (FAIL != (i = zbx_vector_httptest_context_ptr_search(&poller->contexts, context,
+			ZBX_DEFAULT_PTR_COMPARE_FUNC)))
 	{
-		err_str = zbx_dsprintf(err_str, "update interval \"%s\" is invalid", buffer);
-		lastfailedstep = -1;
-		*delay = ZBX_DEFAULT_INTERVAL;
-		goto httptest_error;
+		zbx_vector_httptest_context_ptr_remove_noorder(&poller->contexts, i);
 	}
 
+	httptest_context_free(context);
+
+	poller->processing--;
+	poller->processed++;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
+}
+
 #ifdef HAVE_LIBCURL
-	if (NULL == (easyhandle = curl_easy_init()))
+/******************************************************************************
+ *                                                                            *
+ * Purpose: frees resources of the current web scenario step                  *
+ *                                                                            *
+ ******************************************************************************/
+static void	httptest_step_clean(zbx_httptest_context_t *context)
+{
+	if (0 == context->step_started)
+		return;
+
+	curl_slist_free_all(context->headers_slist);
+	context->headers_slist = NULL;
+
+	zbx_free(context->header.data);
+	zbx_free(context->body.data);
+
+	zbx_free(context->db_httpstep.status_codes);
+	zbx_free(context->db_httpstep.required);
+	zbx_free(context->db_httpstep.posts);
+	zbx_free(context->db_httpstep.url);
+
+	httppairs_free(&context->httpstep.variables);
+
+	if (ZBX_POSTTYPE_FORM == context->db_httpstep.post_type)
+		zbx_free(context->httpstep.posts);
+
+	zbx_free(context->httpstep.url);
+	zbx_free(context->httpstep.headers);
+
+	context->step_started = 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: expands macros in the current web scenario step and sets up       *
+ *          cURL handle for its request                                       *
+ *                                                                            *
+ * Return value: SUCCEED - step is ready to be executed                       *
+ *               FAIL    - step cannot be executed, error is set in           *
+ *                         context->err_str                                   *
+ *                                                                            *
+ ******************************************************************************/
+static int	httptest_step_prepare(zbx_httptest_context_t *context)
+{
+	const zbx_httptest_step_row_t	*step_row = context->steps.values[context->step_index];
+	zbx_db_httpstep			*db_httpstep = &context->db_httpstep;
+	zbx_httpstep_t			*httpstep = &context->httpstep;
+	zbx_httptest_t			*httptest = &context->httptest;
+	zbx_dc_host_t			*host = &context->host;
+	char				*header_cookie = NULL, *buffer;
+	zbx_curl_cb_t			curl_body_cb, curl_header_cb;
+	CURLcode			err;
+	int				ret = FAIL;
+	zbx_dc_um_handle_t		*um_handle_masked, *um_handle_secure;
+
+	httpstep->httptest = httptest;
+	httpstep->httpstep = db_httpstep;
+
+	db_httpstep->httpstepid = step_row->httpstepid;
+	db_httpstep->httptestid = httptest->httptest.httptestid;
+	db_httpstep->no = step_row->no;
+	db_httpstep->name = step_row->name;
+
+	db_httpstep->url = zbx_strdup(NULL, step_row->url);
+
+	um_handle_masked = zbx_dc_open_user_macros_masked();
+	um_handle_secure = zbx_dc_open_user_macros_secure();
+
+	zbx_substitute_macros(&db_httpstep->url, NULL, 0, &macro_httptest_field_resolv, um_handle_secure, host);
+
+	http_substitute_variables(httptest, &db_httpstep->url);
+
+	db_httpstep->required = zbx_strdup(NULL, step_row->required);
+
+	zbx_substitute_macros(&db_httpstep->required, NULL, 0, &macro_httptest_field_resolv, um_handle_masked, host);
+
+	db_httpstep->status_codes = zbx_strdup(NULL, step_row->status_codes);
+	zbx_dc_expand_user_and_func_macros(um_handle_masked, &db_httpstep->status_codes, &host->hostid, 1, NULL);
+
+	db_httpstep->post_type = step_row->post_type;
+
+	if (ZBX_POSTTYPE_RAW == db_httpstep->post_type)
 	{
-		err_str = zbx_strdup(err_str, "cannot initialize cURL library");
-		goto clean;
+		db_httpstep->posts = zbx_strdup(NULL, step_row->posts);
+
+		zbx_substitute_macros(&db_httpstep->posts, NULL, 0, &macro_httptest_field_resolv, um_handle_secure,
+				host);
+
+		http_substitute_variables(httptest, &db_httpstep->posts);
 	}
+	else
+		db_httpstep->posts = NULL;
 
-	if (CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_PROXY, httptest->httptest.http_proxy)) ||
-			CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_COOKIEFILE, "")) ||
-			CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_USERAGENT, httptest->httptest.agent)) ||
-			CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_ACCEPT_ENCODING, "")))
+	buffer = zbx_strdup(NULL, step_row->timeout);
+	zbx_dc_expand_user_and_func_macros(um_handle_masked, &buffer, &host->hostid, 1, NULL);
+
+	zbx_dc_close_user_macros(um_handle_secure);
+	zbx_dc_close_user_macros(um_handle_masked);
+
+	context->step_started = 1;
+
+	if (SUCCEED != httpstep_load_pairs(host, httpstep))
 	{
-		err_str = zbx_strdup(err_str, curl_easy_strerror(err));
-		goto clean;
+		context->err_str = zbx_strdup(context->err_str, "cannot load web scenario step data");
+		goto out;
 	}
 
-	if (SUCCEED != zbx_curl_setopt_https(easyhandle, &err_str))
-		goto clean;
+	if (SUCCEED != zbx_is_time_suffix(buffer, &db_httpstep->timeout, ZBX_LENGTH_UNLIMITED))
+	{
+		context->err_str = zbx_dsprintf(context->err_str, "timeout \"%s\" is invalid", buffer);
+		goto out;
+	}
+	else if (db_httpstep->timeout < 1 || SEC_PER_HOUR < db_httpstep->timeout)
+	{
+		context->err_str = zbx_dsprintf(context->err_str, "timeout \"%s\" is out of 1-3600 seconds bounds",
+				buffer);
+		goto out;
+	}
 
-	if (SUCCEED != zbx_http_prepare_ssl(easyhandle, httptest->httptest.ssl_cert_file,
-			httptest->httptest.ssl_key_file, httptest->httptest.ssl_key_password,
-			httptest->httptest.verify_peer, httptest->httptest.verify_host, config_source_ip,
-			config_ssl_ca_location, config_ssl_cert_location, config_ssl_key_location, &err_str))
+	db_httpstep->follow_redirects = step_row->follow_redirects;
+	db_httpstep->retrieve_mode = step_row->retrieve_mode;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "%s() use step \"%s\"", __func__, db_httpstep->name);
+	zabbix_log(LOG_LEVEL_DEBUG, "%s() use post \"%s\"", __func__, ZBX_NULL2EMPTY_STR(httpstep->posts));
+
+	if (CURLE_OK != (err = curl_easy_setopt(context->easyhandle, CURLOPT_POSTFIELDS, httpstep->posts)))
 	{
-		goto clean;
+		context->err_str = zbx_strdup(context->err_str, curl_easy_strerror(err));
+		goto out;
 	}
 
-	httpstep.httptest = httptest;
-	httpstep.httpstep = &db_httpstep;
+	if (CURLE_OK != (err = curl_easy_setopt(context->easyhandle, CURLOPT_POST, (NULL != httpstep->posts &&
+			'\0' != *httpstep->posts) ? 1L : 0L)))
+	{
+		context->err_str = zbx_strdup(context->err_str, curl_easy_strerror(err));
+		goto out;
+	}
 
-	while (NULL != (row = zbx_db_fetch(result)) && ZBX_IS_RUNNING())
+	if (CURLE_OK != (err = curl_easy_setopt(context->easyhandle, CURLOPT_FOLLOWLOCATION,
+			0 == db_httpstep->follow_redirects ? 0L : 1L)))
 	{
-		struct curl_slist	*headers_slist = NULL;
-		char			*header_cookie = NULL;
-		zbx_curl_cb_t		curl_body_cb, curl_header_cb;
+		context->err_str = zbx_strdup(context->err_str, curl_easy_strerror(err));
+		goto out;
+	}
 
-		/* NOTE: do not break or return from this block! */
-		/*       process_step_data() call is required! */
+	if (0 != db_httpstep->follow_redirects)
+	{
+		if (CURLE_OK != (err = curl_easy_setopt(context->easyhandle, CURLOPT_MAXREDIRS,
+				ZBX_CURLOPT_MAXREDIRS)))
+		{
+			context->err_str = zbx_strdup(context->err_str, curl_easy_strerror(err));
+			goto out;
+		}
+	}
 
-		ZBX_STR2UINT64(db_httpstep.httpstepid, row[0]);
-		db_httpstep.httptestid = httptest->httptest.httptestid;
-		db_httpstep.no = atoi(row[1]);
-		db_httpstep.name = row[2];
+	/* headers defined in a step overwrite headers defined in scenario */
+	if (NULL != httpstep->headers && '\0' != *httpstep->headers)
+		add_http_headers(httpstep->headers, &context->headers_slist, &header_cookie);
+	else if (NULL != httptest->headers && '\0' != *httptest->headers)
+		add_http_headers(httptest->headers, &context->headers_slist, &header_cookie);
 
-		db_httpstep.url = zbx_strdup(NULL, row[3]);
+	err = curl_easy_setopt(context->easyhandle, CURLOPT_COOKIE, header_cookie);
+	zbx_free(header_cookie);
 
-		zbx_dc_um_handle_t	*um_handle_masked = zbx_dc_open_user_macros_masked();
-		zbx_dc_um_handle_t	*um_handle_secure = zbx_dc_open_user_macros_secure();
+	if (CURLE_OK != err)
+	{
+		context->err_str = zbx_strdup(context->err_str, curl_easy_strerror(err));
+		goto out;
+	}
 
-		zbx_substitute_macros(&db_httpstep.url, NULL, 0, &macro_httptest_field_resolv, um_handle_secure, host);
+	if (CURLE_OK != (err = curl_easy_setopt(context->easyhandle, CURLOPT_HTTPHEADER, context->headers_slist)))
+	{
+		context->err_str = zbx_strdup(context->err_str, curl_easy_strerror(err));
+		goto out;
+	}
 
-		http_substitute_variables(httptest, &db_httpstep.url);
+	switch (db_httpstep->retrieve_mode)
+	{
+		case ZBX_RETRIEVE_MODE_CONTENT:
+			curl_header_cb = zbx_curl_ignore_cb;
+			curl_body_cb = zbx_curl_write_cb;
+			break;
+		case ZBX_RETRIEVE_MODE_BOTH:
+			curl_header_cb = curl_body_cb = zbx_curl_write_cb;
+			break;
+		case ZBX_RETRIEVE_MODE_HEADERS:
+			curl_header_cb = zbx_curl_write_cb;
+			curl_body_cb = zbx_curl_ignore_cb;
+			break;
+		default:
+			THIS_SHOULD_NEVER_HAPPEN;
+			context->err_str = zbx_strdup(context->err_str, "invalid retrieve mode");
+			goto out;
+	}
 
-		db_httpstep.required = zbx_strdup(NULL, row[6]);
+	if (SUCCEED != zbx_http_prepare_callbacks(context->easyhandle, &context->header, &context->body,
+			curl_header_cb, curl_body_cb, context->errbuf, &context->err_str))
+	{
+		goto out;
+	}
 
-		zbx_substitute_macros(&db_httpstep.required, NULL, 0, &macro_httptest_field_resolv, um_handle_masked,
-				host);
+	/* enable/disable fetching the body */
+	if (CURLE_OK != (err = curl_easy_setopt(context->easyhandle, CURLOPT_NOBODY,
+			ZBX_RETRIEVE_MODE_HEADERS == db_httpstep->retrieve_mode ? 1L : 0L)))
+	{
+		context->err_str = zbx_strdup(context->err_str, curl_easy_strerror(err));
+		goto out;
+	}
 
-		db_httpstep.status_codes = zbx_strdup(NULL, row[7]);
-		zbx_dc_expand_user_and_func_macros(um_handle_masked, &db_httpstep.status_codes, &host->hostid, 1, NULL);
+	if (SUCCEED != zbx_http_prepare_auth(context->easyhandle, httptest->httptest.authentication,
+			httptest->httptest.http_user, httptest->httptest.http_password, NULL, &context->err_str))
+	{
+		goto out;
+	}
 
-		db_httpstep.post_type = atoi(row[8]);
+	zabbix_log(LOG_LEVEL_DEBUG, "%s() go to URL \"%s\"", __func__, httpstep->url);
 
-		if (ZBX_POSTTYPE_RAW == db_httpstep.post_type)
-		{
-			db_httpstep.posts = zbx_strdup(NULL, row[5]);
+	if (CURLE_OK != (err = curl_easy_setopt(context->easyhandle, CURLOPT_TIMEOUT,
+			(long)db_httpstep->timeout)) ||
+			CURLE_OK != (err = curl_easy_setopt(context->easyhandle, CURLOPT_URL, httpstep->url)))
+	{
+		context->err_str = zbx_strdup(context->err_str, curl_easy_strerror(err));
+		goto out;
+	}
 
-			zbx_substitute_macros(&db_httpstep.posts, NULL, 0, &macro_httptest_field_resolv,
-					um_handle_secure, host);
+	ret = SUCCEED;
+out:
+	zbx_free(buffer);
 
-			http_substitute_variables(httptest, &db_httpstep.posts);
-		}
-		else
-			db_httpstep.posts = NULL;
+	return ret;
+}
 
-		buffer = zbx_strdup(buffer, row[4]);
-		zbx_dc_expand_user_and_func_macros(um_handle_masked, &buffer, &host->hostid, 1, NULL);
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds cURL handle of web scenario to the multi stack to execute    *
+ *          the current step request                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	httptest_step_perform(zbx_httptest_poller_t *poller, zbx_httptest_context_t *context)
+{
+	CURLMcode	merr;
 
-		zbx_dc_close_user_macros(um_handle_secure);
-		zbx_dc_close_user_macros(um_handle_masked);
+	memset(&context->header, 0, sizeof(context->header));
+	memset(&context->body, 0, sizeof(context->body));
+	context->errbuf[0] = '\0';
 
-		if (SUCCEED != httpstep_load_pairs(host, &httpstep))
-		{
-			err_str = zbx_strdup(err_str, "cannot load web scenario step data");
-			goto httpstep_error;
-		}
+	if (CURLM_OK != (merr = curl_multi_add_handle(poller->asynchttppoller_config->curl_handle,
+			context->easyhandle)))
+	{
+		context->err_str = zbx_dsprintf(context->err_str, "cannot add a standard curl handle to the multi"
+				" stack: %s", curl_multi_strerror(merr));
+		return FAIL;
+	}
 
-		if (SUCCEED != zbx_is_time_suffix(buffer, &db_httpstep.timeout, ZBX_LENGTH_UNLIMITED))
-		{
-			err_str = zbx_dsprintf(err_str, "timeout \"%s\" is invalid", buffer);
-			goto httpstep_error;
-		}
-		else if (db_httpstep.timeout < 1 || SEC_PER_HOUR < db_httpstep.timeout)
-		{
-			err_str = zbx_dsprintf(err_str, "timeout \"%s\" is out of 1-3600 seconds bounds", buffer);
-			goto httpstep_error;
-		}
+	return SUCCEED;
+}
 
-		db_httpstep.follow_redirects = atoi(row[9]);
-		db_httpstep.retrieve_mode = atoi(row[10]);
+/******************************************************************************
+ *                                                                            *
+ * Purpose: starts the next step of web scenario or finishes the scenario if  *
+ *          there are no more steps or a step has failed                      *
+ *                                                                            *
+ ******************************************************************************/
+static void	httptest_next_step(zbx_httptest_poller_t *poller, zbx_httptest_context_t *context)
+{
+	while (NULL == context->err_str && context->step_index < context->steps.values_num && ZBX_IS_RUNNING())
+	{
+		if (SUCCEED == httptest_step_prepare(context) && SUCCEED == httptest_step_perform(poller, context))
+			return;
 
-		memset(&stat, 0, sizeof(stat));
+		httptest_step_clean(context);
+		context->lastfailedstep = context->db_httpstep.no;
+	}
 
-		zabbix_log(LOG_LEVEL_DEBUG, "%s() use step \"%s\"", __func__, db_httpstep.name);
-		zabbix_log(LOG_LEVEL_DEBUG, "%s() use post \"%s\"", __func__, ZBX_NULL2EMPTY_STR(httpstep.posts));
+	httptest_finish(poller, context);
+}
 
-		if (CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_POSTFIELDS, httpstep.posts)))
-		{
-			err_str = zbx_strdup(err_str, curl_easy_strerror(err));
-			goto httpstep_error;
-		}
+/******************************************************************************
+ *                                                                            *
+ * Purpose: processes response of web scenario step                           *
+ *                                                                            *
+ * Parameters: easyhandle - [IN] cURL handle of web scenario                  *
+ *             err        - [IN] request result                               *
+ *             arg        - [IN] web scenario poller                          *
+ *                                                                            *
+ ******************************************************************************/
+static void	httptest_step_done(CURL *easyhandle, CURLcode err, void *arg)
+{
+	zbx_httptest_poller_t	*poller = (zbx_httptest_poller_t *)arg;
+	zbx_httptest_context_t	*context;
+	zbx_httptest_t		*httptest;
+	zbx_httpstep_t		*httpstep;
+	zbx_httpstat_t		stat;
+	zbx_timespec_t		ts;
+	CURLcode		err_info;
 
-		if (CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_POST, (NULL != httpstep.posts &&
-				'\0' != *httpstep.posts) ? 1L : 0L)))
-		{
-			err_str = zbx_strdup(err_str, curl_easy_strerror(err));
-			goto httpstep_error;
-		}
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
-		if (CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_FOLLOWLOCATION,
-				0 == db_httpstep.follow_redirects ? 0L : 1L)))
+	if (CURLE_OK != (err_info = curl_easy_getinfo(easyhandle, CURLINFO_PRIVATE, &context)))
+	{
+		THIS_SHOULD_NEVER_HAPPEN;
+		zabbix_log(LOG_LEVEL_CRIT, "Cannot get pointer to private data: %s", curl_easy_strerror(err_info));
+
+		goto out;
+	}
+
+	curl_multi_remove_handle(poller->asynchttppoller_config->curl_handle, easyhandle);
+
+	httptest = &context->httptest;
+	httpstep = &context->httpstep;
+
+	/* try to retrieve page several times depending on number of retries */
+	if (CURLE_OK != err && 0 < --httptest->httptest.retries && ZBX_IS_RUNNING())
+	{
+		zbx_free(context->body.data);
+		zbx_free(context->header.data);
+
+		if (SUCCEED == httptest_step_perform(poller, context))
+			goto out;
+	}
+	else if (CURLE_OK == err)
+	{
+		char	*var_err_str = NULL, *data = NULL;
+
+		memset(&stat, 0, sizeof(stat));
+
+		if (NULL != context->body.data)
 		{
-			err_str = zbx_strdup(err_str, curl_easy_strerror(err));
-			goto httpstep_error;
+			zbx_http_convert_to_utf8(easyhandle, &context->body.data, &context->body.offset,
+					&context->body.allocated);
+			data = context->body.data;
 		}
 
-		if (0 != db_httpstep.follow_redirects)
+		if (NULL != context->header.data)
 		{
-			if (CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_MAXREDIRS, ZBX_CURLOPT_MAXREDIRS)))
+			if (NULL != context->body.data)
 			{
-				err_str = zbx_strdup(err_str, curl_easy_strerror(err));
-				goto httpstep_error;
+				zbx_strncpy_alloc(&context->header.data, &context->header.allocated,
+						&context->header.offset, context->body.data, context->body.offset);
 			}
+
+			data = context->header.data;
 		}
 
-		/* headers defined in a step overwrite headers defined in scenario */
-		if (NULL != httpstep.headers && '\0' != *httpstep.headers)
-			add_http_headers(httpstep.headers, &headers_slist, &header_cookie);
-		else if (NULL != httptest->headers && '\0' != *httptest->headers)
-			add_http_headers(httptest->headers, &headers_slist, &header_cookie);
+		if (NULL == data)
+			data = "";
 
-		err = curl_easy_setopt(easyhandle, CURLOPT_COOKIE, header_cookie);
-		zbx_free(header_cookie);
+		zabbix_log(LOG_LEVEL_TRACE, "%s() page.data from %s:'%s'", __func__, httpstep->url, data);
 
-		if (CURLE_OK != err)
+		/* first get the data that is needed even if step fails */
+		if (CURLE_OK != (err = curl_easy_getinfo(easyhandle, CURLINFO_RESPONSE_CODE, &stat.rspcode)))
 		{
-			err_str = zbx_strdup(err_str, curl_easy_strerror(err));
-			goto httpstep_error;
+			context->err_str = zbx_strdup(context->err_str, curl_easy_strerror(err));
 		}
-
-		if (CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_HTTPHEADER, headers_slist)))
+		else if ('\0' != *context->db_httpstep.status_codes &&
+				FAIL == zbx_int_in_list(context->db_httpstep.status_codes, stat.rspcode))
 		{
-			err_str = zbx_strdup(err_str, curl_easy_strerror(err));
-			goto httpstep_error;
+			context->err_str = zbx_dsprintf(context->err_str, "response code \"%ld\" did not match any of"
+					" the required status codes \"%s\"", stat.rspcode,
+					context->db_httpstep.status_codes);
 		}
 
-		switch (db_httpstep.retrieve_mode)
+		if (CURLE_OK != (err = curl_easy_getinfo(easyhandle, CURLINFO_TOTAL_TIME, &stat.total_time)) &&
+				NULL == context->err_str)
 		{
-			case ZBX_RETRIEVE_MODE_CONTENT:
-				curl_header_cb = zbx_curl_ignore_cb;
-				curl_body_cb = zbx_curl_write_cb;
-				break;
-			case ZBX_RETRIEVE_MODE_BOTH:
-				curl_header_cb = curl_body_cb = zbx_curl_write_cb;
-				break;
-			case ZBX_RETRIEVE_MODE_HEADERS:
-				curl_header_cb = zbx_curl_write_cb;
-				curl_body_cb = zbx_curl_ignore_cb;
-				break;
-			default:
-				THIS_SHOULD_NEVER_HAPPEN;
-				err_str = zbx_strdup(err_str, "invalid retrieve mode");
-				goto httpstep_error;
+			context->err_str = zbx_strdup(context->err_str, curl_easy_strerror(err));
 		}
 
-		if (SUCCEED != zbx_http_prepare_callbacks(easyhandle, &header, &body, curl_header_cb, curl_body_cb,
-				errbuf, &err_str))
+		if (CURLE_OK != (err = curl_easy_getinfo(easyhandle, CURLINFO_SPEED_DOWNLOAD_T,
+				&stat.speed_download)) && NULL == context->err_str)
 		{
-			goto httpstep_error;
+			context->err_str = zbx_strdup(context->err_str, curl_easy_strerror(err));
 		}
-
-		/* enable/disable fetching the body */
-		if (CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_NOBODY,
-				ZBX_RETRIEVE_MODE_HEADERS == db_httpstep.retrieve_mode ? 1L : 0L)))
+		else
 		{
-			err_str = zbx_strdup(err_str, curl_easy_strerror(err));
-			goto httpstep_error;
+			context->speed_download += (double)stat.speed_download;
+			context->speed_download_num++;
 		}
 
-		if (SUCCEED != zbx_http_prepare_auth(easyhandle, httptest->httptest.authentication,
-				httptest->httptest.http_user, httptest->httptest.http_password, NULL, &err_str))
+		/* required pattern */
+		if (NULL == context->err_str && '\0' != *context->db_httpstep.required &&
+				NULL == zbx_regexp_match(data, context->db_httpstep.required, NULL))
 		{
-			goto httpstep_error;
+			context->err_str = zbx_dsprintf(context->err_str, "required pattern \"%s\" was not found on %s",
+					context->db_httpstep.required, httpstep->url);
 		}
 
-		zabbix_log(LOG_LEVEL_DEBUG, "%s() go to URL \"%s\"", __func__, httpstep.url);
-
-		if (CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_TIMEOUT, (long)db_httpstep.timeout)) ||
-				CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_URL, httpstep.url)))
+		/* variables defined in scenario */
+		if (NULL == context->err_str && FAIL == http_process_variables(httptest, &httptest->variables, data,
+				&var_err_str))
 		{
-			err_str = zbx_strdup(err_str, curl_easy_strerror(err));
-			goto httpstep_error;
-		}
+			char	*variables = NULL;
+			size_t	alloc_len = 0, offset;
 
-		/* try to retrieve page several times depending on number of retries */
-		do
-		{
-			memset(&header, 0, sizeof(header));
-			memset(&body, 0, sizeof(body));
-			errbuf[0] = '\0';
+			httpstep_pairs_join(&variables, &alloc_len, &offset, "=", " ", &httptest->variables);
 
-			if (CURLE_OK == (err = curl_easy_perform(easyhandle)))
-				break;
+			context->err_str = zbx_dsprintf(context->err_str, "error in scenario variables \"%s\": %s",
+					variables, var_err_str);
 
-			zbx_free(body.data);
-			zbx_free(header.data);
+			zbx_free(variables);
 		}
-		while (0 < --httptest->httptest.retries);
 
-		if (CURLE_OK == err)
+		/* variables defined in a step */
+		if (NULL == context->err_str && FAIL == http_process_variables(httptest, &httpstep->variables, data,
+				&var_err_str))
 		{
-			char	*var_err_str = NULL, *data = NULL;
-
-			if (NULL != body.data)
-			{
-				zbx_http_convert_to_utf8(easyhandle, &body.data, &body.offset, &body.allocated);
-				data = body.data;
-			}
-
-			if (NULL != header.data)
-			{
-				if (NULL != body.data)
-				{
-					zbx_strncpy_alloc(&header.data, &header.allocated, &header.offset, body.data,
-							body.offset);
-				}
-
-				data = header.data;
-			}
-
-			if (NULL == data)
-				data = "";
+			char	*variables = NULL;
+			size_t	alloc_len = 0, offset;
 
-			zabbix_log(LOG_LEVEL_TRACE, "%s() page.data from %s:'%s'", __func__, httpstep.url, data);
-
-			/* first get the data that is needed even if step fails */
-			if (CURLE_OK != (err = curl_easy_getinfo(easyhandle, CURLINFO_RESPONSE_CODE, &stat.rspcode)))
-			{
-				err_str = zbx_strdup(err_str, curl_easy_strerror(err));
-			}
-			else if ('\0' != *db_httpstep.status_codes &&
-					FAIL == zbx_int_in_list(db_httpstep.status_codes, stat.rspcode))
-			{
-				err_str = zbx_dsprintf(err_str, "response code \"%ld\" did not match any of the"
-						" required status codes \"%s\"", stat.rspcode,
-						db_httpstep.status_codes);
-			}
-
-			if (CURLE_OK != (err = curl_easy_getinfo(easyhandle, CURLINFO_TOTAL_TIME, &stat.total_time)) &&
-					NULL == err_str)
-			{
-				err_str = zbx_strdup(err_str, curl_easy_strerror(err));
-			}
-
-			if (CURLE_OK != (err = curl_easy_getinfo(easyhandle, CURLINFO_SPEED_DOWNLOAD_T,
-					&stat.speed_download)) && NULL == err_str)
-			{
-				err_str = zbx_strdup(err_str, curl_easy_strerror(err));
-			}
-			else
-			{
-				speed_download += (double)stat.speed_download;
-				speed_download_num++;
-			}
-
-			/* required pattern */
-			if (NULL == err_str && '\0' != *db_httpstep.required &&
-					NULL == zbx_regexp_match(data, db_httpstep.required, NULL))
-			{
-				err_str = zbx_dsprintf(err_str, "required pattern \"%s\" was not found on %s",
-						db_httpstep.required, httpstep.url);
-			}
-
-			/* variables defined in scenario */
-			if (NULL == err_str && FAIL == http_process_variables(httptest, &httptest->variables,
-					data, &var_err_str))
-			{
-				char	*variables = NULL;
-				size_t	alloc_len = 0, offset;
+			httpstep_pairs_join(&variables, &alloc_len, &offset, "=", " ", &httpstep->variables);
 
-				httpstep_pairs_join(&variables, &alloc_len, &offset, "=", " ", &httptest->variables);
+			context->err_str = zbx_dsprintf(context->err_str, "error in step variables \"%s\": %s",
+					variables, var_err_str);
 
-				err_str = zbx_dsprintf(err_str, "error in scenario variables \"%s\": %s", variables,
-						var_err_str);
+			zbx_free(variables);
+		}
 
-				zbx_free(variables);
-			}
+		zbx_free(var_err_str);
 
-			/* variables defined in a step */
-			if (NULL == err_str && FAIL == http_process_variables(httptest, &httpstep.variables, data,
-					&var_err_str))
-			{
-				char	*variables = NULL;
-				size_t	alloc_len = 0, offset;
+		zbx_timespec(&ts);
+		process_step_data(context->db_httpstep.httpstepid, &stat, &ts);
+	}
+	else
+	{
+		context->err_str = zbx_dsprintf(context->err_str, "%s", 0 < strlen(context->errbuf) ?
+				context->errbuf : curl_easy_strerror(err));
+	}
 
-				httpstep_pairs_join(&variables, &alloc_len, &offset, "=", " ", &httpstep.variables);
+	httptest_step_clean(context);
 
-				err_str = zbx_dsprintf(err_str, "error in step variables \"%s\": %s", variables,
-						var_err_str);
+	if (NULL != context->err_str)
+		context->lastfailedstep = context->db_httpstep.no;
+	else
+		context->step_index++;
 
-				zbx_free(variables);
-			}
+	httptest_next_step(poller, context);
+out:
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
+}
 
-			zbx_free(var_err_str);
+static void	httptest_poller_action(void *arg)
+{
+	zbx_httptest_poller_t	*poller = (zbx_httptest_poller_t *)arg;
 
-			zbx_timespec(&ts);
-			process_step_data(db_httpstep.httpstepid, &stat, &ts);
+	if (NULL != poller->action_cb)
+		poller->action_cb(poller->action_arg);
+}
 
-			zbx_free(header.data);
-			zbx_free(body.data);
-		}
-		else
-			err_str = zbx_dsprintf(err_str, "%s", 0 < strlen(errbuf) ? errbuf : curl_easy_strerror(err));
-httpstep_error:
-		curl_slist_free_all(headers_slist);
-		zbx_free(db_httpstep.status_codes);
-		zbx_free(db_httpstep.required);
-		zbx_free(db_httpstep.posts);
-		zbx_free(db_httpstep.url);
+/******************************************************************************
+ *                                                                            *
+ * Purpose: creates cURL handle with web scenario level options               *
+ *                                                                            *
+ ******************************************************************************/
+static int	httptest_prepare_handle(zbx_httptest_poller_t *poller, zbx_httptest_context_t *context)
+{
+	zbx_httptest_t	*httptest = &context->httptest;
+	CURLcode	err;
 
-		httppairs_free(&httpstep.variables);
+	if (NULL == (context->easyhandle = curl_easy_init()))
+	{
+		context->err_str = zbx_strdup(context->err_str, "cannot initialize cURL library");
+		return FAIL;
+	}
 
-		if (ZBX_POSTTYPE_FORM == httpstep.httpstep->post_type)
-			zbx_free(httpstep.posts);
+	if (CURLE_OK != (err = curl_easy_setopt(context->easyhandle, CURLOPT_PROXY, httptest->httptest.http_proxy)) ||
+			CURLE_OK != (err = curl_easy_setopt(context->easyhandle, CURLOPT_COOKIEFILE, "")) ||
+			CURLE_OK != (err = curl_easy_setopt(context->easyhandle, CURLOPT_USERAGENT,
+			httptest->httptest.agent)) ||
+			CURLE_OK != (err = curl_easy_setopt(context->easyhandle, CURLOPT_ACCEPT_ENCODING, "")) ||
+			CURLE_OK != (err = curl_easy_setopt(context->easyhandle, CURLOPT_PRIVATE, context)))
+	{
+		context->err_str = zbx_strdup(context->err_str, curl_easy_strerror(err));
+		return FAIL;
+	}
 
-		zbx_free(httpstep.url);
-		zbx_free(httpstep.headers);
+	if (SUCCEED != zbx_curl_setopt_https(context->easyhandle, &context->err_str))
+		return FAIL;
 
-		if (NULL != err_str)
-		{
-			lastfailedstep = db_httpstep.no;
-			break;
-		}
+	if (SUCCEED != zbx_http_prepare_ssl(context->easyhandle, httptest->httptest.ssl_cert_file,
+			httptest->httptest.ssl_key_file, httptest->httptest.ssl_key_password,
+			httptest->httptest.verify_peer, httptest->httptest.verify_host, poller->config_source_ip,
+			poller->config_ssl_ca_location, poller->config_ssl_cert_location,
+			poller->config_ssl_key_location, &context->err_str))
+	{
+		return FAIL;
 	}
-clean:
-	curl_easy_cleanup(easyhandle);
-#else
-	ZBX_UNUSED(config_source_ip);
-	ZBX_UNUSED(config_ssl_ca_location);
-	ZBX_UNUSED(config_ssl_cert_location);
-	ZBX_UNUSED(config_ssl_key_location);
 
-	err_str = zbx_strdup(err_str, "cURL library is required for Web monitoring support");
+	return SUCCEED;
+}
 #endif	/* HAVE_LIBCURL */
 
-httptest_error:
-	zbx_timespec(&ts);
+/******************************************************************************
+ *                                                                            *
+ * Purpose: starts single scenario of HTTP test                               *
+ *                                                                            *
+ * Comments: Scenario steps are executed asynchronously one after another,    *
+ *           the scenario is finished by httptest_finish() after the last     *
+ *           step or the first failed step.                                   *
+ *                                                                            *
+ ******************************************************************************/
+static void	process_httptest(zbx_httptest_poller_t *poller, zbx_httptest_context_t *context)
+{
+	char			*buffer;
+	zbx_dc_um_handle_t	*um_handle;
 
-	if (NULL != err_str)
-	{
-		if (0 >= lastfailedstep)
-		{
-			/* we are here because web scenario update interval is invalid, */
-			/* cURL initialization failed or we have been compiled without cURL library */
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() httptestid:" ZBX_FS_UI64 " name:'%s'",
+			__func__, context->httptest.httptest.httptestid, context->httptest.httptest.name);
 
-			lastfailedstep = 1;
-		}
+	zbx_vector_httptest_context_ptr_append(&poller->contexts, context);
+	poller->processing++;
 
-		if (NULL != db_httpstep.name)
-		{
-			zabbix_log(LOG_LEVEL_DEBUG, "cannot process step \"%s\" of web scenario \"%s\" on host \"%s\": "
-					"%s", db_httpstep.name, httptest->httptest.name, host->name, err_str);
-		}
-	}
-	zbx_db_free_result(result);
+	buffer = zbx_strdup(NULL, context->httptest.httptest.delay);
 
-	if (0 != speed_download_num)
-		speed_download /= speed_download_num;
+	um_handle = zbx_dc_open_user_macros_masked();
+	zbx_dc_expand_user_and_func_macros(um_handle, &buffer, &context->host.hostid, 1, NULL);
+	zbx_dc_close_user_macros(um_handle);
 
-	process_test_data(httptest->httptest.httptestid, lastfailedstep, speed_download, err_str, &ts);
+	if (SUCCEED != zbx_is_time_suffix(buffer, &context->delay, ZBX_LENGTH_UNLIMITED))
+	{
+		context->err_str = zbx_dsprintf(context->err_str, "update interval \"%s\" is invalid", buffer);
+		context->lastfailedstep = -1;
+		context->delay = ZBX_DEFAULT_INTERVAL;
+		zbx_free(buffer);
+		httptest_finish(poller, context);
+		goto out;
+	}
 
 	zbx_free(buffer);
-	zbx_free(err_str);
-	zbx_preprocessor_flush();
 
+#ifdef HAVE_LIBCURL
+	if (SUCCEED != httptest_prepare_handle(poller, context))
+		httptest_finish(poller, context);
+	else
+		httptest_next_step(poller, context);
+#else
+	context->err_str = zbx_strdup(context->err_str, "cURL library is required for Web monitoring support");
+	httptest_finish(poller, context);
+#endif
+out:
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
 
 /******************************************************************************
  *                                                                            *
- * Parameters: now                      - [IN] current timestamp              *
+ * Purpose: creates web scenario poller                                       *
+ *                                                                            *
+ * Parameters: base                     - [IN] event base                     *
+ *             action_cb                - [IN] callback to be called before   *
+ *                                             processing network events      *
+ *             action_arg               - [IN] action callback argument       *
+ *             max_concurrent           - [IN] maximum number of scenarios    *
+ *                                             executed at once               *
  *             config_source_ip         - [IN]                                *
  *             config_ssl_ca_location   - [IN]                                *
  *             config_ssl_cert_location - [IN]                                *
  *             config_ssl_key_location  - [IN]                                *
- *             nextcheck                - [OUT]                               *
+ *             error                    - [OUT]                               *
  *                                                                            *
- * Return value: number of processed httptests                                *
- *                                                                            *
- * Comments: always SUCCEED                                                   *
+ * Return value: web scenario poller or NULL on error                         *
  *                                                                            *
  ******************************************************************************/
-int	process_httptests(int now, const char *config_source_ip, const char *config_ssl_ca_location,
-		const char *config_ssl_cert_location, const char *config_ssl_key_location, time_t *nextcheck)
+zbx_httptest_poller_t	*zbx_httptest_poller_create(struct event_base *base, zbx_httptest_action_cb_t action_cb,
+		void *action_arg, int max_concurrent, const char *config_source_ip, const char *config_ssl_ca_location,
+		const char *config_ssl_cert_location, const char *config_ssl_key_location, char **error)
 {
-	zbx_db_result_t		result;
-	zbx_db_row_t		row;
-	zbx_uint64_t		httptestid;
-	zbx_httptest_t		httptest;
-	zbx_dc_host_t		host;
-	int			httptests_count = 0;
+	zbx_httptest_poller_t	*poller;
 
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
+	poller = (zbx_httptest_poller_t *)zbx_malloc(NULL, sizeof(zbx_httptest_poller_t));
+	memset(poller, 0, sizeof(zbx_httptest_poller_t));
 
-	if (SUCCEED != zbx_dc_httptest_next(now, &httptestid, nextcheck))
-		goto out;
+	poller->max_concurrent = max_concurrent;
+	poller->action_cb = action_cb;
+	poller->action_arg = action_arg;
+	poller->config_source_ip = config_source_ip;
+	poller->config_ssl_ca_location = config_ssl_ca_location;
+	poller->config_ssl_cert_location = config_ssl_cert_location;
+	poller->config_ssl_key_location = config_ssl_key_location;
 
-	/* create macro cache to use in HTTP tests */
-	zbx_vector_ptr_pair_create(&httptest.macros);
+	zbx_vector_httptest_context_ptr_create(&poller->contexts);
 
-	do
-	{
-		int	delay = 0;
-
-		result = zbx_db_select(
-				"select h.hostid,h.host,h.name,t.httptestid,t.name,t.agent,"
-					"t.authentication,t.http_user,t.http_password,t.http_proxy,t.retries,"
-					"t.ssl_cert_file,t.ssl_key_file,t.ssl_key_password,t.verify_peer,"
-					"t.verify_host,t.delay"
-				" from httptest t,hosts h"
-				" where t.hostid=h.hostid"
-					" and t.httptestid=" ZBX_FS_UI64,
-				httptestid);
-
-		if (NULL != (row = zbx_db_fetch(result)))
-		{
-			ZBX_STR2UINT64(host.hostid, row[0]);
-			zbx_strscpy(host.host, row[1]);
-			zbx_strlcpy_utf8(host.name, row[2], sizeof(host.name));
-
-			ZBX_STR2UINT64(httptest.httptest.httptestid, row[3]);
-			httptest.httptest.name = row[4];
-
-			if (SUCCEED != httptest_load_pairs(&host, &httptest))
-			{
-				zabbix_log(LOG_LEVEL_WARNING, "cannot process web scenario \"%s\" on host \"%s\": "
-						"cannot load web scenario data", httptest.httptest.name, host.name);
-				zbx_db_free_result(result);
-				THIS_SHOULD_NEVER_HAPPEN;
-				continue;
-			}
+#ifdef HAVE_LIBCURL
+	zbx_async_httpagent_init();
 
-			zbx_dc_um_handle_t	*um_handle_masked = zbx_dc_open_user_macros_masked();
-			zbx_dc_um_handle_t	*um_handle_secure = zbx_dc_open_user_macros_secure();
+	if (NULL == (poller->asynchttppoller_config = zbx_async_httpagent_create(base, httptest_step_done,
+			httptest_poller_action, poller, error)))
+	{
+		zbx_vector_httptest_context_ptr_destroy(&poller->contexts);
+		zbx_free(poller);
 
-			httptest.httptest.agent = zbx_strdup(NULL, row[5]);
-			zbx_dc_expand_user_and_func_macros(um_handle_masked, &httptest.httptest.agent, &host.hostid, 1,
-					NULL);
+		return NULL;
+	}
+#else
+	ZBX_UNUSED(base);
+	ZBX_UNUSED(error);
+#endif
+	return poller;
+}
 
-			if (HTTPTEST_AUTH_NONE != (httptest.httptest.authentication = atoi(row[6])))
-			{
-				httptest.httptest.http_user = zbx_strdup(NULL, row[7]);
-				zbx_dc_expand_user_and_func_macros(um_handle_secure, &httptest.httptest.http_user,
-						&host.hostid, 1, NULL);
+/******************************************************************************
+ *                                                                            *
+ * Purpose: destroys web scenario poller, unfinished scenarios are dropped    *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_httptest_poller_destroy(zbx_httptest_poller_t *poller)
+{
+	for (int i = 0; i < poller->contexts.values_num; i++)
+	{
+		zbx_httptest_context_t	*context = poller->contexts.values[i];
 
-				httptest.httptest.http_password = zbx_strdup(NULL, row[8]);
-				zbx_dc_expand_user_and_func_macros(um_handle_secure, &httptest.httptest.http_password,
-						&host.hostid, 1, NULL);
-			}
+#ifdef HAVE_LIBCURL
+		curl_multi_remove_handle(poller->asynchttppoller_config->curl_handle, context->easyhandle);
+		httptest_step_clean(context);
+#endif
+		httptest_context_free(context);
+	}
 
-			if ('\0' != *row[9])
-			{
-				httptest.httptest.http_proxy = zbx_strdup(NULL, row[9]);
-				zbx_dc_expand_user_and_func_macros(um_handle_masked, &httptest.httptest.http_proxy,
-						&host.hostid, 1, NULL);
-			}
-			else
-				httptest.httptest.http_proxy = NULL;
+	zbx_vector_httptest_context_ptr_destroy(&poller->contexts);
 
-			httptest.httptest.retries = atoi(row[10]);
+#ifdef HAVE_LIBCURL
+	zbx_async_httpagent_clean(poller->asynchttppoller_config);
+	zbx_free(poller->asynchttppoller_config);
+#endif
+	zbx_free(poller);
+}
 
-			httptest.httptest.ssl_cert_file = zbx_strdup(NULL, row[11]);
-			httptest.httptest.ssl_key_file = zbx_strdup(NULL, row[12]);
+/******************************************************************************
+ *                                                                            *
+ * Purpose: returns the number of web scenarios being executed                *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_httptest_poller_processing(const zbx_httptest_poller_t *poller)
+{
+	return poller->processing;
+}
 
-			zbx_substitute_macros(&httptest.httptest.ssl_cert_file, NULL, 0, &macro_httptest_field_resolv,
-					um_handle_masked, &host);
-			zbx_substitute_macros(&httptest.httptest.ssl_key_file, NULL, 0, &macro_httptest_field_resolv,
-					um_handle_masked, &host);
+/******************************************************************************
+ *                                                                            *
+ * Purpose: returns the number of web scenarios finished since the last call  *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_httptest_poller_pop_processed(zbx_httptest_poller_t *poller)
+{
+	int	processed = poller->processed;
 
-			httptest.httptest.ssl_key_password = zbx_strdup(NULL, row[13]);
-			zbx_dc_expand_user_and_func_macros(um_handle_secure, &httptest.httptest.ssl_key_password,
-					&host.hostid, 1, NULL);
+	poller->processed = 0;
 
-			zbx_dc_close_user_macros(um_handle_secure);
-			zbx_dc_close_user_macros(um_handle_masked);
+	return processed;
+}
 
-			httptest.httptest.verify_peer = atoi(row[14]);
-			httptest.httptest.verify_host = atoi(row[15]);
+/******************************************************************************
+ *                                                                            *
+ * Purpose: starts web scenarios scheduled for execution                      *
+ *                                                                            *
+ * Parameters: poller    - [IN] web scenario poller                           *
+ *             now       - [IN] current timestamp                             *
+ *             nextcheck - [OUT] the time of the next scheduled scenario,     *
+ *                               0 if there are no scheduled scenarios        *
+ *                                                                            *
+ * Return value: number of started httptests                                  *
+ *                                                                            *
+ * Comments: Scenarios are started until the limit of concurrently executed   *
+ *           scenarios is reached, in which case nextcheck is set to now.     *
+ *                                                                            *
+ ******************************************************************************/
+int	process_httptests(zbx_httptest_poller_t *poller, int now, time_t *nextcheck)
+{
+	zbx_uint64_t		httptestid;
+	zbx_httptest_context_t	*context;
+	int			httptests_count = 0;
 
-			httptest.httptest.delay = row[16];
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
-			/* add httptest variables to the current test macro cache */
-			http_process_variables(&httptest, &httptest.variables, NULL, NULL);
+	*nextcheck = 0;
 
-			process_httptest(&host, &httptest, &delay, config_source_ip, config_ssl_ca_location,
-					config_ssl_cert_location, config_ssl_key_location);
-			zbx_dc_httptest_queue(now, httptestid, delay);
+	while (ZBX_IS_RUNNING())
+	{
+		if (poller->processing >= poller->max_concurrent)
+		{
+			*nextcheck = now;
+			break;
+		}
 
-			zbx_free(httptest.httptest.ssl_key_password);
-			zbx_free(httptest.httptest.ssl_key_file);
-			zbx_free(httptest.httptest.ssl_cert_file);
-			zbx_free(httptest.httptest.http_proxy);
+		if (SUCCEED != zbx_dc_httptest_next(now, &httptestid, nextcheck))
+			break;
 
-			if (HTTPTEST_AUTH_NONE != httptest.httptest.authentication)
-			{
-				zbx_free(httptest.httptest.http_password);
-				zbx_free(httptest.httptest.http_user);
-			}
-			zbx_free(httptest.httptest.agent);
-			zbx_free(httptest.headers);
-			httppairs_free(&httptest.variables);
+		if (NULL == (context = httptest_context_load(httptestid, now)))
+			continue;
 
-			/* clear the macro cache used in this HTTP test */
-			httptest_remove_macros(&httptest);
+		process_httptest(poller, context);
 
-			httptests_count++;	/* performance metric */
-		}
-		zbx_db_free_result(result);
+		httptests_count++;	/* performance metric */
 	}
-	while (ZBX_IS_RUNNING() && SUCCEED == zbx_dc_httptest_next(now, &httptestid, nextcheck));
 
-	/* destroy the macro cache used in HTTP tests */
-	zbx_vector_ptr_pair_destroy(&httptest.macros);
-out:
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s() started:%d processing:%d", __func__, httptests_count,
+			poller->processing);
 
 	return httptests_count;
 }
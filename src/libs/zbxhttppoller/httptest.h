@@ -17,7 +17,19 @@
 
 #include "zbxcommon.h"
 
-int	process_httptests(int now, const char *config_source_ip, const char *config_ssl_ca_location,
-		const char *config_ssl_cert_location, const char *config_ssl_key_location, time_t *nextcheck);
+#include <event2/event.h>
+
+typedef struct zbx_httptest_poller zbx_httptest_poller_t;
+
+typedef void (*zbx_httptest_action_cb_t)(void *arg);
+
+zbx_httptest_poller_t	*zbx_httptest_poller_create(struct event_base *base, zbx_httptest_action_cb_t action_cb,
+		void *action_arg, int max_concurrent, const char *config_source_ip, const char *config_ssl_ca_location,
+		const char *config_ssl_cert_location, const char *config_ssl_key_location, char **error);
+void	zbx_httptest_poller_destroy(zbx_httptest_poller_t *poller);
+int	zbx_httptest_poller_processing(const zbx_httptest_poller_t *poller);
+int	zbx_httptest_poller_pop_processed(zbx_httptest_poller_t *poller);
+
+int	process_httptests(zbx_httptest_poller_t *poller, int now, time_t *nextcheck);
 
 #endif
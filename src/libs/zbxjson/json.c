@@ -20,6 +20,20 @@
 
 #include "zbxnum.h"
 
+#if defined(__SSE2__) && (defined(__GNUC__) || defined(__clang__))
+#	include <emmintrin.h>
+#	define JSON_SCAN_SSE2
+#	if defined(__has_attribute)
+#		if __has_attribute(no_sanitize_address)
+#			define JSON_NO_SANITIZE_ADDRESS	__attribute__((no_sanitize_address))
+#		endif
+#	endif
+#endif
+
+#if !defined(JSON_NO_SANITIZE_ADDRESS)
+#	define JSON_NO_SANITIZE_ADDRESS
+#endif
+
 /******************************************************************************
  *                                                                            *
  * Purpose: return string describing json error                               *
@@ -583,6 +597,91 @@ static zbx_json_type_t	__zbx_json_type(const char *p)
 	return ZBX_JSON_TYPE_UNKNOWN;
 }
 
+/* string characters that need attention - quote, escape and control characters including terminating zero */
+#define JSON_IS_STRING_SPECIAL(c)	('"' == (c) || '\\' == (c) || 0x1f >= (unsigned char)(c))
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: skips plain characters inside JSON string                         *
+ *                                                                            *
+ * Parameters: p - [IN] pointer inside JSON string                            *
+ *                                                                            *
+ * Return value: pointer to the first quote, backslash or control character   *
+ *               (including the terminating zero)                             *
+ *                                                                            *
+ * Comments: With SSE2 the string is checked 16 bytes at a time. Aligned      *
+ *           loads never cross page boundary, so reading past terminating     *
+ *           zero is safe, but the function must be excluded from address     *
+ *           sanitizer instrumentation.                                       *
+ *                                                                            *
+ ******************************************************************************/
+JSON_NO_SANITIZE_ADDRESS
+const char	*json_scan_string(const char *p)
+{
+#if defined(JSON_SCAN_SSE2)
+	__m128i	quote, backslash, control;
+
+	for (; 0 != ((uintptr_t)p & 15); p++)
+	{
+		if (JSON_IS_STRING_SPECIAL(*p))
+			return p;
+	}
+
+	quote = _mm_set1_epi8('"');
+	backslash = _mm_set1_epi8('\\');
+	control = _mm_set1_epi8(0x1f);
+
+	for (;; p += 16)
+	{
+		__m128i	chunk, special;
+		int	mask;
+
+		chunk = _mm_load_si128((const __m128i *)p);
+
+		/* unsigned byte <= 0x1f if max(byte, 0x1f) == 0x1f */
+		special = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)),
+				_mm_cmpeq_epi8(_mm_max_epu8(chunk, control), control));
+
+		if (0 != (mask = _mm_movemask_epi8(special)))
+			return p + __builtin_ctz((unsigned int)mask);
+	}
+#else
+	while (!JSON_IS_STRING_SPECIAL(*p))
+		p++;
+
+	return p;
+#endif
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: finds end of JSON string                                          *
+ *                                                                            *
+ * Parameters: p - [IN] pointer to the opening quote                          *
+ *                                                                            *
+ * Return value: pointer to the closing quote or terminating zero if string   *
+ *               is not terminated                                            *
+ *                                                                            *
+ ******************************************************************************/
+static const char	*json_skip_string(const char *p)
+{
+	for (p++;; p++)
+	{
+		p = json_scan_string(p);
+
+		switch (*p)
+		{
+			case '"':
+			case '\0':
+				return p;
+			case '\\':
+				if ('\0' == *++p)
+					return p;
+				break;
+		}
+	}
+}
+
 /******************************************************************************
  *                                                                            *
  * Return value: position of the right bracket                                *
@@ -592,7 +691,6 @@ static zbx_json_type_t	__zbx_json_type(const char *p)
 static const char	*__zbx_json_rbracket(const char *p)
 {
 	int	level = 0;
-	int	state = 0; /* 0 - outside string; 1 - inside string */
 	char	lbracket, rbracket;
 
 	assert(p);
@@ -609,26 +707,18 @@ static const char	*__zbx_json_rbracket(const char *p)
 		switch (*p)
 		{
 			case '"':
-				state = (0 == state ? 1 : 0);
-				break;
-			case '\\':
-				if (1 == state)
-					if ('\0' == *++p)
-						return NULL;
+				if ('\0' == *(p = json_skip_string(p)))
+					return NULL;
 				break;
 			case '[':
 			case '{':
-				if (0 == state)
-					level++;
+				level++;
 				break;
 			case ']':
 			case '}':
-				if (0 == state)
-				{
-					level--;
-					if (0 == level)
-						return (rbracket == *p ? p : NULL);
-				}
+				level--;
+				if (0 == level)
+					return (rbracket == *p ? p : NULL);
 				break;
 		}
 		p++;
@@ -692,7 +782,6 @@ int	zbx_json_open(const char *buffer, struct zbx_json_parse *jp)
 const char	*zbx_json_next(const struct zbx_json_parse *jp, const char *p)
 {
 	int	level = 0;
-	int	state = 0;	/* 0 - outside string; 1 - inside string */
 
 	if (1 == jp->end - jp->start)	/* empty object or array */
 		return NULL;
@@ -709,28 +798,21 @@ const char	*zbx_json_next(const struct zbx_json_parse *jp, const char *p)
 		switch (*p)
 		{
 			case '"':
-				state = (0 == state) ? 1 : 0;
-				break;
-			case '\\':
-				if (1 == state)
-					p++;
+				if ('\0' == *(p = json_skip_string(p)))
+					return NULL;
 				break;
 			case '[':
 			case '{':
-				if (0 == state)
-					level++;
+				level++;
 				break;
 			case ']':
 			case '}':
-				if (0 == state)
-				{
-					if (0 == level)
-						return NULL;
-					level--;
-				}
+				if (0 == level)
+					return NULL;
+				level--;
 				break;
 			case ',':
-				if (0 == state && 0 == level)
+				if (0 == level)
 				{
 					p++;
 					SKIP_WHITESPACE(p);
@@ -935,6 +1017,22 @@ const char	*json_copy_string(const char *p, char *out, size_t size)
 	{
 		unsigned int	nbytes, i;
 		unsigned char	uc[4];	/* decoded Unicode character takes 1-4 bytes in UTF-8 */
+		const char	*plain_end;
+
+		/* copy plain characters in bulk */
+		if (p != (plain_end = json_scan_string(p)))
+		{
+			size_t	plain_len = (size_t)(plain_end - p);
+
+			if ((size_t)(out - start) + plain_len >= size)
+				return NULL;
+
+			memcpy(out, p, plain_len);
+			out += plain_len;
+			p = plain_end;
+
+			continue;
+		}
 
 		switch (*p)
 		{
@@ -1204,6 +1302,175 @@ int	zbx_json_brackets_by_name(const struct zbx_json_parse *jp, const char *name,
 	return SUCCEED;
 }
 
+/* smaller objects are faster to rescan than to index */
+#define ZBX_JSON_INDEX_MIN_SIZE	256
+
+typedef struct
+{
+	char		*name;
+	const char	*value;
+}
+zbx_json_index_pair_t;
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: initializes object member index                                   *
+ *                                                                            *
+ * Parameters: index - [OUT] index to initialize                              *
+ *             jp    - [IN] JSON object to index                              *
+ *                                                                            *
+ * Comments: The index is built on first lookup with single pass over object  *
+ *           members, all following lookups are hashset searches instead of   *
+ *           rescanning the object. Objects smaller than                      *
+ *           ZBX_JSON_INDEX_MIN_SIZE bytes are not indexed and looked up by   *
+ *           scanning. The parsed JSON buffer must stay valid until index is  *
+ *           destroyed.                                                       *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_json_index_init(zbx_json_index_t *index, const struct zbx_json_parse *jp)
+{
+	index->jp = *jp;
+	index->indexed = 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: frees resources allocated by object member index                  *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_json_index_destroy(zbx_json_index_t *index)
+{
+	zbx_hashset_iter_t	iter;
+	zbx_json_index_pair_t	*pair;
+
+	if (0 == index->indexed)
+		return;
+
+	zbx_hashset_iter_reset(&index->pairs, &iter);
+	while (NULL != (pair = (zbx_json_index_pair_t *)zbx_hashset_iter_next(&iter)))
+		zbx_free(pair->name);
+
+	zbx_hashset_destroy(&index->pairs);
+	index->indexed = 0;
+}
+
+static void	json_index_build(zbx_json_index_t *index)
+{
+	char			buffer[MAX_STRING_LEN];
+	const char		*p = NULL;
+	zbx_json_index_pair_t	pair_local;
+
+	zbx_hashset_create(&index->pairs, 16, ZBX_DEFAULT_STRING_PTR_HASH_FUNC, ZBX_DEFAULT_STR_COMPARE_FUNC);
+
+	while (NULL != (p = zbx_json_pair_next(&index->jp, p, buffer, sizeof(buffer))))
+	{
+		pair_local.name = buffer;
+
+		/* keep the first occurrence of duplicate names, same as zbx_json_pair_by_name() */
+		if (NULL != zbx_hashset_search(&index->pairs, &pair_local))
+			continue;
+
+		pair_local.name = zbx_strdup(NULL, buffer);
+		pair_local.value = p;
+		zbx_hashset_insert(&index->pairs, &pair_local, sizeof(pair_local));
+	}
+
+	index->indexed = 1;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: find pair by name in indexed object and return pointer to value   *
+ *                                                                            *
+ * Return value: pointer to value                                             *
+ *        {"name":["a","b",...]}                                              *
+ *                ^ - returned pointer                                        *
+ *                                                                            *
+ ******************************************************************************/
+const char	*zbx_json_index_pair_by_name(zbx_json_index_t *index, const char *name)
+{
+	zbx_json_index_pair_t	*pair, pair_local;
+
+	if (0 == index->indexed)
+	{
+		if (ZBX_JSON_INDEX_MIN_SIZE > index->jp.end - index->jp.start)
+			return zbx_json_pair_by_name(&index->jp, name);
+
+		json_index_build(index);
+	}
+
+	pair_local.name = (char *)name;
+
+	if (NULL == (pair = (zbx_json_index_pair_t *)zbx_hashset_search(&index->pairs, &pair_local)))
+	{
+		zbx_set_json_strerror("cannot find pair with name \"%s\"", name);
+		return NULL;
+	}
+
+	return pair->value;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: return value by pair name from indexed object                     *
+ *                                                                            *
+ * Return value: SUCCEED - if value successfully parsed, FAIL - otherwise     *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_json_index_value_by_name(zbx_json_index_t *index, const char *name, char *string, size_t len,
+		zbx_json_type_t *type)
+{
+	const char	*p;
+
+	if (NULL == (p = zbx_json_index_pair_by_name(index, name)))
+		return FAIL;
+
+	if (NULL == zbx_json_decodevalue(p, string, len, type))
+		return FAIL;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: return value by pair name from indexed object                     *
+ *                                                                            *
+ * Return value: SUCCEED - if value successfully parsed, FAIL - otherwise     *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_json_index_value_by_name_dyn(zbx_json_index_t *index, const char *name, char **string,
+		size_t *string_alloc, zbx_json_type_t *type)
+{
+	const char	*p;
+
+	if (NULL == (p = zbx_json_index_pair_by_name(index, name)))
+		return FAIL;
+
+	if (NULL == zbx_json_decodevalue_dyn(p, string, string_alloc, type))
+		return FAIL;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Return value: SUCCESS - processed successfully                             *
+ *               FAIL - an error occurred                                     *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_json_index_brackets_by_name(zbx_json_index_t *index, const char *name, struct zbx_json_parse *out)
+{
+	const char	*p;
+
+	if (NULL == (p = zbx_json_index_pair_by_name(index, name)))
+		return FAIL;
+
+	if (FAIL == zbx_json_brackets_open(p, out))
+		return FAIL;
+
+	return SUCCEED;
+}
+
 /******************************************************************************
  *                                                                            *
  * Return value: SUCCESS - if object is empty                                 *
@@ -69,7 +69,7 @@ static zbx_int64_t	json_parse_string(const char *start, char **str, char **error
 	/* skip starting '"' */
 	ptr++;
 
-	while ('"' != *ptr)
+	while ('"' != *(ptr = json_scan_string(ptr)))
 	{
 		/* unexpected end of string data, failing */
 		if ('\0' == *ptr)
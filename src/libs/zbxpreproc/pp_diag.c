@@ -77,11 +77,13 @@ int	zbx_diag_add_preproc_info(const struct zbx_json_parse *jp, struct zbx_json *
 		if (0 != (fields & ZBX_DIAG_PREPROC_SIMPLE))
 		{
 			zbx_uint64_t	preproc_num, pending_num, finished_num, sequences_num, queued_num, queued_sz,
-					direct_num, direct_sz;
+					direct_num, direct_sz, regexp_hits, regexp_misses, lock_num, lock_contended_num,
+					stolen_num;
 
 			time1 = zbx_time();
 			if (FAIL == (ret = zbx_preprocessor_get_diag_stats(&preproc_num, &pending_num, &finished_num,
-					&sequences_num, &queued_num, &queued_sz, &direct_num, &direct_sz, error)))
+					&sequences_num, &queued_num, &queued_sz, &direct_num, &direct_sz, &regexp_hits,
+					&regexp_misses, &lock_num, &lock_contended_num, &stolen_num, error)))
 			{
 				goto out;
 			}
@@ -99,6 +101,11 @@ int	zbx_diag_add_preproc_info(const struct zbx_json_parse *jp, struct zbx_json *
 				zbx_json_adduint64(json, "queued size", queued_sz);
 				zbx_json_adduint64(json, "direct count", direct_num);
 				zbx_json_adduint64(json, "direct size", direct_sz);
+				zbx_json_adduint64(json, "regexp cache hits", regexp_hits);
+				zbx_json_adduint64(json, "regexp cache misses", regexp_misses);
+				zbx_json_adduint64(json, "queue locks", lock_num);
+				zbx_json_adduint64(json, "queue lock contentions", lock_contended_num);
+				zbx_json_adduint64(json, "stolen tasks", stolen_num);
 			}
 		}
 
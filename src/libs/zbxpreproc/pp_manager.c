@@ -662,12 +662,33 @@ zbx_hashset_t  *zbx_pp_manager_items(zbx_pp_manager_t *manager)
  *                                                                            *
  ******************************************************************************/
 static void	zbx_pp_manager_get_diag_stats(zbx_pp_manager_t *manager, zbx_uint64_t *preproc_num,
-		zbx_uint64_t *pending_num, zbx_uint64_t *finished_num, zbx_uint64_t *sequences_num)
+		zbx_uint64_t *pending_num, zbx_uint64_t *finished_num, zbx_uint64_t *sequences_num,
+		zbx_uint64_t *regexp_hits, zbx_uint64_t *regexp_misses, zbx_uint64_t *lock_num,
+		zbx_uint64_t *lock_contended_num, zbx_uint64_t *stolen_num)
 {
+	int	i;
+
 	*preproc_num = (zbx_uint64_t)manager->items.num_data;
 	*pending_num = manager->queue.pending_num;
 	*finished_num = manager->queue.finished_num;
 	*sequences_num = (zbx_uint64_t)manager->queue.sequences.num_data;
+
+	*regexp_hits = 0;
+	*regexp_misses = 0;
+
+	pp_task_queue_lock(&manager->queue);
+
+	for (i = 0; i < manager->workers_num; i++)
+	{
+		*regexp_hits += manager->workers[i].regexp_cache_hits;
+		*regexp_misses += manager->workers[i].regexp_cache_misses;
+	}
+
+	*lock_num = manager->queue.lock_num;
+	*lock_contended_num = manager->queue.lock_contended_num;
+	*stolen_num = manager->queue.stolen_num;
+
+	pp_task_queue_unlock(&manager->queue);
 }
 
 /******************************************************************************
@@ -1026,13 +1047,16 @@ static void	preprocessor_flush_tasks(zbx_pp_manager_t *manager, zbx_vector_pp_ta
 static void	preprocessor_reply_diag_info(zbx_pp_manager_t *manager, zbx_ipc_client_t *client,
 		zbx_uint64_t queued_num, zbx_uint64_t queued_sz, zbx_uint64_t direct_num, zbx_uint64_t direct_sz)
 {
-	zbx_uint64_t	preproc_num, pending_num, finished_num, sequences_num;
+	zbx_uint64_t	preproc_num, pending_num, finished_num, sequences_num, regexp_hits, regexp_misses, lock_num,
+			lock_contended_num, stolen_num;
 	unsigned char	*data;
 	zbx_uint32_t	data_len;
 
-	zbx_pp_manager_get_diag_stats(manager, &preproc_num, &pending_num, &finished_num, &sequences_num);
+	zbx_pp_manager_get_diag_stats(manager, &preproc_num, &pending_num, &finished_num, &sequences_num,
+			&regexp_hits, &regexp_misses, &lock_num, &lock_contended_num, &stolen_num);
 	data_len = zbx_preprocessor_pack_diag_stats(&data, preproc_num, pending_num, finished_num, sequences_num,
-			queued_num, queued_sz, direct_num, direct_sz);
+			queued_num, queued_sz, direct_num, direct_sz, regexp_hits, regexp_misses, lock_num,
+			lock_contended_num, stolen_num);
 
 	zbx_ipc_client_send(client, ZBX_IPC_PREPROCESSOR_DIAG_STATS_RESULT, data, data_len);
 
@@ -487,11 +487,20 @@ zbx_uint32_t	zbx_preprocessor_pack_test_result(unsigned char **data, const zbx_p
  *                               require preprocessing                        *
  *             direct_sz     - [IN] size of queued values that do not         *
  *                               require preprocessing                        *
+ *             regexp_hits   - [IN] number of regexps found in workers'       *
+ *                               regexp cache                                 *
+ *             regexp_misses - [IN] number of regexps compiled by workers     *
+ *             lock_num      - [IN] number of task queue locks                *
+ *             lock_contended_num - [IN] number of task queue locks that had  *
+ *                               to wait for other thread                     *
+ *             stolen_num    - [IN] number of tasks stolen by idle workers    *
  *                                                                            *
  ******************************************************************************/
 zbx_uint32_t	zbx_preprocessor_pack_diag_stats(unsigned char **data, zbx_uint64_t preproc_num,
 		zbx_uint64_t pending_num, zbx_uint64_t finished_num, zbx_uint64_t sequences_num,
-		zbx_uint64_t queued_num, zbx_uint64_t queued_sz, zbx_uint64_t direct_num, zbx_uint64_t direct_sz)
+		zbx_uint64_t queued_num, zbx_uint64_t queued_sz, zbx_uint64_t direct_num, zbx_uint64_t direct_sz,
+		zbx_uint64_t regexp_hits, zbx_uint64_t regexp_misses, zbx_uint64_t lock_num,
+		zbx_uint64_t lock_contended_num, zbx_uint64_t stolen_num)
 {
 	unsigned char	*ptr;
 	zbx_uint32_t	data_len = 0;
@@ -504,6 +513,11 @@ zbx_uint32_t	zbx_preprocessor_pack_diag_stats(unsigned char **data, zbx_uint64_t
 	zbx_serialize_prepare_value(data_len, queued_sz);
 	zbx_serialize_prepare_value(data_len, direct_num);
 	zbx_serialize_prepare_value(data_len, direct_sz);
+	zbx_serialize_prepare_value(data_len, regexp_hits);
+	zbx_serialize_prepare_value(data_len, regexp_misses);
+	zbx_serialize_prepare_value(data_len, lock_num);
+	zbx_serialize_prepare_value(data_len, lock_contended_num);
+	zbx_serialize_prepare_value(data_len, stolen_num);
 
 	*data = (unsigned char *)zbx_malloc(NULL, data_len);
 
@@ -515,7 +529,12 @@ zbx_uint32_t	zbx_preprocessor_pack_diag_stats(unsigned char **data, zbx_uint64_t
 	ptr += zbx_serialize_value(ptr, queued_num);
 	ptr += zbx_serialize_value(ptr, queued_sz);
 	ptr += zbx_serialize_value(ptr, direct_num);
-	(void)zbx_serialize_value(ptr, direct_sz);
+	ptr += zbx_serialize_value(ptr, direct_sz);
+	ptr += zbx_serialize_value(ptr, regexp_hits);
+	ptr += zbx_serialize_value(ptr, regexp_misses);
+	ptr += zbx_serialize_value(ptr, lock_num);
+	ptr += zbx_serialize_value(ptr, lock_contended_num);
+	(void)zbx_serialize_value(ptr, stolen_num);
 
 	return data_len;
 }
@@ -767,13 +786,21 @@ void	zbx_preprocessor_unpack_test_result(zbx_vector_pp_result_ptr_t *results, zb
  *                               require preprocessing                        *
  *             direct_sz     - [OUT] size of queued values that do not        *
  *                               require preprocessing                        *
+ *             regexp_hits   - [OUT] number of regexps found in workers'      *
+ *                               regexp cache                                 *
+ *             regexp_misses - [OUT] number of regexps compiled by workers    *
+ *             lock_num      - [OUT] number of task queue locks               *
+ *             lock_contended_num - [OUT] number of task queue locks that had *
+ *                               to wait for other thread                     *
+ *             stolen_num    - [OUT] number of tasks stolen by idle workers   *
  *             data          - [OUT] data buffer                              *
  *                                                                            *
  ******************************************************************************/
 void	zbx_preprocessor_unpack_diag_stats(zbx_uint64_t *preproc_num, zbx_uint64_t *pending_num,
 		zbx_uint64_t *finished_num, zbx_uint64_t *sequences_num, zbx_uint64_t *queued_num,
 		zbx_uint64_t *queued_sz, zbx_uint64_t *direct_num, zbx_uint64_t *direct_sz,
-		const unsigned char *data)
+		zbx_uint64_t *regexp_hits, zbx_uint64_t *regexp_misses, zbx_uint64_t *lock_num,
+		zbx_uint64_t *lock_contended_num, zbx_uint64_t *stolen_num, const unsigned char *data)
 {
 	const unsigned char	*offset = data;
 
@@ -784,7 +811,12 @@ void	zbx_preprocessor_unpack_diag_stats(zbx_uint64_t *preproc_num, zbx_uint64_t
 	offset += zbx_deserialize_value(offset, queued_num);
 	offset += zbx_deserialize_value(offset, queued_sz);
 	offset += zbx_deserialize_value(offset, direct_num);
-	(void)zbx_deserialize_value(offset, direct_sz);
+	offset += zbx_deserialize_value(offset, direct_sz);
+	offset += zbx_deserialize_value(offset, regexp_hits);
+	offset += zbx_deserialize_value(offset, regexp_misses);
+	offset += zbx_deserialize_value(offset, lock_num);
+	offset += zbx_deserialize_value(offset, lock_contended_num);
+	(void)zbx_deserialize_value(offset, stolen_num);
 }
 
 /******************************************************************************
@@ -1201,7 +1233,9 @@ out:
  ******************************************************************************/
 int	zbx_preprocessor_get_diag_stats(zbx_uint64_t *preproc_num, zbx_uint64_t *pending_num,
 		zbx_uint64_t *finished_num, zbx_uint64_t *sequences_num, zbx_uint64_t *queued_num,
-		zbx_uint64_t *queued_sz, zbx_uint64_t *direct_num, zbx_uint64_t *direct_sz, char **error)
+		zbx_uint64_t *queued_sz, zbx_uint64_t *direct_num, zbx_uint64_t *direct_sz,
+		zbx_uint64_t *regexp_hits, zbx_uint64_t *regexp_misses, zbx_uint64_t *lock_num,
+		zbx_uint64_t *lock_contended_num, zbx_uint64_t *stolen_num, char **error)
 {
 	unsigned char	*result;
 
@@ -1212,7 +1246,8 @@ int	zbx_preprocessor_get_diag_stats(zbx_uint64_t *preproc_num, zbx_uint64_t *pen
 	}
 
 	zbx_preprocessor_unpack_diag_stats(preproc_num, pending_num, finished_num, sequences_num, queued_num,
-			queued_sz, direct_num, direct_sz, result);
+			queued_sz, direct_num, direct_sz, regexp_hits, regexp_misses, lock_num, lock_contended_num,
+			stolen_num, result);
 	zbx_free(result);
 
 	return SUCCEED;
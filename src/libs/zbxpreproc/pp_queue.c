@@ -50,6 +50,11 @@ int	pp_task_queue_init(zbx_pp_queue_t *queue, char **error)
 	queue->pending_num = 0;
 	queue->finished_num = 0;
 	queue->processing_num = 0;
+	queue->steal_index = 0;
+	queue->lock_num = 0;
+	queue->lock_contended_num = 0;
+	queue->stolen_num = 0;
+	zbx_vector_ptr_create(&queue->locals);
 	zbx_list_create(&queue->pending);
 	zbx_list_create(&queue->immediate);
 	zbx_list_create(&queue->finished);
@@ -114,6 +119,7 @@ void	pp_task_queue_destroy(zbx_pp_queue_t *queue)
 	zbx_list_destroy(&queue->finished);
 
 	zbx_hashset_destroy(&queue->sequences);
+	zbx_vector_ptr_destroy(&queue->locals);
 
 	queue->init_flags = PP_TASK_QUEUE_INIT_NONE;
 }
@@ -122,10 +128,19 @@ void	pp_task_queue_destroy(zbx_pp_queue_t *queue)
  *                                                                            *
  * Purpose: lock task queue                                                   *
  *                                                                            *
+ * Comments: The lock is first tried without blocking to count lock           *
+ *           contentions.                                                     *
+ *                                                                            *
  ******************************************************************************/
 void	pp_task_queue_lock(zbx_pp_queue_t *queue)
 {
-	pthread_mutex_lock(&queue->lock);
+	if (0 != pthread_mutex_trylock(&queue->lock))
+	{
+		pthread_mutex_lock(&queue->lock);
+		queue->lock_contended_num++;
+	}
+
+	queue->lock_num++;
 }
 
 /******************************************************************************
@@ -138,13 +153,98 @@ void	pp_task_queue_unlock(zbx_pp_queue_t *queue)
 	pthread_mutex_unlock(&queue->lock);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: initialize worker local task queue                                *
+ *                                                                            *
+ * Parameters: local - [IN] local task queue                                  *
+ *             error - [OUT]                                                  *
+ *                                                                            *
+ * Return value: SUCCEED - the local task queue was initialized successfully  *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+int	pp_local_queue_init(zbx_pp_local_queue_t *local, char **error)
+{
+	int	err;
+
+	local->first = 0;
+	local->tasks_num = 0;
+
+	if (0 != (err = pthread_mutex_init(&local->lock, NULL)))
+	{
+		*error = zbx_dsprintf(NULL, "cannot initialize local task queue mutex: %s", zbx_strerror(err));
+		return FAIL;
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: destroy worker local task queue                                   *
+ *                                                                            *
+ ******************************************************************************/
+void	pp_local_queue_destroy(zbx_pp_local_queue_t *local)
+{
+	zbx_pp_task_t	*task;
+
+	while (NULL != (task = pp_local_queue_pop(local)))
+		pp_task_free(task);
+
+	pthread_mutex_destroy(&local->lock);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: append task to local task queue                                   *
+ *                                                                            *
+ * Comments: This function must be called with local queue locked.            *
+ *                                                                            *
+ ******************************************************************************/
+static void	pp_local_queue_append(zbx_pp_local_queue_t *local, zbx_pp_task_t *task)
+{
+	local->tasks[(local->first + local->tasks_num++) % PP_LOCAL_QUEUE_SIZE] = task;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: pop the oldest task from local task queue                         *
+ *                                                                            *
+ * Parameters: local - [IN] local task queue                                  *
+ *                                                                            *
+ * Return value: The popped task or NULL if local task queue is empty.        *
+ *                                                                            *
+ ******************************************************************************/
+zbx_pp_task_t	*pp_local_queue_pop(zbx_pp_local_queue_t *local)
+{
+	zbx_pp_task_t	*task = NULL;
+
+	pthread_mutex_lock(&local->lock);
+
+	if (0 != local->tasks_num)
+	{
+		task = local->tasks[local->first];
+		local->first = (local->first + 1) % PP_LOCAL_QUEUE_SIZE;
+		local->tasks_num--;
+	}
+
+	pthread_mutex_unlock(&local->lock);
+
+	return task;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: register a new worker                                             *
  *                                                                            *
+ * Parameters: queue - [IN] task queue                                        *
+ *             local - [IN] worker local task queue                           *
+ *                                                                            *
  ******************************************************************************/
-void	pp_task_queue_register_worker(zbx_pp_queue_t *queue)
+void	pp_task_queue_register_worker(zbx_pp_queue_t *queue, zbx_pp_local_queue_t *local)
 {
+	zbx_vector_ptr_append(&queue->locals, local);
 	queue->workers_num++;
 }
 
@@ -152,9 +252,17 @@ void	pp_task_queue_register_worker(zbx_pp_queue_t *queue)
  *                                                                            *
  * Purpose: deregister a worker                                               *
  *                                                                            *
+ * Parameters: queue - [IN] task queue                                        *
+ *             local - [IN] worker local task queue                           *
+ *                                                                            *
  ******************************************************************************/
-void	pp_task_queue_deregister_worker(zbx_pp_queue_t *queue)
+void	pp_task_queue_deregister_worker(zbx_pp_queue_t *queue, zbx_pp_local_queue_t *local)
 {
+	int	i;
+
+	if (FAIL != (i = zbx_vector_ptr_search(&queue->locals, local, ZBX_DEFAULT_PTR_COMPARE_FUNC)))
+		zbx_vector_ptr_remove_noorder(&queue->locals, i);
+
 	queue->workers_num--;
 }
 
@@ -334,6 +442,101 @@ zbx_pp_task_t	*pp_task_queue_pop_new(zbx_pp_queue_t *queue)
 	return NULL;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: pop multiple tasks from task queue into worker local queue        *
+ *                                                                            *
+ * Parameters: queue - [IN] task queue                                        *
+ *             local - [IN] worker local task queue                           *
+ *                                                                            *
+ * Return value: The number of popped tasks.                                  *
+ *                                                                            *
+ * Comments: The number of popped tasks depends on the number of pending      *
+ *           tasks per worker, so with low load every worker takes a single   *
+ *           task while under high load the task queue is locked less often.  *
+ *           Tasks are taken in the same order as with pp_task_queue_pop_new()*
+ *           which keeps item task sequence ordering.                         *
+ *                                                                            *
+ ******************************************************************************/
+int	pp_task_queue_pop_batch(zbx_pp_queue_t *queue, zbx_pp_local_queue_t *local)
+{
+	zbx_pp_task_t	*task;
+	zbx_uint64_t	limit;
+	int		tasks_num = 0;
+
+	limit = queue->pending_num / (zbx_uint64_t)MAX(queue->workers_num, 1);
+
+	if (limit > PP_LOCAL_QUEUE_SIZE)
+		limit = PP_LOCAL_QUEUE_SIZE;
+
+	pthread_mutex_lock(&local->lock);
+
+	do
+	{
+		if (PP_LOCAL_QUEUE_SIZE == local->tasks_num || NULL == (task = pp_task_queue_pop_new(queue)))
+			break;
+
+		pp_local_queue_append(local, task);
+	}
+	while ((zbx_uint64_t)++tasks_num < limit);
+
+	pthread_mutex_unlock(&local->lock);
+
+	return tasks_num;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: steal tasks from other worker local queues                        *
+ *                                                                            *
+ * Parameters: queue - [IN] task queue                                        *
+ *             local - [IN] local queue of the worker stealing tasks          *
+ *                                                                            *
+ * Return value: The number of stolen tasks.                                  *
+ *                                                                            *
+ * Comments: This function must be called with task queue locked. A local    *
+ *           queue is locked either by its owner alone or while holding task  *
+ *           queue lock, so there is no lock order inversion. Half of the     *
+ *           newest tasks are stolen from the first non empty local queue     *
+ *           that is not busy.                                                *
+ *                                                                            *
+ ******************************************************************************/
+int	pp_task_queue_steal(zbx_pp_queue_t *queue, zbx_pp_local_queue_t *local)
+{
+	int	i, tasks_num = 0;
+
+	for (i = 0; i < queue->locals.values_num && 0 == tasks_num; i++)
+	{
+		zbx_pp_local_queue_t	*victim;
+
+		victim = (zbx_pp_local_queue_t *)queue->locals.values[(queue->steal_index + i) %
+				queue->locals.values_num];
+
+		if (victim == local || 0 != pthread_mutex_trylock(&victim->lock))
+			continue;
+
+		if (0 != (tasks_num = (victim->tasks_num + 1) / 2))
+		{
+			int	j;
+
+			pthread_mutex_lock(&local->lock);
+
+			for (j = victim->tasks_num - tasks_num; j < victim->tasks_num; j++)
+				pp_local_queue_append(local, victim->tasks[(victim->first + j) % PP_LOCAL_QUEUE_SIZE]);
+
+			pthread_mutex_unlock(&local->lock);
+
+			victim->tasks_num -= tasks_num;
+			queue->stolen_num += (zbx_uint64_t)tasks_num;
+			queue->steal_index = (queue->steal_index + i + 1) % queue->locals.values_num;
+		}
+
+		pthread_mutex_unlock(&victim->lock);
+	}
+
+	return tasks_num;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: push finished task into queue                                     *
@@ -18,32 +18,59 @@
 #include "zbxpreproc.h"
 #include "zbxalgo.h"
 
+/* the maximum number of tasks a worker takes from task queue at once */
+#define PP_LOCAL_QUEUE_SIZE	16
+
+/* worker local task queue, tasks are taken by owner from the head and stolen by other workers from the tail */
 typedef struct
 {
-	zbx_uint32_t	init_flags;
-	int		workers_num;
-	zbx_uint64_t	pending_num;
-	zbx_uint64_t	finished_num;
-	zbx_uint64_t	processing_num;
+	zbx_pp_task_t	*tasks[PP_LOCAL_QUEUE_SIZE];
+	int		first;
+	int		tasks_num;
 
-	zbx_hashset_t	sequences;
+	pthread_mutex_t	lock;
+}
+zbx_pp_local_queue_t;
 
-	zbx_list_t	pending;
-	zbx_list_t	immediate;
-	zbx_list_t	finished;
+typedef struct
+{
+	zbx_uint32_t		init_flags;
+	int			workers_num;
+	zbx_uint64_t		pending_num;
+	zbx_uint64_t		finished_num;
+	zbx_uint64_t		processing_num;
 
-	pthread_mutex_t	lock;
-	pthread_cond_t	event;
+	zbx_hashset_t		sequences;
+
+	zbx_list_t		pending;
+	zbx_list_t		immediate;
+	zbx_list_t		finished;
+
+	/* registered worker local queues */
+	zbx_vector_ptr_t	locals;
+	int			steal_index;
+
+	/* lock statistics */
+	zbx_uint64_t		lock_num;
+	zbx_uint64_t		lock_contended_num;
+	zbx_uint64_t		stolen_num;
+
+	pthread_mutex_t		lock;
+	pthread_cond_t		event;
 }
 zbx_pp_queue_t;
 
+int	pp_local_queue_init(zbx_pp_local_queue_t *local, char **error);
+void	pp_local_queue_destroy(zbx_pp_local_queue_t *local);
+zbx_pp_task_t	*pp_local_queue_pop(zbx_pp_local_queue_t *local);
+
 int	pp_task_queue_init(zbx_pp_queue_t *queue, char **error);
 void	pp_task_queue_destroy(zbx_pp_queue_t *queue);
 
 void	pp_task_queue_lock(zbx_pp_queue_t *queue);
 void	pp_task_queue_unlock(zbx_pp_queue_t *queue);
-void	pp_task_queue_register_worker(zbx_pp_queue_t *queue);
-void	pp_task_queue_deregister_worker(zbx_pp_queue_t *queue);
+void	pp_task_queue_register_worker(zbx_pp_queue_t *queue, zbx_pp_local_queue_t *local);
+void	pp_task_queue_deregister_worker(zbx_pp_queue_t *queue, zbx_pp_local_queue_t *local);
 void	pp_task_queue_remove_sequence(zbx_pp_queue_t *queue, zbx_uint64_t itemid);
 
 int	pp_task_queue_wait(zbx_pp_queue_t *queue, char **error);
@@ -54,6 +81,8 @@ void	pp_task_queue_push_test(zbx_pp_queue_t *queue, zbx_pp_task_t *task);
 void	pp_task_queue_push(zbx_pp_queue_t *queue, zbx_pp_task_t *task);
 
 zbx_pp_task_t	*pp_task_queue_pop_new(zbx_pp_queue_t *queue);
+int	pp_task_queue_pop_batch(zbx_pp_queue_t *queue, zbx_pp_local_queue_t *local);
+int	pp_task_queue_steal(zbx_pp_queue_t *queue, zbx_pp_local_queue_t *local);
 void	pp_task_queue_push_immediate(zbx_pp_queue_t *queue, zbx_pp_task_t *task);
 void	pp_task_queue_push_finished(zbx_pp_queue_t *queue, zbx_pp_task_t *task);
 zbx_pp_task_t	*pp_task_queue_pop_finished(zbx_pp_queue_t *queue);
@@ -24,6 +24,7 @@
 
 #define PP_WORKER_INIT_NONE	0x00
 #define PP_WORKER_INIT_THREAD	0x01
+#define PP_WORKER_INIT_LOCAL	0x02
 
 /******************************************************************************
  *                                                                            *
@@ -129,14 +130,34 @@ static void	*pp_worker_entry(void *args)
 
 	pp_context_init(&worker->execute_ctx);
 	pp_task_queue_lock(queue);
-	pp_task_queue_register_worker(queue);
+	pp_task_queue_register_worker(queue, &worker->local);
 
 	while (0 == worker->stop)
 	{
-		if (NULL != (in = pp_task_queue_pop_new(queue)))
+		if (0 == pp_task_queue_pop_batch(queue, &worker->local) &&
+				0 == pp_task_queue_steal(queue, &worker->local))
 		{
-			pp_task_queue_unlock(queue);
+			if (SUCCEED != pp_task_queue_wait(queue, &error))
+			{
+				zabbix_log(LOG_LEVEL_WARNING, "[%d] %s", worker->id, error);
+				zbx_free(error);
+				worker->stop = 1;
+			}
+
+			if (1 < queue->pending_num)
+				pp_task_queue_notify(queue);
+
+			continue;
+		}
+
+		/* let other workers steal tasks if more than one task was taken */
+		if (1 < worker->local.tasks_num)
+			pp_task_queue_notify(queue);
 
+		pp_task_queue_unlock(queue);
+
+		while (NULL != (in = pp_local_queue_pop(&worker->local)))
+		{
 			zbx_timekeeper_update(worker->timekeeper, worker->id - 1, ZBX_PROCESS_STATE_BUSY);
 
 			zabbix_log(LOG_LEVEL_TRACE, "%s() process task type:%u itemid:" ZBX_FS_UI64, __func__,
@@ -161,27 +182,23 @@ static void	*pp_worker_entry(void *args)
 
 			zbx_timekeeper_update(worker->timekeeper, worker->id - 1, ZBX_PROCESS_STATE_IDLE);
 
+			/* finished task is pushed right away rather than with the rest of local queue, */
+			/* so its result is not delayed by processing of the following tasks            */
 			pp_task_queue_lock(queue);
 			pp_task_queue_push_finished(queue, in);
 
+			zbx_regexp_cache_get_stats(&worker->regexp_cache_hits, &worker->regexp_cache_misses);
+
 			if (NULL != worker->pp_finished_task_cb)
 				worker->pp_finished_task_cb(worker->pp_finished_task_data);
 
-			continue;
-		}
-
-		if (SUCCEED != pp_task_queue_wait(queue, &error))
-		{
-			zabbix_log(LOG_LEVEL_WARNING, "[%d] %s", worker->id, error);
-			zbx_free(error);
-			worker->stop = 1;
+			pp_task_queue_unlock(queue);
 		}
 
-		if (1 < queue->pending_num)
-			pp_task_queue_notify(queue);
+		pp_task_queue_lock(queue);
 	}
 
-	pp_task_queue_deregister_worker(queue);
+	pp_task_queue_deregister_worker(queue, &worker->local);
 	pp_task_queue_unlock(queue);
 
 	zabbix_log(LOG_LEVEL_INFORMATION, "thread stopped [%s #%d]",
@@ -217,6 +234,13 @@ int	pp_worker_init(zbx_pp_worker_t *worker, int id, zbx_pp_queue_t *queue, zbx_t
 	worker->timekeeper = timekeeper;
 	worker->config_source_ip = config_source_ip;
 
+	if (SUCCEED != pp_local_queue_init(&worker->local, error))
+	{
+		err = FAIL;
+		goto out;
+	}
+	worker->init_flags |= PP_WORKER_INIT_LOCAL;
+
 	zbx_pthread_init_attr(&attr);
 	if (0 != (err = pthread_create(&worker->thread, &attr, pp_worker_entry, (void *)worker)))
 	{
@@ -260,6 +284,9 @@ void	pp_worker_destroy(zbx_pp_worker_t *worker)
 
 	pp_context_destroy(&worker->execute_ctx);
 
+	if (0 != (worker->init_flags & PP_WORKER_INIT_LOCAL))
+		pp_local_queue_destroy(&worker->local);
+
 	worker->init_flags = PP_WORKER_INIT_NONE;
 }
 
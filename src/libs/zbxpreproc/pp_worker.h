@@ -29,6 +29,7 @@ typedef struct
 	int				stop;
 
 	zbx_pp_queue_t			*queue;
+	zbx_pp_local_queue_t		local;
 	pthread_t			thread;
 
 	zbx_pp_context_t		execute_ctx;
@@ -42,6 +43,10 @@ typedef struct
 	zbx_log_component_t		logger;
 
 	const char			*config_source_ip;
+
+	/* regular expression cache statistics, updated by worker with task queue locked */
+	zbx_uint64_t			regexp_cache_hits;
+	zbx_uint64_t			regexp_cache_misses;
 }
 zbx_pp_worker_t;
 
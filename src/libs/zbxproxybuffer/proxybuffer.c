@@ -694,7 +694,7 @@ int	zbx_pb_create(int mode, zbx_uint64_t size, int age, int offline_buffer, char
 		allow_oom = 1;
 
 	if (FAIL == zbx_shmem_create(&pb_mem, size, "proxy memory buffer size", "ProxyMemoryBufferSize", allow_oom,
-			error))
+			ZBX_SHMEM_ALLOC_FIRSTFIT, error))
 	{
 		goto out;
 	}
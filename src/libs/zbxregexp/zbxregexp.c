@@ -24,6 +24,7 @@ struct zbx_regexp
 {
 	pcre2_code		*pcre2_regexp;
 	pcre2_match_context	*match_ctx;
+	pcre2_match_data	*match_data;
 };
 
 typedef struct
@@ -40,6 +41,23 @@ zbx_regmatch_t;
 
 ZBX_PTR_VECTOR_IMPL(expression, zbx_expression_t *)
 
+#define REGEXP_CACHE_SIZE	16	/* number of last used regular expressions cached per thread */
+
+typedef struct
+{
+	char		*pattern;
+	uint32_t	flags;
+	zbx_hash_t	hash;
+	zbx_regexp_t	*regexp;
+}
+zbx_regexp_cache_entry_t;
+
+/* compiled regular expressions ordered from the most to the least recently used */
+static ZBX_THREAD_LOCAL zbx_regexp_cache_entry_t	regexp_cache[REGEXP_CACHE_SIZE];
+static ZBX_THREAD_LOCAL int				regexp_cache_num = 0;
+static ZBX_THREAD_LOCAL zbx_uint64_t			regexp_cache_hits = 0;
+static ZBX_THREAD_LOCAL zbx_uint64_t			regexp_cache_misses = 0;
+
 typedef struct
 {
 	zbx_regmatch_t groups[ZBX_REGEXP_GROUPS_MAX];
@@ -134,6 +152,7 @@ static int	regexp_compile(const char *pattern, uint32_t flags, zbx_regexp_t **re
 	if (NULL != regexp)
 	{
 		pcre2_match_context	*match_ctx;
+		pcre2_match_data	*match_data;
 
 		if (NULL == (match_ctx = pcre2_match_context_create(NULL)))
 		{
@@ -142,9 +161,18 @@ static int	regexp_compile(const char *pattern, uint32_t flags, zbx_regexp_t **re
 			return FAIL;
 		}
 
+		if (NULL == (match_data = pcre2_match_data_create(ZBX_REGEXP_GROUPS_MAX, NULL)))
+		{
+			pcre2_match_context_free(match_ctx);
+			pcre2_code_free(pcre2_regexp);
+			*err_msg = zbx_strdup(*err_msg, "cannot create pcre2 match data");
+			return FAIL;
+		}
+
 		*regexp = (zbx_regexp_t *)zbx_malloc(NULL, sizeof(zbx_regexp_t));
 		(*regexp)->pcre2_regexp = pcre2_regexp;
 		(*regexp)->match_ctx = match_ctx;
+		(*regexp)->match_data = match_data;
 	}
 	else
 		pcre2_code_free(pcre2_regexp);
@@ -200,39 +228,85 @@ int	zbx_regexp_compile_ext(const char *pattern, zbx_regexp_t **regexp,
 
 /****************************************************************************************************
  *                                                                                                  *
- * Purpose: wrapper for zbx_regexp_compile. Caches and reuses the last used regexp.                 *
+ * Purpose: wrapper for zbx_regexp_compile. Caches and reuses the last REGEXP_CACHE_SIZE used       *
+ *          regexps of the calling thread. Cached regexps are JIT compiled if supported.            *
+ *                                                                                                  *
+ * Comments: The returned regexp is valid until the next call of this function.                     *
  *                                                                                                  *
  ****************************************************************************************************/
 static int	regexp_prepare(const char *pattern, uint32_t flags, zbx_regexp_t **regexp, char **err_msg)
 {
-	static ZBX_THREAD_LOCAL zbx_regexp_t	*curr_regexp = NULL;
-	static ZBX_THREAD_LOCAL char		*curr_pattern = NULL;
-	static ZBX_THREAD_LOCAL uint32_t	curr_flags = 0;
-	int					ret = SUCCEED;
+	zbx_regexp_cache_entry_t	entry;
+	int				i;
+
+	entry.hash = ZBX_DEFAULT_STRING_HASH_FUNC(pattern);
 
-	if (NULL == curr_regexp || 0 != strcmp(curr_pattern, pattern) || curr_flags != flags)
+	for (i = 0; i < regexp_cache_num; i++)
 	{
-		if (NULL != curr_regexp)
+		if (regexp_cache[i].hash == entry.hash && regexp_cache[i].flags == flags &&
+				0 == strcmp(regexp_cache[i].pattern, pattern))
 		{
-			zbx_regexp_free(curr_regexp);
-			zbx_free(curr_pattern);
-		}
+			regexp_cache_hits++;
 
-		curr_regexp = NULL;
-		curr_pattern = NULL;
-		curr_flags = 0;
+			if (0 != i)
+			{
+				entry = regexp_cache[i];
+				memmove(&regexp_cache[1], &regexp_cache[0],
+						sizeof(zbx_regexp_cache_entry_t) * (size_t)i);
+				regexp_cache[0] = entry;
+			}
 
-		if (SUCCEED == regexp_compile(pattern, flags, &curr_regexp, err_msg))
-		{
-			curr_pattern = zbx_strdup(curr_pattern, pattern);
-			curr_flags = flags;
+			*regexp = regexp_cache[0].regexp;
+
+			return SUCCEED;
 		}
-		else
-			ret = FAIL;
 	}
 
-	*regexp = curr_regexp;
-	return ret;
+	regexp_cache_misses++;
+
+	if (SUCCEED != regexp_compile(pattern, flags, &entry.regexp, err_msg))
+	{
+		*regexp = NULL;
+		return FAIL;
+	}
+
+#ifdef PCRE2_JIT_COMPLETE
+	/* only cached regexps are reused often enough to pay off JIT compilation, */
+	/* its failure is not an error - pcre2_match() falls back to interpreter   */
+	(void)pcre2_jit_compile(entry.regexp->pcre2_regexp, PCRE2_JIT_COMPLETE);
+#endif
+	entry.pattern = zbx_strdup(NULL, pattern);
+	entry.flags = flags;
+
+	if (REGEXP_CACHE_SIZE == regexp_cache_num)
+	{
+		regexp_cache_num--;
+		zbx_regexp_free(regexp_cache[regexp_cache_num].regexp);
+		zbx_free(regexp_cache[regexp_cache_num].pattern);
+	}
+
+	memmove(&regexp_cache[1], &regexp_cache[0], sizeof(zbx_regexp_cache_entry_t) * (size_t)regexp_cache_num);
+	regexp_cache[0] = entry;
+	regexp_cache_num++;
+
+	*regexp = entry.regexp;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets compiled regular expression cache statistics of the calling  *
+ *          thread                                                            *
+ *                                                                            *
+ * Parameters: hits   - [OUT] number of regexps found in cache                *
+ *             misses - [OUT] number of regexps compiled                      *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_regexp_cache_get_stats(zbx_uint64_t *hits, zbx_uint64_t *misses)
+{
+	*hits = regexp_cache_hits;
+	*misses = regexp_cache_misses;
 }
 
 /* calculate recursion limit, PCRE man page suggests to reckon on about 500 bytes per recursion */
@@ -359,7 +433,11 @@ static int	regexp_exec(const char *string, const zbx_regexp_t *regexp, int flags
 	pcre2_set_match_limit(regexp->match_ctx, 1000000);
 
 	pcre2_set_recursion_limit(regexp->match_ctx, (uint32_t)compute_match_recursion_limit());
-	match_data = pcre2_match_data_create((uint32_t)count, NULL);
+
+	if (ZBX_REGEXP_GROUPS_MAX >= count)
+		match_data = regexp->match_data;
+	else
+		match_data = pcre2_match_data_create((uint32_t)count, NULL);
 
 	if (NULL == match_data)
 	{
@@ -372,8 +450,18 @@ static int	regexp_exec(const char *string, const zbx_regexp_t *regexp, int flags
 		flags |= PCRE2_NO_UTF_CHECK;
 #endif
 
-		if (0 <= (r = pcre2_match(regexp->pcre2_regexp, (PCRE2_SPTR)string, PCRE2_ZERO_TERMINATED, offset,
-			flags, match_data, regexp->match_ctx)))
+		r = pcre2_match(regexp->pcre2_regexp, (PCRE2_SPTR)string, PCRE2_ZERO_TERMINATED, offset, flags,
+				match_data, regexp->match_ctx);
+
+#if defined(PCRE2_ERROR_JIT_STACKLIMIT) && defined(PCRE2_NO_JIT)
+		/* JIT uses small fixed size stack, retry with the interpreter which is limited by recursion limit */
+		if (PCRE2_ERROR_JIT_STACKLIMIT == r)
+		{
+			r = pcre2_match(regexp->pcre2_regexp, (PCRE2_SPTR)string, PCRE2_ZERO_TERMINATED, offset,
+					flags | PCRE2_NO_JIT, match_data, regexp->match_ctx);
+		}
+#endif
+		if (0 <= r)
 		{
 			if (NULL != matches)
 			{
@@ -413,7 +501,8 @@ static int	regexp_exec(const char *string, const zbx_regexp_t *regexp, int flags
 			result = FAIL;
 		}
 
-		pcre2_match_data_free(match_data);
+		if (match_data != regexp->match_data)
+			pcre2_match_data_free(match_data);
 	}
 
 	return result;
@@ -430,6 +519,7 @@ void	zbx_regexp_free(zbx_regexp_t *regexp)
 {
 	pcre2_code_free(regexp->pcre2_regexp);
 	pcre2_match_context_free(regexp->match_ctx);
+	pcre2_match_data_free(regexp->match_data);
 
 	zbx_free(regexp);
 }
@@ -1801,6 +1891,238 @@ void	zbx_regexp_escape(char **string)
 	*string = buffer;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: skips character class in regular expression                      *
+ *                                                                            *
+ * Parameters: p - [IN] pointer to the opening '[' of character class         *
+ *                                                                            *
+ * Return value: pointer to the character following the class or NULL if     *
+ *               the class is not terminated                                  *
+ *                                                                            *
+ ******************************************************************************/
+static const char	*regexp_skip_class(const char *p)
+{
+	p++;
+
+	if ('^' == *p)
+		p++;
+
+	if (']' == *p)	/* leading ']' is a literal character */
+		p++;
+
+	for (; '\0' != *p; p++)
+	{
+		switch (*p)
+		{
+			case '\\':
+				if ('\0' == *(++p))
+					return NULL;
+				break;
+			case '[':
+				if (':' == p[1] || '.' == p[1] || '=' == p[1])
+				{
+					const char	*end;
+
+					if (NULL == (end = strchr(p + 2, p[1])) || ']' != end[1])
+						return NULL;
+
+					p = end + 1;
+				}
+				break;
+			case ']':
+				return p + 1;
+		}
+	}
+
+	return NULL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: skips group in regular expression                                 *
+ *                                                                            *
+ * Parameters: p - [IN] pointer to the opening '(' of group                   *
+ *                                                                            *
+ * Return value: pointer to the character following the group or NULL if      *
+ *               the group is not terminated                                  *
+ *                                                                            *
+ ******************************************************************************/
+static const char	*regexp_skip_group(const char *p)
+{
+	int	level = 0;
+
+	while ('\0' != *p)
+	{
+		switch (*p)
+		{
+			case '\\':
+				if ('\0' == p[1])
+					return NULL;
+				p += 2;
+				continue;
+			case '[':
+				if (NULL == (p = regexp_skip_class(p)))
+					return NULL;
+				continue;
+			case '(':
+				level++;
+				break;
+			case ')':
+				if (0 == --level)
+					return p + 1;
+				break;
+		}
+
+		p++;
+	}
+
+	return NULL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if the text following '{' is a repetition quantifier       *
+ *                                                                            *
+ * Parameters: p - [IN] pointer to the opening '{'                            *
+ *                                                                            *
+ * Return value: pointer to the closing '}' or NULL if the text is not a      *
+ *               quantifier                                                   *
+ *                                                                            *
+ ******************************************************************************/
+static const char	*regexp_get_quantifier_end(const char *p)
+{
+	const char	*ptr = p + 1;
+
+	while (' ' == *ptr || 0 != isdigit((unsigned char)*ptr) || ',' == *ptr)
+		ptr++;
+
+	if ('}' != *ptr || ptr == p + 1)
+		return NULL;
+
+	return ptr;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: finishes the current run of literal characters, keeping it if it  *
+ *          is the longest one found so far                                   *
+ *                                                                            *
+ ******************************************************************************/
+static void	regexp_flush_literal(const char *run, size_t *run_len, char **literal, size_t *literal_len)
+{
+	if (*run_len > *literal_len)
+	{
+		*literal = (char *)zbx_realloc(*literal, *run_len + 1);
+		memcpy(*literal, run, *run_len);
+		(*literal)[*run_len] = '\0';
+		*literal_len = *run_len;
+	}
+
+	*run_len = 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: extracts the longest literal substring which must be present in   *
+ *          every string matching regular expression                          *
+ *                                                                            *
+ * Parameters: pattern - [IN] regular expression                              *
+ *                                                                            *
+ * Return value: dynamically allocated literal or NULL if the expression has  *
+ *               no mandatory literal or cannot be analyzed                   *
+ *                                                                            *
+ * Comments: The literal allows to reject strings with a plain substring      *
+ *           search before running the regular expression. Expressions with   *
+ *           top level alternation, inline options, verbs or quoting are not  *
+ *           analyzed. Only case sensitive matching can use the literal.      *
+ *                                                                            *
+ ******************************************************************************/
+char	*zbx_regexp_extract_literal(const char *pattern)
+{
+	const char	*p = pattern;
+	char		*run, *literal = NULL;
+	size_t		run_len = 0, literal_len = 0;
+
+	if (NULL != strstr(pattern, "(?") || NULL != strstr(pattern, "(*") || NULL != strstr(pattern, "\\Q"))
+		return NULL;
+
+	run = (char *)zbx_malloc(NULL, strlen(pattern) + 1);
+
+	while ('\0' != *p)
+	{
+		switch (*p)
+		{
+			case '\\':
+				if ('\0' == p[1])
+					goto fail;
+
+				if (0 == isalnum((unsigned char)p[1]))
+				{
+					run[run_len++] = p[1];
+					p += 2;
+					continue;
+				}
+
+				/* character types and assertions without arguments break the literal, */
+				/* other escape sequences are not analyzed */
+				if (NULL == strchr("dDwWsSbBAzZGhHvVRXKnrtefa", p[1]))
+					goto fail;
+
+				regexp_flush_literal(run, &run_len, &literal, &literal_len);
+				p += 2;
+				continue;
+			case '[':
+				regexp_flush_literal(run, &run_len, &literal, &literal_len);
+
+				if (NULL == (p = regexp_skip_class(p)))
+					goto fail;
+				continue;
+			case '(':
+				regexp_flush_literal(run, &run_len, &literal, &literal_len);
+
+				if (NULL == (p = regexp_skip_group(p)))
+					goto fail;
+				continue;
+			case ')':
+			case '|':
+				goto fail;
+			case '{':
+				if (NULL == (p = regexp_get_quantifier_end(p)))
+					goto fail;
+				ZBX_FALLTHROUGH;
+			case '*':
+			case '?':
+				/* the preceding character is optional, drop all bytes of its UTF-8 sequence */
+				while (0 < run_len && 0x80 == (run[run_len - 1] & 0xc0))
+					run_len--;
+
+				if (0 < run_len)
+					run_len--;
+				ZBX_FALLTHROUGH;
+			case '+':
+			case '.':
+			case '^':
+			case '$':
+				regexp_flush_literal(run, &run_len, &literal, &literal_len);
+				p++;
+				continue;
+			default:
+				run[run_len++] = *p++;
+		}
+	}
+
+	regexp_flush_literal(run, &run_len, &literal, &literal_len);
+	zbx_free(run);
+
+	return literal;
+fail:
+	zbx_free(run);
+	zbx_free(literal);
+
+	return NULL;
+}
+
 /**********************************************************************************
  *                                                                                *
  * Purpose: remove repeated wildcard characters from the expression               *
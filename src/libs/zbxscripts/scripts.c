@@ -102,7 +102,7 @@ int	zbx_init_remote_commands_cache(char **error)
 	remote_command_cache_size -= size_reserved;
 
 	if (SUCCEED != zbx_shmem_create(&remote_commands_mem, remote_command_cache_size, "commands cache size",
-			"CommandsCacheSize",1, error))
+			"CommandsCacheSize",1, ZBX_SHMEM_ALLOC_FIRSTFIT, error))
 	{
 		goto out;
 	}
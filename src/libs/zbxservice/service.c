@@ -94,3 +94,30 @@ void	zbx_service_reload_cache(void)
 
 	zbx_ipc_socket_close(&socket);
 }
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets service manager diagnostic statistics                        *
+ *                                                                            *
+ * Parameters: stats - [OUT]                                                  *
+ *             error - [OUT]                                                  *
+ *                                                                            *
+ * Return value: SUCCEED - statistics were retrieved successfully             *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_service_get_diag_stats(zbx_service_diag_stats_t *stats, char **error)
+{
+	unsigned char	*result;
+
+	if (SUCCEED != zbx_ipc_async_exchange(ZBX_IPC_SERVICE_SERVICE, ZBX_IPC_SERVICE_SERVICE_DIAG_STATS, SEC_PER_MIN,
+			NULL, 0, &result, error))
+	{
+		return FAIL;
+	}
+
+	zbx_service_deserialize_diag_stats(result, stats);
+	zbx_free(result);
+
+	return SUCCEED;
+}
@@ -448,3 +448,52 @@ void	zbx_service_deserialize_event_severities(const unsigned char *data,
 		zbx_vector_event_severity_ptr_append(event_severities, es);
 	}
 }
+
+zbx_uint32_t	zbx_service_serialize_diag_stats(unsigned char **data, const zbx_service_diag_stats_t *stats)
+{
+	zbx_uint32_t	data_len = 0;
+	unsigned char	*ptr;
+
+	zbx_serialize_prepare_value(data_len, stats->services_num);
+	zbx_serialize_prepare_value(data_len, stats->problems_num);
+	zbx_serialize_prepare_value(data_len, stats->batches_num);
+	zbx_serialize_prepare_value(data_len, stats->evaluated_num);
+	zbx_serialize_prepare_value(data_len, stats->updates_num);
+	zbx_serialize_prepare_value(data_len, stats->lag_num);
+	zbx_serialize_prepare_value(data_len, stats->recalc_time);
+	zbx_serialize_prepare_value(data_len, stats->db_time);
+	zbx_serialize_prepare_value(data_len, stats->lag_last);
+	zbx_serialize_prepare_value(data_len, stats->lag_max);
+	zbx_serialize_prepare_value(data_len, stats->lag_total);
+
+	ptr = *data = (unsigned char *)zbx_malloc(NULL, data_len);
+
+	ptr += zbx_serialize_value(ptr, stats->services_num);
+	ptr += zbx_serialize_value(ptr, stats->problems_num);
+	ptr += zbx_serialize_value(ptr, stats->batches_num);
+	ptr += zbx_serialize_value(ptr, stats->evaluated_num);
+	ptr += zbx_serialize_value(ptr, stats->updates_num);
+	ptr += zbx_serialize_value(ptr, stats->lag_num);
+	ptr += zbx_serialize_value(ptr, stats->recalc_time);
+	ptr += zbx_serialize_value(ptr, stats->db_time);
+	ptr += zbx_serialize_value(ptr, stats->lag_last);
+	ptr += zbx_serialize_value(ptr, stats->lag_max);
+	(void)zbx_serialize_value(ptr, stats->lag_total);
+
+	return data_len;
+}
+
+void	zbx_service_deserialize_diag_stats(const unsigned char *data, zbx_service_diag_stats_t *stats)
+{
+	data += zbx_deserialize_value(data, &stats->services_num);
+	data += zbx_deserialize_value(data, &stats->problems_num);
+	data += zbx_deserialize_value(data, &stats->batches_num);
+	data += zbx_deserialize_value(data, &stats->evaluated_num);
+	data += zbx_deserialize_value(data, &stats->updates_num);
+	data += zbx_deserialize_value(data, &stats->lag_num);
+	data += zbx_deserialize_value(data, &stats->recalc_time);
+	data += zbx_deserialize_value(data, &stats->db_time);
+	data += zbx_deserialize_value(data, &stats->lag_last);
+	data += zbx_deserialize_value(data, &stats->lag_max);
+	(void)zbx_deserialize_value(data, &stats->lag_total);
+}
@@ -77,6 +77,23 @@
  *  lo_bound             `size' fields in chunk B                   hi_bound  *
  *  (aligned)            have SHMEM_FLG_USED bit set               (aligned)  *
  *                                                                            *
+ * (*) with ZBX_SHMEM_ALLOC_BESTFIT allocation mode the free chunks that do   *
+ *     not fit into size buckets are stored in a bitwise trie indexed by      *
+ *     chunk size instead of the last bucket list                             *
+ *                                                                            *
+ *     each trie node holds chunks of a unique size, chunks of the same size  *
+ *     are linked to the node through prevnext pointers, the first chunk      *
+ *     being the node itself (having NULL previous chunk pointer)            *
+ *                                                                            *
+ *     node chunks additionally store pointers to the left and right child    *
+ *     and parent nodes after prevnext pointers:                              *
+ *                                                                            *
+ *                |--------|prev|next|left|right|parent|...|--------|         *
+ *                                                                            *
+ *     children of the node at depth N are selected by the bit                *
+ *     (SHMEM_TREE_TOP_BIT - N) of chunk size, so the tree depth is limited   *
+ *     by the bit count of the maximum chunk size                             *
+ *                                                                            *
  ******************************************************************************/
 
 static void	*ALIGN4(void *ptr);
@@ -96,6 +113,17 @@ static void	mem_set_next_chunk(void *chunk, void *next);
 static void	**mem_ptr_to_prev_field(void *chunk);
 static void	**mem_ptr_to_next_field(void *chunk, void **first_chunk);
 
+static void	**mem_ptr_to_child_field(void *chunk, int dir);
+static void	*mem_get_child_chunk(void *chunk, int dir);
+static void	mem_set_child_chunk(void *chunk, int dir, void *child);
+static void	*mem_get_parent_chunk(void *chunk);
+static void	mem_set_parent_chunk(void *chunk, void *parent);
+
+static void	mem_tree_link_chunk(zbx_shmem_info_t *info, void *chunk);
+static void	mem_tree_unlink_chunk(zbx_shmem_info_t *info, void *chunk);
+static void	*mem_tree_find_chunk(const zbx_shmem_info_t *info, zbx_uint64_t size);
+static void	*mem_list_find_chunk(const zbx_shmem_info_t *info, zbx_uint64_t size);
+
 static void	mem_link_chunk(zbx_shmem_info_t *info, void *chunk);
 static void	mem_unlink_chunk(zbx_shmem_info_t *info, void *chunk);
 
@@ -113,6 +141,11 @@ static void	__mem_free(zbx_shmem_info_t *info, void *ptr);
 #define SHMEM_MIN_SIZE		__UINT64_C(128)
 #define SHMEM_MAX_SIZE		__UINT64_C(0x1000000000)	/* 64 GB */
 
+#define SHMEM_TREE_TOP_BIT	35	/* the highest bit of chunk size, chunks are smaller than SHMEM_MAX_SIZE */
+
+#define SHMEM_IS_TREE_BUCKET(info, index)	(ZBX_SHMEM_ALLOC_BESTFIT == (info)->alloc_mode &&	\
+							ZBX_SHMEM_BUCKET_COUNT - 1 == (index))
+
 /* helper functions */
 
 static void	*ALIGN4(void *ptr)
@@ -195,12 +228,253 @@ static void	**mem_ptr_to_next_field(void *chunk, void **first_chunk)
 	return (NULL != chunk ? (void **)((char *)chunk + SHMEM_SIZE_FIELD + ZBX_PTR_SIZE) : first_chunk);
 }
 
+static void	**mem_ptr_to_child_field(void *chunk, int dir)
+{
+	return (void **)((char *)chunk + SHMEM_SIZE_FIELD + (2 + dir) * ZBX_PTR_SIZE);
+}
+
+static void	*mem_get_child_chunk(void *chunk, int dir)
+{
+	return *mem_ptr_to_child_field(chunk, dir);
+}
+
+static void	mem_set_child_chunk(void *chunk, int dir, void *child)
+{
+	*mem_ptr_to_child_field(chunk, dir) = child;
+}
+
+static void	*mem_get_parent_chunk(void *chunk)
+{
+	return *(void **)((char *)chunk + SHMEM_SIZE_FIELD + 4 * ZBX_PTR_SIZE);
+}
+
+static void	mem_set_parent_chunk(void *chunk, void *parent)
+{
+	*(void **)((char *)chunk + SHMEM_SIZE_FIELD + 4 * ZBX_PTR_SIZE) = parent;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds free chunk to the size indexed tree                          *
+ *                                                                            *
+ ******************************************************************************/
+static void	mem_tree_link_chunk(zbx_shmem_info_t *info, void *chunk)
+{
+	void		*node, *next;
+	zbx_uint64_t	size;
+	int		bit = SHMEM_TREE_TOP_BIT;
+
+	size = CHUNK_SIZE(chunk);
+
+	mem_set_prev_chunk(chunk, NULL);
+	mem_set_next_chunk(chunk, NULL);
+	mem_set_child_chunk(chunk, 0, NULL);
+	mem_set_child_chunk(chunk, 1, NULL);
+
+	if (NULL == (node = info->buckets[ZBX_SHMEM_BUCKET_COUNT - 1]))
+	{
+		mem_set_parent_chunk(chunk, NULL);
+		info->buckets[ZBX_SHMEM_BUCKET_COUNT - 1] = chunk;
+		return;
+	}
+
+	while (CHUNK_SIZE(node) != size)
+	{
+		void	*child;
+		int	dir = (int)((size >> bit--) & 1);
+
+		if (NULL == (child = mem_get_child_chunk(node, dir)))
+		{
+			mem_set_child_chunk(node, dir, chunk);
+			mem_set_parent_chunk(chunk, node);
+			return;
+		}
+
+		node = child;
+	}
+
+	/* node of the same size already exists, link chunk after it */
+
+	if (NULL != (next = mem_get_next_chunk(node)))
+		mem_set_prev_chunk(next, chunk);
+
+	mem_set_prev_chunk(chunk, node);
+	mem_set_next_chunk(chunk, next);
+	mem_set_next_chunk(node, chunk);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: removes free chunk from the size indexed tree                     *
+ *                                                                            *
+ ******************************************************************************/
+static void	mem_tree_unlink_chunk(zbx_shmem_info_t *info, void *chunk)
+{
+	void	*prev_chunk, *next_chunk, *parent, *repl, *child;
+	int	dir;
+
+	prev_chunk = mem_get_prev_chunk(chunk);
+	next_chunk = mem_get_next_chunk(chunk);
+
+	if (NULL != prev_chunk)
+	{
+		/* not a tree node, only remove it from the list of same sized chunks */
+		mem_set_next_chunk(prev_chunk, next_chunk);
+
+		if (NULL != next_chunk)
+			mem_set_prev_chunk(next_chunk, prev_chunk);
+
+		return;
+	}
+
+	if (NULL != next_chunk)
+	{
+		/* the next chunk of the same size replaces the node */
+		repl = next_chunk;
+		mem_set_prev_chunk(repl, NULL);
+	}
+	else if (NULL != (repl = mem_get_child_chunk(chunk, 1)) || NULL != (repl = mem_get_child_chunk(chunk, 0)))
+	{
+		/* any leaf of the node subtree shares the node prefix and can replace it */
+		while (NULL != (child = mem_get_child_chunk(repl, 1)) ||
+				NULL != (child = mem_get_child_chunk(repl, 0)))
+		{
+			repl = child;
+		}
+
+		parent = mem_get_parent_chunk(repl);
+		mem_set_child_chunk(parent, mem_get_child_chunk(parent, 1) == repl ? 1 : 0, NULL);
+	}
+
+	if (NULL != repl)
+	{
+		for (dir = 0; dir < 2; dir++)
+		{
+			if (NULL != (child = mem_get_child_chunk(chunk, dir)))
+				mem_set_parent_chunk(child, repl);
+
+			mem_set_child_chunk(repl, dir, child);
+		}
+	}
+
+	if (NULL == (parent = mem_get_parent_chunk(chunk)))
+		info->buckets[ZBX_SHMEM_BUCKET_COUNT - 1] = repl;
+	else
+		mem_set_child_chunk(parent, mem_get_child_chunk(parent, 1) == chunk ? 1 : 0, repl);
+
+	if (NULL != repl)
+		mem_set_parent_chunk(repl, parent);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: finds the smallest free chunk in the size indexed tree that can   *
+ *          hold the requested size                                           *
+ *                                                                            *
+ * Return value: the free chunk or NULL if no chunk is large enough           *
+ *                                                                            *
+ ******************************************************************************/
+static void	*mem_tree_find_chunk(const zbx_shmem_info_t *info, zbx_uint64_t size)
+{
+	void	*node, *best = NULL, *right_subtree = NULL, *right, *next_chunk;
+	int	bit = SHMEM_TREE_TOP_BIT;
+
+	if (size > info->total_size)
+		return NULL;
+
+	/* walk the path of requested size remembering the best fitting node and the deepest */
+	/* not taken right subtree - it holds the smallest chunks larger than requested size  */
+	for (node = info->buckets[ZBX_SHMEM_BUCKET_COUNT - 1]; NULL != node; bit--)
+	{
+		if (CHUNK_SIZE(node) >= size && (NULL == best || CHUNK_SIZE(node) < CHUNK_SIZE(best)))
+		{
+			best = node;
+
+			if (CHUNK_SIZE(node) == size)
+				break;
+		}
+
+		right = mem_get_child_chunk(node, 1);
+		node = mem_get_child_chunk(node, (int)((size >> bit) & 1));
+
+		if (NULL != right && right != node)
+			right_subtree = right;
+	}
+
+	if (NULL == best || CHUNK_SIZE(best) != size)
+	{
+		/* the smallest chunk of a subtree is on its leftmost path */
+		for (node = right_subtree; NULL != node; node = (NULL != mem_get_child_chunk(node, 0) ?
+				mem_get_child_chunk(node, 0) : mem_get_child_chunk(node, 1)))
+		{
+			if (NULL == best || CHUNK_SIZE(node) < CHUNK_SIZE(best))
+				best = node;
+		}
+	}
+
+	/* prefer chunk from the list of same sized chunks as it can be unlinked without tree changes */
+	if (NULL != best && NULL != (next_chunk = mem_get_next_chunk(best)))
+		return next_chunk;
+
+	return best;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: finds free chunk in the last bucket list that can hold the        *
+ *          requested size according to first-fit strategy                    *
+ *                                                                            *
+ * Return value: the free chunk or NULL if no chunk is large enough           *
+ *                                                                            *
+ ******************************************************************************/
+static void	*mem_list_find_chunk(const zbx_shmem_info_t *info, zbx_uint64_t size)
+{
+	void		*chunk;
+	int		counter = 0;
+	zbx_uint64_t	skip_min = __UINT64_C(0xffffffffffffffff), skip_max = __UINT64_C(0);
+
+	chunk = info->buckets[ZBX_SHMEM_BUCKET_COUNT - 1];
+
+	while (NULL != chunk && CHUNK_SIZE(chunk) < size)
+	{
+		counter++;
+		skip_min = MIN(skip_min, CHUNK_SIZE(chunk));
+		skip_max = MAX(skip_max, CHUNK_SIZE(chunk));
+		chunk = mem_get_next_chunk(chunk);
+	}
+
+	/* don't log errors if malloc can return null in low memory situations */
+	if (0 == info->allow_oom)
+	{
+		if (NULL == chunk)
+		{
+			zabbix_log(LOG_LEVEL_CRIT, "__mem_malloc: skipped %d asked " ZBX_FS_UI64 " skip_min "
+					ZBX_FS_UI64 " skip_max " ZBX_FS_UI64,
+					counter, size, skip_min, skip_max);
+		}
+		else if (counter >= 100)
+		{
+			zabbix_log(LOG_LEVEL_DEBUG, "__mem_malloc: skipped %d asked " ZBX_FS_UI64 " skip_min "
+					ZBX_FS_UI64 " skip_max " ZBX_FS_UI64 " size " ZBX_FS_UI64, counter,
+					size, skip_min, skip_max, CHUNK_SIZE(chunk));
+		}
+	}
+
+	return chunk;
+}
+
 static void	mem_link_chunk(zbx_shmem_info_t *info, void *chunk)
 {
 	int	index;
 
 	index = mem_bucket_by_size(CHUNK_SIZE(chunk));
 
+	if (SHMEM_IS_TREE_BUCKET(info, index))
+	{
+		mem_tree_link_chunk(info, chunk);
+		return;
+	}
+
 	if (NULL != info->buckets[index])
 		mem_set_prev_chunk(info->buckets[index], chunk);
 
@@ -218,6 +492,12 @@ static void	mem_unlink_chunk(zbx_shmem_info_t *info, void *chunk)
 
 	index = mem_bucket_by_size(CHUNK_SIZE(chunk));
 
+	if (SHMEM_IS_TREE_BUCKET(info, index))
+	{
+		mem_tree_unlink_chunk(info, chunk);
+		return;
+	}
+
 	prev_chunk = mem_get_prev_chunk(chunk);
 	next_chunk = mem_get_next_chunk(chunk);
 
@@ -246,40 +526,25 @@ static void	*__mem_malloc(zbx_shmem_info_t *info, zbx_uint64_t size)
 	while (index < ZBX_SHMEM_BUCKET_COUNT - 1 && NULL == info->buckets[index])
 		index++;
 
-	chunk = info->buckets[index];
-
-	if (index == ZBX_SHMEM_BUCKET_COUNT - 1)
+	if (index < ZBX_SHMEM_BUCKET_COUNT - 1)
 	{
-		/* otherwise, find a chunk big enough according to first-fit strategy */
-
-		int		counter = 0;
-		zbx_uint64_t	skip_min = __UINT64_C(0xffffffffffffffff), skip_max = __UINT64_C(0);
-
-		while (NULL != chunk && CHUNK_SIZE(chunk) < size)
-		{
-			counter++;
-			skip_min = MIN(skip_min, CHUNK_SIZE(chunk));
-			skip_max = MAX(skip_max, CHUNK_SIZE(chunk));
-			chunk = mem_get_next_chunk(chunk);
-		}
+		chunk = info->buckets[index];
+	}
+	else if (ZBX_SHMEM_ALLOC_BESTFIT == info->alloc_mode)
+	{
+		/* otherwise, find the smallest chunk big enough in the size indexed tree */
 
-		/* don't log errors if malloc can return null in low memory situations */
-		if (0 == info->allow_oom)
+		if (NULL == (chunk = mem_tree_find_chunk(info, size)) && 0 == info->allow_oom)
 		{
-			if (NULL == chunk)
-			{
-				zabbix_log(LOG_LEVEL_CRIT, "__mem_malloc: skipped %d asked " ZBX_FS_UI64 " skip_min "
-						ZBX_FS_UI64 " skip_max " ZBX_FS_UI64,
-						counter, size, skip_min, skip_max);
-			}
-			else if (counter >= 100)
-			{
-				zabbix_log(LOG_LEVEL_DEBUG, "__mem_malloc: skipped %d asked " ZBX_FS_UI64 " skip_min "
-						ZBX_FS_UI64 " skip_max " ZBX_FS_UI64 " size " ZBX_FS_UI64, counter,
-						size, skip_min, skip_max, CHUNK_SIZE(chunk));
-			}
+			zabbix_log(LOG_LEVEL_CRIT, "__mem_malloc: cannot find free chunk for " ZBX_FS_UI64 " bytes",
+					size);
 		}
 	}
+	else
+	{
+		/* otherwise, find a chunk big enough according to first-fit strategy */
+		chunk = mem_list_find_chunk(info, size);
+	}
 
 	if (NULL == chunk)
 		return NULL;
@@ -524,15 +789,16 @@ static void	__mem_free(zbx_shmem_info_t *info, void *ptr)
 /* public memory interface */
 
 int	zbx_shmem_create(zbx_shmem_info_t **info, zbx_uint64_t size, const char *descr, const char *param,
-		int allow_oom, char **error)
+		int allow_oom, unsigned char alloc_mode, char **error)
 {
-	int	shm_id, index, ret = FAIL;
+	int	shm_id, ret = FAIL;
 	void	*base;
 
 	descr = ZBX_NULL2STR(descr);
 	param = ZBX_NULL2STR(param);
 
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s() param:'%s' size:" ZBX_FS_SIZE_T, __func__, param, (zbx_fs_size_t)size);
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() param:'%s' size:" ZBX_FS_SIZE_T " alloc_mode:%d", __func__, param,
+			(zbx_fs_size_t)size, (int)alloc_mode);
 
 	/* allocate shared memory */
 
@@ -594,6 +860,7 @@ int	zbx_shmem_create(zbx_shmem_info_t **info, zbx_uint64_t size, const char *des
 	base = (void *)((char *)base + strlen(param) + 1);
 
 	(*info)->allow_oom = allow_oom;
+	(*info)->alloc_mode = alloc_mode;
 
 	/* prepare shared memory for further allocation by creating one big chunk */
 	(*info)->lo_bound = ALIGN8(base);
@@ -602,11 +869,8 @@ int	zbx_shmem_create(zbx_shmem_info_t **info, zbx_uint64_t size, const char *des
 	(*info)->total_size = (zbx_uint64_t)((char *)((*info)->hi_bound) - (char *)((*info)->lo_bound) -
 			2 * SHMEM_SIZE_FIELD);
 
-	index = mem_bucket_by_size((*info)->total_size);
-	(*info)->buckets[index] = (*info)->lo_bound;
-	mem_set_chunk_size((*info)->buckets[index], (*info)->total_size);
-	mem_set_prev_chunk((*info)->buckets[index], NULL);
-	mem_set_next_chunk((*info)->buckets[index], NULL);
+	mem_set_chunk_size((*info)->lo_bound, (*info)->total_size);
+	mem_link_chunk(*info, (*info)->lo_bound);
 
 	(*info)->used_size = 0;
 	(*info)->free_size = (*info)->total_size;
@@ -654,7 +918,7 @@ int	zbx_shmem_create_min(zbx_shmem_info_t **info, zbx_uint64_t size, const char
 	size += 8;
 	size += 2 * SHMEM_SIZE_FIELD;
 
-	return zbx_shmem_create(info, size, descr, param, allow_oom, error);
+	return zbx_shmem_create(info, size, descr, param, allow_oom, ZBX_SHMEM_ALLOC_FIRSTFIT, error);
 }
 
 void	zbx_shmem_destroy(zbx_shmem_info_t *info)
@@ -747,27 +1011,57 @@ void	__zbx_shmem_free(const char *file, int line, zbx_shmem_info_t *info, void *
 
 void	zbx_shmem_clear(zbx_shmem_info_t *info)
 {
-	int	index;
-
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
 	memset(info->buckets, 0, ZBX_SHMEM_BUCKET_COUNT * ZBX_PTR_SIZE);
-	index = mem_bucket_by_size(info->total_size);
-	info->buckets[index] = info->lo_bound;
-	mem_set_chunk_size(info->buckets[index], info->total_size);
-	mem_set_prev_chunk(info->buckets[index], NULL);
-	mem_set_next_chunk(info->buckets[index], NULL);
+	mem_set_chunk_size(info->lo_bound, info->total_size);
+	mem_link_chunk(info, info->lo_bound);
 	info->used_size = 0;
 	info->free_size = info->total_size;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: counts free chunks in the list starting with the specified chunk  *
+ *          and updates chunk size statistics                                 *
+ *                                                                            *
+ ******************************************************************************/
+static unsigned int	mem_list_get_stats(void *chunk, zbx_shmem_stats_t *stats)
+{
+	unsigned int	counter = 0;
+
+	while (NULL != chunk)
+	{
+		counter++;
+		stats->min_chunk_size = MIN(stats->min_chunk_size, CHUNK_SIZE(chunk));
+		stats->max_chunk_size = MAX(stats->max_chunk_size, CHUNK_SIZE(chunk));
+		chunk = mem_get_next_chunk(chunk);
+	}
+
+	return counter;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: counts free chunks in the size indexed tree and updates chunk     *
+ *          size statistics                                                   *
+ *                                                                            *
+ ******************************************************************************/
+static unsigned int	mem_tree_get_stats(void *node, zbx_shmem_stats_t *stats)
+{
+	if (NULL == node)
+		return 0;
+
+	return mem_list_get_stats(node, stats) + mem_tree_get_stats(mem_get_child_chunk(node, 0), stats) +
+			mem_tree_get_stats(mem_get_child_chunk(node, 1), stats);
+}
+
 void	zbx_shmem_get_stats(const zbx_shmem_info_t *info, zbx_shmem_stats_t *stats)
 {
-	void		*chunk;
 	int		i;
-	zbx_uint64_t	counter;
+	unsigned int	counter;
 
 	stats->free_chunks = 0;
 	stats->max_chunk_size = __UINT64_C(0);
@@ -775,16 +1069,10 @@ void	zbx_shmem_get_stats(const zbx_shmem_info_t *info, zbx_shmem_stats_t *stats)
 
 	for (i = 0; i < ZBX_SHMEM_BUCKET_COUNT; i++)
 	{
-		counter = 0;
-		chunk = info->buckets[i];
-
-		while (NULL != chunk)
-		{
-			counter++;
-			stats->min_chunk_size = MIN(stats->min_chunk_size, CHUNK_SIZE(chunk));
-			stats->max_chunk_size = MAX(stats->max_chunk_size, CHUNK_SIZE(chunk));
-			chunk = mem_get_next_chunk(chunk);
-		}
+		if (SHMEM_IS_TREE_BUCKET(info, i))
+			counter = mem_tree_get_stats(info->buckets[i], stats);
+		else
+			counter = mem_list_get_stats(info->buckets[i], stats);
 
 		stats->free_chunks += counter;
 		stats->chunks_num[i] = counter;
@@ -797,6 +1085,12 @@ void	zbx_shmem_get_stats(const zbx_shmem_info_t *info, zbx_shmem_stats_t *stats)
 	stats->used_chunks = stats->overhead / (2 * SHMEM_SIZE_FIELD) + 1 - stats->free_chunks;
 	stats->free_size = info->free_size;
 	stats->used_size = info->used_size;
+	stats->alloc_mode = info->alloc_mode;
+
+	if (0 != stats->free_size)
+		stats->fragmentation = 100.0 * (double)(stats->free_size - stats->max_chunk_size) / stats->free_size;
+	else
+		stats->fragmentation = 0;
 }
 
 void	zbx_shmem_dump_stats(int level, zbx_shmem_info_t *info)
@@ -806,7 +1100,8 @@ void	zbx_shmem_dump_stats(int level, zbx_shmem_info_t *info)
 
 	zbx_shmem_get_stats(info, &stats);
 
-	zabbix_log(level, "=== memory statistics for %s ===", info->mem_descr);
+	zabbix_log(level, "=== memory statistics for %s (%s) ===", info->mem_descr,
+			ZBX_SHMEM_ALLOC_BESTFIT == stats.alloc_mode ? "best-fit" : "first-fit");
 
 	for (i = 0; i < ZBX_SHMEM_BUCKET_COUNT; i++)
 	{
@@ -829,6 +1124,7 @@ void	zbx_shmem_dump_stats(int level, zbx_shmem_info_t *info)
 			(unsigned long long)stats.used_size, (unsigned long long)stats.used_chunks);
 	zabbix_log(level, "of those, %10llu bytes are used by allocation overhead",
 			(unsigned long long)stats.overhead);
+	zabbix_log(level, "free memory fragmentation: %.2f%%", stats.fragmentation);
 
 	zabbix_log(level, "================================");
 }
@@ -33,6 +33,12 @@
 #include "zbxcrypto.h"
 #include "zbxhash.h"
 #include "zbxexpr.h"
+#include "zbxpoller.h"
+
+#ifdef HAVE_NETSNMP
+#include <net-snmp/net-snmp-config.h>
+#include <net-snmp/net-snmp-includes.h>
+#endif
 
 static int	trap_fd = -1;
 static off_t	trap_lastsize;
@@ -41,6 +47,48 @@ static char	*buffer = NULL;
 static int	offset = 0;
 static int	force = 0;
 
+#define ZBX_SNMPTRAP_ITEM_SKIP		0
+#define ZBX_SNMPTRAP_ITEM_REGEXP	1
+#define ZBX_SNMPTRAP_ITEM_FALLBACK	2
+#define ZBX_SNMPTRAP_ITEM_ERROR		3
+
+/* trap waiting in batch for processing */
+typedef struct
+{
+	char		*addr;
+	char		*trap;
+	zbx_timespec_t	ts;
+}
+zbx_snmp_trap_t;
+
+ZBX_PTR_VECTOR_DECL(snmp_trap_ptr, zbx_snmp_trap_t *)
+ZBX_PTR_VECTOR_IMPL(snmp_trap_ptr, zbx_snmp_trap_t *)
+
+/* snmptrap[] item key parsed once per batch */
+typedef struct
+{
+	unsigned char	type;
+	char		*regex;		/* regular expression or global regular expression name prefixed by '@' */
+	zbx_regexp_t	*regexp;	/* precompiled regular expression, NULL for global regular expressions */
+	char		*literal;	/* string that must be present in trap for regexp to match or NULL */
+	char		*error;
+	int		lastclock;	/* timestamp of the last value, 0 if item did not receive any values */
+}
+zbx_snmp_trap_item_t;
+
+/* interface items cached for the duration of batch */
+typedef struct
+{
+	zbx_uint64_t		interfaceid;
+	zbx_dc_item_t		*items;
+	zbx_snmp_trap_item_t	*trap_items;
+	size_t			items_num;
+	zbx_timespec_t		ts;
+}
+zbx_snmp_trap_interface_t;
+
+static zbx_vector_snmp_trap_ptr_t	trap_batch;
+
 static void	db_update_lastsize(void)
 {
 	zbx_db_begin();
@@ -49,205 +97,404 @@ static void	db_update_lastsize(void)
 	zbx_db_commit();
 }
 
+static void	snmp_trap_free(zbx_snmp_trap_t *trap)
+{
+	zbx_free(trap->addr);
+	zbx_free(trap->trap);
+	zbx_free(trap);
+}
+
 /******************************************************************************
  *                                                                            *
- * Purpose: adds trap to all matching items for specified interface           *
+ * Purpose: parses snmptrap[] item key and prepares its regular expression    *
  *                                                                            *
- * Return value: SUCCEED - matching item was found                            *
- *               FAIL - no matching item was found (including fallback items) *
+ * Parameters: item      - [IN] configuration cache item                      *
+ *             trap_item - [OUT] parsed item                                  *
+ *             regexps   - [IN/OUT] global regular expressions used by batch  *
+ *             um_handle - [IN] user macro cache handle                       *
  *                                                                            *
  ******************************************************************************/
-static int	process_trap_for_interface(zbx_uint64_t interfaceid, char *trap, zbx_timespec_t *ts)
+static void	snmp_trap_item_prepare(zbx_dc_item_t *item, zbx_snmp_trap_item_t *trap_item,
+		zbx_vector_expression_t *regexps, zbx_dc_um_handle_t *um_handle)
 {
-	zbx_dc_item_t		*items = NULL;
-	const char		*regex;
-	char			error[ZBX_ITEM_ERROR_LEN_MAX];
-	int			ret = FAIL, fb = -1, value_type, regexp_ret;
-	AGENT_REQUEST		request;
-	zbx_vector_expression_t	regexps;
-	zbx_dc_um_handle_t	*um_handle;
+	char		error[ZBX_ITEM_ERROR_LEN_MAX], *err_msg = NULL;
+	const char	*regex;
+	AGENT_REQUEST	request;
 
-	zbx_vector_expression_create(&regexps);
+	memset(trap_item, 0, sizeof(zbx_snmp_trap_item_t));
 
-	um_handle = zbx_dc_open_user_macros_masked();
+	item->key = zbx_strdup(item->key, item->key_orig);
+	if (SUCCEED != zbx_substitute_item_key_params(&item->key, error, sizeof(error), zbx_item_key_subst_cb,
+			um_handle, item))
+	{
+		trap_item->type = ZBX_SNMPTRAP_ITEM_ERROR;
+		trap_item->error = zbx_strdup(NULL, error);
+		return;
+	}
 
-	size_t			num = zbx_dc_config_get_snmp_items_by_interfaceid(interfaceid, &items);
-	zbx_uint64_t		*itemids = (zbx_uint64_t *)zbx_malloc(NULL, sizeof(zbx_uint64_t) * num);
-	int			*lastclocks = (int *)zbx_malloc(NULL, sizeof(int) * num),
-				*errcodes = (int *)zbx_malloc(NULL, sizeof(int) * num);
-	AGENT_RESULT		*results = (AGENT_RESULT *)zbx_malloc(NULL, sizeof(AGENT_RESULT) * num);
+	if (0 == strcmp(item->key, "snmptrap.fallback"))
+	{
+		trap_item->type = ZBX_SNMPTRAP_ITEM_FALLBACK;
+		return;
+	}
+
+	zbx_init_agent_request(&request);
 
-	for (size_t i = 0; i < num; i++)
+	if (SUCCEED != zbx_parse_item_key(item->key, &request) || 0 != strcmp(get_rkey(&request), "snmptrap") ||
+			1 < get_rparams_num(&request))
 	{
-		zbx_init_agent_result(&results[i]);
-		errcodes[i] = FAIL;
+		goto out;
+	}
 
-		items[i].key = zbx_strdup(items[i].key, items[i].key_orig);
-		if (SUCCEED != zbx_substitute_item_key_params(&items[i].key, error, sizeof(error),
-				zbx_item_key_subst_cb, um_handle, &items[i]))
+	trap_item->type = ZBX_SNMPTRAP_ITEM_REGEXP;
+
+	if (NULL == (regex = get_rparam(&request, 0)))
+		goto out;
+
+	if ('@' == *regex)
+	{
+		if (SUCCEED != zbx_global_regexp_exists(regex + 1, regexps))
+			zbx_dc_get_expressions_by_name(regexps, regex + 1);
+
+		if (SUCCEED != zbx_global_regexp_exists(regex + 1, regexps))
 		{
-			SET_MSG_RESULT(&results[i], zbx_strdup(NULL, error));
-			errcodes[i] = NOTSUPPORTED;
-			continue;
+			trap_item->type = ZBX_SNMPTRAP_ITEM_ERROR;
+			trap_item->error = zbx_dsprintf(NULL, "Global regular expression \"%s\" does not exist.",
+					regex + 1);
+			goto out;
 		}
-
-		if (0 == strcmp(items[i].key, "snmptrap.fallback"))
+	}
+	else
+	{
+		if (SUCCEED != zbx_regexp_compile(regex, &trap_item->regexp, &err_msg))
 		{
-			fb = i;
-			continue;
+			trap_item->type = ZBX_SNMPTRAP_ITEM_ERROR;
+			trap_item->error = zbx_dsprintf(NULL, "Invalid regular expression \"%s\".", regex);
+			zbx_free(err_msg);
+			goto out;
 		}
 
-		zbx_init_agent_request(&request);
+		trap_item->literal = zbx_regexp_extract_literal(regex);
+	}
 
-		if (SUCCEED != zbx_parse_item_key(items[i].key, &request))
-			goto next;
+	trap_item->regex = zbx_strdup(NULL, regex);
+out:
+	zbx_free_agent_request(&request);
+}
 
-		if (0 != strcmp(get_rkey(&request), "snmptrap"))
-			goto next;
+static void	snmp_trap_item_clean(zbx_snmp_trap_item_t *trap_item)
+{
+	if (NULL != trap_item->regexp)
+		zbx_regexp_free(trap_item->regexp);
 
-		if (1 < get_rparams_num(&request))
-			goto next;
+	zbx_free(trap_item->regex);
+	zbx_free(trap_item->literal);
+	zbx_free(trap_item->error);
+}
 
-		if (NULL != (regex = get_rparam(&request, 0)))
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets interface items from batch cache, loading them from          *
+ *          configuration cache on first use                                  *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_snmp_trap_interface_t	*snmp_trap_get_interface(zbx_hashset_t *interfaces, zbx_uint64_t interfaceid,
+		zbx_vector_expression_t *regexps, zbx_dc_um_handle_t *um_handle)
+{
+	zbx_snmp_trap_interface_t	*interface, interface_local;
+
+	if (NULL != (interface = (zbx_snmp_trap_interface_t *)zbx_hashset_search(interfaces, &interfaceid)))
+		return interface;
+
+	interface_local.interfaceid = interfaceid;
+	interface_local.items = NULL;
+	interface_local.items_num = zbx_dc_config_get_snmp_items_by_interfaceid(interfaceid, &interface_local.items);
+	interface_local.trap_items = (zbx_snmp_trap_item_t *)zbx_malloc(NULL,
+			sizeof(zbx_snmp_trap_item_t) * interface_local.items_num);
+	interface_local.ts.sec = 0;
+	interface_local.ts.ns = 0;
+
+	for (size_t i = 0; i < interface_local.items_num; i++)
+	{
+		snmp_trap_item_prepare(&interface_local.items[i], &interface_local.trap_items[i], regexps,
+				um_handle);
+	}
+
+	return (zbx_snmp_trap_interface_t *)zbx_hashset_insert(interfaces, &interface_local,
+			sizeof(interface_local));
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if trap matches snmptrap[] item regular expression         *
+ *                                                                            *
+ * Return value: ZBX_REGEXP_MATCH    - trap matches                           *
+ *               ZBX_REGEXP_NO_MATCH - trap does not match                    *
+ *               FAIL                - invalid regular expression             *
+ *                                                                            *
+ * Comments: Literal required by the regular expression is searched first so  *
+ *           that most of not matching items are rejected without running     *
+ *           the regular expression.                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	snmp_trap_item_match(const zbx_snmp_trap_item_t *trap_item, const char *trap,
+		const zbx_vector_expression_t *regexps)
+{
+	if (NULL == trap_item->regex)
+		return ZBX_REGEXP_MATCH;
+
+	if (NULL != trap_item->literal && NULL == strstr(trap, trap_item->literal))
+		return ZBX_REGEXP_NO_MATCH;
+
+	if (NULL != trap_item->regexp)
+	{
+		return 0 == zbx_regexp_match_precompiled(trap, trap_item->regexp) ? ZBX_REGEXP_MATCH :
+				ZBX_REGEXP_NO_MATCH;
+	}
+
+	return zbx_regexp_match_ex(regexps, trap, trap_item->regex, ZBX_CASE_SENSITIVE);
+}
+
+static void	snmp_trap_item_set_value(zbx_dc_item_t *item, zbx_snmp_trap_item_t *trap_item, char *trap,
+		zbx_timespec_t *ts)
+{
+	AGENT_RESULT	result;
+	int		value_type;
+
+	zbx_init_agent_result(&result);
+
+	value_type = (ITEM_VALUE_TYPE_LOG == item->value_type ? ITEM_VALUE_TYPE_LOG : ITEM_VALUE_TYPE_TEXT);
+	zbx_set_agent_result_type(&result, value_type, trap);
+
+	if (ITEM_VALUE_TYPE_LOG == item->value_type)
+		zbx_calc_timestamp(result.log->value, &result.log->timestamp, item->logtimefmt);
+
+	item->state = ITEM_STATE_NORMAL;
+	zbx_preprocess_item_value(item->itemid, item->host.hostid, item->value_type, item->flags, &result, ts,
+			item->state, NULL);
+
+	trap_item->lastclock = ts->sec;
+
+	zbx_free_agent_result(&result);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds trap to all matching items for specified interface           *
+ *                                                                            *
+ * Return value: SUCCEED - matching item was found                            *
+ *               FAIL - no matching item was found (including fallback items) *
+ *                                                                            *
+ ******************************************************************************/
+static int	process_trap_for_interface(zbx_snmp_trap_interface_t *interface, char *trap, zbx_timespec_t *ts,
+		const zbx_vector_expression_t *regexps)
+{
+	int	ret = FAIL, fb = -1, regexp_ret;
+
+	interface->ts = *ts;
+
+	for (size_t i = 0; i < interface->items_num; i++)
+	{
+		zbx_snmp_trap_item_t	*trap_item = &interface->trap_items[i];
+
+		switch (trap_item->type)
 		{
-			if ('@' == *regex)
-			{
-				zbx_dc_get_expressions_by_name(&regexps, regex + 1);
+			case ZBX_SNMPTRAP_ITEM_FALLBACK:
+				fb = (int)i;
+				continue;
+			case ZBX_SNMPTRAP_ITEM_REGEXP:
+				break;
+			default:
+				continue;
+		}
 
-				if (0 == regexps.values_num)
-				{
-					SET_MSG_RESULT(&results[i], zbx_dsprintf(NULL,
-							"Global regular expression \"%s\" does not exist.", regex + 1));
-					errcodes[i] = NOTSUPPORTED;
-					goto next;
-				}
-			}
+		if (ZBX_REGEXP_NO_MATCH == (regexp_ret = snmp_trap_item_match(trap_item, trap, regexps)))
+			continue;
 
-			if (ZBX_REGEXP_NO_MATCH == (regexp_ret = zbx_regexp_match_ex(&regexps, trap, regex,
-					ZBX_CASE_SENSITIVE)))
-			{
-				goto next;
-			}
-			else if (FAIL == regexp_ret)
-			{
-				SET_MSG_RESULT(&results[i], zbx_dsprintf(NULL,
-						"Invalid regular expression \"%s\".", regex));
-				errcodes[i] = NOTSUPPORTED;
-				goto next;
-			}
+		if (FAIL == regexp_ret)
+		{
+			trap_item->type = ZBX_SNMPTRAP_ITEM_ERROR;
+			trap_item->error = zbx_dsprintf(NULL, "Invalid regular expression \"%s\".", trap_item->regex);
+			continue;
 		}
 
-		value_type = (ITEM_VALUE_TYPE_LOG == items[i].value_type ? ITEM_VALUE_TYPE_LOG : ITEM_VALUE_TYPE_TEXT);
-		zbx_set_agent_result_type(&results[i], value_type, trap);
-		errcodes[i] = SUCCEED;
+		snmp_trap_item_set_value(&interface->items[i], trap_item, trap, ts);
 		ret = SUCCEED;
-next:
-		zbx_free_agent_request(&request);
 	}
 
 	if (FAIL == ret && -1 != fb)
 	{
-		value_type = (ITEM_VALUE_TYPE_LOG == items[fb].value_type ? ITEM_VALUE_TYPE_LOG : ITEM_VALUE_TYPE_TEXT);
-		zbx_set_agent_result_type(&results[fb], value_type, trap);
-		errcodes[fb] = SUCCEED;
+		snmp_trap_item_set_value(&interface->items[fb], &interface->trap_items[fb], trap, ts);
 		ret = SUCCEED;
 	}
 
-	for (size_t i = 0; i < num; i++)
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: flushes interface items after all traps in batch were processed   *
+ *                                                                            *
+ * Parameters: interface  - [IN] interface with cached items                  *
+ *             itemids    - [OUT] items to requeue                            *
+ *             lastclocks - [OUT]                                             *
+ *             errcodes   - [OUT]                                             *
+ *                                                                            *
+ * Comments: Items failing to parse their key or regular expression are made  *
+ *           not supported once per batch.                                    *
+ *                                                                            *
+ ******************************************************************************/
+static void	snmp_trap_flush_interface(zbx_snmp_trap_interface_t *interface, zbx_vector_uint64_t *itemids,
+		zbx_vector_int32_t *lastclocks, zbx_vector_int32_t *errcodes)
+{
+	for (size_t i = 0; i < interface->items_num; i++)
 	{
-		switch (errcodes[i])
+		zbx_dc_item_t		*item = &interface->items[i];
+		zbx_snmp_trap_item_t	*trap_item = &interface->trap_items[i];
+
+		if (ZBX_SNMPTRAP_ITEM_ERROR == trap_item->type && 0 != interface->ts.sec)
 		{
-			case SUCCEED:
-				if (ITEM_VALUE_TYPE_LOG == items[i].value_type)
-				{
-					zbx_calc_timestamp(results[i].log->value, &results[i].log->timestamp,
-							items[i].logtimefmt);
-				}
+			item->state = ITEM_STATE_NOTSUPPORTED;
+			zbx_preprocess_item_value(item->itemid, item->host.hostid, item->value_type, item->flags, NULL,
+					&interface->ts, item->state, trap_item->error);
+
+			zbx_vector_uint64_append(itemids, item->itemid);
+			zbx_vector_int32_append(lastclocks, interface->ts.sec);
+			zbx_vector_int32_append(errcodes, NOTSUPPORTED);
+		}
+		else if (0 != trap_item->lastclock)
+		{
+			zbx_vector_uint64_append(itemids, item->itemid);
+			zbx_vector_int32_append(lastclocks, trap_item->lastclock);
+			zbx_vector_int32_append(errcodes, SUCCEED);
+		}
 
-				items[i].state = ITEM_STATE_NORMAL;
-				zbx_preprocess_item_value(items[i].itemid, items[i].host.hostid, items[i].value_type,
-						items[i].flags, &results[i], ts, items[i].state, NULL);
+		zbx_free(item->key);
+		snmp_trap_item_clean(trap_item);
+	}
 
-				itemids[i] = items[i].itemid;
-				lastclocks[i] = ts->sec;
-				break;
-			case NOTSUPPORTED:
-				items[i].state = ITEM_STATE_NOTSUPPORTED;
-				zbx_preprocess_item_value(items[i].itemid, items[i].host.hostid, items[i].value_type,
-						items[i].flags, NULL, ts, items[i].state, results[i].msg);
+	zbx_dc_config_clean_items(interface->items, NULL, interface->items_num);
+	zbx_free(interface->items);
+	zbx_free(interface->trap_items);
+}
 
-				itemids[i] = items[i].itemid;
-				lastclocks[i] = ts->sec;
-				break;
+/******************************************************************************
+ *                                                                            *
+ * Purpose: processes traps collected in batch                                *
+ *                                                                            *
+ * Comments: Interface items are retrieved and their keys parsed once per     *
+ *           batch, items are requeued and preprocessor is flushed once after *
+ *           all traps are processed.                                         *
+ *                                                                            *
+ ******************************************************************************/
+static void	process_trap_batch(void)
+{
+	zbx_hashset_t			interfaces;
+	zbx_hashset_iter_t		iter;
+	zbx_snmp_trap_interface_t	*interface;
+	zbx_vector_expression_t		regexps;
+	zbx_vector_uint64_t		itemids;
+	zbx_vector_int32_t		lastclocks, errcodes;
+	zbx_dc_um_handle_t		*um_handle;
+	int				snmptrap_logging = -1;
+
+	if (0 == trap_batch.values_num)
+		return;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() traps:%d", __func__, trap_batch.values_num);
+
+	zbx_hashset_create(&interfaces, 100, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	zbx_vector_expression_create(&regexps);
+
+	um_handle = zbx_dc_open_user_macros_masked();
+
+	for (int i = 0; i < trap_batch.values_num; i++)
+	{
+		zbx_snmp_trap_t	*trap = trap_batch.values[i];
+		zbx_uint64_t	*interfaceids = NULL;
+		int		ret = FAIL, count;
+
+		count = zbx_dc_config_get_snmp_interfaceids_by_addr(trap->addr, &interfaceids);
+
+		for (int j = 0; j < count; j++)
+		{
+			interface = snmp_trap_get_interface(&interfaces, interfaceids[j], &regexps, um_handle);
+
+			if (SUCCEED == process_trap_for_interface(interface, trap->trap, &trap->ts, &regexps))
+				ret = SUCCEED;
 		}
 
-		zbx_free(items[i].key);
-		zbx_free_agent_result(&results[i]);
-	}
+		if (FAIL == ret)
+		{
+			if (-1 == snmptrap_logging)
+			{
+				zbx_config_t	cfg;
 
-	zbx_free(results);
+				zbx_config_get(&cfg, ZBX_CONFIG_FLAGS_SNMPTRAP_LOGGING);
+				snmptrap_logging = cfg.snmptrap_logging;
+				zbx_config_clean(&cfg);
+			}
+
+			if (ZBX_SNMPTRAP_LOGGING_ENABLED == snmptrap_logging)
+			{
+				zabbix_log(LOG_LEVEL_WARNING, "unmatched trap received from \"%s\": %s", trap->addr,
+						trap->trap);
+			}
+		}
 
-	zbx_dc_requeue_items(itemids, lastclocks, errcodes, num);
+		zbx_free(interfaceids);
+	}
 
-	zbx_free(errcodes);
-	zbx_free(lastclocks);
-	zbx_free(itemids);
+	zbx_vector_uint64_create(&itemids);
+	zbx_vector_int32_create(&lastclocks);
+	zbx_vector_int32_create(&errcodes);
 
-	zbx_dc_config_clean_items(items, NULL, num);
-	zbx_free(items);
+	zbx_hashset_iter_reset(&interfaces, &iter);
+	while (NULL != (interface = (zbx_snmp_trap_interface_t *)zbx_hashset_iter_next(&iter)))
+		snmp_trap_flush_interface(interface, &itemids, &lastclocks, &errcodes);
 
 	zbx_dc_close_user_macros(um_handle);
 
+	if (0 != itemids.values_num)
+	{
+		zbx_dc_requeue_items(itemids.values, lastclocks.values, errcodes.values,
+				(size_t)itemids.values_num);
+	}
+
+	zbx_preprocessor_flush();
+
+	zbx_vector_int32_destroy(&errcodes);
+	zbx_vector_int32_destroy(&lastclocks);
+	zbx_vector_uint64_destroy(&itemids);
+
 	zbx_regexp_clean_expressions(&regexps);
 	zbx_vector_expression_destroy(&regexps);
+	zbx_hashset_destroy(&interfaces);
 
-	zbx_preprocessor_flush();
+	zbx_vector_snmp_trap_ptr_clear_ext(&trap_batch, snmp_trap_free);
 
-	return ret;
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: processes single trap                                             *
+ * Purpose: adds single trap to batch                                         *
  *                                                                            *
  * Parameters: addr  - [IN] address of target interface(s)                    *
  *             begin - [IN] beginning of trap message                         *
  *             end   - [IN] end of trap message                               *
  *                                                                            *
  ******************************************************************************/
-static void	process_trap(const char *addr, char *begin, char *end)
+static void	process_trap(const char *addr, const char *begin, const char *end)
 {
-	zbx_timespec_t	ts;
-	zbx_uint64_t	*interfaceids = NULL;
-	int		ret = FAIL;
-	char		*trap = NULL;
-
-	zbx_timespec(&ts);
-
-	trap = zbx_dsprintf(trap, "%s%s", begin, end);
-
-	int	count = zbx_dc_config_get_snmp_interfaceids_by_addr(addr, &interfaceids);
-
-	for (int i = 0; i < count; i++)
-	{
-		if (SUCCEED == process_trap_for_interface(interfaceids[i], trap, &ts))
-			ret = SUCCEED;
-	}
-
-	if (FAIL == ret)
-	{
-		zbx_config_t	cfg;
+	zbx_snmp_trap_t	*trap;
 
-		zbx_config_get(&cfg, ZBX_CONFIG_FLAGS_SNMPTRAP_LOGGING);
+	trap = (zbx_snmp_trap_t *)zbx_malloc(NULL, sizeof(zbx_snmp_trap_t));
+	trap->addr = zbx_strdup(NULL, addr);
+	trap->trap = zbx_dsprintf(NULL, "%s%s", begin, end);
+	zbx_timespec(&trap->ts);
 
-		if (ZBX_SNMPTRAP_LOGGING_ENABLED == cfg.snmptrap_logging)
-			zabbix_log(LOG_LEVEL_WARNING, "unmatched trap received from \"%s\": %s", addr, trap);
-
-		zbx_config_clean(&cfg);
-	}
-
-	zbx_free(interfaceids);
-	zbx_free(trap);
+	zbx_vector_snmp_trap_ptr_append(&trap_batch, trap);
 }
 
 /******************************************************************************
@@ -455,6 +702,8 @@ static void	parse_traps(int flag, int snmp_timestamp, const char *snmp_id_bin, i
 		end = c + 1;	/* the rest of the trap */
 	}
 
+	process_trap_batch();
+
 	if (NULL != last_trap)
 		db_update_snmp_id(last_date, last_trap);
 
@@ -505,6 +754,7 @@ static void	parse_traps(int flag, int snmp_timestamp, const char *snmp_id_bin, i
 			else
 			{
 				process_trap(addr, begin, end);
+				process_trap_batch();
 
 				if (NULL != config_node_name)
 					db_update_snmp_id(begin, end);
@@ -838,6 +1088,366 @@ static int	get_latest_data(const char *config_snmptrap_file, const char *config_
 	return SUCCEED;
 }
 
+#ifdef HAVE_NETSNMP
+#define ZBX_SNMPTRAP_READ_MAX	1000
+
+static void		*trap_sessp = NULL;
+static const char	*trap_communities = NULL;
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if trap community is accepted by listener                  *
+ *                                                                            *
+ * Return value: SUCCEED - community is accepted or no communities are        *
+ *                         configured                                         *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	snmp_trap_check_community(const netsnmp_pdu *pdu)
+{
+	char	*community;
+	int	ret;
+
+	if (NULL == trap_communities || '\0' == *trap_communities)
+		return SUCCEED;
+
+	if (NULL == pdu->community)
+		return FAIL;
+
+	community = (char *)zbx_malloc(NULL, pdu->community_len + 1);
+	memcpy(community, pdu->community, pdu->community_len);
+	community[pdu->community_len] = '\0';
+
+	ret = zbx_str_in_list(trap_communities, community, ',');
+
+	zbx_free(community);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: appends variable binding to trap in the same format as            *
+ *          zabbix_trap_receiver.pl                                           *
+ *                                                                            *
+ ******************************************************************************/
+static void	snmp_trap_append_var(char **trap, size_t *trap_alloc, size_t *trap_offset,
+		const netsnmp_variable_list *var)
+{
+	u_char	*buf;
+	char	*name = NULL;
+	size_t	buf_len = 256, out_len = 0;
+
+	buf = (u_char *)zbx_malloc(NULL, buf_len);
+	*buf = '\0';
+
+	if (1 != sprint_realloc_objid(&buf, &buf_len, &out_len, 1, var->name, var->name_length))
+		goto out;
+
+	name = zbx_strdup(NULL, (const char *)buf);
+	out_len = 0;
+	*buf = '\0';
+
+	if (1 != sprint_realloc_value(&buf, &buf_len, &out_len, 1, var->name, var->name_length, var))
+		goto out;
+
+	zbx_snprintf_alloc(trap, trap_alloc, trap_offset, "  %-30s type=%-2d value=%s\n", name, (int)var->type,
+			(const char *)buf);
+out:
+	zbx_free(name);
+	zbx_free(buf);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: appends SNMPv1 trap converted to SNMPv2 notification variable     *
+ *          bindings as described in RFC 3584 section 3.1                     *
+ *                                                                            *
+ ******************************************************************************/
+static void	snmp_trap_append_v1_vars(char **trap, size_t *trap_alloc, size_t *trap_offset,
+		const netsnmp_pdu *pdu)
+{
+	static oid		sysuptime_oid[] = {1, 3, 6, 1, 2, 1, 1, 3, 0},
+				snmptrapoid_oid[] = {1, 3, 6, 1, 6, 3, 1, 1, 4, 1, 0},
+				snmptrapenterprise_oid[] = {1, 3, 6, 1, 6, 3, 1, 1, 4, 3, 0},
+				snmptraps_oid[] = {1, 3, 6, 1, 6, 3, 1, 1, 5};
+	oid			trap_oid[MAX_OID_LEN];
+	size_t			trap_oid_len;
+	u_long			uptime = (u_long)pdu->time;
+	netsnmp_variable_list	*vars = NULL, *var;
+
+	if (SNMP_TRAP_ENTERPRISESPECIFIC == pdu->trap_type)
+	{
+		if (pdu->enterprise_length + 2 > MAX_OID_LEN)
+			return;
+
+		memcpy(trap_oid, pdu->enterprise, pdu->enterprise_length * sizeof(oid));
+		trap_oid_len = pdu->enterprise_length;
+		trap_oid[trap_oid_len++] = 0;
+		trap_oid[trap_oid_len++] = (oid)pdu->specific_type;
+	}
+	else
+	{
+		memcpy(trap_oid, snmptraps_oid, sizeof(snmptraps_oid));
+		trap_oid_len = OID_LENGTH(snmptraps_oid);
+		trap_oid[trap_oid_len++] = (oid)pdu->trap_type + 1;
+	}
+
+	snmp_varlist_add_variable(&vars, sysuptime_oid, OID_LENGTH(sysuptime_oid), ASN_TIMETICKS,
+			(const void *)&uptime, sizeof(uptime));
+	snmp_varlist_add_variable(&vars, snmptrapoid_oid, OID_LENGTH(snmptrapoid_oid), ASN_OBJECT_ID,
+			(const void *)trap_oid, trap_oid_len * sizeof(oid));
+
+	for (var = vars; NULL != var; var = var->next_variable)
+		snmp_trap_append_var(trap, trap_alloc, trap_offset, var);
+
+	for (var = pdu->variables; NULL != var; var = var->next_variable)
+		snmp_trap_append_var(trap, trap_alloc, trap_offset, var);
+
+	snmp_free_varbind(vars);
+	vars = NULL;
+
+	snmp_varlist_add_variable(&vars, snmptrapenterprise_oid, OID_LENGTH(snmptrapenterprise_oid),
+			ASN_OBJECT_ID, (const void *)pdu->enterprise, pdu->enterprise_length * sizeof(oid));
+	snmp_trap_append_var(trap, trap_alloc, trap_offset, vars);
+	snmp_free_varbind(vars);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds trap received by listener to batch                           *
+ *                                                                            *
+ * Comments: The trap is formatted the same way as zabbix_trap_receiver.pl    *
+ *           writes it to trap file, so existing snmptrap[] item regular      *
+ *           expressions keep matching.                                       *
+ *                                                                            *
+ ******************************************************************************/
+static int	snmp_trap_receive_cb(int operation, netsnmp_session *session, int reqid, netsnmp_pdu *pdu,
+		void *magic)
+{
+	netsnmp_transport	*transport;
+	netsnmp_variable_list	*var;
+	zbx_snmp_trap_t		*trap;
+	char			*from = NULL, *addr, *ptr, date[64], *text = NULL;
+	size_t			text_alloc = 0, text_offset = 0;
+	time_t			now;
+	struct tm		tm;
+
+	ZBX_UNUSED(session);
+	ZBX_UNUSED(reqid);
+	ZBX_UNUSED(magic);
+
+	if (NETSNMP_CALLBACK_OP_RECEIVED_MESSAGE != operation)
+		return 1;
+
+	if (SNMP_MSG_TRAP != pdu->command && SNMP_MSG_TRAP2 != pdu->command && SNMP_MSG_INFORM != pdu->command)
+		return 1;
+
+	if (NULL != (transport = snmp_sess_transport(trap_sessp)) && NULL != transport->f_fmtaddr)
+		from = transport->f_fmtaddr(transport, pdu->transport_data, pdu->transport_data_length);
+
+	if (NULL == from)
+		from = zbx_strdup(NULL, "");
+
+	if (SUCCEED != snmp_trap_check_community(pdu))
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "dropped SNMP trap from \"%s\" with not allowed community", from);
+		zbx_free(from);
+		return 1;
+	}
+
+	/* extract host address from "UDP: [127.0.0.1]:41070->[127.0.0.1]:162" */
+	if (NULL != (ptr = strchr(from, '[')) && NULL != (addr = strchr(++ptr, ']')))
+		addr = zbx_dsprintf(NULL, "%.*s", (int)(addr - ptr), ptr);
+	else
+		addr = zbx_strdup(NULL, from);
+
+	now = time(NULL);
+	localtime_r(&now, &tm);
+	strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S%z", &tm);
+
+	zbx_snprintf_alloc(&text, &text_alloc, &text_offset, "%s PDU INFO:\n", date);
+	zbx_snprintf_alloc(&text, &text_alloc, &text_offset, "  %-30s %s\n", "notificationtype",
+			SNMP_MSG_INFORM == pdu->command ? "INFORM" : "TRAP");
+	zbx_snprintf_alloc(&text, &text_alloc, &text_offset, "  %-30s %ld\n", "version", pdu->version);
+	zbx_snprintf_alloc(&text, &text_alloc, &text_offset, "  %-30s %s\n", "receivedfrom", from);
+	zbx_snprintf_alloc(&text, &text_alloc, &text_offset, "  %-30s %.*s\n", "community",
+			(int)pdu->community_len, NULL != pdu->community ? (const char *)pdu->community : "");
+	zbx_snprintf_alloc(&text, &text_alloc, &text_offset, "  %-30s %ld\n", "requestid", pdu->reqid);
+	zbx_snprintf_alloc(&text, &text_alloc, &text_offset, "  %-30s %ld\n", "messageid", pdu->msgid);
+	zbx_snprintf_alloc(&text, &text_alloc, &text_offset, "  %-30s %ld\n", "transactionid", pdu->transid);
+	zbx_snprintf_alloc(&text, &text_alloc, &text_offset, "  %-30s %ld\n", "errorstatus", pdu->errstat);
+	zbx_snprintf_alloc(&text, &text_alloc, &text_offset, "  %-30s %ld\n", "errorindex", pdu->errindex);
+	zbx_strcpy_alloc(&text, &text_alloc, &text_offset, "VARBINDS:\n");
+
+	if (SNMP_MSG_TRAP == pdu->command)
+	{
+		snmp_trap_append_v1_vars(&text, &text_alloc, &text_offset, pdu);
+	}
+	else
+	{
+		for (var = pdu->variables; NULL != var; var = var->next_variable)
+			snmp_trap_append_var(&text, &text_alloc, &text_offset, var);
+	}
+
+	/* trap read from file does not have trailing newline */
+	text[--text_offset] = '\0';
+
+	trap = (zbx_snmp_trap_t *)zbx_malloc(NULL, sizeof(zbx_snmp_trap_t));
+	trap->addr = addr;
+	trap->trap = text;
+	zbx_timespec(&trap->ts);
+	zbx_vector_snmp_trap_ptr_append(&trap_batch, trap);
+
+	zbx_free(from);
+
+	if (SNMP_MSG_INFORM == pdu->command)
+	{
+		netsnmp_pdu	*reply;
+
+		if (NULL != (reply = snmp_clone_pdu(pdu)))
+		{
+			reply->command = SNMP_MSG_RESPONSE;
+			reply->errstat = 0;
+			reply->errindex = 0;
+
+			if (0 == snmp_sess_send(trap_sessp, reply))
+			{
+				zabbix_log(LOG_LEVEL_DEBUG, "cannot send response to SNMP inform: %s",
+						snmp_api_errstring(snmp_errno));
+				snmp_free_pdu(reply);
+			}
+		}
+	}
+
+	return 1;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: opens UDP socket to receive SNMPv1 and SNMPv2c traps directly     *
+ *          without snmptrapd and intermediate trap file                      *
+ *                                                                            *
+ * Parameters: progname    - [IN] program name used to load SNMP            *
+ *                                configuration                               *
+ *             port        - [IN] UDP port to listen on                       *
+ *             communities - [IN] comma delimited list of accepted            *
+ *                                communities, all are accepted if empty      *
+ *                                                                            *
+ * Return value: SUCCEED - listener was opened                                *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	snmp_trap_listener_open(const char *progname, int port, const char *communities)
+{
+	netsnmp_session		session;
+	netsnmp_transport	*transport;
+	char			listen_addr[16];
+
+	zbx_init_library_mt_snmp(progname);
+
+	trap_communities = communities;
+
+	zbx_snprintf(listen_addr, sizeof(listen_addr), "udp:%d", port);
+
+	if (NULL == (transport = netsnmp_tdomain_transport(listen_addr, 1, "udp")))
+	{
+		zabbix_log(LOG_LEVEL_CRIT, "cannot listen for SNMP traps on \"%s\": %s", listen_addr,
+				snmp_api_errstring(snmp_errno));
+		zbx_shutdown_library_mt_snmp(progname);
+		return FAIL;
+	}
+
+	snmp_sess_init(&session);
+	session.peername = SNMP_DEFAULT_PEERNAME;
+	session.version = SNMP_DEFAULT_VERSION;
+	session.community_len = SNMP_DEFAULT_COMMUNITY_LEN;
+	session.retries = SNMP_DEFAULT_RETRIES;
+	session.timeout = SNMP_DEFAULT_TIMEOUT;
+	session.callback = snmp_trap_receive_cb;
+	session.callback_magic = NULL;
+	session.isAuthoritative = SNMP_SESS_UNKNOWNAUTH;
+
+	/* transport is closed by library if session cannot be added */
+	if (NULL == (trap_sessp = snmp_sess_add(&session, transport, NULL, NULL)))
+	{
+		zabbix_log(LOG_LEVEL_CRIT, "cannot create SNMP trap listener session: %s",
+				snmp_api_errstring(snmp_errno));
+		zbx_shutdown_library_mt_snmp(progname);
+		return FAIL;
+	}
+
+	zabbix_log(LOG_LEVEL_INFORMATION, "listening for SNMP traps on \"%s\"", listen_addr);
+
+	return SUCCEED;
+}
+
+static void	snmp_trap_listener_close(const char *progname)
+{
+	if (NULL == trap_sessp)
+		return;
+
+	snmp_sess_close(trap_sessp);
+	trap_sessp = NULL;
+
+	zbx_shutdown_library_mt_snmp(progname);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: waits for traps on listener socket instead of sleeping and        *
+ *          processes received traps as single batch                          *
+ *                                                                            *
+ * Parameters: info    - [IN] thread information                              *
+ *             timeout - [IN] maximum time to wait for first trap in seconds  *
+ *                                                                            *
+ * Comments: After the first trap arrives all already queued datagrams are    *
+ *           read without waiting, up to ZBX_SNMPTRAP_READ_MAX.               *
+ *                                                                            *
+ ******************************************************************************/
+static void	snmp_trap_listener_wait(const zbx_thread_info_t *info, int timeout)
+{
+	netsnmp_transport	*transport;
+	fd_set			fdset;
+	struct timeval		tv;
+	int			received = 0;
+
+	if (NULL == (transport = snmp_sess_transport(trap_sessp)))
+	{
+		zbx_sleep_loop(info, timeout);
+		return;
+	}
+
+	zbx_update_selfmon_counter(info, ZBX_PROCESS_STATE_IDLE);
+
+	tv.tv_sec = timeout;
+	tv.tv_usec = 0;
+
+	while (ZBX_SNMPTRAP_READ_MAX > received && ZBX_IS_RUNNING())
+	{
+		FD_ZERO(&fdset);
+		FD_SET(transport->sock, &fdset);
+
+		if (0 >= select(transport->sock + 1, &fdset, NULL, NULL, &tv))
+			break;
+
+		if (0 == received++)
+			zbx_update_selfmon_counter(info, ZBX_PROCESS_STATE_BUSY);
+
+		snmp_sess_read(trap_sessp, &fdset);
+
+		tv.tv_sec = 0;
+		tv.tv_usec = 0;
+	}
+
+	if (0 == received)
+		zbx_update_selfmon_counter(info, ZBX_PROCESS_STATE_BUSY);
+
+	process_trap_batch();
+}
+#undef ZBX_SNMPTRAP_READ_MAX
+#endif
+
 /******************************************************************************
  *                                                                            *
  * Purpose: SNMP trap reader's entry point                                    *
@@ -870,8 +1480,22 @@ ZBX_THREAD_ENTRY(zbx_snmptrapper_thread, args)
 	buffer = (char *)zbx_malloc(buffer, MAX_BUFFER_LEN);
 	*buffer = '\0';
 
+	zbx_vector_snmp_trap_ptr_create(&trap_batch);
+
 	DBget_lastsize(snmptrapper_args_in->config_ha_node_name, snmptrapper_args_in->config_snmptrap_file);
 
+	if (0 != snmptrapper_args_in->config_snmptrap_listen_port)
+	{
+#ifdef HAVE_NETSNMP
+		snmp_trap_listener_open(snmptrapper_args_in->progname,
+				snmptrapper_args_in->config_snmptrap_listen_port,
+				snmptrapper_args_in->config_snmptrap_listen_community);
+#else
+		zabbix_log(LOG_LEVEL_WARNING, "SNMP trap listener cannot be started: Zabbix was compiled without"
+				" Net-SNMP support");
+#endif
+	}
+
 	while (ZBX_IS_RUNNING())
 	{
 		sec = zbx_time();
@@ -896,9 +1520,21 @@ ZBX_THREAD_ENTRY(zbx_snmptrapper_thread, args)
 		zbx_setproctitle("%s [processed data in " ZBX_FS_DBL " sec, idle 1 sec%s]",
 				get_process_type_string(process_type), sec, zbx_vps_monitor_status());
 
+#ifdef HAVE_NETSNMP
+		if (NULL != trap_sessp)
+		{
+			snmp_trap_listener_wait(info, 1);
+			continue;
+		}
+#endif
 		zbx_sleep_loop(info, 1);
 	}
 
+#ifdef HAVE_NETSNMP
+	snmp_trap_listener_close(snmptrapper_args_in->progname);
+#endif
+	zbx_vector_snmp_trap_ptr_clear_ext(&trap_batch, snmp_trap_free);
+	zbx_vector_snmp_trap_ptr_destroy(&trap_batch);
 	zbx_free(buffer);
 
 	if (-1 != trap_fd)
@@ -0,0 +1,301 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "procsnap.h"
+
+#include "stats.h"
+#include "zbxnix.h"
+#include "zbxtime.h"
+#include "zbxmutexs.h"
+
+#ifdef ZBX_PROCSNAP_COLLECTOR
+
+/*
+ * The process snapshot is a copy of process attributes (names, user, state,
+ * memory usage) of all processes, taken by collector and shared with the
+ * processes serving checks, so every proc.num and proc.mem check does not
+ * have to walk /proc on its own.
+ *
+ *  .--------------------------------------.
+ *  | header                               |
+ *  | ------------------------------------ |
+ *  | snapshot data (platform specific)    |
+ *  '--------------------------------------'
+ *
+ * The shared memory segment is allocated by the first snapshot request.
+ * Collector refreshes the snapshot once per configured interval as long as
+ * it has been requested during the last PROCSNAP_MAX_INACTIVITY_PERIOD.
+ * Requests made before the first snapshot is taken or when the snapshot is
+ * older than the configured interval (collector is busy or has not refreshed
+ * it yet) fail and the caller reads /proc directly, so the values are never
+ * more than ProcessSnapshotInterval seconds old.
+ */
+
+/* local reference to the process snapshot shared memory */
+static zbx_dshm_ref_t	procsnap_ref;
+
+/* the snapshot refresh interval in seconds, 0 - disabled */
+static int		procsnap_interval;
+
+typedef struct
+{
+	/* the total shared memory segment size */
+	size_t	size;
+
+	/* the size of snapshot data */
+	size_t	data_size;
+
+	/* the time when snapshot was taken, 0 if it has not been taken yet */
+	int	timestamp;
+
+	/* the last access time (request from server) */
+	int	last_accessed;
+}
+zbx_procsnap_header_t;
+
+#define PROCSNAP_ALIGNED_HEADER_SIZE	ZBX_SIZE_T_ALIGN8(sizeof(zbx_procsnap_header_t))
+
+/* the time period after which snapshot is not refreshed if it is not accessed */
+#define PROCSNAP_MAX_INACTIVITY_PERIOD	SEC_PER_DAY
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: reattaches the procsnap_ref to the shared memory segment if it    *
+ *          was resized by other process                                      *
+ *                                                                            *
+ * Comments: This function logs critical error and exits in the case of       *
+ *           shared memory segment operation failure.                         *
+ *                                                                            *
+ ******************************************************************************/
+static void	procsnap_reattach(void)
+{
+	char	*errmsg = NULL;
+
+	if (FAIL == zbx_dshm_validate_ref(&(get_collector())->procsnap, &procsnap_ref, &errmsg))
+	{
+		zabbix_log(LOG_LEVEL_CRIT, "cannot validate process snapshot collector reference: %s", errmsg);
+		zbx_free(errmsg);
+		exit(EXIT_FAILURE);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: initializes new shared memory segment                             *
+ *                                                                            *
+ * Parameters: dst      - [OUT] destination segment                           *
+ *             size_dst - [IN] size of destination segment                    *
+ *             src      - [IN] source segment                                 *
+ *                                                                            *
+ * Comments: The snapshot data is not copied because segment is reallocated   *
+ *           only before storing a new snapshot.                              *
+ *                                                                            *
+ ******************************************************************************/
+static void	procsnap_copy_data(void *dst, size_t size_dst, const void *src)
+{
+	zbx_procsnap_header_t	*hdst = (zbx_procsnap_header_t *)dst;
+
+	hdst->size = size_dst;
+	hdst->data_size = 0;
+	hdst->timestamp = 0;
+	hdst->last_accessed = (NULL != src ? ((const zbx_procsnap_header_t *)src)->last_accessed : 0);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: reallocates shared memory segment                                 *
+ *                                                                            *
+ * Comments: This function logs critical error and exits in the case of       *
+ *           shared memory segment operation failure.                         *
+ *                                                                            *
+ ******************************************************************************/
+static void	procsnap_realloc(size_t size)
+{
+	char	*errmsg = NULL;
+
+	if (FAIL == zbx_dshm_realloc(&(get_collector())->procsnap, size, &errmsg))
+	{
+		zabbix_log(LOG_LEVEL_CRIT, "cannot reallocate memory in process snapshot collector: %s", errmsg);
+		zbx_free(errmsg);
+		zbx_dshm_unlock(&(get_collector())->procsnap);
+
+		exit(EXIT_FAILURE);
+	}
+
+	/* header initialised in procsnap_copy_data() which is called back from zbx_dshm_realloc() */
+	procsnap_reattach();
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if process snapshot collector is enabled                   *
+ *                                                                            *
+ ******************************************************************************/
+static int	procsnap_enabled(void)
+{
+	if (0 == procsnap_interval || NULL == get_collector())
+		return FAIL;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: initializes process snapshot collector                            *
+ *                                                                            *
+ * Parameters: interval - [IN] snapshot refresh interval in seconds,          *
+ *                             0 - disabled                                   *
+ *                                                                            *
+ * Return value: This function calls exit() on shared memory errors.          *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_procsnap_init(int interval)
+{
+	char	*errmsg = NULL;
+
+	if (SUCCEED != zbx_dshm_create(&(get_collector())->procsnap, 0, ZBX_MUTEX_PROCSNAP, procsnap_copy_data,
+			&errmsg))
+	{
+		zabbix_log(LOG_LEVEL_CRIT, "cannot initialize process snapshot collector: %s", errmsg);
+		zbx_free(errmsg);
+		exit(EXIT_FAILURE);
+	}
+
+	procsnap_interval = interval;
+	procsnap_ref.shmid = ZBX_NONEXISTENT_SHMID;
+	procsnap_ref.addr = NULL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: destroys process snapshot collector                               *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_procsnap_destroy(void)
+{
+	char	*errmsg = NULL;
+
+	if (SUCCEED != zbx_dshm_destroy(&(get_collector())->procsnap, &errmsg))
+	{
+		zabbix_log(LOG_LEVEL_CRIT, "cannot free resources allocated by process snapshot collector: %s",
+				errmsg);
+		zbx_free(errmsg);
+	}
+
+	procsnap_ref.shmid = ZBX_NONEXISTENT_SHMID;
+	procsnap_ref.addr = NULL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: locks process snapshot for reading                                *
+ *                                                                            *
+ * Parameters: data - [OUT] snapshot data                                     *
+ *                                                                            *
+ * Return value: SUCCEED - snapshot is locked, it must be unlocked with       *
+ *                         zbx_procsnap_unlock() after reading                *
+ *               FAIL    - snapshot is disabled, has not been taken yet or    *
+ *                         is outdated                                        *
+ *                                                                            *
+ * Comments: This function calls exit() on shared memory errors.              *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_procsnap_lock(const void **data)
+{
+	zbx_procsnap_header_t	*header;
+	int			now;
+
+	if (SUCCEED != procsnap_enabled())
+		return FAIL;
+
+	zbx_dshm_lock(&(get_collector())->procsnap);
+
+	/* the first request allocates segment to let collector know that snapshot is needed */
+	if (ZBX_NONEXISTENT_SHMID == (get_collector())->procsnap.shmid)
+		procsnap_realloc(PROCSNAP_ALIGNED_HEADER_SIZE);
+	else
+		procsnap_reattach();
+
+	header = (zbx_procsnap_header_t *)procsnap_ref.addr;
+	header->last_accessed = now = (int)time(NULL);
+
+	if (0 == header->timestamp || header->timestamp + procsnap_interval < now)
+	{
+		zbx_dshm_unlock(&(get_collector())->procsnap);
+		return FAIL;
+	}
+
+	*data = (const char *)header + PROCSNAP_ALIGNED_HEADER_SIZE;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: unlocks process snapshot locked by zbx_procsnap_lock()            *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_procsnap_unlock(void)
+{
+	zbx_dshm_unlock(&(get_collector())->procsnap);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: refreshes process snapshot if it has been requested and is older  *
+ *          than the configured interval                                      *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_procsnap_collect(void)
+{
+	zbx_procsnap_header_t	*header;
+	char			*data;
+	size_t			data_size;
+	int			now, timestamp, last_accessed;
+
+	if (SUCCEED != procsnap_enabled() || ZBX_NONEXISTENT_SHMID == (get_collector())->procsnap.shmid)
+		return;
+
+	zbx_dshm_lock(&(get_collector())->procsnap);
+	procsnap_reattach();
+	header = (zbx_procsnap_header_t *)procsnap_ref.addr;
+	timestamp = header->timestamp;
+	last_accessed = header->last_accessed;
+	zbx_dshm_unlock(&(get_collector())->procsnap);
+
+	now = (int)time(NULL);
+
+	if (timestamp + procsnap_interval > now || last_accessed + PROCSNAP_MAX_INACTIVITY_PERIOD < now)
+		return;
+
+	if (SUCCEED != zbx_proc_get_snapshot(&data, &data_size))
+		return;
+
+	zbx_dshm_lock(&(get_collector())->procsnap);
+	procsnap_reattach();
+
+	if ((get_collector())->procsnap.size < PROCSNAP_ALIGNED_HEADER_SIZE + data_size)
+		procsnap_realloc(PROCSNAP_ALIGNED_HEADER_SIZE + data_size);
+
+	header = (zbx_procsnap_header_t *)procsnap_ref.addr;
+	memcpy((char *)header + PROCSNAP_ALIGNED_HEADER_SIZE, data, data_size);
+	header->data_size = data_size;
+	header->timestamp = now;
+
+	zbx_dshm_unlock(&(get_collector())->procsnap);
+
+	zbx_free(data);
+}
+
+#endif
@@ -0,0 +1,35 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#ifndef ZABBIX_PROCSNAP_H
+#define ZABBIX_PROCSNAP_H
+
+#include "config.h"
+
+#ifdef ZBX_PROCSNAP_COLLECTOR
+
+#include "zbxtypes.h"
+
+void	zbx_procsnap_init(int interval);
+void	zbx_procsnap_destroy(void);
+int	zbx_procsnap_lock(const void **data);
+void	zbx_procsnap_unlock(void);
+void	zbx_procsnap_collect(void);
+
+/* external function used by process snapshot collector */
+int	zbx_proc_get_snapshot(char **data, size_t *data_size);
+
+#endif	/* ZBX_PROCSNAP_COLLECTOR */
+
+#endif	/* ZABBIX_PROCSNAP_H */
@@ -24,6 +24,10 @@
 #	include "procstat.h"
 #endif
 
+#ifdef ZBX_PROCSNAP_COLLECTOR
+#	include "procsnap.h"
+#endif
+
 #ifdef _WINDOWS
 #	include "zbxwinservice.h"
 #	include "../win32/perfstat/perfstat.h"
@@ -151,7 +155,7 @@ return_one:
  * Comments: Unix version allocates memory as shared.                         *
  *                                                                            *
  ******************************************************************************/
-int	zbx_init_collector_data(char **error)
+int	zbx_init_collector_data(int config_process_snapshot_interval, char **error)
 {
 	int	cpu_count, ret = FAIL;
 	size_t	sz, sz_cpu, sz_cpu_phys_util = 0;
@@ -213,6 +217,12 @@ int	zbx_init_collector_data(char **error)
 	zbx_procstat_init();
 #endif
 
+#ifdef ZBX_PROCSNAP_COLLECTOR
+	zbx_procsnap_init(config_process_snapshot_interval);
+#else
+	ZBX_UNUSED(config_process_snapshot_interval);
+#endif
+
 	if (SUCCEED != zbx_mutex_create(&diskstats_lock, ZBX_MUTEX_DISKSTATS, error))
 		goto out;
 #endif
@@ -254,6 +264,10 @@ void	zbx_free_collector_data(void)
 	zbx_procstat_destroy();
 #endif
 
+#ifdef ZBX_PROCSNAP_COLLECTOR
+	zbx_procsnap_destroy();
+#endif
+
 	if (ZBX_NONEXISTENT_SHMID != collector->diskstat_shmid)
 	{
 		if (-1 == shmctl(collector->diskstat_shmid, IPC_RMID, 0))
@@ -459,6 +473,10 @@ ZBX_THREAD_ENTRY(zbx_collector_thread, args)
 		if (0 != diskdevice_collector_started())
 			collect_stats_diskdevices();
 
+#ifdef ZBX_PROCSNAP_COLLECTOR
+		zbx_procsnap_collect();
+#endif
+
 #ifdef ZBX_PROCSTAT_COLLECTOR
 		zbx_procstat_collect();
 #endif
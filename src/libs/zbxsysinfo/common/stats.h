@@ -68,6 +68,9 @@ typedef struct
 #ifdef ZBX_PROCSTAT_COLLECTOR
 	zbx_dshm_t		procstat;
 #endif
+#ifdef ZBX_PROCSNAP_COLLECTOR
+	zbx_dshm_t		procsnap;
+#endif
 #ifdef _AIX
 	ZBX_VMSTAT_DATA		vmstat;
 	ZBX_CPUS_UTIL_DATA_AIX	cpus_phys_util;
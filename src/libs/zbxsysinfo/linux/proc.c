@@ -17,6 +17,7 @@
 #include "../sysinfo.h"
 
 #include "../common/procstat.h"
+#include "../common/procsnap.h"
 
 #include "zbxstr.h"
 #include "zbxregexp.h"
@@ -572,6 +573,39 @@ out:
 	*bytes = ZBX_MAX_UINT64;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: Reads amount of memory in bytes from a /proc file value           *
+ *          following the label, e.g. "   176712 kB\n"                        *
+ *                                                                            *
+ * Parameters:                                                                *
+ *     value - [IN] value to read, it is modified by this function            *
+ *     bytes - [OUT] result in bytes                                          *
+ *                                                                            *
+ * Return value: SUCCEED - successful reading                                 *
+ *               FAIL - the value could not be parsed                         *
+ *                                                                            *
+ ******************************************************************************/
+static int	byte_value_from_value_str(char *value, zbx_uint64_t *bytes)
+{
+	char	*p_unit;
+
+	if (NULL == (p_unit = strrchr(value, ' ')))
+		return FAIL;
+
+	*p_unit++ = '\0';
+
+	while (' ' == *value)
+		value++;
+
+	if (FAIL == zbx_is_uint64(value, bytes))
+		return FAIL;
+
+	convert_to_bytes(p_unit, bytes);
+
+	return SUCCEED;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: Reads amount of memory in bytes from a string in /proc file.      *
@@ -593,7 +627,7 @@ out:
  ******************************************************************************/
 int	byte_value_from_proc_file(FILE *f, const char *label, const char *guard, zbx_uint64_t *bytes)
 {
-	char	buf[MAX_STRING_LEN], *p_value, *p_unit;
+	char	buf[MAX_STRING_LEN], *p_value;
 	size_t	label_len, guard_len;
 	long	pos = 0;
 	int	ret = NOTSUPPORTED;
@@ -629,29 +663,615 @@ int	byte_value_from_proc_file(FILE *f, const char *label, const char *guard, zbx
 		if (0 != strncmp(buf, label, label_len))
 			continue;
 
-		if (NULL == (p_unit = strrchr(p_value, ' ')))
+		ret = byte_value_from_value_str(p_value, bytes);
+		break;
+	}
+
+	return ret;
+}
+
+#define PROC_MEM_COUNT	12
+
+/* memory labels in /proc/<pid>/status file stored in process snapshot */
+static const char	*proc_mem_labels[PROC_MEM_COUNT] = {"VmSize:\t", "VmRSS:\t", "VmData:\t", "VmStk:\t",
+		"VmExe:\t", "VmPeak:\t", "VmSwap:\t", "VmLib:\t", "VmLck:\t", "VmPin:\t", "VmHWM:\t", "VmPTE:\t"};
+
+/* process attributes stored in process snapshot */
+typedef struct
+{
+	pid_t		pid;
+	uid_t		uid;
+
+	/* offsets of strings in snapshot data, 0 - not available */
+	int		name;
+	int		name_arg0;
+	int		cmdline;
+
+	/* bits (by proc_mem_labels index) of memory values found in status file and values that failed to parse */
+	zbx_uint32_t	mem_found;
+	zbx_uint32_t	mem_invalid;
+
+	unsigned char	uid_found;
+
+	/* the first character of process state, '\0' if not available */
+	char		state;
+
+	zbx_uint64_t	mem[PROC_MEM_COUNT];
+}
+proc_snapshot_proc_t;
+
+ZBX_VECTOR_DECL(proc_snapshot_proc, proc_snapshot_proc_t)
+ZBX_VECTOR_IMPL(proc_snapshot_proc, proc_snapshot_proc_t)
+
+/*
+ * Process snapshot data layout:
+ *
+ *  .------------------------------------------------------.
+ *  | proc_snapshot_t                                      |
+ *  | ---------------------------------------------------- |
+ *  | proc_snapshot_proc_t[procs_num] sorted by name       |
+ *  | ---------------------------------------------------- |
+ *  | int[procs_num] process indexes sorted by name_arg0   |
+ *  | ---------------------------------------------------- |
+ *  | int[procs_num] process indexes sorted by uid         |
+ *  | ---------------------------------------------------- |
+ *  | strings                                              |
+ *  '------------------------------------------------------'
+ *
+ * All references are offsets from the start of snapshot data.
+ */
+typedef struct
+{
+	int	procs_num;
+	int	procs;
+	int	by_name_arg0;
+	int	by_uid;
+}
+proc_snapshot_t;
+
+typedef int	(*proc_snapshot_compare_func_t)(const char *data, const proc_snapshot_proc_t *proc, const void *key);
+
+typedef struct
+{
+	proc_snapshot_proc_t	proc;
+
+	/* index of process in snapshot */
+	int			index;
+
+	char			*name;
+	char			*name_arg0;
+	char			*cmdline;
+}
+proc_snapshot_entry_t;
+
+ZBX_PTR_VECTOR_DECL(proc_snapshot_entry_ptr, proc_snapshot_entry_t *)
+ZBX_PTR_VECTOR_IMPL(proc_snapshot_entry_ptr, proc_snapshot_entry_t *)
+
+static void	proc_snapshot_entry_free(proc_snapshot_entry_t *entry)
+{
+	zbx_free(entry->name);
+	zbx_free(entry->name_arg0);
+	zbx_free(entry->cmdline);
+
+	zbx_free(entry);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: reads process attributes used by proc.num[] and proc.mem[] items  *
+ *          in a single pass over /proc/<pid>/cmdline and /proc/<pid>/status  *
+ *                                                                            *
+ * Parameters: pid - [IN] process identifier                                  *
+ *                                                                            *
+ * Return value: process snapshot entry or NULL if process files cannot be    *
+ *               opened                                                       *
+ *                                                                            *
+ * Comments: The attributes are parsed in the same way as check_procname(),   *
+ *           check_user(), check_proccomm(), check_procstate() and            *
+ *           byte_value_from_proc_file() parse them.                          *
+ *                                                                            *
+ ******************************************************************************/
+static proc_snapshot_entry_t	*proc_snapshot_read_entry(const char *pid)
+{
+	char			tmp[MAX_STRING_LEN], *cmdline = NULL, *p;
+	FILE			*f_cmd, *f_stat;
+	size_t			cmdline_len;
+	proc_snapshot_entry_t	*entry;
+
+	zbx_snprintf(tmp, sizeof(tmp), "/proc/%s/cmdline", pid);
+
+	if (NULL == (f_cmd = fopen(tmp, "r")))
+		return NULL;
+
+	zbx_snprintf(tmp, sizeof(tmp), "/proc/%s/status", pid);
+
+	if (NULL == (f_stat = fopen(tmp, "r")))
+	{
+		zbx_fclose(f_cmd);
+		return NULL;
+	}
+
+	entry = (proc_snapshot_entry_t *)zbx_malloc(NULL, sizeof(proc_snapshot_entry_t));
+	memset(entry, 0, sizeof(proc_snapshot_entry_t));
+	entry->proc.pid = (pid_t)atoi(pid);
+
+	if (SUCCEED == get_cmdline(f_cmd, &cmdline, &cmdline_len))
+	{
+		if (NULL == (p = strrchr(cmdline, '/')))
+			p = cmdline;
+		else
+			p++;
+
+		if ('\0' != *p)
+			entry->name_arg0 = zbx_strdup(NULL, p);
+
+		for (size_t i = 0; i < cmdline_len - 2; i++)
 		{
-			ret = FAIL;
-			break;
+			if ('\0' == cmdline[i])
+				cmdline[i] = ' ';
 		}
 
-		*p_unit++ = '\0';
+		entry->cmdline = cmdline;
+	}
 
-		while (' ' == *p_value)
-			p_value++;
+	zbx_fclose(f_cmd);
 
-		if (FAIL == zbx_is_uint64(p_value, bytes))
+	while (NULL != fgets(tmp, (int)sizeof(tmp), f_stat))
+	{
+		if (0 == strncmp(tmp, "Vm", 2))
 		{
-			ret = FAIL;
-			break;
+			for (int i = 0; i < PROC_MEM_COUNT; i++)
+			{
+				size_t		label_len;
+				zbx_uint32_t	mask = 1 << i;
+
+				if (0 != ((entry->proc.mem_found | entry->proc.mem_invalid) & mask))
+					continue;
+
+				label_len = strlen(proc_mem_labels[i]);
+
+				if (0 != strncmp(tmp, proc_mem_labels[i], label_len))
+					continue;
+
+				if (SUCCEED == byte_value_from_value_str(tmp + label_len, &entry->proc.mem[i]))
+					entry->proc.mem_found |= mask;
+				else
+					entry->proc.mem_invalid |= mask;
+
+				break;
+			}
+		}
+		else if (NULL == entry->name && 0 == strncmp(tmp, "Name:\t", 6))
+		{
+			zbx_rtrim(tmp + 6, "\n");
+			entry->name = zbx_strdup(NULL, tmp + 6);
+		}
+		else if ('\0' == entry->proc.state && 0 == strncmp(tmp, "State:\t", 7))
+		{
+			entry->proc.state = tmp[7];
 		}
-		convert_to_bytes(p_unit, bytes);
+		else if (0 == entry->proc.uid_found && 0 == strncmp(tmp, "Uid", 3))
+		{
+			p = tmp + 4;
 
-		ret = SUCCEED;
-		break;
+			while (' ' == *p || '\t' == *p)
+				p++;
+
+			entry->proc.uid = (uid_t)atoi(p);
+			entry->proc.uid_found = 1;
+		}
 	}
 
-	return ret;
+	zbx_fclose(f_stat);
+
+	return entry;
+}
+
+static int	proc_snapshot_compare_str(const char *s1, const char *s2)
+{
+	if (NULL == s1)
+		return NULL == s2 ? 0 : -1;
+
+	if (NULL == s2)
+		return 1;
+
+	return strcmp(s1, s2);
+}
+
+static int	proc_snapshot_compare_uid(unsigned char uid_found1, uid_t uid1, unsigned char uid_found2, uid_t uid2)
+{
+	ZBX_RETURN_IF_NOT_EQUAL(uid_found1, uid_found2);
+	ZBX_RETURN_IF_NOT_EQUAL(uid1, uid2);
+
+	return 0;
+}
+
+static int	proc_snapshot_entry_compare_by_name(const void *d1, const void *d2)
+{
+	const proc_snapshot_entry_t	*e1 = *(const proc_snapshot_entry_t * const *)d1;
+	const proc_snapshot_entry_t	*e2 = *(const proc_snapshot_entry_t * const *)d2;
+
+	return proc_snapshot_compare_str(e1->name, e2->name);
+}
+
+static int	proc_snapshot_entry_compare_by_name_arg0(const void *d1, const void *d2)
+{
+	const proc_snapshot_entry_t	*e1 = *(const proc_snapshot_entry_t * const *)d1;
+	const proc_snapshot_entry_t	*e2 = *(const proc_snapshot_entry_t * const *)d2;
+
+	return proc_snapshot_compare_str(e1->name_arg0, e2->name_arg0);
+}
+
+static int	proc_snapshot_entry_compare_by_uid(const void *d1, const void *d2)
+{
+	const proc_snapshot_entry_t	*e1 = *(const proc_snapshot_entry_t * const *)d1;
+	const proc_snapshot_entry_t	*e2 = *(const proc_snapshot_entry_t * const *)d2;
+
+	return proc_snapshot_compare_uid(e1->proc.uid_found, e1->proc.uid, e2->proc.uid_found, e2->proc.uid);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: copies string into snapshot data                                  *
+ *                                                                            *
+ * Parameters: data   - [IN/OUT] snapshot data                                *
+ *             offset - [IN/OUT] offset of the next string                    *
+ *             str    - [IN] string to copy, can be NULL                      *
+ *                                                                            *
+ * Return value: offset of the copied string or 0 if string is NULL           *
+ *                                                                            *
+ ******************************************************************************/
+static int	proc_snapshot_add_str(char *data, size_t *offset, const char *str)
+{
+	size_t	len, str_offset = *offset;
+
+	if (NULL == str)
+		return 0;
+
+	len = strlen(str) + 1;
+	memcpy(data + str_offset, str, len);
+	*offset += len;
+
+	return (int)str_offset;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: takes a snapshot of running processes for proc.num[] and          *
+ *          proc.mem[] items                                                  *
+ *                                                                            *
+ * Parameters: data      - [OUT] snapshot data                                *
+ *             data_size - [OUT] snapshot data size                           *
+ *                                                                            *
+ * Return value: SUCCEED - snapshot was taken, data must be freed by caller   *
+ *               FAIL    - /proc directory cannot be opened                   *
+ *                                                                            *
+ * Comments: This function is called by process snapshot collector.           *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_proc_get_snapshot(char **data, size_t *data_size)
+{
+	DIR					*dir;
+	struct dirent				*entries;
+	zbx_vector_proc_snapshot_entry_ptr_t	procs;
+	proc_snapshot_entry_t			*entry;
+	proc_snapshot_t				*snapshot;
+	proc_snapshot_proc_t			*proc;
+	int					*index, i;
+	size_t					offset;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
+
+	if (NULL == (dir = opendir("/proc")))
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "End of %s(): cannot open /proc: %s", __func__, zbx_strerror(errno));
+		return FAIL;
+	}
+
+	zbx_vector_proc_snapshot_entry_ptr_create(&procs);
+
+	while (NULL != (entries = readdir(dir)))
+	{
+		if (0 == atoi(entries->d_name))
+			continue;
+
+		if (NULL != (entry = proc_snapshot_read_entry(entries->d_name)))
+			zbx_vector_proc_snapshot_entry_ptr_append(&procs, entry);
+	}
+
+	closedir(dir);
+
+	zbx_vector_proc_snapshot_entry_ptr_sort(&procs, proc_snapshot_entry_compare_by_name);
+
+	*data_size = ZBX_SIZE_T_ALIGN8(sizeof(proc_snapshot_t)) + (sizeof(proc_snapshot_proc_t) + 2 * sizeof(int)) *
+			(size_t)procs.values_num;
+
+	for (i = 0; i < procs.values_num; i++)
+	{
+		entry = procs.values[i];
+		entry->index = i;
+
+		if (NULL != entry->name)
+			*data_size += strlen(entry->name) + 1;
+
+		if (NULL != entry->name_arg0)
+			*data_size += strlen(entry->name_arg0) + 1;
+
+		if (NULL != entry->cmdline)
+			*data_size += strlen(entry->cmdline) + 1;
+	}
+
+	*data = (char *)zbx_malloc(NULL, *data_size);
+
+	snapshot = (proc_snapshot_t *)*data;
+	snapshot->procs_num = procs.values_num;
+	snapshot->procs = (int)ZBX_SIZE_T_ALIGN8(sizeof(proc_snapshot_t));
+	snapshot->by_name_arg0 = snapshot->procs + (int)sizeof(proc_snapshot_proc_t) * procs.values_num;
+	snapshot->by_uid = snapshot->by_name_arg0 + (int)sizeof(int) * procs.values_num;
+	offset = (size_t)snapshot->by_uid + sizeof(int) * (size_t)procs.values_num;
+
+	proc = (proc_snapshot_proc_t *)(*data + snapshot->procs);
+
+	for (i = 0; i < procs.values_num; i++)
+	{
+		entry = procs.values[i];
+
+		proc[i] = entry->proc;
+		proc[i].name = proc_snapshot_add_str(*data, &offset, entry->name);
+		proc[i].name_arg0 = proc_snapshot_add_str(*data, &offset, entry->name_arg0);
+		proc[i].cmdline = proc_snapshot_add_str(*data, &offset, entry->cmdline);
+	}
+
+	/* entries keep their position in process array, so the vector can be resorted to build indexes */
+	zbx_vector_proc_snapshot_entry_ptr_sort(&procs, proc_snapshot_entry_compare_by_name_arg0);
+	index = (int *)(*data + snapshot->by_name_arg0);
+
+	for (i = 0; i < procs.values_num; i++)
+		index[i] = procs.values[i]->index;
+
+	zbx_vector_proc_snapshot_entry_ptr_sort(&procs, proc_snapshot_entry_compare_by_uid);
+	index = (int *)(*data + snapshot->by_uid);
+
+	for (i = 0; i < procs.values_num; i++)
+		index[i] = procs.values[i]->index;
+
+	zbx_vector_proc_snapshot_entry_ptr_clear_ext(&procs, proc_snapshot_entry_free);
+	zbx_vector_proc_snapshot_entry_ptr_destroy(&procs);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s() procs:%d size:" ZBX_FS_SIZE_T, __func__, snapshot->procs_num,
+			(zbx_fs_size_t)*data_size);
+
+	return SUCCEED;
+}
+
+static const char	*proc_snapshot_str(const char *data, int offset)
+{
+	return 0 == offset ? NULL : data + offset;
+}
+
+static int	proc_snapshot_compare_name(const char *data, const proc_snapshot_proc_t *proc, const void *key)
+{
+	return proc_snapshot_compare_str(proc_snapshot_str(data, proc->name), (const char *)key);
+}
+
+static int	proc_snapshot_compare_name_arg0(const char *data, const proc_snapshot_proc_t *proc, const void *key)
+{
+	return proc_snapshot_compare_str(proc_snapshot_str(data, proc->name_arg0), (const char *)key);
+}
+
+static int	proc_snapshot_compare_user(const char *data, const proc_snapshot_proc_t *proc, const void *key)
+{
+	ZBX_UNUSED(data);
+
+	return proc_snapshot_compare_uid(proc->uid_found, proc->uid, 1, *(const uid_t *)key);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: finds the first snapshot process not less than the key            *
+ *                                                                            *
+ * Parameters: data    - [IN] snapshot data                                   *
+ *             index   - [IN] process index sorted by the compared attribute, *
+ *                            NULL to search processes sorted by name         *
+ *             compare - [IN] process attribute comparison function           *
+ *             key     - [IN] value to search for                             *
+ *                                                                            *
+ * Return value: position in the process index or process array               *
+ *                                                                            *
+ ******************************************************************************/
+static int	proc_snapshot_lower_bound(const char *data, const int *index, proc_snapshot_compare_func_t compare,
+		const void *key)
+{
+	const proc_snapshot_t		*snapshot = (const proc_snapshot_t *)data;
+	const proc_snapshot_proc_t	*procs = (const proc_snapshot_proc_t *)(data + snapshot->procs);
+	int				lo = 0, hi = snapshot->procs_num;
+
+	while (lo < hi)
+	{
+		int	mid = lo + (hi - lo) / 2;
+
+		if (0 > compare(data, &procs[NULL == index ? mid : index[mid]], key))
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+static int	proc_snapshot_match_state(const proc_snapshot_proc_t *proc, int zbx_proc_stat)
+{
+	switch (zbx_proc_stat)
+	{
+		case ZBX_PROC_STAT_ALL:
+			return SUCCEED;
+		case ZBX_PROC_STAT_RUN:
+			return ('R' == proc->state) ? SUCCEED : FAIL;
+		case ZBX_PROC_STAT_SLEEP:
+			return ('S' == proc->state) ? SUCCEED : FAIL;
+		case ZBX_PROC_STAT_ZOMB:
+			return ('Z' == proc->state) ? SUCCEED : FAIL;
+		case ZBX_PROC_STAT_DISK:
+			return ('D' == proc->state) ? SUCCEED : FAIL;
+		case ZBX_PROC_STAT_TRACE:
+			return ('T' == proc->state) ? SUCCEED : FAIL;
+		default:
+			return FAIL;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks snapshot process against user, command line and state      *
+ *          filters and adds it to the selected processes                     *
+ *                                                                            *
+ ******************************************************************************/
+static void	proc_snapshot_add_matching(const char *data, const proc_snapshot_proc_t *proc,
+		const struct passwd *usrinfo, const zbx_regexp_t *proccomm_rxp, int zbx_proc_stat,
+		zbx_vector_proc_snapshot_proc_t *procs, int *procs_num)
+{
+	if (NULL != usrinfo && (0 == proc->uid_found || usrinfo->pw_uid != proc->uid))
+		return;
+
+	if (NULL != proccomm_rxp && (0 == proc->cmdline ||
+			0 != zbx_regexp_match_precompiled(data + proc->cmdline, proccomm_rxp)))
+	{
+		return;
+	}
+
+	if (SUCCEED != proc_snapshot_match_state(proc, zbx_proc_stat))
+		return;
+
+	(*procs_num)++;
+
+	if (NULL != procs)
+		zbx_vector_proc_snapshot_proc_append(procs, *proc);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: selects processes matching proc.num[] and proc.mem[] filters from *
+ *          process snapshot                                                  *
+ *                                                                            *
+ * Parameters: procname      - [IN] process name, NULL or empty - all         *
+ *             usrinfo       - [IN] process owner, NULL - all                 *
+ *             proccomm_rxp  - [IN] command line regexp, NULL - all           *
+ *             zbx_proc_stat - [IN] process state (ZBX_PROC_STAT_*)           *
+ *             procs         - [OUT] copies of matching processes (optional)  *
+ *             procs_num     - [OUT] number of matching processes             *
+ *                                                                            *
+ * Return value: SUCCEED - processes were selected from snapshot              *
+ *               FAIL    - snapshot is not available, /proc must be read      *
+ *                                                                            *
+ * Comments: Processes are looked up by name, 0th argument or user in sorted  *
+ *           snapshot indexes, only the rest of filters are checked for each  *
+ *           found process.                                                   *
+ *                                                                            *
+ ******************************************************************************/
+static int	proc_snapshot_select(const char *procname, const struct passwd *usrinfo,
+		const zbx_regexp_t *proccomm_rxp, int zbx_proc_stat, zbx_vector_proc_snapshot_proc_t *procs,
+		int *procs_num)
+{
+	const void			*ptr;
+	const char			*data;
+	const proc_snapshot_t		*snapshot;
+	const proc_snapshot_proc_t	*proc;
+	const int			*index;
+	int				i;
+
+	if (SUCCEED != zbx_procsnap_lock(&ptr))
+		return FAIL;
+
+	data = (const char *)ptr;
+	snapshot = (const proc_snapshot_t *)data;
+	proc = (const proc_snapshot_proc_t *)(data + snapshot->procs);
+	*procs_num = 0;
+
+	if (NULL != procname && '\0' != *procname)
+	{
+		for (i = proc_snapshot_lower_bound(data, NULL, proc_snapshot_compare_name, procname);
+				i < snapshot->procs_num &&
+				0 == proc_snapshot_compare_name(data, &proc[i], procname); i++)
+		{
+			proc_snapshot_add_matching(data, &proc[i], usrinfo, proccomm_rxp, zbx_proc_stat, procs,
+					procs_num);
+		}
+
+		/* process name in status file is truncated, long names are matched by the 0th argument */
+		index = (const int *)(data + snapshot->by_name_arg0);
+
+		for (i = proc_snapshot_lower_bound(data, index, proc_snapshot_compare_name_arg0, procname);
+				i < snapshot->procs_num &&
+				0 == proc_snapshot_compare_name_arg0(data, &proc[index[i]], procname); i++)
+		{
+			/* already selected by name */
+			if (0 == proc_snapshot_compare_name(data, &proc[index[i]], procname))
+				continue;
+
+			proc_snapshot_add_matching(data, &proc[index[i]], usrinfo, proccomm_rxp, zbx_proc_stat, procs,
+					procs_num);
+		}
+	}
+	else if (NULL != usrinfo)
+	{
+		index = (const int *)(data + snapshot->by_uid);
+
+		for (i = proc_snapshot_lower_bound(data, index, proc_snapshot_compare_user, &usrinfo->pw_uid);
+				i < snapshot->procs_num &&
+				0 == proc_snapshot_compare_user(data, &proc[index[i]], &usrinfo->pw_uid); i++)
+		{
+			proc_snapshot_add_matching(data, &proc[index[i]], NULL, proccomm_rxp, zbx_proc_stat, procs,
+					procs_num);
+		}
+	}
+	else
+	{
+		for (i = 0; i < snapshot->procs_num; i++)
+			proc_snapshot_add_matching(data, &proc[i], NULL, proccomm_rxp, zbx_proc_stat, procs, procs_num);
+	}
+
+	zbx_procsnap_unlock();
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: reads amount of memory in bytes of process from snapshot or from  *
+ *          /proc/<pid>/status file                                           *
+ *                                                                            *
+ * Parameters: f_stat - [IN] process status file, used if proc is NULL        *
+ *             proc   - [IN] snapshot process (optional)                      *
+ *             label  - [IN] label to look for, e.g. "VmData:\t"              *
+ *             bytes  - [OUT] result in bytes                                 *
+ *                                                                            *
+ * Return value: see byte_value_from_proc_file()                              *
+ *                                                                            *
+ ******************************************************************************/
+static int	proc_read_mem(FILE *f_stat, const proc_snapshot_proc_t *proc, const char *label, zbx_uint64_t *bytes)
+{
+	if (NULL == proc)
+		return byte_value_from_proc_file(f_stat, label, NULL, bytes);
+
+	for (int i = 0; i < PROC_MEM_COUNT; i++)
+	{
+		zbx_uint32_t	mask = 1 << i;
+
+		if (0 != strcmp(label, proc_mem_labels[i]))
+			continue;
+
+		if (0 != (proc->mem_invalid & mask))
+			return FAIL;
+
+		if (0 == (proc->mem_found & mask))
+			return NOTSUPPORTED;
+
+		*bytes = proc->mem[i];
+
+		return SUCCEED;
+	}
+
+	return NOTSUPPORTED;
 }
 
 static int	get_total_memory(zbx_uint64_t *total_memory)
@@ -694,10 +1314,13 @@ int	proc_mem(AGENT_REQUEST *request, AGENT_RESULT *result)
 	zbx_uint64_t	mem_size = 0, byte_value = 0, total_memory;
 	double		pct_size = 0.0, pct_value = 0.0;
 	int		do_task, res, mem_type_code, mem_type_tried = 0, proccount = 0, invalid_user = 0,
-			invalid_read = 0, ret = SYSINFO_RET_OK;
+			invalid_read = 0, snapshot_index = 0, snapshot_num, ret = SYSINFO_RET_OK;
 	char		*mem_type = NULL, *rxp_error = NULL;
 	const char	*mem_type_search = NULL;
 
+	zbx_vector_proc_snapshot_proc_t	snapshot_procs;
+	const proc_snapshot_proc_t	*snapshot_proc = NULL;
+
 	if (5 < request->nparam)
 	{
 		SET_MSG_RESULT(result, zbx_strdup(NULL, "Too many parameters."));
@@ -863,41 +1486,62 @@ int	proc_mem(AGENT_REQUEST *request, AGENT_RESULT *result)
 		}
 	}
 
-	if (NULL == (dir = opendir("/proc")))
+	zbx_vector_proc_snapshot_proc_create(&snapshot_procs);
+
+	if (SUCCEED == proc_snapshot_select(procname, usrinfo, proccomm_rxp, ZBX_PROC_STAT_ALL, &snapshot_procs,
+			&snapshot_num))
+	{
+		dir = NULL;
+	}
+	else if (NULL == (dir = opendir("/proc")))
 	{
 		SET_MSG_RESULT(result, zbx_dsprintf(NULL, "Cannot open /proc: %s", zbx_strerror(errno)));
+		zbx_vector_proc_snapshot_proc_destroy(&snapshot_procs);
 		ret = SYSINFO_RET_FAIL;
 		goto clean_re;
 	}
 
-	while (NULL != (entries = readdir(dir)))
+	while (1)
 	{
-		zbx_fclose(f_cmd);
-		zbx_fclose(f_stat);
+		if (NULL == dir)
+		{
+			if (snapshot_index == snapshot_procs.values_num)
+				break;
 
-		if (0 == atoi(entries->d_name))
-			continue;
+			snapshot_proc = &snapshot_procs.values[snapshot_index++];
+		}
+		else
+		{
+			zbx_fclose(f_cmd);
+			zbx_fclose(f_stat);
 
-		zbx_snprintf(tmp, sizeof(tmp), "/proc/%s/cmdline", entries->d_name);
+			if (NULL == (entries = readdir(dir)))
+				break;
 
-		if (NULL == (f_cmd = fopen(tmp, "r")))
-			continue;
+			if (0 == atoi(entries->d_name))
+				continue;
 
-		zbx_snprintf(tmp, sizeof(tmp), "/proc/%s/status", entries->d_name);
+			zbx_snprintf(tmp, sizeof(tmp), "/proc/%s/cmdline", entries->d_name);
 
-		if (NULL == (f_stat = fopen(tmp, "r")))
-			continue;
+			if (NULL == (f_cmd = fopen(tmp, "r")))
+				continue;
 
-		if (FAIL == check_procname(f_cmd, f_stat, procname))
-			continue;
+			zbx_snprintf(tmp, sizeof(tmp), "/proc/%s/status", entries->d_name);
 
-		if (FAIL == check_user(f_stat, usrinfo))
-			continue;
+			if (NULL == (f_stat = fopen(tmp, "r")))
+				continue;
 
-		if (FAIL == check_proccomm(f_cmd, proccomm_rxp))
-			continue;
+			if (FAIL == check_procname(f_cmd, f_stat, procname))
+				continue;
 
-		rewind(f_stat);
+			if (FAIL == check_user(f_stat, usrinfo))
+				continue;
+
+			if (FAIL == check_proccomm(f_cmd, proccomm_rxp))
+				continue;
+
+			rewind(f_stat);
+		}
 
 		if (0 == mem_type_tried)
 			mem_type_tried = 1;
@@ -916,7 +1560,7 @@ int	proc_mem(AGENT_REQUEST *request, AGENT_RESULT *result)
 			case ZBX_VMSTK:
 			case ZBX_VMEXE:
 			case ZBX_VMPTE:
-				res = byte_value_from_proc_file(f_stat, mem_type_search, NULL, &byte_value);
+				res = proc_read_mem(f_stat, snapshot_proc, mem_type_search, &byte_value);
 
 				if (NOTSUPPORTED == res)
 					continue;
@@ -936,19 +1580,19 @@ int	proc_mem(AGENT_REQUEST *request, AGENT_RESULT *result)
 
 					mem_type_search = "VmData:\t";
 
-					if (SUCCEED == (res = byte_value_from_proc_file(f_stat, mem_type_search, NULL,
-							&byte_value)))
+					if (SUCCEED == (res = proc_read_mem(f_stat, snapshot_proc,
+							mem_type_search, &byte_value)))
 					{
 						mem_type_search = "VmStk:\t";
 
-						if (SUCCEED == (res = byte_value_from_proc_file(f_stat, mem_type_search,
-								NULL, &m)))
+						if (SUCCEED == (res = proc_read_mem(f_stat, snapshot_proc,
+								mem_type_search, &m)))
 						{
 							byte_value += m;
 							mem_type_search = "VmExe:\t";
 
-							if (SUCCEED == (res = byte_value_from_proc_file(f_stat,
-									mem_type_search, NULL, &m)))
+							if (SUCCEED == (res = proc_read_mem(f_stat, snapshot_proc,
+									mem_type_search, &m)))
 							{
 								byte_value += m;
 							}
@@ -973,7 +1617,7 @@ int	proc_mem(AGENT_REQUEST *request, AGENT_RESULT *result)
 				break;
 			case ZBX_PMEM:
 				mem_type_search = "VmRSS:\t";
-				res = byte_value_from_proc_file(f_stat, mem_type_search, NULL, &byte_value);
+				res = proc_read_mem(f_stat, snapshot_proc, mem_type_search, &byte_value);
 
 				if (SUCCEED == res)
 				{
@@ -1023,7 +1667,11 @@ int	proc_mem(AGENT_REQUEST *request, AGENT_RESULT *result)
 clean:
 	zbx_fclose(f_cmd);
 	zbx_fclose(f_stat);
-	closedir(dir);
+
+	if (NULL != dir)
+		closedir(dir);
+
+	zbx_vector_proc_snapshot_proc_destroy(&snapshot_procs);
 
 	if ((0 == proccount && 0 != mem_type_tried) || 0 != invalid_read)
 	{
@@ -1151,6 +1799,9 @@ int	proc_num(AGENT_REQUEST *request, AGENT_RESULT *result)
 	if (1 == invalid_user)	/* handle 0 for non-existent user after all parameters have been parsed and validated */
 		goto out;
 
+	if (SUCCEED == proc_snapshot_select(procname, usrinfo, proccomm_rxp, zbx_proc_stat, NULL, &proccount))
+		goto out;
+
 	if (NULL == (dir = opendir("/proc")))
 	{
 		SET_MSG_RESULT(result, zbx_dsprintf(NULL, "Cannot open /proc: %s", zbx_strerror(errno)));
@@ -396,7 +396,7 @@ int	zbx_tfc_init(zbx_uint64_t cache_size, char **error)
 		goto out;
 
 	if (SUCCEED != zbx_shmem_create(&tfc_mem, cache_size, "trend function cache size",
-			"TrendFunctionCacheSize", 1, error))
+			"TrendFunctionCacheSize", 1, ZBX_SHMEM_ALLOC_FIRSTFIT, error))
 	{
 		goto out;
 	}
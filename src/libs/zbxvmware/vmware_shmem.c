@@ -1230,7 +1230,7 @@ int	vmware_shmem_init(zbx_uint64_t *config_vmware_cache_size, zbx_vmware_t **vmw
 	*config_vmware_cache_size -= size_reserved;
 
 	if (SUCCEED != zbx_shmem_create(&vmware_mem, *config_vmware_cache_size, "vmware cache size", "VMwareCacheSize",
-			0, error))
+			0, ZBX_SHMEM_ALLOC_FIRSTFIT, error))
 	{
 		goto out;
 	}
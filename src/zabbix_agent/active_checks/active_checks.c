@@ -41,6 +41,10 @@
 #	include "zbxnix.h"
 #endif
 
+#if !defined(_WINDOWS) && !defined(__MINGW32__)
+#	include "../logfiles/logwatch.h"
+#endif
+
 typedef struct
 {
 	zbx_uint64_t	itemid;
@@ -100,6 +104,8 @@ static ZBX_THREAD_LOCAL zbx_vector_pre_persistent_t	pre_persistent_vec;	/* used
 										/* into persistent files */
 /* used for deleting inactive persistent files */
 static ZBX_THREAD_LOCAL zbx_vector_persistent_inactive_t	persistent_inactive_vec;
+/* protocol flags of active checks requests and history data sent to server (proxy) */
+static ZBX_THREAD_LOCAL unsigned char				send_flags = ZBX_TCP_PROTOCOL;
 
 #define ZBX_HISTORY_UPLOAD_ENABLED	0
 #define ZBX_HISTORY_UPLOAD_DISABLED	(-1)
@@ -161,6 +167,7 @@ static void	free_active_metric(zbx_active_metric_t *metric)
 	zbx_free(metric->logfiles);
 #if !defined(_WINDOWS) && !defined(__MINGW32__)
 	zbx_free(metric->persistent_file_name);
+	zbx_logwatch_release(&metric->watch);
 #endif
 	zbx_free(metric);
 }
@@ -283,6 +290,8 @@ static void	add_check(const char *key, zbx_uint64_t itemid, const char *delay, z
 			metric->start_time = 0.0;
 			metric->processed_bytes = 0;
 #if !defined(_WINDOWS) && !defined(__MINGW32__)
+			zbx_logwatch_release(&metric->watch);
+
 			if (NULL != metric->persistent_file_name)
 			{
 				char	*error = NULL;
@@ -365,6 +374,7 @@ static void	add_check(const char *key, zbx_uint64_t itemid, const char *delay, z
 	metric->start_time = 0.0;
 	metric->processed_bytes = 0;
 	metric->persistent_file_name = NULL;	/* initialized but not used on Microsoft Windows */
+	memset(&metric->watch, 0, sizeof(metric->watch));
 
 	zbx_vector_active_metrics_ptr_append(&active_metrics, metric);
 out:
@@ -933,7 +943,7 @@ static int	refresh_active_checks(zbx_vector_addr_ptr_t *addrs, const zbx_config_
 	level = SUCCEED != last_ret ? LOG_LEVEL_DEBUG : LOG_LEVEL_WARNING;
 
 	ret = zbx_comms_exchange_with_redirect(config_source_ip, addrs, config_timeout, config_timeout, 0, level,
-			config_tls, json.buffer, NULL, NULL, &data, NULL);
+			config_tls, json.buffer, send_flags, NULL, NULL, &data, NULL);
 
 	if (SUCCEED == ret && '\0' == *data)
 	{
@@ -1250,7 +1260,8 @@ static int	send_buffer(zbx_vector_addr_ptr_t *addrs, zbx_vector_pre_persistent_t
 	level = 0 == buffer.first_error ? LOG_LEVEL_WARNING : LOG_LEVEL_DEBUG;
 
 	ret = zbx_comms_exchange_with_redirect(config_source_ip, addrs, MIN(buffer.count * config_timeout, 60),
-			config_timeout, 0, level, config_tls, json.buffer, connect_callback, &json, &data, NULL);
+			config_timeout, 0, level, config_tls, json.buffer, send_flags, connect_callback, &json, &data,
+			NULL);
 
 	if (SUCCEED == ret)
 	{
@@ -1847,6 +1858,52 @@ static void	update_schedule(int delta)
 	buffer.lastsent += delta;
 }
 
+#if !defined(_WINDOWS) && !defined(__MINGW32__)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: processes log file changes and schedules checks of changed log    *
+ *          items to be done immediately                                      *
+ *                                                                            *
+ * Parameters: timeout - [IN] maximum time to wait for changes, seconds       *
+ *                                                                            *
+ * Return value: SUCCEED - at least one check was scheduled                   *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: Checks are started early at most once per second for each item   *
+ *           and only for items whose log files are watched.                  *
+ *                                                                            *
+ ******************************************************************************/
+static int	wake_log_checks(int timeout)
+{
+	int	now, ret = FAIL;
+
+	if (SUCCEED != zbx_logwatch_wait(timeout))
+		return FAIL;
+
+	now = (int)time(NULL);
+
+	for (int i = 0; i < active_metrics.values_num; i++)
+	{
+		zbx_active_metric_t	*metric = active_metrics.values[i];
+
+		if (0 == ((ZBX_METRIC_FLAG_LOG_LOG | ZBX_METRIC_FLAG_LOG_LOGRT) & metric->flags))
+			continue;
+
+		if (metric->nextcheck <= now || metric->watch.lastcheck >= now || 0 == metric->watch.revision)
+			continue;
+
+		if (SUCCEED == zbx_logwatch_unchanged(&metric->watch))
+			continue;
+
+		metric->nextcheck = now;
+		metric->watch.woken = 1;
+		ret = SUCCEED;
+	}
+
+	return ret;
+}
+#endif
+
 #ifndef _WINDOWS
 static void	zbx_active_checks_sigusr_handler(int flags)
 {
@@ -1876,7 +1933,7 @@ static void	send_heartbeat_msg(zbx_vector_addr_ptr_t *addrs, const zbx_config_tl
 	level = SUCCEED != last_ret ? LOG_LEVEL_DEBUG : LOG_LEVEL_WARNING;
 
 	ret = zbx_comms_exchange_with_redirect(config_source_ip, addrs, config_timeout, config_timeout, 0, level,
-			config_tls, json.buffer, NULL, NULL, NULL, &error);
+			config_tls, json.buffer, ZBX_TCP_PROTOCOL, NULL, NULL, NULL, &error);
 
 	if (SUCCEED == ret)
 	{
@@ -1930,9 +1987,15 @@ ZBX_THREAD_ENTRY(active_checks_thread, args)
 	init_active_metrics(activechks_args_in->config_buffer_size);
 	zbx_cfg_set_process_num(process_num);
 
+	if (0 != activechks_args_in->config_compression_level)
+		send_flags |= ZBX_TCP_COMPRESS;
+
 #ifndef _WINDOWS
 	zbx_set_sigusr_handler(zbx_active_checks_sigusr_handler);
 #endif
+#if !defined(_WINDOWS) && !defined(__MINGW32__)
+	zbx_logwatch_init();
+#endif
 
 	if (0 != activechks_args_in->config_heartbeat_frequency)
 		heartbeat_nextcheck = time(NULL);
@@ -2001,6 +2064,11 @@ ZBX_THREAD_ENTRY(active_checks_thread, args)
 					activechks_args_in->config_buffer_size);
 		}
 
+#if !defined(_WINDOWS) && !defined(__MINGW32__)
+		/* pick up log file changes that happened since the last wait */
+		if (SUCCEED == wake_log_checks(0))
+			nextcheck = 0;
+#endif
 		if (now >= nextcheck && activechks_args_in->config_buffer_size / 2 > buffer.pcount)
 		{
 			zbx_setproctitle("active checks #%d [processing active checks]", process_num);
@@ -2038,7 +2106,12 @@ ZBX_THREAD_ENTRY(active_checks_thread, args)
 			}
 
 			zbx_setproctitle("active checks #%d [idle 1 sec]", process_num);
+#if !defined(_WINDOWS) && !defined(__MINGW32__)
+			if (SUCCEED == wake_log_checks(1))
+				nextcheck = 0;
+#else
 			zbx_sleep(1);
+#endif
 		}
 
 		lastcheck = now;
@@ -2051,6 +2124,9 @@ ZBX_THREAD_ENTRY(active_checks_thread, args)
 	}
 
 	zbx_free(session_token);
+#if !defined(_WINDOWS) && !defined(__MINGW32__)
+	zbx_logwatch_destroy();
+#endif
 
 #ifdef _WINDOWS
 	zbx_vector_addr_ptr_clear_ext(&activechk_args.addrs, (zbx_clean_func_t)zbx_addr_free);
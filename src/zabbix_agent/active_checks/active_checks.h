@@ -42,6 +42,7 @@ typedef struct
 	int			config_eventlog_max_lines_per_second;
 	int			config_max_lines_per_second;
 	int			config_refresh_active_checks;
+	int			config_compression_level;
 }
 zbx_thread_activechk_args;
 
@@ -23,6 +23,10 @@
 #include "zbx_rtc_constants.h"
 #include "zbxjson.h"
 #include "zbxcfg.h"
+#include "zbxfile.h"
+#include "zbxcrypto.h"
+#include "zbxcompress.h"
+#include "zbxalgo.h"
 
 #if defined(ZABBIX_SERVICE)
 #	include "zbxwinservice.h"
@@ -33,13 +37,23 @@
 #ifndef _WINDOWS
 static volatile sig_atomic_t	need_update_userparam;
 #endif
-static int	process_passive_checks_json(zbx_socket_t *s, int config_timeout, struct zbx_json_parse *jp)
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: processes passive check request in JSON format                    *
+ *                                                                            *
+ * Parameters: jp           - [IN] request                                    *
+ *             response     - [OUT] dynamically allocated response            *
+ *             response_len - [OUT] response length                           *
+ *                                                                            *
+ ******************************************************************************/
+static void	process_passive_checks_json(struct zbx_json_parse *jp, char **response, size_t *response_len)
 {
 	struct zbx_json_parse	jp_data, jp_row;
 	const char		*p = NULL;
 	size_t			key_alloc = 0;
 	char			tmp[MAX_STRING_LEN], error_tmp[MAX_STRING_LEN], *key = NULL, *error = NULL;
-	int			timeout, ret = SUCCEED;
+	int			timeout;
 	struct zbx_json		j;
 	AGENT_RESULT		result;
 	char			**value;
@@ -133,83 +147,1183 @@ fail:
 	zbx_json_close(&j);
 
 	zabbix_log(LOG_LEVEL_DEBUG, "Sending back [%s]", j.buffer);
-	ret = zbx_tcp_send_bytes_to(s, j.buffer, j.buffer_size, config_timeout);
+
+	*response = (char *)zbx_malloc(NULL, j.buffer_size);
+	memcpy(*response, j.buffer, j.buffer_size);
+	*response_len = j.buffer_size;
 
 	zbx_free(key);
 	zbx_json_free(&j);
 	zbx_free(error);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: processes passive check request                                   *
+ *                                                                            *
+ * Parameters: request        - [IN/OUT] request, trailing newline is removed *
+ *             config_timeout - [IN]                                          *
+ *             response       - [OUT] dynamically allocated response or NULL  *
+ *                                    if nothing must be sent back            *
+ *             response_len   - [OUT] response length                         *
+ *                                                                            *
+ ******************************************************************************/
+static void	process_request(char *request, int config_timeout, char **response, size_t *response_len)
+{
+	struct zbx_json_parse	jp;
+
+	*response = NULL;
+	*response_len = 0;
+
+	zbx_rtrim(request, "\r\n");
+
+	zabbix_log(LOG_LEVEL_DEBUG, "Requested [%s]", request);
+
+	if (SUCCEED == zbx_json_open(request, &jp))
+	{
+		process_passive_checks_json(&jp, response, response_len);
+	}
+	else
+	{
+		AGENT_RESULT	result;
+		char		**value = NULL;
+
+		zbx_init_agent_result(&result);
+
+		if (SUCCEED == zbx_execute_agent_check(request, ZBX_PROCESS_WITH_ALIAS, &result, config_timeout))
+		{
+			if (NULL != (value = ZBX_GET_TEXT_RESULT(&result)))
+			{
+				zabbix_log(LOG_LEVEL_DEBUG, "Sending back [%s]", *value);
+				*response_len = strlen(*value);
+				*response = zbx_strdup(NULL, *value);
+			}
+		}
+		else
+		{
+			size_t	response_alloc = 0;
+
+			value = ZBX_GET_MSG_RESULT(&result);
+
+			if (NULL != value)
+			{
+				zabbix_log(LOG_LEVEL_DEBUG, "Sending back [" ZBX_NOTSUPPORTED ": %s]", *value);
+
+				zbx_strncpy_alloc(response, &response_alloc, response_len,
+						ZBX_NOTSUPPORTED, ZBX_CONST_STRLEN(ZBX_NOTSUPPORTED));
+				(*response_len)++;
+				zbx_strcpy_alloc(response, &response_alloc, response_len, *value);
+			}
+			else
+			{
+				zabbix_log(LOG_LEVEL_DEBUG, "Sending back [" ZBX_NOTSUPPORTED "]");
+				*response_len = ZBX_CONST_STRLEN(ZBX_NOTSUPPORTED);
+				*response = zbx_strdup(NULL, ZBX_NOTSUPPORTED);
+			}
+		}
 
-	return ret;
+		zbx_free_agent_result(&result);
+	}
 }
 
+#ifdef _WINDOWS
 static void	process_listener(zbx_socket_t *s, int config_timeout)
 {
 	int	ret;
 
 	if (SUCCEED == (ret = zbx_tcp_recv_to(s, config_timeout)))
 	{
-		struct zbx_json_parse	jp;
+		char	*response;
+		size_t	response_len;
+
+		process_request(s->buffer, config_timeout, &response, &response_len);
+
+		if (NULL != response)
+		{
+			ret = zbx_tcp_send_bytes_to(s, response, response_len, config_timeout);
+			zbx_free(response);
+		}
+	}
+
+	if (FAIL == ret)
+		zabbix_log(LOG_LEVEL_DEBUG, "Process listener error: %s", zbx_socket_strerror());
+}
+#endif
+
+#ifndef _WINDOWS
+#define LISTENER_CONNECTIONS_MAX	256	/* maximum number of connections served by one listener */
+#define LISTENER_PIPELINE_MAX		64	/* maximum number of queued requests per connection */
+
+#define LISTENER_REQUEST_QUEUED		0
+#define LISTENER_REQUEST_RUNNING	1
+#define LISTENER_REQUEST_DONE		2
+
+#define LISTENER_NO_RESPONSE		(~(zbx_uint32_t)0)
+
+typedef struct listener_conn	listener_conn_t;
+
+typedef struct
+{
+	listener_conn_t	*conn;		/* NULL if connection was closed before the request was processed */
+	char		*request;
+	char		*response;	/* NULL if nothing must be sent back */
+	size_t		response_len;
+	unsigned char	state;
+}
+listener_request_t;
+
+ZBX_PTR_VECTOR_DECL(listener_request_ptr, listener_request_t *)
+ZBX_PTR_VECTOR_IMPL(listener_request_ptr, listener_request_t *)
+
+struct listener_conn
+{
+	zbx_socket_t				s;
+	char					*buf;		/* received data not parsed into requests yet */
+	size_t					buf_alloc;
+	size_t					buf_offset;
+	zbx_vector_listener_request_ptr_t	requests;	/* requests in the order of arrival */
+	zbx_tcp_send_context_t			send_context;
+	int					requests_num;	/* number of received requests */
+	time_t					lastaccess;
+	short					recv_events;
+	short					send_events;
+	unsigned char				handshake;	/* TLS handshake or peer checks are pending */
+	unsigned char				sending;	/* the first request response is being sent */
+	unsigned char				eof;		/* peer will not send more data */
+};
+
+ZBX_PTR_VECTOR_DECL(listener_conn_ptr, listener_conn_t *)
+ZBX_PTR_VECTOR_IMPL(listener_conn_ptr, listener_conn_t *)
+
+typedef struct
+{
+	pid_t			pid;
+	int			fd;		/* socket connected to worker process, -1 if worker is not running */
+	listener_request_t	*request;	/* request being processed, NULL if worker is idle */
+	char			*buf;		/* response being received */
+	size_t			buf_alloc;
+	size_t			buf_offset;
+	unsigned char		restart;	/* restart worker when it becomes idle */
+}
+listener_worker_t;
+
+typedef struct
+{
+	zbx_socket_t				*listen_sock;
+	const zbx_thread_listener_args		*args;
+	int					process_num;
+	zbx_vector_listener_conn_ptr_t		conns;
+	zbx_list_t				queue;		/* requests waiting to be processed */
+	listener_worker_t			*workers;
+	int					workers_num;
+	time_t					accept_resume;	/* time when accepting connections is resumed */
+}
+listener_loop_t;
+
+static void	listener_request_free(listener_request_t *request)
+{
+	zbx_free(request->request);
+	zbx_free(request->response);
+	zbx_free(request);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: reads exactly the specified number of bytes from blocking socket  *
+ *                                                                            *
+ ******************************************************************************/
+static int	worker_read_all(int fd, char *buf, size_t len)
+{
+	while (0 < len)
+	{
+		ssize_t	n;
+
+		if (0 < (n = read(fd, buf, len)))
+		{
+			buf += n;
+			len -= (size_t)n;
+		}
+		else if (0 == n || EINTR != errno)
+			return FAIL;
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: main loop of listener worker process                              *
+ *                                                                            *
+ * Parameters: fd             - [IN] socket connected to listener             *
+ *             config_timeout - [IN]                                          *
+ *                                                                            *
+ * Comments: The worker receives requests as 32-bit length followed by data   *
+ *           and sends back responses in the same format, using               *
+ *           LISTENER_NO_RESPONSE length when there is no response. The       *
+ *           worker exits when listener closes its side of the socket.        *
+ *                                                                            *
+ ******************************************************************************/
+static void	listener_worker_run(int fd, int config_timeout)
+{
+	char	*request = NULL, *response;
+	size_t	request_alloc = 0, response_len;
+
+	for (;;)
+	{
+		zbx_uint32_t	len;
+
+		if (SUCCEED != worker_read_all(fd, (char *)&len, sizeof(len)))
+			break;
+
+		if (request_alloc <= len)
+		{
+			request_alloc = (size_t)len + 1;
+			request = (char *)zbx_realloc(request, request_alloc);
+		}
+
+		if (SUCCEED != worker_read_all(fd, request, len))
+			break;
+
+		request[len] = '\0';
+
+		process_request(request, config_timeout, &response, &response_len);
+
+		len = (NULL == response ? LISTENER_NO_RESPONSE : (zbx_uint32_t)response_len);
+
+		if (FAIL == zbx_write_all(fd, (const char *)&len, sizeof(len)) ||
+				(NULL != response && FAIL == zbx_write_all(fd, response, response_len)))
+		{
+			zbx_free(response);
+			break;
+		}
+
+		zbx_free(response);
+	}
+
+	zbx_free(request);
+	close(fd);
+
+	exit(EXIT_SUCCESS);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: starts listener worker process                                    *
+ *                                                                            *
+ * Comments: The worker is forked from listener, so it closes inherited       *
+ *           listening sockets, connections and sockets of other workers to   *
+ *           not keep them open.                                              *
+ *                                                                            *
+ ******************************************************************************/
+static int	listener_worker_start(listener_loop_t *loop, listener_worker_t *worker)
+{
+	int	fds[2], i;
+
+	if (-1 == socketpair(AF_UNIX, SOCK_STREAM, 0, fds))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot create socket pair for listener worker: %s",
+				zbx_strerror(errno));
+		return FAIL;
+	}
+
+	if (-1 == (worker->pid = zbx_fork()))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot start listener worker: %s", zbx_strerror(errno));
+		close(fds[0]);
+		close(fds[1]);
+		return FAIL;
+	}
+
+	if (0 == worker->pid)
+	{
+		close(fds[0]);
+
+		for (i = 0; i < loop->listen_sock->num_socks; i++)
+			close(loop->listen_sock->sockets[i]);
+
+		for (i = 0; i < loop->conns.values_num; i++)
+			close(loop->conns.values[i]->s.socket);
+
+		for (i = 0; i < loop->workers_num; i++)
+		{
+			if (-1 != loop->workers[i].fd)
+				close(loop->workers[i].fd);
+		}
+
+		zbx_setproctitle("listener #%d [worker #%d]", loop->process_num, (int)(worker - loop->workers) + 1);
+
+		listener_worker_run(fds[1], loop->args->config_timeout);
+	}
+
+	close(fds[1]);
+
+	worker->fd = fds[0];
+	worker->request = NULL;
+	worker->buf_offset = 0;
+	worker->restart = 0;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: stops listener worker process                                     *
+ *                                                                            *
+ * Comments: The worker exits after reading end of file from its socket.      *
+ *                                                                            *
+ ******************************************************************************/
+static void	listener_worker_stop(listener_worker_t *worker)
+{
+	if (-1 == worker->fd)
+		return;
+
+	close(worker->fd);
+	worker->fd = -1;
+
+	while (-1 == waitpid(worker->pid, NULL, 0) && EINTR == errno)
+		;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: finishes request processing                                       *
+ *                                                                            *
+ * Comments: Requests of closed connections are freed.                        *
+ *                                                                            *
+ ******************************************************************************/
+static void	listener_request_finish(listener_request_t *request, char *response, size_t response_len)
+{
+	if (NULL == request->conn)
+	{
+		zbx_free(response);
+		listener_request_free(request);
+		return;
+	}
+
+	request->response = response;
+	request->response_len = response_len;
+	request->state = LISTENER_REQUEST_DONE;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: handles failure of listener worker, restarting it                 *
+ *                                                                            *
+ ******************************************************************************/
+static void	listener_worker_fail(listener_loop_t *loop, listener_worker_t *worker)
+{
+	zabbix_log(LOG_LEVEL_WARNING, "listener #%d worker #%d (pid:%d) terminated unexpectedly", loop->process_num,
+			(int)(worker - loop->workers) + 1, (int)worker->pid);
+
+	if (NULL != worker->request)
+	{
+		listener_request_finish(worker->request, NULL, 0);
+		worker->request = NULL;
+	}
+
+	listener_worker_stop(worker);
+	(void)listener_worker_start(loop, worker);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: passes request to listener worker process                         *
+ *                                                                            *
+ ******************************************************************************/
+static void	listener_worker_send(listener_loop_t *loop, listener_worker_t *worker, listener_request_t *request)
+{
+	zbx_uint32_t	len = (zbx_uint32_t)strlen(request->request);
+
+	request->state = LISTENER_REQUEST_RUNNING;
+	worker->request = request;
+	worker->buf_offset = 0;
+
+	if (FAIL == zbx_write_all(worker->fd, (const char *)&len, sizeof(len)) ||
+			FAIL == zbx_write_all(worker->fd, request->request, len))
+	{
+		listener_worker_fail(loop, worker);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: reads available part of response from listener worker process     *
+ *                                                                            *
+ * Comments: Worker sockets are blocking, so only one read is done after      *
+ *           poll() reports that data is available.                           *
+ *                                                                            *
+ ******************************************************************************/
+static void	listener_worker_recv(listener_loop_t *loop, listener_worker_t *worker)
+{
+	zbx_uint32_t	len;
+	size_t		size;
+	ssize_t		n;
+
+	if (sizeof(len) > worker->buf_offset)
+	{
+		size = sizeof(len);
+	}
+	else
+	{
+		memcpy(&len, worker->buf, sizeof(len));
+		size = sizeof(len) + (LISTENER_NO_RESPONSE == len ? 0 : (size_t)len);
+	}
+
+	if (worker->buf_alloc < size + 1)
+	{
+		worker->buf_alloc = MAX(size + 1, ZBX_KIBIBYTE);
+		worker->buf = (char *)zbx_realloc(worker->buf, worker->buf_alloc);
+	}
+
+	if (worker->buf_offset < size)
+	{
+		if (0 >= (n = read(worker->fd, worker->buf + worker->buf_offset, size - worker->buf_offset)))
+		{
+			if (0 == n || EINTR != errno)
+				listener_worker_fail(loop, worker);
+
+			return;
+		}
+
+		worker->buf_offset += (size_t)n;
+
+		if (sizeof(len) == worker->buf_offset)
+		{
+			/* header has been received, read the response with the next call */
+			memcpy(&len, worker->buf, sizeof(len));
+
+			if (LISTENER_NO_RESPONSE != len && 0 != len)
+				return;
+		}
+		else if (worker->buf_offset < size)
+			return;
+	}
+
+	memcpy(&len, worker->buf, sizeof(len));
+
+	if (LISTENER_NO_RESPONSE == len)
+	{
+		listener_request_finish(worker->request, NULL, 0);
+	}
+	else
+	{
+		char	*response;
+
+		response = (char *)zbx_malloc(NULL, (size_t)len + 1);
+		memcpy(response, worker->buf + sizeof(len), len);
+		response[len] = '\0';
+		listener_request_finish(worker->request, response, len);
+	}
 
-		zbx_rtrim(s->buffer, "\r\n");
+	worker->request = NULL;
+	worker->buf_offset = 0;
 
-		zabbix_log(LOG_LEVEL_DEBUG, "Requested [%s]", s->buffer);
+	if (0 != worker->restart)
+	{
+		listener_worker_stop(worker);
+		(void)listener_worker_start(loop, worker);
+	}
+}
 
-		if (SUCCEED == zbx_json_open(s->buffer, &jp))
+/******************************************************************************
+ *                                                                            *
+ * Purpose: passes queued requests to idle workers or processes them when     *
+ *          no workers are configured                                         *
+ *                                                                            *
+ * Comments: Without workers only one request is processed per call, so       *
+ *           responses are sent and other connections are served between      *
+ *           the requests.                                                    *
+ *                                                                            *
+ ******************************************************************************/
+static void	listener_dispatch(listener_loop_t *loop)
+{
+	listener_request_t	*request;
+	int			i = 0;
+
+	while (SUCCEED == zbx_list_peek(&loop->queue, (void **)&request))
+	{
+		if (NULL == request->conn)
 		{
-			ret = process_passive_checks_json(s, config_timeout, &jp);
+			(void)zbx_list_pop(&loop->queue, NULL);
+			listener_request_free(request);
+			continue;
 		}
+
+		if (0 == loop->workers_num)
+		{
+			char	*response;
+			size_t	response_len;
+
+			(void)zbx_list_pop(&loop->queue, NULL);
+
+			zbx_setproctitle("listener #%d [processing request]", loop->process_num);
+			process_request(request->request, loop->args->config_timeout, &response, &response_len);
+			listener_request_finish(request, response, response_len);
+			break;
+		}
+
+		for (; i < loop->workers_num; i++)
+		{
+			if (-1 != loop->workers[i].fd && NULL == loop->workers[i].request)
+				break;
+		}
+
+		if (i == loop->workers_num)
+			break;
+
+		(void)zbx_list_pop(&loop->queue, NULL);
+		listener_worker_send(loop, &loop->workers[i], request);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: closes connection                                                 *
+ *                                                                            *
+ * Comments: Requests which are still being processed are detached from the   *
+ *           connection and freed when processing is finished.                *
+ *                                                                            *
+ ******************************************************************************/
+static void	listener_conn_free(listener_conn_t *conn)
+{
+	int	i;
+
+	for (i = 0; i < conn->requests.values_num; i++)
+	{
+		listener_request_t	*request = conn->requests.values[i];
+
+		if (LISTENER_REQUEST_DONE == request->state)
+			listener_request_free(request);
 		else
+			request->conn = NULL;
+	}
+
+	zbx_vector_listener_request_ptr_destroy(&conn->requests);
+
+	if (0 != conn->sending)
+		zbx_tcp_send_context_clear(&conn->send_context);
+
+	zbx_tcp_unaccept(&conn->s);
+	zbx_free(conn->buf);
+	zbx_free(conn);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: extracts the next complete request from received data             *
+ *                                                                            *
+ * Parameters: conn    - [IN/OUT]                                             *
+ *             request - [OUT] dynamically allocated request or NULL if more  *
+ *                             data is required                               *
+ *                                                                            *
+ * Return value: SUCCEED - request was extracted or more data is required     *
+ *               FAIL    - invalid message was received                       *
+ *                                                                            *
+ * Comments: Unlike zbx_tcp_recv_context() the data following the message is  *
+ *           kept for the next request, which allows pipelining.              *
+ *                                                                            *
+ ******************************************************************************/
+static int	listener_conn_get_request(listener_conn_t *conn, char **request)
+{
+#define HEADER_DATA	"ZBXD"
+#define HEADER_LEN	ZBX_CONST_STRLEN(HEADER_DATA)
+	zbx_uint64_t	expected_len, reserved, max_len;
+	unsigned char	protocol;
+	size_t		offset, out_len;
+	char		*out;
+
+	*request = NULL;
+
+	if (0 != strncmp(conn->buf, HEADER_DATA, MIN(conn->buf_offset, HEADER_LEN)))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "Message from %s is missing header. Message ignored.", conn->s.peer);
+		return FAIL;
+	}
+
+	if (HEADER_LEN + 1 > conn->buf_offset)
+		return SUCCEED;
+
+	protocol = (unsigned char)conn->buf[HEADER_LEN];
+
+	if (0 == (protocol & ZBX_TCP_PROTOCOL) || protocol > (ZBX_TCP_PROTOCOL | ZBX_TCP_COMPRESS | ZBX_TCP_LARGE))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "Message from %s is using unsupported protocol version \"%d\"."
+				" Message ignored.", conn->s.peer, (int)protocol);
+		return FAIL;
+	}
+
+	if (0 != (protocol & ZBX_TCP_LARGE))
+	{
+		zbx_uint64_t	len64_le;
+
+		if ((offset = HEADER_LEN + 1 + 2 * sizeof(len64_le)) > conn->buf_offset)
+			return SUCCEED;
+
+		memcpy(&len64_le, conn->buf + HEADER_LEN + 1, sizeof(len64_le));
+		expected_len = zbx_letoh_uint64(len64_le);
+		memcpy(&len64_le, conn->buf + HEADER_LEN + 1 + sizeof(len64_le), sizeof(len64_le));
+		reserved = zbx_letoh_uint64(len64_le);
+	}
+	else
+	{
+		zbx_uint32_t	len32_le;
+
+		if ((offset = HEADER_LEN + 1 + 2 * sizeof(len32_le)) > conn->buf_offset)
+			return SUCCEED;
+
+		memcpy(&len32_le, conn->buf + HEADER_LEN + 1, sizeof(len32_le));
+		expected_len = zbx_letoh_uint32(len32_le);
+		memcpy(&len32_le, conn->buf + HEADER_LEN + 1 + sizeof(len32_le), sizeof(len32_le));
+		reserved = zbx_letoh_uint32(len32_le);
+	}
+
+	max_len = (0 != conn->s.max_len_limit ? conn->s.max_len_limit : ZBX_MAX_RECV_DATA_SIZE);
+
+	if (max_len < expected_len || (0 != (protocol & ZBX_TCP_COMPRESS) && max_len < reserved))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "Message size " ZBX_FS_UI64 " from %s exceeds the maximum size "
+				ZBX_FS_UI64 " bytes. Message ignored.", MAX(expected_len, reserved), conn->s.peer,
+				max_len);
+		return FAIL;
+	}
+
+	if (offset + expected_len > conn->buf_offset)
+		return SUCCEED;
+
+	if (0 != (protocol & ZBX_TCP_COMPRESS))
+	{
+		out = (char *)zbx_malloc(NULL, (size_t)reserved + 1);
+		out_len = (size_t)reserved;
+
+		if (FAIL == zbx_uncompress(conn->buf + offset, (size_t)expected_len, out, &out_len) ||
+				out_len != reserved)
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "Cannot uncompress message from %s. Message ignored.",
+					conn->s.peer);
+			zbx_free(out);
+			return FAIL;
+		}
+	}
+	else
+	{
+		out_len = (size_t)expected_len;
+		out = (char *)zbx_malloc(NULL, out_len + 1);
+		memcpy(out, conn->buf + offset, out_len);
+	}
+
+	out[out_len] = '\0';
+
+	offset += (size_t)expected_len;
+	conn->buf_offset -= offset;
+	memmove(conn->buf, conn->buf + offset, conn->buf_offset);
+
+	*request = out;
+
+	return SUCCEED;
+#undef HEADER_DATA
+#undef HEADER_LEN
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: reads available data from connection and queues the received      *
+ *          requests                                                          *
+ *                                                                            *
+ * Return value: SUCCEED - data was read or would block                       *
+ *               FAIL    - network or protocol error                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	listener_conn_recv(listener_loop_t *loop, listener_conn_t *conn)
+{
+	conn->recv_events = 0;
+
+	for (;;)
+	{
+		ssize_t	n;
+
+		while (0 != conn->buf_offset && LISTENER_PIPELINE_MAX > conn->requests.values_num)
+		{
+			listener_request_t	*request;
+			char			*data;
+
+			if (FAIL == listener_conn_get_request(conn, &data))
+				return FAIL;
+
+			if (NULL == data)
+				break;
+
+			request = (listener_request_t *)zbx_malloc(NULL, sizeof(listener_request_t));
+			request->conn = conn;
+			request->request = data;
+			request->response = NULL;
+			request->response_len = 0;
+			request->state = LISTENER_REQUEST_QUEUED;
+
+			zbx_vector_listener_request_ptr_append(&conn->requests, request);
+			(void)zbx_list_append(&loop->queue, request, NULL);
+			conn->requests_num++;
+		}
+
+		if (0 != conn->eof || LISTENER_PIPELINE_MAX <= conn->requests.values_num)
+			break;
+
+		if (conn->buf_alloc - conn->buf_offset < ZBX_STAT_BUF_LEN)
+		{
+			conn->buf_alloc = MAX(conn->buf_alloc * 2, ZBX_STAT_BUF_LEN * 2);
+			conn->buf = (char *)zbx_realloc(conn->buf, conn->buf_alloc);
+		}
+
+		if (ZBX_PROTO_ERROR == (n = zbx_tcp_read(&conn->s, conn->buf + conn->buf_offset,
+				conn->buf_alloc - conn->buf_offset, &conn->recv_events)))
+		{
+			if (0 != conn->recv_events)
+				break;
+
+			return FAIL;
+		}
+
+		if (0 == n)
+		{
+			conn->eof = 1;
+			break;
+		}
+
+		conn->buf_offset += (size_t)n;
+		conn->lastaccess = time(NULL);
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: sends responses of processed requests in the order of arrival     *
+ *                                                                            *
+ * Return value: SUCCEED - responses were sent or sending would block         *
+ *               FAIL    - network error or there was nothing to send back,   *
+ *                         connection must be closed                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	listener_conn_send(listener_conn_t *conn)
+{
+	conn->send_events = 0;
+
+	while (0 != conn->requests.values_num)
+	{
+		listener_request_t	*request = conn->requests.values[0];
+
+		if (LISTENER_REQUEST_DONE != request->state)
+			break;
+
+		if (NULL == request->response)
+			return FAIL;
+
+		if (0 == conn->sending)
+		{
+			if (SUCCEED != zbx_tcp_send_context_init(request->response, request->response_len, 0,
+					ZBX_TCP_PROTOCOL, &conn->send_context))
+			{
+				return FAIL;
+			}
+
+			conn->sending = 1;
+		}
+
+		if (SUCCEED != zbx_tcp_send_context(&conn->s, &conn->send_context, &conn->send_events))
 		{
-			AGENT_RESULT	result;
-			char		**value = NULL;
+			if (0 != conn->send_events)
+				break;
+
+			return FAIL;
+		}
+
+		zbx_tcp_send_context_clear(&conn->send_context);
+		conn->sending = 0;
+		conn->lastaccess = time(NULL);
+
+		zbx_vector_listener_request_ptr_remove(&conn->requests, 0);
+		listener_request_free(request);
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: continues TLS handshake of accepted connection and checks peer    *
+ *          when it is finished                                               *
+ *                                                                            *
+ * Return value: SUCCEED - handshake is finished or must be continued when    *
+ *                         connection is ready for recv_events                *
+ *               FAIL    - connection was refused                             *
+ *                                                                            *
+ ******************************************************************************/
+static int	listener_conn_handshake(listener_loop_t *loop, listener_conn_t *conn)
+{
+	const zbx_thread_listener_args	*args = loop->args;
+#if defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL)
+	char				*msg = NULL;
+#endif
+	if (SUCCEED != zbx_tcp_accept_handshake(&conn->s, args->zbx_config_tls->accept_modes, &conn->recv_events))
+	{
+		if (0 != conn->recv_events)
+			return SUCCEED;
+
+		zabbix_log(LOG_LEVEL_WARNING, "failed to accept an incoming connection: %s", zbx_socket_strerror());
+		return FAIL;
+	}
+
+	if ('\0' == *args->config_hosts_allowed)
+		return FAIL;
+
+	if (SUCCEED != zbx_tcp_check_allowed_peers(&conn->s, args->config_hosts_allowed))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "failed to accept an incoming connection: %s", zbx_socket_strerror());
+		return FAIL;
+	}
+#if defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL)
+	if (ZBX_TCP_SEC_TLS_CERT == conn->s.connection_type && SUCCEED != zbx_check_server_issuer_subject(&conn->s,
+			args->zbx_config_tls->server_cert_issuer, args->zbx_config_tls->server_cert_subject, &msg))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "failed to accept an incoming connection: %s", msg);
+		zbx_free(msg);
+		return FAIL;
+	}
+#endif
+	conn->handshake = 0;
+	conn->recv_events = POLLIN;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: performs pending connection input and output                      *
+ *                                                                            *
+ * Return value: SUCCEED - connection must be kept open                       *
+ *               FAIL    - connection must be closed                          *
+ *                                                                            *
+ * Comments: The connection is closed after all received requests have been   *
+ *           answered and the peer has not sent more data, so clients which   *
+ *           wait for the connection to be closed are not delayed. Pipelined  *
+ *           requests sent before reading the responses are served over the   *
+ *           same connection.                                                 *
+ *                                                                            *
+ ******************************************************************************/
+static int	listener_conn_process(listener_loop_t *loop, listener_conn_t *conn)
+{
+	if (0 != conn->handshake)
+	{
+		if (SUCCEED != listener_conn_handshake(loop, conn))
+			return FAIL;
+
+		if (0 != conn->handshake)
+			return SUCCEED;
+	}
+
+	if (SUCCEED != listener_conn_recv(loop, conn) || SUCCEED != listener_conn_send(conn))
+		return FAIL;
+
+	if (0 != conn->requests.values_num || 0 == conn->requests_num)
+		return 0 == conn->eof || 0 != conn->requests.values_num ? SUCCEED : FAIL;
+
+	/* all requests have been answered, check if more have been sent meanwhile */
+	if (SUCCEED != listener_conn_recv(loop, conn))
+		return FAIL;
+
+	if (0 == conn->requests.values_num && 0 == conn->buf_offset)
+		return FAIL;
+
+	return 0 == conn->eof || 0 != conn->requests.values_num ? SUCCEED : FAIL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: accepts new connection                                            *
+ *                                                                            *
+ * Comments: Connection is accepted without waiting for the peer, TLS         *
+ *           handshake and peer checks are done by listener_conn_process()    *
+ *           when the peer sends data.                                        *
+ *                                                                            *
+ ******************************************************************************/
+static void	listener_accept(listener_loop_t *loop)
+{
+	listener_conn_t	*conn;
+	int		ret;
+
+	conn = (listener_conn_t *)zbx_malloc(NULL, sizeof(listener_conn_t));
+	memcpy(&conn->s, loop->listen_sock, sizeof(zbx_socket_t));
+	conn->s.buf_type = ZBX_BUF_TYPE_STAT;
+	conn->s.buffer = conn->s.buf_stat;
+
+	if (SUCCEED != (ret = zbx_tcp_accept_nowait(&conn->s)))
+	{
+		zbx_free(conn);
+
+		/* connection was accepted by another listener */
+		if (TIMEOUT_ERROR == ret)
+			return;
+
+		zabbix_log(LOG_LEVEL_WARNING, "failed to accept an incoming connection: %s", zbx_socket_strerror());
+
+		/* pause accepting instead of sleeping to keep serving the accepted connections */
+		loop->accept_resume = time(NULL) + 1;
+
+		return;
+	}
+
+	conn->buf = NULL;
+	conn->buf_alloc = 0;
+	conn->buf_offset = 0;
+	conn->requests_num = 0;
+	conn->lastaccess = time(NULL);
+	conn->recv_events = POLLIN;
+	conn->send_events = 0;
+	conn->handshake = 1;
+	conn->sending = 0;
+	conn->eof = 0;
+	zbx_vector_listener_request_ptr_create(&conn->requests);
+	zbx_vector_listener_conn_ptr_append(&loop->conns, conn);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: serves passive checks multiplexing connections with poll()        *
+ *                                                                            *
+ * Comments: Requests are processed by worker processes forked by listener    *
+ *           when StartListenerWorkers is set, otherwise by listener itself   *
+ *           and new connections are not accepted while requests are queued.  *
+ *           Workers are processes instead of threads because item timeouts   *
+ *           rely on process wide alarm().                                    *
+ *                                                                            *
+ ******************************************************************************/
+static void	listener_loop_run(zbx_socket_t *listen_sock, const zbx_thread_listener_args *args,
+		unsigned char process_type, int process_num)
+{
+	listener_loop_t		loop;
+	listener_request_t	*request;
+	zbx_pollfd_t		*pds = NULL;
+	int			pds_alloc = 0, i;
+
+	loop.listen_sock = listen_sock;
+	loop.args = args;
+	loop.process_num = process_num;
+	loop.accept_resume = 0;
+	zbx_vector_listener_conn_ptr_create(&loop.conns);
+	zbx_list_create(&loop.queue);
+
+	loop.workers_num = args->config_listener_workers;
+	loop.workers = (listener_worker_t *)zbx_calloc(NULL, (size_t)MAX(loop.workers_num, 1),
+			sizeof(listener_worker_t));
 
-			zbx_init_agent_result(&result);
+	for (i = 0; i < loop.workers_num; i++)
+		loop.workers[i].fd = -1;
 
-			if (SUCCEED == zbx_execute_agent_check(s->buffer, ZBX_PROCESS_WITH_ALIAS, &result,
-					config_timeout))
+	for (i = 0; i < loop.workers_num; i++)
+		(void)listener_worker_start(&loop, &loop.workers[i]);
+
+	while (ZBX_IS_RUNNING())
+	{
+		int	pds_num = 0, conns_offset, workers_offset, busy_num = 0, idle_num = 0, timeout, rc;
+		time_t	now;
+
+		if (1 == need_update_userparam)
+		{
+			zbx_setproctitle("listener #%d [reloading user parameters]", process_num);
+			reload_user_parameters(process_type, process_num, args->config_file);
+			need_update_userparam = 0;
+
+			for (i = 0; i < loop.workers_num; i++)
 			{
-				if (NULL != (value = ZBX_GET_TEXT_RESULT(&result)))
+				if (NULL != loop.workers[i].request)
 				{
-					zabbix_log(LOG_LEVEL_DEBUG, "Sending back [%s]", *value);
-					ret = zbx_tcp_send_to(s, *value, config_timeout);
+					loop.workers[i].restart = 1;
+					continue;
 				}
+
+				listener_worker_stop(&loop.workers[i]);
+				(void)listener_worker_start(&loop, &loop.workers[i]);
 			}
-			else
+		}
+
+		listener_dispatch(&loop);
+
+		for (i = 0; i < loop.workers_num; i++)
+		{
+			/* retry starting workers which have failed to start */
+			if (-1 == loop.workers[i].fd)
+				(void)listener_worker_start(&loop, &loop.workers[i]);
+		}
+
+		for (i = 0; i < loop.conns.values_num; i++)
+		{
+			listener_conn_t	*conn = loop.conns.values[i];
+
+			/* send responses of requests processed by listener itself */
+			if (0 == conn->handshake && 0 == conn->send_events &&
+					SUCCEED != listener_conn_process(&loop, conn))
+			{
+				listener_conn_free(conn);
+				zbx_vector_listener_conn_ptr_remove_noorder(&loop.conns, i--);
+			}
+		}
+
+		if (pds_alloc < listen_sock->num_socks + loop.workers_num + loop.conns.values_num)
+		{
+			pds_alloc = listen_sock->num_socks + loop.workers_num + LISTENER_CONNECTIONS_MAX;
+			pds = (zbx_pollfd_t *)zbx_realloc(pds, sizeof(zbx_pollfd_t) * (size_t)pds_alloc);
+		}
+
+		now = time(NULL);
+
+		/* Without workers requests are processed by listener one at a time, so new connections are */
+		/* left to other listeners until the queued requests are processed instead of keeping them   */
+		/* waiting behind a slow check.                                                              */
+		if (LISTENER_CONNECTIONS_MAX > loop.conns.values_num && now >= loop.accept_resume &&
+				(0 != loop.workers_num || SUCCEED != zbx_list_peek(&loop.queue, (void **)&request)))
+		{
+			for (i = 0; i < listen_sock->num_socks; i++)
 			{
-				value = ZBX_GET_MSG_RESULT(&result);
+				pds[pds_num].fd = listen_sock->sockets[i];
+				pds[pds_num++].events = POLLIN;
+			}
+		}
 
-				if (NULL != value)
-				{
-					static char	*buffer = NULL;
-					static size_t	buffer_alloc = 256;
-					size_t		buffer_offset = 0;
+		workers_offset = pds_num;
+
+		for (i = 0; i < loop.workers_num; i++)
+		{
+			pds[pds_num].fd = loop.workers[i].fd;
+			pds[pds_num++].events = POLLIN;
+
+			if (NULL != loop.workers[i].request)
+				busy_num++;
+			else if (-1 != loop.workers[i].fd)
+				idle_num++;
+		}
+
+		conns_offset = pds_num;
+
+		for (i = 0; i < loop.conns.values_num; i++)
+		{
+			listener_conn_t	*conn = loop.conns.values[i];
+
+			pds[pds_num].fd = conn->s.socket;
+			pds[pds_num++].events = conn->recv_events | conn->send_events;
+		}
+
+		if (0 == loop.conns.values_num)
+			zbx_setproctitle("listener #%d [waiting for connection]", process_num);
+		else
+		{
+			zbx_setproctitle("listener #%d [serving %d connections, %d requests in progress]", process_num,
+					loop.conns.values_num, busy_num);
+		}
+
+		/* do not wait if there are requests which can be processed right away */
+		if (SUCCEED == zbx_list_peek(&loop.queue, (void **)&request) &&
+				(0 == loop.workers_num || 0 != idle_num))
+		{
+			timeout = 0;
+		}
+		else
+			timeout = 1000;
+
+		rc = zbx_socket_poll(pds, (unsigned long)pds_num, timeout);
+		zbx_update_env(get_process_type_string(process_type), zbx_time());
+
+		if (-1 == rc)
+		{
+			if (EINTR != errno)
+			{
+				zabbix_log(LOG_LEVEL_WARNING, "cannot wait for connections: %s", zbx_strerror(errno));
+				zbx_sleep(1);
+			}
 
-					zabbix_log(LOG_LEVEL_DEBUG, "Sending back [" ZBX_NOTSUPPORTED ": %s]", *value);
+			continue;
+		}
 
-					if (NULL == buffer)
-						buffer = (char *)zbx_malloc(buffer, buffer_alloc);
+		for (i = 0; i < loop.workers_num; i++)
+		{
+			if (0 == (pds[workers_offset + i].revents & (POLLIN | POLLHUP | POLLERR)))
+				continue;
+
+			/* idle worker can only report that it has terminated */
+			if (NULL == loop.workers[i].request)
+				listener_worker_fail(&loop, &loop.workers[i]);
+			else
+				listener_worker_recv(&loop, &loop.workers[i]);
+		}
 
-					zbx_strncpy_alloc(&buffer, &buffer_alloc, &buffer_offset,
-							ZBX_NOTSUPPORTED, ZBX_CONST_STRLEN(ZBX_NOTSUPPORTED));
-					buffer_offset++;
-					zbx_strcpy_alloc(&buffer, &buffer_alloc, &buffer_offset, *value);
+		now = time(NULL);
 
-					ret = zbx_tcp_send_bytes_to(s, buffer, buffer_offset, config_timeout);
+		for (i = loop.conns.values_num - 1; 0 <= i; i--)
+		{
+			listener_conn_t	*conn = loop.conns.values[i];
+			int		ret = SUCCEED;
+
+			if (0 != pds[conns_offset + i].revents && SUCCEED != listener_conn_process(&loop, conn))
+			{
+				zabbix_log(LOG_LEVEL_DEBUG, "closing connection from %s", conn->s.peer);
+				ret = FAIL;
+			}
+			else if ((0 == conn->requests.values_num || 0 != conn->send_events) &&
+					conn->lastaccess + args->config_timeout <= now)
+			{
+				if (0 != conn->handshake)
+				{
+					zabbix_log(LOG_LEVEL_WARNING, "failed to accept an incoming connection: from %s:"
+							" timed out", conn->s.peer);
 				}
 				else
 				{
-					zabbix_log(LOG_LEVEL_DEBUG, "Sending back [" ZBX_NOTSUPPORTED "]");
-					ret = zbx_tcp_send_to(s, ZBX_NOTSUPPORTED, config_timeout);
+					zabbix_log(LOG_LEVEL_DEBUG, "Process listener error: connection from %s timed"
+							" out", conn->s.peer);
 				}
+
+				ret = FAIL;
 			}
 
-			zbx_free_agent_result(&result);
+			if (SUCCEED != ret)
+			{
+				listener_conn_free(conn);
+				zbx_vector_listener_conn_ptr_remove_noorder(&loop.conns, i);
+			}
+		}
+
+		for (i = 0; i < workers_offset; i++)
+		{
+			if (0 != (pds[i].revents & POLLIN))
+			{
+				listener_accept(&loop);
+				break;
+			}
 		}
 	}
 
-	if (FAIL == ret)
-		zabbix_log(LOG_LEVEL_DEBUG, "Process listener error: %s", zbx_socket_strerror());
+	for (i = 0; i < loop.conns.values_num; i++)
+		listener_conn_free(loop.conns.values[i]);
+
+	zbx_vector_listener_conn_ptr_destroy(&loop.conns);
+
+	for (i = 0; i < loop.workers_num; i++)
+	{
+		if (NULL != loop.workers[i].request)
+			listener_request_free(loop.workers[i].request);
+
+		listener_worker_stop(&loop.workers[i]);
+		zbx_free(loop.workers[i].buf);
+	}
+
+	zbx_free(loop.workers);
+
+	while (SUCCEED == zbx_list_pop(&loop.queue, (void **)&request))
+		listener_request_free(request);
+
+	zbx_list_destroy(&loop.queue);
+	zbx_free(pds);
 }
+#endif
 
 #ifndef _WINDOWS
 static void	zbx_listener_sigusr_handler(int flags)
@@ -221,15 +1335,18 @@ static void	zbx_listener_sigusr_handler(int flags)
 
 ZBX_THREAD_ENTRY(listener_thread, args)
 {
+#ifdef _WINDOWS
 #define POLL_TIMEOUT		1
 #if defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL)
 	char				*msg = NULL;
+#endif
+	int				ret;
 #endif
 	zbx_socket_t			s;
 	zbx_thread_listener_args	*init_child_args_in;
 	zbx_thread_info_t		*info = &((zbx_thread_args_t *)args)->info;
 	unsigned char			process_type = ((zbx_thread_args_t *)args)->info.process_type;
-	int				ret, server_num = ((zbx_thread_args_t *)args)->info.server_num,
+	int				server_num = ((zbx_thread_args_t *)args)->info.server_num,
 					process_num = ((zbx_thread_args_t *)args)->info.process_num;
 
 	init_child_args_in = (zbx_thread_listener_args *)((((zbx_thread_args_t *)args))->args);
@@ -250,17 +1367,11 @@ ZBX_THREAD_ENTRY(listener_thread, args)
 #endif
 	zbx_cfg_set_process_num(process_num);
 
+#ifndef _WINDOWS
+	listener_loop_run(&s, init_child_args_in, process_type, process_num);
+#else
 	while (ZBX_IS_RUNNING())
 	{
-#ifndef _WINDOWS
-		if (1 == need_update_userparam)
-		{
-			zbx_setproctitle("listener #%d [reloading user parameters]", process_num);
-			reload_user_parameters(process_type, process_num, init_child_args_in->config_file);
-			need_update_userparam = 0;
-		}
-#endif
-
 		zbx_setproctitle("listener #%d [waiting for connection]", process_num);
 		ret = zbx_tcp_accept(&s, init_child_args_in->zbx_config_tls->accept_modes, POLL_TIMEOUT, 0, NULL);
 		zbx_update_env(get_process_type_string(process_type), zbx_time());
@@ -310,6 +1421,7 @@ ZBX_THREAD_ENTRY(listener_thread, args)
 		if (ZBX_IS_RUNNING())
 			zbx_sleep(1);
 	}
+#endif
 
 #ifdef _WINDOWS
 	ZBX_DO_EXIT();
@@ -321,5 +1433,7 @@ ZBX_THREAD_ENTRY(listener_thread, args)
 	while (1)
 		zbx_sleep(SEC_PER_MIN);
 #endif
+#ifdef _WINDOWS
 #undef POLL_TIMEOUT
+#endif
 }
@@ -26,6 +26,7 @@ typedef struct
 	const char		*config_file;
 	int			config_timeout;
 	const char		*config_hosts_allowed;
+	int			config_listener_workers;
 }
 zbx_thread_listener_args;
 
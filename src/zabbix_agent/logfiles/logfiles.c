@@ -30,6 +30,8 @@
 #	include "zbxtypes.h"	/* ssize_t */
 #	include "zbxwin32.h"
 #	include "zbxlog.h"
+#else
+#	include "logwatch.h"
 #endif /* _WINDOWS */
 
 #define MAX_LEN_MD5	512	/* maximum size of the first and the last blocks of the file to calculate MD5 sum for */
@@ -1987,7 +1989,7 @@ static int	zbx_read2(int fd, unsigned char flags, struct st_logfile *logfile, zb
 
 	int				ret, nbytes;
 	const char			*cr, *lf, *p_end;
-	char				*p_start, *p, *p_nl, *p_next, *item_value = NULL;
+	char				*p_start, *p, *p_nl, *p_next, *item_value = NULL, *literal = NULL;
 	size_t				szbyte;
 	zbx_offset_t			offset;
 	const int			is_count_item = (0 != (ZBX_METRIC_FLAG_LOG_COUNT & flags)) ? 1 : 0;
@@ -2009,6 +2011,15 @@ static int	zbx_read2(int fd, unsigned char flags, struct st_logfile *logfile, zb
 
 	zbx_find_cr_lf_szbyte(encoding, &cr, &lf, &szbyte);
 
+	/* Records without the literal part of the regular expression cannot match, they are rejected without */
+	/* running the regular expression. The expression is compiled first so that invalid expressions are */
+	/* still reported. Global regular expressions ('@' prefix) are matched as usual. */
+	if (NULL != pattern && '\0' != *pattern && '@' != *pattern &&
+			ZBX_REGEXP_COMPILE_FAIL != zbx_regexp_match_ex(regexps, "", pattern, ZBX_CASE_SENSITIVE))
+	{
+		literal = zbx_regexp_extract_literal(pattern);
+	}
+
 	for (;;)
 	{
 		if (0 >= *p_count || 0 >= *s_count)
@@ -2096,9 +2107,17 @@ static int	zbx_read2(int fd, unsigned char flags, struct st_logfile *logfile, zb
 					processed_size = (size_t)offset + (size_t)nbytes;
 					send_err = FAIL;
 
-					regexp_ret = zbx_regexp_sub_ex2(regexps, value, pattern, ZBX_CASE_SENSITIVE,
-							(0 == is_count_item) ? output_template : NULL,
-							(0 == is_count_item) ? &item_value : NULL, err_msg);
+					if (NULL != literal && NULL == strstr(value, literal))
+					{
+						regexp_ret = ZBX_REGEXP_NO_MATCH;
+					}
+					else
+					{
+						regexp_ret = zbx_regexp_sub_ex2(regexps, value, pattern,
+								ZBX_CASE_SENSITIVE,
+								(0 == is_count_item) ? output_template : NULL,
+								(0 == is_count_item) ? &item_value : NULL, err_msg);
+					}
 #if !defined(_WINDOWS) && !defined(__MINGW32__)
 					if (NULL != persistent_file_name && (ZBX_REGEXP_MATCH == regexp_ret ||
 							ZBX_REGEXP_NO_MATCH == regexp_ret ||
@@ -2234,9 +2253,17 @@ static int	zbx_read2(int fd, unsigned char flags, struct st_logfile *logfile, zb
 					processed_size = (size_t)offset + (size_t)(p_next - buf);
 					send_err = FAIL;
 
-					regexp_ret = zbx_regexp_sub_ex2(regexps, value, pattern, ZBX_CASE_SENSITIVE,
-							(0 == is_count_item) ? output_template : NULL,
-							(0 == is_count_item) ? &item_value : NULL, err_msg);
+					if (NULL != literal && NULL == strstr(value, literal))
+					{
+						regexp_ret = ZBX_REGEXP_NO_MATCH;
+					}
+					else
+					{
+						regexp_ret = zbx_regexp_sub_ex2(regexps, value, pattern,
+								ZBX_CASE_SENSITIVE,
+								(0 == is_count_item) ? output_template : NULL,
+								(0 == is_count_item) ? &item_value : NULL, err_msg);
+					}
 #if !defined(_WINDOWS) && !defined(__MINGW32__)
 					if (NULL != persistent_file_name && (ZBX_REGEXP_MATCH == regexp_ret ||
 							ZBX_REGEXP_NO_MATCH == regexp_ret ||
@@ -2357,6 +2384,8 @@ static int	zbx_read2(int fd, unsigned char flags, struct st_logfile *logfile, zb
 		}
 	}
 out:
+	zbx_free(literal);
+
 	return ret;
 
 #undef BUF_SIZE
@@ -3636,6 +3665,55 @@ out:
 	return ret;
 }
 
+#if !defined(_WINDOWS) && !defined(__MINGW32__)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: starts or stops watching log files of an item after check         *
+ *                                                                            *
+ * Parameters: metric   - [IN/OUT] log item                                   *
+ *             filename - [IN] log file name or file name regular expression  *
+ *                             with path                                      *
+ *             complete - [IN] 1 - the new log file list was accepted         *
+ *                                                                            *
+ * Comments: Log files are watched only if all data was processed, otherwise  *
+ *           the next check must continue reading them.                       *
+ *                                                                            *
+ ******************************************************************************/
+static void	update_log_watch(zbx_active_metric_t *metric, const char *filename, int complete)
+{
+	const char	*separator;
+	char		*directory;
+
+	if (0 == complete || 0 != metric->error_count || NULL == (separator = strrchr(filename, ZBX_PATH_SEPARATOR)))
+	{
+		zbx_logwatch_reset(&metric->watch);
+		return;
+	}
+
+	for (int i = 0; i < metric->logfiles_num; i++)
+	{
+		const struct st_logfile	*logfile = &metric->logfiles[i];
+
+		if (0 == logfile->incomplete && logfile->processed_size < logfile->size)
+		{
+			zbx_logwatch_reset(&metric->watch);
+			return;
+		}
+	}
+
+	directory = (char *)zbx_malloc(NULL, (size_t)(separator - filename) + 2);
+	memcpy(directory, filename, (size_t)(separator - filename) + 1);
+	directory[separator - filename + 1] = '\0';
+
+	/* the list is sorted by modification time, the file being written to is the last one */
+	zbx_logwatch_update(&metric->watch, directory, separator + 1,
+			0 != (ZBX_METRIC_FLAG_LOG_LOGRT & metric->flags) ? 1 : 0, 0 < metric->logfiles_num ?
+			metric->logfiles[metric->logfiles_num - 1].filename : NULL);
+
+	zbx_free(directory);
+}
+#endif
+
 static int	check_number_of_parameters(unsigned char flags, const AGENT_REQUEST *request, char **error)
 {
 	int	parameter_num, max_parameter_num;
@@ -3842,8 +3920,9 @@ int	process_log_check(zbx_vector_addr_ptr_t *addrs, zbx_vector_ptr_t *agent2_res
 	AGENT_REQUEST			request;
 	const char			*filename, *regexp, *encoding, *skip, *output_template;
 	char				*encoding_uc = NULL;
-	int				max_lines_per_sec, ret = FAIL, s_count, p_count, s_count_orig, is_count_item,
-					mtime_orig, big_rec_orig, logfiles_num_new = 0, jumped = 0, delay;
+	int				max_lines_per_sec, ret = FAIL, s_count, p_count, s_count_orig = 0,
+					is_count_item, mtime_orig, big_rec_orig, logfiles_num_new = 0, jumped = 0,
+					delay, unchanged = 0, complete = 0;
 	zbx_log_rotation_options_t	rotation_type;
 	zbx_uint64_t			lastlogsize_orig;
 	float				max_delay;
@@ -3958,8 +4037,9 @@ int	process_log_check(zbx_vector_addr_ptr_t *addrs, zbx_vector_ptr_t *agent2_res
 		goto out;
 	}
 
-	/* do not flood Zabbix server if file grows too fast */
-	if (0 >= (delay = metric->nextcheck - (int)time(NULL)))
+	/* do not flood Zabbix server if file grows too fast, checks started early by log file changes */
+	/* are limited to one second worth of lines */
+	if (0 >= (delay = metric->nextcheck - (int)time(NULL)) || 0 != metric->watch.woken)
 		delay = 1;
 
 	s_count = max_lines_per_sec * delay;
@@ -4066,14 +4146,30 @@ int	process_log_check(zbx_vector_addr_ptr_t *addrs, zbx_vector_ptr_t *agent2_res
 			zbx_free(err_msg);
 		}
 	}
+
+	/* skip scanning log files if nothing has changed since all their data was processed */
+	if (0 == (ZBX_METRIC_FLAG_NEW & metric->flags) && SUCCEED == zbx_logwatch_unchanged(&metric->watch))
+		unchanged = 1;
 #endif
-	ret = process_logrt(metric->flags, filename, &metric->lastlogsize, &metric->mtime, lastlogsize_sent, mtime_sent,
-			&metric->skip_old_data, &metric->big_rec, &metric->use_ino, error, &metric->logfiles,
-			metric->logfiles_num, &logfiles_new, &logfiles_num_new, encoding, regexps, regexp,
-			output_template, &p_count, &s_count, process_value_cb, addrs, agent2_result, config_hostname,
-			metric->key, &jumped, max_delay, &metric->start_time, &metric->processed_bytes,
-			rotation_type, metric->persistent_file_name, prep_vec, config_tls, config_timeout,
-			config_source_ip, metric->itemid, config_buffer_send, config_buffer_size);
+	if (0 == unchanged)
+	{
+		ret = process_logrt(metric->flags, filename, &metric->lastlogsize, &metric->mtime, lastlogsize_sent,
+				mtime_sent, &metric->skip_old_data, &metric->big_rec, &metric->use_ino, error,
+				&metric->logfiles, metric->logfiles_num, &logfiles_new, &logfiles_num_new, encoding,
+				regexps, regexp, output_template, &p_count, &s_count, process_value_cb, addrs,
+				agent2_result, config_hostname, metric->key, &jumped, max_delay, &metric->start_time,
+				&metric->processed_bytes, rotation_type, metric->persistent_file_name, prep_vec,
+				config_tls, config_timeout, config_source_ip, metric->itemid, config_buffer_send,
+				config_buffer_size);
+	}
+	else
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "%s(): item \"%s\": log files have not changed", __func__, metric->key);
+
+		/* there was nothing to process, prevent jump in the next check */
+		metric->start_time = 0.0;
+		ret = SUCCEED;
+	}
 
 	if (0 == is_count_item && NULL != logfiles_new)
 	{
@@ -4088,7 +4184,11 @@ int	process_log_check(zbx_vector_addr_ptr_t *addrs, zbx_vector_ptr_t *agent2_res
 	{
 		metric->error_count = 0;
 
-		if (0 != is_count_item)
+		if (0 == is_count_item)
+		{
+			complete = 1;
+		}
+		else
 		{
 			/* send log.count[] or logrt.count[] item value to server */
 
@@ -4112,10 +4212,15 @@ int	process_log_check(zbx_vector_addr_ptr_t *addrs, zbx_vector_ptr_t *agent2_res
 				*lastlogsize_sent = metric->lastlogsize;
 				*mtime_sent = metric->mtime;
 
-				/* switch to the new log file list */
-				destroy_logfile_list(&metric->logfiles, NULL, &metric->logfiles_num);
-				metric->logfiles = logfiles_new;
-				metric->logfiles_num = logfiles_num_new;
+				/* switch to the new log file list, the old one is kept if log files were not checked */
+				if (0 == unchanged)
+				{
+					destroy_logfile_list(&metric->logfiles, NULL, &metric->logfiles_num);
+					metric->logfiles = logfiles_new;
+					metric->logfiles_num = logfiles_num_new;
+				}
+
+				complete = 1;
 			}
 			else
 			{
@@ -4157,6 +4262,13 @@ int	process_log_check(zbx_vector_addr_ptr_t *addrs, zbx_vector_ptr_t *agent2_res
 			ret = SUCCEED;
 		}
 	}
+#if !defined(_WINDOWS) && !defined(__MINGW32__)
+	metric->watch.lastcheck = (int)time(NULL);
+	metric->watch.woken = 0;
+
+	if (0 == unchanged)
+		update_log_watch(metric, filename, complete);
+#endif
 out:
 	zbx_free(encoding_uc);
 	zbx_free_agent_request(&request);
@@ -0,0 +1,701 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "logwatch.h"
+
+#include "zbxalgo.h"
+#include "zbxlog.h"
+#include "zbxregexp.h"
+#include "zbxstr.h"
+#include "zbxtime.h"
+#include "zbxthreads.h"
+
+#if defined(HAVE_SYS_INOTIFY_H)
+
+/* changes not reported by inotify (e.g. writes through shared memory mappings) are picked up by periodic */
+/* full checks of log files */
+#define ZBX_LOGWATCH_RESCAN_PERIOD	SEC_PER_MIN
+
+#define ZBX_LOGWATCH_EVENTS		(IN_MODIFY | IN_ATTRIB | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | \
+					IN_DELETE_SELF | IN_MOVE_SELF)
+
+/* file systems where inotify does not see changes made by other hosts */
+#define ZBX_FS_NFS	0x6969
+#define ZBX_FS_SMB	0x517b
+#define ZBX_FS_SMB2	0xfe534d42
+#define ZBX_FS_CIFS	0xff534d42
+#define ZBX_FS_FUSE	0x65735546
+#define ZBX_FS_CEPH	0x00c36400
+#define ZBX_FS_AFS	0x5346414f
+#define ZBX_FS_V9FS	0x01021997
+#define ZBX_FS_GFS2	0x01161970
+#define ZBX_FS_OCFS2	0x7461636f
+
+/* log files of a directory watch monitored by items, other files of the directory are ignored */
+typedef struct
+{
+	char		*pattern;	/* log file name or regular expression of log file names */
+	zbx_regexp_t	*regexp;	/* compiled pattern, NULL if pattern is a file name */
+	int		refs;
+	zbx_uint64_t	revision;	/* watcher revision of the last event of a matching file */
+}
+zbx_logwatch_filter_t;
+
+ZBX_PTR_VECTOR_DECL(logwatch_filter_ptr, zbx_logwatch_filter_t *)
+ZBX_PTR_VECTOR_IMPL(logwatch_filter_ptr, zbx_logwatch_filter_t *)
+
+typedef struct
+{
+	int					wd;
+	int					refs;
+	char					*path;
+	zbx_uint64_t				revision;	/* watcher revision of the last event */
+	zbx_vector_logwatch_filter_ptr_t	filters;	/* directory watch filters */
+}
+zbx_logwatch_entry_t;
+
+typedef struct
+{
+	int		fd;
+	zbx_uint64_t	revision;
+	time_t		rescan_time;
+	zbx_hashset_t	entries;
+}
+zbx_logwatch_t;
+
+static ZBX_THREAD_LOCAL zbx_logwatch_t	logwatch = {.fd = -1};
+
+static zbx_hash_t	logwatch_entry_hash(const void *data)
+{
+	const zbx_logwatch_entry_t	*entry = (const zbx_logwatch_entry_t *)data;
+
+	return ZBX_DEFAULT_HASH_ALGO(&entry->wd, sizeof(entry->wd), ZBX_DEFAULT_HASH_SEED);
+}
+
+static int	logwatch_entry_compare(const void *d1, const void *d2)
+{
+	const zbx_logwatch_entry_t	*entry1 = (const zbx_logwatch_entry_t *)d1;
+	const zbx_logwatch_entry_t	*entry2 = (const zbx_logwatch_entry_t *)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(entry1->wd, entry2->wd);
+
+	return 0;
+}
+
+static void	logwatch_filter_free(zbx_logwatch_filter_t *filter)
+{
+	if (NULL != filter->regexp)
+		zbx_regexp_free(filter->regexp);
+
+	zbx_free(filter->pattern);
+	zbx_free(filter);
+}
+
+static void	logwatch_entry_clean(void *data)
+{
+	zbx_logwatch_entry_t	*entry = (zbx_logwatch_entry_t *)data;
+
+	zbx_free(entry->path);
+	zbx_vector_logwatch_filter_ptr_clear_ext(&entry->filters, logwatch_filter_free);
+	zbx_vector_logwatch_filter_ptr_destroy(&entry->filters);
+}
+
+static zbx_logwatch_filter_t	*logwatch_filter_get(const zbx_logwatch_entry_t *entry, const char *pattern,
+		unsigned char regexp)
+{
+	for (int i = 0; i < entry->filters.values_num; i++)
+	{
+		zbx_logwatch_filter_t	*filter = entry->filters.values[i];
+
+		if ((NULL != filter->regexp) == (0 != regexp) && 0 == strcmp(filter->pattern, pattern))
+			return filter;
+	}
+
+	return NULL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: marks directory watch filters matching the changed file           *
+ *                                                                            *
+ * Parameters: entry - [IN/OUT] directory watch                               *
+ *             name  - [IN] name of the changed file in the directory         *
+ *                                                                            *
+ * Return value: SUCCEED - the file is monitored by at least one item         *
+ *               FAIL    - the file is not monitored, change is ignored       *
+ *                                                                            *
+ ******************************************************************************/
+static int	logwatch_entry_match(zbx_logwatch_entry_t *entry, const char *name)
+{
+	int	ret = FAIL;
+
+	for (int i = 0; i < entry->filters.values_num; i++)
+	{
+		zbx_logwatch_filter_t	*filter = entry->filters.values[i];
+
+		if (NULL != filter->regexp)
+		{
+			if (0 != zbx_regexp_match_precompiled(name, filter->regexp))
+				continue;
+		}
+		else if (0 != strcmp(name, filter->pattern))
+			continue;
+
+		filter->revision = logwatch.revision;
+		ret = SUCCEED;
+	}
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if path resides on a network file system                   *
+ *                                                                            *
+ * Comments: Changes made on other hosts are not reported by inotify, such    *
+ *           paths must be checked by polling.                                *
+ *                                                                            *
+ ******************************************************************************/
+static int	logwatch_is_remote(const char *path)
+{
+	struct statfs	buf;
+
+	if (0 != statfs(path, &buf))
+		return SUCCEED;
+
+	switch ((unsigned int)buf.f_type)
+	{
+		case ZBX_FS_NFS:
+		case ZBX_FS_SMB:
+		case ZBX_FS_SMB2:
+		case ZBX_FS_CIFS:
+		case ZBX_FS_FUSE:
+		case ZBX_FS_CEPH:
+		case ZBX_FS_AFS:
+		case ZBX_FS_V9FS:
+		case ZBX_FS_GFS2:
+		case ZBX_FS_OCFS2:
+			return SUCCEED;
+		default:
+			return FAIL;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: increments watcher revision and marks all watches as changed      *
+ *                                                                            *
+ ******************************************************************************/
+static void	logwatch_invalidate(void)
+{
+	zbx_hashset_iter_t	iter;
+	zbx_logwatch_entry_t	*entry;
+
+	logwatch.revision++;
+
+	zbx_hashset_iter_reset(&logwatch.entries, &iter);
+
+	while (NULL != (entry = (zbx_logwatch_entry_t *)zbx_hashset_iter_next(&iter)))
+		entry->revision = logwatch.revision;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: updates revisions of watches changed by inotify events            *
+ *                                                                            *
+ * Parameters: buf - [IN] inotify events                                      *
+ *             len - [IN] size of events in buffer                            *
+ *                                                                            *
+ * Return value: SUCCEED - changes were detected                              *
+ *               FAIL    - no changes                                         *
+ *                                                                            *
+ * Comments: Events of files in a watched directory are ignored unless the    *
+ *           file name matches the log file name or regular expression of     *
+ *           an item.                                                         *
+ *                                                                            *
+ ******************************************************************************/
+static int	logwatch_process_events(const char *buf, size_t len)
+{
+	int	ret = FAIL;
+
+	for (const char *ptr = buf; ptr < buf + len;)
+	{
+		const struct inotify_event	*event = (const struct inotify_event *)ptr;
+		zbx_logwatch_entry_t		*entry, entry_local;
+
+		ptr += sizeof(struct inotify_event) + event->len;
+
+		if (0 != (event->mask & IN_Q_OVERFLOW))
+		{
+			zabbix_log(LOG_LEVEL_DEBUG, "log file watcher event queue overflow");
+			logwatch_invalidate();
+			ret = SUCCEED;
+			continue;
+		}
+
+		entry_local.wd = event->wd;
+
+		if (NULL == (entry = (zbx_logwatch_entry_t *)zbx_hashset_search(&logwatch.entries, &entry_local)))
+			continue;
+
+		/* only events of files inside watched directory have names */
+		if (0 != event->len)
+		{
+			if (SUCCEED == logwatch_entry_match(entry, event->name))
+				ret = SUCCEED;
+
+			continue;
+		}
+
+		entry->revision = logwatch.revision;
+		ret = SUCCEED;
+
+		/* after rotation the watch follows the renamed file, force watching the path again */
+		if (0 != (event->mask & (IN_MOVE_SELF | IN_DELETE_SELF)))
+			entry->path[0] = '\0';
+
+		/* watch was removed by kernel because watched object was deleted or its file system */
+		/* was unmounted, metrics referring to it will notice it is gone and check log files */
+		if (0 != (event->mask & IN_IGNORED))
+			zbx_hashset_remove_direct(&logwatch.entries, entry);
+	}
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: reads pending inotify events and updates revisions of changed     *
+ *          watches                                                           *
+ *                                                                            *
+ * Return value: SUCCEED - changes were detected                              *
+ *               FAIL    - no changes                                         *
+ *                                                                            *
+ ******************************************************************************/
+static int	logwatch_read_events(void)
+{
+	union
+	{
+		struct inotify_event	event;
+		char			buf[4096];
+	}
+	data;
+	ssize_t		n;
+	int		ret = FAIL;
+	time_t		now;
+
+	logwatch.revision++;
+
+	while (0 < (n = read(logwatch.fd, data.buf, sizeof(data.buf))))
+	{
+		if (SUCCEED == logwatch_process_events(data.buf, (size_t)n))
+			ret = SUCCEED;
+	}
+
+	if (-1 == n && EAGAIN != errno && EINTR != errno)
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot read log file change events: %s", zbx_strerror(errno));
+		logwatch_invalidate();
+		ret = SUCCEED;
+	}
+
+	if ((now = time(NULL)) >= logwatch.rescan_time || now < logwatch.rescan_time - ZBX_LOGWATCH_RESCAN_PERIOD)
+	{
+		logwatch.rescan_time = now + ZBX_LOGWATCH_RESCAN_PERIOD;
+		logwatch_invalidate();
+		ret = SUCCEED;
+	}
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds path to watched objects                                      *
+ *                                                                            *
+ * Parameters: wd      - [IN] current watch descriptor, 0 if none             *
+ *             path    - [IN] directory or file to watch                      *
+ *             pattern - [IN] log file name or regular expression to filter   *
+ *                            events of directory files, NULL for file watch  *
+ *             regexp  - [IN] 1 - pattern is a regular expression             *
+ *             created - [OUT] set to 1 if a new watch or filter was created  *
+ *                                                                            *
+ * Return value: watch descriptor or 0 if path cannot be watched              *
+ *                                                                            *
+ * Comments: Every returned watch descriptor holds a reference that must be   *
+ *           released with logwatch_remove() using the same pattern.          *
+ *                                                                            *
+ ******************************************************************************/
+static int	logwatch_add(int wd, const char *path, const char *pattern, unsigned char regexp, int *created)
+{
+	zbx_logwatch_entry_t	*entry, entry_local;
+	zbx_logwatch_filter_t	*filter = NULL;
+
+	entry_local.wd = wd;
+
+	if (0 == wd || NULL == (entry = (zbx_logwatch_entry_t *)zbx_hashset_search(&logwatch.entries,
+			&entry_local)) || 0 != strcmp(entry->path, path))
+	{
+		if (SUCCEED == logwatch_is_remote(path))
+		{
+			zabbix_log(LOG_LEVEL_DEBUG, "log file changes in \"%s\" will be detected by polling", path);
+			return 0;
+		}
+
+		if (-1 == (entry_local.wd = inotify_add_watch(logwatch.fd, path, ZBX_LOGWATCH_EVENTS)))
+		{
+			zabbix_log(LOG_LEVEL_DEBUG, "cannot watch \"%s\" for changes: %s", path, zbx_strerror(errno));
+			return 0;
+		}
+
+		if (NULL == (entry = (zbx_logwatch_entry_t *)zbx_hashset_search(&logwatch.entries, &entry_local)))
+		{
+			entry_local.refs = 0;
+			entry_local.path = zbx_strdup(NULL, path);
+			entry_local.revision = 0;
+			zbx_vector_logwatch_filter_ptr_create(&entry_local.filters);
+			entry = (zbx_logwatch_entry_t *)zbx_hashset_insert(&logwatch.entries, &entry_local,
+					sizeof(entry_local));
+
+			*created = 1;
+		}
+	}
+
+	if (NULL != pattern && NULL == (filter = logwatch_filter_get(entry, pattern, regexp)))
+	{
+		zbx_regexp_t	*re = NULL;
+		char		*error = NULL;
+
+		if (0 != regexp && SUCCEED != zbx_regexp_compile(pattern, &re, &error))
+		{
+			zabbix_log(LOG_LEVEL_DEBUG, "cannot watch \"%s\" for changes of \"%s\": %s", path, pattern,
+					error);
+			zbx_free(error);
+
+			if (0 == entry->refs)
+			{
+				inotify_rm_watch(logwatch.fd, entry->wd);
+				zbx_hashset_remove_direct(&logwatch.entries, entry);
+			}
+
+			return 0;
+		}
+
+		filter = (zbx_logwatch_filter_t *)zbx_malloc(NULL, sizeof(zbx_logwatch_filter_t));
+		filter->pattern = zbx_strdup(NULL, pattern);
+		filter->regexp = re;
+		filter->refs = 0;
+		filter->revision = 0;
+		zbx_vector_logwatch_filter_ptr_append(&entry->filters, filter);
+
+		*created = 1;
+	}
+
+	entry->refs++;
+
+	if (NULL != filter)
+		filter->refs++;
+
+	return entry->wd;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: releases watch, removes it when it is not referenced anymore      *
+ *                                                                            *
+ ******************************************************************************/
+static void	logwatch_remove(int wd, const char *pattern, unsigned char regexp)
+{
+	zbx_logwatch_entry_t	*entry, entry_local;
+	zbx_logwatch_filter_t	*filter;
+
+	if (0 == wd)
+		return;
+
+	entry_local.wd = wd;
+
+	if (NULL == (entry = (zbx_logwatch_entry_t *)zbx_hashset_search(&logwatch.entries, &entry_local)))
+		return;
+
+	if (NULL != pattern && NULL != (filter = logwatch_filter_get(entry, pattern, regexp)) && 0 == --filter->refs)
+	{
+		int	i;
+
+		if (FAIL != (i = zbx_vector_logwatch_filter_ptr_search(&entry->filters, filter,
+				ZBX_DEFAULT_PTR_COMPARE_FUNC)))
+		{
+			zbx_vector_logwatch_filter_ptr_remove_noorder(&entry->filters, i);
+		}
+
+		logwatch_filter_free(filter);
+	}
+
+	if (0 != --entry->refs)
+		return;
+
+	inotify_rm_watch(logwatch.fd, wd);
+	zbx_hashset_remove_direct(&logwatch.entries, entry);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if watch has no changes after the specified revision       *
+ *                                                                            *
+ ******************************************************************************/
+static int	logwatch_entry_unchanged(int wd, const char *pattern, unsigned char regexp, zbx_uint64_t revision)
+{
+	zbx_logwatch_entry_t	*entry, entry_local;
+	zbx_logwatch_filter_t	*filter;
+
+	entry_local.wd = wd;
+
+	if (NULL == (entry = (zbx_logwatch_entry_t *)zbx_hashset_search(&logwatch.entries, &entry_local)))
+		return FAIL;
+
+	if (entry->revision > revision)
+		return FAIL;
+
+	if (NULL != pattern && (NULL == (filter = logwatch_filter_get(entry, pattern, regexp)) ||
+			filter->revision > revision))
+	{
+		return FAIL;
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: initializes log file change watcher of the current thread         *
+ *                                                                            *
+ * Return value: SUCCEED - watcher was initialized                            *
+ *               FAIL    - inotify is not available, log files will be        *
+ *                         checked by polling                                 *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_logwatch_init(void)
+{
+	if (-1 == (logwatch.fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC)))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot initialize log file change notifications, log files will be"
+				" polled: %s", zbx_strerror(errno));
+		return FAIL;
+	}
+
+	zbx_hashset_create_ext(&logwatch.entries, 0, logwatch_entry_hash, logwatch_entry_compare,
+			logwatch_entry_clean, ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC,
+			ZBX_DEFAULT_MEM_FREE_FUNC);
+
+	logwatch.revision = 1;
+	logwatch.rescan_time = time(NULL) + ZBX_LOGWATCH_RESCAN_PERIOD;
+
+	return SUCCEED;
+}
+
+void	zbx_logwatch_destroy(void)
+{
+	if (-1 == logwatch.fd)
+		return;
+
+	close(logwatch.fd);
+	logwatch.fd = -1;
+
+	zbx_hashset_destroy(&logwatch.entries);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: waits for log file changes                                        *
+ *                                                                            *
+ * Parameters: timeout - [IN] maximum time to wait, seconds                   *
+ *                                                                            *
+ * Return value: SUCCEED - changes were detected                              *
+ *               FAIL    - timeout, no changes                                *
+ *                                                                            *
+ * Comments: Without watcher simply sleeps for the specified time. Should     *
+ *           also be called with zero timeout before checking log items to    *
+ *           process the changes that happened since the last call.           *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_logwatch_wait(int timeout)
+{
+	struct pollfd	pfd;
+
+	if (-1 == logwatch.fd)
+	{
+		if (0 < timeout)
+			zbx_sleep(timeout);
+
+		return FAIL;
+	}
+
+	pfd.fd = logwatch.fd;
+	pfd.events = POLLIN;
+
+	if (0 >= poll(&pfd, 1, timeout * 1000) && 0 != timeout)
+	{
+		/* on timeout still check if periodic full check is due */
+		if (time(NULL) < logwatch.rescan_time)
+			return FAIL;
+	}
+
+	return logwatch_read_events();
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if log files of an item have not changed since the last    *
+ *          complete check                                                    *
+ *                                                                            *
+ * Return value: SUCCEED - no changes, log files do not have to be checked    *
+ *               FAIL    - log files changed or are not watched               *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_logwatch_unchanged(const zbx_log_watch_t *watch)
+{
+	if (-1 == logwatch.fd || 0 == watch->revision || 0 == watch->dir_wd)
+		return FAIL;
+
+	if (SUCCEED != logwatch_entry_unchanged(watch->dir_wd, watch->filter, watch->filter_regexp, watch->revision))
+		return FAIL;
+
+	if (0 != watch->file_wd && SUCCEED != logwatch_entry_unchanged(watch->file_wd, NULL, 0, watch->revision))
+		return FAIL;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: starts watching log files of an item after a complete check       *
+ *                                                                            *
+ * Parameters: watch     - [IN/OUT] item watch state                          *
+ *             directory - [IN] log file directory                            *
+ *             pattern   - [IN] log file name or regular expression of log    *
+ *                              file names in the directory                   *
+ *             regexp    - [IN] 1 - pattern is a regular expression           *
+ *             filename  - [IN] the most recent log file, can be NULL         *
+ *                                                                            *
+ * Comments: The most recent file is watched separately to detect writes to   *
+ *           it through symbolic links located in the watched directory.      *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_logwatch_update(zbx_log_watch_t *watch, const char *directory, const char *pattern,
+		unsigned char regexp, const char *filename)
+{
+	int	dir_wd, file_wd = 0, created = 0;
+
+	if (-1 == logwatch.fd)
+		return;
+
+	if (0 != (dir_wd = logwatch_add(watch->dir_wd, directory, pattern, regexp, &created)) && NULL != filename &&
+			0 == (file_wd = logwatch_add(watch->file_wd, filename, NULL, 0, &created)))
+	{
+		logwatch_remove(dir_wd, pattern, regexp);
+		dir_wd = 0;
+	}
+
+	/* release previous watches after the new ones are referenced to keep the unchanged ones */
+	logwatch_remove(watch->dir_wd, watch->filter, watch->filter_regexp);
+	logwatch_remove(watch->file_wd, NULL, 0);
+
+	watch->dir_wd = dir_wd;
+	watch->file_wd = file_wd;
+
+	zbx_free(watch->filter);
+
+	if (0 != dir_wd)
+	{
+		watch->filter = zbx_strdup(NULL, pattern);
+		watch->filter_regexp = regexp;
+	}
+
+	/* changes made before the watch was created could have been missed, check once more */
+	if (0 == dir_wd || 0 != created)
+		watch->revision = 0;
+	else
+		watch->revision = logwatch.revision;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: requires a complete check of item log files                       *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_logwatch_reset(zbx_log_watch_t *watch)
+{
+	watch->revision = 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: stops watching log files of an item                               *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_logwatch_release(zbx_log_watch_t *watch)
+{
+	if (-1 != logwatch.fd)
+	{
+		logwatch_remove(watch->dir_wd, watch->filter, watch->filter_regexp);
+		logwatch_remove(watch->file_wd, NULL, 0);
+	}
+
+	zbx_free(watch->filter);
+	memset(watch, 0, sizeof(zbx_log_watch_t));
+}
+#else
+int	zbx_logwatch_init(void)
+{
+	return FAIL;
+}
+
+void	zbx_logwatch_destroy(void)
+{
+}
+
+int	zbx_logwatch_wait(int timeout)
+{
+	if (0 < timeout)
+		zbx_sleep(timeout);
+
+	return FAIL;
+}
+
+int	zbx_logwatch_unchanged(const zbx_log_watch_t *watch)
+{
+	ZBX_UNUSED(watch);
+
+	return FAIL;
+}
+
+void	zbx_logwatch_update(zbx_log_watch_t *watch, const char *directory, const char *pattern,
+		unsigned char regexp, const char *filename)
+{
+	ZBX_UNUSED(watch);
+	ZBX_UNUSED(directory);
+	ZBX_UNUSED(pattern);
+	ZBX_UNUSED(regexp);
+	ZBX_UNUSED(filename);
+}
+
+void	zbx_logwatch_reset(zbx_log_watch_t *watch)
+{
+	ZBX_UNUSED(watch);
+}
+
+void	zbx_logwatch_release(zbx_log_watch_t *watch)
+{
+	memset(watch, 0, sizeof(zbx_log_watch_t));
+}
+#endif
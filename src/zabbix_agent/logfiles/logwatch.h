@@ -0,0 +1,28 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#ifndef ZABBIX_LOGWATCH_H
+#define ZABBIX_LOGWATCH_H
+
+#include "../metrics/metrics.h"
+
+int	zbx_logwatch_init(void);
+void	zbx_logwatch_destroy(void);
+int	zbx_logwatch_wait(int timeout);
+int	zbx_logwatch_unchanged(const zbx_log_watch_t *watch);
+void	zbx_logwatch_update(zbx_log_watch_t *watch, const char *directory, const char *pattern,
+		unsigned char regexp, const char *filename);
+void	zbx_logwatch_reset(zbx_log_watch_t *watch);
+void	zbx_logwatch_release(zbx_log_watch_t *watch);
+#endif
@@ -33,6 +33,20 @@
 #define ZBX_METRIC_FLAG_LOG			/* item for log file monitoring, one of the above */	\
 		(ZBX_METRIC_FLAG_LOG_LOG | ZBX_METRIC_FLAG_LOG_LOGRT | ZBX_METRIC_FLAG_LOG_EVENTLOG)
 
+/* state of log file change notifications for log[], log.count[], logrt[], logrt.count[] items */
+typedef struct
+{
+	int		dir_wd;		/* watch descriptor of log file directory, 0 - not watched */
+	int		file_wd;	/* watch descriptor of the most recent log file, 0 - not watched */
+	char		*filter;	/* log file name or regular expression, changes of other files in the */
+					/* watched directory are ignored */
+	unsigned char	filter_regexp;	/* 1 - filter is a regular expression */
+	zbx_uint64_t	revision;	/* watcher revision at the last complete check, 0 - full check required */
+	int		lastcheck;	/* time of the last check */
+	unsigned char	woken;		/* 1 - check was started before schedule because log files changed */
+}
+zbx_log_watch_t;
+
 typedef struct
 {
 	zbx_uint64_t		itemid;
@@ -57,6 +71,7 @@ typedef struct
 	zbx_uint64_t		processed_bytes;	/* number of processed bytes for log[], log.count[], logrt[], */
 							/* logrt.count[] items */
 	char			*persistent_file_name;	/* not used on Microsoft Windows */
+	zbx_log_watch_t		watch;			/* not used on Microsoft Windows */
 
 	int			timeout;
 }
@@ -28,6 +28,7 @@
 #include "zbxmutexs.h"
 #include "zbxbincommon.h"
 #include "zbxtime.h"
+#include "zbxcompress.h"
 
 static char	*config_pid_file = NULL;
 
@@ -43,6 +44,8 @@ ZBX_GET_CONFIG_VAR(int, zbx_config_enable_remote_commands, 1)
 ZBX_GET_CONFIG_VAR(int, zbx_config_log_remote_commands, 0)
 ZBX_GET_CONFIG_VAR(int, zbx_config_unsafe_user_parameters, 0)
 static int	zbx_config_listen_port = ZBX_DEFAULT_AGENT_PORT;
+static int	config_listener_workers = 0;
+static int	config_process_snapshot_interval = 0;
 static char	*zbx_config_listen_ip = NULL;
 static int	zbx_config_refresh_active_checks = 5;
 ZBX_GET_CONFIG_VAR2(char*, const char *, zbx_config_source_ip, NULL)
@@ -84,6 +87,7 @@ static char	*config_user = NULL;
 static zbx_config_tls_t	*zbx_config_tls = NULL;
 
 static int	config_tcp_max_backlog_size	= SOMAXCONN;
+static int	config_compression_level	= 0;
 
 int	zbx_config_heartbeat_frequency	= 60;
 
@@ -777,6 +781,9 @@ static void	zbx_validate_config(ZBX_TASK_EX *task)
 	if (SUCCEED != zbx_validate_log_parameters(task, &log_file_cfg))
 		err = 1;
 
+#if !defined(HAVE_ZLIB)
+	err |= (FAIL == zbx_check_cfg_feature_int("CompressionLevel", config_compression_level, "zlib support"));
+#endif
 #if !(defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL))
 	err |= (FAIL == zbx_check_cfg_feature_str("TLSConnect", zbx_config_tls->connect, "TLS support"));
 	err |= (FAIL == zbx_check_cfg_feature_str("TLSAccept", zbx_config_tls->accept, "TLS support"));
@@ -854,6 +861,7 @@ static int	add_serveractive_host_agent_cb(const zbx_vector_addr_ptr_t *addrs, zb
 				zbx_config_eventlog_max_lines_per_second;
 		config_active_args[forks].config_max_lines_per_second = zbx_config_max_lines_per_second;
 		config_active_args[forks].config_refresh_active_checks = zbx_config_refresh_active_checks;
+		config_active_args[forks].config_compression_level = config_compression_level;
 	}
 
 	return SUCCEED;
@@ -960,6 +968,8 @@ static void	zbx_load_config(int requirement, ZBX_TASK_EX *task)
 				ZBX_CONF_PARM_OPT,	2,			65535},
 		{"BufferSend",			&zbx_config_buffer_send,		ZBX_CFG_TYPE_INT,
 				ZBX_CONF_PARM_OPT,	1,			SEC_PER_HOUR},
+		{"CompressionLevel",		&config_compression_level,		ZBX_CFG_TYPE_INT,
+				ZBX_CONF_PARM_OPT,	0,			ZBX_COMPRESS_LEVEL_MAX},
 #ifndef _WINDOWS
 		{"PidFile",			&config_pid_file,			ZBX_CFG_TYPE_STRING,
 				ZBX_CONF_PARM_OPT,	0,			0},
@@ -1008,6 +1018,10 @@ static void	zbx_load_config(int requirement, ZBX_TASK_EX *task)
 				ZBX_CONF_PARM_OPT,	0,			1},
 		{"User",			&config_user,				ZBX_CFG_TYPE_STRING,
 				ZBX_CONF_PARM_OPT,	0,			0},
+		{"StartListenerWorkers",	&config_listener_workers,		ZBX_CFG_TYPE_INT,
+				ZBX_CONF_PARM_OPT,	0,			100},
+		{"ProcessSnapshotInterval",	&config_process_snapshot_interval,	ZBX_CFG_TYPE_INT,
+				ZBX_CONF_PARM_OPT,	0,			SEC_PER_HOUR},
 #endif
 #ifdef _WINDOWS
 		{"PerfCounter",			&config_perf_counters,			ZBX_CFG_TYPE_MULTISTRING,
@@ -1077,6 +1091,9 @@ static void	zbx_load_config(int requirement, ZBX_TASK_EX *task)
 
 	set_defaults();
 
+	if (0 != config_compression_level)
+		zbx_compress_set_level(config_compression_level);
+
 	log_file_cfg.log_type = zbx_get_log_type(log_file_cfg.log_type_str);
 
 	zbx_vector_str_create(&hostnames);
@@ -1359,7 +1376,7 @@ int	MAIN_ZABBIX_ENTRY(int flags)
 		exit(EXIT_FAILURE);
 	}
 
-	if (SUCCEED != zbx_init_collector_data(&error))
+	if (SUCCEED != zbx_init_collector_data(config_process_snapshot_interval, &error))
 	{
 		zabbix_log(LOG_LEVEL_CRIT, "cannot initialize collector: %s", error);
 		zbx_free(error);
@@ -1406,7 +1423,7 @@ int	MAIN_ZABBIX_ENTRY(int flags)
 		zbx_thread_info_t		*thread_info;
 		zbx_thread_listener_args	listener_args = {&listen_sock, zbx_config_tls, get_zbx_program_type,
 								config_file, zbx_config_timeout,
-								zbx_config_hosts_allowed};
+								zbx_config_hosts_allowed, config_listener_workers};
 
 		thread_args = (zbx_thread_args_t *)zbx_malloc(NULL, sizeof(zbx_thread_args_t));
 		thread_info = &thread_args->info;
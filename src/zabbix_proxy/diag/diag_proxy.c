@@ -99,6 +99,8 @@ int	diag_add_section_info_proxy(const char *section, const struct zbx_json_parse
 		ret = diag_add_proxybuffer_info(jp, json, error);
 	else if (0 == strcmp(section, ZBX_DIAG_PREPROCESSING))
 		ret = zbx_diag_add_preproc_info(jp, json, error);
+	else if (0 == strcmp(section, ZBX_DIAG_CONFIGCACHE))
+		ret = zbx_diag_add_configcache_info(jp, json, error);
 	else if (0 == strcmp(section, ZBX_DIAG_LOCKS))
 	{
 		zbx_diag_add_locks_info(json);
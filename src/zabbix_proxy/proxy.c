@@ -73,6 +73,7 @@
 #include "zbxstr.h"
 #include "zbxtime.h"
 #include "zbxbincommon.h"
+#include "zbxcompress.h"
 
 #ifdef HAVE_OPENIPMI
 #include "zbxipmi.h"
@@ -110,8 +111,9 @@ static const char	*help_message[] = {
 	"                                   target is not specified",
 	"      " ZBX_SNMP_CACHE_RELOAD "          Reload SNMP cache",
 	"      " ZBX_DIAGINFO "=section           Log internal diagnostic information of the",
-	"                                 section (historycache, preprocessing, locks) or",
-	"                                 everything if section is not specified",
+	"                                 section (historycache, preprocessing, locks,",
+	"                                 configcache) or everything if section is not",
+	"                                 specified",
 	"      " ZBX_HISTORY_CACHE_CLEAR "=target Clear history cache for item specified by its ID",
 	"      " ZBX_PROF_ENABLE "=target         Enable profiling, affects all processes if",
 	"                                   target is not specified",
@@ -297,6 +299,8 @@ static int	config_server_port;
 static char	*config_hostname		= NULL;
 static char	*config_hostname_item		= NULL;
 static char	*zbx_config_snmptrap_file	= NULL;
+static int	zbx_config_snmptrap_listen_port	= 0;
+static char	*zbx_config_snmptrap_listen_community = NULL;
 static char	*config_java_gateway		= NULL;
 static int	config_java_gateway_port	= ZBX_DEFAULT_GATEWAY_PORT;
 static char	*config_ssh_key_location	= NULL;
@@ -320,6 +324,7 @@ static char	*config_socket_path	= NULL;
 static int	config_history_storage_pipelines	= 0;
 static char	*config_stats_allowed_ip	= NULL;
 static int	config_tcp_max_backlog_size	= SOMAXCONN;
+static int	config_compression_level	= ZBX_COMPRESS_LEVEL_DEFAULT;
 static char	*config_file		= NULL;
 static int	config_allow_root	= 0;
 
@@ -893,6 +898,10 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 				ZBX_CONF_PARM_OPT,	1024,			32767},
 		{"SNMPTrapperFile",		&zbx_config_snmptrap_file,		ZBX_CFG_TYPE_STRING,
 				ZBX_CONF_PARM_OPT,	0,			0},
+		{"SNMPTrapperListenPort",	&zbx_config_snmptrap_listen_port,	ZBX_CFG_TYPE_INT,
+				ZBX_CONF_PARM_OPT,	0,			65535},
+		{"SNMPTrapperListenCommunity",	&zbx_config_snmptrap_listen_community,	ZBX_CFG_TYPE_STRING_LIST,
+				ZBX_CONF_PARM_OPT,	0,			0},
 		{"StartSNMPTrapper",		&config_forks[ZBX_PROCESS_TYPE_SNMPTRAPPER],
 											ZBX_CFG_TYPE_INT,
 				ZBX_CONF_PARM_OPT,	0,			1},
@@ -1003,6 +1012,8 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 				ZBX_CONF_PARM_OPT,	0,			0},
 		{"LogSlowQueries",		&(zbx_db_config->log_slow_queries),	ZBX_CFG_TYPE_INT,
 				ZBX_CONF_PARM_OPT,	0,			3600000},
+		{"DBBulkLoad",			&(zbx_db_config->bulk_load),		ZBX_CFG_TYPE_INT,
+				ZBX_CONF_PARM_OPT,	0,			1},
 		{"LoadModulePath",		&config_load_module_path,		ZBX_CFG_TYPE_STRING,
 				ZBX_CONF_PARM_OPT,	0,			0},
 		{"LoadModule",			&config_load_module,			ZBX_CFG_TYPE_MULTISTRING,
@@ -1074,6 +1085,8 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 				ZBX_CONF_PARM_OPT,	1,			1000},
 		{"ListenBacklog",		&config_tcp_max_backlog_size,		ZBX_CFG_TYPE_INT,
 				ZBX_CONF_PARM_OPT,	0,			INT_MAX},
+		{"CompressionLevel",		&config_compression_level,		ZBX_CFG_TYPE_INT,
+				ZBX_CONF_PARM_OPT,	ZBX_COMPRESS_LEVEL_MIN,	ZBX_COMPRESS_LEVEL_MAX},
 		{"StartODBCPollers",		&config_forks[ZBX_PROCESS_TYPE_ODBCPOLLER],
 											ZBX_CFG_TYPE_INT,
 				ZBX_CONF_PARM_OPT,	0,			1000},
@@ -1110,6 +1123,7 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 			ZBX_CFG_ENVVAR_USE);
 
 	zbx_set_defaults();
+	zbx_compress_set_level(config_compression_level);
 
 	log_file_cfg.log_type = zbx_get_log_type(log_file_cfg.log_type_str);
 
@@ -1547,7 +1561,8 @@ int	MAIN_ZABBIX_ENTRY(int flags)
 			.config_source_ip = zbx_config_source_ip,
 			.config_ssl_ca_location = config_ssl_ca_location,
 			.config_ssl_cert_location = config_ssl_cert_location,
-			.config_ssl_key_location = config_ssl_key_location
+			.config_ssl_key_location = config_ssl_key_location,
+			.config_max_concurrent_checks_per_poller = config_max_concurrent_checks_per_poller
 		};
 
 	zbx_thread_discoverer_args		discoverer_args =
@@ -1637,6 +1652,9 @@ int	MAIN_ZABBIX_ENTRY(int flags)
 	zbx_thread_snmptrapper_args		snmptrapper_args =
 		{
 			.config_snmptrap_file = zbx_config_snmptrap_file,
+			.config_snmptrap_listen_port = zbx_config_snmptrap_listen_port,
+			.config_snmptrap_listen_community = zbx_config_snmptrap_listen_community,
+			.progname = zbx_progname,
 			.config_ha_node_name = NULL
 		};
 
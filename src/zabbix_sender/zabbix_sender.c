@@ -27,6 +27,7 @@
 #include "zbxalgo.h"
 #include "zbxcomms.h"
 #include "zbxbincommon.h"
+#include "zbxcompress.h"
 
 #if !defined(_WINDOWS)
 #	include "zbxnix.h"
@@ -143,6 +144,8 @@ static int	config_timeout = 3;
 
 static int	CONFIG_SENDER_TIMEOUT = GET_SENDER_TIMEOUT;
 
+static int	config_compression_level = 0;
+
 #define CONFIG_SENDER_TIMEOUT_MIN	1
 #define CONFIG_SENDER_TIMEOUT_MAX	300
 #define CONFIG_SENDER_TIMEOUT_MIN_STR	ZBX_STR(CONFIG_SENDER_TIMEOUT_MIN)
@@ -640,6 +643,7 @@ static	ZBX_THREAD_ENTRY(send_value, args)
 
 	ret = zbx_comms_exchange_with_redirect(config_source_ip, sendval_args->addrs, CONFIG_SENDER_TIMEOUT,
 			config_timeout, 0, LOG_LEVEL_DEBUG, sendval_args->zbx_config_tls, sendval_args->json->buffer,
+			0 != config_compression_level ? ZBX_TCP_PROTOCOL | ZBX_TCP_COMPRESS : ZBX_TCP_PROTOCOL,
 			connect_callback, sendval_args->json, &data, NULL);
 
 
@@ -842,6 +846,8 @@ static void	zbx_load_config(const char *config_file_in)
 				ZBX_CONF_PARM_OPT,	0,			0},
 		{"ListenBacklog",		&CONFIG_TCP_MAX_BACKLOG_SIZE,		ZBX_CFG_TYPE_INT,
 				ZBX_CONF_PARM_OPT,	0,			INT_MAX},
+		{"CompressionLevel",		&config_compression_level,		ZBX_CFG_TYPE_INT,
+				ZBX_CONF_PARM_OPT,	0,			ZBX_COMPRESS_LEVEL_MAX},
 		{0}
 	};
 
@@ -849,6 +855,13 @@ static void	zbx_load_config(const char *config_file_in)
 	zbx_parse_cfg_file(config_file_in, cfg, ZBX_CFG_FILE_REQUIRED, ZBX_CFG_NOT_STRICT, ZBX_CFG_EXIT_FAILURE,
 			ZBX_CFG_ENVVAR_USE);
 
+#if !defined(HAVE_ZLIB)
+	if (FAIL == zbx_check_cfg_feature_int("CompressionLevel", config_compression_level, "zlib support"))
+		exit(EXIT_FAILURE);
+#endif
+	if (0 != config_compression_level)
+		zbx_compress_set_level(config_compression_level);
+
 	/* get first hostname only */
 	if (NULL != cfg_hostname)
 	{
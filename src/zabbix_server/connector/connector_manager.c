@@ -34,14 +34,29 @@
 #define ZBX_CONNECTOR_RESCHEDULE_FALSE	0
 #define ZBX_CONNECTOR_RESCHEDULE_TRUE	1
 
-/* connector worker data */
+/* the maximum number of requests sent by a worker at once */
+#define ZBX_CONNECTOR_WORKER_TASKS_MAX	16
+
+/* task sent to connector worker */
 typedef struct
 {
-	zbx_ipc_client_t	*client;	/* the connected worker client */
-	zbx_uint64_t		taskid;		/* the current task id (connectorid) */
+	zbx_uint64_t		taskid;		/* the task sequence number within worker */
+	zbx_uint64_t		connectorid;
 	zbx_vector_uint64_t	ids;
 	int			reschedule;
 }
+zbx_connector_task_t;
+
+ZBX_PTR_VECTOR_DECL(connector_task_ptr, zbx_connector_task_t *)
+ZBX_PTR_VECTOR_IMPL(connector_task_ptr, zbx_connector_task_t *)
+
+/* connector worker data */
+typedef struct
+{
+	zbx_ipc_client_t		*client;	/* the connected worker client */
+	zbx_uint64_t			tasks_num;	/* the number of tasks sent to worker */
+	zbx_vector_connector_task_ptr_t	tasks;		/* the tasks being processed by worker */
+}
 zbx_connector_worker_t;
 
 /* connector manager data */
@@ -89,6 +104,12 @@ static void	connector_clear(zbx_connector_t *connector)
 	zbx_hashset_destroy(&connector->data_point_links);
 }
 
+static void	connector_task_free(zbx_connector_task_t *task)
+{
+	zbx_vector_uint64_destroy(&task->ids);
+	zbx_free(task);
+}
+
 static void	data_point_link_clean(zbx_data_point_link_t *data_point_link)
 {
 	zbx_vector_connector_data_point_clear_ext(&data_point_link->connector_data_points,
@@ -129,7 +150,10 @@ static void	connector_destroy_manager(zbx_connector_manager_t *manager)
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() workers: %d", __func__, manager->worker_count);
 
 	for (i = 0; i < manager->worker_count; i++)
-		zbx_vector_uint64_destroy(&manager->workers[i].ids);
+	{
+		zbx_vector_connector_task_ptr_clear_ext(&manager->workers[i].tasks, connector_task_free);
+		zbx_vector_connector_task_ptr_destroy(&manager->workers[i].tasks);
+	}
 
 	zbx_free(manager->workers);
 	zbx_hashset_destroy(&manager->connectors);
@@ -173,7 +197,7 @@ static void	connector_register_worker(zbx_connector_manager_t *manager, zbx_ipc_
 
 		worker = (zbx_connector_worker_t *)&manager->workers[manager->worker_count++];
 		worker->client = client;
-		zbx_vector_uint64_create(&worker->ids);
+		zbx_vector_connector_task_ptr_create(&worker->tasks);
 	}
 
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
@@ -181,27 +205,37 @@ static void	connector_register_worker(zbx_connector_manager_t *manager, zbx_ipc_
 
 /******************************************************************************
  *                                                                            *
- * Purpose: get worker without active task                                    *
+ * Purpose: get the least loaded worker that can accept more tasks            *
  *                                                                            *
  * Parameters: manager - [IN] connector manager                               *
  *                                                                            *
- * Return value: pointer to the worker data or NULL if none                   *
+ * Return value: pointer to the worker data or NULL if all workers are at     *
+ *               full capacity                                                *
  *                                                                            *
  ******************************************************************************/
 static zbx_connector_worker_t	*connector_get_free_worker(zbx_connector_manager_t *manager)
 {
-	int	i;
+	zbx_connector_worker_t	*worker = NULL;
+	int			i;
 
 	for (i = 0; i < manager->worker_count; i++)
 	{
-		if (0 == manager->workers[i].ids.values_num)
-			return &manager->workers[i];
+		if (ZBX_CONNECTOR_WORKER_TASKS_MAX <= manager->workers[i].tasks.values_num)
+			continue;
+
+		if (NULL == worker || manager->workers[i].tasks.values_num < worker->tasks.values_num)
+		{
+			worker = &manager->workers[i];
+
+			if (0 == worker->tasks.values_num)
+				break;
+		}
 	}
 
-	return NULL;
+	return worker;
 }
 
-static void	connector_get_next_task(zbx_connector_t *connector, zbx_connector_worker_t *worker,
+static void	connector_get_next_task(zbx_connector_t *connector, zbx_connector_task_t *task,
 		unsigned char **data, size_t *data_alloc, size_t *data_offset, int *reschedule, int *processed_num)
 {
 #define ZBX_DATA_JSON_RESERVED		(ZBX_HISTORY_TEXT_VALUE_LEN * 4 + ZBX_KIBIBYTE * 4)
@@ -259,23 +293,21 @@ static void	connector_get_next_task(zbx_connector_t *connector, zbx_connector_wo
 					zbx_connector_data_point_free);
 		}
 
-		zbx_vector_uint64_append(&worker->ids, data_point_link->objectid);
+		zbx_vector_uint64_append(&task->ids, data_point_link->objectid);
 	}
 
 	*processed_num += records;
 
-	if (0 != worker->ids.values_num)
-	{
-		worker->reschedule = *reschedule;
-		worker->taskid = connector->connectorid;
-	}
+	task->reschedule = *reschedule;
+	task->connectorid = connector->connectorid;
 
 #undef ZBX_DATA_JSON_RESERVED
 #undef ZBX_DATA_JSON_RECORD_LIMIT
 }
 /******************************************************************************
  *                                                                            *
- * Purpose: assign available queued connector tasks to free workers           *
+ * Purpose: assign available queued connector tasks to workers with free      *
+ *          capacity                                                          *
  *                                                                            *
  * Parameters: manager       - [IN] connector manager                         *
  *             now           - [IN] current time                              *
@@ -310,14 +342,22 @@ static void	connector_assign_tasks(zbx_connector_manager_t *manager, int now, in
 
 		while (connector->senders < connector->max_senders)
 		{
+			zbx_connector_task_t	*task;
+			int			reschedule;
+
 			data_offset = 0;
-			int	reschedule;
 
-			connector_get_next_task(connector, worker, &data, &data_alloc, &data_offset, &reschedule,
+			task = (zbx_connector_task_t *)zbx_malloc(NULL, sizeof(zbx_connector_task_t));
+			zbx_vector_uint64_create(&task->ids);
+
+			connector_get_next_task(connector, task, &data, &data_alloc, &data_offset, &reschedule,
 					processed_num);
 
 			if (0 == data_offset)
+			{
+				connector_task_free(task);
 				break;
+			}
 
 			if (FAIL == zbx_ipc_client_send(worker->client, ZBX_IPC_CONNECTOR_REQUEST, data,
 					(zbx_uint32_t)data_offset))
@@ -326,6 +366,10 @@ static void	connector_assign_tasks(zbx_connector_manager_t *manager, int now, in
 				exit(EXIT_FAILURE);
 			}
 
+			/* worker numbers received requests in the same order */
+			task->taskid = ++worker->tasks_num;
+			zbx_vector_connector_task_ptr_append(&worker->tasks, task);
+
 			connector->senders++;
 
 			if (NULL == (worker = connector_get_free_worker(manager)))
@@ -419,24 +463,45 @@ static zbx_connector_worker_t	*connector_get_worker_by_client(zbx_connector_mana
 	return worker;
 }
 
-static void	connector_add_result(zbx_connector_manager_t *manager, zbx_ipc_client_t *client, int now)
+static void	connector_add_result(zbx_connector_manager_t *manager, zbx_ipc_client_t *client,
+		const zbx_ipc_message_t *message, int now)
 {
 	zbx_connector_worker_t	*worker;
+	zbx_connector_task_t	*task = NULL;
 	zbx_connector_t		*connector;
+	zbx_uint64_t		taskid;
 	int			i;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
 	worker = connector_get_worker_by_client(manager, client);
 
-	if (NULL != (connector = (zbx_connector_t *)zbx_hashset_search(&manager->connectors, &worker->taskid)))
+	memcpy(&taskid, message->data, sizeof(taskid));
+
+	for (i = 0; i < worker->tasks.values_num; i++)
+	{
+		if (taskid == worker->tasks.values[i]->taskid)
+		{
+			task = worker->tasks.values[i];
+			zbx_vector_connector_task_ptr_remove_noorder(&worker->tasks, i);
+			break;
+		}
+	}
+
+	if (NULL == task)
 	{
-		for (i = 0; i < worker->ids.values_num; i++)
+		THIS_SHOULD_NEVER_HAPPEN;
+		goto out;
+	}
+
+	if (NULL != (connector = (zbx_connector_t *)zbx_hashset_search(&manager->connectors, &task->connectorid)))
+	{
+		for (i = 0; i < task->ids.values_num; i++)
 		{
 			zbx_data_point_link_t	*data_point_link;
 
 			if (NULL == (data_point_link = (zbx_data_point_link_t *)zbx_hashset_search(
-					&connector->data_point_links, &worker->ids.values[i])))
+					&connector->data_point_links, &task->ids.values[i])))
 			{
 				continue;
 			}
@@ -454,11 +519,13 @@ static void	connector_add_result(zbx_connector_manager_t *manager, zbx_ipc_clien
 
 		connector->senders--;
 
-		if (ZBX_CONNECTOR_RESCHEDULE_TRUE == worker->reschedule)
+		if (ZBX_CONNECTOR_RESCHEDULE_TRUE == task->reschedule)
 			connector->time_flush = now;
 	}
 
-	zbx_vector_uint64_clear(&worker->ids);
+	connector_task_free(task);
+out:
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
 
 static	void	connector_get_items_totals(zbx_connector_manager_t *manager, zbx_uint64_t *queued)
@@ -696,7 +763,7 @@ ZBX_THREAD_ENTRY(connector_manager_thread, args)
 					connector_register_worker(&manager, client, message);
 					break;
 				case ZBX_IPC_CONNECTOR_RESULT:
-					connector_add_result(&manager, client, (int)time_now);
+					connector_add_result(&manager, client, message, (int)time_now);
 					break;
 				case ZBX_IPC_CONNECTOR_DIAG_STATS:
 					connector_get_diag_stats(&manager, client);
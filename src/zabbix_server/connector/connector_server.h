@@ -23,6 +23,7 @@ typedef struct
 	const char	*config_ssl_ca_location;
 	const char	*config_ssl_cert_location;
 	const char	*config_ssl_key_location;
+	int		config_connector_compression;
 }
 zbx_thread_connector_worker_args;
 
@@ -17,6 +17,8 @@
 #ifdef HAVE_LIBCURL
 #	include "zbxhttp.h"
 #	include "zbxnum.h"
+#	include "zbxcompress.h"
+#	include "zbxasynchttppoller.h"
 #endif
 
 #include "zbxtimekeeper.h"
@@ -31,178 +33,548 @@
 #include "zbxjson.h"
 #include "zbxstr.h"
 
+#include <event2/event.h>
+
+/* connector request being sent by worker */
+typedef struct
+{
+	/* the request sequence number, returned to manager with result */
+	zbx_uint64_t				taskid;
+	zbx_connector_t				connector;
+	zbx_vector_connector_data_point_t	data_points;
+#ifdef HAVE_LIBCURL
+	zbx_http_context_t			context;
+	int					attempt_interval_sec;
+	struct event				*retry_timer;
+
+	/* gzip compressed request body, NULL if body is streamed from data points */
+	char					*body;
+	size_t					body_size;
+
+	/* streamed request body read position */
+	int					point_index;
+	size_t					point_offset;
+#endif
+}
+zbx_connector_request_t;
+
+ZBX_PTR_VECTOR_DECL(connector_request_ptr, zbx_connector_request_t *)
+ZBX_PTR_VECTOR_IMPL(connector_request_ptr, zbx_connector_request_t *)
+
+/* connector worker data */
+typedef struct
+{
+	zbx_ipc_async_socket_t			socket;
+	struct event_base			*base;
+	zbx_vector_connector_request_ptr_t	requests;
+
+	/* the number of received requests, used as request sequence number */
+	zbx_uint64_t				requests_num;
+
+	const zbx_thread_info_t			*info;
+	unsigned char				state;
+
+	const char				*config_source_ip;
+	const char				*config_ssl_ca_location;
+	const char				*config_ssl_cert_location;
+	const char				*config_ssl_key_location;
+	int					config_connector_compression;
+#ifdef HAVE_LIBCURL
+	zbx_asynchttppoller_config		*asynchttppoller_config;
+#endif
+}
+zbx_connector_worker_data_t;
+
 static int	connector_object_compare_func(const void *d1, const void *d2)
 {
 	return zbx_timespec_compare(&((const zbx_connector_data_point_t *)d1)->ts,
 			&((const zbx_connector_data_point_t *)d2)->ts);
 }
 
-static void	worker_process_request(zbx_ipc_socket_t *socket, const char *config_source_ip,
-		const char *config_ssl_ca_location, const char *config_ssl_cert_location,
-		const char *config_ssl_key_location, zbx_ipc_message_t *message,
-		zbx_vector_connector_data_point_t *connector_data_points, zbx_uint64_t *processed_num)
+static void	connector_request_free(zbx_connector_request_t *request)
 {
-	zbx_connector_t	connector;
-	char		*str = NULL, *out = NULL, *error = NULL;
-	size_t		str_alloc = 0, str_offset = 0;
+#ifdef HAVE_LIBCURL
+	if (NULL != request->retry_timer)
+		event_free(request->retry_timer);
 
-	zbx_connector_deserialize_connector_and_data_point(message->data, message->size, &connector,
-			connector_data_points);
+	zbx_http_context_destroy(&request->context);
+	zbx_free(request->body);
+#endif
+	zbx_vector_connector_data_point_clear_ext(&request->data_points, zbx_connector_data_point_free);
+	zbx_vector_connector_data_point_destroy(&request->data_points);
+
+	zbx_free(request->connector.url);
+	zbx_free(request->connector.timeout);
+	zbx_free(request->connector.token);
+	zbx_free(request->connector.http_proxy);
+	zbx_free(request->connector.username);
+	zbx_free(request->connector.password);
+	zbx_free(request->connector.ssl_cert_file);
+	zbx_free(request->connector.ssl_key_file);
+	zbx_free(request->connector.ssl_key_password);
+	zbx_free(request->connector.attempt_interval);
+
+	zbx_free(request);
+}
 
-	zbx_vector_connector_data_point_sort(connector_data_points, connector_object_compare_func);
-	for (int i = 0; i < connector_data_points->values_num; i++)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: notifies connector manager that request is finished and frees it  *
+ *                                                                            *
+ ******************************************************************************/
+static void	worker_finish_request(zbx_connector_worker_data_t *worker, zbx_connector_request_t *request)
+{
+	int	i;
+
+	if (FAIL == zbx_ipc_async_socket_send(&worker->socket, ZBX_IPC_CONNECTOR_RESULT,
+			(const unsigned char *)&request->taskid, sizeof(request->taskid)) ||
+			FAIL == zbx_ipc_async_socket_flush(&worker->socket, SEC_PER_MIN))
 	{
-		zbx_strcpy_alloc(&str, &str_alloc, &str_offset, connector_data_points->values[i].str);
-		zbx_chrcpy_alloc(&str, &str_alloc, &str_offset, '\n');
+		zabbix_log(LOG_LEVEL_CRIT, "cannot send connector result");
+		exit(EXIT_FAILURE);
 	}
 
-	*processed_num += (zbx_uint64_t)connector_data_points->values_num;
+	if (FAIL != (i = zbx_vector_connector_request_ptr_search(&worker->requests, request,
+			ZBX_DEFAULT_PTR_COMPARE_FUNC)))
+	{
+		zbx_vector_connector_request_ptr_remove_noorder(&worker->requests, i);
+	}
 
-	zbx_vector_connector_data_point_clear_ext(connector_data_points, zbx_connector_data_point_free);
-#ifdef HAVE_LIBCURL
-#define ATTEMPT_DELAY_MAX	10
-	char			query_fields[] = "", headers[] = "", status_codes[] = "200,201,202,203,204";
-	zbx_http_context_t	context;
-	int			ret, timeout_seconds, attempt_interval_sec;
+	connector_request_free(request);
+}
 
-	zbx_http_context_create(&context);
+#ifdef HAVE_LIBCURL
+/******************************************************************************
+ *                                                                            *
+ * Purpose: streams NDJSON request body directly from data points             *
+ *                                                                            *
+ ******************************************************************************/
+static size_t	worker_read_body_cb(char *buffer, size_t size, size_t nitems, void *userdata)
+{
+	zbx_connector_request_t	*request = (zbx_connector_request_t *)userdata;
+	size_t			offset = 0, buffer_size = size * nitems;
 
-	if (FAIL == zbx_is_time_suffix(connector.timeout, &timeout_seconds, (int)strlen(connector.timeout)))
+	while (offset < buffer_size && request->point_index < request->data_points.values_num)
 	{
-		error = zbx_dsprintf(NULL, "Invalid timeout: %s", connector.timeout);
-		ret = FAIL;
-		goto skip;
+		const char	*str = request->data_points.values[request->point_index].str;
+		size_t		len = strlen(str), copy_len;
+
+		/* the data point string is followed by newline */
+		if (request->point_offset < len)
+		{
+			copy_len = MIN(len - request->point_offset, buffer_size - offset);
+			memcpy(buffer + offset, str + request->point_offset, copy_len);
+			request->point_offset += copy_len;
+			offset += copy_len;
+		}
+		else
+		{
+			buffer[offset++] = '\n';
+			request->point_index++;
+			request->point_offset = 0;
+		}
 	}
 
-	if (FAIL == zbx_is_time_suffix(connector.attempt_interval, &attempt_interval_sec,
-			(int)strlen(connector.attempt_interval)) || ATTEMPT_DELAY_MAX < attempt_interval_sec)
+	return offset;
+}
+
+static int	worker_seek_body_cb(void *userdata, curl_off_t offset, int origin)
+{
+	zbx_connector_request_t	*request = (zbx_connector_request_t *)userdata;
+
+	/* only rewinding is needed for redirects and authentication */
+	if (SEEK_SET != origin || 0 != offset)
+		return CURL_SEEKFUNC_CANTSEEK;
+
+	request->point_index = 0;
+	request->point_offset = 0;
+
+	return CURL_SEEKFUNC_OK;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: sets request body either as compressed buffer or as streamed      *
+ *          data points                                                       *
+ *                                                                            *
+ ******************************************************************************/
+static int	worker_prepare_body(zbx_connector_request_t *request, int compression, char **error)
+{
+	CURL		*easyhandle = request->context.easyhandle;
+	CURLcode	err;
+	size_t		body_size = 0;
+
+	if (0 != compression)
 	{
-		error = zbx_dsprintf(NULL, "Invalid attempt delay: %s", connector.attempt_interval);
-		ret = FAIL;
-		goto skip;
+		char	*str = NULL;
+		size_t	str_alloc = 0, str_offset = 0;
+
+		for (int i = 0; i < request->data_points.values_num; i++)
+		{
+			zbx_strcpy_alloc(&str, &str_alloc, &str_offset, request->data_points.values[i].str);
+			zbx_chrcpy_alloc(&str, &str_alloc, &str_offset, '\n');
+		}
+
+		if (SUCCEED != zbx_compress_gzip(str, str_offset, &request->body, &request->body_size))
+		{
+			*error = zbx_dsprintf(NULL, "cannot compress request body: %s", zbx_compress_strerror());
+			zbx_free(str);
+			return FAIL;
+		}
+
+		zbx_free(str);
+
+		if (CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_POSTFIELDSIZE_LARGE,
+				(curl_off_t)request->body_size)) ||
+				CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_POSTFIELDS, request->body)))
+		{
+			*error = zbx_dsprintf(NULL, "Cannot specify data to POST: %s", curl_easy_strerror(err));
+			return FAIL;
+		}
+
+		return SUCCEED;
 	}
 
-	if (SUCCEED == (ret = zbx_http_request_prepare(&context, HTTP_REQUEST_POST, connector.url, headers,
-			query_fields, str, ZBX_RETRIEVE_MODE_CONTENT, connector.http_proxy, 0, timeout_seconds,
-			connector.max_attempts, connector.ssl_cert_file, connector.ssl_key_file,
-			connector.ssl_key_password, connector.verify_peer, connector.verify_host, connector.authtype,
-			connector.username, connector.password, connector.token, ZBX_POSTTYPE_NDJSON,
-			HTTP_STORE_RAW, config_source_ip, config_ssl_ca_location, config_ssl_cert_location,
-			config_ssl_key_location, &error)))
+	for (int i = 0; i < request->data_points.values_num; i++)
+		body_size += strlen(request->data_points.values[i].str) + 1;
+
+	if (CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_POSTFIELDS, NULL)) ||
+			CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_POST, 1L)) ||
+			CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_POSTFIELDSIZE_LARGE,
+			(curl_off_t)body_size)) ||
+			CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_READFUNCTION, worker_read_body_cb)) ||
+			CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_READDATA, request)) ||
+			CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_SEEKFUNCTION, worker_seek_body_cb)) ||
+			CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_SEEKDATA, request)))
 	{
-		long		response_code;
-		CURLcode	err;
+		*error = zbx_dsprintf(NULL, "Cannot specify data to POST: %s", curl_easy_strerror(err));
+		return FAIL;
+	}
+
+	return SUCCEED;
+}
 
-		if (!ZBX_IS_RUNNING())
-			attempt_interval_sec = 0;
+static void	worker_log_error(const zbx_connector_request_t *request, const char *out, const char *error)
+{
+	char	*info = NULL;
 
-		err = zbx_http_request_sync_perform(context.easyhandle, &context, attempt_interval_sec,
-				ZBX_HTTP_CHECK_RESPONSE_CODE);
+	if (NULL != out)
+	{
+		struct zbx_json_parse	jp;
+		size_t			info_alloc = 0;
 
-		if (SUCCEED == (ret = zbx_http_handle_response(context.easyhandle, &context, err, &response_code,
-				&out, &error)))
+		if (SUCCEED != zbx_json_open(out, &jp))
 		{
-			if (FAIL == (ret = zbx_int_in_list(status_codes, (int)response_code)))
+			zabbix_log(LOG_LEVEL_WARNING, "cannot retrieve error from \"%s\": %s response: %s",
+					request->connector.url, zbx_json_strerror(), out);
+		}
+		else
+		{
+			if (SUCCEED != zbx_json_value_by_name_dyn(&jp, ZBX_PROTO_TAG_ERROR, &info, &info_alloc,
+				NULL))
 			{
-				error = zbx_dsprintf(NULL, "Response code \"%ld\" did not match any of the"
-						" required status codes \"%s\"", response_code, status_codes);
+				zabbix_log(LOG_LEVEL_WARNING, "cannot find error tag in response from \"%s\""
+						" response: %s", request->connector.url, out);
+				info = NULL;
 			}
 		}
 	}
-skip:
-	if (FAIL == ret)
+
+	if (NULL != info)
 	{
-		char	*info = NULL;
+		zabbix_log(LOG_LEVEL_WARNING, "cannot send data to \"%s\": %s: %s", request->connector.url,
+				error, info);
+	}
+	else
+		zabbix_log(LOG_LEVEL_WARNING, "cannot send data to \"%s\": %s", request->connector.url, error);
 
-		if (NULL != out)
-		{
-			struct zbx_json_parse	jp;
-			size_t			info_alloc = 0;
+	zbx_free(info);
+}
 
-			if (SUCCEED != zbx_json_open(out, &jp))
-			{
-				zabbix_log(LOG_LEVEL_WARNING, "cannot retrieve error from \"%s\": %s response: %s",
-						connector.url, zbx_json_strerror(), out);
-			}
-			else
-			{
-				if (SUCCEED != zbx_json_value_by_name_dyn(&jp, ZBX_PROTO_TAG_ERROR, &info, &info_alloc,
-					NULL))
-				{
-					zabbix_log(LOG_LEVEL_WARNING, "cannot find error tag in response from \"%s\""
-							" response: %s", connector.url, out);
-					info = NULL;
-				}
-			}
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds request to the multi stack                                   *
+ *                                                                            *
+ ******************************************************************************/
+static int	worker_perform_request(zbx_connector_worker_data_t *worker, zbx_connector_request_t *request,
+		char **error)
+{
+	CURLMcode	merr;
+
+	*request->context.errbuf = '\0';
+	request->point_index = 0;
+	request->point_offset = 0;
+
+	if (CURLM_OK != (merr = curl_multi_add_handle(worker->asynchttppoller_config->curl_handle,
+			request->context.easyhandle)))
+	{
+		*error = zbx_dsprintf(NULL, "Cannot add a standard curl handle to the multi stack: %s",
+				curl_multi_strerror(merr));
+		return FAIL;
+	}
+
+	return SUCCEED;
+}
+
+static void	worker_retry_cb(evutil_socket_t fd, short events, void *arg)
+{
+	zbx_connector_request_t	*request = (zbx_connector_request_t *)arg;
+	zbx_connector_worker_data_t	*worker;
+	char			*error = NULL;
+
+	ZBX_UNUSED(fd);
+	ZBX_UNUSED(events);
+
+	if (CURLE_OK != curl_easy_getinfo(request->context.easyhandle, CURLINFO_PRIVATE, &worker))
+	{
+		THIS_SHOULD_NEVER_HAPPEN;
+		return;
+	}
+
+	if (SUCCEED != worker_perform_request(worker, request, &error))
+	{
+		worker_log_error(request, NULL, error);
+		zbx_free(error);
+		worker_finish_request(worker, request);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: processes finished HTTP request, retrying it if allowed           *
+ *                                                                            *
+ * Comments: Retries follow zbx_http_request_sync_perform() logic - request   *
+ *           is repeated after attempt interval on transfer error or if the   *
+ *           response code is not expected from connector receiver.           *
+ *                                                                            *
+ ******************************************************************************/
+static void	worker_request_done(CURL *easyhandle, CURLcode err, void *arg)
+{
+	zbx_connector_worker_data_t	*worker = (zbx_connector_worker_data_t *)arg;
+	zbx_connector_request_t	*request = NULL;
+	char			retry_codes[] = "200,201,202,203,204,400,401,403,404,405,415,422",
+				status_codes[] = "200,201,202,203,204", *out = NULL, *error = NULL;
+	long			response_code;
+	int			ret;
+
+	curl_multi_remove_handle(worker->asynchttppoller_config->curl_handle, easyhandle);
+
+	for (int i = 0; i < worker->requests.values_num; i++)
+	{
+		if (easyhandle == worker->requests.values[i]->context.easyhandle)
+		{
+			request = worker->requests.values[i];
+			break;
 		}
+	}
 
-		if (NULL != info)
+	if (NULL == request)
+	{
+		THIS_SHOULD_NEVER_HAPPEN;
+		return;
+	}
+
+	if (CURLE_OK == err)
+	{
+		if (CURLE_OK != curl_easy_getinfo(easyhandle, CURLINFO_RESPONSE_CODE, &response_code) ||
+				FAIL == zbx_int_in_list(retry_codes, (int)response_code))
 		{
-			zabbix_log(LOG_LEVEL_WARNING, "cannot send data to \"%s\": %s: %s", connector.url,
-					error, info);
+			goto next_attempt;
 		}
-		else
-			zabbix_log(LOG_LEVEL_WARNING, "cannot send data to \"%s\": %s", connector.url, error);
 
-		zbx_free(info);
+		goto out;
+	}
+	else if (1 != request->context.max_attempts)
+	{
+		zabbix_log(LOG_LEVEL_INFORMATION, "cannot perform request: %s",
+				'\0' == *request->context.errbuf ? curl_easy_strerror(err) : request->context.errbuf);
+	}
+next_attempt:
+	if (0 < --request->context.max_attempts)
+	{
+		struct timeval	tv = {ZBX_IS_RUNNING() ? request->attempt_interval_sec : 0, 0};
+
+		request->context.header.offset = 0;
+		request->context.body.offset = 0;
+
+		evtimer_add(request->retry_timer, &tv);
+
+		return;
+	}
+out:
+	if (SUCCEED == (ret = zbx_http_handle_response(easyhandle, &request->context, err, &response_code, &out,
+			&error)))
+	{
+		if (FAIL == (ret = zbx_int_in_list(status_codes, (int)response_code)))
+		{
+			error = zbx_dsprintf(NULL, "Response code \"%ld\" did not match any of the"
+					" required status codes \"%s\"", response_code, status_codes);
+		}
 	}
 
-	zbx_http_context_destroy(&context);
-#undef ATTEMPT_DELAY_MAX
-#else
-	ZBX_UNUSED(config_source_ip);
-	ZBX_UNUSED(config_ssl_ca_location);
-	ZBX_UNUSED(config_ssl_cert_location);
-	ZBX_UNUSED(config_ssl_key_location);
+	if (FAIL == ret)
+		worker_log_error(request, out, error);
 
-	zabbix_log(LOG_LEVEL_WARNING, "Support for connectors was not compiled in: missing cURL library");
-#endif
-	zbx_free(str);
 	zbx_free(error);
 	zbx_free(out);
 
-	zbx_free(connector.url);
-	zbx_free(connector.timeout);
-	zbx_free(connector.token);
-	zbx_free(connector.http_proxy);
-	zbx_free(connector.username);
-	zbx_free(connector.password);
-	zbx_free(connector.ssl_cert_file);
-	zbx_free(connector.ssl_key_file);
-	zbx_free(connector.ssl_key_password);
-	zbx_free(connector.attempt_interval);
-
-	if (FAIL == zbx_ipc_socket_write(socket, ZBX_IPC_CONNECTOR_RESULT, NULL, 0))
+	worker_finish_request(worker, request);
+}
+
+static void	worker_update_selfmon_counter(void *arg)
+{
+	zbx_connector_worker_data_t	*worker = (zbx_connector_worker_data_t *)arg;
+
+	if (ZBX_PROCESS_STATE_IDLE == worker->state)
 	{
-		zabbix_log(LOG_LEVEL_CRIT, "cannot send preprocessing result");
-		exit(EXIT_FAILURE);
+		zbx_update_selfmon_counter(worker->info, ZBX_PROCESS_STATE_BUSY);
+		worker->state = ZBX_PROCESS_STATE_BUSY;
 	}
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: prepares connector request and adds it to curl multi handle      *
+ *                                                                            *
+ * Return value: SUCCEED - the request was started                            *
+ *               FAIL    - the request could not be started, error is logged  *
+ *                                                                            *
+ ******************************************************************************/
+static int	worker_start_request(zbx_connector_worker_data_t *worker, zbx_connector_request_t *request)
+{
+#define ATTEMPT_DELAY_MAX	10
+	char			query_fields[] = "", headers[] = "", headers_gzip[] = "Content-Encoding: gzip",
+				*error = NULL;
+	zbx_connector_t		*connector = &request->connector;
+	int			timeout_seconds;
+
+	zbx_http_context_create(&request->context);
+
+	if (FAIL == zbx_is_time_suffix(connector->timeout, &timeout_seconds, (int)strlen(connector->timeout)))
+	{
+		error = zbx_dsprintf(NULL, "Invalid timeout: %s", connector->timeout);
+		goto fail;
+	}
+
+	if (FAIL == zbx_is_time_suffix(connector->attempt_interval, &request->attempt_interval_sec,
+			(int)strlen(connector->attempt_interval)) || ATTEMPT_DELAY_MAX < request->attempt_interval_sec)
+	{
+		error = zbx_dsprintf(NULL, "Invalid attempt delay: %s", connector->attempt_interval);
+		goto fail;
+	}
+
+	if (SUCCEED != zbx_http_request_prepare(&request->context, HTTP_REQUEST_POST, connector->url, query_fields,
+			0 != worker->config_connector_compression ? headers_gzip : headers, "",
+			ZBX_RETRIEVE_MODE_CONTENT, connector->http_proxy, 0, timeout_seconds, connector->max_attempts,
+			connector->ssl_cert_file, connector->ssl_key_file, connector->ssl_key_password,
+			connector->verify_peer, connector->verify_host, connector->authtype, connector->username,
+			connector->password, connector->token, ZBX_POSTTYPE_NDJSON, HTTP_STORE_RAW,
+			worker->config_source_ip, worker->config_ssl_ca_location, worker->config_ssl_cert_location,
+			worker->config_ssl_key_location, &error))
+	{
+		goto fail;
+	}
+
+	if (SUCCEED != worker_prepare_body(request, worker->config_connector_compression, &error))
+		goto fail;
+
+	if (CURLE_OK != curl_easy_setopt(request->context.easyhandle, CURLOPT_PRIVATE, worker))
+	{
+		error = zbx_strdup(NULL, "Cannot set pointer to private data");
+		goto fail;
+	}
+
+	if (NULL == (request->retry_timer = evtimer_new(worker->base, worker_retry_cb, request)))
+	{
+		error = zbx_strdup(NULL, "Cannot create retry timer");
+		goto fail;
+	}
+
+	if (SUCCEED == worker_perform_request(worker, request, &error))
+		return SUCCEED;
+fail:
+	worker_log_error(request, NULL, error);
+	zbx_free(error);
+
+	return FAIL;
+#undef ATTEMPT_DELAY_MAX
+}
+#endif	/* HAVE_LIBCURL */
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: starts sending connector data received from manager               *
+ *                                                                            *
+ * Comments: The request is sent asynchronously, manager is notified when it  *
+ *           is finished.                                                     *
+ *                                                                            *
+ ******************************************************************************/
+static void	worker_process_request(zbx_connector_worker_data_t *worker, zbx_ipc_message_t *message,
+		zbx_uint64_t *processed_num)
+{
+	zbx_connector_request_t	*request;
+
+	request = (zbx_connector_request_t *)zbx_malloc(NULL, sizeof(zbx_connector_request_t));
+	memset(request, 0, sizeof(zbx_connector_request_t));
+
+	request->taskid = ++worker->requests_num;
+	zbx_vector_connector_data_point_create(&request->data_points);
+	zbx_vector_connector_request_ptr_append(&worker->requests, request);
+
+	zbx_connector_deserialize_connector_and_data_point(message->data, message->size, &request->connector,
+			&request->data_points);
+
+	zbx_vector_connector_data_point_sort(&request->data_points, connector_object_compare_func);
+
+	*processed_num += (zbx_uint64_t)request->data_points.values_num;
+#ifdef HAVE_LIBCURL
+	if (SUCCEED == worker_start_request(worker, request))
+		return;
+#else
+	zabbix_log(LOG_LEVEL_WARNING, "Support for connectors was not compiled in: missing cURL library");
+#endif
+	worker_finish_request(worker, request);
+}
+
+static void	worker_socket_read_event_cb(evutil_socket_t fd, short what, void *arg)
+{
+	ZBX_UNUSED(fd);
+	ZBX_UNUSED(what);
+	ZBX_UNUSED(arg);
+}
+
 ZBX_THREAD_ENTRY(connector_worker_thread, args)
 {
 #define	STAT_INTERVAL	5	/* if a process is busy and does not sleep then update status not faster than */
 				/* once in STAT_INTERVAL seconds */
 	pid_t					ppid;
 	char					*error = NULL;
-	zbx_ipc_socket_t			socket;
-	zbx_ipc_message_t			message;
+	zbx_ipc_message_t			*message;
 	double					time_stat, time_idle = 0, time_now, time_read;
 	const zbx_thread_info_t			*info = &((zbx_thread_args_t *)args)->info;
 	int					server_num = ((zbx_thread_args_t *)args)->info.server_num,
 						process_num = ((zbx_thread_args_t *)args)->info.process_num;
 	unsigned char				process_type = ((zbx_thread_args_t *)args)->info.process_type;
-	zbx_vector_connector_data_point_t	connector_data_points;
 	zbx_uint64_t				processed_num = 0, connections_num = 0;
+	zbx_connector_worker_data_t			worker;
+	struct event				*socket_event, *wake_timer;
+	struct timeval				tv = {1, 0};
 
 	const zbx_thread_connector_worker_args	*connector_worker_args_in = (const zbx_thread_connector_worker_args *)
 						(((zbx_thread_args_t *)args)->args);
 
 	zbx_setproctitle("%s #%d starting", get_process_type_string(info->program_type), process_num);
 
-	zbx_ipc_message_init(&message);
+	memset(&worker, 0, sizeof(worker));
+	worker.info = info;
+	worker.config_source_ip = connector_worker_args_in->config_source_ip;
+	worker.config_ssl_ca_location = connector_worker_args_in->config_ssl_ca_location;
+	worker.config_ssl_cert_location = connector_worker_args_in->config_ssl_cert_location;
+	worker.config_ssl_key_location = connector_worker_args_in->config_ssl_key_location;
+	worker.config_connector_compression = connector_worker_args_in->config_connector_compression;
+	zbx_vector_connector_request_ptr_create(&worker.requests);
 
-	if (FAIL == zbx_ipc_socket_open(&socket, ZBX_IPC_SERVICE_CONNECTOR, SEC_PER_MIN, &error))
+	if (FAIL == zbx_ipc_async_socket_open(&worker.socket, ZBX_IPC_SERVICE_CONNECTOR, SEC_PER_MIN, &error))
 	{
 		zabbix_log(LOG_LEVEL_CRIT, "cannot connect to connector service: %s", error);
 		zbx_free(error);
@@ -210,30 +582,61 @@ ZBX_THREAD_ENTRY(connector_worker_thread, args)
 	}
 
 	ppid = getppid();
-	zbx_ipc_socket_write(&socket, ZBX_IPC_CONNECTOR_WORKER, (unsigned char *)&ppid, sizeof(ppid));
 
+	if (FAIL == zbx_ipc_async_socket_send(&worker.socket, ZBX_IPC_CONNECTOR_WORKER, (unsigned char *)&ppid,
+			sizeof(ppid)) || FAIL == zbx_ipc_async_socket_flush(&worker.socket, SEC_PER_MIN))
+	{
+		zabbix_log(LOG_LEVEL_CRIT, "cannot register in connector service");
+		exit(EXIT_FAILURE);
+	}
+
+	if (NULL == (worker.base = event_base_new()))
+	{
+		zabbix_log(LOG_LEVEL_CRIT, "cannot initialize event base");
+		exit(EXIT_FAILURE);
+	}
+
+	/* the socket event only wakes up the event loop, messages are read by asynchronous socket */
+	socket_event = event_new(worker.base, zbx_ipc_client_get_fd(worker.socket.client), EV_READ | EV_PERSIST,
+			worker_socket_read_event_cb, NULL);
+	event_add(socket_event, NULL);
+
+	wake_timer = event_new(worker.base, -1, EV_PERSIST, worker_socket_read_event_cb, NULL);
+	evtimer_add(wake_timer, &tv);
+
+#ifdef HAVE_LIBCURL
+	zbx_async_httpagent_init();
+
+	if (NULL == (worker.asynchttppoller_config = zbx_async_httpagent_create(worker.base, worker_request_done,
+			worker_update_selfmon_counter, &worker, &error)))
+	{
+		zabbix_log(LOG_LEVEL_CRIT, "zbx_async_httpagent_create() error: %s", error);
+		zbx_free(error);
+		exit(EXIT_FAILURE);
+	}
+#endif
 	zabbix_log(LOG_LEVEL_INFORMATION, "%s #%d started [%s #%d]", get_program_type_string(info->program_type),
 			server_num, get_process_type_string(process_type), process_num);
 
 	zbx_update_selfmon_counter(info, ZBX_PROCESS_STATE_BUSY);
+	worker.state = ZBX_PROCESS_STATE_BUSY;
 
 	zbx_setproctitle("%s #%d started", get_process_type_string(process_type), process_num);
 
-	zbx_vector_connector_data_point_create(&connector_data_points);
-
 	time_stat = zbx_time();
 
 	for (;;)
 	{
+		int	ret;
 
 		time_now = zbx_time();
 
 		if (STAT_INTERVAL < time_now - time_stat)
 		{
-			zbx_setproctitle("%s #%d [processed values " ZBX_FS_UI64 ", connections " ZBX_FS_UI64 ", idle "
-					ZBX_FS_DBL " sec during " ZBX_FS_DBL " sec]",
+			zbx_setproctitle("%s #%d [processed values " ZBX_FS_UI64 ", connections " ZBX_FS_UI64 ", "
+					"sending %d, idle " ZBX_FS_DBL " sec during " ZBX_FS_DBL " sec]",
 					get_process_type_string(process_type), process_num, processed_num,
-					connections_num, time_idle, time_now - time_stat);
+					connections_num, worker.requests.values_num, time_idle, time_now - time_stat);
 
 			time_stat = time_now;
 			time_idle = 0;
@@ -241,9 +644,41 @@ ZBX_THREAD_ENTRY(connector_worker_thread, args)
 			connections_num = 0;
 		}
 
-		zbx_update_selfmon_counter(info, ZBX_PROCESS_STATE_IDLE);
+		if (ZBX_PROCESS_STATE_BUSY == worker.state)
+		{
+			zbx_update_selfmon_counter(info, ZBX_PROCESS_STATE_IDLE);
+			worker.state = ZBX_PROCESS_STATE_IDLE;
+		}
+
+		event_base_loop(worker.base, EVLOOP_ONCE);
 
-		if (SUCCEED != zbx_ipc_socket_read(&socket, &message))
+		time_read = zbx_time();
+
+		if (0 == worker.requests.values_num)
+			time_idle += time_read - time_now;
+
+		zbx_update_env(get_process_type_string(process_type), time_read);
+
+		while (SUCCEED == (ret = zbx_ipc_async_socket_recv(&worker.socket, 0, &message)) && NULL != message)
+		{
+			if (ZBX_PROCESS_STATE_IDLE == worker.state)
+			{
+				zbx_update_selfmon_counter(info, ZBX_PROCESS_STATE_BUSY);
+				worker.state = ZBX_PROCESS_STATE_BUSY;
+			}
+
+			switch (message->code)
+			{
+				case ZBX_IPC_CONNECTOR_REQUEST:
+					worker_process_request(&worker, message, &processed_num);
+					connections_num++;
+					break;
+			}
+
+			zbx_ipc_message_free(message);
+		}
+
+		if (FAIL == ret)
 		{
 			if (ZBX_IS_RUNNING())
 			{
@@ -253,29 +688,26 @@ ZBX_THREAD_ENTRY(connector_worker_thread, args)
 
 			break;
 		}
+	}
 
-		zbx_update_selfmon_counter(info, ZBX_PROCESS_STATE_BUSY);
-
-		time_read = zbx_time();
-		time_idle += time_read - time_now;
-
-		zbx_update_env(get_process_type_string(process_type), time_read);
+#ifdef HAVE_LIBCURL
+	for (int i = 0; i < worker.requests.values_num; i++)
+	{
+		curl_multi_remove_handle(worker.asynchttppoller_config->curl_handle,
+				worker.requests.values[i]->context.easyhandle);
+	}
 
-		switch (message.code)
-		{
-			case ZBX_IPC_CONNECTOR_REQUEST:
-				worker_process_request(&socket, connector_worker_args_in->config_source_ip,
-						connector_worker_args_in->config_ssl_ca_location,
-						connector_worker_args_in->config_ssl_cert_location,
-						connector_worker_args_in->config_ssl_key_location,
-						&message, &connector_data_points, &processed_num);
-				connections_num++;
-				break;
-		}
+	zbx_async_httpagent_clean(worker.asynchttppoller_config);
+	zbx_free(worker.asynchttppoller_config);
+#endif
+	zbx_vector_connector_request_ptr_clear_ext(&worker.requests, connector_request_free);
+	zbx_vector_connector_request_ptr_destroy(&worker.requests);
 
-		zbx_ipc_message_clean(&message);
-	}
+	event_free(wake_timer);
+	event_free(socket_event);
+	event_base_free(worker.base);
+	zbx_ipc_async_socket_close(&worker.socket);
 
-	zbx_vector_connector_data_point_destroy(&connector_data_points);
 	exit(EXIT_SUCCESS);
+#undef STAT_INTERVAL
 }
@@ -19,6 +19,7 @@
 
 #include "zbxcachevalue.h"
 #include "zbxalerter.h"
+#include "zbxservice.h"
 #include "zbxtime.h"
 #include "zbxpreproc.h"
 #include "zbxalgo.h"
@@ -35,6 +36,22 @@
 
 #define ZBX_DIAG_ALERTING_SIMPLE	(ZBX_DIAG_ALERTING_ALERTS)
 
+#define ZBX_DIAG_SERVICEMANAGER_SERVICES	0x00000001
+#define ZBX_DIAG_SERVICEMANAGER_PROBLEMS	0x00000002
+#define ZBX_DIAG_SERVICEMANAGER_BATCHES		0x00000004
+#define ZBX_DIAG_SERVICEMANAGER_EVALUATED	0x00000008
+#define ZBX_DIAG_SERVICEMANAGER_UPDATES		0x00000010
+#define ZBX_DIAG_SERVICEMANAGER_TIME		0x00000020
+#define ZBX_DIAG_SERVICEMANAGER_LAG		0x00000040
+
+#define ZBX_DIAG_SERVICEMANAGER_SIMPLE	(ZBX_DIAG_SERVICEMANAGER_SERVICES | \
+					ZBX_DIAG_SERVICEMANAGER_PROBLEMS | \
+					ZBX_DIAG_SERVICEMANAGER_BATCHES | \
+					ZBX_DIAG_SERVICEMANAGER_EVALUATED | \
+					ZBX_DIAG_SERVICEMANAGER_UPDATES | \
+					ZBX_DIAG_SERVICEMANAGER_TIME | \
+					ZBX_DIAG_SERVICEMANAGER_LAG)
+
 /******************************************************************************
  *                                                                            *
  * Purpose: sort itemid,values_num pair by values_num in descending order     *
@@ -508,6 +525,92 @@ out:
 	return ret;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: add requested service manager diagnostic information to json data *
+ *                                                                            *
+ * Parameters: jp    - [IN] the request                                       *
+ *             json  - [IN/OUT] the json to update                            *
+ *             error - [OUT] error message                                    *
+ *                                                                            *
+ * Return value: SUCCEED - the information was added successfully             *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	diag_add_servicemanager_info(const struct zbx_json_parse *jp, struct zbx_json *json, char **error)
+{
+	zbx_vector_diag_map_ptr_t	tops;
+	int				ret;
+	double				time1, time2;
+	zbx_uint64_t			fields;
+	zbx_diag_map_t			field_map[] = {
+							{"", ZBX_DIAG_SERVICEMANAGER_SIMPLE},
+							{"services", ZBX_DIAG_SERVICEMANAGER_SERVICES},
+							{"problems", ZBX_DIAG_SERVICEMANAGER_PROBLEMS},
+							{"batches", ZBX_DIAG_SERVICEMANAGER_BATCHES},
+							{"evaluated", ZBX_DIAG_SERVICEMANAGER_EVALUATED},
+							{"updates", ZBX_DIAG_SERVICEMANAGER_UPDATES},
+							{"time", ZBX_DIAG_SERVICEMANAGER_TIME},
+							{"lag", ZBX_DIAG_SERVICEMANAGER_LAG},
+							{NULL, 0}
+						};
+
+	zbx_vector_diag_map_ptr_create(&tops);
+
+	if (SUCCEED == (ret = zbx_diag_parse_request(jp, field_map, &fields, &tops, error)))
+	{
+		zbx_service_diag_stats_t	stats;
+
+		if (0 != tops.values_num)
+		{
+			zbx_diag_map_t	*map = (zbx_diag_map_t *)tops.values[0];
+
+			*error = zbx_dsprintf(*error, "Unsupported top field: %s", map->name);
+			ret = FAIL;
+			goto out;
+		}
+
+		time1 = zbx_time();
+		if (FAIL == (ret = zbx_service_get_diag_stats(&stats, error)))
+			goto out;
+		time2 = zbx_time();
+
+		zbx_json_addobject(json, ZBX_DIAG_SERVICEMANAGER);
+
+		if (0 != (fields & ZBX_DIAG_SERVICEMANAGER_SERVICES))
+			zbx_json_adduint64(json, "services", stats.services_num);
+		if (0 != (fields & ZBX_DIAG_SERVICEMANAGER_PROBLEMS))
+			zbx_json_adduint64(json, "problems", stats.problems_num);
+		if (0 != (fields & ZBX_DIAG_SERVICEMANAGER_BATCHES))
+			zbx_json_adduint64(json, "batches", stats.batches_num);
+		if (0 != (fields & ZBX_DIAG_SERVICEMANAGER_EVALUATED))
+			zbx_json_adduint64(json, "evaluated", stats.evaluated_num);
+		if (0 != (fields & ZBX_DIAG_SERVICEMANAGER_UPDATES))
+			zbx_json_adduint64(json, "updates", stats.updates_num);
+
+		if (0 != (fields & ZBX_DIAG_SERVICEMANAGER_TIME))
+		{
+			zbx_json_addfloat(json, "time.recalculation", stats.recalc_time);
+			zbx_json_addfloat(json, "time.db", stats.db_time);
+		}
+
+		if (0 != (fields & ZBX_DIAG_SERVICEMANAGER_LAG))
+		{
+			zbx_json_addfloat(json, "lag.last", stats.lag_last);
+			zbx_json_addfloat(json, "lag.avg", 0 != stats.lag_num ? stats.lag_total / stats.lag_num : 0);
+			zbx_json_addfloat(json, "lag.max", stats.lag_max);
+		}
+
+		zbx_json_addfloat(json, "time", time2 - time1);
+		zbx_json_close(json);
+	}
+out:
+	zbx_vector_diag_map_ptr_clear_ext(&tops, zbx_diag_map_free);
+	zbx_vector_diag_map_ptr_destroy(&tops);
+
+	return ret;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: add requested section diagnostic information                      *
@@ -543,6 +646,10 @@ int	diag_add_section_info_server(const char *section, const struct zbx_json_pars
 	}
 	else if (0 == strcmp(section, ZBX_DIAG_CONNECTOR))
 		ret = zbx_diag_add_connector_info(jp, json, error);
+	else if (0 == strcmp(section, ZBX_DIAG_CONFIGCACHE))
+		ret = zbx_diag_add_configcache_info(jp, json, error);
+	else if (0 == strcmp(section, ZBX_DIAG_SERVICEMANAGER))
+		ret = diag_add_servicemanager_info(jp, json, error);
 	else
 		*error = zbx_dsprintf(*error, "Unsupported diagnostics section: %s", section);
 
@@ -229,6 +229,8 @@ static int	filter_condition_match(const zbx_lld_entry_t *lld_obj, const zbx_lld_
  *                                                                                      *
  * Parameters: filter          - [IN] LLD filter                                        *
  *             lld_obj         - [IN] LLD data row                                      *
+ *             results         - [IN] precalculated condition results ('0' or '1'),     *
+ *                                    optional                                          *
  *             info            - [OUT] warning description                              *
  *                                                                                      *
  * Return value: SUCCEED - LLD data passed filter evaluation                            *
@@ -236,7 +238,7 @@ static int	filter_condition_match(const zbx_lld_entry_t *lld_obj, const zbx_lld_
  *                                                                                      *
  ****************************************************************************************/
 static int	filter_evaluate_and_or_andor(const zbx_lld_filter_t *filter, const zbx_lld_entry_t *lld_obj,
-		char **info)
+		const char *results, char **info)
 {
 	int			ret = SUCCEED, error_num = 0, res;
 	double			result;
@@ -286,7 +288,11 @@ static int	filter_evaluate_and_or_andor(const zbx_lld_filter_t *filter, const zb
 				goto out;
 		}
 
-		if (SUCCEED == (ret = filter_condition_match(lld_obj, condition, &res, &errmsg)))
+		if (NULL != results)
+		{
+			zbx_chrcpy_alloc(&expression, &expression_alloc, &expression_offset, results[i]);
+		}
+		else if (SUCCEED == (ret = filter_condition_match(lld_obj, condition, &res, &errmsg)))
 		{
 			zbx_snprintf_alloc(&expression, &expression_alloc, &expression_offset, "%d", res);
 		}
@@ -327,6 +333,8 @@ out:
  *                                                                            *
  * Parameters: filter          - [IN] LLD filter                              *
  *             lld_obj         - [IN] LLD data row                            *
+ *             results         - [IN] precalculated condition results ('0' or *
+ *                                    '1'), optional                          *
  *             err_msg         - [OUT]                                        *
  *                                                                            *
  * Return value: SUCCEED - LLD data passed filter evaluation                  *
@@ -338,7 +346,7 @@ out:
  *                                                                            *
  ******************************************************************************/
 static int	filter_evaluate_expression(const zbx_lld_filter_t *filter, const zbx_lld_entry_t *lld_obj,
-		char **err_msg)
+		const char *results, char **err_msg)
 {
 	int			ret, res, error_num = 0;
 	char			*expression = NULL, id[ZBX_MAX_UINT64_LEN + 2], *p, error[256], value[16],
@@ -360,7 +368,11 @@ static int	filter_evaluate_expression(const zbx_lld_filter_t *filter, const zbx_
 	{
 		const zbx_lld_condition_t	*condition = filter->conditions.values[i];
 
-		if (SUCCEED == filter_condition_match(lld_obj, condition, &res, &errmsg))
+		if (NULL != results)
+		{
+			zbx_snprintf(value, sizeof(value), "%c", results[i]);
+		}
+		else if (SUCCEED == filter_condition_match(lld_obj, condition, &res, &errmsg))
 		{
 			zbx_snprintf(value, sizeof(value), "%d", res);
 		}
@@ -412,13 +424,16 @@ static int	filter_evaluate_expression(const zbx_lld_filter_t *filter, const zbx_
  *                                                                            *
  * Parameters: filter          - [IN] LLD filter                              *
  *             lld_obj         - [IN] LLD data row                            *
+ *             results         - [IN] precalculated condition results ('0' or *
+ *                                    '1'), optional                          *
  *             info            - [OUT] warning description                    *
  *                                                                            *
  * Return value: SUCCEED - LLD data passed filter evaluation                  *
  *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
-static int	filter_evaluate(const zbx_lld_filter_t *filter, const zbx_lld_entry_t *lld_obj, char **info)
+static int	filter_evaluate(const zbx_lld_filter_t *filter, const zbx_lld_entry_t *lld_obj, const char *results,
+		char **info)
 {
 	if (0 == filter->conditions.values_num)
 		return SUCCEED;
@@ -428,9 +443,9 @@ static int	filter_evaluate(const zbx_lld_filter_t *filter, const zbx_lld_entry_t
 		case ZBX_CONDITION_EVAL_TYPE_AND_OR:
 		case ZBX_CONDITION_EVAL_TYPE_AND:
 		case ZBX_CONDITION_EVAL_TYPE_OR:
-			return filter_evaluate_and_or_andor(filter, lld_obj, info);
+			return filter_evaluate_and_or_andor(filter, lld_obj, results, info);
 		case ZBX_CONDITION_EVAL_TYPE_EXPRESSION:
-			return filter_evaluate_expression(filter, lld_obj, info);
+			return filter_evaluate_expression(filter, lld_obj, results, info);
 	}
 
 	return FAIL;
@@ -984,20 +999,376 @@ int	lld_validate_lldrule_override_no_discover(const zbx_vector_lld_override_ptr_
 	return ZBX_PROTOTYPE_NO_DISCOVER == override_default ? FAIL : SUCCEED;
 }
 
+/* filter condition results, stored as characters to be used in memoized result keys */
+#define ZBX_LLD_CONDITION_UNDEFINED	'\0'
+#define ZBX_LLD_CONDITION_FALSE		'0'
+#define ZBX_LLD_CONDITION_TRUE		'1'
+#define ZBX_LLD_CONDITION_UNKNOWN	'?'
+
+/* filter condition compiled for evaluation over all LLD rows, shared by conditions */
+/* with the same macro, pattern and operator in rule filter and overrides           */
+typedef struct
+{
+	const zbx_lld_condition_t	*condition;
+	zbx_regexp_t			*regexp;	/* precompiled non-global regular expression */
+	char				*results;	/* condition results by LLD row index */
+}
+zbx_lld_plan_column_t;
+
+ZBX_PTR_VECTOR_DECL(lld_plan_column_ptr, zbx_lld_plan_column_t *)
+ZBX_PTR_VECTOR_IMPL(lld_plan_column_ptr, zbx_lld_plan_column_t *)
+
+/* filter result for a combination of condition results */
+typedef struct
+{
+	char	*key;
+	int	ret;
+}
+zbx_lld_plan_result_t;
+
+typedef struct
+{
+	const zbx_lld_filter_t	*filter;
+	int			*columns;	/* plan columns of filter conditions */
+	char			*key;		/* condition results of the evaluated row */
+	zbx_hashset_t		results;	/* memoized filter results */
+}
+zbx_lld_plan_filter_t;
+
+/* LLD rule filter and overrides compiled for LLD row evaluation */
+typedef struct
+{
+	const zbx_vector_lld_entry_ptr_t	*entries;
+	zbx_vector_lld_plan_column_ptr_t	columns;
+	zbx_lld_plan_filter_t			filter;
+	zbx_lld_plan_filter_t			*overrides;
+	int					overrides_num;
+}
+zbx_lld_plan_t;
+
+static zbx_hash_t	lld_plan_result_hash(const void *d)
+{
+	const zbx_lld_plan_result_t	*result = (const zbx_lld_plan_result_t *)d;
+
+	return ZBX_DEFAULT_STRING_HASH_FUNC(result->key);
+}
+
+static int	lld_plan_result_compare(const void *d1, const void *d2)
+{
+	const zbx_lld_plan_result_t	*r1 = (const zbx_lld_plan_result_t *)d1;
+	const zbx_lld_plan_result_t	*r2 = (const zbx_lld_plan_result_t *)d2;
+
+	return strcmp(r1->key, r2->key);
+}
+
+static void	lld_plan_result_clear(void *d)
+{
+	zbx_lld_plan_result_t	*result = (zbx_lld_plan_result_t *)d;
+
+	zbx_free(result->key);
+}
+
+static int	lld_plan_get_column(zbx_lld_plan_t *plan, const zbx_lld_condition_t *condition)
+{
+	zbx_lld_plan_column_t	*column;
+	char			*error = NULL;
+
+	for (int i = 0; i < plan->columns.values_num; i++)
+	{
+		const zbx_lld_condition_t	*c = plan->columns.values[i]->condition;
+
+		if (c->op == condition->op && 0 == strcmp(c->macro, condition->macro) &&
+				0 == strcmp(c->regexp, condition->regexp))
+		{
+			return i;
+		}
+	}
+
+	column = (zbx_lld_plan_column_t *)zbx_malloc(NULL, sizeof(zbx_lld_plan_column_t));
+	column->condition = condition;
+	column->regexp = NULL;
+	column->results = (char *)zbx_calloc(NULL, (size_t)plan->entries->values_num + 1, sizeof(char));
+
+	/* global regular expressions are resolved during filter loading, invalid */
+	/* expressions are left for row by row evaluation to report errors        */
+	if (ZBX_CONDITION_OPERATOR_REGEXP == condition->op || ZBX_CONDITION_OPERATOR_NOT_REGEXP == condition->op)
+	{
+		if ('@' != *condition->regexp && '\0' != *condition->regexp &&
+				SUCCEED != zbx_regexp_compile(condition->regexp, &column->regexp, &error))
+		{
+			zbx_free(error);
+		}
+	}
+
+	zbx_vector_lld_plan_column_ptr_append(&plan->columns, column);
+
+	return plan->columns.values_num - 1;
+}
+
+static void	lld_plan_filter_init(zbx_lld_plan_t *plan, zbx_lld_plan_filter_t *plan_filter,
+		const zbx_lld_filter_t *filter)
+{
+	int	conditions_num = filter->conditions.values_num;
+
+	plan_filter->filter = filter;
+	plan_filter->columns = (int *)zbx_malloc(NULL, sizeof(int) * (size_t)(conditions_num + 1));
+	plan_filter->key = (char *)zbx_malloc(NULL, (size_t)conditions_num + 1);
+	plan_filter->key[conditions_num] = '\0';
+
+	for (int i = 0; i < conditions_num; i++)
+		plan_filter->columns[i] = lld_plan_get_column(plan, filter->conditions.values[i]);
+
+	zbx_hashset_create_ext(&plan_filter->results, 0, lld_plan_result_hash, lld_plan_result_compare,
+			lld_plan_result_clear, ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC,
+			ZBX_DEFAULT_MEM_FREE_FUNC);
+}
+
+static void	lld_plan_filter_clear(zbx_lld_plan_filter_t *plan_filter)
+{
+	zbx_hashset_destroy(&plan_filter->results);
+	zbx_free(plan_filter->key);
+	zbx_free(plan_filter->columns);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: compiles LLD rule filter and overrides into evaluation plan       *
+ *                                                                            *
+ * Parameters: plan      - [OUT]                                              *
+ *             entries   - [IN] LLD rows                                      *
+ *             filter    - [IN] LLD rule filter                               *
+ *             overrides - [IN] LLD rule overrides                            *
+ *                                                                            *
+ * Comments: The same condition used in filter and several overrides is       *
+ *           evaluated only once per row.                                     *
+ *                                                                            *
+ ******************************************************************************/
+static void	lld_plan_init(zbx_lld_plan_t *plan, const zbx_vector_lld_entry_ptr_t *entries,
+		const zbx_lld_filter_t *filter, const zbx_vector_lld_override_ptr_t *overrides)
+{
+	plan->entries = entries;
+	zbx_vector_lld_plan_column_ptr_create(&plan->columns);
+
+	lld_plan_filter_init(plan, &plan->filter, filter);
+
+	plan->overrides_num = overrides->values_num;
+	plan->overrides = (zbx_lld_plan_filter_t *)zbx_malloc(NULL, sizeof(zbx_lld_plan_filter_t) *
+			(size_t)(overrides->values_num + 1));
+
+	for (int i = 0; i < overrides->values_num; i++)
+		lld_plan_filter_init(plan, &plan->overrides[i], &overrides->values[i]->filter);
+}
+
+static void	lld_plan_clear(zbx_lld_plan_t *plan)
+{
+	for (int i = 0; i < plan->overrides_num; i++)
+		lld_plan_filter_clear(&plan->overrides[i]);
+
+	zbx_free(plan->overrides);
+	lld_plan_filter_clear(&plan->filter);
+
+	for (int i = 0; i < plan->columns.values_num; i++)
+	{
+		zbx_lld_plan_column_t	*column = plan->columns.values[i];
+
+		if (NULL != column->regexp)
+			zbx_regexp_free(column->regexp);
+
+		zbx_free(column->results);
+		zbx_free(column);
+	}
+
+	zbx_vector_lld_plan_column_ptr_destroy(&plan->columns);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: evaluates filter condition for LLD row                            *
+ *                                                                            *
+ * Return value: ZBX_LLD_CONDITION_TRUE    - the condition is true            *
+ *               ZBX_LLD_CONDITION_FALSE   - the condition is false           *
+ *               ZBX_LLD_CONDITION_UNKNOWN - the condition cannot be          *
+ *                                           evaluated                        *
+ *                                                                            *
+ ******************************************************************************/
+static char	lld_plan_column_match(const zbx_lld_plan_column_t *column, const zbx_lld_entry_t *entry)
+{
+	const zbx_lld_condition_t	*condition = column->condition;
+	const char			*value;
+	int				ret;
+
+	if (NULL == (value = lld_entry_get_macro(entry, condition->macro)))
+	{
+		switch (condition->op)
+		{
+			case ZBX_CONDITION_OPERATOR_NOT_EXIST:
+				return ZBX_LLD_CONDITION_TRUE;
+			case ZBX_CONDITION_OPERATOR_EXIST:
+				return ZBX_LLD_CONDITION_FALSE;
+			default:
+				return ZBX_LLD_CONDITION_UNKNOWN;
+		}
+	}
+
+	switch (condition->op)
+	{
+		case ZBX_CONDITION_OPERATOR_NOT_EXIST:
+			return ZBX_LLD_CONDITION_FALSE;
+		case ZBX_CONDITION_OPERATOR_EXIST:
+			return ZBX_LLD_CONDITION_TRUE;
+	}
+
+	if (NULL != column->regexp)
+	{
+		char	*error = NULL;
+
+		if (FAIL == (ret = zbx_regexp_match_precompiled2(value, column->regexp, &error)))
+			zbx_free(error);
+	}
+	else
+		ret = zbx_regexp_match_ex(&condition->regexps, value, condition->regexp, ZBX_CASE_SENSITIVE);
+
+	switch (ret)
+	{
+		case ZBX_REGEXP_MATCH:
+			return ZBX_CONDITION_OPERATOR_REGEXP == condition->op ? ZBX_LLD_CONDITION_TRUE :
+					ZBX_LLD_CONDITION_FALSE;
+		case ZBX_REGEXP_NO_MATCH:
+			return ZBX_CONDITION_OPERATOR_NOT_REGEXP == condition->op ? ZBX_LLD_CONDITION_TRUE :
+					ZBX_LLD_CONDITION_FALSE;
+		default:
+			return ZBX_LLD_CONDITION_UNKNOWN;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: evaluates filter conditions for a batch of LLD rows               *
+ *                                                                            *
+ * Parameters: plan        - [IN/OUT]                                         *
+ *             plan_filter - [IN] filter which conditions must be evaluated   *
+ *             rows        - [IN] indexes of rows to evaluate                 *
+ *                                                                            *
+ * Comments: Conditions are evaluated column by column, already evaluated     *
+ *           results are reused.                                              *
+ *                                                                            *
+ ******************************************************************************/
+static void	lld_plan_evaluate_columns(zbx_lld_plan_t *plan, const zbx_lld_plan_filter_t *plan_filter,
+		const zbx_vector_int32_t *rows)
+{
+	for (int i = 0; i < plan_filter->filter->conditions.values_num; i++)
+	{
+		zbx_lld_plan_column_t	*column = plan->columns.values[plan_filter->columns[i]];
+
+		for (int j = 0; j < rows->values_num; j++)
+		{
+			int	row = rows->values[j];
+
+			if (ZBX_LLD_CONDITION_UNDEFINED == column->results[row])
+				column->results[row] = lld_plan_column_match(column, plan->entries->values[row]);
+		}
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if LLD row passes filter evaluation                        *
+ *                                                                            *
+ * Parameters: plan        - [IN]                                             *
+ *             plan_filter - [IN/OUT]                                         *
+ *             row         - [IN] LLD row index                               *
+ *             info        - [OUT] warning description                        *
+ *                                                                            *
+ * Return value: SUCCEED - LLD row passed filter evaluation                   *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: Filter expression is evaluated once per combination of condition *
+ *           results. Rows with conditions that cannot be evaluated are       *
+ *           passed to generic filter evaluation to report the warnings.      *
+ *                                                                            *
+ ******************************************************************************/
+static int	lld_plan_filter_evaluate(const zbx_lld_plan_t *plan, zbx_lld_plan_filter_t *plan_filter, int row,
+		char **info)
+{
+	const zbx_lld_filter_t	*filter = plan_filter->filter;
+	const zbx_lld_entry_t	*entry = plan->entries->values[row];
+	zbx_lld_plan_result_t	result_local, *result;
+	char			*error = NULL;
+	int			ret;
+
+	if (0 == filter->conditions.values_num)
+		return SUCCEED;
+
+	for (int i = 0; i < filter->conditions.values_num; i++)
+	{
+		char	value = plan->columns.values[plan_filter->columns[i]]->results[row];
+
+		if (ZBX_LLD_CONDITION_TRUE != value && ZBX_LLD_CONDITION_FALSE != value)
+			return filter_evaluate(filter, entry, NULL, info);
+
+		plan_filter->key[i] = value;
+	}
+
+	result_local.key = plan_filter->key;
+
+	if (NULL != (result = (zbx_lld_plan_result_t *)zbx_hashset_search(&plan_filter->results, &result_local)))
+		return result->ret;
+
+	ret = filter_evaluate(filter, entry, plan_filter->key, &error);
+
+	/* filter expression errors are reported for every row, as with generic evaluation */
+	if (NULL != error)
+	{
+		*info = zbx_strdcat(*info, error);
+		zbx_free(error);
+
+		return ret;
+	}
+
+	result_local.key = zbx_strdup(NULL, plan_filter->key);
+	result_local.ret = ret;
+	zbx_hashset_insert(&plan_filter->results, &result_local, sizeof(result_local));
+
+	return ret;
+}
+
 static int	lld_rows_get(zbx_vector_lld_entry_ptr_t *lld_entries, zbx_lld_filter_t *filter,
 		zbx_vector_lld_row_ptr_t *lld_rows, const zbx_vector_lld_override_ptr_t *overrides, char **info)
 {
-	zbx_lld_row_t	*lld_row;
-	int		ret = FAIL;
+	zbx_lld_row_t		*lld_row;
+	zbx_lld_plan_t		plan;
+	zbx_vector_int32_t	rows;
+	int			rows_num = 0, ret = FAIL;
 
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() rows:%d", __func__, lld_entries->values_num);
+
+	lld_plan_init(&plan, lld_entries, filter, overrides);
+
+	zbx_vector_int32_create(&rows);
+	zbx_vector_int32_reserve(&rows, (size_t)lld_entries->values_num);
 
+	for (int i = 0; i < lld_entries->values_num; i++)
+		zbx_vector_int32_append(&rows, i);
+
+	lld_plan_evaluate_columns(&plan, &plan.filter, &rows);
+
+	/* keep only rows passing the filter, overrides are evaluated for them */
 	for (int i = 0; i < lld_entries->values_num; i++)
 	{
-		zbx_lld_entry_t	*lld_entry = (zbx_lld_entry_t *)lld_entries->values[i];
+		if (SUCCEED == lld_plan_filter_evaluate(&plan, &plan.filter, i, info))
+			rows.values[rows_num++] = i;
+	}
 
-		if (SUCCEED != filter_evaluate(filter, lld_entry, info))
-			continue;
+	rows.values_num = rows_num;
+
+	for (int i = 0; i < plan.overrides_num; i++)
+		lld_plan_evaluate_columns(&plan, &plan.overrides[i], &rows);
+
+	zbx_vector_lld_row_ptr_reserve(lld_rows, (size_t)rows.values_num);
+
+	for (int i = 0; i < rows.values_num; i++)
+	{
+		zbx_lld_entry_t	*lld_entry = (zbx_lld_entry_t *)lld_entries->values[rows.values[i]];
 
 		lld_row = (zbx_lld_row_t *)zbx_malloc(NULL, sizeof(zbx_lld_row_t));
 		zbx_vector_lld_row_ptr_append(lld_rows, lld_row);
@@ -1012,7 +1383,7 @@ static int	lld_rows_get(zbx_vector_lld_entry_ptr_t *lld_entries, zbx_lld_filter_
 		{
 			zbx_lld_override_t	*override = overrides->values[j];
 
-			if (SUCCEED != filter_evaluate(&override->filter, lld_entry, info))
+			if (SUCCEED != lld_plan_filter_evaluate(&plan, &plan.overrides[j], rows.values[i], info))
 				continue;
 
 			zbx_vector_lld_override_ptr_append(&lld_row->overrides, override);
@@ -1024,6 +1395,12 @@ static int	lld_rows_get(zbx_vector_lld_entry_ptr_t *lld_entries, zbx_lld_filter_
 #undef OVERRIDE_STOP_TRUE
 	}
 
+	zabbix_log(LOG_LEVEL_DEBUG, "%s() conditions:%d rows:%d", __func__, plan.columns.values_num,
+			lld_rows->values_num);
+
+	zbx_vector_int32_destroy(&rows);
+	lld_plan_clear(&plan);
+
 	ret = SUCCEED;
 
 	if (SUCCEED == ZBX_CHECK_LOG_LEVEL(LOG_LEVEL_TRACE))
@@ -1056,6 +1433,11 @@ static int	lld_rows_get(zbx_vector_lld_entry_ptr_t *lld_entries, zbx_lld_filter_
 	return ret;
 }
 
+#undef ZBX_LLD_CONDITION_UNDEFINED
+#undef ZBX_LLD_CONDITION_FALSE
+#undef ZBX_LLD_CONDITION_TRUE
+#undef ZBX_LLD_CONDITION_UNKNOWN
+
 void	lld_item_link_free(zbx_lld_item_link_t *item_link)
 {
 	zbx_free(item_link);
@@ -1093,6 +1475,24 @@ static void	lld_lifetime_init(zbx_lld_lifetime_t *lifetime, const char *key, zbx
 	zbx_free(duration_res);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: limits period to skip unchanged LLD values by lost resource       *
+ *          lifetime                                                          *
+ *                                                                            *
+ * Comments: Lost resources are removed or disabled only when LLD value is    *
+ *           processed, so unchanged values must not be skipped for longer    *
+ *           than lost resources are kept.                                    *
+ *                                                                            *
+ ******************************************************************************/
+static int	lld_lifetime_limit_ttl(const zbx_lld_lifetime_t *lifetime, int ttl)
+{
+	if (ZBX_LLD_LIFETIME_TYPE_AFTER == lifetime->type && lifetime->duration < ttl)
+		return lifetime->duration;
+
+	return ttl;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: adds or updates items, triggers and graphs for discovery item     *
@@ -1102,9 +1502,12 @@ static void	lld_lifetime_init(zbx_lld_lifetime_t *lifetime, const char *key, zbx
  *             error       - [OUT] Error or informational message. Will be    *
  *                               set to empty string on successful discovery  *
  *                               without additional information.              *
+ *             skip_ttl    - [OUT] period in seconds during which the same    *
+ *                               value can be skipped without processing      *
  *                                                                            *
  ******************************************************************************/
-int	lld_process_discovery_rule(zbx_dc_item_t *item, zbx_vector_lld_entry_ptr_t *lld_entries, char **error)
+int	lld_process_discovery_rule(zbx_dc_item_t *item, zbx_vector_lld_entry_ptr_t *lld_entries, char **error,
+		int *skip_ttl)
 {
 	zbx_db_result_t			result;
 	zbx_db_row_t			row;
@@ -1122,6 +1525,8 @@ int	lld_process_discovery_rule(zbx_dc_item_t *item, zbx_vector_lld_entry_ptr_t *
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() itemid:" ZBX_FS_UI64, __func__, item->itemid);
 
+	*skip_ttl = 0;
+
 	um_handle = zbx_dc_open_user_macros();
 	zbx_config_get(&cfg, ZBX_CONFIG_FLAGS_AUDITLOG_ENABLED | ZBX_CONFIG_FLAGS_AUDITLOG_MODE);
 
@@ -1147,6 +1552,9 @@ int	lld_process_discovery_rule(zbx_dc_item_t *item, zbx_vector_lld_entry_ptr_t *
 		filter.expression = zbx_strdup(NULL, row[3]);
 		lld_lifetime_init(&lifetime, discovery_key, hostid, atoi(row[4]), row[5], um_handle);
 		lld_lifetime_init(&enabled_lifetime, discovery_key, hostid, atoi(row[6]), row[7], um_handle);
+
+		*skip_ttl = lld_lifetime_limit_ttl(&lifetime, lld_lifetime_limit_ttl(&enabled_lifetime,
+				ZBX_LLD_SKIP_TTL_MAX));
 	}
 	zbx_db_free_result(result);
 
@@ -104,6 +104,7 @@ int	lld_extract_entries(zbx_hashset_t *entries, zbx_vector_lld_entry_ptr_t *entr
 		const zbx_jsonobj_t *lld_obj, const zbx_vector_lld_macro_path_ptr_t *lld_macro_paths, char **error);
 void	lld_free_entries(zbx_hashset_t *entries);
 int	lld_compare_entries(const zbx_hashset_t *entries1, const zbx_hashset_t *entries2);
+void	lld_entries_get_digest(const zbx_hashset_t *entries, unsigned char *digest);
 
 int	lld_macro_value_by_name(const zbx_lld_entry_t *lld_obj, const char *macro, char **value);
 void	lld_macro_clear(zbx_lld_macro_t *macro);
@@ -121,6 +122,10 @@ typedef struct
 }
 zbx_lld_lifetime_t;
 
+/* the maximum period to skip unchanged LLD values, limits the delay of applying configuration changes */
+/* that are not tracked by configuration cache revisions (filter conditions, overrides, LLD macro paths) */
+#define ZBX_LLD_SKIP_TTL_MAX	SEC_PER_HOUR
+
 typedef struct
 {
 	const zbx_lld_entry_t		*data;
@@ -467,7 +472,8 @@ typedef void	(*object_audit_entry_update_status_f)(int audit_context_mode, zbx_u
 		int status_old, int status_new);
 typedef unsigned char	(get_object_status_val)(int status);
 
-int	lld_process_discovery_rule(zbx_dc_item_t *item, zbx_vector_lld_entry_ptr_t *lld_entries, char **error);
+int	lld_process_discovery_rule(zbx_dc_item_t *item, zbx_vector_lld_entry_ptr_t *lld_entries, char **error,
+		int *skip_ttl);
 
 /* discovered resource tracking (*_discovery tables) */
 typedef struct
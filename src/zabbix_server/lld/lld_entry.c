@@ -18,6 +18,7 @@
 #include "zbxjson.h"
 #include "zbxexpr.h"
 #include "zbxstr.h"
+#include "zbxhash.h"
 
 ZBX_VECTOR_IMPL(lld_macro, zbx_lld_macro_t)
 
@@ -266,6 +267,58 @@ int	lld_compare_entries(const zbx_hashset_t *entries1, const zbx_hashset_t *entr
 	return SUCCEED;
 }
 
+static int	lld_digest_compare(const void *d1, const void *d2)
+{
+	return memcmp(d1, d2, ZBX_MD5_DIGEST_SIZE);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: calculate digest of lld entries                                   *
+ *                                                                            *
+ * Parameters: entries - [IN] lld entries                                     *
+ *             digest  - [OUT] entries digest (ZBX_MD5_DIGEST_SIZE bytes)     *
+ *                                                                            *
+ * Comments: The digest does not depend on entry order, so two sets of        *
+ *           entries having the same digest are equal according to            *
+ *           lld_compare_entries().                                           *
+ *                                                                            *
+ ******************************************************************************/
+void	lld_entries_get_digest(const zbx_hashset_t *entries, unsigned char *digest)
+{
+	zbx_hashset_const_iter_t	iter;
+	const zbx_lld_entry_t		*entry;
+	md5_state_t			state;
+	unsigned char			*digests;
+	int				num = 0;
+
+	digests = (unsigned char *)zbx_malloc(NULL, (size_t)(entries->num_data + 1) * ZBX_MD5_DIGEST_SIZE);
+
+	zbx_hashset_const_iter_reset(entries, &iter);
+	while (NULL != (entry = (zbx_lld_entry_t *)zbx_hashset_const_iter_next(&iter)))
+	{
+		zbx_md5_init(&state);
+
+		for (int i = 0; i < entry->macros.values_num; i++)
+		{
+			const zbx_lld_macro_t	*macro = &entry->macros.values[i];
+
+			zbx_md5_append(&state, (const md5_byte_t *)macro->macro, (int)strlen(macro->macro) + 1);
+			zbx_md5_append(&state, (const md5_byte_t *)macro->value, (int)strlen(macro->value) + 1);
+		}
+
+		zbx_md5_finish(&state, digests + num++ * ZBX_MD5_DIGEST_SIZE);
+	}
+
+	qsort(digests, (size_t)num, ZBX_MD5_DIGEST_SIZE, lld_digest_compare);
+
+	zbx_md5_init(&state);
+	zbx_md5_append(&state, digests, num * ZBX_MD5_DIGEST_SIZE);
+	zbx_md5_finish(&state, digest);
+
+	zbx_free(digests);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: print entry contents as comma delimited macro:value string        *
@@ -13,6 +13,7 @@
 **/
 
 #include "lld_manager.h"
+#include "lld.h"
 
 #include "lld_protocol.h"
 
@@ -24,6 +25,8 @@
 #include "zbxipcservice.h"
 #include "zbxstr.h"
 #include "zbxtime.h"
+#include "zbxhash.h"
+#include "zbxcacheconfig.h"
 
 /*
  * The LLD queue is organized as a queue (rule_queue binary heap) of LLD rules,
@@ -38,15 +41,39 @@
  * values in the list the rule is removed from the index (rule_index hashset),
  * otherwise the rule is enqueued back in LLD queue.
  *
+ * Workers report digests of successfully processed values. If the next value of
+ * the same LLD rule has the same digest it is flushed without processing. The
+ * digest is valid while the configuration revision of LLD rule (covering the
+ * rule, its item prototypes, host, user macros and global regular expressions)
+ * is the same as when the value processing started, and no longer than the
+ * period reported by worker. The period is limited by lost resource lifetimes
+ * of LLD rule, so that lost resources are removed in time, and by
+ * ZBX_LLD_SKIP_TTL_MAX to apply configuration changes not tracked by revisions.
+ *
  */
 
 typedef struct
 {
 	zbx_ipc_client_t	*client;
 	zbx_lld_rule_t		*rule;
+	unsigned char		digest[ZBX_MD5_DIGEST_SIZE];	/* digest of the value being processed */
+	unsigned char		digest_set;
+	unsigned char		skip;				/* value is flushed without processing */
+	zbx_uint64_t		revision;			/* LLD rule configuration revision */
+								/* when value processing started   */
 }
 zbx_lld_worker_t;
 
+/* digest of the last successfully processed LLD rule value */
+typedef struct
+{
+	zbx_uint64_t	itemid;
+	unsigned char	digest[ZBX_MD5_DIGEST_SIZE];
+	zbx_uint64_t	revision;	/* LLD rule configuration revision the value was processed with */
+	time_t		expires;	/* time until the same value can be skipped                     */
+}
+zbx_lld_digest_t;
+
 ZBX_PTR_VECTOR_DECL(lld_worker_ptr, zbx_lld_worker_t*)
 ZBX_PTR_VECTOR_IMPL(lld_worker_ptr, zbx_lld_worker_t*)
 
@@ -73,6 +100,8 @@ typedef struct
 	/* the number of queued LLD rules */
 	zbx_uint64_t			queued_num;
 
+	/* digests of the last processed LLD rule values, indexed by itemids */
+	zbx_hashset_t			digests;
 }
 zbx_lld_manager_t;
 
@@ -152,12 +181,17 @@ static void	lld_manager_init(zbx_lld_manager_t *manager, zbx_get_config_forks_f
 		worker = (zbx_lld_worker_t *)zbx_malloc(NULL, sizeof(zbx_lld_worker_t));
 
 		worker->client = NULL;
+		worker->rule = NULL;
+		worker->digest_set = 0;
+		worker->skip = 0;
 
 		zbx_vector_lld_worker_ptr_append(&manager->workers, worker);
 	}
 
 	manager->queued_num = 0;
 
+	zbx_hashset_create(&manager->digests, 0, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
 
@@ -333,6 +367,11 @@ static void	lld_process_next_request(zbx_lld_manager_t *manager, zbx_lld_worker_
 	zbx_binary_heap_remove_min(&manager->rule_queue);
 
 	data = worker->rule->head;
+
+	worker->digest_set = 0;
+	worker->skip = 0;
+	worker->revision = zbx_dc_get_lld_rule_revision(data->itemid);
+
 	buf_len = zbx_lld_serialize_item_value(&buf, data->itemid, 0, data->value, &data->ts, data->meta,
 			data->lastlogsize, data->mtime, data->error);
 	zbx_ipc_client_send(worker->client, ZBX_IPC_LLD_PREPARE_VALUE, buf, buf_len);
@@ -357,15 +396,84 @@ static void	lld_process_queue(zbx_lld_manager_t *manager)
 	}
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: updates digest of the last processed LLD rule value               *
+ *                                                                            *
+ * Parameters: manager - [IN/OUT]                                             *
+ *             worker  - [IN] worker that processed the value                 *
+ *             itemid  - [IN] LLD rule identifier                             *
+ *             message - [IN] worker 'done' response                          *
+ *                                                                            *
+ * Comments: The digest is stored with LLD rule configuration revision from   *
+ *           the start of value processing, so configuration changes made     *
+ *           during processing invalidate it.                                 *
+ *                                                                            *
+ ******************************************************************************/
+static void	lld_update_digest(zbx_lld_manager_t *manager, const zbx_lld_worker_t *worker, zbx_uint64_t itemid,
+		const zbx_ipc_message_t *message)
+{
+	zbx_lld_digest_t	*digest;
+	unsigned char		value_digest[ZBX_MD5_DIGEST_SIZE];
+	int			ttl = 0;
+
+	if (0 != message->size)
+		zbx_lld_deserialize_done(message->data, value_digest, &ttl);
+
+	if (0 >= ttl || 0 == worker->revision)
+	{
+		if (NULL != (digest = (zbx_lld_digest_t *)zbx_hashset_search(&manager->digests, &itemid)))
+			zbx_hashset_remove_direct(&manager->digests, digest);
+
+		return;
+	}
+
+	if (NULL == (digest = (zbx_lld_digest_t *)zbx_hashset_search(&manager->digests, &itemid)))
+	{
+		zbx_lld_digest_t	digest_local = {.itemid = itemid};
+
+		digest = (zbx_lld_digest_t *)zbx_hashset_insert(&manager->digests, &digest_local,
+				sizeof(digest_local));
+	}
+
+	memcpy(digest->digest, value_digest, ZBX_MD5_DIGEST_SIZE);
+	digest->revision = worker->revision;
+	digest->expires = time(NULL) + ttl;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: removes expired digests                                           *
+ *                                                                            *
+ * Parameters: manager - [IN/OUT]                                             *
+ *             now     - [IN] current time                                    *
+ *                                                                            *
+ ******************************************************************************/
+static void	lld_remove_expired_digests(zbx_lld_manager_t *manager, time_t now)
+{
+	zbx_hashset_iter_t	iter;
+	zbx_lld_digest_t	*digest;
+
+	zbx_hashset_iter_reset(&manager->digests, &iter);
+
+	while (NULL != (digest = (zbx_lld_digest_t *)zbx_hashset_iter_next(&iter)))
+	{
+		if (digest->expires <= now)
+			zbx_hashset_iter_remove(&iter);
+	}
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: processes LLD worker 'done' response                              *
  *                                                                            *
  * Parameters: manager - [IN]                                                 *
  *             client  - [IN] worker's IPC client connection                  *
+ *             message - [IN] received message                                *
  *                                                                            *
  ******************************************************************************/
-static void	lld_process_result(zbx_lld_manager_t *manager, zbx_ipc_client_t *client)
+static void	lld_process_result(zbx_lld_manager_t *manager, zbx_ipc_client_t *client,
+		const zbx_ipc_message_t *message)
 {
 	zbx_lld_worker_t	*worker;
 	zbx_lld_rule_t		*rule;
@@ -380,6 +488,10 @@ static void	lld_process_result(zbx_lld_manager_t *manager, zbx_ipc_client_t *cli
 	rule = worker->rule;
 	worker->rule = NULL;
 
+	/* skipped values keep the digest of the last actual processing */
+	if (0 == worker->skip)
+		lld_update_digest(manager, worker, rule->head->itemid, message);
+
 	rule->dup = NULL;
 	data = rule->head;
 	rule->head = rule->head->next;
@@ -428,15 +540,43 @@ static zbx_lld_data_t	*lld_data_get_next_value(zbx_lld_data_t *from, zbx_uint64_
 	return NULL;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if value being processed by worker has the same digest as  *
+ *          the last processed value of LLD rule and LLD rule configuration   *
+ *          has not changed since                                             *
+ *                                                                            *
+ ******************************************************************************/
+static int	lld_value_is_unchanged(const zbx_lld_manager_t *manager, const zbx_lld_worker_t *worker)
+{
+	const zbx_lld_digest_t	*digest;
+
+	if (0 == worker->digest_set)
+		return FAIL;
+
+	if (NULL == (digest = (const zbx_lld_digest_t *)zbx_hashset_search(&manager->digests,
+			&worker->rule->head->itemid)))
+	{
+		return FAIL;
+	}
+
+	if (digest->revision != worker->revision || digest->expires <= time(NULL))
+		return FAIL;
+
+	return 0 == memcmp(digest->digest, worker->digest, ZBX_MD5_DIGEST_SIZE) ? SUCCEED : FAIL;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: processes LLD worker 'next' response                              *
  *                                                                            *
  * Parameters: manager - [IN]                                                 *
  *             client  - [IN] worker's IPC client connection                  *
+ *             message - [IN] received message                                *
  *                                                                            *
  ******************************************************************************/
-static void	lld_process_next(zbx_lld_manager_t *manager, zbx_ipc_client_t *client)
+static void	lld_process_next(zbx_lld_manager_t *manager, zbx_ipc_client_t *client,
+		const zbx_ipc_message_t *message)
 {
 	zbx_lld_worker_t	*worker;
 	zbx_lld_rule_t		*rule;
@@ -449,6 +589,13 @@ static void	lld_process_next(zbx_lld_manager_t *manager, zbx_ipc_client_t *clien
 	zabbix_log(LOG_LEVEL_DEBUG, "discovery rule:" ZBX_FS_UI64 " duplicate check in progress, values:%d",
 			rule->head->itemid, rule->values_num);
 
+	/* digest is sent with the first 'next' response after value preparation */
+	if (ZBX_MD5_DIGEST_SIZE == message->size)
+	{
+		memcpy(worker->digest, message->data, ZBX_MD5_DIGEST_SIZE);
+		worker->digest_set = 1;
+	}
+
 	if (NULL != rule->dup)
 	{
 		/* worker asking for another value after duplicate check  */
@@ -475,7 +622,17 @@ static void	lld_process_next(zbx_lld_manager_t *manager, zbx_ipc_client_t *clien
 
 	if (NULL == (rule->dup = lld_data_get_next_value(rule->head->next, rule->head->itemid)))
 	{
-		zbx_ipc_client_send(client, ZBX_IPC_LLD_PROCESS, NULL, 0);
+		if (SUCCEED == lld_value_is_unchanged(manager, worker))
+		{
+			zabbix_log(LOG_LEVEL_DEBUG, "discovery rule:" ZBX_FS_UI64 " value has not changed",
+					rule->head->itemid);
+
+			worker->skip = 1;
+			zbx_ipc_client_send(client, ZBX_IPC_LLD_PROCESS, &worker->skip, sizeof(worker->skip));
+		}
+		else
+			zbx_ipc_client_send(client, ZBX_IPC_LLD_PROCESS, NULL, 0);
+
 		goto out;
 	}
 
@@ -599,7 +756,7 @@ ZBX_THREAD_ENTRY(lld_manager_thread, args)
 	char			*error = NULL;
 	zbx_ipc_client_t	*client;
 	zbx_ipc_message_t	*message;
-	double			time_stat, time_now, sec, time_idle = 0;
+	double			time_stat, time_now, sec, time_idle = 0, time_cleanup;
 	zbx_lld_manager_t	manager;
 	zbx_uint64_t		processed_num = 0;
 	zbx_timespec_t		timeout = {1, 0};
@@ -626,6 +783,7 @@ ZBX_THREAD_ENTRY(lld_manager_thread, args)
 
 	/* initialize statistics */
 	time_stat = zbx_time();
+	time_cleanup = time_stat;
 
 	zbx_setproctitle("%s #%d started", get_process_type_string(process_type), process_num);
 
@@ -647,6 +805,12 @@ ZBX_THREAD_ENTRY(lld_manager_thread, args)
 			processed_num = 0;
 		}
 
+		if (ZBX_LLD_SKIP_TTL_MAX < time_now - time_cleanup)
+		{
+			lld_remove_expired_digests(&manager, (time_t)time_now);
+			time_cleanup = time_now;
+		}
+
 		zbx_update_selfmon_counter(info, ZBX_PROCESS_STATE_IDLE);
 		ret = zbx_ipc_service_recv(&lld_service, &timeout, &client, &message);
 		zbx_update_selfmon_counter(info, ZBX_PROCESS_STATE_BUSY);
@@ -669,11 +833,11 @@ ZBX_THREAD_ENTRY(lld_manager_thread, args)
 					lld_process_queue(&manager);
 					break;
 				case ZBX_IPC_LLD_DONE:
-					lld_process_result(&manager, client);
+					lld_process_result(&manager, client, message);
 					processed_num++;
 					break;
 				case ZBX_IPC_LLD_NEXT:
-					lld_process_next(&manager, client);
+					lld_process_next(&manager, client, message);
 					break;
 				case ZBX_IPC_LLD_QUEUE:
 					zbx_ipc_client_send(client, message->code, (unsigned char *)&manager.queued_num,
@@ -17,6 +17,7 @@
 #include "zbxserialize.h"
 #include "zbxipcservice.h"
 #include "zbxsysinfo.h"
+#include "zbxhash.h"
 
 zbx_uint32_t	zbx_lld_serialize_item_value(unsigned char **data, zbx_uint64_t itemid, zbx_uint64_t hostid,
 		const char *value, const zbx_timespec_t *ts, unsigned char meta, zbx_uint64_t lastlogsize, int mtime,
@@ -103,6 +104,25 @@ void	zbx_lld_deserialize_value(const unsigned char *data, char **value)
 }
 
 
+zbx_uint32_t	zbx_lld_serialize_done(unsigned char **data, const unsigned char *digest, int ttl)
+{
+	zbx_uint32_t	data_len = ZBX_MD5_DIGEST_SIZE;
+
+	zbx_serialize_prepare_value(data_len, ttl);
+	*data = (unsigned char *)zbx_malloc(NULL, data_len);
+
+	memcpy(*data, digest, ZBX_MD5_DIGEST_SIZE);
+	(void)zbx_serialize_value(*data + ZBX_MD5_DIGEST_SIZE, ttl);
+
+	return data_len;
+}
+
+void	zbx_lld_deserialize_done(const unsigned char *data, unsigned char *digest, int *ttl)
+{
+	memcpy(digest, data, ZBX_MD5_DIGEST_SIZE);
+	(void)zbx_deserialize_value(data + ZBX_MD5_DIGEST_SIZE, ttl);
+}
+
 zbx_uint32_t	zbx_lld_serialize_diag_stats(unsigned char **data, zbx_uint64_t items_num, zbx_uint64_t values_num)
 {
 	unsigned char	*ptr;
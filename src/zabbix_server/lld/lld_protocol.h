@@ -61,6 +61,10 @@ zbx_uint32_t	zbx_lld_serialize_value(unsigned char **data, const char *value);
 
 void	zbx_lld_deserialize_value(const unsigned char *data, char **value);
 
+zbx_uint32_t	zbx_lld_serialize_done(unsigned char **data, const unsigned char *digest, int ttl);
+
+void	zbx_lld_deserialize_done(const unsigned char *data, unsigned char *digest, int *ttl);
+
 zbx_uint32_t	zbx_lld_serialize_diag_stats(unsigned char **data, zbx_uint64_t items_num, zbx_uint64_t values_num);
 
 void	zbx_lld_deserialize_top_items_request(const unsigned char *data, int *limit);
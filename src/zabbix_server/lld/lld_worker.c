@@ -30,6 +30,7 @@
 #include "zbxdb.h"
 #include "zbxdbhigh.h"
 #include "zbxalgo.h"
+#include "zbxhash.h"
 
 typedef struct
 {
@@ -43,6 +44,7 @@ typedef struct
 	zbx_vector_lld_entry_ptr_t	entries_sorted;
 	zbx_vector_lld_macro_path_ptr_t	macro_paths;
 	zbx_jsonobj_t			source;
+	unsigned char			digest[ZBX_MD5_DIGEST_SIZE];
 }
 zbx_lld_value_t;
 
@@ -285,20 +287,62 @@ out:
  *                                                                            *
  * Purpose: process LLD value                                                 *
  *                                                                            *
+ * Parameters: lld_value - [IN] LLD value                                     *
+ *             skip_ttl  - [OUT] period in seconds during which the same      *
+ *                               value can be skipped without processing      *
+ *                                                                            *
+ * Return value: SUCCEED - LLD value was processed without errors or warnings *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
  ******************************************************************************/
-static void	lld_process_value(zbx_lld_value_t *lld_value)
+static int	lld_process_value(zbx_lld_value_t *lld_value, int *skip_ttl)
 {
 	char		*error = NULL;
 	unsigned char	state;
+	int		ret;
 
-	if (SUCCEED == lld_process_discovery_rule(&lld_value->item, &lld_value->entries_sorted, &error))
+	if (SUCCEED == lld_process_discovery_rule(&lld_value->item, &lld_value->entries_sorted, &error, skip_ttl))
 		state = ITEM_STATE_NORMAL;
 	else
 		state = ITEM_STATE_NOTSUPPORTED;
 
 	lld_flush_value(lld_value, state, error);
 
+	ret = (ITEM_STATE_NORMAL == state && '\0' == *ZBX_NULL2EMPTY_STR(error) ? SUCCEED : FAIL);
+
 	zbx_free(error);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: check if LLD rule state allows to skip processing of LLD value    *
+ *          with the same digest as the last processed value                  *
+ *                                                                            *
+ * Comments: Rules with errors or warnings are always processed to update     *
+ *           their state.                                                     *
+ *                                                                            *
+ ******************************************************************************/
+static int	lld_value_is_skippable(const zbx_lld_value_t *lld_value)
+{
+	if (ITEM_STATE_NORMAL != lld_value->item.state || '\0' != *ZBX_NULL2EMPTY_STR(lld_value->item.error))
+		return FAIL;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: flush LLD value without processing when LLD manager reports       *
+ *          that the last value with the same digest was processed recently   *
+ *                                                                            *
+ ******************************************************************************/
+static void	lld_skip_value(zbx_lld_value_t *lld_value)
+{
+	zabbix_log(LOG_LEVEL_DEBUG, "skipped unchanged value for LLD rule " ZBX_FS_UI64, lld_value->item.itemid);
+
+	lld_flush_value(lld_value, ITEM_STATE_NORMAL, NULL);
 }
 
 ZBX_THREAD_ENTRY(lld_worker_thread, args)
@@ -313,6 +357,7 @@ ZBX_THREAD_ENTRY(lld_worker_thread, args)
 				process_num = ((zbx_thread_args_t *)args)->info.process_num;
 	unsigned char		process_type = ((zbx_thread_args_t *)args)->info.process_type;
 	zbx_lld_value_t		lld_value = {0};
+	int			skip_ttl;
 
 	zabbix_log(LOG_LEVEL_INFORMATION, "%s #%d started [%s #%d]", get_program_type_string(info->program_type),
 			server_num, get_process_type_string(process_type), process_num);
@@ -379,7 +424,16 @@ ZBX_THREAD_ENTRY(lld_worker_thread, args)
 				lld_value_init(&lld_value);
 				if (SUCCEED == lld_prepare_value(&message, &lld_value))
 				{
-					zbx_ipc_socket_write(&lld_socket, ZBX_IPC_LLD_NEXT, NULL, 0);
+					lld_entries_get_digest(&lld_value.entries, lld_value.digest);
+
+					/* the digest allows LLD manager to skip unchanged values */
+					if (SUCCEED == lld_value_is_skippable(&lld_value))
+					{
+						zbx_ipc_socket_write(&lld_socket, ZBX_IPC_LLD_NEXT, lld_value.digest,
+								sizeof(lld_value.digest));
+					}
+					else
+						zbx_ipc_socket_write(&lld_socket, ZBX_IPC_LLD_NEXT, NULL, 0);
 				}
 				else
 				{
@@ -405,9 +459,29 @@ ZBX_THREAD_ENTRY(lld_worker_thread, args)
 				}
 				ZBX_FALLTHROUGH;
 			case ZBX_IPC_LLD_PROCESS:
-				lld_process_value(&lld_value);
+				if (ZBX_IPC_LLD_PROCESS == message.code && 0 != message.size && 0 != *message.data)
+				{
+					lld_skip_value(&lld_value);
+					lld_value_clear(&lld_value);
+					zbx_ipc_socket_write(&lld_socket, ZBX_IPC_LLD_DONE, NULL, 0);
+					processed_num++;
+					break;
+				}
+
+				/* the digest is reported only for values processed without errors or warnings */
+				if (SUCCEED == lld_process_value(&lld_value, &skip_ttl))
+				{
+					unsigned char	*data;
+					zbx_uint32_t	data_len;
+
+					data_len = zbx_lld_serialize_done(&data, lld_value.digest, skip_ttl);
+					zbx_ipc_socket_write(&lld_socket, ZBX_IPC_LLD_DONE, data, data_len);
+					zbx_free(data);
+				}
+				else
+					zbx_ipc_socket_write(&lld_socket, ZBX_IPC_LLD_DONE, NULL, 0);
+
 				lld_value_clear(&lld_value);
-				zbx_ipc_socket_write(&lld_socket, ZBX_IPC_LLD_DONE, NULL, 0);
 				processed_num++;
 				break;
 		}
@@ -230,7 +230,7 @@ static int	rtc_process_diaginfo(const char *data, char **result)
 	if (0 == strcmp(buf, "all"))
 	{
 		scope = (1 << ZBX_DIAGINFO_VALUECACHE) | (1 << ZBX_DIAGINFO_LLD) | (1 << ZBX_DIAGINFO_ALERTING) |
-				(1 << ZBX_DIAGINFO_CONNECTOR);
+				(1 << ZBX_DIAGINFO_CONNECTOR) | (1 << ZBX_DIAGINFO_SERVICEMANAGER);
 	}
 	else if (0 == strcmp(buf, ZBX_DIAG_VALUECACHE))
 	{
@@ -252,6 +252,11 @@ static int	rtc_process_diaginfo(const char *data, char **result)
 		scope = 1 << ZBX_DIAGINFO_CONNECTOR;
 		ret = SUCCEED;
 	}
+	else if (0 == strcmp(buf, ZBX_DIAG_SERVICEMANAGER))
+	{
+		scope = 1 << ZBX_DIAGINFO_SERVICEMANAGER;
+		ret = SUCCEED;
+	}
 
 	if (0 != scope)
 		zbx_diag_log_info(scope, result);
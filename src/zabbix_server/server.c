@@ -100,6 +100,7 @@
 #include "zbx_ha_constants.h"
 #include "zbxescalations.h"
 #include "zbxbincommon.h"
+#include "zbxcompress.h"
 
 #ifdef HAVE_LIBCURL
 #	include "zbxcurl.h"
@@ -139,8 +140,9 @@ static const char	*help_message[] = {
 	"      " ZBX_SECRETS_RELOAD "                  Reload secrets from Vault",
 	"      " ZBX_DIAGINFO "=section                Log internal diagnostic information of the",
 	"                                        section (historycache, preprocessing, alerting,",
-	"                                        lld, valuecache, locks, connector) or everything if section is",
-	"                                        not specified",
+	"                                        lld, valuecache, locks, connector, configcache,",
+	"                                        servicemanager) or everything if section is not",
+	"                                        specified",
 	"      " ZBX_HISTORY_CACHE_CLEAR "=target      Clear history cache for item specified by its ID",
 	"      " ZBX_PROF_ENABLE "=target              Enable profiling, affects all processes if",
 	"                                        target is not specified",
@@ -324,6 +326,7 @@ static zbx_uint64_t	config_history_index_cache_size	= 4 * ZBX_MEBIBYTE;
 static zbx_uint64_t	config_trends_cache_size	= 4 * ZBX_MEBIBYTE;
 static zbx_uint64_t	config_trend_func_cache_size	= 4 * ZBX_MEBIBYTE;
 static zbx_uint64_t	config_value_cache_size		= 8 * ZBX_MEBIBYTE;
+static int		config_value_cache_compression	= 0;
 static zbx_uint64_t	config_vmware_cache_size	= 8 * ZBX_MEBIBYTE;
 
 static int	config_unreachable_period		= 45;
@@ -338,6 +341,8 @@ ZBX_GET_CONFIG_VAR(int, zbx_config_log_remote_commands, 0)
 ZBX_GET_CONFIG_VAR(int, zbx_config_unsafe_user_parameters, 0)
 
 static char	*zbx_config_snmptrap_file	= NULL;
+static int	zbx_config_snmptrap_listen_port	= 0;
+static char	*zbx_config_snmptrap_listen_community = NULL;
 static char	*config_java_gateway		= NULL;
 static int	config_java_gateway_port	= ZBX_DEFAULT_GATEWAY_PORT;
 static char	*config_ssh_key_location	= NULL;
@@ -373,8 +378,12 @@ static char	*CONFIG_SOCKET_PATH	= NULL;
 static char	*config_history_storage_url		= NULL;
 static char	*config_history_storage_opts		= NULL;
 static int	config_history_storage_pipelines	= 0;
+static int	config_history_writers			= 0;
+static char	*config_history_storage_path		= NULL;
+static char	*config_history_storage_path_opts	= NULL;
 static char	*config_stats_allowed_ip		= NULL;
 static int	config_tcp_max_backlog_size		= SOMAXCONN;
+static int	config_compression_level		= ZBX_COMPRESS_LEVEL_DEFAULT;
 static char	*zbx_config_webservice_url		= NULL;
 static int	config_service_manager_sync_frequency	= 60;
 static int	config_vps_limit			= 0;
@@ -383,6 +392,7 @@ static char	*config_file				= NULL;
 static int	config_allow_root			= 0;
 static int	config_enable_global_scripts		= 1;
 static int	config_allow_software_update_check	= 1;
+static int	config_connector_compression		= 0;
 static char	*config_sms_devices			= NULL;
 static char	*config_frontend_allowed_ip		= NULL;
 static zbx_config_log_t	log_file_cfg			= {NULL, NULL, ZBX_LOG_TYPE_UNDEFINED, 1};
@@ -679,6 +689,9 @@ static void	zbx_set_defaults(void)
 		config_history_storage_opts = zbx_strdup(config_history_storage_opts, "uint,dbl,str,log,text");
 #endif
 
+	if (NULL == config_history_storage_path_opts)
+		config_history_storage_path_opts = zbx_strdup(config_history_storage_path_opts, "uint,dbl");
+
 #ifdef HAVE_SQLITE3
 	config_max_housekeeper_delete = 0;
 #endif
@@ -924,6 +937,10 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 				ZBX_CONF_PARM_OPT,	1024,			32767},
 		{"SNMPTrapperFile",		&zbx_config_snmptrap_file,		ZBX_CFG_TYPE_STRING,
 				ZBX_CONF_PARM_OPT,	0,			0},
+		{"SNMPTrapperListenPort",	&zbx_config_snmptrap_listen_port,	ZBX_CFG_TYPE_INT,
+				ZBX_CONF_PARM_OPT,	0,			65535},
+		{"SNMPTrapperListenCommunity",	&zbx_config_snmptrap_listen_community,	ZBX_CFG_TYPE_STRING_LIST,
+				ZBX_CONF_PARM_OPT,	0,			0},
 		{"StartSNMPTrapper",		&config_forks[ZBX_PROCESS_TYPE_SNMPTRAPPER],
 											ZBX_CFG_TYPE_INT,
 				ZBX_CONF_PARM_OPT,	0,			1},
@@ -939,6 +956,8 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 				ZBX_CONF_PARM_OPT,	0,			__UINT64_C(2) * ZBX_GIBIBYTE},
 		{"ValueCacheSize",		&config_value_cache_size,		ZBX_CFG_TYPE_UINT64,
 				ZBX_CONF_PARM_OPT,	0,			__UINT64_C(64) * ZBX_GIBIBYTE},
+		{"ValueCacheCompression",	&config_value_cache_compression,	ZBX_CFG_TYPE_INT,
+				ZBX_CONF_PARM_OPT,	0,			1},
 		{"CacheUpdateFrequency",	&config_confsyncer_frequency,		ZBX_CFG_TYPE_INT,
 				ZBX_CONF_PARM_OPT,	1,			SEC_PER_HOUR},
 		{"HousekeepingFrequency",	&config_housekeeping_frequency,		ZBX_CFG_TYPE_INT,
@@ -1034,6 +1053,8 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 				ZBX_CONF_PARM_OPT,	0,			0},
 		{"LogSlowQueries",		&(zbx_db_config->log_slow_queries),	ZBX_CFG_TYPE_INT,
 				ZBX_CONF_PARM_OPT,	0,			3600000},
+		{"DBBulkLoad",			&(zbx_db_config->bulk_load),		ZBX_CFG_TYPE_INT,
+				ZBX_CONF_PARM_OPT,	0,			1},
 		{"StartProxyPollers",		&config_forks[ZBX_PROCESS_TYPE_PROXYPOLLER],
 											ZBX_CFG_TYPE_INT,
 				ZBX_CONF_PARM_OPT,	0,			250},
@@ -1107,6 +1128,12 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 				ZBX_CONF_PARM_OPT,	0,			0},
 		{"HistoryStorageDateIndex",	&config_history_storage_pipelines,	ZBX_CFG_TYPE_INT,
 				ZBX_CONF_PARM_OPT,	0,			1},
+		{"HistoryWriters",		&config_history_writers,		ZBX_CFG_TYPE_INT,
+				ZBX_CONF_PARM_OPT,	0,			5},
+		{"HistoryStoragePath",		&config_history_storage_path,		ZBX_CFG_TYPE_STRING,
+				ZBX_CONF_PARM_OPT,	0,			0},
+		{"HistoryStoragePathTypes",	&config_history_storage_path_opts,	ZBX_CFG_TYPE_STRING_LIST,
+				ZBX_CONF_PARM_OPT,	0,			0},
 		{"ExportDir",			&(zbx_config_export.dir),		ZBX_CFG_TYPE_STRING,
 				ZBX_CONF_PARM_OPT,	0,			0},
 		{"ExportType",			&(zbx_config_export.type),		ZBX_CFG_TYPE_STRING_LIST,
@@ -1134,6 +1161,8 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 				ZBX_CONF_PARM_OPT,	1,			3600},
 		{"ListenBacklog",		&config_tcp_max_backlog_size,		ZBX_CFG_TYPE_INT,
 				ZBX_CONF_PARM_OPT,	0,			INT_MAX},
+		{"CompressionLevel",		&config_compression_level,		ZBX_CFG_TYPE_INT,
+				ZBX_CONF_PARM_OPT,	ZBX_COMPRESS_LEVEL_MIN,	ZBX_COMPRESS_LEVEL_MAX},
 		{"HANodeName",			&CONFIG_HA_NODE_NAME,			ZBX_CFG_TYPE_STRING,
 				ZBX_CONF_PARM_OPT,	0,			0},
 		{"NodeAddress",			&CONFIG_NODE_ADDRESS,			ZBX_CFG_TYPE_STRING,
@@ -1144,6 +1173,8 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 		{"StartConnectors",		&config_forks[ZBX_PROCESS_TYPE_CONNECTORWORKER],
 											ZBX_CFG_TYPE_INT,
 				ZBX_CONF_PARM_OPT,	0,			1000},
+		{"ConnectorCompression",	&config_connector_compression,		ZBX_CFG_TYPE_INT,
+				ZBX_CONF_PARM_OPT,	0,			1},
 		{"StartHTTPAgentPollers",	&config_forks[ZBX_PROCESS_TYPE_HTTPAGENT_POLLER],
 											ZBX_CFG_TYPE_INT,
 				ZBX_CONF_PARM_OPT,	0,			1000},
@@ -1181,6 +1212,7 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 	zbx_parse_cfg_file(config_file, cfg, ZBX_CFG_FILE_REQUIRED, ZBX_CFG_STRICT, ZBX_CFG_EXIT_FAILURE,
 			ZBX_CFG_ENVVAR_USE);
 	zbx_set_defaults();
+	zbx_compress_set_level(config_compression_level);
 
 	log_file_cfg.log_type = zbx_get_log_type(log_file_cfg.log_type_str);
 
@@ -1648,7 +1680,8 @@ static int	server_startup(zbx_socket_t *listen_sock, int *ha_stat, int *ha_failo
 			.config_source_ip = zbx_config_source_ip,
 			.config_ssl_ca_location = config_ssl_ca_location,
 			.config_ssl_cert_location = config_ssl_cert_location,
-			.config_ssl_key_location = config_ssl_key_location
+			.config_ssl_key_location = config_ssl_key_location,
+			.config_max_concurrent_checks_per_poller = config_max_concurrent_checks_per_poller
 		};
 
 	zbx_thread_discoverer_args	discoverer_args =
@@ -1744,7 +1777,8 @@ static int	server_startup(zbx_socket_t *listen_sock, int *ha_stat, int *ha_failo
 			.config_source_ip = zbx_config_source_ip,
 			.config_ssl_ca_location = config_ssl_ca_location,
 			.config_ssl_cert_location = config_ssl_cert_location,
-			.config_ssl_key_location = config_ssl_key_location
+			.config_ssl_key_location = config_ssl_key_location,
+			.config_connector_compression = config_connector_compression
 		};
 
 	zbx_thread_report_manager_args	report_manager_args =
@@ -1800,6 +1834,9 @@ static int	server_startup(zbx_socket_t *listen_sock, int *ha_stat, int *ha_failo
 	zbx_thread_snmptrapper_args	snmptrapper_args =
 		{
 			.config_snmptrap_file = zbx_config_snmptrap_file,
+			.config_snmptrap_listen_port = zbx_config_snmptrap_listen_port,
+			.config_snmptrap_listen_community = zbx_config_snmptrap_listen_community,
+			.progname = zbx_progname,
 			.config_ha_node_name = CONFIG_HA_NODE_NAME
 		};
 
@@ -1834,7 +1871,7 @@ static int	server_startup(zbx_socket_t *listen_sock, int *ha_stat, int *ha_failo
 		return FAIL;
 	}
 
-	if (SUCCEED != zbx_vc_init(config_value_cache_size, &error))
+	if (SUCCEED != zbx_vc_init(config_value_cache_size, config_value_cache_compression, &error))
 	{
 		zabbix_log(LOG_LEVEL_CRIT, "cannot initialize history value cache: %s", error);
 		zbx_free(error);
@@ -2508,7 +2545,8 @@ int	MAIN_ZABBIX_ENTRY(int flags)
 	}
 
 	if (SUCCEED != zbx_history_init(config_history_storage_url, config_history_storage_opts,
-			zbx_db_config->log_slow_queries, &error))
+			config_history_storage_path, config_history_storage_path_opts, zbx_db_config->log_slow_queries,
+			config_history_writers, &error))
 	{
 		zabbix_log(LOG_LEVEL_CRIT, "cannot initialize history storage: %s", error);
 		zbx_free(error);
@@ -50,10 +50,9 @@ void    zbx_service_rule_free(zbx_service_rule_t *service_rule)
 ZBX_PTR_VECTOR_IMPL(service_tag_ptr, zbx_service_tag_t *)
 ZBX_PTR_VECTOR_IMPL(service_action_ptr, zbx_service_action_t *)
 
-ZBX_PTR_VECTOR_DECL(status_update_ptr, zbx_status_update_t *)
 ZBX_PTR_VECTOR_IMPL(status_update_ptr, zbx_status_update_t *)
 
-static void	zbx_status_update_free(zbx_status_update_t *status_update)
+void	zbx_status_update_free(zbx_status_update_t *status_update)
 {
 	zbx_free(status_update);
 }
@@ -102,9 +101,6 @@ typedef struct
 	zbx_uint64_t				serviceid;
 	zbx_vector_service_problem_ptr_t	service_problems;
 	zbx_vector_service_problem_ptr_t	service_problems_recovered;
-#define ZBX_FLAG_SERVICE_UPDATE			0x00
-#define ZBX_FLAG_SERVICE_RECALCULATE		0x01
-#define ZBX_FLAG_SERVICE_RECALCULATE_SUPPRESS	0x04
 	int					flags;
 }
 zbx_services_diff_t;
@@ -127,6 +123,9 @@ typedef struct
 	zbx_hashset_t	action_conditions;
 
 	char		*severities[TRIGGER_SEVERITY_COUNT];
+
+	zbx_service_diag_stats_t	stats;
+	double				batch_clock;	/* timestamp of the oldest event in current batch */
 }
 zbx_service_manager_t;
 
@@ -1996,60 +1995,192 @@ void	service_get_rootcause_eventids(const zbx_service_t *parent, zbx_vector_uint
 	zbx_vector_uint64_uniq(eventids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 }
 
+#define ZBX_SERVICE_LEVEL_UNKNOWN	-1
+#define ZBX_SERVICE_LEVEL_PENDING	-2
+
+static int	service_calculate_level(zbx_service_t *service)
+{
+	int	level = 0;
+
+	if (0 <= service->level)
+		return service->level;
+
+	/* circular service dependency, cannot be created from frontend */
+	if (ZBX_SERVICE_LEVEL_PENDING == service->level)
+		return 0;
+
+	service->level = ZBX_SERVICE_LEVEL_PENDING;
+
+	for (int i = 0; i < service->children.values_num; i++)
+	{
+		int	child_level;
+
+		if (level <= (child_level = service_calculate_level(service->children.values[i])))
+			level = child_level + 1;
+	}
+
+	service->level = level;
+
+	return level;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: calculates service levels - the longest path from service to a    *
+ *          leaf service                                                      *
+ *                                                                            *
+ * Parameters: services - [IN/OUT]                                            *
+ *                                                                            *
+ * Comments: Services without children have level 0. Parent service level is  *
+ *           always greater than the levels of its children.                  *
+ *                                                                            *
+ ******************************************************************************/
+void	service_update_levels(zbx_hashset_t *services)
+{
+	zbx_hashset_iter_t	iter;
+	zbx_service_t		*service;
+
+	zbx_hashset_iter_reset(services, &iter);
+	while (NULL != (service = (zbx_service_t *)zbx_hashset_iter_next(&iter)))
+		service->level = ZBX_SERVICE_LEVEL_UNKNOWN;
+
+	zbx_hashset_iter_reset(services, &iter);
+	while (NULL != (service = (zbx_service_t *)zbx_hashset_iter_next(&iter)))
+		(void)service_calculate_level(service);
+}
+
+#undef ZBX_SERVICE_LEVEL_UNKNOWN
+#undef ZBX_SERVICE_LEVEL_PENDING
+
+static int	service_dirty_compare(const void *d1, const void *d2)
+{
+	const zbx_binary_heap_elem_t	*e1 = (const zbx_binary_heap_elem_t *)d1;
+	const zbx_binary_heap_elem_t	*e2 = (const zbx_binary_heap_elem_t *)d2;
+	const zbx_service_dirty_t	*s1 = (const zbx_service_dirty_t *)e1->data;
+	const zbx_service_dirty_t	*s2 = (const zbx_service_dirty_t *)e2->data;
+
+	ZBX_RETURN_IF_NOT_EQUAL(s1->service->level, s2->service->level);
+
+	return 0;
+}
+
+void	services_dirty_init(zbx_services_dirty_t *dirty)
+{
+	zbx_hashset_create(&dirty->services, 100, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	zbx_binary_heap_create(&dirty->queue, service_dirty_compare, ZBX_BINARY_HEAP_OPTION_EMPTY);
+	dirty->evaluated_num = 0;
+}
+
+void	services_dirty_destroy(zbx_services_dirty_t *dirty)
+{
+	zbx_binary_heap_destroy(&dirty->queue);
+	zbx_hashset_destroy(&dirty->services);
+}
+
 /******************************************************************************
  *                                                                            *
- * Purpose: updates service and its parents statuses                          *
+ * Purpose: queues parent services for status recalculation                   *
+ *                                                                            *
+ * Parameters: dirty   - [IN/OUT] services queued for recalculation           *
+ *             service - [IN] updated service                                 *
+ *             ts      - [IN] update timestamp                                *
+ *             flags   - [IN]                                                 *
+ *                                                                            *
+ * Comments: Parent queued by several children is recalculated once, with     *
+ *           the latest update timestamp.                                     *
  *                                                                            *
- * Parameters: itservice       - [IN] service to update                       *
- *             ts              - [IN] update timestamp                        *
+ ******************************************************************************/
+void	service_queue_parents(zbx_services_dirty_t *dirty, const zbx_service_t *service,
+		const zbx_timespec_t *ts, int flags)
+{
+	for (int i = 0; i < service->parents.values_num; i++)
+	{
+		zbx_service_t		*parent = service->parents.values[i];
+		zbx_service_dirty_t	service_dirty_local = {.serviceid = parent->serviceid}, *service_dirty;
+		zbx_binary_heap_elem_t	elem;
+
+		if (NULL != (service_dirty = (zbx_service_dirty_t *)zbx_hashset_search(&dirty->services,
+				&service_dirty_local)))
+		{
+			/* already recalculated parent can be queued again only by circular dependency */
+			if (0 != service_dirty->processed)
+				continue;
+
+			if (0 > zbx_timespec_compare(&service_dirty->ts, ts))
+				service_dirty->ts = *ts;
+
+			service_dirty->flags |= flags;
+			continue;
+		}
+
+		service_dirty_local.service = parent;
+		service_dirty_local.ts = *ts;
+		service_dirty_local.flags = flags;
+		service_dirty_local.processed = 0;
+
+		service_dirty = (zbx_service_dirty_t *)zbx_hashset_insert(&dirty->services, &service_dirty_local,
+				sizeof(service_dirty_local));
+
+		elem.key = parent->serviceid;
+		elem.data = service_dirty;
+		zbx_binary_heap_insert(&dirty->queue, &elem);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: updates statuses of queued services                               *
+ *                                                                            *
+ * Parameters: dirty           - [IN/OUT] services queued for recalculation   *
  *             alarms          - [OUT] alarms update queue                    *
  *             service_updates - [IN/OUT]                                     *
- *             flags           - [IN]                                         *
- *                                                                            *
  *                                                                            *
  * Comments: This function recalculates service status according to the       *
  *           algorithm and status of the children services. If the status     *
  *           has been changed, an alarm is generated and parent services      *
- *           (up until the root service) are updated too.                     *
+ *           (up until the root service) are queued too. Services are         *
+ *           processed in the order of their level, so every service is       *
+ *           recalculated once per batch after all its updated children.      *
  *                                                                            *
  ******************************************************************************/
-static void	its_itservice_update_status(zbx_service_t *itservice, const zbx_timespec_t *ts,
-		zbx_vector_status_update_ptr_t *alarms, zbx_hashset_t *service_updates, int flags)
+void	its_itservices_update_status(zbx_services_dirty_t *dirty, zbx_vector_status_update_ptr_t *alarms,
+		zbx_hashset_t *service_updates)
 {
-	int	status, rule_status;
-
-	status = service_get_main_status(itservice);
-
-	for (int i = 0; i < itservice->status_rules.values_num; i++)
+	while (SUCCEED != zbx_binary_heap_empty(&dirty->queue))
 	{
-		zbx_service_rule_t	*rule = itservice->status_rules.values[i];
+		zbx_service_dirty_t	*service_dirty;
+		zbx_service_t		*itservice;
+		int			status, rule_status;
 
-		if (status < (rule_status = service_get_rule_status(itservice, rule)))
-			status = rule_status;
-	}
+		service_dirty = (zbx_service_dirty_t *)zbx_binary_heap_find_min(&dirty->queue)->data;
+		zbx_binary_heap_remove_min(&dirty->queue);
 
-	if (itservice->status != status)
-	{
-		zbx_service_update_t	*update;
+		service_dirty->processed = 1;
+		dirty->evaluated_num++;
+		itservice = service_dirty->service;
 
-		update = update_service(service_updates, itservice, status, ts);
-		update->alarm = its_updates_append(alarms, itservice->serviceid, status, ts->sec);
+		status = service_get_main_status(itservice);
 
-		/* update parent services */
-		for (int i = 0; i < itservice->parents.values_num; i++)
+		for (int i = 0; i < itservice->status_rules.values_num; i++)
 		{
-			its_itservice_update_status(itservice->parents.values[i], ts, alarms,
-					service_updates, flags);
+			zbx_service_rule_t	*rule = itservice->status_rules.values[i];
+
+			if (status < (rule_status = service_get_rule_status(itservice, rule)))
+				status = rule_status;
 		}
-	}
-	else if (0 != (ZBX_FLAG_SERVICE_RECALCULATE & flags))
-	{
-		/* update parent services */
-		for (int i = 0; i < itservice->parents.values_num; i++)
+
+		if (itservice->status != status)
 		{
-			its_itservice_update_status((zbx_service_t *)itservice->parents.values[i], ts, alarms,
-					service_updates, flags);
+			zbx_service_update_t	*update;
+
+			update = update_service(service_updates, itservice, status, &service_dirty->ts);
+			update->alarm = its_updates_append(alarms, itservice->serviceid, status,
+					service_dirty->ts.sec);
+
+			service_queue_parents(dirty, itservice, &service_dirty->ts, service_dirty->flags);
 		}
+		else if (0 != (ZBX_FLAG_SERVICE_RECALCULATE & service_dirty->flags))
+			service_queue_parents(dirty, itservice, &service_dirty->ts, service_dirty->flags);
 	}
 }
 
@@ -2566,6 +2697,49 @@ static int	service_update_compare_func(const void *d1, const void *d2)
 	return 0;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: updates service manager statistics after update batch             *
+ *                                                                            *
+ * Parameters: manager       - [IN/OUT]                                       *
+ *             evaluated_num - [IN] number of services evaluated              *
+ *             updates_num   - [IN] number of services with changed status    *
+ *             recalc_time   - [IN] time spent recalculating statuses         *
+ *             db_time       - [IN] time spent writing changes to database    *
+ *                                                                            *
+ * Comments: Lag is the time between the oldest event of the batch and the    *
+ *           moment when service statuses were written to database.           *
+ *                                                                            *
+ ******************************************************************************/
+static void	service_manager_update_stats(zbx_service_manager_t *manager, int evaluated_num, int updates_num,
+		double recalc_time, double db_time)
+{
+	zbx_service_diag_stats_t	*stats = &manager->stats;
+
+	stats->batches_num++;
+	stats->evaluated_num += (zbx_uint64_t)evaluated_num;
+	stats->updates_num += (zbx_uint64_t)updates_num;
+	stats->recalc_time += recalc_time;
+	stats->db_time += db_time;
+
+	if (0 != manager->batch_clock)
+	{
+		double	lag = zbx_time() - manager->batch_clock;
+
+		if (0 > lag)
+			lag = 0;
+
+		stats->lag_last = lag;
+		stats->lag_total += lag;
+		stats->lag_num++;
+
+		if (stats->lag_max < lag)
+			stats->lag_max = lag;
+
+		manager->batch_clock = 0;
+	}
+}
+
 static void	db_update_services(zbx_service_manager_t *manager)
 {
 	zbx_hashset_iter_t			iter;
@@ -2574,9 +2748,14 @@ static void	db_update_services(zbx_service_manager_t *manager)
 	zbx_vector_service_problem_ptr_t	service_problems_new;
 	zbx_vector_uint64_t			service_problemids;
 	zbx_hashset_t				service_updates;
+	zbx_services_dirty_t			dirty;
+	double					time_start, time_db;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
+	time_start = zbx_time();
+
+	services_dirty_init(&dirty);
 	zbx_vector_status_update_ptr_create(&alarms);
 	zbx_vector_service_problem_ptr_create(&service_problems_new);
 	zbx_vector_uint64_create(&service_problemids);
@@ -2704,24 +2883,17 @@ static void	db_update_services(zbx_service_manager_t *manager)
 			update = update_service(&service_updates, service, status, &ts);
 			update->alarm = its_updates_append(&alarms, service->serviceid, service->status, ts.sec);
 
-			/* update parent services */
-			for (int i = 0; i < service->parents.values_num; i++)
-			{
-				its_itservice_update_status((zbx_service_t *)service->parents.values[i], &ts, &alarms,
-						&service_updates, service_diff->flags);
-			}
+			service_queue_parents(&dirty, service, &ts, service_diff->flags);
 		}
 		else if (0 != (ZBX_FLAG_SERVICE_RECALCULATE & service_diff->flags))
-		{
-			/* update parent services */
-			for (int i = 0; i < service->parents.values_num; i++)
-			{
-				its_itservice_update_status((zbx_service_t *)service->parents.values[i], &ts, &alarms,
-						&service_updates, service_diff->flags);
-			}
-		}
+			service_queue_parents(&dirty, service, &ts, service_diff->flags);
 	}
 
+	/* update parent services */
+	its_itservices_update_status(&dirty, &alarms, &service_updates);
+
+	time_db = zbx_time();
+
 	do
 	{
 		zbx_db_begin();
@@ -2732,6 +2904,10 @@ static void	db_update_services(zbx_service_manager_t *manager)
 	}
 	while (ZBX_DB_DOWN == zbx_db_commit());
 
+	service_manager_update_stats(manager, manager->service_diffs.num_data + dirty.evaluated_num,
+			service_updates.num_data, time_db - time_start, zbx_time() - time_db);
+
+	services_dirty_destroy(&dirty);
 	zbx_vector_uint64_destroy(&service_problemids);
 	zbx_vector_service_problem_ptr_destroy(&service_problems_new);
 	zbx_hashset_destroy(&service_updates);
@@ -2961,6 +3137,7 @@ static void	process_events(zbx_vector_events_ptr_t *events, zbx_service_manager_
 	for (int i = 0; i < events->values_num; i++)
 	{
 		zbx_event_t	*event, **ptr;
+		double		clock;
 
 		event = (zbx_event_t *)events->values[i];
 
@@ -2971,6 +3148,11 @@ static void	process_events(zbx_vector_events_ptr_t *events, zbx_service_manager_
 			continue;
 		}
 
+		clock = event->clock + event->ns / 1e9;
+
+		if (0 == service_manager->batch_clock || clock < service_manager->batch_clock)
+			service_manager->batch_clock = clock;
+
 		switch (event->value)
 		{
 			case TRIGGER_VALUE_OK:
@@ -3239,6 +3421,25 @@ out:
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s() severities_num:%d", __func__, severities_num);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: sends service manager diagnostic statistics                       *
+ *                                                                            *
+ ******************************************************************************/
+static void	process_diag_stats(zbx_service_manager_t *service_manager, zbx_ipc_client_t *client)
+{
+	unsigned char	*data = NULL;
+	zbx_uint32_t	data_len;
+
+	service_manager->stats.services_num = (zbx_uint64_t)service_manager->services.num_data;
+	service_manager->stats.problems_num = (zbx_uint64_t)service_manager->problem_events.num_data;
+
+	data_len = zbx_service_serialize_diag_stats(&data, &service_manager->stats);
+	zbx_ipc_client_send(client, ZBX_IPC_SERVICE_SERVICE_DIAG_STATS, data, data_len);
+
+	zbx_free(data);
+}
+
 static void	service_manager_create_event_cache(zbx_service_manager_t *service_manager)
 {
 	zbx_hashset_create_ext(&service_manager->problem_events, 1000, default_uint64_ptr_hash_func,
@@ -3303,6 +3504,8 @@ static void	service_manager_init(zbx_service_manager_t *service_manager)
 			ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC, ZBX_DEFAULT_MEM_FREE_FUNC);
 
 	memset(&service_manager->severities, 0, sizeof(service_manager->severities));
+	memset(&service_manager->stats, 0, sizeof(service_manager->stats));
+	service_manager->batch_clock = 0;
 }
 
 static void	service_manager_free(zbx_service_manager_t *service_manager)
@@ -3643,6 +3846,8 @@ ZBX_THREAD_ENTRY(service_manager_thread, args)
 			}
 			while (ZBX_DB_DOWN == zbx_db_commit());
 
+			service_update_levels(&service_manager.services);
+
 			if (0 != updated)
 				recalculate_services(&service_manager);
 
@@ -3718,6 +3923,9 @@ ZBX_THREAD_ENTRY(service_manager_thread, args)
 				case ZBX_IPC_SERVICE_EVENT_SEVERITIES:
 					process_event_severities(message, &service_manager);
 					break;
+				case ZBX_IPC_SERVICE_SERVICE_DIAG_STATS:
+					process_diag_stats(&service_manager, client);
+					break;
 				case ZBX_IPC_SERVICE_RELOAD_CACHE:
 					if (0 != service_cache_reload_requested)
 					{
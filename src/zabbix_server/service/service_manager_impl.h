@@ -108,6 +108,8 @@ struct zbx_service_s
 	int					weight;
 	int					propagation_rule;
 	int					propagation_value;
+	/* the longest path to a leaf service, children are always recalculated before parents */
+	int					level;
 };
 
 /* status update queue items */
@@ -124,6 +126,10 @@ typedef struct
 }
 zbx_status_update_t;
 
+ZBX_PTR_VECTOR_DECL(status_update_ptr, zbx_status_update_t *)
+
+void	zbx_status_update_free(zbx_status_update_t *status_update);
+
 /* service update queue items */
 typedef struct
 {
@@ -138,6 +144,30 @@ zbx_service_update_t;
 
 ZBX_PTR_VECTOR_DECL(service_update_ptr, zbx_service_update_t *)
 
+#define ZBX_FLAG_SERVICE_UPDATE			0x00
+#define ZBX_FLAG_SERVICE_RECALCULATE		0x01
+#define ZBX_FLAG_SERVICE_RECALCULATE_SUPPRESS	0x04
+
+/* service queued for status recalculation after its children were updated */
+typedef struct
+{
+	zbx_uint64_t	serviceid;
+	zbx_service_t	*service;
+	zbx_timespec_t	ts;
+	int		flags;
+	int		processed;
+}
+zbx_service_dirty_t;
+
+/* services queued for status recalculation during single update batch */
+typedef struct
+{
+	zbx_hashset_t		services;
+	zbx_binary_heap_t	queue;
+	int			evaluated_num;
+}
+zbx_services_dirty_t;
+
 typedef struct
 {
 	zbx_uint64_t	conditionid;
@@ -171,5 +201,13 @@ int	service_get_status(const zbx_service_t	*service, int *status);
 int	service_get_main_status(const zbx_service_t *service);
 int	service_get_rule_status(const zbx_service_t *service, const zbx_service_rule_t *rule);
 void	service_get_rootcause_eventids(const zbx_service_t *parent, zbx_vector_uint64_t *eventids);
+void	service_update_levels(zbx_hashset_t *services);
+
+void	services_dirty_init(zbx_services_dirty_t *dirty);
+void	services_dirty_destroy(zbx_services_dirty_t *dirty);
+void	service_queue_parents(zbx_services_dirty_t *dirty, const zbx_service_t *service,
+		const zbx_timespec_t *ts, int flags);
+void	its_itservices_update_status(zbx_services_dirty_t *dirty, zbx_vector_status_update_ptr_t *alarms,
+		zbx_hashset_t *service_updates);
 
 #endif
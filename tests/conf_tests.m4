@@ -55,15 +55,19 @@ AC_DEFUN([CONF_TESTS],
 			tests/test_zbxcommon/Makefile
 			tests/libs/zbxcomms/Makefile
 			tests/libs/zbxcommshigh/Makefile
+			tests/libs/zbxcompress/Makefile
 			tests/libs/zbxcfg/Makefile
 			tests/libs/zbxcachevalue/Makefile
 			tests/libs/zbxcacheconfig/Makefile
+			tests/libs/zbxcachehistory/Makefile
 			tests/libs/zbxdb/Makefile
 			tests/libs/zbxdbhigh/Makefile
 			tests/libs/zbxeval/Makefile
 			tests/libs/zbxexpr/Makefile
+			tests/libs/zbxexport/Makefile
 			tests/libs/zbxfile/Makefile
 			tests/libs/zbxhistory/Makefile
+			tests/libs/zbxhttppoller/Makefile
 			tests/libs/zbxicmpping/Makefile
 			tests/libs/zbxjson/Makefile
 			tests/libs/zbxmodules/Makefile
@@ -72,6 +76,8 @@ AC_DEFUN([CONF_TESTS],
 			tests/libs/zbxparam/Makefile
 			tests/libs/zbxpreproc/Makefile
 			tests/libs/zbxprometheus/Makefile
+			tests/libs/zbxshmem/Makefile
+			tests/libs/zbxsnmptrapper/Makefile
 			tests/libs/zbxregexp/Makefile
 			tests/libs/zbxexpression/Makefile
 			tests/libs/zbxsysinfo/Makefile
@@ -87,10 +93,14 @@ AC_DEFUN([CONF_TESTS],
 			tests/libs/zbxodbc/Makefile
 			tests/libs/zbxip/Makefile
 			tests/zabbix_server/Makefile
+			tests/zabbix_server/connector/Makefile
 			tests/zabbix_server/pinger/Makefile
 			tests/zabbix_server/service/Makefile
 			tests/zabbix_server/trapper/Makefile
 			tests/zabbix_server/lld/Makefile
+			tests/zabbix_agent/Makefile
+			tests/zabbix_agent/listener/Makefile
+			tests/zabbix_agent/logwatch/Makefile
 			tests/mocks/Makefile
 			tests/mocks/configcache/Makefile
 			tests/mocks/valuecache/Makefile
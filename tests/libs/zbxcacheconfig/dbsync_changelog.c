@@ -0,0 +1,277 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+#include "zbxmockdb.h"
+
+#include "../../../src/libs/zbxcacheconfig/dbsync.c"
+
+/* Changelog records and table rows are read from mocked database. Configuration cache holds only */
+/* the objects needed to decide between changelog and full table compare.                        */
+
+static zbx_hash_t	mock_um_host_hash(const void *d)
+{
+	const zbx_um_host_t	*host = *(const zbx_um_host_t * const *)d;
+
+	return ZBX_DEFAULT_UINT64_HASH_FUNC(&host->hostid);
+}
+
+static int	mock_um_host_compare(const void *d1, const void *d2)
+{
+	const zbx_um_host_t	*h1 = *(const zbx_um_host_t * const *)d1;
+	const zbx_um_host_t	*h2 = *(const zbx_um_host_t * const *)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(h1->hostid, h2->hostid);
+
+	return 0;
+}
+
+static void	mock_config_init(zbx_dc_config_t *config, zbx_um_cache_t *um_cache)
+{
+	zbx_mock_handle_t	hhosts, hhost, hmacroids, hmacroid;
+	int			i, groups_num = 0;
+
+	memset(config, 0, sizeof(zbx_dc_config_t));
+
+	zbx_hashset_create(&config->gmacros, 0, um_macro_hash, um_macro_compare);
+	zbx_hashset_create(&config->hmacros, 0, um_macro_hash, um_macro_compare);
+	zbx_hashset_create(&config->hostgroups, 0, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	zbx_hashset_create(&um_cache->hosts, 0, mock_um_host_hash, mock_um_host_compare);
+	config->um_cache = um_cache;
+
+	/* cached host groups are used only to count objects, their identifiers do not clash with test data */
+	if (ZBX_MOCK_SUCCESS == zbx_mock_parameter_exists("in.cached_groups"))
+		groups_num = zbx_mock_get_parameter_int("in.cached_groups");
+
+	for (i = 0; i < groups_num; i++)
+	{
+		zbx_dc_hostgroup_t	group = {.groupid = ZBX_DBSYNC_BATCH_SIZE * 1000 + (zbx_uint64_t)i, .name = ""};
+
+		zbx_hashset_insert(&config->hostgroups, &group, sizeof(group));
+	}
+
+	if (ZBX_MOCK_SUCCESS != zbx_mock_parameter_exists("in.hosts"))
+		return;
+
+	hhosts = zbx_mock_get_parameter_handle("in.hosts");
+
+	while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hhosts, &hhost))
+	{
+		zbx_um_host_t	*host;
+
+		host = (zbx_um_host_t *)zbx_malloc(NULL, sizeof(zbx_um_host_t));
+		memset(host, 0, sizeof(zbx_um_host_t));
+		host->hostid = zbx_mock_get_object_member_uint64(hhost, "hostid");
+		zbx_vector_uint64_create(&host->templateids);
+		zbx_vector_um_macro_create(&host->macros);
+
+		hmacroids = zbx_mock_get_object_member_handle(hhost, "macroids");
+
+		while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hmacroids, &hmacroid))
+		{
+			zbx_um_macro_t	*macro;
+
+			macro = (zbx_um_macro_t *)zbx_malloc(NULL, sizeof(zbx_um_macro_t));
+			memset(macro, 0, sizeof(zbx_um_macro_t));
+
+			if (ZBX_MOCK_SUCCESS != zbx_mock_uint64(hmacroid, &macro->macroid))
+				fail_msg("invalid macro identifier");
+
+			macro->hostid = host->hostid;
+			zbx_vector_um_macro_append(&host->macros, macro);
+		}
+
+		zbx_hashset_insert(&um_cache->hosts, &host, sizeof(host));
+	}
+}
+
+static void	mock_config_destroy(zbx_dc_config_t *config)
+{
+	zbx_hashset_iter_t	iter;
+	zbx_um_host_t		**phost;
+
+	zbx_hashset_iter_reset(&config->um_cache->hosts, &iter);
+	while (NULL != (phost = (zbx_um_host_t **)zbx_hashset_iter_next(&iter)))
+	{
+		for (int i = 0; i < (*phost)->macros.values_num; i++)
+			zbx_free((*phost)->macros.values[i]);
+
+		zbx_vector_um_macro_destroy(&(*phost)->macros);
+		zbx_vector_uint64_destroy(&(*phost)->templateids);
+		zbx_free(*phost);
+	}
+
+	zbx_hashset_destroy(&config->um_cache->hosts);
+	zbx_hashset_destroy(&config->hostgroups);
+	zbx_hashset_destroy(&config->hmacros);
+	zbx_hashset_destroy(&config->gmacros);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: simulates mass update by registering the specified number of      *
+ *          updated objects in table journal                                  *
+ *                                                                            *
+ ******************************************************************************/
+static void	mock_journal_add_updates(int object)
+{
+	zbx_dbsync_journal_t	*journal = &dbsync_env.journals[ZBX_DBSYNC_JOURNAL(object)];
+	int			updates_num;
+
+	if (ZBX_MOCK_SUCCESS != zbx_mock_parameter_exists("in.mass_updates"))
+		return;
+
+	updates_num = zbx_mock_get_parameter_int("in.mass_updates");
+
+	for (int i = 0; i < updates_num; i++)
+		zbx_vector_uint64_append(&journal->updates, ZBX_DBSYNC_BATCH_SIZE * 100 + (zbx_uint64_t)i);
+
+	zbx_vector_uint64_sort(&journal->updates, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+}
+
+static unsigned char	mock_str_to_tag(const char *str)
+{
+	if (0 == strcmp(str, "add"))
+		return ZBX_DBSYNC_ROW_ADD;
+
+	if (0 == strcmp(str, "update"))
+		return ZBX_DBSYNC_ROW_UPDATE;
+
+	if (0 == strcmp(str, "remove"))
+		return ZBX_DBSYNC_ROW_REMOVE;
+
+	fail_msg("unknown row tag \"%s\"", str);
+
+	return ZBX_DBSYNC_ROW_NONE;
+}
+
+static unsigned char	mock_str_to_type(const char *str)
+{
+	if (0 == strcmp(str, "diff"))
+		return ZBX_DBSYNC_TYPE_DIFF;
+
+	if (0 == strcmp(str, "changelog"))
+		return ZBX_DBSYNC_TYPE_CHANGELOG;
+
+	if (0 == strcmp(str, "fallback"))
+		return ZBX_DBSYNC_TYPE_FALLBACK;
+
+	fail_msg("unknown sync type \"%s\"", str);
+
+	return ZBX_DBSYNC_TYPE_DIFF;
+}
+
+static int	mock_compare_rows(const void *d1, const void *d2)
+{
+	const zbx_dbsync_row_t	*r1 = *(const zbx_dbsync_row_t * const *)d1;
+	const zbx_dbsync_row_t	*r2 = *(const zbx_dbsync_row_t * const *)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(r1->rowid, r2->rowid);
+
+	return 0;
+}
+
+static void	mock_check_rows(zbx_dbsync_t *sync)
+{
+	zbx_mock_handle_t	hrows, hrow;
+	int			i = 0;
+
+	zbx_vector_ptr_sort(&sync->rows, mock_compare_rows);
+
+	hrows = zbx_mock_get_parameter_handle("out.rows");
+
+	while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hrows, &hrow))
+	{
+		zbx_dbsync_row_t	*row;
+
+		if (i >= sync->rows.values_num)
+			fail_msg("expected more than %d changed rows", sync->rows.values_num);
+
+		row = (zbx_dbsync_row_t *)sync->rows.values[i++];
+
+		zbx_mock_assert_uint64_eq("row identifier", zbx_mock_get_object_member_uint64(hrow, "id"),
+				row->rowid);
+		zbx_mock_assert_int_eq("row tag", mock_str_to_tag(zbx_mock_get_object_member_string(hrow, "tag")),
+				row->tag);
+	}
+
+	zbx_mock_assert_int_eq("changed rows", i, sync->rows.values_num);
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_dc_config_t	config;
+	zbx_um_cache_t	um_cache;
+	zbx_dbsync_t	sync;
+	const char	*table, *mode;
+	int		ret, object;
+
+	ZBX_UNUSED(state);
+
+	zbx_mockdb_init();
+
+	mock_config_init(&config, &um_cache);
+	zbx_dbsync_env_init(&config);
+
+	mode = zbx_mock_get_parameter_string("in.mode");
+	zbx_dbsync_env_prepare(0 == strcmp(mode, "init") ? ZBX_DBSYNC_INIT : ZBX_DBSYNC_UPDATE);
+
+	table = zbx_mock_get_parameter_string("in.table");
+
+	if (0 == strcmp(table, "globalmacro"))
+		object = ZBX_DBSYNC_OBJ_GLOBALMACRO;
+	else if (0 == strcmp(table, "hostmacro"))
+		object = ZBX_DBSYNC_OBJ_HOSTMACRO;
+	else if (0 == strcmp(table, "hstgrp"))
+		object = ZBX_DBSYNC_OBJ_HSTGRP;
+	else
+		fail_msg("unsupported table \"%s\"", table);
+
+	mock_journal_add_updates(object);
+
+	/* macros and host groups are synced in update mode also when changelog is not available */
+	zbx_dbsync_init_changelog(&sync, table, ZBX_DBSYNC_UPDATE);
+
+	switch (object)
+	{
+		case ZBX_DBSYNC_OBJ_GLOBALMACRO:
+			ret = zbx_dbsync_compare_global_macros(&sync);
+			break;
+		case ZBX_DBSYNC_OBJ_HOSTMACRO:
+			ret = zbx_dbsync_compare_host_macros(&sync);
+			break;
+		default:
+			ret = zbx_dbsync_compare_host_groups(&sync);
+			break;
+	}
+
+	zbx_mock_assert_result_eq("compare result", SUCCEED, ret);
+	zbx_mock_assert_int_eq("sync type", mock_str_to_type(zbx_mock_get_parameter_string("out.type")),
+			sync.type);
+	mock_check_rows(&sync);
+
+	zbx_dbsync_env_flush_changelog();
+	zbx_mock_assert_int_eq("flushed changelog records", zbx_mock_get_parameter_int("out.changelog"),
+			zbx_dbsync_env_changelog_num());
+
+	zbx_dbsync_clear(&sync);
+	zbx_dbsync_env_clear();
+	zbx_hashset_destroy(&dbsync_env.changelog);
+
+	mock_config_destroy(&config);
+	zbx_mockdb_destroy();
+}
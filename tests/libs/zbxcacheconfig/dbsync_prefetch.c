@@ -0,0 +1,274 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "../../../src/libs/zbxcacheconfig/dbsync.c"
+
+/* Database connections are mocked. Every select records the table it reads and the connection it is */
+/* executed with, so the test can check which connection loaded which changeset. Test data is read    */
+/* before and checked after the prefetch, because mock data access is not thread safe.                */
+
+#define MOCK_CONNECTIONS_MAX	16
+#define MOCK_SELECTS_MAX	64
+
+int		__wrap_zbx_dbconn_open(zbx_dbconn_t *db);
+void		__wrap_zbx_dbconn_close(zbx_dbconn_t *db);
+zbx_db_result_t	__wrap_zbx_dbconn_vselect(zbx_dbconn_t *db, const char *fmt, va_list args);
+void		__wrap_zbx_db_thread_deinit(void);
+
+typedef struct
+{
+	char	table[64];
+	int	conn;		/* sequence number of connection the select was executed with */
+}
+mock_select_t;
+
+static pthread_mutex_t	mock_lock = PTHREAD_MUTEX_INITIALIZER;
+static zbx_dbconn_t	*mock_conns[MOCK_CONNECTIONS_MAX];
+static int		mock_conns_num, mock_open_failures, mock_closed_num, mock_deinit_num;
+static mock_select_t	mock_selects[MOCK_SELECTS_MAX];
+static int		mock_selects_num;
+static char		mock_result;
+
+int	__wrap_zbx_dbconn_open(zbx_dbconn_t *db)
+{
+	int	ret = ZBX_DB_OK;
+
+	pthread_mutex_lock(&mock_lock);
+
+	if (MOCK_CONNECTIONS_MAX == mock_conns_num)
+		fail_msg("too many connections");
+
+	/* the first connection attempts fail, as if database connection limit was reached */
+	if (0 < mock_open_failures)
+	{
+		mock_open_failures--;
+		ret = ZBX_DB_DOWN;
+	}
+	else
+		mock_conns[mock_conns_num++] = db;
+
+	pthread_mutex_unlock(&mock_lock);
+
+	return ret;
+}
+
+void	__wrap_zbx_dbconn_close(zbx_dbconn_t *db)
+{
+	pthread_mutex_lock(&mock_lock);
+
+	for (int i = 0; i < mock_conns_num; i++)
+	{
+		if (mock_conns[i] == db)
+		{
+			/* closed connection memory can be reused by the next connection */
+			mock_conns[i] = NULL;
+			mock_closed_num++;
+			break;
+		}
+	}
+
+	pthread_mutex_unlock(&mock_lock);
+}
+
+zbx_db_result_t	__wrap_zbx_dbconn_vselect(zbx_dbconn_t *db, const char *fmt, va_list args)
+{
+	char		*sql;
+	const char	*from;
+	mock_select_t	*select;
+
+	sql = zbx_dvsprintf(NULL, fmt, args);
+
+	pthread_mutex_lock(&mock_lock);
+
+	if (MOCK_SELECTS_MAX == mock_selects_num)
+		fail_msg("too many selects");
+
+	select = &mock_selects[mock_selects_num++];
+	select->conn = -1;
+
+	for (int i = 0; i < mock_conns_num; i++)
+	{
+		if (mock_conns[i] == db)
+			select->conn = i;
+	}
+
+	if (NULL == (from = strstr(sql, " from ")))
+		fail_msg("unexpected query \"%s\"", sql);
+
+	from += ZBX_CONST_STRLEN(" from ");
+	zbx_strlcpy(select->table, from, MIN(sizeof(select->table), strcspn(from, " ,") + 1));
+
+	pthread_mutex_unlock(&mock_lock);
+
+	zbx_free(sql);
+
+	/* rows are not fetched, the result is only passed to changeset */
+	return (zbx_db_result_t)&mock_result;
+}
+
+void	__wrap_zbx_db_thread_deinit(void)
+{
+	pthread_mutex_lock(&mock_lock);
+	mock_deinit_num++;
+	pthread_mutex_unlock(&mock_lock);
+}
+
+static zbx_dbsync_compare_func_t	mock_get_compare_func(const char *table)
+{
+	if (0 == strcmp(table, "hosts"))
+		return zbx_dbsync_compare_hosts;
+
+	if (0 == strcmp(table, "hstgrp"))
+		return zbx_dbsync_compare_host_groups;
+
+	if (0 == strcmp(table, "interface"))
+		return zbx_dbsync_compare_interfaces;
+
+	if (0 == strcmp(table, "items"))
+		return zbx_dbsync_compare_items;
+
+	if (0 == strcmp(table, "item_discovery"))
+		return zbx_dbsync_compare_item_discovery;
+
+	if (0 == strcmp(table, "triggers"))
+		return zbx_dbsync_compare_triggers;
+
+	if (0 == strcmp(table, "trigger_depends"))
+		return zbx_dbsync_compare_trigger_dependency;
+
+	if (0 == strcmp(table, "actions"))
+		return zbx_dbsync_compare_actions;
+
+	fail_msg("unsupported table \"%s\"", table);
+
+	return NULL;
+}
+
+static const mock_select_t	*mock_find_select(const char *table, int from)
+{
+	for (int i = from; i < mock_selects_num; i++)
+	{
+		if (0 == strcmp(mock_selects[i].table, table))
+			return &mock_selects[i];
+	}
+
+	fail_msg("table \"%s\" was not selected", table);
+
+	return NULL;
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_mock_handle_t	htasks, htask;
+	zbx_dbsync_task_t	tasks[MOCK_SELECTS_MAX];
+	zbx_dbsync_t		syncs[MOCK_SELECTS_MAX];
+	const char		*tables[MOCK_SELECTS_MAX];
+	int			tasks_num = 0, groups_num = 0, prefetched_num = 0, group_conns[MOCK_CONNECTIONS_MAX],
+				prefetch_selects_num, prefetch_conns_num, default_conn;
+
+	ZBX_UNUSED(state);
+
+	htasks = zbx_mock_get_parameter_handle("in.tasks");
+
+	while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(htasks, &htask))
+	{
+		tables[tasks_num] = zbx_mock_get_object_member_string(htask, "table");
+
+		zbx_dbsync_init(&syncs[tasks_num], NULL, ZBX_DBSYNC_INIT);
+		tasks[tasks_num].sync = &syncs[tasks_num];
+		tasks[tasks_num].compare_func = mock_get_compare_func(tables[tasks_num]);
+		tasks[tasks_num].group = zbx_mock_get_object_member_int(htask, "group");
+
+		groups_num = MAX(groups_num, tasks[tasks_num].group + 1);
+		tasks_num++;
+	}
+
+	mock_open_failures = zbx_mock_get_parameter_int("in.failed_connections");
+
+	zbx_dbsync_prefetch(tasks, tasks_num);
+
+	prefetch_selects_num = mock_selects_num;
+	prefetch_conns_num = mock_conns_num;
+
+	zbx_mock_assert_int_eq("connections", zbx_mock_get_parameter_int("out.connections"), prefetch_conns_num);
+	zbx_mock_assert_int_eq("closed connections", prefetch_conns_num, mock_closed_num);
+	zbx_mock_assert_int_eq("thread deinitializations", groups_num, mock_deinit_num);
+
+	for (int i = 0; i < groups_num; i++)
+		group_conns[i] = -2;
+
+	/* tasks of one group are loaded by one connection, different groups use different connections */
+	for (int i = 0; i < tasks_num; i++)
+	{
+		int	conn = -1;
+
+		zbx_mock_assert_ptr_eq("changeset connection", NULL, syncs[i].db);
+
+		if (0 != syncs[i].prefetched)
+		{
+			const mock_select_t	*select = mock_find_select(tables[i], 0);
+
+			zbx_mock_assert_result_eq("prefetch result", SUCCEED, syncs[i].prefetch_ret);
+			zbx_mock_assert_ptr_eq("prefetched result set", &mock_result, syncs[i].dbresult);
+			zbx_mock_assert_int_ne("prefetch connection", -1, select->conn);
+
+			conn = select->conn;
+			prefetched_num++;
+		}
+
+		if (-2 == group_conns[tasks[i].group])
+			group_conns[tasks[i].group] = conn;
+		else
+			zbx_mock_assert_int_eq("group connection", group_conns[tasks[i].group], conn);
+
+		for (int j = 0; j < tasks[i].group; j++)
+		{
+			if (-1 != conn)
+				zbx_mock_assert_int_ne("connection of other group", group_conns[j], conn);
+		}
+	}
+
+	zbx_mock_assert_int_eq("prefetched changesets", zbx_mock_get_parameter_int("out.prefetched"), prefetched_num);
+
+	/* changesets which were not prefetched are calculated with the default connection */
+	zbx_db_connect(ZBX_DB_CONNECT_NORMAL);
+	default_conn = mock_conns_num - 1;
+
+	for (int i = 0; i < tasks_num; i++)
+	{
+		int	prefetched = syncs[i].prefetched;
+
+		zbx_mock_assert_result_eq("compare result", SUCCEED, zbx_dbsync_compare(&syncs[i],
+				tasks[i].compare_func));
+
+		if (0 == prefetched)
+		{
+			zbx_mock_assert_int_eq("default connection", default_conn,
+					mock_find_select(tables[i], prefetch_selects_num)->conn);
+		}
+
+		syncs[i].dbresult = NULL;
+		zbx_dbsync_clear(&syncs[i]);
+	}
+
+	zbx_mock_assert_int_eq("selects", prefetch_selects_num + tasks_num - prefetched_num, mock_selects_num);
+	zbx_mock_assert_int_eq("connections", prefetch_conns_num + 1, mock_conns_num);
+
+	zbx_db_close();
+}
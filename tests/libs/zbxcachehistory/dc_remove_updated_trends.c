@@ -0,0 +1,126 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+#include "zbxmockdb.h"
+
+#include "../../../src/libs/zbxcachehistory/cachehistory.c"
+
+/* Trends table is selected once per checked time range, older ranges are checked only while there are */
+/* items left without newer trends. Test data lists rows of every expected select - an unexpected select */
+/* fails because of missing data source.                                                                  */
+
+#define MOCK_TRENDS_MAX	16
+
+time_t	__wrap_time(time_t *t);
+
+time_t	__wrap_time(time_t *t)
+{
+	time_t	now = (time_t)zbx_mock_get_parameter_int("in.now");
+
+	if (NULL != t)
+		*t = now;
+
+	return now;
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	ZBX_DC_TREND		trends[MOCK_TRENDS_MAX];
+	zbx_uint64_t		itemids[MOCK_TRENDS_MAX], itemid;
+	zbx_hashset_t		trends_index;
+	zbx_mock_handle_t	hitemids, hitemid;
+	zbx_mock_error_t	err;
+	zbx_vector_uint64_t	disabled;
+	int			trends_num = 0, itemids_num = 0, clock;
+
+	ZBX_UNUSED(state);
+
+	zbx_mockdb_init();
+
+	clock = zbx_mock_get_parameter_int("in.clock");
+
+	zbx_hashset_create(&trends_index, MOCK_TRENDS_MAX, ZBX_DEFAULT_UINT64_HASH_FUNC,
+			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+	hitemids = zbx_mock_get_parameter_handle("in.trends");
+
+	while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hitemids, &hitemid))
+	{
+		zbx_dc_trend_ref_t	ref_local;
+
+		if (MOCK_TRENDS_MAX == trends_num)
+			fail_msg("too many trends");
+
+		memset(&trends[trends_num], 0, sizeof(ZBX_DC_TREND));
+		trends[trends_num].itemid = zbx_mock_get_object_member_uint64(hitemid, "itemid");
+		trends[trends_num].clock = clock;
+
+		ref_local.itemid = trends[trends_num].itemid;
+		ref_local.trend = &trends[trends_num];
+		zbx_hashset_insert(&trends_index, &ref_local, sizeof(ref_local));
+
+		trends_num++;
+	}
+
+	hitemids = zbx_mock_get_parameter_handle("in.itemids");
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = zbx_mock_vector_element(hitemids, &hitemid)))
+	{
+		if (ZBX_MOCK_SUCCESS != err || ZBX_MOCK_SUCCESS != zbx_mock_uint64(hitemid, &itemid))
+			fail_msg("cannot read itemid");
+
+		if (MOCK_TRENDS_MAX == itemids_num)
+			fail_msg("too many itemids");
+
+		itemids[itemids_num++] = itemid;
+	}
+
+	dc_remove_updated_trends(&trends_index, "trends", itemids, &itemids_num, clock);
+
+	zbx_mock_assert_int_eq("itemids left", 0, itemids_num);
+
+	zbx_vector_uint64_create(&disabled);
+
+	hitemids = zbx_mock_get_parameter_handle("out.disabled");
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = zbx_mock_vector_element(hitemids, &hitemid)))
+	{
+		if (ZBX_MOCK_SUCCESS != err || ZBX_MOCK_SUCCESS != zbx_mock_uint64(hitemid, &itemid))
+			fail_msg("cannot read disabled itemid");
+
+		zbx_vector_uint64_append(&disabled, itemid);
+	}
+
+	/* trends of items without newer data are disabled from the flushed clock, others are left as is */
+	for (int i = 0; i < trends_num; i++)
+	{
+		char	name[64];
+
+		zbx_snprintf(name, sizeof(name), "item " ZBX_FS_UI64 " trend disabled from", trends[i].itemid);
+
+		if (FAIL != zbx_vector_uint64_search(&disabled, trends[i].itemid, ZBX_DEFAULT_UINT64_COMPARE_FUNC))
+			zbx_mock_assert_int_eq(name, clock, trends[i].disable_from);
+		else
+			zbx_mock_assert_int_eq(name, 0, trends[i].disable_from);
+	}
+
+	zbx_vector_uint64_destroy(&disabled);
+	zbx_hashset_destroy(&trends_index);
+	zbx_free(sql);
+	zbx_mockdb_destroy();
+}
@@ -0,0 +1,163 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+#include "zbxmockdb.h"
+
+#include "../../../src/libs/zbxcachehistory/cachehistory.c"
+
+#define MOCK_TRENDS_MAX	16
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: reads trend from test data, uint trend average is read as average *
+ *          and stored as sum of values like in trend cache                   *
+ *                                                                            *
+ ******************************************************************************/
+static void	mock_read_trend(zbx_mock_handle_t htrend, unsigned char value_type, int clock, ZBX_DC_TREND *trend)
+{
+	memset(trend, 0, sizeof(ZBX_DC_TREND));
+
+	trend->itemid = zbx_mock_get_object_member_uint64(htrend, "itemid");
+	trend->num = zbx_mock_get_object_member_int(htrend, "num");
+	trend->clock = clock;
+	trend->value_type = value_type;
+
+	if (ITEM_VALUE_TYPE_FLOAT == value_type)
+	{
+		trend->value_min.dbl = zbx_mock_get_object_member_float(htrend, "min");
+		trend->value_avg.dbl = zbx_mock_get_object_member_float(htrend, "avg");
+		trend->value_max.dbl = zbx_mock_get_object_member_float(htrend, "max");
+	}
+	else
+	{
+		trend->value_min.ui64 = zbx_mock_get_object_member_uint64(htrend, "min");
+		zbx_umul64_64(&trend->value_avg.ui64, (zbx_uint64_t)trend->num,
+				zbx_mock_get_object_member_uint64(htrend, "avg"));
+		trend->value_max.ui64 = zbx_mock_get_object_member_uint64(htrend, "max");
+	}
+}
+
+static void	mock_check_trend(zbx_mock_handle_t htrend, const ZBX_DC_TREND *trend)
+{
+	zbx_mock_assert_int_eq("trend values number", zbx_mock_get_object_member_int(htrend, "num"), trend->num);
+
+	if (ITEM_VALUE_TYPE_FLOAT == trend->value_type)
+	{
+		zbx_mock_assert_double_eq("trend minimum", zbx_mock_get_object_member_float(htrend, "min"),
+				trend->value_min.dbl);
+		zbx_mock_assert_double_eq("trend average", zbx_mock_get_object_member_float(htrend, "avg"),
+				trend->value_avg.dbl);
+		zbx_mock_assert_double_eq("trend maximum", zbx_mock_get_object_member_float(htrend, "max"),
+				trend->value_max.dbl);
+	}
+	else
+	{
+		zbx_uint128_t	avg;
+
+		zbx_udiv128_64(&avg, &trend->value_avg.ui64, (zbx_uint64_t)trend->num);
+
+		zbx_mock_assert_uint64_eq("trend minimum", zbx_mock_get_object_member_uint64(htrend, "min"),
+				trend->value_min.ui64);
+		zbx_mock_assert_uint64_eq("trend average", zbx_mock_get_object_member_uint64(htrend, "avg"),
+				avg.lo);
+		zbx_mock_assert_uint64_eq("trend average high bits", 0, avg.hi);
+		zbx_mock_assert_uint64_eq("trend maximum", zbx_mock_get_object_member_uint64(htrend, "max"),
+				trend->value_max.ui64);
+	}
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	ZBX_DC_TREND		trends[MOCK_TRENDS_MAX];
+	zbx_uint64_t		itemids[MOCK_TRENDS_MAX];
+	zbx_hashset_t		trends_index;
+	zbx_mock_handle_t	htrends, htrend;
+	int			trends_num = 0, inserts_num, upserts_num = 0, clock, merged_num;
+	unsigned char		value_type;
+	const char		*table_name;
+
+	ZBX_UNUSED(state);
+
+	zbx_mockdb_init();
+
+	if (0 == strcmp(zbx_mock_get_parameter_string("in.value_type"), "float"))
+	{
+		value_type = ITEM_VALUE_TYPE_FLOAT;
+		table_name = "trends";
+	}
+	else
+	{
+		value_type = ITEM_VALUE_TYPE_UINT64;
+		table_name = "trends_uint";
+	}
+
+	clock = zbx_mock_get_parameter_int("in.clock");
+
+	zbx_hashset_create(&trends_index, MOCK_TRENDS_MAX, ZBX_DEFAULT_UINT64_HASH_FUNC,
+			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+	htrends = zbx_mock_get_parameter_handle("in.trends");
+
+	while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(htrends, &htrend))
+	{
+		zbx_dc_trend_ref_t	ref_local;
+
+		if (MOCK_TRENDS_MAX == trends_num)
+			fail_msg("too many trends");
+
+		mock_read_trend(htrend, value_type, clock, &trends[trends_num]);
+
+		ref_local.itemid = trends[trends_num].itemid;
+		ref_local.trend = &trends[trends_num];
+		zbx_hashset_insert(&trends_index, &ref_local, sizeof(ref_local));
+
+		itemids[trends_num] = trends[trends_num].itemid;
+		trends_num++;
+	}
+
+	inserts_num = trends_num;
+
+	dc_trends_fetch_and_update(&trends_index, itemids, trends_num, &inserts_num, &upserts_num, value_type,
+			table_name, clock);
+
+	merged_num = zbx_mock_get_parameter_int("out.merged");
+
+#ifdef HAVE_POSTGRESQL
+	/* merged trends stay in insert and are written with upsert */
+	zbx_mock_assert_int_eq("upserted trends", merged_num, upserts_num);
+	zbx_mock_assert_int_eq("inserted trends", trends_num, inserts_num);
+#else
+	/* merged trends are updated and removed from insert */
+	zbx_mock_assert_int_eq("upserted trends", 0, upserts_num);
+	zbx_mock_assert_int_eq("inserted trends", trends_num - merged_num, inserts_num);
+#endif
+
+	htrends = zbx_mock_get_parameter_handle("out.trends");
+
+	for (int i = 0; ZBX_MOCK_SUCCESS == zbx_mock_vector_element(htrends, &htrend); i++)
+	{
+		if (i == trends_num)
+			fail_msg("too many expected trends");
+
+		mock_check_trend(htrend, &trends[i]);
+	}
+
+	zbx_hashset_destroy(&trends_index);
+	zbx_free(sql);
+	zbx_mockdb_destroy();
+}
@@ -38,17 +38,36 @@ int	zbx_vc_get_cached_values(zbx_uint64_t itemid, unsigned char value_type, zbx_
 	for (chunk = item->tail; NULL != chunk; chunk = chunk->next)
 	{
 		for (i = chunk->first_value; i <= chunk->last_value; i++)
-			vc_history_record_vector_append(values, value_type, &chunk->slots[i]);
+			vc_history_record_vector_append(values, value_type, &vch_chunk_values(chunk, value_type)[i]);
 	}
 
 	return SUCCEED;
 }
 
+int	zbx_vc_get_compressed_chunks(zbx_uint64_t itemid)
+{
+	zbx_vc_item_t	*item;
+	zbx_vc_chunk_t	*chunk;
+	int		chunks_num = 0;
+
+	if (NULL == (item = zbx_hashset_search(&vc_cache->items, &itemid)))
+		return 0;
+
+	for (chunk = item->tail; NULL != chunk; chunk = chunk->next)
+	{
+		if (0 != chunk->compressed_size)
+			chunks_num++;
+	}
+
+	return chunks_num;
+}
+
 int	zbx_vc_precache_values(zbx_uint64_t itemid, int value_type, int seconds, int count, const zbx_timespec_t *ts)
 {
 	zbx_vc_item_t			*item;
 	int				ret;
 	zbx_vector_history_record_t	values;
+	zbx_vc_append_data_t		append = {.values = &values, .value_type = value_type};
 
 	/* add item to cache if necessary */
 	if (NULL == (item = (zbx_vc_item_t *)zbx_hashset_search(&vc_cache->items, &itemid)))
@@ -60,7 +79,7 @@ int	zbx_vc_precache_values(zbx_uint64_t itemid, int value_type, int seconds, int
 	/* perform request to cache values */
 	zbx_history_record_vector_create(&values);
 	RDLOCK_CACHE;
-	ret = vch_item_get_values(item, &values, seconds, count, ts);
+	ret = vch_item_process_values(item, seconds, count, ts, vc_append_value_cb, &append);
 	UNLOCK_CACHE;
 	zbx_vc_flush_stats();
 	zbx_history_record_vector_destroy(&values, value_type);
@@ -44,9 +44,9 @@ void	zbx_vc_common_test_func(
 		zbx_vc_test_get_values_setup_cb get_values_cb,
 		int test_check_result)
 {
-	int				err, seconds, count, cache_mode;
+	int				err, seconds, count, cache_mode, compression = 0;
 	zbx_vector_history_record_t	expected, returned;
-	const char			*data;
+	const char			*data, *compression_str;
 	char				*error;
 	zbx_mock_handle_t		handle, hitem, hitems;
 	zbx_mock_error_t		mock_err;
@@ -62,7 +62,10 @@ void	zbx_vc_common_test_func(
 	err = zbx_locks_create(&error);
 	zbx_mock_assert_result_eq("Lock initialization failed", SUCCEED, err);
 
-	err = zbx_vc_init(get_zbx_config_value_cache_size(), &error);
+	if (NULL != (compression_str = zbx_mock_get_optional_parameter_string("in.compression")))
+		compression = atoi(compression_str);
+
+	err = zbx_vc_init(get_zbx_config_value_cache_size(), compression, &error);
 	zbx_mock_assert_result_eq("Value cache initialization failed", SUCCEED, err);
 
 	zbx_vc_enable();
@@ -107,7 +110,7 @@ void	zbx_vc_common_test_func(
 	while (ZBX_MOCK_END_OF_VECTOR != (mock_err = (zbx_mock_vector_element(hitems, &hitem))))
 	{
 		int			item_status, item_active_range, item_db_cached_from, item_values_total;
-		zbx_mock_handle_t	hstatus;
+		zbx_mock_handle_t	hstatus, hcompressed;
 
 		if (ZBX_MOCK_NOT_A_VECTOR == mock_err)
 			fail_msg("out.cache.items parameter is not a vector");
@@ -152,6 +155,18 @@ void	zbx_vc_common_test_func(
 
 			zbx_vcmock_check_records("Cached values", value_type, &expected, &returned);
 
+			if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hitem, "compressed chunks", &hcompressed))
+			{
+				if (ZBX_MOCK_SUCCESS != (mock_err = zbx_mock_string(hcompressed, &data)))
+				{
+					fail_msg("Cannot read number of compressed chunks: %s",
+							zbx_mock_error_string(mock_err));
+				}
+
+				zbx_mock_assert_int_eq("item compressed chunks", atoi(data),
+						zbx_vc_get_compressed_chunks(itemid));
+			}
+
 			zbx_history_record_vector_clean(&expected, value_type);
 			zbx_history_record_vector_clean(&returned, value_type);
 		}
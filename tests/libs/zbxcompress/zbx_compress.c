@@ -0,0 +1,140 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "../../../src/libs/zbxcompress/compress.c"
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: generates test data - text repeated the specified number of times *
+ *          or pseudo-random bytes, which do not compress                     *
+ *                                                                            *
+ ******************************************************************************/
+static char	*mock_get_data(size_t *size)
+{
+	char	*data;
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_parameter_exists("in.random"))
+	{
+		zbx_uint64_t	state = 0x9e3779b97f4a7c15;
+
+		*size = (size_t)zbx_mock_get_parameter_uint64("in.random");
+		data = (char *)zbx_malloc(NULL, MAX(*size, 1));
+
+		/* xorshift generator keeps the data the same between runs */
+		for (size_t i = 0; i < *size; i++)
+		{
+			state ^= state << 13;
+			state ^= state >> 7;
+			state ^= state << 17;
+			data[i] = (char)(state >> 32);
+		}
+	}
+	else
+	{
+		const char	*text = zbx_mock_get_parameter_string("in.text");
+		size_t		text_len = strlen(text), repeat;
+
+		repeat = (size_t)zbx_mock_get_parameter_uint64("in.repeat");
+		*size = text_len * repeat;
+		data = (char *)zbx_malloc(NULL, MAX(*size, 1));
+
+		for (size_t i = 0; i < repeat; i++)
+			memcpy(data + i * text_len, text, text_len);
+	}
+
+	return data;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: inflates gzip format data                                         *
+ *                                                                            *
+ ******************************************************************************/
+static int	mock_uncompress_gzip(const char *in, size_t size_in, char *out, size_t *size_out)
+{
+	z_stream	stream;
+	int		ret;
+
+	memset(&stream, 0, sizeof(stream));
+
+	if (Z_OK != inflateInit2(&stream, MAX_WBITS + 16))
+		return FAIL;
+
+	stream.next_in = (Bytef *)in;
+	stream.avail_in = (uInt)size_in;
+	stream.next_out = (Bytef *)out;
+	stream.avail_out = (uInt)*size_out;
+
+	ret = inflate(&stream, Z_FINISH);
+	*size_out = (size_t)stream.total_out;
+	(void)inflateEnd(&stream);
+
+	return Z_STREAM_END == ret ? SUCCEED : FAIL;
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	char		*data, *compressed = NULL, *uncompressed;
+	const char	*format;
+	size_t		size, compressed_size, uncompressed_size, buf_size;
+	int		ret;
+
+	ZBX_UNUSED(state);
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_parameter_exists("in.level"))
+		zbx_compress_set_level(zbx_mock_get_parameter_int("in.level"));
+
+	data = mock_get_data(&size);
+	format = zbx_mock_get_parameter_string("in.format");
+
+	if (0 == strcmp(format, "zlib"))
+		ret = zbx_compress(data, size, &compressed, &compressed_size);
+	else if (0 == strcmp(format, "gzip"))
+		ret = zbx_compress_gzip(data, size, &compressed, &compressed_size);
+	else
+		fail_msg("unsupported format \"%s\"", format);
+
+	if (SUCCEED != ret)
+		fail_msg("cannot compress data: %s", zbx_compress_strerror());
+
+	/* the output buffer is initially sized for data compressing at least four times and grows on demand */
+	buf_size = MAX(size / 4, ZBX_COMPRESS_BUF_MIN);
+	zbx_mock_assert_int_eq("output exceeds initial buffer", zbx_mock_get_parameter_int("out.grown"),
+			compressed_size > buf_size);
+
+	uncompressed = (char *)zbx_malloc(NULL, size + 1);
+	uncompressed_size = size + 1;
+
+	if (0 == strcmp(format, "zlib"))
+		ret = zbx_uncompress(compressed, compressed_size, uncompressed, &uncompressed_size);
+	else
+		ret = mock_uncompress_gzip(compressed, compressed_size, uncompressed, &uncompressed_size);
+
+	if (SUCCEED != ret)
+		fail_msg("cannot uncompress data: %s", zbx_compress_strerror());
+
+	zbx_mock_assert_uint64_eq("uncompressed size", size, uncompressed_size);
+
+	if (0 != memcmp(data, uncompressed, size))
+		fail_msg("uncompressed data does not match original data");
+
+	zbx_free(uncompressed);
+	zbx_free(compressed);
+	zbx_free(data);
+}
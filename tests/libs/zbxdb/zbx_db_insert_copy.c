@@ -0,0 +1,205 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockutil.h"
+#include "zbxmockassert.h"
+
+#include "../../../src/libs/zbxdb/dbinsert.c"
+
+#include "zbxnum.h"
+
+static char	*copy_sql, *copy_data;
+static size_t	copy_size;
+
+int	__wrap_dbconn_copy_from(zbx_dbconn_t *db, const char *sql, const char *data, size_t size);
+
+int	__wrap_dbconn_copy_from(zbx_dbconn_t *db, const char *sql, const char *data, size_t size)
+{
+	ZBX_UNUSED(db);
+
+	copy_sql = zbx_strdup(copy_sql, sql);
+	copy_data = (char *)zbx_realloc(copy_data, size);
+	memcpy(copy_data, data, size);
+	copy_size = size;
+
+	return ZBX_DB_OK;
+}
+
+static unsigned char	str_to_field_type(const char *str)
+{
+	if (0 == strcmp(str, "ZBX_TYPE_INT"))
+		return ZBX_TYPE_INT;
+	if (0 == strcmp(str, "ZBX_TYPE_CHAR"))
+		return ZBX_TYPE_CHAR;
+	if (0 == strcmp(str, "ZBX_TYPE_FLOAT"))
+		return ZBX_TYPE_FLOAT;
+	if (0 == strcmp(str, "ZBX_TYPE_BLOB"))
+		return ZBX_TYPE_BLOB;
+	if (0 == strcmp(str, "ZBX_TYPE_TEXT"))
+		return ZBX_TYPE_TEXT;
+	if (0 == strcmp(str, "ZBX_TYPE_UINT"))
+		return ZBX_TYPE_UINT;
+	if (0 == strcmp(str, "ZBX_TYPE_ID"))
+		return ZBX_TYPE_ID;
+	if (0 == strcmp(str, "ZBX_TYPE_LONGTEXT"))
+		return ZBX_TYPE_LONGTEXT;
+	if (0 == strcmp(str, "ZBX_TYPE_CUID"))
+		return ZBX_TYPE_CUID;
+
+	fail_msg("unknown field type \"%s\"", str);
+
+	return 0;
+}
+
+static void	read_fields(zbx_db_table_t *table, const zbx_db_field_t **fields, int *fields_num)
+{
+	zbx_mock_handle_t	hfields, hfield, hmember;
+	zbx_mock_error_t	err;
+
+	hfields = zbx_mock_get_parameter_handle("in.fields");
+
+	for (*fields_num = 0; ZBX_MOCK_END_OF_VECTOR != (err = zbx_mock_vector_element(hfields, &hfield));
+			(*fields_num)++)
+	{
+		zbx_db_field_t	*field = &table->fields[*fields_num];
+
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("cannot read field #%d: %s", *fields_num + 1, zbx_mock_error_string(err));
+
+		if (ZBX_MAX_FIELDS - 1 == *fields_num)
+			fail_msg("too many fields");
+
+		field->name = zbx_mock_get_object_member_string(hfield, "name");
+		field->type = str_to_field_type(zbx_mock_get_object_member_string(hfield, "type"));
+
+		if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hfield, "length", &hmember))
+			field->length = (unsigned short)atoi(zbx_mock_get_object_member_string(hfield, "length"));
+
+		if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hfield, "upper", &hmember))
+			field->flags |= ZBX_UPPER;
+
+		fields[*fields_num] = field;
+	}
+}
+
+static void	read_rows(zbx_db_insert_t *db_insert)
+{
+	zbx_mock_handle_t	hrows, hrow, hvalue;
+	zbx_mock_error_t	err;
+	zbx_db_value_t		values[ZBX_MAX_FIELDS], *pvalues[ZBX_MAX_FIELDS];
+
+	hrows = zbx_mock_get_parameter_handle("in.rows");
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = zbx_mock_vector_element(hrows, &hrow)))
+	{
+		int	i;
+
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("cannot read row: %s", zbx_mock_error_string(err));
+
+		for (i = 0; ZBX_MOCK_END_OF_VECTOR != (err = zbx_mock_vector_element(hrow, &hvalue)); i++)
+		{
+			const char	*str;
+
+			if (i == db_insert->fields.values_num)
+				fail_msg("too many row values");
+
+			if (ZBX_MOCK_SUCCESS != err || ZBX_MOCK_SUCCESS != (err = zbx_mock_string(hvalue, &str)))
+				fail_msg("cannot read row value #%d: %s", i + 1, zbx_mock_error_string(err));
+
+			switch (db_insert->fields.values[i]->type)
+			{
+				case ZBX_TYPE_INT:
+					values[i].i32 = atoi(str);
+					break;
+				case ZBX_TYPE_FLOAT:
+					values[i].dbl = atof(str);
+					break;
+				case ZBX_TYPE_UINT:
+				case ZBX_TYPE_ID:
+					if (SUCCEED != zbx_is_uint64(str, &values[i].ui64))
+						fail_msg("invalid unsigned value \"%s\"", str);
+					break;
+				default:
+					values[i].str = (char *)str;
+			}
+
+			pvalues[i] = &values[i];
+		}
+
+		zbx_db_insert_add_values_dyn(db_insert, pvalues, i);
+	}
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+#if defined(HAVE_POSTGRESQL)
+	zbx_db_config_t		config = {.bulk_load = 1};
+	zbx_dbconn_t		db = {.config = &config};
+	zbx_db_table_t		table = {.table = "test"};
+	const zbx_db_field_t	*fields[ZBX_MAX_FIELDS];
+	zbx_db_insert_t		db_insert;
+	int			fields_num, bulk_load;
+	const char		*data;
+	size_t			data_len;
+
+	ZBX_UNUSED(state);
+
+	read_fields(&table, fields, &fields_num);
+
+	zbx_dbconn_prepare_insert_dyn(&db, &db_insert, &table, fields, fields_num);
+	zbx_db_insert_set_bulk_load(&db_insert);
+
+	bulk_load = zbx_mock_get_parameter_int("out.bulk_load");
+	zbx_mock_assert_int_eq("bulk load mode", bulk_load, db_insert.bulk_load);
+
+	if (0 != bulk_load)
+	{
+		zbx_mock_error_t	err;
+
+		read_rows(&db_insert);
+		zbx_mock_assert_result_eq("zbx_db_insert_execute() return value", SUCCEED,
+				zbx_db_insert_execute(&db_insert));
+
+		zbx_mock_assert_str_eq("COPY statement", zbx_mock_get_parameter_string("out.sql"), copy_sql);
+
+		if (ZBX_MOCK_SUCCESS != (err = zbx_mock_binary(zbx_mock_get_parameter_handle("out.data"), &data,
+				&data_len)))
+		{
+			fail_msg("cannot read expected data: %s", zbx_mock_error_string(err));
+		}
+
+		zbx_mock_assert_uint64_eq("COPY data size", data_len, copy_size);
+
+		for (size_t i = 0; i < data_len; i++)
+		{
+			if (data[i] != copy_data[i])
+			{
+				fail_msg("COPY data differs at offset " ZBX_FS_SIZE_T ": expected 0x%02x got 0x%02x",
+						(zbx_fs_size_t)i, (unsigned char)data[i], (unsigned char)copy_data[i]);
+			}
+		}
+	}
+
+	zbx_db_insert_clean(&db_insert);
+	zbx_free(copy_sql);
+	zbx_free(copy_data);
+#else
+	ZBX_UNUSED(state);
+
+	skip();
+#endif
+}
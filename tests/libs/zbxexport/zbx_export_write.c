@@ -0,0 +1,226 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxcommon.h"
+
+int	__real_open(const char *path, int oflag, ...);
+int	__real_stat(const char *path, struct stat *buf);
+FILE	*__real_fopen(const char *path, const char *mode);
+
+/* export is tested on real files, bypass the file system mocks */
+#define open(...)		__real_open(__VA_ARGS__)
+#define stat(path, buf)		__real_stat(path, buf)
+
+#include "../../../src/libs/zbxexport/export.c"
+
+/* Export file is written to a temporary directory. Write errors are simulated by allowing only the */
+/* specified number of bytes to be written before write() fails with 'No space left on device'.     */
+
+ssize_t	__real_write(int fd, const void *buf, size_t count);
+ssize_t	__wrap_write(int fd, const void *buf, size_t count);
+
+static zbx_export_file_t	*mock_file;
+static ssize_t			mock_write_left = -1;
+
+ssize_t	__wrap_write(int fd, const void *buf, size_t count)
+{
+	ssize_t	ret;
+
+	if (-1 == mock_write_left)
+		return __real_write(fd, buf, count);
+
+	if (0 == mock_write_left)
+	{
+		errno = ENOSPC;
+		return -1;
+	}
+
+	if (-1 != (ret = __real_write(fd, buf, MIN(count, (size_t)mock_write_left))))
+		mock_write_left -= ret;
+
+	return ret;
+}
+
+static int	mock_has_member(zbx_mock_handle_t object, const char *name)
+{
+	zbx_mock_handle_t	hmember;
+
+	return ZBX_MOCK_SUCCESS == zbx_mock_object_member(object, name, &hmember) ? SUCCEED : FAIL;
+}
+
+static zbx_export_file_t	*mock_get_export_file(void)
+{
+	return mock_file;
+}
+
+static char	*mock_read_file(const char *path)
+{
+	char	*data = NULL;
+	size_t	data_alloc = 0, data_offset = 0;
+	FILE	*f;
+	int	c;
+
+	if (NULL == (f = __real_fopen(path, "r")))
+		return zbx_strdup(NULL, "");
+
+	while (EOF != (c = fgetc(f)))
+		zbx_chrcpy_alloc(&data, &data_alloc, &data_offset, (char)c);
+
+	fclose(f);
+
+	return NULL != data ? data : zbx_strdup(NULL, "");
+}
+
+static int	mock_count_lines(const char *data)
+{
+	int	lines_num = 0;
+
+	for (; NULL != (data = strchr(data, '\n')); data++)
+		lines_num++;
+
+	return lines_num;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: exports line built by repeating text the specified number of      *
+ *          times                                                             *
+ *                                                                            *
+ ******************************************************************************/
+static void	mock_write_line(zbx_mock_handle_t hstep)
+{
+	const char	*text;
+	char		*line = NULL;
+	size_t		line_alloc = 0, line_offset = 0;
+	int		width = 1;
+
+	text = zbx_mock_get_object_member_string(hstep, "write");
+
+	if (SUCCEED == mock_has_member(hstep, "width"))
+		width = zbx_mock_get_object_member_int(hstep, "width");
+
+	for (int i = 0; i < width; i++)
+		zbx_strcpy_alloc(&line, &line_alloc, &line_offset, text);
+
+	zbx_history_export_write(line, line_offset);
+	zbx_free(line);
+}
+
+static void	mock_check_file(zbx_mock_handle_t hcheck, const char *path, const char *name)
+{
+	char	*data, *old_path;
+
+	data = mock_read_file(path);
+
+	if (SUCCEED == mock_has_member(hcheck, "file"))
+		zbx_mock_assert_str_eq(name, zbx_mock_get_object_member_string(hcheck, "file"), data);
+
+	if (SUCCEED == mock_has_member(hcheck, "lines"))
+	{
+		zbx_mock_assert_int_eq(name, zbx_mock_get_object_member_int(hcheck, "lines"),
+				mock_count_lines(data));
+	}
+
+	zbx_free(data);
+
+	if (SUCCEED == mock_has_member(hcheck, "old"))
+	{
+		old_path = zbx_dsprintf(NULL, "%s.old", path);
+		data = mock_read_file(old_path);
+		zbx_mock_assert_str_eq(name, zbx_mock_get_object_member_string(hcheck, "old"), data);
+		zbx_free(data);
+		zbx_free(old_path);
+	}
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_config_export_t	config;
+	zbx_mock_handle_t	hsteps, hstep, hmember;
+	zbx_mock_error_t	err;
+	char			dir[] = "/tmp/zbx_export_XXXXXX", *path, *old_path, *error = NULL, name[64];
+	int			step = 0;
+
+	ZBX_UNUSED(state);
+
+	if (NULL == mkdtemp(dir))
+		fail_msg("cannot create export directory: %s", zbx_strerror(errno));
+
+	config.dir = zbx_strdup(NULL, dir);
+	config.type = NULL;
+	config.file_size = zbx_mock_get_parameter_uint64("in.file_size");
+
+	if (SUCCEED != zbx_init_library_export(&config, &error))
+		fail_msg("cannot initialize export: %s", error);
+
+	mock_file = zbx_history_export_init(mock_get_export_file, "test", 1);
+	path = zbx_dsprintf(NULL, "%s/history-test-1.ndjson", dir);
+	old_path = zbx_dsprintf(NULL, "%s.old", path);
+
+	hsteps = zbx_mock_get_parameter_handle("in.steps");
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = zbx_mock_vector_element(hsteps, &hstep)))
+	{
+		int	repeat = 1;
+
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("cannot read step: %s", zbx_mock_error_string(err));
+
+		step++;
+
+		if (SUCCEED == mock_has_member(hstep, "repeat"))
+			repeat = zbx_mock_get_object_member_int(hstep, "repeat");
+
+		for (int i = 0; i < repeat; i++)
+		{
+			if (SUCCEED == mock_has_member(hstep, "write"))
+				mock_write_line(hstep);
+		}
+
+		if (SUCCEED == mock_has_member(hstep, "flush"))
+			zbx_history_export_flush();
+
+		if (SUCCEED == mock_has_member(hstep, "fail_after"))
+			mock_write_left = (ssize_t)zbx_mock_get_object_member_int(hstep, "fail_after");
+
+		if (SUCCEED == mock_has_member(hstep, "recover"))
+			mock_write_left = -1;
+
+		if (SUCCEED == mock_has_member(hstep, "remove") && 0 != unlink(path))
+			fail_msg("cannot remove export file: %s", zbx_strerror(errno));
+
+		if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hstep, "check", &hmember))
+		{
+			zbx_snprintf(name, sizeof(name), "step %d export file", step);
+			mock_check_file(hmember, path, name);
+		}
+	}
+
+	/* the remaining buffered data is written when export is deinitialized */
+	zbx_export_deinit(mock_file);
+	mock_check_file(zbx_mock_get_parameter_handle("out"), path, "export file");
+
+	unlink(old_path);
+	unlink(path);
+	rmdir(dir);
+
+	zbx_free(old_path);
+	zbx_free(path);
+	zbx_deinit_library_export();
+}
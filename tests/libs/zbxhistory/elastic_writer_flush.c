@@ -0,0 +1,337 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "../../../src/libs/zbxhistory/history_elastic.c"
+
+#include <zlib.h>
+
+/* Bulk requests are sent to a stub HTTP server running in a child process. The server replies with */
+/* responses listed in test case and reports itemids of documents received with every request.    */
+
+static int	curl_init_fail_num;
+
+void	__wrap_zbx_recalc_time_period(time_t *ts_from, int table_group);
+CURL	*__wrap_curl_easy_init(void);
+CURL	*__real_curl_easy_init(void);
+unsigned int	__wrap_sleep(unsigned int seconds);
+
+void	__wrap_zbx_recalc_time_period(time_t *ts_from, int table_group)
+{
+	ZBX_UNUSED(ts_from);
+	ZBX_UNUSED(table_group);
+}
+
+CURL	*__wrap_curl_easy_init(void)
+{
+	if (0 < curl_init_fail_num)
+	{
+		curl_init_fail_num--;
+		return NULL;
+	}
+
+	return __real_curl_easy_init();
+}
+
+unsigned int	__wrap_sleep(unsigned int seconds)
+{
+	ZBX_UNUSED(seconds);
+
+	return 0;
+}
+
+static char	*stub_gunzip(const char *data, size_t size)
+{
+	z_stream	strm;
+	char		*out = NULL;
+	size_t		out_alloc = 0, out_offset = 0;
+	int		ret;
+
+	memset(&strm, 0, sizeof(strm));
+
+	if (Z_OK != inflateInit2(&strm, 16 + MAX_WBITS))
+		return NULL;
+
+	strm.next_in = (Bytef *)data;
+	strm.avail_in = (uInt)size;
+
+	do
+	{
+		char	buf[4096];
+
+		strm.next_out = (Bytef *)buf;
+		strm.avail_out = sizeof(buf);
+
+		if (Z_STREAM_ERROR == (ret = inflate(&strm, Z_NO_FLUSH)) || Z_DATA_ERROR == ret || Z_MEM_ERROR == ret)
+			break;
+
+		zbx_strncpy_alloc(&out, &out_alloc, &out_offset, buf, sizeof(buf) - strm.avail_out);
+	}
+	while (Z_STREAM_END != ret);
+
+	inflateEnd(&strm);
+
+	if (Z_STREAM_END != ret)
+		zbx_free(out);
+
+	return out;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: reads HTTP request and writes itemids of the received documents   *
+ *          to the report socket                                              *
+ *                                                                            *
+ ******************************************************************************/
+static void	stub_read_request(int fd, int report)
+{
+	char		*req = NULL, *body, *docs, *ptr, *line, *report_line = NULL;
+	size_t		req_alloc = 0, req_offset = 0, report_alloc = 0, report_offset = 0, size = 0, body_offset = 0;
+	const char	*cl;
+
+	while (1)
+	{
+		char	buf[4096];
+		ssize_t	n;
+
+		if (0 >= (n = recv(fd, buf, sizeof(buf), 0)))
+			break;
+
+		zbx_str_memcpy_alloc(&req, &req_alloc, &req_offset, buf, (size_t)n);
+
+		/* buffer can be reallocated, so body is referenced by offset */
+		if (0 == body_offset && NULL != (body = strstr(req, "\r\n\r\n")))
+		{
+			body_offset = (size_t)(body - req) + 4;
+
+			if (NULL != (cl = zbx_strcasestr(req, "Content-Length:")) && cl < body)
+				size = strtoul(cl + ZBX_CONST_STRLEN("Content-Length:"), NULL, 10);
+		}
+
+		if (0 != body_offset && req_offset >= body_offset + size)
+			break;
+	}
+
+	if (0 == body_offset)
+		goto out;
+
+	body = req + body_offset;
+
+	if (NULL != zbx_strcasestr(req, "Content-Encoding: gzip"))
+		docs = stub_gunzip(body, size);
+	else
+		docs = zbx_strdup(NULL, body);
+
+	if (NULL == docs)
+		goto out;
+
+	/* every document consists of action and source lines */
+	for (line = strtok_r(docs, "\n", &ptr); NULL != line; line = strtok_r(NULL, "\n", &ptr))
+	{
+		struct zbx_json_parse	jp;
+		char			itemid[MAX_ID_LEN + 1];
+
+		if (SUCCEED != zbx_json_open(line, &jp) ||
+				SUCCEED != zbx_json_value_by_name(&jp, "itemid", itemid, sizeof(itemid), NULL))
+		{
+			continue;
+		}
+
+		zbx_snprintf_alloc(&report_line, &report_alloc, &report_offset, "%s%s", 0 == report_offset ? "" : ",",
+				itemid);
+	}
+
+	zbx_free(docs);
+out:
+	zbx_chrcpy_alloc(&report_line, &report_alloc, &report_offset, '\n');
+
+	if ((ssize_t)report_offset != send(report, report_line, report_offset, 0))
+		_exit(EXIT_FAILURE);
+
+	zbx_free(report_line);
+	zbx_free(req);
+}
+
+static void	stub_server_run(int sock, int report)
+{
+	zbx_mock_handle_t	hresponses, hresponse;
+
+	hresponses = zbx_mock_get_parameter_handle("in.responses");
+
+	while (1)
+	{
+		int		fd, status = 200;
+		const char	*body = "{\"errors\":false}";
+		char		*response;
+
+		if (-1 == (fd = accept(sock, NULL, NULL)))
+			_exit(EXIT_FAILURE);
+
+		stub_read_request(fd, report);
+
+		/* requests after the listed responses succeed */
+		if (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hresponses, &hresponse))
+		{
+			status = atoi(zbx_mock_get_object_member_string(hresponse, "status"));
+			body = zbx_mock_get_object_member_string(hresponse, "body");
+		}
+
+		response = zbx_dsprintf(NULL, "HTTP/1.1 %d Stub\r\nContent-Type: application/json\r\n"
+				"Content-Length: " ZBX_FS_SIZE_T "\r\nConnection: close\r\n\r\n%s", status,
+				(zbx_fs_size_t)strlen(body), body);
+
+		if ((ssize_t)strlen(response) != send(fd, response, strlen(response), 0))
+			_exit(EXIT_FAILURE);
+
+		zbx_free(response);
+		close(fd);
+	}
+}
+
+static pid_t	stub_server_start(unsigned short *port, int *report)
+{
+	struct sockaddr_in	addr;
+	socklen_t		addr_len = sizeof(addr);
+	int			sock, fds[2];
+	pid_t			pid;
+
+	if (-1 == (sock = socket(AF_INET, SOCK_STREAM, 0)))
+		fail_msg("cannot create socket: %s", zbx_strerror(errno));
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+	if (0 != bind(sock, (struct sockaddr *)&addr, sizeof(addr)) || 0 != listen(sock, SOMAXCONN) ||
+			0 != getsockname(sock, (struct sockaddr *)&addr, &addr_len))
+	{
+		fail_msg("cannot start stub server: %s", zbx_strerror(errno));
+	}
+
+	/* socket pair is used for reports as read() is mocked in tests */
+	if (0 != socketpair(AF_UNIX, SOCK_STREAM, 0, fds))
+		fail_msg("cannot create socket pair: %s", zbx_strerror(errno));
+
+	if (0 == (pid = fork()))
+	{
+		close(fds[0]);
+		stub_server_run(sock, fds[1]);
+	}
+
+	if (-1 == pid)
+		fail_msg("cannot fork stub server: %s", zbx_strerror(errno));
+
+	close(fds[1]);
+	close(sock);
+
+	*port = ntohs(addr.sin_port);
+	*report = fds[0];
+
+	return pid;
+}
+
+static void	read_values(zbx_vector_dc_history_ptr_t *history)
+{
+	zbx_mock_handle_t	hvalues, hvalue;
+
+	hvalues = zbx_mock_get_parameter_handle("in.values");
+
+	while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hvalues, &hvalue))
+	{
+		zbx_dc_history_t	*h;
+
+		h = (zbx_dc_history_t *)zbx_malloc(NULL, sizeof(zbx_dc_history_t));
+		memset(h, 0, sizeof(zbx_dc_history_t));
+
+		if (SUCCEED != zbx_is_uint64(zbx_mock_get_object_member_string(hvalue, "itemid"), &h->itemid))
+			fail_msg("invalid itemid");
+
+		if (SUCCEED != zbx_is_uint64(zbx_mock_get_object_member_string(hvalue, "value"), &h->value.ui64))
+			fail_msg("invalid value");
+
+		h->value_type = ITEM_VALUE_TYPE_UINT64;
+		h->ts.sec = atoi(zbx_mock_get_object_member_string(hvalue, "clock"));
+		zbx_vector_dc_history_ptr_append(history, h);
+	}
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_history_iface_t		hist;
+	zbx_vector_dc_history_ptr_t	history;
+	zbx_mock_handle_t		hrequests, hrequest;
+	char				*url, *error = NULL, *requests = NULL, buf[4096], *ptr, *line;
+	size_t				requests_alloc = 0, requests_offset = 0;
+	unsigned short			port;
+	int				report, i;
+	ssize_t				n;
+	pid_t				pid;
+
+	ZBX_UNUSED(state);
+
+	curl_init_fail_num = zbx_mock_get_parameter_int("in.curl_init_fail");
+
+	pid = stub_server_start(&port, &report);
+
+	url = zbx_dsprintf(NULL, "http://127.0.0.1:%hu", port);
+
+	if (SUCCEED != zbx_history_elastic_init(&hist, ITEM_VALUE_TYPE_UINT64, url, 0, &error))
+		fail_msg("cannot initialize elasticsearch history: %s", error);
+
+	zbx_vector_dc_history_ptr_create(&history);
+	read_values(&history);
+
+	hist.add_values(&hist, &history, 0);
+	zbx_mock_assert_result_eq("flush result", SUCCEED, hist.flush(&hist));
+
+	kill(pid, SIGKILL);
+	waitpid(pid, NULL, 0);
+
+	while (0 < (n = recv(report, buf, sizeof(buf), 0)))
+		zbx_strncpy_alloc(&requests, &requests_alloc, &requests_offset, buf, (size_t)n);
+
+	close(report);
+
+	hrequests = zbx_mock_get_parameter_handle("out.requests");
+	line = (NULL != requests ? strtok_r(requests, "\n", &ptr) : NULL);
+
+	for (i = 0; ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hrequests, &hrequest); i++)
+	{
+		const char	*itemids;
+
+		if (NULL == line)
+			fail_msg("expected request #%d was not sent", i + 1);
+
+		if (ZBX_MOCK_SUCCESS != zbx_mock_string(hrequest, &itemids))
+			fail_msg("cannot read expected request #%d", i + 1);
+
+		zbx_mock_assert_str_eq("request documents", itemids, line);
+		line = strtok_r(NULL, "\n", &ptr);
+	}
+
+	if (NULL != line)
+		fail_msg("unexpected request #%d with documents \"%s\"", i + 1, line);
+
+	hist.destroy(&hist);
+	for (i = 0; i < history.values_num; i++)
+		zbx_free(history.values[i]);
+
+	zbx_vector_dc_history_ptr_destroy(&history);
+	zbx_free(requests);
+	zbx_free(url);
+}
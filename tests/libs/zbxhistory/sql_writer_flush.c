@@ -0,0 +1,370 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+#include "zbxmockdb.h"
+
+#include "../../../src/libs/zbxhistory/history_sql.c"
+
+/* Transactions are simulated by wrapped database connection functions. Committed values are kept in */
+/* memory together with the values listed as already stored and committing a stored value fails with */
+/* duplicate entry error. Writer threads can be held before starting transactions to check that      */
+/* history syncer does not wait for them.                                                            */
+
+typedef struct
+{
+	pthread_mutex_t			lock;
+	pthread_cond_t			event;
+	/* 1 - transactions are not started until released */
+	int				hold;
+	/* number of transactions to fail with other than duplicate entry error */
+	int				fail_num;
+	zbx_vector_sql_history_key_t	stored;
+	/* committed transactions in format "<connection> <number of values> <result>" */
+	zbx_vector_str_t		transactions;
+}
+zbx_mock_history_db_t;
+
+static zbx_mock_history_db_t	mock_db = {.lock = PTHREAD_MUTEX_INITIALIZER, .event = PTHREAD_COND_INITIALIZER};
+
+/* values inserted by the current transaction of the thread */
+static ZBX_THREAD_LOCAL zbx_vector_sql_history_key_t	*mock_txn;
+static ZBX_THREAD_LOCAL zbx_err_codes_t			mock_errcode;
+
+int	__wrap_zbx_dbconn_open(zbx_dbconn_t *db);
+void	__wrap_zbx_dbconn_close(zbx_dbconn_t *db);
+int	__wrap_zbx_dbconn_begin(zbx_dbconn_t *db);
+int	__wrap_zbx_dbconn_commit(zbx_dbconn_t *db);
+zbx_err_codes_t	__wrap_zbx_dbconn_last_errcode(zbx_dbconn_t *db);
+const char	*__wrap_zbx_dbconn_last_strerr(zbx_dbconn_t *db);
+int	__wrap_zbx_db_insert_execute(zbx_db_insert_t *db_insert);
+zbx_db_result_t	__wrap_zbx_dbconn_select(zbx_dbconn_t *db, const char *fmt, ...);
+zbx_db_result_t	__wrap_zbx_db_vselect(const char *fmt, va_list args);
+void	__wrap_zbx_recalc_time_period(time_t *ts_from, int table_group);
+
+int	__wrap_zbx_dbconn_open(zbx_dbconn_t *db)
+{
+	ZBX_UNUSED(db);
+
+	return ZBX_DB_OK;
+}
+
+void	__wrap_zbx_dbconn_close(zbx_dbconn_t *db)
+{
+	ZBX_UNUSED(db);
+}
+
+int	__wrap_zbx_dbconn_begin(zbx_dbconn_t *db)
+{
+	ZBX_UNUSED(db);
+
+	pthread_mutex_lock(&mock_db.lock);
+
+	while (0 != mock_db.hold)
+		pthread_cond_wait(&mock_db.event, &mock_db.lock);
+
+	pthread_mutex_unlock(&mock_db.lock);
+
+	mock_txn = (zbx_vector_sql_history_key_t *)zbx_malloc(NULL, sizeof(zbx_vector_sql_history_key_t));
+	zbx_vector_sql_history_key_create(mock_txn);
+
+	return ZBX_DB_OK;
+}
+
+int	__wrap_zbx_db_insert_execute(zbx_db_insert_t *db_insert)
+{
+	for (int i = 0; i < db_insert->rows.values_num; i++)
+	{
+		const zbx_db_value_t	*values = db_insert->rows.values[i];
+		zbx_sql_history_key_t	key = {.itemid = values[0].ui64, .clock = values[1].i32, .ns = values[2].i32};
+
+		zbx_vector_sql_history_key_append(mock_txn, key);
+	}
+
+	return SUCCEED;
+}
+
+static const char	*mock_connection_name(const zbx_dbconn_t *db)
+{
+	for (int i = 0; i < async_writer.writers_num; i++)
+	{
+		if (async_writer.writers[i].db == db)
+			return "writer";
+	}
+
+	return "syncer";
+}
+
+int	__wrap_zbx_dbconn_commit(zbx_dbconn_t *db)
+{
+	const char	*result = "ok";
+
+	pthread_mutex_lock(&mock_db.lock);
+
+	if (0 < mock_db.fail_num)
+	{
+		mock_db.fail_num--;
+		mock_errcode = ERR_Z3005;
+		result = "fail";
+	}
+	else
+	{
+		for (int i = 0; i < mock_txn->values_num; i++)
+		{
+			if (FAIL != zbx_vector_sql_history_key_search(&mock_db.stored, mock_txn->values[i],
+					sql_history_key_compare))
+			{
+				mock_errcode = ERR_Z3008;
+				result = "duplicate";
+				break;
+			}
+		}
+	}
+
+	if (0 == strcmp(result, "ok"))
+		zbx_vector_sql_history_key_append_array(&mock_db.stored, mock_txn->values, mock_txn->values_num);
+
+	zbx_vector_str_append(&mock_db.transactions, zbx_dsprintf(NULL, "%s %d %s", mock_connection_name(db),
+			mock_txn->values_num, result));
+
+	pthread_mutex_unlock(&mock_db.lock);
+
+	zbx_vector_sql_history_key_destroy(mock_txn);
+	zbx_free(mock_txn);
+
+	return 0 == strcmp(result, "ok") ? ZBX_DB_OK : ZBX_DB_FAIL;
+}
+
+zbx_err_codes_t	__wrap_zbx_dbconn_last_errcode(zbx_dbconn_t *db)
+{
+	ZBX_UNUSED(db);
+
+	return mock_errcode;
+}
+
+const char	*__wrap_zbx_dbconn_last_strerr(zbx_dbconn_t *db)
+{
+	ZBX_UNUSED(db);
+
+	return "mock error";
+}
+
+/* values already stored are selected from test case database data */
+zbx_db_result_t	__wrap_zbx_dbconn_select(zbx_dbconn_t *db, const char *fmt, ...)
+{
+	zbx_db_result_t	result;
+	va_list		args;
+
+	ZBX_UNUSED(db);
+
+	va_start(args, fmt);
+	result = __wrap_zbx_db_vselect(fmt, args);
+	va_end(args);
+
+	return result;
+}
+
+void	__wrap_zbx_recalc_time_period(time_t *ts_from, int table_group)
+{
+	ZBX_UNUSED(ts_from);
+	ZBX_UNUSED(table_group);
+}
+
+static int	mock_str_to_flush_result(const char *str)
+{
+	if (0 == strcmp(str, "FLUSH_SUCCEED"))
+		return FLUSH_SUCCEED;
+
+	if (0 == strcmp(str, "FLUSH_FAIL"))
+		return FLUSH_FAIL;
+
+	if (0 == strcmp(str, "FLUSH_DUPL_REJECTED"))
+		return FLUSH_DUPL_REJECTED;
+
+	fail_msg("unknown flush result \"%s\"", str);
+
+	return FLUSH_FAIL;
+}
+
+static void	mock_read_stored(void)
+{
+	zbx_mock_handle_t	hvalues, hvalue;
+
+	hvalues = zbx_mock_get_parameter_handle("in.stored");
+
+	while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hvalues, &hvalue))
+	{
+		zbx_sql_history_key_t	key;
+
+		key.itemid = zbx_mock_get_object_member_uint64(hvalue, "itemid");
+		key.clock = zbx_mock_get_object_member_int(hvalue, "clock");
+		key.ns = zbx_mock_get_object_member_int(hvalue, "ns");
+
+		zbx_vector_sql_history_key_append(&mock_db.stored, key);
+	}
+}
+
+static void	mock_read_batch(zbx_mock_handle_t hbatch, zbx_vector_dc_history_ptr_t *history)
+{
+	zbx_mock_handle_t	hvalues, hvalue;
+
+	hvalues = zbx_mock_get_object_member_handle(hbatch, "values");
+
+	while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hvalues, &hvalue))
+	{
+		zbx_dc_history_t	*h;
+
+		h = (zbx_dc_history_t *)zbx_malloc(NULL, sizeof(zbx_dc_history_t));
+		memset(h, 0, sizeof(zbx_dc_history_t));
+
+		h->itemid = zbx_mock_get_object_member_uint64(hvalue, "itemid");
+		h->value_type = zbx_mock_str_to_value_type(zbx_mock_get_object_member_string(hvalue, "value_type"));
+		h->ts.sec = zbx_mock_get_object_member_int(hvalue, "clock");
+		h->ts.ns = zbx_mock_get_object_member_int(hvalue, "ns");
+
+		if (ITEM_VALUE_TYPE_FLOAT == h->value_type)
+			h->value.dbl = atof(zbx_mock_get_object_member_string(hvalue, "value"));
+		else
+			h->value.ui64 = zbx_mock_get_object_member_uint64(hvalue, "value");
+
+		zbx_vector_dc_history_ptr_append(history, h);
+	}
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_history_iface_t		hist_uint, hist_dbl;
+	zbx_db_config_t			*db_config;
+	zbx_vector_ptr_t		batches;
+	zbx_vector_int32_t		results;
+	zbx_mock_handle_t		hbatches, hbatch, htransactions, htransaction;
+	int				writers_num, pending = 0, i;
+	const char			*transaction;
+
+	ZBX_UNUSED(state);
+
+	zbx_mockdb_init();
+	db_config = zbx_db_config_create();
+	zbx_init_library_db(db_config);
+
+	if (ZBX_DB_OK != zbx_db_connect(ZBX_DB_CONNECT_NORMAL))
+		fail_msg("cannot connect to database");
+
+	zbx_vector_sql_history_key_create(&mock_db.stored);
+	zbx_vector_str_create(&mock_db.transactions);
+	zbx_vector_ptr_create(&batches);
+	zbx_vector_int32_create(&results);
+
+	/* test data is read before writer threads are started, as mock data access is not thread safe */
+	mock_read_stored();
+	mock_db.fail_num = zbx_mock_get_parameter_int("in.fail");
+	mock_db.hold = zbx_mock_get_parameter_int("in.hold");
+	writers_num = zbx_mock_get_parameter_int("in.writers");
+
+	hbatches = zbx_mock_get_parameter_handle("in.batches");
+
+	while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hbatches, &hbatch))
+	{
+		zbx_vector_dc_history_ptr_t	*history;
+
+		history = (zbx_vector_dc_history_ptr_t *)zbx_malloc(NULL, sizeof(zbx_vector_dc_history_ptr_t));
+		zbx_vector_dc_history_ptr_create(history);
+		mock_read_batch(hbatch, history);
+		zbx_vector_ptr_append(&batches, history);
+
+		zbx_vector_int32_append(&results,
+				mock_str_to_flush_result(zbx_mock_get_object_member_string(hbatch, "result")));
+	}
+
+	zbx_history_sql_set_writers_num(writers_num);
+	zbx_history_sql_init(&hist_uint, ITEM_VALUE_TYPE_UINT64);
+	zbx_history_sql_init(&hist_dbl, ITEM_VALUE_TYPE_FLOAT);
+
+	for (i = 0; i < batches.values_num; i++)
+	{
+		zbx_vector_dc_history_ptr_t	*history = (zbx_vector_dc_history_ptr_t *)batches.values[i];
+
+		hist_uint.add_values(&hist_uint, history, 0);
+		hist_dbl.add_values(&hist_dbl, history, 0);
+
+		/* the first flush writes bulk insert data of all history tables */
+		zbx_mock_assert_int_eq("flush result", results.values[i], hist_uint.flush(&hist_uint));
+		zbx_mock_assert_int_eq("second flush result", FLUSH_SUCCEED, hist_dbl.flush(&hist_dbl));
+	}
+
+	if (0 != mock_db.hold)
+	{
+		pthread_mutex_lock(&mock_db.lock);
+
+		for (i = 0; i < async_writer.writers_num; i++)
+			pending += async_writer.writers[i].pending;
+
+		mock_db.hold = 0;
+		pthread_cond_broadcast(&mock_db.event);
+		pthread_mutex_unlock(&mock_db.lock);
+	}
+
+	/* waits for writer threads to write the handed over batches */
+	hist_uint.destroy(&hist_uint);
+	hist_dbl.destroy(&hist_dbl);
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_parameter_exists("out.pending"))
+	{
+		zbx_mock_assert_int_eq("batches pending after flush", zbx_mock_get_parameter_int("out.pending"),
+				pending);
+	}
+
+	/* writer threads commit in any order, but transactions of the same case are alike */
+	zbx_vector_str_sort(&mock_db.transactions, ZBX_DEFAULT_STR_COMPARE_FUNC);
+
+	htransactions = zbx_mock_get_parameter_handle("out.transactions");
+
+	for (i = 0; ZBX_MOCK_SUCCESS == zbx_mock_vector_element(htransactions, &htransaction); i++)
+	{
+		if (ZBX_MOCK_SUCCESS != zbx_mock_string(htransaction, &transaction))
+			fail_msg("cannot read expected transaction #%d", i + 1);
+
+		if (i >= mock_db.transactions.values_num)
+			fail_msg("expected transaction \"%s\" was not committed", transaction);
+
+		zbx_mock_assert_str_eq("transaction", transaction, mock_db.transactions.values[i]);
+	}
+
+	zbx_mock_assert_int_eq("number of transactions", i, mock_db.transactions.values_num);
+	zbx_mock_assert_uint64_eq("lost values", zbx_mock_get_parameter_uint64("out.lost"), async_writer.values_lost);
+
+	for (i = 0; i < batches.values_num; i++)
+	{
+		zbx_vector_dc_history_ptr_t	*history = (zbx_vector_dc_history_ptr_t *)batches.values[i];
+
+		for (int j = 0; j < history->values_num; j++)
+			zbx_free(history->values[j]);
+
+		zbx_vector_dc_history_ptr_destroy(history);
+		zbx_free(history);
+	}
+
+	zbx_vector_ptr_destroy(&batches);
+	zbx_vector_int32_destroy(&results);
+	zbx_vector_str_clear_ext(&mock_db.transactions, zbx_str_free);
+	zbx_vector_str_destroy(&mock_db.transactions);
+	zbx_vector_sql_history_key_destroy(&mock_db.stored);
+
+	zbx_db_close();
+	zbx_db_config_free(db_config);
+	zbx_mockdb_destroy();
+}
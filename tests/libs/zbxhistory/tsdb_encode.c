@@ -0,0 +1,103 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "../../../src/libs/zbxhistory/history_tsdb.c"
+
+void	__wrap_zbx_recalc_time_period(time_t *ts_from, int table_group);
+
+void	__wrap_zbx_recalc_time_period(time_t *ts_from, int table_group)
+{
+	ZBX_UNUSED(ts_from);
+	ZBX_UNUSED(table_group);
+}
+
+static void	read_value(zbx_mock_handle_t hvalue, unsigned char value_type, zbx_timespec_t *ts,
+		zbx_uint64_t *bits)
+{
+	const char		*data;
+	zbx_history_value_t	value;
+	zbx_mock_error_t	err;
+
+	data = zbx_mock_get_object_member_string(hvalue, "ts");
+	if (ZBX_MOCK_SUCCESS != (err = zbx_strtime_to_timespec(data, ts)))
+		fail_msg("Invalid value timestamp \"%s\": %s", data, zbx_mock_error_string(err));
+
+	data = zbx_mock_get_object_member_string(hvalue, "value");
+
+	if (ITEM_VALUE_TYPE_UINT64 == value_type)
+	{
+		if (FAIL == zbx_is_uint64(data, &value.ui64))
+			fail_msg("Invalid uint64 value \"%s\"", data);
+	}
+	else
+		value.dbl = atof(data);
+
+	*bits = tsdb_value2bits(&value, value_type);
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_mock_handle_t	hvalues, hvalue;
+	zbx_tsdb_bits_t		bs = {0};
+	zbx_tsdb_codec_t	codec;
+	zbx_timespec_t		ts;
+	zbx_uint64_t		bits;
+	unsigned char		value_type;
+	size_t			pos = 0;
+	int			i;
+
+	ZBX_UNUSED(state);
+
+	value_type = zbx_mock_str_to_value_type(zbx_mock_get_parameter_string("in['value type']"));
+	hvalues = zbx_mock_get_parameter_handle("in.values");
+
+	memset(&codec, 0, sizeof(codec));
+
+	for (i = 0; ZBX_MOCK_END_OF_VECTOR != zbx_mock_vector_element(hvalues, &hvalue); i++)
+	{
+		read_value(hvalue, value_type, &ts, &bits);
+		tsdb_encode(&bs, &codec, &ts, bits, 0 == i);
+	}
+
+	zbx_mock_assert_uint64_eq("encoded bits", zbx_mock_get_parameter_uint64("out.bits"), bs.bits);
+
+	hvalues = zbx_mock_get_parameter_handle("in.values");
+	memset(&codec, 0, sizeof(codec));
+
+	for (i = 0; ZBX_MOCK_END_OF_VECTOR != zbx_mock_vector_element(hvalues, &hvalue); i++)
+	{
+		zbx_timespec_t	ts_decoded;
+		zbx_uint64_t	bits_decoded;
+
+		read_value(hvalue, value_type, &ts, &bits);
+
+		if (SUCCEED != tsdb_decode(bs.data, (bs.bits + 7) / 8, &pos, &codec, &ts_decoded, &bits_decoded,
+				0 == i))
+		{
+			fail_msg("cannot decode value #%d", i);
+		}
+
+		zbx_mock_assert_timespec_eq("decoded timestamp", &ts, &ts_decoded);
+		zbx_mock_assert_uint64_eq("decoded value", bits, bits_decoded);
+	}
+
+	zbx_mock_assert_uint64_eq("decoded bits", bs.bits, pos);
+
+	zbx_free(bs.data);
+}
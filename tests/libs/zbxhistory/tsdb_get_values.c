@@ -0,0 +1,357 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxcommon.h"
+
+int		__real_open(const char *path, int oflag, ...);
+int		__real_stat(const char *path, struct stat *buf);
+DIR		*__real_opendir(const char *name);
+struct dirent	*__real_readdir(DIR *dirp);
+
+/* local history storage is tested on real files, bypass the file system mocks */
+#define open(...)		__real_open(__VA_ARGS__)
+#define stat(path, buf)		__real_stat(path, buf)
+#define opendir(name)		__real_opendir(name)
+#define readdir(dirp)		__real_readdir(dirp)
+
+#include "../../../src/libs/zbxhistory/history_tsdb.c"
+
+void	__wrap_zbx_recalc_time_period(time_t *ts_from, int table_group);
+time_t	__real_time(time_t *t);
+time_t	__wrap_time(time_t *t);
+
+/* current time set by test steps, real time is used if not set */
+static time_t	mock_now;
+
+time_t	__wrap_time(time_t *t)
+{
+	time_t	now = (0 != mock_now ? mock_now : __real_time(NULL));
+
+	if (NULL != t)
+		*t = now;
+
+	return now;
+}
+
+void	__wrap_zbx_recalc_time_period(time_t *ts_from, int table_group)
+{
+	ZBX_UNUSED(ts_from);
+	ZBX_UNUSED(table_group);
+}
+
+static void	read_value(zbx_mock_handle_t hvalue, unsigned char value_type, zbx_history_value_t *value,
+		zbx_timespec_t *ts)
+{
+	const char		*data;
+	zbx_mock_error_t	err;
+
+	data = zbx_mock_get_object_member_string(hvalue, "ts");
+	if (ZBX_MOCK_SUCCESS != (err = zbx_strtime_to_timespec(data, ts)))
+		fail_msg("Invalid value timestamp \"%s\": %s", data, zbx_mock_error_string(err));
+
+	data = zbx_mock_get_object_member_string(hvalue, "value");
+
+	if (ITEM_VALUE_TYPE_UINT64 == value_type)
+	{
+		if (FAIL == zbx_is_uint64(data, &value->ui64))
+			fail_msg("Invalid uint64 value \"%s\"", data);
+	}
+	else
+		value->dbl = atof(data);
+}
+
+static int	read_time(zbx_mock_handle_t hobject, const char *name)
+{
+	zbx_timespec_t		ts;
+	const char		*data;
+	zbx_mock_error_t	err;
+
+	data = zbx_mock_get_object_member_string(hobject, name);
+	if (ZBX_MOCK_SUCCESS != (err = zbx_strtime_to_timespec(data, &ts)))
+		fail_msg("Invalid %s timestamp \"%s\": %s", name, data, zbx_mock_error_string(err));
+
+	return ts.sec;
+}
+
+static void	tsdb_mock_add(zbx_history_iface_t *hist, zbx_mock_handle_t hvalues)
+{
+	zbx_mock_handle_t		hvalue;
+	zbx_vector_dc_history_ptr_t	history;
+	zbx_dc_history_t		*h;
+
+	zbx_vector_dc_history_ptr_create(&history);
+
+	while (ZBX_MOCK_END_OF_VECTOR != zbx_mock_vector_element(hvalues, &hvalue))
+	{
+		h = (zbx_dc_history_t *)zbx_malloc(NULL, sizeof(zbx_dc_history_t));
+		memset(h, 0, sizeof(zbx_dc_history_t));
+		h->itemid = zbx_mock_get_object_member_uint64(hvalue, "itemid");
+		h->value_type = hist->value_type;
+		read_value(hvalue, hist->value_type, &h->value, &h->ts);
+		zbx_vector_dc_history_ptr_append(&history, h);
+	}
+
+	zbx_mock_assert_int_eq("add_values()", history.values_num, hist->add_values(hist, &history, 0));
+	zbx_mock_assert_int_eq("flush()", FLUSH_SUCCEED, hist->flush(hist));
+
+	zbx_vector_dc_history_ptr_clear_ext(&history, (zbx_dc_history_ptr_free_func_t)zbx_ptr_free);
+	zbx_vector_dc_history_ptr_destroy(&history);
+}
+
+static void	tsdb_mock_get(zbx_history_iface_t *hist, zbx_mock_handle_t hget)
+{
+	zbx_mock_handle_t		hvalues, hvalue;
+	zbx_vector_history_record_t	values;
+	zbx_history_record_t		expected;
+	int				i, start, end, count;
+
+	start = read_time(hget, "start");
+	end = read_time(hget, "end");
+	count = zbx_mock_get_object_member_int(hget, "count");
+
+	zbx_history_record_vector_create(&values);
+
+	zbx_mock_assert_result_eq("get_values()", SUCCEED, hist->get_values(hist,
+			zbx_mock_get_object_member_uint64(hget, "itemid"), start, count, end, &values));
+
+	zbx_vector_history_record_sort(&values, (zbx_compare_func_t)zbx_history_record_compare_desc_func);
+
+	hvalues = zbx_mock_get_object_member_handle(hget, "values");
+
+	for (i = 0; ZBX_MOCK_END_OF_VECTOR != zbx_mock_vector_element(hvalues, &hvalue); i++)
+	{
+		if (i >= values.values_num)
+			fail_msg("expected more than %d values", values.values_num);
+
+		read_value(hvalue, hist->value_type, &expected.value, &expected.timestamp);
+
+		zbx_mock_assert_timespec_eq("returned timestamp", &expected.timestamp, &values.values[i].timestamp);
+
+		if (ITEM_VALUE_TYPE_UINT64 == hist->value_type)
+			zbx_mock_assert_uint64_eq("returned value", expected.value.ui64, values.values[i].value.ui64);
+		else
+			zbx_mock_assert_double_eq("returned value", expected.value.dbl, values.values[i].value.dbl);
+	}
+
+	zbx_mock_assert_int_eq("returned values", i, values.values_num);
+
+	zbx_history_record_vector_destroy(&values, hist->value_type);
+}
+
+static int	tsdb_mock_block(zbx_mock_handle_t hobject)
+{
+	return tsdb_block_start(read_time(hobject, "block"));
+}
+
+static int	tsdb_mock_compare_chunks(const void *d1, const void *d2)
+{
+	const zbx_tsdb_chunk_t	*c1 = (const zbx_tsdb_chunk_t *)d1;
+	const zbx_tsdb_chunk_t	*c2 = (const zbx_tsdb_chunk_t *)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(c1->itemid, c2->itemid);
+	ZBX_RETURN_IF_NOT_EQUAL(c1->first, c2->first);
+
+	return 0;
+}
+
+static double	tsdb_mock_summary(zbx_uint64_t bits, unsigned char value_type)
+{
+	zbx_history_value_t	value;
+
+	tsdb_bits2value(bits, value_type, &value);
+
+	return ITEM_VALUE_TYPE_UINT64 == value_type ? (double)value.ui64 : value.dbl;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks chunk headers written to time block segment file           *
+ *                                                                            *
+ ******************************************************************************/
+static void	tsdb_mock_check_chunks(zbx_history_iface_t *hist, zbx_mock_handle_t hcheck)
+{
+	zbx_tsdb_data_t		*data = (zbx_tsdb_data_t *)hist->data.tsdb_data;
+	zbx_mock_handle_t	hchunks, hchunk;
+	zbx_tsdb_chunk_t	*chunks = NULL;
+	char			path[MAX_STRING_LEN];
+	int			fd, i, chunks_num = 0;
+	off_t			offset = 0;
+
+	tsdb_block_path(data, tsdb_mock_block(hcheck), path, sizeof(path));
+
+	if (-1 != (fd = open(path, O_RDONLY)))
+	{
+		zbx_tsdb_chunk_t	chunk;
+
+		while (sizeof(chunk) == pread(fd, &chunk, sizeof(chunk), offset))
+		{
+			zbx_mock_assert_uint64_eq("chunk magic", ZBX_TSDB_CHUNK_MAGIC, chunk.magic);
+
+			chunks = (zbx_tsdb_chunk_t *)zbx_realloc(chunks, sizeof(zbx_tsdb_chunk_t) *
+					(size_t)(chunks_num + 1));
+			chunks[chunks_num++] = chunk;
+			offset += (off_t)(sizeof(chunk) + chunk.size);
+		}
+
+		close(fd);
+	}
+
+	/* chunks of one flush are written in undefined item order */
+	if (0 != chunks_num)
+		qsort(chunks, (size_t)chunks_num, sizeof(zbx_tsdb_chunk_t), tsdb_mock_compare_chunks);
+
+	hchunks = zbx_mock_get_object_member_handle(hcheck, "chunks");
+
+	for (i = 0; ZBX_MOCK_END_OF_VECTOR != zbx_mock_vector_element(hchunks, &hchunk); i++)
+	{
+		if (i >= chunks_num)
+			fail_msg("expected more than %d chunks", chunks_num);
+
+		zbx_mock_assert_uint64_eq("chunk itemid", zbx_mock_get_object_member_uint64(hchunk, "itemid"),
+				chunks[i].itemid);
+		zbx_mock_assert_int_eq("chunk values", zbx_mock_get_object_member_int(hchunk, "count"),
+				(int)chunks[i].count);
+		zbx_mock_assert_double_eq("chunk min", atof(zbx_mock_get_object_member_string(hchunk, "min")),
+				tsdb_mock_summary(chunks[i].min, hist->value_type));
+		zbx_mock_assert_double_eq("chunk max", atof(zbx_mock_get_object_member_string(hchunk, "max")),
+				tsdb_mock_summary(chunks[i].max, hist->value_type));
+		zbx_mock_assert_double_eq("chunk sum", atof(zbx_mock_get_object_member_string(hchunk, "sum")),
+				chunks[i].sum);
+	}
+
+	zbx_mock_assert_int_eq("chunks", i, chunks_num);
+
+	zbx_free(chunks);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: appends invalid data to time block segment file                   *
+ *                                                                            *
+ ******************************************************************************/
+static void	tsdb_mock_corrupt(zbx_history_iface_t *hist, zbx_mock_handle_t hcorrupt)
+{
+	char	path[MAX_STRING_LEN], *garbage;
+	int	fd, size;
+
+	tsdb_block_path((zbx_tsdb_data_t *)hist->data.tsdb_data, tsdb_mock_block(hcorrupt), path, sizeof(path));
+	size = zbx_mock_get_object_member_int(hcorrupt, "size");
+
+	garbage = (char *)zbx_malloc(NULL, (size_t)size);
+	memset(garbage, 0x5a, (size_t)size);
+
+	if (-1 == (fd = open(path, O_WRONLY | O_APPEND)))
+		fail_msg("cannot open \"%s\": %s", path, zbx_strerror(errno));
+
+	if (size != write(fd, garbage, (size_t)size))
+		fail_msg("cannot write to \"%s\": %s", path, zbx_strerror(errno));
+
+	close(fd);
+	zbx_free(garbage);
+}
+
+static void	tsdb_mock_check_indexed(zbx_history_iface_t *hist, int expected)
+{
+	zbx_tsdb_data_t	*data = (zbx_tsdb_data_t *)hist->data.tsdb_data;
+	int		indexed = 0;
+
+	for (int i = 0; i < data->blocks.values_num; i++)
+	{
+		if (-1 != data->blocks.values[i]->fd)
+			indexed++;
+	}
+
+	zbx_mock_assert_int_eq("indexed blocks", expected, indexed);
+}
+
+static void	tsdb_mock_remove_dir(const char *path)
+{
+	DIR		*dir;
+	struct dirent	*entry;
+	char		*file;
+
+	if (NULL == (dir = opendir(path)))
+		return;
+
+	while (NULL != (entry = readdir(dir)))
+	{
+		if ('.' == *entry->d_name)
+			continue;
+
+		file = zbx_dsprintf(NULL, "%s/%s", path, entry->d_name);
+		unlink(file);
+		zbx_free(file);
+	}
+
+	closedir(dir);
+	rmdir(path);
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_history_iface_t	hist;
+	zbx_mock_handle_t	hsteps, hstep, hmember;
+	char			template[] = "/tmp/zbx_tsdb_XXXXXX", *dir;
+	unsigned char		value_type;
+
+	ZBX_UNUSED(state);
+
+	if (NULL == (dir = mkdtemp(template)))
+		fail_msg("cannot create temporary directory: %s", zbx_strerror(errno));
+
+	value_type = zbx_mock_str_to_value_type(zbx_mock_get_parameter_string("in['value type']"));
+	tsdb_iface_init(&hist, value_type, zbx_strdup(NULL, dir));
+
+	hsteps = zbx_mock_get_parameter_handle("in.steps");
+
+	while (ZBX_MOCK_END_OF_VECTOR != zbx_mock_vector_element(hsteps, &hstep))
+	{
+		if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hstep, "add", &hmember))
+		{
+			tsdb_mock_add(&hist, hmember);
+		}
+		else if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hstep, "time", &hmember))
+		{
+			mock_now = read_time(hstep, "time");
+		}
+		else if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hstep, "reopen", &hmember))
+		{
+			/* new interface sees only data written by the previous one, as another process would */
+			hist.destroy(&hist);
+			tsdb_iface_init(&hist, value_type, zbx_strdup(NULL, dir));
+		}
+		else if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hstep, "file", &hmember))
+		{
+			tsdb_mock_check_chunks(&hist, hmember);
+		}
+		else if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hstep, "corrupt", &hmember))
+		{
+			tsdb_mock_corrupt(&hist, hmember);
+		}
+		else if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hstep, "indexed", &hmember))
+		{
+			tsdb_mock_check_indexed(&hist, zbx_mock_get_object_member_int(hstep, "indexed"));
+		}
+		else
+			tsdb_mock_get(&hist, zbx_mock_get_object_member_handle(hstep, "get"));
+	}
+
+	hist.destroy(&hist);
+	tsdb_mock_remove_dir(dir);
+}
@@ -0,0 +1,300 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+/* Compares local history storage with database history tables on the same generated workload:     */
+/* values are added and flushed in batches as by history syncer, then read by time range and by     */
+/* count as by value cache. The program is not a unit test and is built only on demand:             */
+/*                                                                                                  */
+/*   make -C tests/libs/zbxhistory tsdb_sql_benchmark                                               */
+/*   tests/libs/zbxhistory/tsdb_sql_benchmark -d zabbix -u zabbix -p <password> -D /tmp/tsdb        */
+/*                                                                                                  */
+/* Values are written to history_uint table of the specified database for item identifiers          */
+/* starting with -b option and are deleted when the benchmark finishes.                             */
+
+#include "zbxcommon.h"
+#include "zbxdb.h"
+#include "zbxdbhigh.h"
+#include "zbxtime.h"
+#include "zbxlog.h"
+#include "zbxnix.h"
+
+#include "../../../src/libs/zbxhistory/history_tsdb.c"
+
+time_t	__real_time(time_t *t);
+time_t	__wrap_time(time_t *t);
+
+/* simulated current time, values are added as they would be collected */
+static time_t	bench_now;
+
+time_t	__wrap_time(time_t *t)
+{
+	time_t	now = (0 != bench_now ? bench_now : __real_time(NULL));
+
+	if (NULL != t)
+		*t = now;
+
+	return now;
+}
+
+/* configuration cache is not available, expired blocks are not removed */
+void	zbx_recalc_time_period(time_t *ts_from, int table_group)
+{
+	ZBX_UNUSED(ts_from);
+	ZBX_UNUSED(table_group);
+}
+
+ZBX_GET_CONFIG_VAR2(const char *, const char *, zbx_progname, "tsdb_sql_benchmark")
+
+typedef struct
+{
+	zbx_uint64_t	itemid_base;
+	int		items;
+	int		values;
+	int		interval;
+	int		reads;
+}
+zbx_bench_options_t;
+
+typedef struct
+{
+	double	flush;
+	double	read_range;
+	double	read_last;
+	int	read_values;
+}
+zbx_bench_result_t;
+
+static void	bench_write(zbx_history_iface_t *hist, const zbx_bench_options_t *opts, int start, double *elapsed)
+{
+	zbx_vector_dc_history_ptr_t	history;
+	zbx_dc_history_t		*values;
+	double				sec;
+
+	values = (zbx_dc_history_t *)zbx_malloc(NULL, sizeof(zbx_dc_history_t) * (size_t)opts->items);
+	memset(values, 0, sizeof(zbx_dc_history_t) * (size_t)opts->items);
+
+	zbx_vector_dc_history_ptr_create(&history);
+	zbx_vector_dc_history_ptr_reserve(&history, (size_t)opts->items);
+
+	for (int i = 0; i < opts->items; i++)
+	{
+		values[i].itemid = opts->itemid_base + (zbx_uint64_t)i;
+		values[i].value_type = ITEM_VALUE_TYPE_UINT64;
+		zbx_vector_dc_history_ptr_append(&history, &values[i]);
+	}
+
+	for (int n = 0; n < opts->values; n++)
+	{
+		int	clock = start + n * opts->interval;
+
+		for (int i = 0; i < opts->items; i++)
+		{
+			/* counter like values that compress as real data does */
+			values[i].ts.sec = clock + i % opts->interval;
+			values[i].ts.ns = 0;
+			values[i].value.ui64 = (zbx_uint64_t)(n * (i + 1)) + (zbx_uint64_t)(n % 7);
+		}
+
+		bench_now = values[0].ts.sec + opts->interval;
+
+		sec = zbx_time();
+		hist->add_values(hist, &history, 0);
+
+		if (FLUSH_SUCCEED != hist->flush(hist))
+		{
+			zbx_error("cannot flush history");
+			exit(EXIT_FAILURE);
+		}
+
+		*elapsed += zbx_time() - sec;
+	}
+
+	zbx_vector_dc_history_ptr_destroy(&history);
+	zbx_free(values);
+}
+
+static void	bench_read(zbx_history_iface_t *hist, const zbx_bench_options_t *opts, int start,
+		zbx_bench_result_t *result)
+{
+	zbx_vector_history_record_t	values;
+	int				end = start + opts->values * opts->interval;
+	double				sec;
+
+	zbx_history_record_vector_create(&values);
+
+	for (int r = 0; r < opts->reads; r++)
+	{
+		for (int i = 0; i < opts->items; i++)
+		{
+			zbx_uint64_t	itemid = opts->itemid_base + (zbx_uint64_t)i;
+
+			/* last hour, as trigger functions and value cache requests after restart */
+			sec = zbx_time();
+			hist->get_values(hist, itemid, end - SEC_PER_HOUR, 0, end, &values);
+			result->read_range += zbx_time() - sec;
+			result->read_values += values.values_num;
+			zbx_history_record_vector_clean(&values, ITEM_VALUE_TYPE_UINT64);
+
+			sec = zbx_time();
+			hist->get_values(hist, itemid, 0, 1, end, &values);
+			result->read_last += zbx_time() - sec;
+			result->read_values += values.values_num;
+			zbx_history_record_vector_clean(&values, ITEM_VALUE_TYPE_UINT64);
+		}
+	}
+
+	zbx_history_record_vector_destroy(&values, ITEM_VALUE_TYPE_UINT64);
+}
+
+static void	bench_run(zbx_history_iface_t *hist, const zbx_bench_options_t *opts, int start,
+		zbx_bench_result_t *result)
+{
+	memset(result, 0, sizeof(zbx_bench_result_t));
+
+	bench_write(hist, opts, start, &result->flush);
+
+	/* values are read after collection, values still buffered by local storage are read from memory */
+	bench_now = 0;
+	bench_read(hist, opts, start, result);
+}
+
+static void	bench_print(const char *name, const zbx_bench_options_t *opts, const zbx_bench_result_t *result)
+{
+	int	reads = opts->items * opts->reads;
+
+	printf("%-8s write: %10.3f s %10.0f values/s | range read: %8.3f ms | last value read: %8.3f ms |"
+			" values read: %d\n", name, result->flush,
+			(double)opts->items * opts->values / result->flush, result->read_range * 1000 / reads,
+			result->read_last * 1000 / reads, result->read_values);
+}
+
+static void	bench_usage(void)
+{
+	printf("usage: %s -D dir [-h dbhost] [-P dbport] [-s dbsocket] [-d dbname] [-u dbuser] [-p dbpassword]\n"
+			"       [-i items] [-n values per item] [-t interval] [-r reads] [-b itemid base]\n",
+			zbx_progname);
+}
+
+int	main(int argc, char **argv)
+{
+	zbx_db_config_t		*db_config;
+	zbx_bench_options_t	opts = {.itemid_base = ZBX_DB_MAX_ID - 1000000, .items = 1000, .values = 1440,
+				.interval = SEC_PER_MIN, .reads = 1};
+	zbx_bench_result_t	sql_result, tsdb_result;
+	zbx_history_iface_t	hist;
+	char			*dir = NULL, *error = NULL;
+	int			ch, start;
+
+	zbx_init_library_common(zbx_log_impl, get_zbx_progname, zbx_backtrace);
+	zbx_init_library_nix(get_zbx_progname, NULL);
+
+	db_config = zbx_db_config_create();
+
+	while (-1 != (ch = getopt(argc, argv, "h:P:s:d:u:p:D:i:n:t:r:b:")))
+	{
+		switch (ch)
+		{
+			case 'h':
+				db_config->dbhost = zbx_strdup(db_config->dbhost, optarg);
+				break;
+			case 'P':
+				db_config->dbport = (unsigned int)atoi(optarg);
+				break;
+			case 's':
+				db_config->dbsocket = zbx_strdup(db_config->dbsocket, optarg);
+				break;
+			case 'd':
+				db_config->dbname = zbx_strdup(db_config->dbname, optarg);
+				break;
+			case 'u':
+				db_config->dbuser = zbx_strdup(db_config->dbuser, optarg);
+				break;
+			case 'p':
+				db_config->dbpassword = zbx_strdup(db_config->dbpassword, optarg);
+				break;
+			case 'D':
+				dir = zbx_strdup(dir, optarg);
+				break;
+			case 'i':
+				opts.items = atoi(optarg);
+				break;
+			case 'n':
+				opts.values = atoi(optarg);
+				break;
+			case 't':
+				opts.interval = atoi(optarg);
+				break;
+			case 'r':
+				opts.reads = atoi(optarg);
+				break;
+			case 'b':
+				ZBX_STR2UINT64(opts.itemid_base, optarg);
+				break;
+			default:
+				bench_usage();
+				exit(EXIT_FAILURE);
+		}
+	}
+
+	if (NULL == dir || 0 >= opts.items || 0 >= opts.values || 0 >= opts.interval || 0 >= opts.reads)
+	{
+		bench_usage();
+		exit(EXIT_FAILURE);
+	}
+
+	zbx_init_library_db(db_config);
+
+	if (SUCCEED != zbx_db_init(&error))
+	{
+		zbx_error("cannot initialize database: %s", error);
+		exit(EXIT_FAILURE);
+	}
+
+	if (ZBX_DB_OK != zbx_db_connect(ZBX_DB_CONNECT_ONCE))
+	{
+		zbx_error("cannot connect to database");
+		exit(EXIT_FAILURE);
+	}
+
+	if (0 != mkdir(dir, 0750) && EEXIST != errno)
+	{
+		zbx_error("cannot create directory \"%s\": %s", dir, zbx_strerror(errno));
+		exit(EXIT_FAILURE);
+	}
+
+	/* align to time block so that both storages get the same values in the same number of blocks */
+	start = tsdb_block_start((int)time(NULL)) - opts.values * opts.interval;
+
+	printf("items: %d, values per item: %d, interval: %d s\n", opts.items, opts.values, opts.interval);
+
+	zbx_history_sql_init(&hist, ITEM_VALUE_TYPE_UINT64);
+	bench_run(&hist, &opts, start, &sql_result);
+	hist.destroy(&hist);
+	bench_print("database", &opts, &sql_result);
+
+	/* storage takes ownership of the directory path */
+	tsdb_iface_init(&hist, ITEM_VALUE_TYPE_UINT64, dir);
+	bench_run(&hist, &opts, start, &tsdb_result);
+	hist.destroy(&hist);
+	bench_print("local", &opts, &tsdb_result);
+
+	zbx_db_execute("delete from history_uint where itemid between " ZBX_FS_UI64 " and " ZBX_FS_UI64,
+			opts.itemid_base, opts.itemid_base + (zbx_uint64_t)opts.items - 1);
+
+	zbx_db_close();
+	zbx_db_deinit();
+	zbx_db_config_free(db_config);
+
+	return EXIT_SUCCESS;
+}
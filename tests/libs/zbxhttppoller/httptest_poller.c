@@ -0,0 +1,456 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+#include "zbxmockdb.h"
+
+#include "../../../src/libs/zbxhttppoller/httptest.c"
+
+/* Web scenarios are loaded from mocked database and executed against a stub HTTP server running in a child */
+/* process. The server replies with responses listed in test case and reports every received request.       */
+
+static char			stub_port[ZBX_INTERFACE_PORT_LEN_MAX];
+static zbx_mock_handle_t	httptests;
+static zbx_vector_str_t		values, queued;
+
+int	__wrap_zbx_dc_httptest_next(time_t now, zbx_uint64_t *httptestid, time_t *nextcheck);
+void	__wrap_zbx_dc_httptest_queue(time_t now, zbx_uint64_t httptestid, int delay);
+zbx_dc_um_handle_t	*__wrap_zbx_dc_open_user_macros(void);
+zbx_dc_um_handle_t	*__wrap_zbx_dc_open_user_macros_secure(void);
+zbx_dc_um_handle_t	*__wrap_zbx_dc_open_user_macros_masked(void);
+void	__wrap_zbx_dc_close_user_macros(zbx_dc_um_handle_t *um_handle);
+void	__wrap_zbx_dc_get_user_macro(const zbx_dc_um_handle_t *um_handle, const char *macro,
+		const zbx_uint64_t *hostids, int hostids_num, char **value);
+int	__wrap_zbx_dc_expand_user_and_func_macros(const zbx_dc_um_handle_t *um_handle, char **text,
+		const zbx_uint64_t *hostids, int hostids_num, char **error);
+int	__wrap_zbx_dc_config_get_interface(zbx_dc_interface_t *interface, zbx_uint64_t hostid, zbx_uint64_t itemid);
+void	__wrap_zbx_dc_config_get_items_by_itemids(zbx_dc_item_t *items, const zbx_uint64_t *itemids, int *errcodes,
+		size_t num);
+void	__wrap_zbx_dc_config_clean_items(zbx_dc_item_t *items, int *errcodes, size_t num);
+void	__wrap_zbx_preprocess_item_value(zbx_uint64_t itemid, zbx_uint64_t hostid, unsigned char item_value_type,
+		unsigned char item_flags, AGENT_RESULT *result, zbx_timespec_t *ts, unsigned char state, char *error);
+
+int	__wrap_zbx_dc_httptest_next(time_t now, zbx_uint64_t *httptestid, time_t *nextcheck)
+{
+	zbx_mock_handle_t	hid;
+
+	ZBX_UNUSED(now);
+
+	*nextcheck = 0;
+
+	if (ZBX_MOCK_SUCCESS != zbx_mock_vector_element(httptests, &hid))
+		return FAIL;
+
+	if (ZBX_MOCK_SUCCESS != zbx_mock_uint64(hid, httptestid))
+		fail_msg("invalid web scenario identifier");
+
+	return SUCCEED;
+}
+
+void	__wrap_zbx_dc_httptest_queue(time_t now, zbx_uint64_t httptestid, int delay)
+{
+	ZBX_UNUSED(now);
+
+	zbx_vector_str_append(&queued, zbx_dsprintf(NULL, ZBX_FS_UI64 ":%d", httptestid, delay));
+}
+
+zbx_dc_um_handle_t	*__wrap_zbx_dc_open_user_macros(void)
+{
+	return NULL;
+}
+
+zbx_dc_um_handle_t	*__wrap_zbx_dc_open_user_macros_secure(void)
+{
+	return NULL;
+}
+
+zbx_dc_um_handle_t	*__wrap_zbx_dc_open_user_macros_masked(void)
+{
+	return NULL;
+}
+
+void	__wrap_zbx_dc_close_user_macros(zbx_dc_um_handle_t *um_handle)
+{
+	ZBX_UNUSED(um_handle);
+}
+
+void	__wrap_zbx_dc_get_user_macro(const zbx_dc_um_handle_t *um_handle, const char *macro,
+		const zbx_uint64_t *hostids, int hostids_num, char **value)
+{
+	ZBX_UNUSED(um_handle);
+	ZBX_UNUSED(macro);
+	ZBX_UNUSED(hostids);
+	ZBX_UNUSED(hostids_num);
+	ZBX_UNUSED(value);
+}
+
+int	__wrap_zbx_dc_expand_user_and_func_macros(const zbx_dc_um_handle_t *um_handle, char **text,
+		const zbx_uint64_t *hostids, int hostids_num, char **error)
+{
+	ZBX_UNUSED(um_handle);
+	ZBX_UNUSED(text);
+	ZBX_UNUSED(hostids);
+	ZBX_UNUSED(hostids_num);
+	ZBX_UNUSED(error);
+
+	return SUCCEED;
+}
+
+/* host interface points to the stub server so step URLs can use {HOST.CONN} and {HOST.PORT} macros */
+int	__wrap_zbx_dc_config_get_interface(zbx_dc_interface_t *interface, zbx_uint64_t hostid, zbx_uint64_t itemid)
+{
+	static char	addr[] = "127.0.0.1";
+
+	ZBX_UNUSED(hostid);
+	ZBX_UNUSED(itemid);
+
+	memset(interface, 0, sizeof(zbx_dc_interface_t));
+	zbx_strscpy(interface->ip_orig, addr);
+	zbx_strscpy(interface->port_orig, stub_port);
+	interface->addr = addr;
+	interface->useip = 1;
+
+	return SUCCEED;
+}
+
+void	__wrap_zbx_dc_config_get_items_by_itemids(zbx_dc_item_t *items, const zbx_uint64_t *itemids, int *errcodes,
+		size_t num)
+{
+	for (size_t i = 0; i < num; i++)
+	{
+		memset(&items[i], 0, sizeof(zbx_dc_item_t));
+		items[i].itemid = itemids[i];
+		items[i].status = ITEM_STATUS_ACTIVE;
+		items[i].host.status = HOST_STATUS_MONITORED;
+		errcodes[i] = SUCCEED;
+	}
+}
+
+void	__wrap_zbx_dc_config_clean_items(zbx_dc_item_t *items, int *errcodes, size_t num)
+{
+	ZBX_UNUSED(items);
+	ZBX_UNUSED(errcodes);
+	ZBX_UNUSED(num);
+}
+
+void	__wrap_zbx_preprocess_item_value(zbx_uint64_t itemid, zbx_uint64_t hostid, unsigned char item_value_type,
+		unsigned char item_flags, AGENT_RESULT *result, zbx_timespec_t *ts, unsigned char state, char *error)
+{
+	ZBX_UNUSED(hostid);
+	ZBX_UNUSED(item_value_type);
+	ZBX_UNUSED(item_flags);
+	ZBX_UNUSED(ts);
+	ZBX_UNUSED(state);
+	ZBX_UNUSED(error);
+
+	if (ZBX_ISSET_UI64(result))
+		zbx_vector_str_append(&values, zbx_dsprintf(NULL, ZBX_FS_UI64 ":" ZBX_FS_UI64, itemid, result->ui64));
+	else if (ZBX_ISSET_STR(result))
+		zbx_vector_str_append(&values, zbx_dsprintf(NULL, ZBX_FS_UI64 ":%s", itemid, result->str));
+	else
+		zbx_vector_str_append(&values, zbx_dsprintf(NULL, ZBX_FS_UI64 ":*", itemid));
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: reads HTTP request and writes its method, path, cookies and body  *
+ *          to the report socket                                              *
+ *                                                                            *
+ ******************************************************************************/
+static void	stub_read_request(int fd, int report)
+{
+	char		*req = NULL, *body, *report_line = NULL, *ptr;
+	size_t		req_alloc = 0, req_offset = 0, report_alloc = 0, report_offset = 0, size = 0, body_offset = 0;
+	const char	*cl, *cookie;
+
+	while (1)
+	{
+		char	buf[4096];
+		ssize_t	n;
+
+		if (0 >= (n = recv(fd, buf, sizeof(buf), 0)))
+			break;
+
+		zbx_strncpy_alloc(&req, &req_alloc, &req_offset, buf, (size_t)n);
+
+		/* buffer can be reallocated, so body is referenced by offset */
+		if (0 == body_offset && NULL != (body = strstr(req, "\r\n\r\n")))
+		{
+			body_offset = (size_t)(body - req) + 4;
+
+			if (NULL != (cl = zbx_strcasestr(req, "Content-Length:")) && cl < body)
+				size = strtoul(cl + ZBX_CONST_STRLEN("Content-Length:"), NULL, 10);
+		}
+
+		if (0 != body_offset && req_offset >= body_offset + size)
+			break;
+	}
+
+	if (0 == body_offset)
+		goto out;
+
+	body = req + body_offset;
+
+	/* request line without protocol version */
+	if (NULL != (ptr = strstr(req, " HTTP/")))
+		zbx_strncpy_alloc(&report_line, &report_alloc, &report_offset, req, (size_t)(ptr - req));
+
+	if (NULL != (cookie = zbx_strcasestr(req, "\r\nCookie: ")) && cookie < body)
+	{
+		cookie += ZBX_CONST_STRLEN("\r\nCookie: ");
+		zbx_strcpy_alloc(&report_line, &report_alloc, &report_offset, " cookie:");
+		zbx_strncpy_alloc(&report_line, &report_alloc, &report_offset, cookie, strcspn(cookie, "\r\n"));
+	}
+
+	if ('\0' != *body)
+		zbx_snprintf_alloc(&report_line, &report_alloc, &report_offset, " body:%s", body);
+out:
+	zbx_chrcpy_alloc(&report_line, &report_alloc, &report_offset, '\n');
+
+	if ((ssize_t)report_offset != send(report, report_line, report_offset, 0))
+		_exit(EXIT_FAILURE);
+
+	zbx_free(report_line);
+	zbx_free(req);
+}
+
+static void	stub_server_run(int sock, int report)
+{
+	zbx_mock_handle_t	hresponses, hresponse, hmember;
+
+	hresponses = zbx_mock_get_parameter_handle("in.responses");
+
+	while (1)
+	{
+		int		fd, status = 200;
+		const char	*body = "", *headers = "";
+		char		*response;
+
+		if (-1 == (fd = accept(sock, NULL, NULL)))
+			_exit(EXIT_FAILURE);
+
+		stub_read_request(fd, report);
+
+		/* requests after the listed responses succeed */
+		if (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hresponses, &hresponse))
+		{
+			/* drop connection without response */
+			if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hresponse, "close", &hmember))
+			{
+				close(fd);
+				continue;
+			}
+
+			status = zbx_mock_get_object_member_int(hresponse, "status");
+
+			if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hresponse, "body", &hmember))
+				body = zbx_mock_get_object_member_string(hresponse, "body");
+
+			if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hresponse, "headers", &hmember))
+				headers = zbx_mock_get_object_member_string(hresponse, "headers");
+		}
+
+		response = zbx_dsprintf(NULL, "HTTP/1.1 %d Stub\r\nContent-Type: text/plain\r\n%s%s"
+				"Content-Length: " ZBX_FS_SIZE_T "\r\nConnection: close\r\n\r\n%s", status, headers,
+				'\0' != *headers ? "\r\n" : "", (zbx_fs_size_t)strlen(body), body);
+
+		if ((ssize_t)strlen(response) != send(fd, response, strlen(response), 0))
+			_exit(EXIT_FAILURE);
+
+		zbx_free(response);
+		close(fd);
+	}
+}
+
+static pid_t	stub_server_start(int *report)
+{
+	struct sockaddr_in	addr;
+	socklen_t		addr_len = sizeof(addr);
+	int			sock, fds[2];
+	pid_t			pid;
+
+	if (-1 == (sock = socket(AF_INET, SOCK_STREAM, 0)))
+		fail_msg("cannot create socket: %s", zbx_strerror(errno));
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+	if (0 != bind(sock, (struct sockaddr *)&addr, sizeof(addr)) || 0 != listen(sock, SOMAXCONN) ||
+			0 != getsockname(sock, (struct sockaddr *)&addr, &addr_len))
+	{
+		fail_msg("cannot start stub server: %s", zbx_strerror(errno));
+	}
+
+	/* socket pair is used for reports as read() is mocked in tests */
+	if (0 != socketpair(AF_UNIX, SOCK_STREAM, 0, fds))
+		fail_msg("cannot create socket pair: %s", zbx_strerror(errno));
+
+	if (0 == (pid = fork()))
+	{
+		close(fds[0]);
+		stub_server_run(sock, fds[1]);
+	}
+
+	if (-1 == pid)
+		fail_msg("cannot fork stub server: %s", zbx_strerror(errno));
+
+	close(fds[1]);
+	close(sock);
+
+	zbx_snprintf(stub_port, sizeof(stub_port), "%hu", ntohs(addr.sin_port));
+	*report = fds[0];
+
+	return pid;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: compares strings with the expected list, lists are sorted when   *
+ *          order depends on which of concurrent scenarios finishes first     *
+ *                                                                            *
+ ******************************************************************************/
+static void	compare_strings(const char *path, zbx_vector_str_t *actual, int sort)
+{
+	zbx_mock_handle_t	hexpected, hvalue;
+	zbx_vector_str_t	expected;
+	const char		*value;
+	int			i;
+
+	zbx_vector_str_create(&expected);
+
+	hexpected = zbx_mock_get_parameter_handle(path);
+
+	while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hexpected, &hvalue))
+	{
+		if (ZBX_MOCK_SUCCESS != zbx_mock_string(hvalue, &value))
+			fail_msg("cannot read %s element #%d", path, expected.values_num + 1);
+
+		zbx_vector_str_append(&expected, (char *)value);
+	}
+
+	if (0 != sort)
+	{
+		zbx_vector_str_sort(&expected, ZBX_DEFAULT_STR_COMPARE_FUNC);
+		zbx_vector_str_sort(actual, ZBX_DEFAULT_STR_COMPARE_FUNC);
+	}
+
+	for (i = 0; i < expected.values_num && i < actual->values_num; i++)
+		zbx_mock_assert_str_eq(path, expected.values[i], actual->values[i]);
+
+	if (i < expected.values_num)
+		fail_msg("expected %s element \"%s\" was not found", path, expected.values[i]);
+
+	if (i < actual->values_num)
+		fail_msg("unexpected %s element \"%s\"", path, actual->values[i]);
+
+	zbx_vector_str_destroy(&expected);
+}
+
+static void	read_requests(int report, zbx_vector_str_t *requests)
+{
+	char	*data = NULL, *line, *ptr, buf[4096];
+	size_t	data_alloc = 0, data_offset = 0;
+	ssize_t	n;
+
+	while (0 < (n = recv(report, buf, sizeof(buf), 0)))
+		zbx_strncpy_alloc(&data, &data_alloc, &data_offset, buf, (size_t)n);
+
+	if (NULL == data)
+		return;
+
+	for (line = strtok_r(data, "\n", &ptr); NULL != line; line = strtok_r(NULL, "\n", &ptr))
+		zbx_vector_str_append(requests, zbx_strdup(NULL, line));
+
+	zbx_free(data);
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+#ifdef HAVE_LIBCURL
+	struct event_base	*base;
+	zbx_httptest_poller_t	*poller;
+	zbx_vector_str_t	requests, started;
+	char			*error = NULL;
+	int			report, started_num;
+	time_t			nextcheck;
+	pid_t			pid;
+
+	ZBX_UNUSED(state);
+
+	zbx_mockdb_init();
+
+	zbx_vector_str_create(&values);
+	zbx_vector_str_create(&queued);
+	zbx_vector_str_create(&requests);
+	zbx_vector_str_create(&started);
+
+	httptests = zbx_mock_get_parameter_handle("in.httptests");
+
+	pid = stub_server_start(&report);
+
+	if (NULL == (base = event_base_new()))
+		fail_msg("cannot initialize event base");
+
+	if (NULL == (poller = zbx_httptest_poller_create(base, NULL, NULL,
+			zbx_mock_get_parameter_int("in.max_concurrent"), NULL, NULL, NULL, NULL, &error)))
+	{
+		fail_msg("cannot create web scenario poller: %s", error);
+	}
+
+	/* start scenarios whenever there is a free slot, the same as HTTP poller does */
+	while (1)
+	{
+		if (0 != (started_num = process_httptests(poller, (int)time(NULL), &nextcheck)))
+			zbx_vector_str_append(&started, zbx_dsprintf(NULL, "%d", started_num));
+
+		if (0 == zbx_httptest_poller_processing(poller))
+			break;
+
+		event_base_loop(base, EVLOOP_ONCE);
+	}
+
+	zbx_httptest_poller_destroy(poller);
+	event_base_free(base);
+
+	kill(pid, SIGKILL);
+	waitpid(pid, NULL, 0);
+
+	read_requests(report, &requests);
+	close(report);
+
+	compare_strings("out.started", &started, 0);
+	compare_strings("out.requests", &requests, 1);
+	compare_strings("out.values", &values, 1);
+	compare_strings("out.queued", &queued, 1);
+
+	zbx_vector_str_clear_ext(&started, zbx_str_free);
+	zbx_vector_str_destroy(&started);
+	zbx_vector_str_clear_ext(&requests, zbx_str_free);
+	zbx_vector_str_destroy(&requests);
+	zbx_vector_str_clear_ext(&queued, zbx_str_free);
+	zbx_vector_str_destroy(&queued);
+	zbx_vector_str_clear_ext(&values, zbx_str_free);
+	zbx_vector_str_destroy(&values);
+
+	zbx_mockdb_destroy();
+#else
+	ZBX_UNUSED(state);
+
+	skip();
+#endif
+}
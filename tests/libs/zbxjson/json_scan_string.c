@@ -0,0 +1,94 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "../../../src/libs/zbxjson/json.c"
+
+#include <sys/mman.h>
+
+/* String scanning checks 16 bytes at a time, so every string is scanned at all 16 alignments. Strings */
+/* are also placed right before an inaccessible page to make sure the scanning does not read past the  */
+/* page with terminating zero.                                                                          */
+
+#define JSON_SCAN_ALIGNMENTS	16
+#define JSON_SCAN_OFFSET	64
+
+static const char	*json_scan(const char *p, const char *function)
+{
+	if (0 == strcmp(function, "json_scan_string"))
+		return json_scan_string(p);
+
+	if (0 == strcmp(function, "json_skip_string"))
+		return json_skip_string(p);
+
+	fail_msg("unsupported function \"%s\"", function);
+
+	return NULL;
+}
+
+static void	json_check_scan(const char *function, char *p, const char *data, size_t size, int expected, int shift,
+		const char *placement)
+{
+	char	name[64];
+
+	memcpy(p, data, size);
+	zbx_snprintf(name, sizeof(name), "%s shifted by %d", placement, shift);
+	zbx_mock_assert_int_eq(name, expected, (int)(json_scan(p, function) - p));
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	const char	*function, *data;
+	size_t		size, page_size;
+	int		expected;
+	char		*pages;
+
+	ZBX_UNUSED(state);
+
+	function = zbx_mock_get_parameter_string("in.function");
+	data = zbx_mock_get_parameter_string("in.data");
+	expected = zbx_mock_get_parameter_int("out.offset");
+	size = strlen(data) + 1;
+
+	page_size = (size_t)sysconf(_SC_PAGESIZE);
+
+	if (size + JSON_SCAN_OFFSET + JSON_SCAN_ALIGNMENTS > page_size)
+		fail_msg("too long test data");
+
+	if (MAP_FAILED == (pages = (char *)mmap(NULL, page_size * 2, PROT_READ | PROT_WRITE,
+			MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)))
+	{
+		fail_msg("cannot map memory: %s", zbx_strerror(errno));
+	}
+
+	if (0 != mprotect(pages + page_size, page_size, PROT_NONE))
+		fail_msg("cannot protect memory: %s", zbx_strerror(errno));
+
+	for (int shift = 0; shift < JSON_SCAN_ALIGNMENTS; shift++)
+	{
+		memset(pages, 'x', page_size);
+		json_check_scan(function, pages + JSON_SCAN_OFFSET + shift, data, size, expected, shift,
+				"string");
+
+		memset(pages, 'x', page_size);
+		json_check_scan(function, pages + page_size - size - shift, data, size, expected, shift,
+				"string at page end");
+	}
+
+	munmap(pages, page_size * 2);
+}
@@ -0,0 +1,101 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxcommon.h"
+#include "zbxjson.h"
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: looks up object member with index and checks it against linear   *
+ *          lookup and expected value                                         *
+ *                                                                            *
+ * Comments: Member is expected to have either value or number of array       *
+ *           elements (count). Member without both must not be found.         *
+ *                                                                            *
+ ******************************************************************************/
+static void	json_index_check_lookup(zbx_json_index_t *index, const struct zbx_json_parse *jp,
+		zbx_mock_handle_t hlookup)
+{
+	const char		*name, *p_linear, *p_index;
+	char			*value = NULL;
+	size_t			value_alloc = 0;
+	zbx_mock_handle_t	hexpected;
+	struct zbx_json_parse	jp_data;
+
+	name = zbx_mock_get_object_member_string(hlookup, "name");
+
+	/* indexed lookup must find the same member as scanning, including the first of duplicate names */
+	p_linear = zbx_json_pair_by_name(jp, name);
+	p_index = zbx_json_index_pair_by_name(index, name);
+	zbx_mock_assert_ptr_eq(name, p_linear, p_index);
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hlookup, "value", &hexpected))
+	{
+		if (SUCCEED != zbx_json_index_value_by_name_dyn(index, name, &value, &value_alloc, NULL))
+			fail_msg("cannot find \"%s\" with indexed lookup", name);
+
+		zbx_mock_assert_str_eq(name, zbx_mock_get_object_member_string(hlookup, "value"), value);
+		zbx_free(value);
+	}
+	else if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hlookup, "count", &hexpected))
+	{
+		if (SUCCEED != zbx_json_index_brackets_by_name(index, name, &jp_data))
+			fail_msg("cannot open \"%s\" with indexed lookup", name);
+
+		zbx_mock_assert_int_eq(name, zbx_mock_get_object_member_int(hlookup, "count"),
+				zbx_json_count(&jp_data));
+	}
+	else
+	{
+		if (SUCCEED == zbx_json_index_value_by_name_dyn(index, name, &value, &value_alloc, NULL))
+			fail_msg("found nonexistent member \"%s\" with indexed lookup", name);
+
+		if (SUCCEED == zbx_json_index_brackets_by_name(index, name, &jp_data))
+			fail_msg("opened nonexistent member \"%s\" with indexed lookup", name);
+	}
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	struct zbx_json_parse	jp;
+	zbx_json_index_t	index;
+	zbx_mock_handle_t	hlookups, hlookup;
+	zbx_mock_error_t	err;
+
+	ZBX_UNUSED(state);
+
+	if (SUCCEED != zbx_json_open(zbx_mock_get_parameter_string("in.json"), &jp))
+		fail_msg("cannot open JSON: %s", zbx_json_strerror());
+
+	zbx_json_index_init(&index, &jp);
+
+	hlookups = zbx_mock_get_parameter_handle("in.lookups");
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = zbx_mock_vector_element(hlookups, &hlookup)))
+	{
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("cannot read lookup: %s", zbx_mock_error_string(err));
+
+		json_index_check_lookup(&index, &jp, hlookup);
+	}
+
+	zbx_mock_assert_int_eq("object indexed", zbx_mock_get_parameter_int("out.indexed"), index.indexed);
+
+	zbx_json_index_destroy(&index);
+}
@@ -0,0 +1,199 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxcommon.h"
+#include "zbxpreproc.h"
+#include "libs/zbxpreproc/pp_queue.h"
+#include "libs/zbxpreproc/pp_task.h"
+
+#define MOCK_WORKERS_MAX	8
+
+zbx_dc_um_shared_handle_t	*__wrap_zbx_dc_um_shared_handle_copy(zbx_dc_um_shared_handle_t *handle);
+void				__wrap_zbx_dc_um_shared_handle_release(zbx_dc_um_shared_handle_t *handle);
+
+zbx_dc_um_shared_handle_t	*__wrap_zbx_dc_um_shared_handle_copy(zbx_dc_um_shared_handle_t *handle)
+{
+	return handle;
+}
+
+void	__wrap_zbx_dc_um_shared_handle_release(zbx_dc_um_shared_handle_t *handle)
+{
+	ZBX_UNUSED(handle);
+}
+
+static void	mock_push_tasks(zbx_pp_queue_t *queue, zbx_pp_item_preproc_t *preproc)
+{
+	zbx_mock_handle_t	htasks, htask;
+	zbx_mock_error_t	err;
+	zbx_timespec_t		ts = {0, 0};
+
+	htasks = zbx_mock_get_parameter_handle("in.tasks");
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = zbx_mock_vector_element(htasks, &htask)))
+	{
+		zbx_uint64_t	itemid;
+		const char	*type;
+		zbx_pp_task_t	*task;
+
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("cannot read task: %s", zbx_mock_error_string(err));
+
+		itemid = zbx_mock_get_object_member_uint64(htask, "itemid");
+		type = zbx_mock_get_object_member_string(htask, "type");
+
+		if (0 == strcmp(type, "value"))
+			task = pp_task_value_create(itemid, preproc, NULL, NULL, ts, NULL, NULL);
+		else if (0 == strcmp(type, "value_seq"))
+			task = pp_task_value_seq_create(itemid, preproc, NULL, NULL, ts, NULL, NULL);
+		else
+			fail_msg("unsupported task type \"%s\"", type);
+
+		pp_task_queue_push(queue, task);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks identifiers of items in worker local queue, from the       *
+ *          oldest to the newest task                                         *
+ *                                                                            *
+ ******************************************************************************/
+static void	mock_check_local_queue(const zbx_pp_local_queue_t *local, zbx_mock_handle_t hitemids, int step)
+{
+	zbx_mock_handle_t	hitemid;
+	zbx_mock_error_t	err;
+	int			i = 0;
+	char			name[64];
+
+	zbx_snprintf(name, sizeof(name), "step %d local queue task", step + 1);
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = zbx_mock_vector_element(hitemids, &hitemid)))
+	{
+		zbx_uint64_t	itemid;
+
+		if (ZBX_MOCK_SUCCESS != err || ZBX_MOCK_SUCCESS != (err = zbx_mock_uint64(hitemid, &itemid)))
+			fail_msg("cannot read local queue itemid: %s", zbx_mock_error_string(err));
+
+		if (i == local->tasks_num)
+			fail_msg("step %d local queue has only %d tasks", step + 1, local->tasks_num);
+
+		zbx_mock_assert_uint64_eq(name, itemid, local->tasks[(local->first + i) % PP_LOCAL_QUEUE_SIZE]->itemid);
+		i++;
+	}
+
+	zbx_snprintf(name, sizeof(name), "step %d local queue tasks", step + 1);
+	zbx_mock_assert_int_eq(name, i, local->tasks_num);
+}
+
+static void	mock_process_step(zbx_pp_queue_t *queue, zbx_pp_local_queue_t *locals, zbx_mock_handle_t hstep,
+		int step)
+{
+	zbx_pp_local_queue_t	*local;
+	const char		*action;
+	zbx_mock_handle_t	hitemids;
+	char			name[64];
+	int			worker;
+
+	worker = zbx_mock_get_object_member_int(hstep, "worker");
+	action = zbx_mock_get_object_member_string(hstep, "action");
+	local = &locals[worker];
+
+	zbx_snprintf(name, sizeof(name), "step %d %s", step + 1, action);
+
+	if (0 == strcmp(action, "pop batch"))
+	{
+		zbx_mock_assert_int_eq(name, zbx_mock_get_object_member_int(hstep, "tasks"),
+				pp_task_queue_pop_batch(queue, local));
+	}
+	else if (0 == strcmp(action, "steal"))
+	{
+		zbx_mock_assert_int_eq(name, zbx_mock_get_object_member_int(hstep, "tasks"),
+				pp_task_queue_steal(queue, local));
+	}
+	else if (0 == strcmp(action, "finish"))
+	{
+		zbx_pp_task_t	*task;
+
+		if (NULL == (task = pp_local_queue_pop(local)))
+			fail_msg("step %d local queue of worker %d is empty", step + 1, worker);
+
+		zbx_mock_assert_uint64_eq(name, zbx_mock_get_object_member_uint64(hstep, "itemid"), task->itemid);
+		pp_task_queue_push_finished(queue, task);
+	}
+	else
+		fail_msg("unsupported action \"%s\"", action);
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hstep, "local", &hitemids))
+		mock_check_local_queue(local, hitemids, step);
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_pp_queue_t		queue = {0};
+	zbx_pp_local_queue_t	locals[MOCK_WORKERS_MAX];
+	zbx_pp_item_preproc_t	*preproc;
+	zbx_mock_handle_t	hsteps, hstep;
+	zbx_mock_error_t	err;
+	int			workers_num, step = 0;
+	char			*error = NULL;
+
+	ZBX_UNUSED(state);
+
+	if (SUCCEED != pp_task_queue_init(&queue, &error))
+		fail_msg("cannot initialize task queue: %s", error);
+
+	if (MOCK_WORKERS_MAX < (workers_num = zbx_mock_get_parameter_int("in.workers")))
+		fail_msg("too many workers");
+
+	for (int i = 0; i < workers_num; i++)
+	{
+		if (SUCCEED != pp_local_queue_init(&locals[i], &error))
+			fail_msg("cannot initialize local task queue: %s", error);
+
+		pp_task_queue_register_worker(&queue, &locals[i]);
+	}
+
+	preproc = zbx_pp_item_preproc_create(0, ITEM_TYPE_ZABBIX, ITEM_VALUE_TYPE_UINT64, 0);
+	mock_push_tasks(&queue, preproc);
+
+	hsteps = zbx_mock_get_parameter_handle("in.steps");
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = zbx_mock_vector_element(hsteps, &hstep)))
+	{
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("cannot read step: %s", zbx_mock_error_string(err));
+
+		mock_process_step(&queue, locals, hstep, step++);
+	}
+
+	zbx_mock_assert_uint64_eq("pending tasks", zbx_mock_get_parameter_uint64("out.pending"), queue.pending_num);
+	zbx_mock_assert_uint64_eq("processing tasks", zbx_mock_get_parameter_uint64("out.processing"),
+			queue.processing_num);
+	zbx_mock_assert_uint64_eq("finished tasks", zbx_mock_get_parameter_uint64("out.finished"), queue.finished_num);
+	zbx_mock_assert_uint64_eq("stolen tasks", zbx_mock_get_parameter_uint64("out.stolen"), queue.stolen_num);
+
+	for (int i = 0; i < workers_num; i++)
+	{
+		pp_task_queue_deregister_worker(&queue, &locals[i]);
+		pp_local_queue_destroy(&locals[i]);
+	}
+
+	pp_task_queue_destroy(&queue);
+	zbx_pp_item_preproc_release(preproc);
+}
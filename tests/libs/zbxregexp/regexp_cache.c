@@ -0,0 +1,120 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "../../../src/libs/zbxregexp/zbxregexp.c"
+
+static int	mock_regexp_is_jit_compiled(const zbx_regexp_t *regexp)
+{
+	size_t	size = 0;
+
+	if (0 != pcre2_pattern_info(regexp->pcre2_regexp, PCRE2_INFO_JITSIZE, &size))
+		fail_msg("cannot get JIT compiled code size");
+
+	return 0 != size;
+}
+
+static void	mock_process_step(zbx_mock_handle_t hstep, int step)
+{
+	const char		*pattern, *string, *result, *caseless;
+	char			name[64];
+	zbx_mock_handle_t	hcaseless;
+	uint32_t		flags = PCRE2_MULTILINE;
+	int			len;
+
+	pattern = zbx_mock_get_object_member_string(hstep, "pattern");
+	string = zbx_mock_get_object_member_string(hstep, "string");
+	result = zbx_mock_get_object_member_string(hstep, "result");
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hstep, "caseless", &hcaseless) &&
+			ZBX_MOCK_SUCCESS == zbx_mock_string(hcaseless, &caseless) && 0 == strcmp(caseless, "yes"))
+	{
+		flags |= PCRE2_CASELESS;
+	}
+
+	(void)zbx_regexp(string, pattern, flags, &len);
+
+	zbx_snprintf(name, sizeof(name), "step %d result", step + 1);
+
+	if (0 == strcmp(result, "match"))
+		zbx_mock_assert_int_ne(name, 0, len);
+	else if (0 == strcmp(result, "no match"))
+		zbx_mock_assert_int_eq(name, 0, len);
+	else
+		zbx_mock_assert_int_eq(name, FAIL, len);
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_mock_handle_t	hsteps, hstep, hpatterns, hpattern;
+	zbx_mock_error_t	err;
+	zbx_uint64_t		hits, misses;
+	int			step = 0, i = 0;
+	uint32_t		jit = 0;
+	zbx_regexp_t		*regexp;
+	char			*error = NULL;
+
+	ZBX_UNUSED(state);
+
+	hsteps = zbx_mock_get_parameter_handle("in.steps");
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = zbx_mock_vector_element(hsteps, &hstep)))
+	{
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("cannot read step: %s", zbx_mock_error_string(err));
+
+		mock_process_step(hstep, step++);
+	}
+
+	zbx_regexp_cache_get_stats(&hits, &misses);
+	zbx_mock_assert_uint64_eq("cache hits", zbx_mock_get_parameter_uint64("out.hits"), hits);
+	zbx_mock_assert_uint64_eq("cache misses", zbx_mock_get_parameter_uint64("out.misses"), misses);
+
+	/* cached patterns are listed from the most to the least recently used */
+	hpatterns = zbx_mock_get_parameter_handle("out.cache");
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = zbx_mock_vector_element(hpatterns, &hpattern)))
+	{
+		const char	*pattern;
+
+		if (ZBX_MOCK_SUCCESS != err || ZBX_MOCK_SUCCESS != (err = zbx_mock_string(hpattern, &pattern)))
+			fail_msg("cannot read cached pattern: %s", zbx_mock_error_string(err));
+
+		if (i == regexp_cache_num)
+			fail_msg("pattern \"%s\" is not cached", pattern);
+
+		zbx_mock_assert_str_eq("cached pattern", pattern, regexp_cache[i++].pattern);
+	}
+
+	zbx_mock_assert_int_eq("cached patterns", i, regexp_cache_num);
+
+	/* only cached regexps are JIT compiled */
+	(void)pcre2_config(PCRE2_CONFIG_JIT, &jit);
+
+	for (i = 0; i < regexp_cache_num; i++)
+	{
+		zbx_mock_assert_int_eq("cached regexp JIT compiled", 0 != jit,
+				mock_regexp_is_jit_compiled(regexp_cache[i].regexp));
+	}
+
+	if (SUCCEED != zbx_regexp_compile("^[a-z]+$", &regexp, &error))
+		fail_msg("cannot compile regexp: %s", error);
+
+	zbx_mock_assert_int_eq("compiled regexp JIT compiled", 0, mock_regexp_is_jit_compiled(regexp));
+	zbx_regexp_free(regexp);
+}
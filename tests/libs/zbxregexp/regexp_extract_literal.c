@@ -0,0 +1,43 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxregexp.h"
+
+void	zbx_mock_test_entry(void **state)
+{
+	const char	*pattern;
+	char		*literal;
+
+	ZBX_UNUSED(state);
+
+	pattern = zbx_mock_get_parameter_string("in.pattern");
+	literal = zbx_regexp_extract_literal(pattern);
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_parameter_exists("out.literal"))
+	{
+		if (NULL == literal)
+			fail_msg("no literal was extracted from \"%s\"", pattern);
+
+		zbx_mock_assert_str_eq("literal", zbx_mock_get_parameter_string("out.literal"), literal);
+	}
+	else if (NULL != literal)
+		fail_msg("unexpected literal \"%s\" extracted from \"%s\"", literal, pattern);
+
+	zbx_free(literal);
+}
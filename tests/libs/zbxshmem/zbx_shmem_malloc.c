@@ -0,0 +1,256 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxshmem.h"
+
+#define MOCK_ALLOCS_MAX	64
+
+typedef struct
+{
+	const char	*name;
+	void		*ptr;
+	void		*last_ptr;	/* address of the freed allocation */
+	size_t		size;
+	unsigned char	fill;
+}
+zbx_mock_alloc_t;
+
+static zbx_mock_alloc_t	allocs[MOCK_ALLOCS_MAX];
+static int		allocs_num;
+
+static zbx_mock_alloc_t	*mock_get_alloc(const char *name)
+{
+	int	i;
+
+	for (i = 0; i < allocs_num; i++)
+	{
+		if (0 == strcmp(allocs[i].name, name))
+			return &allocs[i];
+	}
+
+	if (MOCK_ALLOCS_MAX == allocs_num)
+		fail_msg("too many allocations");
+
+	memset(&allocs[allocs_num], 0, sizeof(zbx_mock_alloc_t));
+	allocs[allocs_num].name = name;
+	allocs[allocs_num].fill = (unsigned char)(allocs_num + 1);
+
+	return &allocs[allocs_num++];
+}
+
+static unsigned char	mock_get_alloc_mode(const char *path)
+{
+	const char	*mode;
+
+	mode = zbx_mock_get_parameter_string(path);
+
+	if (0 == strcmp(mode, "FIRSTFIT"))
+		return ZBX_SHMEM_ALLOC_FIRSTFIT;
+
+	if (0 == strcmp(mode, "BESTFIT"))
+		return ZBX_SHMEM_ALLOC_BESTFIT;
+
+	fail_msg("unknown allocation mode '%s'", mode);
+
+	return ZBX_SHMEM_ALLOC_FIRSTFIT;
+}
+
+/* allocated memory must not be overwritten by other allocations or by the allocator */
+static void	mock_check_allocs(const char *step)
+{
+	int	i;
+	size_t	j;
+
+	for (i = 0; i < allocs_num; i++)
+	{
+		if (NULL == allocs[i].ptr)
+			continue;
+
+		for (j = 0; j < allocs[i].size; j++)
+		{
+			if (allocs[i].fill != ((unsigned char *)allocs[i].ptr)[j])
+				fail_msg("%s: allocation '%s' is corrupted at offset " ZBX_FS_SIZE_T, step,
+						allocs[i].name, (zbx_fs_size_t)j);
+		}
+	}
+}
+
+static void	mock_check_stats(const char *step, zbx_shmem_info_t *info)
+{
+	zbx_shmem_stats_t	stats;
+	int			i, used_num = 0;
+
+	zbx_shmem_get_stats(info, &stats);
+
+	for (i = 0; i < allocs_num; i++)
+	{
+		if (NULL != allocs[i].ptr)
+			used_num++;
+	}
+
+	zbx_mock_assert_int_eq(step, used_num, (int)stats.used_chunks);
+	zbx_mock_assert_int_eq(step, info->alloc_mode, stats.alloc_mode);
+	zbx_mock_assert_uint64_eq(step, info->total_size, stats.free_size + stats.used_size + stats.overhead);
+}
+
+static void	mock_alloc(zbx_shmem_info_t *info, zbx_mock_handle_t hstep, const char *step, int realloc)
+{
+	zbx_mock_alloc_t	*alloc;
+	zbx_mock_handle_t	hvalue;
+	const char		*value;
+	void			*ptr;
+	size_t			size;
+	int			expected = SUCCEED;
+
+	alloc = mock_get_alloc(zbx_mock_get_object_member_string(hstep, "name"));
+	size = (size_t)zbx_mock_get_object_member_uint64(hstep, "size");
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hstep, "result", &hvalue))
+	{
+		if (ZBX_MOCK_SUCCESS != zbx_mock_string(hvalue, &value))
+			fail_msg("%s: cannot read result", step);
+
+		expected = zbx_mock_str_to_return_code(value);
+	}
+
+	if (0 != realloc)
+	{
+		if (NULL == alloc->ptr)
+			fail_msg("%s: allocation '%s' does not exist", step, alloc->name);
+
+		ptr = zbx_shmem_realloc(info, alloc->ptr, size);
+	}
+	else
+	{
+		if (NULL != alloc->ptr)
+			fail_msg("%s: allocation '%s' already exists", step, alloc->name);
+
+		ptr = zbx_shmem_malloc(info, NULL, size);
+	}
+
+	if (FAIL == expected)
+	{
+		zbx_mock_assert_ptr_eq(step, NULL, ptr);
+		return;
+	}
+
+	zbx_mock_assert_ptr_ne(step, NULL, ptr);
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hstep, "at", &hvalue))
+	{
+		zbx_mock_alloc_t	*at;
+
+		if (ZBX_MOCK_SUCCESS != zbx_mock_string(hvalue, &value))
+			fail_msg("%s: cannot read expected allocation address", step);
+
+		at = mock_get_alloc(value);
+		zbx_mock_assert_ptr_eq(step, NULL != at->ptr ? at->ptr : at->last_ptr, ptr);
+	}
+
+	/* reallocated memory must keep the old contents */
+	if (0 != realloc)
+		alloc->size = MIN(alloc->size, size);
+	else
+		alloc->size = 0;
+
+	alloc->ptr = ptr;
+	mock_check_allocs(step);
+
+	alloc->size = size;
+	memset(alloc->ptr, alloc->fill, alloc->size);
+}
+
+static void	mock_free(zbx_shmem_info_t *info, zbx_mock_handle_t hstep, const char *step)
+{
+	zbx_mock_alloc_t	*alloc;
+
+	alloc = mock_get_alloc(zbx_mock_get_object_member_string(hstep, "name"));
+
+	if (NULL == alloc->ptr)
+		fail_msg("%s: allocation '%s' does not exist", step, alloc->name);
+
+	alloc->last_ptr = alloc->ptr;
+	zbx_shmem_free(info, alloc->ptr);
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_shmem_info_t	*info = NULL;
+	zbx_shmem_stats_t	stats;
+	zbx_mock_handle_t	hsteps, hstep;
+	zbx_mock_error_t	err;
+	char			*error = NULL, step[MAX_STRING_LEN];
+	const char		*op;
+	int			i, step_num = 0;
+
+	ZBX_UNUSED(state);
+
+	if (SUCCEED != zbx_shmem_create(&info, zbx_mock_get_parameter_uint64("in.size"), "test memory",
+			"TestMemory", 1, mock_get_alloc_mode("in.mode"), &error))
+	{
+		fail_msg("cannot create shared memory: %s", error);
+	}
+
+	allocs_num = 0;
+
+	hsteps = zbx_mock_get_parameter_handle("in.steps");
+	while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hsteps, &hstep))))
+	{
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("cannot read step #%d", step_num);
+
+		op = zbx_mock_get_object_member_string(hstep, "op");
+		zbx_snprintf(step, sizeof(step), "step #%d (%s %s)", step_num, op,
+				zbx_mock_get_object_member_string(hstep, "name"));
+
+		if (0 == strcmp(op, "alloc"))
+			mock_alloc(info, hstep, step, 0);
+		else if (0 == strcmp(op, "realloc"))
+			mock_alloc(info, hstep, step, 1);
+		else if (0 == strcmp(op, "free"))
+			mock_free(info, hstep, step);
+		else
+			fail_msg("%s: unknown operation", step);
+
+		mock_check_allocs(step);
+		mock_check_stats(step, info);
+		step_num++;
+	}
+
+	zbx_shmem_get_stats(info, &stats);
+	zbx_mock_assert_int_eq("free chunks", zbx_mock_get_parameter_int("out.free_chunks"), (int)stats.free_chunks);
+
+	/* freeing all allocations must merge free memory back into single chunk */
+	for (i = 0; i < allocs_num; i++)
+	{
+		if (NULL != allocs[i].ptr)
+		{
+			zbx_shmem_free(info, allocs[i].ptr);
+			mock_check_allocs("cleanup");
+		}
+	}
+
+	zbx_shmem_get_stats(info, &stats);
+	zbx_mock_assert_int_eq("free chunks after cleanup", 1, (int)stats.free_chunks);
+	zbx_mock_assert_int_eq("used chunks after cleanup", 0, (int)stats.used_chunks);
+	zbx_mock_assert_uint64_eq("free size after cleanup", info->total_size, stats.free_size);
+	zbx_mock_assert_uint64_eq("max chunk size after cleanup", info->total_size, stats.max_chunk_size);
+
+	zbx_shmem_destroy(info);
+}
@@ -0,0 +1,322 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "../../../src/libs/zbxsnmptrapper/snmptrapper.c"
+
+/* Interfaces, their items and global regular expressions come from test case, values passed to */
+/* preprocessing and requeued items are recorded and compared with expected results.            */
+
+typedef struct
+{
+	zbx_uint64_t	itemid;
+	unsigned char	state;
+	char		*value;
+}
+zbx_mock_value_t;
+
+ZBX_PTR_VECTOR_DECL(mock_value_ptr, zbx_mock_value_t *)
+ZBX_PTR_VECTOR_IMPL(mock_value_ptr, zbx_mock_value_t *)
+
+static zbx_vector_mock_value_ptr_t	values;
+static zbx_vector_uint64_pair_t		requeued;
+static int				items_loads, flushes;
+
+int	__wrap_zbx_dc_config_get_snmp_interfaceids_by_addr(const char *addr, zbx_uint64_t **interfaceids);
+size_t	__wrap_zbx_dc_config_get_snmp_items_by_interfaceid(zbx_uint64_t interfaceid, zbx_dc_item_t **items);
+void	__wrap_zbx_dc_config_clean_items(zbx_dc_item_t *items, int *errcodes, size_t num);
+void	__wrap_zbx_dc_requeue_items(const zbx_uint64_t *itemids, const int *lastclocks, const int *errcodes,
+		size_t num);
+void	__wrap_zbx_dc_get_expressions_by_name(zbx_vector_expression_t *expressions, const char *name);
+zbx_dc_um_handle_t	*__wrap_zbx_dc_open_user_macros_masked(void);
+void	__wrap_zbx_dc_close_user_macros(zbx_dc_um_handle_t *um_handle);
+int	__wrap_zbx_substitute_item_key_params(char **data, char *error, size_t maxerrlen, zbx_subst_func_t cb, ...);
+void	__wrap_zbx_config_get(zbx_config_t *cfg, zbx_uint64_t flags);
+void	__wrap_zbx_config_clean(zbx_config_t *cfg);
+void	__wrap_zbx_preprocess_item_value(zbx_uint64_t itemid, zbx_uint64_t hostid, unsigned char item_value_type,
+		unsigned char item_flags, AGENT_RESULT *result, zbx_timespec_t *ts, unsigned char state, char *error);
+void	__wrap_zbx_preprocessor_flush(void);
+
+int	__wrap_zbx_dc_config_get_snmp_interfaceids_by_addr(const char *addr, zbx_uint64_t **interfaceids)
+{
+	zbx_mock_handle_t	haddrs, haddr, hids, hid;
+	int			count = 0;
+
+	haddrs = zbx_mock_get_parameter_handle("in.addresses");
+
+	while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(haddrs, &haddr))
+	{
+		if (0 != strcmp(addr, zbx_mock_get_object_member_string(haddr, "addr")))
+			continue;
+
+		hids = zbx_mock_get_object_member_handle(haddr, "interfaceids");
+
+		while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hids, &hid))
+		{
+			*interfaceids = (zbx_uint64_t *)zbx_realloc(*interfaceids, sizeof(zbx_uint64_t) *
+					(size_t)(count + 1));
+
+			if (ZBX_MOCK_SUCCESS != zbx_mock_uint64(hid, &(*interfaceids)[count++]))
+				fail_msg("invalid interface identifier");
+		}
+	}
+
+	return count;
+}
+
+size_t	__wrap_zbx_dc_config_get_snmp_items_by_interfaceid(zbx_uint64_t interfaceid, zbx_dc_item_t **items)
+{
+	zbx_mock_handle_t	hitems, hitem;
+	size_t			items_num = 0;
+
+	items_loads++;
+
+	hitems = zbx_mock_get_parameter_handle("in.items");
+
+	while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hitems, &hitem))
+	{
+		zbx_dc_item_t	*item;
+		const char	*value_type;
+
+		if (interfaceid != zbx_mock_get_object_member_uint64(hitem, "interfaceid"))
+			continue;
+
+		*items = (zbx_dc_item_t *)zbx_realloc(*items, sizeof(zbx_dc_item_t) * (items_num + 1));
+		item = &(*items)[items_num++];
+		memset(item, 0, sizeof(zbx_dc_item_t));
+
+		item->itemid = zbx_mock_get_object_member_uint64(hitem, "itemid");
+		item->host.hostid = 1;
+		zbx_strlcpy(item->key_orig, zbx_mock_get_object_member_string(hitem, "key"), sizeof(item->key_orig));
+
+		value_type = zbx_mock_get_object_member_string(hitem, "value_type");
+		item->value_type = zbx_mock_str_to_value_type(value_type);
+	}
+
+	return items_num;
+}
+
+void	__wrap_zbx_dc_config_clean_items(zbx_dc_item_t *items, int *errcodes, size_t num)
+{
+	ZBX_UNUSED(items);
+	ZBX_UNUSED(errcodes);
+	ZBX_UNUSED(num);
+}
+
+void	__wrap_zbx_dc_requeue_items(const zbx_uint64_t *itemids, const int *lastclocks, const int *errcodes,
+		size_t num)
+{
+	ZBX_UNUSED(lastclocks);
+
+	for (size_t i = 0; i < num; i++)
+	{
+		zbx_uint64_pair_t	pair = {itemids[i], (zbx_uint64_t)errcodes[i]};
+
+		zbx_vector_uint64_pair_append(&requeued, pair);
+	}
+}
+
+void	__wrap_zbx_dc_get_expressions_by_name(zbx_vector_expression_t *expressions, const char *name)
+{
+	zbx_mock_handle_t	hregexps, hregexp;
+
+	if (ZBX_MOCK_SUCCESS != zbx_mock_parameter_exists("in.regexps"))
+		return;
+
+	hregexps = zbx_mock_get_parameter_handle("in.regexps");
+
+	while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hregexps, &hregexp))
+	{
+		if (0 != strcmp(name, zbx_mock_get_object_member_string(hregexp, "name")))
+			continue;
+
+		zbx_add_regexp_ex(expressions, name, zbx_mock_get_object_member_string(hregexp, "expression"),
+				zbx_mock_get_object_member_int(hregexp, "type"), ',', ZBX_CASE_SENSITIVE);
+	}
+}
+
+zbx_dc_um_handle_t	*__wrap_zbx_dc_open_user_macros_masked(void)
+{
+	return NULL;
+}
+
+void	__wrap_zbx_dc_close_user_macros(zbx_dc_um_handle_t *um_handle)
+{
+	ZBX_UNUSED(um_handle);
+}
+
+int	__wrap_zbx_substitute_item_key_params(char **data, char *error, size_t maxerrlen, zbx_subst_func_t cb, ...)
+{
+	ZBX_UNUSED(cb);
+
+	/* user macros are not resolved, keys containing them are treated as invalid */
+	if (NULL != strstr(*data, "{$"))
+	{
+		zbx_strlcpy(error, "cannot resolve macro", maxerrlen);
+		return FAIL;
+	}
+
+	return SUCCEED;
+}
+
+void	__wrap_zbx_config_get(zbx_config_t *cfg, zbx_uint64_t flags)
+{
+	ZBX_UNUSED(flags);
+
+	cfg->snmptrap_logging = ZBX_SNMPTRAP_LOGGING_ENABLED;
+}
+
+void	__wrap_zbx_config_clean(zbx_config_t *cfg)
+{
+	ZBX_UNUSED(cfg);
+}
+
+void	__wrap_zbx_preprocess_item_value(zbx_uint64_t itemid, zbx_uint64_t hostid, unsigned char item_value_type,
+		unsigned char item_flags, AGENT_RESULT *result, zbx_timespec_t *ts, unsigned char state, char *error)
+{
+	zbx_mock_value_t	*value;
+
+	ZBX_UNUSED(hostid);
+	ZBX_UNUSED(item_flags);
+	ZBX_UNUSED(ts);
+
+	value = (zbx_mock_value_t *)zbx_malloc(NULL, sizeof(zbx_mock_value_t));
+	value->itemid = itemid;
+	value->state = state;
+
+	if (ITEM_STATE_NOTSUPPORTED == state)
+		value->value = zbx_strdup(NULL, error);
+	else if (ITEM_VALUE_TYPE_LOG == item_value_type)
+		value->value = zbx_strdup(NULL, result->log->value);
+	else
+		value->value = zbx_strdup(NULL, result->text);
+
+	zbx_vector_mock_value_ptr_append(&values, value);
+}
+
+void	__wrap_zbx_preprocessor_flush(void)
+{
+	flushes++;
+}
+
+static void	mock_value_free(zbx_mock_value_t *value)
+{
+	zbx_free(value->value);
+	zbx_free(value);
+}
+
+static void	mock_add_traps(void)
+{
+	zbx_mock_handle_t	htraps, htrap;
+
+	htraps = zbx_mock_get_parameter_handle("in.traps");
+
+	while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(htraps, &htrap))
+	{
+		const char	*text = zbx_mock_get_object_member_string(htrap, "trap");
+
+		process_trap(zbx_mock_get_object_member_string(htrap, "addr"), text, text + strlen(text));
+	}
+}
+
+static void	mock_check_values(void)
+{
+	zbx_mock_handle_t	hvalues, hvalue;
+	int			i = 0;
+
+	hvalues = zbx_mock_get_parameter_handle("out.values");
+
+	while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hvalues, &hvalue))
+	{
+		zbx_mock_value_t	*value;
+		const char		*state;
+
+		if (i >= values.values_num)
+			fail_msg("expected more than %d values", values.values_num);
+
+		value = values.values[i++];
+
+		zbx_mock_assert_uint64_eq("itemid", zbx_mock_get_object_member_uint64(hvalue, "itemid"),
+				value->itemid);
+
+		state = zbx_mock_get_object_member_string(hvalue, "state");
+		zbx_mock_assert_int_eq("item state", 0 == strcmp(state, "normal") ? ITEM_STATE_NORMAL :
+				ITEM_STATE_NOTSUPPORTED, value->state);
+		zbx_mock_assert_str_eq("value", zbx_mock_get_object_member_string(hvalue, "value"), value->value);
+	}
+
+	zbx_mock_assert_int_eq("values", i, values.values_num);
+}
+
+static int	mock_compare_requeued(const void *d1, const void *d2)
+{
+	const zbx_uint64_pair_t	*p1 = (const zbx_uint64_pair_t *)d1;
+	const zbx_uint64_pair_t	*p2 = (const zbx_uint64_pair_t *)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(p1->first, p2->first);
+
+	return 0;
+}
+
+static void	mock_check_requeued(void)
+{
+	zbx_mock_handle_t	hitems, hitem;
+	int			i = 0;
+
+	zbx_vector_uint64_pair_sort(&requeued, mock_compare_requeued);
+
+	hitems = zbx_mock_get_parameter_handle("out.requeued");
+
+	while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hitems, &hitem))
+	{
+		if (i >= requeued.values_num)
+			fail_msg("expected more than %d requeued items", requeued.values_num);
+
+		zbx_mock_assert_uint64_eq("requeued itemid", zbx_mock_get_object_member_uint64(hitem, "itemid"),
+				requeued.values[i].first);
+		zbx_mock_assert_int_eq("requeued errcode", zbx_mock_str_to_return_code(
+				zbx_mock_get_object_member_string(hitem, "errcode")), (int)requeued.values[i].second);
+		i++;
+	}
+
+	zbx_mock_assert_int_eq("requeued items", i, requeued.values_num);
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	ZBX_UNUSED(state);
+
+	zbx_vector_mock_value_ptr_create(&values);
+	zbx_vector_uint64_pair_create(&requeued);
+	zbx_vector_snmp_trap_ptr_create(&trap_batch);
+
+	mock_add_traps();
+	process_trap_batch();
+
+	zbx_mock_assert_int_eq("batch size after processing", 0, trap_batch.values_num);
+	zbx_mock_assert_int_eq("interface item loads", zbx_mock_get_parameter_int("out.item_loads"), items_loads);
+	zbx_mock_assert_int_eq("preprocessor flushes", 1, flushes);
+
+	mock_check_values();
+	mock_check_requeued();
+
+	zbx_vector_snmp_trap_ptr_destroy(&trap_batch);
+	zbx_vector_uint64_pair_destroy(&requeued);
+	zbx_vector_mock_value_ptr_clear_ext(&values, mock_value_free);
+	zbx_vector_mock_value_ptr_destroy(&values);
+}
@@ -0,0 +1,123 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "../../../src/libs/zbxsnmptrapper/snmptrapper.c"
+
+void	__wrap_zbx_dc_get_expressions_by_name(zbx_vector_expression_t *expressions, const char *name);
+int	__wrap_zbx_substitute_item_key_params(char **data, char *error, size_t maxerrlen, zbx_subst_func_t cb, ...);
+
+void	__wrap_zbx_dc_get_expressions_by_name(zbx_vector_expression_t *expressions, const char *name)
+{
+	zbx_mock_handle_t	hregexps, hregexp;
+
+	if (ZBX_MOCK_SUCCESS != zbx_mock_parameter_exists("in.regexps"))
+		return;
+
+	hregexps = zbx_mock_get_parameter_handle("in.regexps");
+
+	while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hregexps, &hregexp))
+	{
+		if (0 != strcmp(name, zbx_mock_get_object_member_string(hregexp, "name")))
+			continue;
+
+		zbx_add_regexp_ex(expressions, name, zbx_mock_get_object_member_string(hregexp, "expression"),
+				zbx_mock_get_object_member_int(hregexp, "type"), ',', ZBX_CASE_SENSITIVE);
+	}
+}
+
+int	__wrap_zbx_substitute_item_key_params(char **data, char *error, size_t maxerrlen, zbx_subst_func_t cb, ...)
+{
+	ZBX_UNUSED(data);
+	ZBX_UNUSED(error);
+	ZBX_UNUSED(maxerrlen);
+	ZBX_UNUSED(cb);
+
+	return SUCCEED;
+}
+
+static int	mock_str_to_match(const char *str)
+{
+	if (0 == strcmp(str, "ZBX_REGEXP_MATCH"))
+		return ZBX_REGEXP_MATCH;
+
+	if (0 == strcmp(str, "ZBX_REGEXP_NO_MATCH"))
+		return ZBX_REGEXP_NO_MATCH;
+
+	return zbx_mock_str_to_return_code(str);
+}
+
+static unsigned char	mock_str_to_item_type(const char *str)
+{
+	if (0 == strcmp(str, "regexp"))
+		return ZBX_SNMPTRAP_ITEM_REGEXP;
+
+	if (0 == strcmp(str, "fallback"))
+		return ZBX_SNMPTRAP_ITEM_FALLBACK;
+
+	if (0 == strcmp(str, "error"))
+		return ZBX_SNMPTRAP_ITEM_ERROR;
+
+	if (0 == strcmp(str, "skip"))
+		return ZBX_SNMPTRAP_ITEM_SKIP;
+
+	fail_msg("unknown snmptrap item type \"%s\"", str);
+
+	return ZBX_SNMPTRAP_ITEM_SKIP;
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_dc_item_t		item;
+	zbx_snmp_trap_item_t	trap_item;
+	zbx_vector_expression_t	regexps;
+	const char		*literal;
+
+	ZBX_UNUSED(state);
+
+	zbx_vector_expression_create(&regexps);
+
+	memset(&item, 0, sizeof(item));
+	zbx_strlcpy(item.key_orig, zbx_mock_get_parameter_string("in.key"), sizeof(item.key_orig));
+
+	snmp_trap_item_prepare(&item, &trap_item, &regexps, NULL);
+
+	zbx_mock_assert_int_eq("item type", mock_str_to_item_type(zbx_mock_get_parameter_string("out.type")),
+			trap_item.type);
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_parameter_exists("out.literal"))
+	{
+		literal = zbx_mock_get_parameter_string("out.literal");
+
+		if ('\0' == *literal)
+			zbx_mock_assert_ptr_eq("literal", NULL, trap_item.literal);
+		else
+			zbx_mock_assert_str_eq("literal", literal, trap_item.literal);
+	}
+
+	if (ZBX_SNMPTRAP_ITEM_REGEXP == trap_item.type)
+	{
+		zbx_mock_assert_int_eq("match result", mock_str_to_match(zbx_mock_get_parameter_string("out.result")),
+				snmp_trap_item_match(&trap_item, zbx_mock_get_parameter_string("in.trap"), &regexps));
+	}
+
+	zbx_free(item.key);
+	snmp_trap_item_clean(&trap_item);
+	zbx_regexp_clean_expressions(&regexps);
+	zbx_vector_expression_destroy(&regexps);
+}
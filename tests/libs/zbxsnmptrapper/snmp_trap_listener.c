@@ -0,0 +1,253 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "../../../src/libs/zbxsnmptrapper/snmptrapper.c"
+
+#ifdef HAVE_NETSNMP
+/* Traps are sent by child process to listener opened on loopback interface, parent process reads */
+/* them and compares formatted trap texts with expected patterns.                                  */
+
+#define MOCK_LISTENER_TIMEOUT	10
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: sends single trap or inform to listener                           *
+ *                                                                            *
+ * Return value: SUCCEED - trap was sent, inform was acknowledged             *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	mock_send_trap(int port, zbx_mock_handle_t htrap)
+{
+	static oid	sysuptime_oid[] = {1, 3, 6, 1, 2, 1, 1, 3, 0},
+			snmptrapoid_oid[] = {1, 3, 6, 1, 6, 3, 1, 1, 4, 1, 0},
+			ifindex_oid[] = {1, 3, 6, 1, 2, 1, 2, 2, 1, 1, 1},
+			linkdown_oid[] = {1, 3, 6, 1, 6, 3, 1, 1, 5, 3},
+			enterprise_oid[] = {1, 3, 6, 1, 4, 1, 3375};
+	netsnmp_session	session;
+	netsnmp_pdu	*pdu, *response = NULL;
+	void		*sessp;
+	const char	*version, *type, *community;
+	char		peername[32];
+	long		ifindex = 1;
+	u_long		uptime = 100;
+	int		ret = FAIL;
+
+	version = zbx_mock_get_object_member_string(htrap, "version");
+	type = zbx_mock_get_object_member_string(htrap, "type");
+	community = zbx_mock_get_object_member_string(htrap, "community");
+
+	zbx_snprintf(peername, sizeof(peername), "udp:127.0.0.1:%d", port);
+
+	snmp_sess_init(&session);
+	session.peername = peername;
+	session.version = 0 == strcmp(version, "1") ? SNMP_VERSION_1 : SNMP_VERSION_2c;
+	session.community = (u_char *)community;
+	session.community_len = strlen(community);
+	session.retries = 0;
+	session.timeout = MOCK_LISTENER_TIMEOUT / 2 * 1000000L;
+
+	if (NULL == (sessp = snmp_sess_open(&session)))
+		return FAIL;
+
+	if (SNMP_VERSION_1 == session.version)
+	{
+		pdu = snmp_pdu_create(SNMP_MSG_TRAP);
+		pdu->enterprise = snmp_duplicate_objid(enterprise_oid, OID_LENGTH(enterprise_oid));
+		pdu->enterprise_length = OID_LENGTH(enterprise_oid);
+		pdu->trap_type = SNMP_TRAP_LINKDOWN;
+		pdu->specific_type = 0;
+		pdu->time = uptime;
+	}
+	else
+	{
+		pdu = snmp_pdu_create(0 == strcmp(type, "inform") ? SNMP_MSG_INFORM : SNMP_MSG_TRAP2);
+		snmp_pdu_add_variable(pdu, sysuptime_oid, OID_LENGTH(sysuptime_oid), ASN_TIMETICKS, &uptime,
+				sizeof(uptime));
+		snmp_pdu_add_variable(pdu, snmptrapoid_oid, OID_LENGTH(snmptrapoid_oid), ASN_OBJECT_ID, linkdown_oid,
+				sizeof(linkdown_oid));
+	}
+
+	snmp_pdu_add_variable(pdu, ifindex_oid, OID_LENGTH(ifindex_oid), ASN_INTEGER, &ifindex, sizeof(ifindex));
+
+	if (SNMP_MSG_INFORM == pdu->command)
+	{
+		if (STAT_SUCCESS == snmp_sess_synch_response(sessp, pdu, &response) && NULL != response &&
+				SNMP_MSG_RESPONSE == response->command)
+		{
+			ret = SUCCEED;
+		}
+
+		if (NULL != response)
+			snmp_free_pdu(response);
+	}
+	else if (0 != snmp_sess_send(sessp, pdu))
+	{
+		ret = SUCCEED;
+	}
+	else
+		snmp_free_pdu(pdu);
+
+	snmp_sess_close(sessp);
+
+	return ret;
+}
+
+static void	mock_send_traps(int port)
+{
+	zbx_mock_handle_t	htraps, htrap;
+	int			ret = SUCCEED;
+
+	htraps = zbx_mock_get_parameter_handle("in.traps");
+
+	while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(htraps, &htrap))
+	{
+		if (SUCCEED != mock_send_trap(port, htrap))
+			ret = FAIL;
+	}
+
+	_exit(SUCCEED == ret ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: reads traps from listener socket until expected number of traps   *
+ *          is collected in batch and sender has finished                     *
+ *                                                                            *
+ ******************************************************************************/
+static void	mock_receive_traps(pid_t pid, int traps_num, int *status)
+{
+	netsnmp_transport	*transport;
+	fd_set			fdset;
+	struct timeval		tv;
+	time_t			deadline = time(NULL) + MOCK_LISTENER_TIMEOUT;
+	int			exited = 0;
+
+	if (NULL == (transport = snmp_sess_transport(trap_sessp)))
+		fail_msg("listener session has no transport");
+
+	while (0 == exited || trap_batch.values_num < traps_num)
+	{
+		if (time(NULL) > deadline)
+			break;
+
+		if (0 == exited && pid == waitpid(pid, status, WNOHANG))
+			exited = 1;
+
+		FD_ZERO(&fdset);
+		FD_SET(transport->sock, &fdset);
+
+		tv.tv_sec = 0;
+		tv.tv_usec = 100000;
+
+		if (0 < select(transport->sock + 1, &fdset, NULL, NULL, &tv))
+			snmp_sess_read(trap_sessp, &fdset);
+	}
+
+	if (0 == exited)
+	{
+		kill(pid, SIGKILL);
+		waitpid(pid, status, 0);
+		fail_msg("trap sender did not finish in %d seconds", MOCK_LISTENER_TIMEOUT);
+	}
+}
+
+static void	mock_check_traps(void)
+{
+	zbx_mock_handle_t	htraps, htrap, hpatterns, hpattern;
+	int			i = 0;
+
+	htraps = zbx_mock_get_parameter_handle("out.traps");
+
+	while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(htraps, &htrap))
+	{
+		zbx_snmp_trap_t	*trap;
+
+		if (i >= trap_batch.values_num)
+			fail_msg("expected more than %d traps", trap_batch.values_num);
+
+		trap = trap_batch.values[i++];
+
+		zbx_mock_assert_str_eq("trap address", "127.0.0.1", trap->addr);
+
+		hpatterns = zbx_mock_get_object_member_handle(htrap, "patterns");
+
+		while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hpatterns, &hpattern))
+		{
+			const char	*pattern;
+
+			if (ZBX_MOCK_SUCCESS != zbx_mock_string(hpattern, &pattern))
+				fail_msg("invalid trap pattern");
+
+			if (NULL == zbx_regexp_match(trap->trap, pattern, NULL))
+				fail_msg("trap does not match \"%s\":\n%s", pattern, trap->trap);
+		}
+	}
+
+	zbx_mock_assert_int_eq("received traps", i, trap_batch.values_num);
+}
+#endif
+
+void	zbx_mock_test_entry(void **state)
+{
+#ifdef HAVE_NETSNMP
+	zbx_mock_handle_t	htraps, htrap;
+	pid_t			pid;
+	int			port, traps_num = 0, status = 0;
+
+	ZBX_UNUSED(state);
+
+	zbx_vector_snmp_trap_ptr_create(&trap_batch);
+
+	port = zbx_mock_get_parameter_int("in.port");
+
+	if (SUCCEED != snmp_trap_listener_open("zabbix_server", port, zbx_mock_get_parameter_string(
+			"in.communities")))
+	{
+		fail_msg("cannot open SNMP trap listener on port %d", port);
+	}
+
+	htraps = zbx_mock_get_parameter_handle("out.traps");
+	while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(htraps, &htrap))
+		traps_num++;
+
+	if (-1 == (pid = fork()))
+		fail_msg("cannot fork trap sender: %s", zbx_strerror(errno));
+
+	if (0 == pid)
+		mock_send_traps(port);
+
+	mock_receive_traps(pid, traps_num, &status);
+
+	/* inform is acknowledged by listener, otherwise sender exits with failure */
+	if (!WIFEXITED(status) || EXIT_SUCCESS != WEXITSTATUS(status))
+		fail_msg("trap sender failed");
+
+	mock_check_traps();
+
+	snmp_trap_listener_close("zabbix_server");
+
+	zbx_vector_snmp_trap_ptr_clear_ext(&trap_batch, snmp_trap_free);
+	zbx_vector_snmp_trap_ptr_destroy(&trap_batch);
+#else
+	ZBX_UNUSED(state);
+
+	skip();
+#endif
+}
@@ -0,0 +1,241 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "proc_snapshot_common.h"
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockutil.h"
+
+#include "zbxcommon.h"
+#include "zbxalgo.h"
+#include "zbxstr.h"
+
+#include <dirent.h>
+
+/*
+ * The tests replace /proc with the processes listed in in.procs test case
+ * parameter:
+ *
+ *   procs:
+ *   - pid: 1
+ *     cmdline: [/sbin/init, splash]
+ *     status: |
+ *       Name:	systemd
+ *       ...
+ *
+ * When in.procs is not set the real /proc is used.
+ */
+
+typedef struct
+{
+	char	pid[32];
+	char	*cmdline;
+	size_t	cmdline_len;
+	char	*status;
+}
+mock_proc_t;
+
+ZBX_PTR_VECTOR_DECL(mock_proc_ptr, mock_proc_t *)
+ZBX_PTR_VECTOR_IMPL(mock_proc_ptr, mock_proc_t *)
+
+static zbx_vector_mock_proc_ptr_t	mock_procs;
+static int				mock_procs_enabled, mock_procs_next;
+static struct dirent			mock_dirent;
+
+/* the address is used only as DIR handle of the mocked /proc */
+static char				mock_dir;
+
+static const void			*mock_snapshot;
+
+FILE	*__real_fopen(const char *path, const char *mode);
+DIR	*__real_opendir(const char *name);
+struct dirent	*__real_readdir(DIR *dirp);
+int	__real_closedir(DIR *dirp);
+
+DIR	*__wrap_opendir(const char *name);
+struct dirent	*__wrap_readdir(DIR *dirp);
+int	__wrap_closedir(DIR *dirp);
+int	__wrap_zbx_procsnap_lock(const void **data);
+void	__wrap_zbx_procsnap_unlock(void);
+
+static void	mock_proc_free(mock_proc_t *proc)
+{
+	zbx_free(proc->cmdline);
+	zbx_free(proc->status);
+	zbx_free(proc);
+}
+
+static FILE	*mock_proc_fopen(const char *path, const char *mode)
+{
+	const char	*pid, *file;
+	size_t		pid_len;
+
+	if (0 == mock_procs_enabled || 0 != strncmp(path, "/proc/", ZBX_CONST_STRLEN("/proc/")))
+		return __real_fopen(path, mode);
+
+	pid = path + ZBX_CONST_STRLEN("/proc/");
+
+	if (NULL == (file = strchr(pid, '/')))
+		return __real_fopen(path, mode);
+
+	pid_len = (size_t)(file++ - pid);
+
+	for (int i = 0; i < mock_procs.values_num; i++)
+	{
+		mock_proc_t	*proc = mock_procs.values[i];
+
+		if (pid_len != strlen(proc->pid) || 0 != strncmp(pid, proc->pid, pid_len))
+			continue;
+
+		if (0 == strcmp(file, "cmdline"))
+		{
+			/* fmemopen() fails on empty buffer in older glibc versions */
+			if (0 == proc->cmdline_len)
+				return __real_fopen("/dev/null", mode);
+
+			return fmemopen(proc->cmdline, proc->cmdline_len, mode);
+		}
+
+		if (0 == strcmp(file, "status") && NULL != proc->status)
+			return fmemopen(proc->status, strlen(proc->status), mode);
+
+		break;
+	}
+
+	errno = ENOENT;
+
+	return NULL;
+}
+
+void	proc_snapshot_mock_init(void)
+{
+	zbx_mock_handle_t	hprocs, hproc, harg, hargs;
+	zbx_mock_error_t	err;
+
+	zbx_vector_mock_proc_ptr_create(&mock_procs);
+	mock_snapshot = NULL;
+
+	zbx_set_fopen_mock_callback(mock_proc_fopen);
+
+	if (ZBX_MOCK_SUCCESS != zbx_mock_parameter("in.procs", &hprocs))
+	{
+		mock_procs_enabled = 0;
+		return;
+	}
+
+	mock_procs_enabled = 1;
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = zbx_mock_vector_element(hprocs, &hproc)))
+	{
+		mock_proc_t	*proc;
+		size_t		cmdline_alloc = 0;
+		const char	*status;
+
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("Cannot read process: %s", zbx_mock_error_string(err));
+
+		proc = (mock_proc_t *)zbx_malloc(NULL, sizeof(mock_proc_t));
+		memset(proc, 0, sizeof(mock_proc_t));
+
+		zbx_snprintf(proc->pid, sizeof(proc->pid), ZBX_FS_UI64,
+				zbx_mock_get_object_member_uint64(hproc, "pid"));
+
+		/* command line arguments are stored separated by '\0' as in /proc/<pid>/cmdline */
+		if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hproc, "cmdline", &hargs))
+		{
+			while (ZBX_MOCK_END_OF_VECTOR != (err = zbx_mock_vector_element(hargs, &harg)))
+			{
+				const char	*arg;
+
+				if (ZBX_MOCK_SUCCESS != err || ZBX_MOCK_SUCCESS != (err = zbx_mock_string(harg, &arg)))
+					fail_msg("Cannot read command line argument: %s", zbx_mock_error_string(err));
+
+				zbx_str_memcpy_alloc(&proc->cmdline, &cmdline_alloc, &proc->cmdline_len, arg,
+						strlen(arg) + 1);
+			}
+		}
+
+		if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hproc, "status", &harg) &&
+				ZBX_MOCK_SUCCESS == zbx_mock_string(harg, &status))
+		{
+			proc->status = zbx_strdup(NULL, status);
+		}
+
+		zbx_vector_mock_proc_ptr_append(&mock_procs, proc);
+	}
+}
+
+void	proc_snapshot_mock_destroy(void)
+{
+	zbx_set_fopen_mock_callback(NULL);
+
+	zbx_vector_mock_proc_ptr_clear_ext(&mock_procs, mock_proc_free);
+	zbx_vector_mock_proc_ptr_destroy(&mock_procs);
+}
+
+int	proc_snapshot_mock_procs_num(void)
+{
+	return mock_procs.values_num;
+}
+
+/* sets snapshot returned by zbx_procsnap_lock(), NULL - snapshot is not available */
+void	proc_snapshot_mock_set(const void *data)
+{
+	mock_snapshot = data;
+}
+
+DIR	*__wrap_opendir(const char *name)
+{
+	if (0 == mock_procs_enabled || 0 != strcmp(name, "/proc"))
+		return __real_opendir(name);
+
+	mock_procs_next = 0;
+
+	return (DIR *)&mock_dir;
+}
+
+struct dirent	*__wrap_readdir(DIR *dirp)
+{
+	if ((DIR *)&mock_dir != dirp)
+		return __real_readdir(dirp);
+
+	if (mock_procs_next == mock_procs.values_num)
+		return NULL;
+
+	zbx_strlcpy(mock_dirent.d_name, mock_procs.values[mock_procs_next++]->pid, sizeof(mock_dirent.d_name));
+
+	return &mock_dirent;
+}
+
+int	__wrap_closedir(DIR *dirp)
+{
+	if ((DIR *)&mock_dir != dirp)
+		return __real_closedir(dirp);
+
+	return 0;
+}
+
+int	__wrap_zbx_procsnap_lock(const void **data)
+{
+	if (NULL == mock_snapshot)
+		return FAIL;
+
+	*data = mock_snapshot;
+
+	return SUCCEED;
+}
+
+void	__wrap_zbx_procsnap_unlock(void)
+{
+}
@@ -0,0 +1,100 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "proc_snapshot_common.h"
+#include "../../../../src/libs/zbxsysinfo/linux/proc.c"
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: evaluates proc.num[] or proc.mem[] item                           *
+ *                                                                            *
+ * Parameters: key - [IN] item key                                            *
+ *                                                                            *
+ * Return value: item value                                                   *
+ *                                                                            *
+ ******************************************************************************/
+static char	*evaluate_item(const char *key)
+{
+	AGENT_REQUEST	request;
+	AGENT_RESULT	result;
+	char		*value = NULL;
+	int		ret;
+
+	zbx_init_agent_request(&request);
+	zbx_init_agent_result(&result);
+
+	if (SUCCEED != zbx_parse_item_key(key, &request))
+		fail_msg("invalid item key \"%s\"", key);
+
+	if (0 == strcmp(request.key, "proc.num"))
+		ret = proc_num(&request, &result);
+	else if (0 == strcmp(request.key, "proc.mem"))
+		ret = proc_mem(&request, &result);
+	else
+		fail_msg("unsupported item key \"%s\"", key);
+
+	if (SYSINFO_RET_OK != ret)
+	{
+		fail_msg("cannot evaluate \"%s\": %s", key, NULL != ZBX_GET_MSG_RESULT(&result) ?
+				*ZBX_GET_MSG_RESULT(&result) : "unknown error");
+	}
+
+	if (0 != ZBX_ISSET_UI64(&result))
+		value = zbx_dsprintf(NULL, ZBX_FS_UI64, *ZBX_GET_UI64_RESULT(&result));
+	else if (0 != ZBX_ISSET_DBL(&result))
+		value = zbx_dsprintf(NULL, ZBX_FS_DBL, *ZBX_GET_DBL_RESULT(&result));
+	else
+		fail_msg("unexpected result type of \"%s\"", key);
+
+	zbx_free_agent_result(&result);
+	zbx_free_agent_request(&request);
+
+	return value;
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	char		*data = NULL, *direct_value, *snapshot_value;
+	const char	*key, *expected_value;
+	size_t		data_size;
+
+	ZBX_UNUSED(state);
+
+	proc_snapshot_mock_init();
+
+	key = zbx_mock_get_parameter_string("in.key");
+	expected_value = zbx_mock_get_parameter_string("out.value");
+
+	direct_value = evaluate_item(key);
+
+	if (SUCCEED != zbx_proc_get_snapshot(&data, &data_size))
+		fail_msg("cannot take process snapshot");
+
+	proc_snapshot_mock_set(data);
+	snapshot_value = evaluate_item(key);
+	proc_snapshot_mock_set(NULL);
+
+	zbx_mock_assert_str_eq("value read from /proc", expected_value, direct_value);
+	zbx_mock_assert_str_eq("value read from snapshot", expected_value, snapshot_value);
+
+	zbx_free(snapshot_value);
+	zbx_free(direct_value);
+	zbx_free(data);
+	proc_snapshot_mock_destroy();
+}
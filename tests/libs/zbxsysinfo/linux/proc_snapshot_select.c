@@ -0,0 +1,133 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "proc_snapshot_common.h"
+#include "../../../../src/libs/zbxsysinfo/linux/proc.c"
+
+static int	mock_str_to_proc_stat(const char *str)
+{
+	if (NULL == str || 0 == strcmp(str, "all"))
+		return ZBX_PROC_STAT_ALL;
+
+	if (0 == strcmp(str, "run"))
+		return ZBX_PROC_STAT_RUN;
+
+	if (0 == strcmp(str, "sleep"))
+		return ZBX_PROC_STAT_SLEEP;
+
+	if (0 == strcmp(str, "zomb"))
+		return ZBX_PROC_STAT_ZOMB;
+
+	if (0 == strcmp(str, "disk"))
+		return ZBX_PROC_STAT_DISK;
+
+	if (0 == strcmp(str, "trace"))
+		return ZBX_PROC_STAT_TRACE;
+
+	fail_msg("unknown process state \"%s\"", str);
+
+	return ZBX_PROC_STAT_ALL;
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	char				*data = NULL, *error = NULL;
+	size_t				data_size;
+	const char			*procname, *cmdline, *snapshot;
+	struct passwd			pw, *usrinfo = NULL;
+	zbx_regexp_t			*proccomm_rxp = NULL;
+	zbx_mock_handle_t		huid;
+	zbx_uint64_t			uid;
+	zbx_vector_proc_snapshot_proc_t	procs;
+	zbx_vector_uint64_t		expected_pids, returned_pids;
+	int				procs_num, count_num, zbx_proc_stat, ret, expected_ret;
+
+	ZBX_UNUSED(state);
+
+	proc_snapshot_mock_init();
+
+	if (SUCCEED != zbx_proc_get_snapshot(&data, &data_size))
+		fail_msg("cannot take process snapshot");
+
+	/* snapshot is not available before collector takes it or when it is outdated */
+	if (NULL == (snapshot = zbx_mock_get_optional_parameter_string("in.snapshot")) ||
+			0 != strcmp(snapshot, "unavailable"))
+	{
+		proc_snapshot_mock_set(data);
+	}
+
+	procname = zbx_mock_get_optional_parameter_string("in.filter.name");
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_parameter("in.filter.uid", &huid))
+	{
+		if (ZBX_MOCK_SUCCESS != zbx_mock_uint64(huid, &uid))
+			fail_msg("invalid user identifier in test case data");
+
+		memset(&pw, 0, sizeof(pw));
+		pw.pw_uid = (uid_t)uid;
+		usrinfo = &pw;
+	}
+
+	if (NULL != (cmdline = zbx_mock_get_optional_parameter_string("in.filter.cmdline")) &&
+			SUCCEED != zbx_regexp_compile(cmdline, &proccomm_rxp, &error))
+	{
+		fail_msg("invalid command line regular expression: %s", error);
+	}
+
+	zbx_proc_stat = mock_str_to_proc_stat(zbx_mock_get_optional_parameter_string("in.filter.state"));
+
+	zbx_vector_proc_snapshot_proc_create(&procs);
+	zbx_vector_uint64_create(&expected_pids);
+	zbx_vector_uint64_create(&returned_pids);
+
+	ret = proc_snapshot_select(procname, usrinfo, proccomm_rxp, zbx_proc_stat, &procs, &procs_num);
+
+	expected_ret = zbx_mock_str_to_return_code(zbx_mock_get_parameter_string("out.return"));
+	zbx_mock_assert_result_eq("proc_snapshot_select() return value", expected_ret, ret);
+
+	if (SUCCEED == ret)
+	{
+		zbx_mock_assert_int_eq("number of selected processes", procs.values_num, procs_num);
+
+		for (int i = 0; i < procs.values_num; i++)
+			zbx_vector_uint64_append(&returned_pids, (zbx_uint64_t)procs.values[i].pid);
+
+		zbx_vector_uint64_sort(&returned_pids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+		zbx_mock_extract_yaml_values_uint64(zbx_mock_get_parameter_handle("out.pids"), &expected_pids);
+		zbx_vector_uint64_sort(&expected_pids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+		zbx_mock_assert_vector_uint64_eq("selected processes", &expected_pids, &returned_pids);
+
+		/* proc.num[] counts processes without copying them */
+		zbx_mock_assert_result_eq("proc_snapshot_select() return value without processes", SUCCEED,
+				proc_snapshot_select(procname, usrinfo, proccomm_rxp, zbx_proc_stat, NULL, &count_num));
+		zbx_mock_assert_int_eq("number of counted processes", procs_num, count_num);
+	}
+
+	zbx_vector_uint64_destroy(&returned_pids);
+	zbx_vector_uint64_destroy(&expected_pids);
+	zbx_vector_proc_snapshot_proc_destroy(&procs);
+
+	if (NULL != proccomm_rxp)
+		zbx_regexp_free(proccomm_rxp);
+
+	zbx_free(data);
+	proc_snapshot_mock_destroy();
+}
@@ -0,0 +1,187 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "proc_snapshot_common.h"
+#include "../../../../src/libs/zbxsysinfo/linux/proc.c"
+
+static int	mock_vector_has_str(zbx_mock_handle_t hvector, const char *str)
+{
+	zbx_mock_handle_t	hvalue;
+	const char		*value;
+
+	while (ZBX_MOCK_END_OF_VECTOR != zbx_mock_vector_element(hvector, &hvalue))
+	{
+		if (ZBX_MOCK_SUCCESS == zbx_mock_string(hvalue, &value) && 0 == strcmp(value, str))
+			return SUCCEED;
+	}
+
+	return FAIL;
+}
+
+static void	check_snapshot_str(const char *prefix, const char *data, int offset, zbx_mock_handle_t hproc,
+		const char *name)
+{
+	zbx_mock_handle_t	hvalue;
+	const char		*expected;
+
+	if (ZBX_MOCK_SUCCESS != zbx_mock_object_member(hproc, name, &hvalue))
+	{
+		if (0 != offset)
+			fail_msg("%s: expected no %s but got \"%s\"", prefix, name, data + offset);
+
+		return;
+	}
+
+	if (ZBX_MOCK_SUCCESS != zbx_mock_string(hvalue, &expected))
+		fail_msg("%s: invalid expected %s", prefix, name);
+
+	if (0 == offset)
+		fail_msg("%s: expected %s \"%s\" but got none", prefix, name, expected);
+
+	zbx_mock_assert_str_eq(prefix, expected, data + offset);
+}
+
+static void	check_snapshot_mem(const char *prefix, const proc_snapshot_proc_t *proc, zbx_mock_handle_t hproc)
+{
+	zbx_mock_handle_t	hmem, hinvalid, hvalue;
+	zbx_uint32_t		mem_found = 0, mem_invalid = 0;
+	zbx_uint64_t		value;
+	int			has_mem;
+
+	has_mem = (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hproc, "mem", &hmem));
+
+	for (int i = 0; i < PROC_MEM_COUNT; i++)
+	{
+		char	label[32];
+
+		/* drop ":\t" suffix of status file label */
+		zbx_strlcpy(label, proc_mem_labels[i], strlen(proc_mem_labels[i]) - 1);
+
+		/* vector handle is iterated, so it is requested for every label */
+		if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hproc, "invalid", &hinvalid) &&
+				SUCCEED == mock_vector_has_str(hinvalid, label))
+			mem_invalid |= 1 << i;
+
+		if (0 == has_mem || ZBX_MOCK_SUCCESS != zbx_mock_object_member(hmem, label, &hvalue))
+			continue;
+
+		if (ZBX_MOCK_SUCCESS != zbx_mock_uint64(hvalue, &value))
+			fail_msg("%s: invalid expected %s value", prefix, label);
+
+		mem_found |= 1 << i;
+		zbx_mock_assert_uint64_eq(label, value, proc->mem[i]);
+	}
+
+	zbx_mock_assert_uint64_eq("found memory values", mem_found, proc->mem_found);
+	zbx_mock_assert_uint64_eq("invalid memory values", mem_invalid, proc->mem_invalid);
+}
+
+static void	check_snapshot_index(const char *path, const char *data, const int *index)
+{
+	const proc_snapshot_t		*snapshot = (const proc_snapshot_t *)data;
+	const proc_snapshot_proc_t	*procs = (const proc_snapshot_proc_t *)(data + snapshot->procs);
+	zbx_vector_uint64_t		expected, returned;
+
+	zbx_vector_uint64_create(&expected);
+	zbx_vector_uint64_create(&returned);
+
+	zbx_mock_extract_yaml_values_uint64(zbx_mock_get_parameter_handle(path), &expected);
+
+	for (int i = 0; i < snapshot->procs_num; i++)
+		zbx_vector_uint64_append(&returned, (zbx_uint64_t)procs[index[i]].pid);
+
+	zbx_mock_assert_vector_uint64_eq(path, &expected, &returned);
+
+	zbx_vector_uint64_destroy(&returned);
+	zbx_vector_uint64_destroy(&expected);
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	char				*data = NULL, prefix[64];
+	size_t				data_size;
+	const proc_snapshot_t		*snapshot;
+	const proc_snapshot_proc_t	*procs;
+	zbx_mock_handle_t		hprocs, hproc, hvalue;
+	zbx_mock_error_t		err;
+	zbx_uint64_t			uid;
+	const char			*state_str;
+	int				i;
+
+	ZBX_UNUSED(state);
+
+	proc_snapshot_mock_init();
+
+	zbx_mock_assert_result_eq("zbx_proc_get_snapshot() return value", SUCCEED,
+			zbx_proc_get_snapshot(&data, &data_size));
+
+	snapshot = (const proc_snapshot_t *)data;
+	procs = (const proc_snapshot_proc_t *)(data + snapshot->procs);
+
+	hprocs = zbx_mock_get_parameter_handle("out.procs");
+
+	for (i = 0; ZBX_MOCK_END_OF_VECTOR != (err = zbx_mock_vector_element(hprocs, &hproc)); i++)
+	{
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("Cannot read expected process #%d: %s", i, zbx_mock_error_string(err));
+
+		if (i >= snapshot->procs_num)
+			fail_msg("expected more than %d processes in snapshot", snapshot->procs_num);
+
+		zbx_snprintf(prefix, sizeof(prefix), "process #%d", i);
+
+		zbx_mock_assert_uint64_eq(prefix, zbx_mock_get_object_member_uint64(hproc, "pid"),
+				(zbx_uint64_t)procs[i].pid);
+
+		zbx_snprintf(prefix, sizeof(prefix), "process %d", (int)procs[i].pid);
+
+		check_snapshot_str(prefix, data, procs[i].name, hproc, "name");
+		check_snapshot_str(prefix, data, procs[i].name_arg0, hproc, "name_arg0");
+		check_snapshot_str(prefix, data, procs[i].cmdline, hproc, "cmdline");
+
+		if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hproc, "uid", &hvalue))
+		{
+			if (ZBX_MOCK_SUCCESS != zbx_mock_uint64(hvalue, &uid))
+				fail_msg("%s: invalid expected uid", prefix);
+
+			zbx_mock_assert_int_eq(prefix, 1, procs[i].uid_found);
+			zbx_mock_assert_uint64_eq(prefix, uid, (zbx_uint64_t)procs[i].uid);
+		}
+		else
+			zbx_mock_assert_int_eq(prefix, 0, procs[i].uid_found);
+
+		if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hproc, "state", &hvalue) &&
+				ZBX_MOCK_SUCCESS == zbx_mock_string(hvalue, &state_str))
+		{
+			zbx_mock_assert_int_eq(prefix, *state_str, procs[i].state);
+		}
+		else
+			zbx_mock_assert_int_eq(prefix, '\0', procs[i].state);
+
+		check_snapshot_mem(prefix, &procs[i], hproc);
+	}
+
+	zbx_mock_assert_int_eq("number of processes in snapshot", i, snapshot->procs_num);
+
+	check_snapshot_index("out.by_name_arg0", data, (const int *)(data + snapshot->by_name_arg0));
+	check_snapshot_index("out.by_uid", data, (const int *)(data + snapshot->by_uid));
+
+	zbx_free(data);
+	proc_snapshot_mock_destroy();
+}
@@ -41,7 +41,7 @@ static zbx_timespec_t	vcmock_ts;
 int	__wrap_zbx_mutex_create(zbx_mutex_t *mutex, zbx_mutex_name_t name, char **error);
 void	__wrap_zbx_mutex_destroy(zbx_mutex_t *mutex);
 int	__wrap_zbx_shmem_create(zbx_shmem_info_t **info, zbx_uint64_t size, const char *descr, const char *param,
-		int allow_oom, char **error);
+		int allow_oom, unsigned char alloc_mode, char **error);
 void	__wrap_zbx_shmem_destroy(zbx_shmem_info_t *info);
 void	*__wrap___zbx_shmem_malloc(const char *file, int line, zbx_shmem_info_t *info, const void *old, size_t size);
 void	*__wrap___zbx_shmem_realloc(const char *file, int line, zbx_shmem_info_t *info, void *old, size_t size);
@@ -51,8 +51,11 @@ int	__wrap_zbx_history_get_values(zbx_uint64_t itemid, int value_type, int start
 		zbx_vector_history_record_t *values);
 int	__wrap_zbx_history_add_values(const zbx_vector_ptr_t *history);
 void	__wrap_zbx_history_sql_init(zbx_history_iface_t *hist, unsigned char value_type);
+void	__wrap_zbx_history_sql_set_writers_num(int writers_num);
 int	__wrap_zbx_history_elastic_init(zbx_history_iface_t *hist, unsigned char value_type,
 		int config_log_slow_queries, char **error);
+int	__wrap_zbx_history_tsdb_init(zbx_history_iface_t *hist, unsigned char value_type,
+		const char *config_history_storage_path, char **error);
 void	__wrap_zbx_elastic_version_extract(void);
 int	__wrap_zbx_elastic_version_get(void);
 time_t	__wrap_time(time_t *ptr);
@@ -219,11 +222,18 @@ static void	zbx_vcmock_ds_clone_record(const zbx_history_record_t *src, unsigned
 void	zbx_vcmock_read_values(zbx_mock_handle_t hdata, unsigned char value_type, zbx_vector_history_record_t *values)
 {
 	zbx_mock_error_t	err;
-	zbx_mock_handle_t	hvalue;
+	zbx_mock_handle_t	hvalue, hmember;
 	zbx_history_record_t	rec;
 
 	while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hdata, &hvalue))))
 	{
+		/* nested value lists are flattened, so lists included from files can be combined */
+		if (ZBX_MOCK_NOT_AN_OBJECT == zbx_mock_object_member(hvalue, "value", &hmember))
+		{
+			zbx_vcmock_read_values(hvalue, value_type, values);
+			continue;
+		}
+
 		zbx_vcmock_read_history_value(hvalue, value_type, &rec.value, &rec.timestamp);
 		zbx_vector_history_record_append_ptr(values, &rec);
 	}
@@ -498,13 +508,14 @@ void	__wrap_zbx_mutex_destroy(zbx_mutex_t *mutex)
 }
 
 int	__wrap_zbx_shmem_create(zbx_shmem_info_t **info, zbx_uint64_t size, const char *descr, const char *param,
-		int allow_oom, char **error)
+		int allow_oom, unsigned char alloc_mode, char **error)
 {
 	*info = vc_meminfo;
 	ZBX_UNUSED(size);
 	ZBX_UNUSED(descr);
 	ZBX_UNUSED(param);
 	ZBX_UNUSED(allow_oom);
+	ZBX_UNUSED(alloc_mode);
 	ZBX_UNUSED(error);
 
 	return SUCCEED;
@@ -653,6 +664,11 @@ void	__wrap_zbx_history_sql_init(zbx_history_iface_t *hist, unsigned char value_
 	ZBX_UNUSED(value_type);
 }
 
+void	__wrap_zbx_history_sql_set_writers_num(int writers_num)
+{
+	ZBX_UNUSED(writers_num);
+}
+
 int	__wrap_zbx_history_elastic_init(zbx_history_iface_t *hist, unsigned char value_type,
 		int config_log_slow_queries, char **error)
 {
@@ -664,6 +680,17 @@ int	__wrap_zbx_history_elastic_init(zbx_history_iface_t *hist, unsigned char val
 	return SUCCEED;
 }
 
+int	__wrap_zbx_history_tsdb_init(zbx_history_iface_t *hist, unsigned char value_type,
+		const char *config_history_storage_path, char **error)
+{
+	ZBX_UNUSED(hist);
+	ZBX_UNUSED(value_type);
+	ZBX_UNUSED(config_history_storage_path);
+	ZBX_UNUSED(error);
+
+	return SUCCEED;
+}
+
 void	__wrap_zbx_elastic_version_extract(void)
 {
 }
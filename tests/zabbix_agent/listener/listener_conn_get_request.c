@@ -0,0 +1,183 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "../../../src/zabbix_agent/listener/listener.c"
+
+static unsigned char	read_flags(zbx_mock_handle_t hmessage)
+{
+	zbx_mock_handle_t	hflags, hflag;
+	unsigned char		flags = ZBX_TCP_PROTOCOL;
+	const char		*flag;
+
+	if (ZBX_MOCK_SUCCESS != zbx_mock_object_member(hmessage, "flags", &hflags))
+		return flags;
+
+	while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hflags, &hflag))
+	{
+		if (ZBX_MOCK_SUCCESS != zbx_mock_string(hflag, &flag))
+			fail_msg("Cannot read message flag");
+
+		if (0 == strcmp(flag, "ZBX_TCP_COMPRESS"))
+			flags |= ZBX_TCP_COMPRESS;
+		else if (0 == strcmp(flag, "ZBX_TCP_LARGE"))
+			flags |= ZBX_TCP_LARGE;
+		else
+			fail_msg("Unknown message flag \"%s\"", flag);
+	}
+
+	return flags;
+}
+
+/* writes message in Zabbix protocol format, 'raw' messages are written as is */
+static void	write_message(zbx_mock_handle_t hmessage, char **buf, size_t *buf_alloc, size_t *buf_offset)
+{
+	zbx_mock_handle_t	hraw, hprotocol;
+	const char		*data;
+	char			*payload = NULL;
+	size_t			payload_len, data_len;
+	unsigned char		flags, protocol;
+	zbx_uint64_t		value;
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hmessage, "raw", &hraw))
+	{
+		if (ZBX_MOCK_SUCCESS != zbx_mock_string(hraw, &data))
+			fail_msg("Cannot read raw message");
+
+		zbx_strcpy_alloc(buf, buf_alloc, buf_offset, data);
+		return;
+	}
+
+	data = zbx_mock_get_object_member_string(hmessage, "data");
+	data_len = strlen(data);
+	flags = read_flags(hmessage);
+
+	if (0 != (flags & ZBX_TCP_COMPRESS))
+	{
+		if (SUCCEED != zbx_compress(data, data_len, &payload, &payload_len))
+			fail_msg("Cannot compress message");
+	}
+	else
+	{
+		payload = zbx_strdup(NULL, data);
+		payload_len = data_len;
+	}
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hmessage, "protocol", &hprotocol))
+		protocol = (unsigned char)zbx_mock_get_object_member_uint64(hmessage, "protocol");
+	else
+		protocol = flags;
+
+	zbx_strcpy_alloc(buf, buf_alloc, buf_offset, "ZBXD");
+	zbx_chrcpy_alloc(buf, buf_alloc, buf_offset, (char)protocol);
+
+	if (0 != (flags & ZBX_TCP_LARGE))
+	{
+		zbx_uint64_t	len64_le;
+
+		len64_le = zbx_htole_uint64((zbx_uint64_t)payload_len);
+		zbx_str_memcpy_alloc(buf, buf_alloc, buf_offset, (const char *)&len64_le, sizeof(len64_le));
+		value = (0 != (flags & ZBX_TCP_COMPRESS) ? data_len : 0);
+		len64_le = zbx_htole_uint64(value);
+		zbx_str_memcpy_alloc(buf, buf_alloc, buf_offset, (const char *)&len64_le, sizeof(len64_le));
+	}
+	else
+	{
+		zbx_uint32_t	len32_le;
+
+		len32_le = zbx_htole_uint32((zbx_uint32_t)payload_len);
+		zbx_str_memcpy_alloc(buf, buf_alloc, buf_offset, (const char *)&len32_le, sizeof(len32_le));
+		value = (0 != (flags & ZBX_TCP_COMPRESS) ? data_len : 0);
+		len32_le = zbx_htole_uint32((zbx_uint32_t)value);
+		zbx_str_memcpy_alloc(buf, buf_alloc, buf_offset, (const char *)&len32_le, sizeof(len32_le));
+	}
+
+	zbx_str_memcpy_alloc(buf, buf_alloc, buf_offset, payload, payload_len);
+	zbx_free(payload);
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_mock_handle_t	hmessages, hmessage, hrequests, hrequest;
+	listener_conn_t		conn;
+	char			*data = NULL, *request;
+	size_t			data_alloc = 0, data_offset = 0, chunk, offset;
+	int			i, ret = SUCCEED, expected_ret;
+	zbx_vector_str_t	requests;
+	const char		*expected;
+
+	ZBX_UNUSED(state);
+
+	memset(&conn, 0, sizeof(conn));
+	zbx_strlcpy(conn.s.peer, "127.0.0.1", sizeof(conn.s.peer));
+	conn.s.max_len_limit = zbx_mock_get_parameter_uint64("in.max_len_limit");
+
+	hmessages = zbx_mock_get_parameter_handle("in.messages");
+
+	while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hmessages, &hmessage))
+		write_message(hmessage, &data, &data_alloc, &data_offset);
+
+	/* feed received data in chunks to check that partial messages are completed later */
+	if (0 == (chunk = (size_t)zbx_mock_get_parameter_uint64("in.chunk")))
+		chunk = data_offset;
+
+	zbx_vector_str_create(&requests);
+
+	for (offset = 0; offset < data_offset && SUCCEED == ret; offset += chunk)
+	{
+		size_t	len = MIN(chunk, data_offset - offset);
+
+		zbx_str_memcpy_alloc(&conn.buf, &conn.buf_alloc, &conn.buf_offset, data + offset, len);
+
+		while (0 != conn.buf_offset && SUCCEED == (ret = listener_conn_get_request(&conn, &request)) &&
+				NULL != request)
+		{
+			zbx_vector_str_append(&requests, request);
+		}
+	}
+
+	expected_ret = zbx_mock_str_to_return_code(zbx_mock_get_parameter_string("out.return"));
+	zbx_mock_assert_result_eq("listener_conn_get_request() return value", expected_ret, ret);
+
+	hrequests = zbx_mock_get_parameter_handle("out.requests");
+
+	for (i = 0; ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hrequests, &hrequest); i++)
+	{
+		if (ZBX_MOCK_SUCCESS != zbx_mock_string(hrequest, &expected))
+			fail_msg("Cannot read expected request");
+
+		if (i >= requests.values_num)
+			fail_msg("Expected request \"%s\" was not received", expected);
+
+		zbx_mock_assert_str_eq("received request", expected, requests.values[i]);
+	}
+
+	zbx_mock_assert_int_eq("number of received requests", zbx_mock_get_parameter_int("out.requests_num"),
+			requests.values_num);
+
+	if (SUCCEED == ret)
+	{
+		zbx_mock_assert_uint64_eq("number of unparsed bytes", zbx_mock_get_parameter_uint64("out.left"),
+				(zbx_uint64_t)conn.buf_offset);
+	}
+
+	zbx_vector_str_clear_ext(&requests, zbx_str_free);
+	zbx_vector_str_destroy(&requests);
+	zbx_free(conn.buf);
+	zbx_free(data);
+}
@@ -0,0 +1,313 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "../../../src/zabbix_agent/logfiles/logwatch.c"
+
+#if defined(HAVE_SYS_INOTIFY_H)
+#define MOCK_ITEMS_MAX	16
+
+typedef struct
+{
+	const char	*name;
+	const char	*file;
+	zbx_log_watch_t	watch;
+}
+zbx_mock_item_t;
+
+static zbx_mock_item_t	items[MOCK_ITEMS_MAX];
+static int		items_num;
+
+static zbx_uint32_t	read_mask(zbx_mock_handle_t hevent)
+{
+	zbx_mock_handle_t	hmask, hflag;
+	zbx_uint32_t		mask = 0;
+	const char		*flag;
+
+	hmask = zbx_mock_get_object_member_handle(hevent, "mask");
+
+	while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hmask, &hflag))
+	{
+		if (ZBX_MOCK_SUCCESS != zbx_mock_string(hflag, &flag))
+			fail_msg("Cannot read event mask flag");
+
+		if (0 == strcmp(flag, "IN_MODIFY"))
+			mask |= IN_MODIFY;
+		else if (0 == strcmp(flag, "IN_ATTRIB"))
+			mask |= IN_ATTRIB;
+		else if (0 == strcmp(flag, "IN_CREATE"))
+			mask |= IN_CREATE;
+		else if (0 == strcmp(flag, "IN_DELETE"))
+			mask |= IN_DELETE;
+		else if (0 == strcmp(flag, "IN_MOVED_FROM"))
+			mask |= IN_MOVED_FROM;
+		else if (0 == strcmp(flag, "IN_MOVED_TO"))
+			mask |= IN_MOVED_TO;
+		else if (0 == strcmp(flag, "IN_DELETE_SELF"))
+			mask |= IN_DELETE_SELF;
+		else if (0 == strcmp(flag, "IN_MOVE_SELF"))
+			mask |= IN_MOVE_SELF;
+		else if (0 == strcmp(flag, "IN_IGNORED"))
+			mask |= IN_IGNORED;
+		else if (0 == strcmp(flag, "IN_Q_OVERFLOW"))
+			mask |= IN_Q_OVERFLOW;
+		else
+			fail_msg("Unknown event mask flag \"%s\"", flag);
+	}
+
+	return mask;
+}
+
+/* returns watch descriptor of the log file directory or of the most recent log file */
+static int	get_watch(const char *watch)
+{
+	if (0 == strcmp(watch, "none"))
+		return -1;
+
+	for (int i = 0; i < items_num; i++)
+	{
+		if (0 == strcmp(watch, "dir"))
+			return items[i].watch.dir_wd;
+
+		if (NULL != items[i].file && 0 == strcmp(watch, items[i].file))
+			return items[i].watch.file_wd;
+	}
+
+	fail_msg("Cannot find watch \"%s\"", watch);
+
+	return -1;
+}
+
+/* writes events in the format returned by read() from inotify descriptor */
+static size_t	write_events(char *buf, size_t buf_size)
+{
+	zbx_mock_handle_t	hevents, hevent, hname;
+	const char		*name;
+	size_t			offset = 0;
+
+	hevents = zbx_mock_get_parameter_handle("in.events");
+
+	while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hevents, &hevent))
+	{
+		struct inotify_event	event;
+		size_t			name_len = 0;
+
+		memset(&event, 0, sizeof(event));
+		event.wd = get_watch(zbx_mock_get_object_member_string(hevent, "watch"));
+		event.mask = read_mask(hevent);
+
+		if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hevent, "name", &hname))
+		{
+			if (ZBX_MOCK_SUCCESS != zbx_mock_string(hname, &name))
+				fail_msg("Cannot read event file name");
+
+			/* kernel pads file names with null bytes to align the next event */
+			name_len = strlen(name) + 1;
+			name_len = (name_len + sizeof(event) - 1) / sizeof(event) * sizeof(event);
+			event.len = (zbx_uint32_t)name_len;
+		}
+
+		if (offset + sizeof(event) + name_len > buf_size)
+			fail_msg("Too many events");
+
+		memcpy(buf + offset, &event, sizeof(event));
+		memset(buf + offset + sizeof(event), 0, name_len);
+
+		if (0 != name_len)
+			memcpy(buf + offset + sizeof(event), name, strlen(name));
+
+		offset += sizeof(event) + name_len;
+	}
+
+	return offset;
+}
+
+static void	create_files(const char *dir)
+{
+	zbx_mock_handle_t	hfiles, hfile;
+	const char		*name;
+	char			path[MAX_STRING_LEN];
+	int			fd;
+
+	hfiles = zbx_mock_get_parameter_handle("in.files");
+
+	while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hfiles, &hfile))
+	{
+		if (ZBX_MOCK_SUCCESS != zbx_mock_string(hfile, &name))
+			fail_msg("Cannot read file name");
+
+		zbx_snprintf(path, sizeof(path), "%s/%s", dir, name);
+
+		if (-1 == (fd = creat(path, 0600)))
+			fail_msg("Cannot create file \"%s\": %s", path, zbx_strerror(errno));
+
+		close(fd);
+	}
+}
+
+static void	remove_files(const char *dir)
+{
+	zbx_mock_handle_t	hfiles, hfile;
+	const char		*name;
+	char			path[MAX_STRING_LEN];
+
+	hfiles = zbx_mock_get_parameter_handle("in.files");
+
+	while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hfiles, &hfile))
+	{
+		if (ZBX_MOCK_SUCCESS == zbx_mock_string(hfile, &name))
+		{
+			zbx_snprintf(path, sizeof(path), "%s/%s", dir, name);
+			unlink(path);
+		}
+	}
+
+	rmdir(dir);
+}
+
+/* watches item log files after two complete checks, the first one creates watches */
+static void	watch_items(const char *dir)
+{
+	zbx_mock_handle_t	hitems, hitem, hfile;
+	const char		*type, *pattern;
+	char			directory[MAX_STRING_LEN], path[MAX_STRING_LEN];
+	unsigned char		regexp;
+
+	zbx_snprintf(directory, sizeof(directory), "%s/", dir);
+
+	hitems = zbx_mock_get_parameter_handle("in.items");
+
+	for (items_num = 0; ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hitems, &hitem); items_num++)
+	{
+		zbx_mock_item_t	*item;
+
+		if (MOCK_ITEMS_MAX == items_num)
+			fail_msg("Too many items");
+
+		item = &items[items_num];
+		memset(item, 0, sizeof(zbx_mock_item_t));
+		item->name = zbx_mock_get_object_member_string(hitem, "name");
+
+		type = zbx_mock_get_object_member_string(hitem, "type");
+
+		if (0 == strcmp(type, "log"))
+			regexp = 0;
+		else if (0 == strcmp(type, "logrt"))
+			regexp = 1;
+		else
+			fail_msg("Unknown item type \"%s\"", type);
+
+		pattern = zbx_mock_get_object_member_string(hitem, "pattern");
+
+		if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hitem, "file", &hfile))
+		{
+			if (ZBX_MOCK_SUCCESS != zbx_mock_string(hfile, &item->file))
+				fail_msg("Cannot read item \"%s\" file", item->name);
+
+			zbx_snprintf(path, sizeof(path), "%s/%s", dir, item->file);
+		}
+
+		for (int i = 0; i < 2; i++)
+		{
+			zbx_logwatch_update(&item->watch, directory, pattern, regexp,
+					NULL != item->file ? path : NULL);
+		}
+
+		if (0 == item->watch.dir_wd || (NULL != item->file && 0 == item->watch.file_wd))
+			fail_msg("Item \"%s\" log files are not watched", item->name);
+
+		zbx_mock_assert_int_eq(item->name, SUCCEED, zbx_logwatch_unchanged(&item->watch));
+	}
+}
+
+static int	is_changed(const char *name)
+{
+	zbx_mock_handle_t	hchanged, hname;
+	const char		*changed;
+
+	hchanged = zbx_mock_get_parameter_handle("out.changed");
+
+	while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hchanged, &hname))
+	{
+		if (ZBX_MOCK_SUCCESS != zbx_mock_string(hname, &changed))
+			fail_msg("Cannot read changed item name");
+
+		if (0 == strcmp(name, changed))
+			return SUCCEED;
+	}
+
+	return FAIL;
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	union
+	{
+		struct inotify_event	event;
+		char			buf[4096];
+	}
+	data;
+	char	dir[] = "/tmp/zbx_logwatch_XXXXXX";
+	size_t	len;
+	int	ret;
+
+	ZBX_UNUSED(state);
+
+	if (NULL == mkdtemp(dir))
+		fail_msg("Cannot create temporary directory: %s", zbx_strerror(errno));
+
+	if (SUCCEED != zbx_logwatch_init())
+	{
+		remove_files(dir);
+		skip();
+	}
+
+	create_files(dir);
+	watch_items(dir);
+
+	len = write_events(data.buf, sizeof(data.buf));
+
+	/* the same as logwatch_read_events() does before processing events */
+	logwatch.revision++;
+	ret = logwatch_process_events(data.buf, len);
+
+	zbx_mock_assert_result_eq("logwatch_process_events()", zbx_mock_str_to_return_code(
+			zbx_mock_get_parameter_string("out.result")), ret);
+
+	for (int i = 0; i < items_num; i++)
+	{
+		zbx_mock_assert_int_eq(items[i].name, SUCCEED == is_changed(items[i].name) ? FAIL : SUCCEED,
+				zbx_logwatch_unchanged(&items[i].watch));
+	}
+
+	for (int i = 0; i < items_num; i++)
+		zbx_logwatch_release(&items[i].watch);
+
+	zbx_mock_assert_int_eq("watches left after release", 0, logwatch.entries.num_data);
+
+	zbx_logwatch_destroy();
+	remove_files(dir);
+}
+#else
+void	zbx_mock_test_entry(void **state)
+{
+	ZBX_UNUSED(state);
+
+	skip();
+}
+#endif
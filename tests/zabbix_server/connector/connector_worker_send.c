@@ -0,0 +1,563 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "../../../src/zabbix_server/connector/connector_worker.c"
+
+#include "zbxhash.h"
+
+#include <zlib.h>
+
+/* Connector requests are sent by worker event loop to a stub HTTP server running in a child process. The  */
+/* server can hold the first requests and reply to them in reverse order, other requests are replied to as */
+/* soon as they are received. Every received request body is reported back to the test by its digest.     */
+
+#define STUB_REQUESTS_MAX	16
+#define STUB_DIGEST_LEN		(ZBX_MD5_DIGEST_SIZE * 2 + 1)
+
+static zbx_vector_str_t	finished;
+static char		*paths[STUB_REQUESTS_MAX];
+
+int	__wrap_zbx_ipc_async_socket_send(zbx_ipc_async_socket_t *asocket, zbx_uint32_t code, const unsigned char *data,
+		zbx_uint32_t size);
+int	__wrap_zbx_ipc_async_socket_flush(zbx_ipc_async_socket_t *asocket, int timeout);
+void	__wrap_zbx_update_selfmon_counter(const zbx_thread_info_t *info, unsigned char state);
+
+/* results sent to connector manager are recorded as paths of finished requests */
+int	__wrap_zbx_ipc_async_socket_send(zbx_ipc_async_socket_t *asocket, zbx_uint32_t code, const unsigned char *data,
+		zbx_uint32_t size)
+{
+	zbx_uint64_t	taskid;
+
+	ZBX_UNUSED(asocket);
+
+	zbx_mock_assert_uint64_eq("result message code", ZBX_IPC_CONNECTOR_RESULT, code);
+	zbx_mock_assert_uint64_eq("result message size", sizeof(taskid), size);
+
+	memcpy(&taskid, data, sizeof(taskid));
+
+	if (0 == taskid || STUB_REQUESTS_MAX < taskid)
+		fail_msg("unexpected task identifier " ZBX_FS_UI64, taskid);
+
+	zbx_vector_str_append(&finished, paths[taskid - 1]);
+
+	return SUCCEED;
+}
+
+int	__wrap_zbx_ipc_async_socket_flush(zbx_ipc_async_socket_t *asocket, int timeout)
+{
+	ZBX_UNUSED(asocket);
+	ZBX_UNUSED(timeout);
+
+	return SUCCEED;
+}
+
+void	__wrap_zbx_update_selfmon_counter(const zbx_thread_info_t *info, unsigned char state)
+{
+	ZBX_UNUSED(info);
+	ZBX_UNUSED(state);
+}
+
+static void	body_digest(const char *data, size_t size, char *digest)
+{
+	md5_state_t	state;
+	md5_byte_t	hash[ZBX_MD5_DIGEST_SIZE];
+
+	zbx_md5_init(&state);
+	zbx_md5_append(&state, (const md5_byte_t *)data, (int)size);
+	zbx_md5_finish(&state, hash);
+	zbx_md5buf2str(hash, digest);
+}
+
+static char	*stub_gunzip(const char *data, size_t size)
+{
+	z_stream	strm;
+	char		*out = NULL;
+	size_t		out_alloc = 0, out_offset = 0;
+	int		ret;
+
+	memset(&strm, 0, sizeof(strm));
+
+	if (Z_OK != inflateInit2(&strm, 16 + MAX_WBITS))
+		return NULL;
+
+	strm.next_in = (Bytef *)data;
+	strm.avail_in = (uInt)size;
+
+	do
+	{
+		char	buf[4096];
+
+		strm.next_out = (Bytef *)buf;
+		strm.avail_out = sizeof(buf);
+
+		if (Z_STREAM_ERROR == (ret = inflate(&strm, Z_NO_FLUSH)) || Z_DATA_ERROR == ret || Z_MEM_ERROR == ret)
+			break;
+
+		zbx_strncpy_alloc(&out, &out_alloc, &out_offset, buf, sizeof(buf) - strm.avail_out);
+	}
+	while (Z_STREAM_END != ret);
+
+	inflateEnd(&strm);
+
+	if (Z_STREAM_END != ret)
+		zbx_free(out);
+
+	return out;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: reads HTTP request and reports its path, body encoding, size and *
+ *          digest                                                            *
+ *                                                                            *
+ * Return value: the request path                                             *
+ *                                                                            *
+ ******************************************************************************/
+static char	*stub_read_request(int fd, int report)
+{
+	char		*req = NULL, *body, *path = NULL, *data = NULL, *report_line, digest[STUB_DIGEST_LEN];
+	size_t		req_alloc = 0, req_offset = 0, size = 0, body_offset = 0;
+	const char	*cl;
+	int		gzip = 0;
+
+	while (1)
+	{
+		char	buf[4096];
+		ssize_t	n;
+
+		if (0 >= (n = recv(fd, buf, sizeof(buf), 0)))
+			break;
+
+		zbx_str_memcpy_alloc(&req, &req_alloc, &req_offset, buf, (size_t)n);
+
+		/* buffer can be reallocated, so body is referenced by offset */
+		if (0 == body_offset && NULL != (body = strstr(req, "\r\n\r\n")))
+		{
+			body_offset = (size_t)(body - req) + 4;
+
+			if (NULL != (cl = zbx_strcasestr(req, "Content-Length:")) && cl < body)
+				size = strtoul(cl + ZBX_CONST_STRLEN("Content-Length:"), NULL, 10);
+		}
+
+		if (0 != body_offset && req_offset >= body_offset + size)
+			break;
+	}
+
+	if (0 == body_offset)
+		_exit(EXIT_FAILURE);
+
+	body = req + body_offset;
+
+	if (NULL != (path = strchr(req, ' ')))
+		path = zbx_dsprintf(NULL, "%.*s", (int)strcspn(path + 1, " "), path + 1);
+	else
+		path = zbx_strdup(NULL, "");
+
+	if (NULL != zbx_strcasestr(req, "Content-Encoding: gzip"))
+	{
+		gzip = 1;
+
+		if (NULL == (data = stub_gunzip(body, size)))
+			data = zbx_strdup(NULL, "");
+	}
+	else
+		data = zbx_dsprintf(NULL, "%.*s", (int)size, body);
+
+	/* large bodies are reported by digest as the test reads reports only after stub server is stopped */
+	body_digest(data, strlen(data), digest);
+	report_line = zbx_dsprintf(NULL, "%s %d " ZBX_FS_SIZE_T " %s\n", path, gzip, (zbx_fs_size_t)strlen(data),
+			digest);
+
+	if ((ssize_t)strlen(report_line) != send(report, report_line, strlen(report_line), 0))
+		_exit(EXIT_FAILURE);
+
+	zbx_free(report_line);
+	zbx_free(data);
+	zbx_free(req);
+
+	return path;
+}
+
+static void	stub_send_response(int fd, const char *path)
+{
+	static unsigned char	used[STUB_REQUESTS_MAX];
+	zbx_mock_handle_t	hresponses, hresponse;
+	int			status = 200, i;
+	char			*response;
+
+	hresponses = zbx_mock_get_parameter_handle("in.responses");
+
+	/* use the first unused response listed for the path, other requests succeed */
+	for (i = 0; i < STUB_REQUESTS_MAX && ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hresponses, &hresponse); i++)
+	{
+		if (0 != used[i] || 0 != strcmp(path, zbx_mock_get_object_member_string(hresponse, "path")))
+			continue;
+
+		status = zbx_mock_get_object_member_int(hresponse, "status");
+		used[i] = 1;
+		break;
+	}
+
+	response = zbx_dsprintf(NULL, "HTTP/1.1 %d Stub\r\nContent-Type: application/json\r\n"
+			"Content-Length: 2\r\nConnection: close\r\n\r\n{}", status);
+
+	if ((ssize_t)strlen(response) != send(fd, response, strlen(response), 0))
+		_exit(EXIT_FAILURE);
+
+	zbx_free(response);
+	close(fd);
+}
+
+static void	stub_server_run(int sock, int report)
+{
+	int	fds[STUB_REQUESTS_MAX], hold, held = 0;
+	char	*held_paths[STUB_REQUESTS_MAX], *line;
+
+	/* wait for held requests a limited time, so sequentially sent requests are not blocked forever */
+	hold = zbx_mock_get_parameter_int("in.hold");
+
+	while (held < hold && -1 != (fds[held] = accept(sock, NULL, NULL)))
+	{
+		held_paths[held] = stub_read_request(fds[held], report);
+		held++;
+	}
+
+	line = zbx_dsprintf(NULL, "held %d\n", held);
+
+	if ((ssize_t)strlen(line) != send(report, line, strlen(line), 0))
+		_exit(EXIT_FAILURE);
+
+	zbx_free(line);
+
+	while (0 < held--)
+	{
+		stub_send_response(fds[held], held_paths[held]);
+		zbx_free(held_paths[held]);
+
+		/* let worker process responses one at a time */
+		usleep(100000);
+	}
+
+	while (1)
+	{
+		int	fd;
+		char	*path;
+
+		/* stop when idle, so the server does not outlive a failed test */
+		if (-1 == (fd = accept(sock, NULL, NULL)))
+		{
+			if (EINTR == errno)
+				continue;
+
+			_exit(EAGAIN == errno || EWOULDBLOCK == errno ? EXIT_SUCCESS : EXIT_FAILURE);
+		}
+
+		path = stub_read_request(fd, report);
+		stub_send_response(fd, path);
+		zbx_free(path);
+	}
+}
+
+static pid_t	stub_server_start(unsigned short *port, int *report)
+{
+	struct sockaddr_in	addr;
+	struct timeval		tv = {3, 0};
+	socklen_t		addr_len = sizeof(addr);
+	int			sock, fds[2];
+	pid_t			pid;
+
+	if (-1 == (sock = socket(AF_INET, SOCK_STREAM, 0)))
+		fail_msg("cannot create socket: %s", zbx_strerror(errno));
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+	if (0 != bind(sock, (struct sockaddr *)&addr, sizeof(addr)) || 0 != listen(sock, SOMAXCONN) ||
+			0 != getsockname(sock, (struct sockaddr *)&addr, &addr_len) ||
+			0 != setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv)))
+	{
+		fail_msg("cannot start stub server: %s", zbx_strerror(errno));
+	}
+
+	/* socket pair is used for reports as read() is mocked in tests */
+	if (0 != socketpair(AF_UNIX, SOCK_STREAM, 0, fds))
+		fail_msg("cannot create socket pair: %s", zbx_strerror(errno));
+
+	if (0 == (pid = fork()))
+	{
+		close(fds[0]);
+		stub_server_run(sock, fds[1]);
+	}
+
+	if (-1 == pid)
+		fail_msg("cannot fork stub server: %s", zbx_strerror(errno));
+
+	close(fds[1]);
+	close(sock);
+
+	*port = ntohs(addr.sin_port);
+	*report = fds[0];
+
+	return pid;
+}
+
+static char	*read_data_point(zbx_mock_handle_t hpoint)
+{
+	const char	*str;
+	char		*out = NULL;
+	size_t		out_alloc = 0, out_offset = 0;
+	int		repeat;
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_string(hpoint, &str))
+		return zbx_strdup(NULL, str);
+
+	/* large data points are built by repeating a string */
+	str = zbx_mock_get_object_member_string(hpoint, "str");
+	repeat = zbx_mock_get_object_member_int(hpoint, "repeat");
+
+	for (int i = 0; i < repeat; i++)
+		zbx_strcpy_alloc(&out, &out_alloc, &out_offset, str);
+
+	return out;
+}
+
+static zbx_connector_request_t	*read_request(zbx_mock_handle_t hrequest, unsigned short port, char **body)
+{
+	zbx_connector_request_t		*request;
+	zbx_mock_handle_t		hpoints, hpoint;
+	zbx_connector_data_point_t	point;
+	size_t				body_alloc = 0, body_offset = 0;
+
+	request = (zbx_connector_request_t *)zbx_malloc(NULL, sizeof(zbx_connector_request_t));
+	memset(request, 0, sizeof(zbx_connector_request_t));
+
+	request->connector.url = zbx_dsprintf(NULL, "http://127.0.0.1:%hu%s", port,
+			zbx_mock_get_object_member_string(hrequest, "path"));
+	request->connector.timeout = zbx_strdup(NULL, "10s");
+	request->connector.attempt_interval = zbx_strdup(NULL,
+			zbx_mock_get_object_member_string(hrequest, "attempt_interval"));
+	request->connector.max_attempts = (unsigned char)zbx_mock_get_object_member_int(hrequest, "max_attempts");
+	request->connector.token = zbx_strdup(NULL, "");
+	request->connector.http_proxy = zbx_strdup(NULL, "");
+	request->connector.username = zbx_strdup(NULL, "");
+	request->connector.password = zbx_strdup(NULL, "");
+	request->connector.ssl_cert_file = zbx_strdup(NULL, "");
+	request->connector.ssl_key_file = zbx_strdup(NULL, "");
+	request->connector.ssl_key_password = zbx_strdup(NULL, "");
+
+	zbx_vector_connector_data_point_create(&request->data_points);
+
+	hpoints = zbx_mock_get_object_member_handle(hrequest, "points");
+
+	while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hpoints, &hpoint))
+	{
+		memset(&point, 0, sizeof(point));
+		point.str = read_data_point(hpoint);
+		zbx_vector_connector_data_point_append(&request->data_points, point);
+
+		zbx_strcpy_alloc(body, &body_alloc, &body_offset, point.str);
+		zbx_chrcpy_alloc(body, &body_alloc, &body_offset, '\n');
+	}
+
+	return request;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks requests received by stub server                           *
+ *                                                                            *
+ * Parameters: report     - [IN] report socket                                *
+ *             bodies     - [IN] expected request bodies                      *
+ *             gzip       - [IN] 1 if bodies are expected to be compressed    *
+ *                                                                            *
+ ******************************************************************************/
+static void	check_requests(int report, char **bodies, int gzip)
+{
+	char			*data = NULL, *ptr, path[MAX_STRING_LEN], digest[STUB_DIGEST_LEN],
+				expected_digest[STUB_DIGEST_LEN];
+	size_t			data_alloc = 0, data_offset = 0;
+	ssize_t			n;
+	int			attempts[STUB_REQUESTS_MAX] = {0}, held = -1, i;
+	zbx_mock_handle_t	hrequests, hrequest;
+
+	while (1)
+	{
+		char	buf[4096];
+
+		if (0 >= (n = recv(report, buf, sizeof(buf), 0)))
+			break;
+
+		zbx_str_memcpy_alloc(&data, &data_alloc, &data_offset, buf, (size_t)n);
+	}
+
+	for (ptr = data; NULL != ptr && ptr < data + data_offset;)
+	{
+		zbx_fs_size_t	len;
+		int		request_gzip, pos;
+
+		if (1 == sscanf(ptr, "held %d\n%n", &held, &pos))
+		{
+			ptr += pos;
+			continue;
+		}
+
+		if (4 != sscanf(ptr, "%1023s %d " ZBX_FS_SIZE_T " %32s\n%n", path, &request_gzip, &len, digest, &pos))
+			fail_msg("cannot parse stub server report \"%.40s\"", ptr);
+
+		ptr += pos;
+
+		for (i = 0; i < STUB_REQUESTS_MAX && NULL != paths[i]; i++)
+		{
+			if (0 == strcmp(paths[i], path))
+				break;
+		}
+
+		if (STUB_REQUESTS_MAX == i || NULL == paths[i])
+			fail_msg("unexpected request to \"%s\"", path);
+
+		zbx_mock_assert_int_eq("request body compression", gzip, request_gzip);
+		zbx_mock_assert_uint64_eq("request body size", strlen(bodies[i]), len);
+
+		body_digest(bodies[i], strlen(bodies[i]), expected_digest);
+
+		if (0 != strcmp(expected_digest, digest))
+			fail_msg("request body to \"%s\" does not match the data points", path);
+
+		attempts[i]++;
+	}
+
+	zbx_mock_assert_int_eq("requests held by stub server", zbx_mock_get_parameter_int("out.held"), held);
+
+	hrequests = zbx_mock_get_parameter_handle("in.requests");
+
+	for (i = 0; ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hrequests, &hrequest); i++)
+	{
+		zbx_mock_assert_int_eq(paths[i], zbx_mock_get_object_member_int(hrequest, "attempts"),
+				attempts[i]);
+	}
+
+	zbx_free(data);
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+#ifdef HAVE_LIBCURL
+	zbx_connector_worker_data_t	worker;
+	zbx_mock_handle_t		hrequests, hrequest, hfinished, hpath;
+	char				*error = NULL, *bodies[STUB_REQUESTS_MAX] = {0};
+	const char			*path;
+	unsigned short			port;
+	int				report, i;
+	pid_t				pid;
+	double				time_start, duration;
+
+	ZBX_UNUSED(state);
+
+	zbx_vector_str_create(&finished);
+
+	pid = stub_server_start(&port, &report);
+
+	memset(&worker, 0, sizeof(worker));
+	worker.state = ZBX_PROCESS_STATE_BUSY;
+	worker.config_connector_compression = zbx_mock_get_parameter_int("in.compression");
+	zbx_vector_connector_request_ptr_create(&worker.requests);
+
+	if (NULL == (worker.base = event_base_new()))
+		fail_msg("cannot initialize event base");
+
+	zbx_async_httpagent_init();
+
+	if (NULL == (worker.asynchttppoller_config = zbx_async_httpagent_create(worker.base, worker_request_done,
+			worker_update_selfmon_counter, &worker, &error)))
+	{
+		fail_msg("cannot create asynchronous HTTP agent: %s", error);
+	}
+
+	time_start = zbx_time();
+
+	/* all requests are started before any response is processed */
+	hrequests = zbx_mock_get_parameter_handle("in.requests");
+
+	for (i = 0; ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hrequests, &hrequest); i++)
+	{
+		zbx_connector_request_t	*request;
+
+		if (STUB_REQUESTS_MAX == i)
+			fail_msg("too many requests");
+
+		paths[i] = zbx_strdup(NULL, zbx_mock_get_object_member_string(hrequest, "path"));
+		request = read_request(hrequest, port, &bodies[i]);
+		request->taskid = ++worker.requests_num;
+		zbx_vector_connector_request_ptr_append(&worker.requests, request);
+
+		if (SUCCEED != worker_start_request(&worker, request))
+			worker_finish_request(&worker, request);
+	}
+
+	while (0 < worker.requests.values_num)
+		event_base_loop(worker.base, EVLOOP_ONCE);
+
+	duration = zbx_time() - time_start;
+
+	kill(pid, SIGKILL);
+	waitpid(pid, NULL, 0);
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_parameter_exists("out.min_duration") &&
+			duration < zbx_mock_get_parameter_int("out.min_duration"))
+	{
+		fail_msg("requests were finished in " ZBX_FS_DBL " seconds, before the attempt interval", duration);
+	}
+
+	check_requests(report, bodies, worker.config_connector_compression);
+	close(report);
+
+	hfinished = zbx_mock_get_parameter_handle("out.finished");
+
+	for (i = 0; ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hfinished, &hpath); i++)
+	{
+		if (ZBX_MOCK_SUCCESS != zbx_mock_string(hpath, &path))
+			fail_msg("cannot read finished request #%d", i + 1);
+
+		if (i == finished.values_num)
+			fail_msg("request \"%s\" was not finished", path);
+
+		zbx_mock_assert_str_eq("finished request", path, finished.values[i]);
+	}
+
+	zbx_mock_assert_int_eq("finished requests", i, finished.values_num);
+
+	zbx_async_httpagent_clean(worker.asynchttppoller_config);
+	zbx_free(worker.asynchttppoller_config);
+	zbx_vector_connector_request_ptr_destroy(&worker.requests);
+	event_base_free(worker.base);
+
+	for (i = 0; i < STUB_REQUESTS_MAX; i++)
+	{
+		zbx_free(paths[i]);
+		zbx_free(bodies[i]);
+	}
+
+	zbx_vector_str_destroy(&finished);
+#else
+	ZBX_UNUSED(state);
+
+	skip();
+#endif
+}
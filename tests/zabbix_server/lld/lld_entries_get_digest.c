@@ -0,0 +1,61 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "../../../src/zabbix_server/lld/lld_entry.c"
+#include "zbxmocktest.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+#include "zbxmockdata.h"
+#include "zbxcommon.h"
+
+static void	get_digest(const char *value, unsigned char *digest)
+{
+	char				*error = NULL;
+	zbx_vector_lld_macro_path_ptr_t	macro_paths;
+	zbx_jsonobj_t			obj;
+	zbx_hashset_t			entries;
+
+	zbx_mock_assert_result_eq("jsonobj_parse", SUCCEED, zbx_jsonobj_open(value, &obj));
+
+	zbx_vector_lld_macro_path_ptr_create(&macro_paths);
+
+	zbx_hashset_create_ext(&entries, 0, lld_entry_hash, lld_entry_compare, (zbx_clean_func_t)lld_entry_clear,
+			ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC, ZBX_DEFAULT_MEM_FREE_FUNC);
+
+	if (SUCCEED != lld_extract_entries(&entries, NULL, &obj, &macro_paths, &error))
+		fail_msg("lld_extract_entries: %s", error);
+
+	lld_entries_get_digest(&entries, digest);
+
+	zbx_hashset_destroy(&entries);
+	zbx_jsonobj_clear(&obj);
+	zbx_vector_lld_macro_path_ptr_destroy(&macro_paths);
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	unsigned char	digest1[ZBX_MD5_DIGEST_SIZE], digest2[ZBX_MD5_DIGEST_SIZE];
+	int		expected_ret, returned_ret;
+
+	ZBX_UNUSED(state);
+
+	expected_ret = zbx_mock_str_to_return_code(zbx_mock_get_parameter_string("out.result"));
+
+	get_digest(zbx_mock_get_parameter_string("in.entry1"), digest1);
+	get_digest(zbx_mock_get_parameter_string("in.entry2"), digest2);
+
+	returned_ret = (0 == memcmp(digest1, digest2, ZBX_MD5_DIGEST_SIZE) ? SUCCEED : FAIL);
+
+	zbx_mock_assert_result_eq("lld_entries_get_digest", expected_ret, returned_ret);
+}
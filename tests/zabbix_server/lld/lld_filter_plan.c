@@ -0,0 +1,256 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "../../../src/zabbix_server/lld/lld.c"
+#include "zbxmocktest.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+#include "zbxmockdata.h"
+#include "zbxcommon.h"
+
+static void	mock_read_filter(zbx_mock_handle_t hfilter, zbx_lld_filter_t *filter)
+{
+	zbx_mock_handle_t	hconditions, hcondition;
+	zbx_mock_error_t	err;
+
+	hconditions = zbx_mock_get_object_member_handle(hfilter, "conditions");
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = zbx_mock_vector_element(hconditions, &hcondition)))
+	{
+		zbx_lld_condition_t	*condition;
+
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("cannot read filter condition: %s", zbx_mock_error_string(err));
+
+		condition = zbx_lld_filter_condition_create(zbx_mock_get_object_member_string(hcondition, "id"),
+				zbx_mock_get_object_member_string(hcondition, "operator"),
+				zbx_mock_get_object_member_string(hcondition, "macro"),
+				zbx_mock_get_object_member_string(hcondition, "value"));
+
+		zbx_vector_lld_condition_ptr_append(&filter->conditions, condition);
+	}
+
+	/* conditions are sorted by macro when loaded from database */
+	if (ZBX_CONDITION_EVAL_TYPE_AND_OR == filter->evaltype)
+		zbx_vector_lld_condition_ptr_sort(&filter->conditions, lld_condition_compare_by_macro);
+}
+
+static void	mock_read_overrides(zbx_vector_lld_override_ptr_t *overrides)
+{
+	zbx_mock_handle_t	hoverrides, hoverride;
+	zbx_mock_error_t	err;
+
+	if (ZBX_MOCK_SUCCESS != zbx_mock_parameter("in.overrides", &hoverrides))
+		return;
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = zbx_mock_vector_element(hoverrides, &hoverride)))
+	{
+		zbx_lld_override_t	*override;
+
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("cannot read override: %s", zbx_mock_error_string(err));
+
+		override = zbx_lld_override_create(zbx_mock_get_object_member_string(hoverride, "id"), "0",
+				zbx_mock_get_object_member_string(hoverride, "id"), "1",
+				zbx_mock_get_object_member_string(hoverride, "evaltype"),
+				zbx_mock_get_object_member_string(hoverride, "formula"),
+				zbx_mock_get_object_member_string(hoverride, "stop"));
+
+		mock_read_filter(hoverride, &override->filter);
+		zbx_vector_lld_override_ptr_append(overrides, override);
+	}
+}
+
+static void	mock_compare_ints(const char *path, const zbx_vector_int32_t *values)
+{
+	zbx_mock_handle_t	hvalues, hvalue;
+	zbx_mock_error_t	err;
+	int			i = 0, value;
+
+	hvalues = zbx_mock_get_parameter_handle(path);
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = zbx_mock_vector_element(hvalues, &hvalue)))
+	{
+		if (ZBX_MOCK_SUCCESS != err || ZBX_MOCK_SUCCESS != (err = zbx_mock_int(hvalue, &value)))
+			fail_msg("cannot read %s: %s", path, zbx_mock_error_string(err));
+
+		if (i >= values->values_num)
+			fail_msg("%s: expected more than %d values", path, values->values_num);
+
+		zbx_mock_assert_int_eq(path, value, values->values[i++]);
+	}
+
+	zbx_mock_assert_int_eq(path, i, values->values_num);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: evaluates filter with plan and with generic row by row            *
+ *          evaluation, checks that results and warnings match                *
+ *                                                                            *
+ ******************************************************************************/
+static int	filter_evaluate_both(const zbx_lld_plan_t *plan, zbx_lld_plan_filter_t *plan_filter, int row)
+{
+	char	*info = NULL, *info_plan = NULL;
+	int	ret, ret_plan;
+
+	ret = filter_evaluate(plan_filter->filter, plan->entries->values[row], NULL, &info);
+	ret_plan = lld_plan_filter_evaluate(plan, plan_filter, row, &info_plan);
+
+	zbx_mock_assert_result_eq("filter result", ret, ret_plan);
+	zbx_mock_assert_str_eq("filter warning", ZBX_NULL2EMPTY_STR(info), ZBX_NULL2EMPTY_STR(info_plan));
+
+	zbx_free(info);
+	zbx_free(info_plan);
+
+	return ret_plan;
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	char				*error = NULL, *info = NULL;
+	zbx_vector_lld_macro_path_ptr_t	macro_paths;
+	zbx_jsonobj_t			obj;
+	zbx_hashset_t			entries;
+	zbx_vector_lld_entry_ptr_t	entries_sorted;
+	zbx_lld_filter_t		filter;
+	zbx_vector_lld_override_ptr_t	overrides;
+	zbx_vector_lld_row_ptr_t	lld_rows;
+	zbx_vector_int32_t		rows, passed, results;
+	zbx_lld_plan_t			plan;
+	zbx_mock_handle_t		hfilter;
+	int				rows_num = 0;
+
+	ZBX_UNUSED(state);
+
+	zbx_mock_assert_result_eq("jsonobj_parse", SUCCEED,
+			zbx_jsonobj_open(zbx_mock_get_parameter_string("in.rows"), &obj));
+
+	zbx_vector_lld_macro_path_ptr_create(&macro_paths);
+	zbx_vector_lld_entry_ptr_create(&entries_sorted);
+	zbx_hashset_create_ext(&entries, 0, lld_entry_hash, lld_entry_compare, (zbx_clean_func_t)lld_entry_clear,
+			ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC, ZBX_DEFAULT_MEM_FREE_FUNC);
+
+	if (SUCCEED != lld_extract_entries(&entries, &entries_sorted, &obj, &macro_paths, &error))
+		fail_msg("lld_extract_entries: %s", error);
+
+	hfilter = zbx_mock_get_parameter_handle("in.filter");
+
+	zbx_lld_filter_init(&filter);
+	filter.evaltype = atoi(zbx_mock_get_object_member_string(hfilter, "evaltype"));
+	filter.expression = zbx_strdup(NULL, zbx_mock_get_object_member_string(hfilter, "formula"));
+	mock_read_filter(hfilter, &filter);
+
+	zbx_vector_lld_override_ptr_create(&overrides);
+	mock_read_overrides(&overrides);
+
+	zbx_vector_int32_create(&rows);
+	zbx_vector_int32_create(&passed);
+	zbx_vector_int32_create(&results);
+
+	for (int i = 0; i < entries_sorted.values_num; i++)
+		zbx_vector_int32_append(&rows, i);
+
+	/* evaluate filter and every override for all rows to compare them with generic evaluation */
+	lld_plan_init(&plan, &entries_sorted, &filter, &overrides);
+
+	lld_plan_evaluate_columns(&plan, &plan.filter, &rows);
+
+	for (int i = 0; i < plan.overrides_num; i++)
+		lld_plan_evaluate_columns(&plan, &plan.overrides[i], &rows);
+
+	for (int i = 0; i < entries_sorted.values_num; i++)
+	{
+		if (SUCCEED == filter_evaluate_both(&plan, &plan.filter, i))
+			zbx_vector_int32_append(&passed, i);
+
+		for (int j = 0; j < plan.overrides_num; j++)
+			filter_evaluate_both(&plan, &plan.overrides[j], i);
+	}
+
+	zbx_mock_assert_int_eq("plan columns", zbx_mock_get_parameter_int("out.columns"), plan.columns.values_num);
+	mock_compare_ints("out.passed", &passed);
+
+	zbx_vector_int32_append(&results, plan.filter.results.num_data);
+
+	for (int i = 0; i < plan.overrides_num; i++)
+		zbx_vector_int32_append(&results, plan.overrides[i].results.num_data);
+
+	mock_compare_ints("out.results", &results);
+
+	lld_plan_clear(&plan);
+
+	/* check that rows and their overrides match generic row by row evaluation */
+	zbx_vector_lld_row_ptr_create(&lld_rows);
+
+	zbx_mock_assert_result_eq("lld_rows_get", SUCCEED,
+			lld_rows_get(&entries_sorted, &filter, &lld_rows, &overrides, &info));
+
+	for (int i = 0; i < entries_sorted.values_num; i++)
+	{
+		zbx_lld_row_t	*lld_row;
+		char		*info_row = NULL;
+		int		overrides_num = 0;
+
+		if (SUCCEED != filter_evaluate(&filter, entries_sorted.values[i], NULL, &info_row))
+		{
+			zbx_free(info_row);
+			continue;
+		}
+
+		if (rows_num >= lld_rows.values_num)
+			fail_msg("row %d passed generic filter evaluation but is missing in LLD rows", i);
+
+		lld_row = lld_rows.values[rows_num++];
+		zbx_mock_assert_ptr_eq("LLD row", entries_sorted.values[i], lld_row->data);
+
+		for (int j = 0; j < overrides.values_num; j++)
+		{
+			zbx_lld_override_t	*override = overrides.values[j];
+
+			if (SUCCEED != filter_evaluate(&override->filter, entries_sorted.values[i], NULL, &info_row))
+				continue;
+
+			if (overrides_num >= lld_row->overrides.values_num)
+				fail_msg("row %d override " ZBX_FS_UI64 " is missing", i, override->overrideid);
+
+			zbx_mock_assert_ptr_eq("LLD row override", override, lld_row->overrides.values[overrides_num++]);
+
+			if (1 == override->stop)
+				break;
+		}
+
+		zbx_mock_assert_int_eq("LLD row overrides", overrides_num, lld_row->overrides.values_num);
+		zbx_free(info_row);
+	}
+
+	zbx_mock_assert_int_eq("LLD rows", rows_num, lld_rows.values_num);
+
+	zbx_free(info);
+	zbx_vector_lld_row_ptr_clear_ext(&lld_rows, lld_row_free);
+	zbx_vector_lld_row_ptr_destroy(&lld_rows);
+
+	zbx_vector_int32_destroy(&results);
+	zbx_vector_int32_destroy(&passed);
+	zbx_vector_int32_destroy(&rows);
+
+	zbx_vector_lld_override_ptr_clear_ext(&overrides, zbx_lld_override_free);
+	zbx_vector_lld_override_ptr_destroy(&overrides);
+	zbx_lld_filter_clean(&filter);
+
+	zbx_vector_lld_entry_ptr_destroy(&entries_sorted);
+	zbx_hashset_destroy(&entries);
+	zbx_jsonobj_clear(&obj);
+	zbx_vector_lld_macro_path_ptr_destroy(&macro_paths);
+}
@@ -0,0 +1,202 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "../../../src/zabbix_server/lld/lld_manager.c"
+#include "zbxmocktest.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+#include "zbxmockdata.h"
+
+#define MOCK_LLD_RULEID	1001
+
+int		__wrap_zbx_ipc_client_send(zbx_ipc_client_t *client, zbx_uint32_t code, const unsigned char *data,
+		zbx_uint32_t size);
+zbx_uint64_t	__wrap_zbx_dc_get_lld_rule_revision(zbx_uint64_t itemid);
+time_t		__real_time(time_t *t);
+time_t		__wrap_time(time_t *t);
+
+static time_t		mock_now;
+static zbx_uint64_t	mock_revision;
+static zbx_uint32_t	mock_sent_code;
+static int		mock_sent_skip;
+
+int	__wrap_zbx_ipc_client_send(zbx_ipc_client_t *client, zbx_uint32_t code, const unsigned char *data,
+		zbx_uint32_t size)
+{
+	ZBX_UNUSED(client);
+
+	mock_sent_code = code;
+	mock_sent_skip = (0 != size && 0 != data[0]);
+
+	return SUCCEED;
+}
+
+zbx_uint64_t	__wrap_zbx_dc_get_lld_rule_revision(zbx_uint64_t itemid)
+{
+	zbx_mock_assert_uint64_eq("LLD rule identifier", MOCK_LLD_RULEID, itemid);
+
+	return mock_revision;
+}
+
+time_t	__wrap_time(time_t *t)
+{
+	time_t	now = (0 != mock_now ? mock_now : __real_time(NULL));
+
+	if (NULL != t)
+		*t = now;
+
+	return now;
+}
+
+static int	mock_get_config_forks(unsigned char process_type)
+{
+	return ZBX_PROCESS_TYPE_LLDWORKER == process_type ? 1 : 0;
+}
+
+static void	mock_register_worker(zbx_lld_manager_t *manager, zbx_ipc_client_t *client)
+{
+	zbx_ipc_message_t	message;
+	pid_t			ppid = getppid();
+
+	message.code = ZBX_IPC_LLD_REGISTER;
+	message.size = sizeof(ppid);
+	message.data = (unsigned char *)&ppid;
+
+	lld_register_worker(manager, client, &message);
+}
+
+static void	mock_queue_value(zbx_lld_manager_t *manager, const char *value)
+{
+	zbx_ipc_message_t	message;
+	zbx_timespec_t		ts = {(int)mock_now, 0};
+
+	message.code = ZBX_IPC_LLD_REQUEST;
+	message.size = zbx_lld_serialize_item_value(&message.data, MOCK_LLD_RULEID, MOCK_LLD_RULEID, value, &ts, 0,
+			0, 0, NULL);
+
+	lld_queue_request(manager, &message);
+	zbx_free(message.data);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: passes one value through LLD manager as LLD worker would do and   *
+ *          checks if the manager asked to skip its processing                *
+ *                                                                            *
+ ******************************************************************************/
+static void	mock_process_step(zbx_lld_manager_t *manager, zbx_ipc_client_t *client, zbx_mock_handle_t hstep,
+		int step)
+{
+	const char		*value;
+	char			name[64];
+	zbx_ipc_message_t	message;
+	md5_state_t		state;
+	unsigned char		digest[ZBX_MD5_DIGEST_SIZE];
+
+	mock_now = (time_t)zbx_mock_get_object_member_int(hstep, "time");
+	mock_revision = zbx_mock_get_object_member_uint64(hstep, "revision");
+	value = zbx_mock_get_object_member_string(hstep, "value");
+
+	mock_queue_value(manager, value);
+	lld_process_queue(manager);
+
+	zbx_snprintf(name, sizeof(name), "step %d prepare request", step + 1);
+	zbx_mock_assert_uint64_eq(name, ZBX_IPC_LLD_PREPARE_VALUE, mock_sent_code);
+
+	/* worker reports digest of the prepared value with the first 'next' response */
+	zbx_md5_init(&state);
+	zbx_md5_append(&state, (const md5_byte_t *)value, (int)strlen(value));
+	zbx_md5_finish(&state, digest);
+
+	message.code = ZBX_IPC_LLD_NEXT;
+
+	if (0 == strcmp(zbx_mock_get_object_member_string(hstep, "digest"), "yes"))
+	{
+		message.size = ZBX_MD5_DIGEST_SIZE;
+		message.data = digest;
+	}
+	else
+	{
+		message.size = 0;
+		message.data = NULL;
+	}
+
+	lld_process_next(manager, client, &message);
+
+	zbx_snprintf(name, sizeof(name), "step %d process request", step + 1);
+	zbx_mock_assert_uint64_eq(name, ZBX_IPC_LLD_PROCESS, mock_sent_code);
+
+	zbx_snprintf(name, sizeof(name), "step %d skipped", step + 1);
+	zbx_mock_assert_int_eq(name, 0 == strcmp(zbx_mock_get_object_member_string(hstep, "skip"), "yes"),
+			mock_sent_skip);
+
+	message.code = ZBX_IPC_LLD_DONE;
+
+	/* skipped and failed values are reported without digest */
+	if (0 == mock_sent_skip && 0 == strcmp(zbx_mock_get_object_member_string(hstep, "result"), "succeed"))
+	{
+		message.size = zbx_lld_serialize_done(&message.data, digest,
+				zbx_mock_get_object_member_int(hstep, "ttl"));
+	}
+	else
+	{
+		message.size = 0;
+		message.data = NULL;
+	}
+
+	lld_process_result(manager, client, &message);
+	zbx_free(message.data);
+
+	zbx_snprintf(name, sizeof(name), "step %d queued values", step + 1);
+	zbx_mock_assert_uint64_eq(name, 0, manager->queued_num);
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_lld_manager_t	manager;
+	zbx_mock_handle_t	hsteps, hstep;
+	zbx_mock_error_t	err;
+	int			mock_client, step = 0;
+	zbx_ipc_client_t	*client = (zbx_ipc_client_t *)&mock_client;
+
+	ZBX_UNUSED(state);
+
+	lld_manager_init(&manager, mock_get_config_forks);
+	mock_register_worker(&manager, client);
+
+	hsteps = zbx_mock_get_parameter_handle("in.steps");
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = zbx_mock_vector_element(hsteps, &hstep)))
+	{
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("cannot read step: %s", zbx_mock_error_string(err));
+
+		mock_process_step(&manager, client, hstep, step++);
+	}
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_parameter_exists("in.cleanup"))
+	{
+		lld_remove_expired_digests(&manager, (time_t)zbx_mock_get_parameter_int("in.cleanup"));
+		zbx_mock_assert_int_eq("digests after cleanup", zbx_mock_get_parameter_int("out.digests"),
+				manager.digests.num_data);
+	}
+
+	zbx_hashset_destroy(&manager.digests);
+	zbx_hashset_destroy(&manager.rule_index);
+	zbx_binary_heap_destroy(&manager.rule_queue);
+	zbx_hashset_destroy(&manager.workers_client);
+	zbx_queue_ptr_destroy(&manager.free_workers);
+	zbx_vector_lld_worker_ptr_clear_ext(&manager.workers, (zbx_lld_worker_ptr_free_func_t)zbx_ptr_free);
+	zbx_vector_lld_worker_ptr_destroy(&manager.workers);
+}
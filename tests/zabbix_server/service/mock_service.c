@@ -87,6 +87,11 @@ zbx_service_t	*mock_get_service(const char *name)
 	return zbx_hashset_search(&cache.services, &service_local);
 }
 
+zbx_hashset_t	*mock_get_services(void)
+{
+	return &cache.services;
+}
+
 void	mock_init_service_cache(const char *path)
 {
 	zbx_mock_handle_t	hservices, hservice, hchildren, hparents, hname, hevents, hevent, halgo, hweight, hprop,
@@ -108,6 +113,7 @@ void	mock_init_service_cache(const char *path)
 			fail_msg("cannot read service #%d", service_num);
 
 		memset(&service_local, 0, sizeof(zbx_service_t));
+		service_local.serviceid = (zbx_uint64_t)service_num + 1;
 		service_local.name = zbx_strdup(NULL, zbx_mock_get_object_member_string(hservice, "name"));
 		service = (zbx_service_t *)zbx_hashset_insert(&cache.services, &service_local, sizeof(service_local));
 
@@ -21,5 +21,6 @@ void	mock_init_service_cache(const char *path);
 void	mock_destroy_service_cache(void);
 
 zbx_service_t	*mock_get_service(const char *name);
+zbx_hashset_t	*mock_get_services(void);
 
 #endif
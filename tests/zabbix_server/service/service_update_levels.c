@@ -0,0 +1,174 @@
+/*
+** Copyright (C) 2001-2025 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+#include "service_manager_impl.h"
+
+#include "mock_service.h"
+
+static void	mock_update_services(const char *path, zbx_services_dirty_t *dirty)
+{
+	zbx_service_t		*service;
+	zbx_mock_handle_t	hupdates, hupdate, hstatus, hflags;
+	zbx_mock_error_t	err;
+	const char		*service_name, *value;
+	zbx_timespec_t		ts = {0, 0};
+	int			status, flags, update_num = 0;
+
+	hupdates = zbx_mock_get_parameter_handle(path);
+	while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hupdates, &hupdate))))
+	{
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("cannot read update #%d", update_num);
+
+		service_name = zbx_mock_get_object_member_string(hupdate, "service");
+		if (NULL == (service = mock_get_service(service_name)))
+			fail_msg("cannot find service '%s'", service_name);
+
+		ts.sec = zbx_mock_get_object_member_int(hupdate, "clock");
+
+		if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hupdate, "status", &hstatus))
+		{
+			if (ZBX_MOCK_SUCCESS != zbx_mock_int(hstatus, &status))
+				fail_msg("cannot read service '%s' update status", service_name);
+		}
+		else
+			status = service->status;
+
+		flags = ZBX_FLAG_SERVICE_UPDATE;
+
+		if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hupdate, "flags", &hflags))
+		{
+			if (ZBX_MOCK_SUCCESS != zbx_mock_string(hflags, &value))
+				fail_msg("cannot read service '%s' update flags", service_name);
+
+			if (0 == strcmp(value, "RECALCULATE"))
+				flags = ZBX_FLAG_SERVICE_RECALCULATE;
+			else
+				fail_msg("unknown service '%s' update flags '%s'", service_name, value);
+		}
+
+		/* queue parents the same way as service problem changes are processed */
+		if (service->status != status)
+		{
+			service->status = status;
+			service_queue_parents(dirty, service, &ts, flags);
+		}
+		else if (0 != (ZBX_FLAG_SERVICE_RECALCULATE & flags))
+			service_queue_parents(dirty, service, &ts, flags);
+
+		update_num++;
+	}
+}
+
+static void	mock_check_alarms(const char *path, const zbx_vector_status_update_ptr_t *alarms)
+{
+	zbx_service_t		*service;
+	zbx_mock_handle_t	halarms, halarm;
+	zbx_mock_error_t	err;
+	const char		*service_name;
+	int			alarm_num = 0, i;
+
+	halarms = zbx_mock_get_parameter_handle(path);
+	while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(halarms, &halarm))))
+	{
+		zbx_status_update_t	*alarm = NULL;
+
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("cannot read alarm #%d", alarm_num);
+
+		service_name = zbx_mock_get_object_member_string(halarm, "service");
+		if (NULL == (service = mock_get_service(service_name)))
+			fail_msg("cannot find service '%s'", service_name);
+
+		for (i = 0; i < alarms->values_num; i++)
+		{
+			if (alarms->values[i]->sourceid == service->serviceid)
+			{
+				if (NULL != alarm)
+					fail_msg("service '%s' has more than one alarm", service_name);
+
+				alarm = alarms->values[i];
+			}
+		}
+
+		if (NULL == alarm)
+			fail_msg("service '%s' has no alarm", service_name);
+
+		zbx_mock_assert_int_eq(service_name, zbx_mock_get_object_member_int(halarm, "status"), alarm->status);
+		zbx_mock_assert_int_eq(service_name, zbx_mock_get_object_member_int(halarm, "clock"), alarm->clock);
+		zbx_mock_assert_int_eq(service_name, alarm->status, service->status);
+		alarm_num++;
+	}
+
+	zbx_mock_assert_int_eq("alarms", alarm_num, alarms->values_num);
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_service_t		*service;
+	zbx_mock_handle_t	hlevels, hlevel;
+	zbx_mock_error_t	err;
+	const char		*service_name;
+	int			level_num = 0;
+
+	ZBX_UNUSED(state);
+
+	mock_init_service_cache("in.services");
+
+	service_update_levels(mock_get_services());
+
+	hlevels = zbx_mock_get_parameter_handle("out.levels");
+	while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hlevels, &hlevel))))
+	{
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("cannot read level #%d", level_num);
+
+		service_name = zbx_mock_get_object_member_string(hlevel, "service");
+		if (NULL == (service = mock_get_service(service_name)))
+			fail_msg("cannot find service '%s'", service_name);
+
+		zbx_mock_assert_int_eq(service_name, zbx_mock_get_object_member_int(hlevel, "level"), service->level);
+		level_num++;
+	}
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_parameter_exists("in.updates"))
+	{
+		zbx_services_dirty_t		dirty;
+		zbx_vector_status_update_ptr_t	alarms;
+		zbx_hashset_t			service_updates;
+
+		services_dirty_init(&dirty);
+		zbx_vector_status_update_ptr_create(&alarms);
+		zbx_hashset_create(&service_updates, 100, ZBX_DEFAULT_PTR_HASH_FUNC, ZBX_DEFAULT_PTR_COMPARE_FUNC);
+
+		mock_update_services("in.updates", &dirty);
+		its_itservices_update_status(&dirty, &alarms, &service_updates);
+
+		zbx_mock_assert_int_eq("evaluated services", zbx_mock_get_parameter_int("out.evaluated"),
+				dirty.evaluated_num);
+		mock_check_alarms("out.alarms", &alarms);
+		zbx_mock_assert_int_eq("service updates", alarms.values_num, service_updates.num_data);
+
+		zbx_hashset_destroy(&service_updates);
+		zbx_vector_status_update_ptr_clear_ext(&alarms, zbx_status_update_free);
+		zbx_vector_status_update_ptr_destroy(&alarms);
+		services_dirty_destroy(&dirty);
+	}
+
+	mock_destroy_service_cache();
+}